@@ -29,6 +29,7 @@
 # DEALINGS IN THE SOFTWARE.
 ###############################################################################
 
+import struct
 import sys
 
 sys.path.append( '../pymod' )
@@ -217,12 +218,95 @@ def polygonize_4():
     else:
         return 'fail'
 
+###############################################################################
+# Test the tiled mode (TILE_HEIGHT and NUM_THREADS options) against the
+# default mode. Features are not written in the same order.
+
+def polygonize_5_run(src_band, options):
+
+    mem_drv = ogr.GetDriverByName( 'Memory' )
+    mem_ds = mem_drv.CreateDataSource( 'out' )
+    mem_layer = mem_ds.CreateLayer( 'poly', None, ogr.wkbPolygon )
+    fd = ogr.FieldDefn( 'DN', ogr.OFTInteger )
+    mem_layer.CreateField( fd )
+
+    result = gdal.Polygonize( src_band, None, mem_layer, 0, options )
+    if result != 0:
+        return None
+
+    res = []
+    for feat in mem_layer:
+        geom = feat.GetGeometryRef()
+        res.append( (feat.GetField('DN'), geom.GetEnvelope(), geom.GetArea()) )
+    res.sort()
+    return res
+
+def polygonize_5():
+
+    src_ds = gdal.Open('data/polygonize_in_2.grd')
+
+    # Holes touching each other and the outer ring at a vertex
+    small_ds = gdal.GetDriverByName('MEM').Create('', 4, 4, 1)
+    small_ds.GetRasterBand(1).WriteRaster(0, 0, 4, 4,
+        struct.pack('B' * 16, 1, 1, 1, 1,
+                              1, 0, 1, 0,
+                              1, 1, 0, 1,
+                              0, 1, 1, 1))
+
+    for ds in [ src_ds, small_ds ]:
+        src_band = ds.GetRasterBand(1)
+        for connectedness in [ [], ['8CONNECTED=8'] ]:
+            ref = polygonize_5_run(src_band, connectedness)
+            if ref is None or len(ref) == 0:
+                gdaltest.post_reason( 'Polygonize failed' )
+                return 'fail'
+
+            for options in [ ['TILED=YES'],
+                             ['TILE_HEIGHT=1'],
+                             ['TILE_HEIGHT=2'],
+                             ['TILE_HEIGHT=7', 'NUM_THREADS=2'],
+                             ['NUM_THREADS=ALL_CPUS'] ]:
+                res = polygonize_5_run(src_band, connectedness + options)
+                if res is None:
+                    gdaltest.post_reason( 'Polygonize failed' )
+                    print(connectedness + options)
+                    return 'fail'
+                if len(res) != len(ref):
+                    gdaltest.post_reason( 'got %d features instead of %d' % (len(res), len(ref)) )
+                    print(connectedness + options)
+                    return 'fail'
+                for i in range(len(ref)):
+                    if res[i][0] != ref[i][0] or res[i][1] != ref[i][1] or \
+                       abs(res[i][2] - ref[i][2]) > 1e-8:
+                        gdaltest.post_reason( 'fail' )
+                        print(connectedness + options)
+                        print(res[i])
+                        print(ref[i])
+                        return 'fail'
+
+    # The areas add up to the number of pixels of each value
+    for connectedness in [ [], ['8CONNECTED=8'] ]:
+        for options in [ [], ['TILE_HEIGHT=1'], ['TILE_HEIGHT=100'] ]:
+            res = polygonize_5_run(small_ds.GetRasterBand(1),
+                                   connectedness + options)
+            areas = {}
+            for (dn, env, area) in res:
+                areas[dn] = areas.get(dn, 0) + area
+            if areas != { 0: 4, 1: 12 }:
+                gdaltest.post_reason( 'fail' )
+                print(connectedness + options)
+                print(areas)
+                return 'fail'
+
+    return 'success'
+
 gdaltest_list = [
     polygonize_1,
     polygonize_1_float,
     polygonize_2,
     polygonize_3,
-    polygonize_4
+    polygonize_4,
+    polygonize_5
     ]
 
 if __name__ == '__main__':
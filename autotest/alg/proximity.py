@@ -137,10 +137,70 @@ def proximity_3():
     else:
         return 'success'
 
+###############################################################################
+# Check the exactness of the distances, and the NEAREST_VALUE, NEAREST_X
+# and NEAREST_Y outputs, against a brute force computation.
+
+def proximity_4():
+
+    import struct
+
+    xsize = 23
+    ysize = 17
+    src_data = [ 0 for i in range(xsize * ysize) ]
+    for (x, y, val) in [ (2, 1, 10), (19, 3, 20), (7, 12, 30),
+                         (15, 16, 40), (11, 6, 50), (0, 16, 60) ]:
+        src_data[y * xsize + x] = val
+
+    src_ds = gdal.GetDriverByName('MEM').Create('', xsize, ysize)
+    src_ds.GetRasterBand(1).WriteRaster( 0, 0, xsize, ysize,
+        struct.pack('B' * (xsize * ysize), *src_data) )
+
+    targets = [ (i % xsize, int(i / xsize), src_data[i])
+                for i in range(xsize * ysize) if src_data[i] != 0 ]
+
+    for output in [ 'DISTANCE', 'NEAREST_VALUE', 'NEAREST_X', 'NEAREST_Y' ]:
+        dst_ds = gdal.GetDriverByName('MEM').Create('', xsize, ysize, 1,
+                                                    gdal.GDT_Float64)
+        gdal.ComputeProximity( src_ds.GetRasterBand(1),
+                               dst_ds.GetRasterBand(1),
+                               options = [ 'OUTPUT=' + output,
+                                           'MAXDIST=9',
+                                           'NODATA=-1',
+                                           'NUM_THREADS=2' ] )
+        got = struct.unpack('d' * (xsize * ysize),
+                            dst_ds.GetRasterBand(1).ReadRaster())
+
+        for y in range(ysize):
+            for x in range(xsize):
+                dist2 = min([ (x - tx) * (x - tx) + (y - ty) * (y - ty)
+                              for (tx, ty, val) in targets ])
+                nearest = [ (tx, ty, val) for (tx, ty, val) in targets
+                            if (x - tx) * (x - tx) + (y - ty) * (y - ty) == dist2 ]
+                if dist2 > 81:
+                    expected = [ -1 ]
+                elif output == 'DISTANCE':
+                    expected = [ dist2 ** 0.5 ]
+                elif output == 'NEAREST_VALUE':
+                    expected = [ val for (tx, ty, val) in nearest ]
+                elif output == 'NEAREST_X':
+                    expected = [ tx for (tx, ty, val) in nearest ]
+                else:
+                    expected = [ ty for (tx, ty, val) in nearest ]
+
+                val = got[y * xsize + x]
+                if min([ abs(val - e) for e in expected ]) > 1e-8:
+                    gdaltest.post_reason( 'fail' )
+                    print(output, x, y, val, expected)
+                    return 'fail'
+
+    return 'success'
+
 gdaltest_list = [
     proximity_1,
     proximity_2,
-    proximity_3
+    proximity_3,
+    proximity_4
     ]
 
 if __name__ == '__main__':
@@ -29,6 +29,7 @@
 # DEALINGS IN THE SOFTWARE.
 ###############################################################################
 
+import struct
 import sys
 
 sys.path.append( '../pymod' )
@@ -343,6 +344,129 @@ cellsize     60.000000000000
         return 'success'
 
 
+###############################################################################
+# Test processing by strips of lines with several threads. The result should
+# not depend on the strip height nor on the number of threads.
+
+def sieve_9():
+
+    for (filename, xsize, ysize, cs_expected) in \
+            [ ('data/sieve_src.grd', 5, 7, 364),
+              ('data/sieve_2634.grd', 10, 8, 98) ]:
+        src_ds = gdal.Open(filename)
+        src_band = src_ds.GetRasterBand(1)
+
+        for options in [ ['TILE_HEIGHT=1'],
+                         ['TILE_HEIGHT=2', 'NUM_THREADS=2'],
+                         ['TILE_HEIGHT=3', 'NUM_THREADS=ALL_CPUS'],
+                         ['NUM_THREADS=4'] ]:
+            dst_ds = gdal.GetDriverByName('MEM').Create('', xsize, ysize, 1,
+                                                        gdal.GDT_Byte )
+            dst_band = dst_ds.GetRasterBand(1)
+
+            gdal.SieveFilter( src_band, None, dst_band, 2, 4,
+                              options = options )
+
+            cs = dst_band.Checksum()
+            if cs != cs_expected:
+                gdaltest.post_reason( 'got wrong checksum' )
+                print(filename, options, cs)
+                return 'fail'
+
+    return 'success'
+
+###############################################################################
+# Test gdal.LabelConnectedComponents() against a straightforward flood fill
+
+def sieve_label_reference(values, valid, xsize, ysize, connectedness):
+
+    if connectedness == 4:
+        neighbours = [ (-1, 0), (1, 0), (0, -1), (0, 1) ]
+    else:
+        neighbours = [ (dx, dy) for dx in (-1, 0, 1) for dy in (-1, 0, 1)
+                       if dx != 0 or dy != 0 ]
+    labels = [ 0 ] * (xsize * ysize)
+    next_label = 1
+    for start in range(xsize * ysize):
+        if labels[start] != 0 or not valid[start]:
+            continue
+        labels[start] = next_label
+        stack = [ start ]
+        while len(stack) > 0:
+            idx = stack.pop()
+            x = idx % xsize
+            y = idx // xsize
+            for (dx, dy) in neighbours:
+                if x + dx < 0 or x + dx >= xsize or \
+                   y + dy < 0 or y + dy >= ysize:
+                    continue
+                other = idx + dy * xsize + dx
+                if labels[other] == 0 and valid[other] and \
+                   values[other] == values[start]:
+                    labels[other] = next_label
+                    stack.append(other)
+        next_label += 1
+    return labels
+
+def sieve_10():
+
+    for filename in [ 'data/sieve_src.grd', 'data/sieve_2634.grd' ]:
+        src_ds = gdal.Open(filename)
+        src_band = src_ds.GetRasterBand(1)
+        xsize = src_ds.RasterXSize
+        ysize = src_ds.RasterYSize
+        values = struct.unpack('i' * (xsize * ysize),
+            src_band.ReadRaster(0, 0, xsize, ysize,
+                                buf_type = gdal.GDT_Int32))
+
+        # Mask out the second column
+        mask_ds = gdal.GetDriverByName('MEM').Create('', xsize, ysize, 1)
+        mask_band = mask_ds.GetRasterBand(1)
+        mask_band.Fill(255)
+        mask_band.WriteRaster(1, 0, 1, ysize, struct.pack('B', 0) * ysize)
+
+        for use_mask in [ False, True ]:
+            if use_mask:
+                valid = [ (i % xsize) != 1 for i in range(xsize * ysize) ]
+            else:
+                valid = [ True ] * (xsize * ysize)
+
+            for connectedness in [ 4, 8 ]:
+                expected = sieve_label_reference(values, valid, xsize, ysize,
+                                                 connectedness)
+
+                for options in [ [],
+                                 ['TILE_HEIGHT=1'],
+                                 ['TILE_HEIGHT=2', 'NUM_THREADS=2'],
+                                 ['TILE_HEIGHT=3', 'NUM_THREADS=ALL_CPUS'] ]:
+                    dst_ds = gdal.GetDriverByName('MEM').Create(
+                        '', xsize, ysize, 1, gdal.GDT_Int32 )
+                    dst_band = dst_ds.GetRasterBand(1)
+
+                    if use_mask:
+                        ret = gdal.LabelConnectedComponents(
+                            src_band, mask_band, dst_band, connectedness,
+                            options = options )
+                    else:
+                        ret = gdal.LabelConnectedComponents(
+                            src_band, None, dst_band,
+                            connectedness = connectedness,
+                            options = options )
+                    if ret != 0:
+                        gdaltest.post_reason( 'fail' )
+                        return 'fail'
+
+                    got = list(struct.unpack('i' * (xsize * ysize),
+                                             dst_band.ReadRaster()))
+                    if got != expected:
+                        gdaltest.post_reason( 'got wrong labels' )
+                        print(filename, use_mask, connectedness, options)
+                        print(got)
+                        print(expected)
+                        return 'fail'
+
+    return 'success'
+
 gdaltest_list = [
     sieve_1,
     sieve_2,
@@ -351,7 +475,9 @@ gdaltest_list = [
     sieve_5,
     sieve_6,
     sieve_7,
-    sieve_8
+    sieve_8,
+    sieve_9,
+    sieve_10
     ]
 
 if __name__ == '__main__':
@@ -1695,6 +1695,97 @@ def warp_52():
 
     return 'success'
 
+###############################################################################
+# Test pipelined multi-threaded warping of chunks (-multi with NUM_THREADS)
+
+def warp_53():
+
+    src_ds = gdal.Open('../gcore/data/utmsmall.tif')
+
+    ref_ds = gdal.Warp('', src_ds, format = 'MEM',
+              dstSRS = 'EPSG:4326',
+              warpMemoryLimit = 4096,
+              resampleAlg = gdal.GRA_Bilinear)
+    ref_cs = ref_ds.GetRasterBand(1).Checksum()
+
+    for warp_options in [ ['NUM_THREADS=4'],
+                          ['NUM_THREADS=4', 'MULTI_CHUNK_PIPELINE=NO'] ]:
+        tab = [ 0 ]
+        ds = gdal.Warp('', src_ds, format = 'MEM',
+                  dstSRS = 'EPSG:4326',
+                  warpMemoryLimit = 4096,
+                  multithread = True,
+                  warpOptions = warp_options,
+                  resampleAlg = gdal.GRA_Bilinear,
+                  callback = warp_53_progress, callback_data = tab)
+        cs = ds.GetRasterBand(1).Checksum()
+        if cs != ref_cs:
+            gdaltest.post_reason('fail')
+            print(warp_options, cs, ref_cs)
+            return 'fail'
+        if tab[0] < 0:
+            gdaltest.post_reason('fail')
+            return 'fail'
+
+    return 'success'
+
+def warp_53_progress(pct, msg, user_data):
+    if pct < user_data[0]:
+        print('progress went backward: %f < %f' % (pct, user_data[0]))
+        user_data[0] = -1e10
+        return 0
+    user_data[0] = pct
+    return 1
+
+###############################################################################
+# Test TRANSFORM_GRID warping option
+
+def warp_54():
+
+    src_ds = gdal.Open('../gcore/data/utmsmall.tif')
+
+    ref_ds = gdal.Warp('', src_ds, format = 'MEM',
+              dstSRS = 'EPSG:4326',
+              errorThreshold = 0,
+              resampleAlg = gdal.GRA_Bilinear)
+
+    warp_options = [ 'TRANSFORM_GRID=YES',
+                     'TRANSFORM_GRID_MAX_ERROR=0.001',
+                     'TRANSFORM_GRID_STEP=8',
+                     'TRANSFORM_GRID_CACHE_FILE=/vsimem/warp_54.grd' ]
+    ds = gdal.Warp('', src_ds, format = 'MEM',
+              dstSRS = 'EPSG:4326',
+              warpMemoryLimit = 4096,
+              warpOptions = warp_options,
+              resampleAlg = gdal.GRA_Bilinear)
+    maxdiff = gdaltest.compare_ds(ds, ref_ds, verbose = 0)
+    if maxdiff > 1:
+        gdaltest.post_reason('fail')
+        print(maxdiff)
+        return 'fail'
+    cs = ds.GetRasterBand(1).Checksum()
+    ds = None
+
+    if gdal.VSIStatL('/vsimem/warp_54.grd') is None:
+        gdaltest.post_reason('fail')
+        return 'fail'
+
+    # Reuse the cache file, with several threads sharing the grid
+    ds = gdal.Warp('', src_ds, format = 'MEM',
+              dstSRS = 'EPSG:4326',
+              warpMemoryLimit = 4096,
+              multithread = True,
+              warpOptions = warp_options + [ 'NUM_THREADS=4' ],
+              resampleAlg = gdal.GRA_Bilinear)
+    if ds.GetRasterBand(1).Checksum() != cs:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    ds = None
+
+    gdal.Unlink('/vsimem/warp_54.grd')
+
+    return 'success'
+
 gdaltest_list = [
     warp_1,
     warp_1_short,
@@ -1764,7 +1855,9 @@ gdaltest_list = [
     warp_49,
     warp_50,
     warp_51,
-    warp_52
+    warp_52,
+    warp_53,
+    warp_54
     ]
 
 
@@ -32,6 +32,7 @@
 #include <fstream>
 #include "cpl_list.h"
 #include "cpl_hash_set.h"
+#include "cpl_metrics.h"
 #include "cpl_string.h"
 #include "cpl_sha256.h"
 
@@ -833,4 +834,70 @@ namespace tut
         ensure( VSIGetDiskFreeSpace(".") == -1 || VSIGetDiskFreeSpace(".") >= 0 );
     }
 
+    // Test metrics registry
+    template<>
+    template<>
+    void object::test<14>()
+    {
+        CPLMetric* psCounter = CPLMetricGetCounter("test_cpl.counter");
+        ensure( psCounter != NULL );
+        ensure( CPLMetricGetCounter("test_cpl.counter") == psCounter );
+        CPLMetricAdd(psCounter, 3);
+        CPLMetricAdd(psCounter, 4);
+        GIntBig nValue = 0;
+        ensure( CPLMetricGetValue("test_cpl.counter", &nValue) );
+        ensure_equals( nValue, 7 );
+        ensure( !CPLMetricGetValue("test_cpl.non_existing", &nValue) );
+
+        CPLMetric* psHisto = CPLMetricGetHistogram("test_cpl.histogram");
+        ensure( psHisto != NULL );
+        CPLMetricRecord(psHisto, 0.5);
+        CPLMetricRecord(psHisto, 3);
+        CPLMetricRecord(psHisto, 100);
+        GIntBig nCount = 0;
+        double dfSum = 0, dfMin = 0, dfMax = 0;
+        ensure( CPLMetricGetHistogramStats("test_cpl.histogram",
+                                           &nCount, &dfSum, &dfMin, &dfMax) );
+        ensure_equals( nCount, 3 );
+        ensure_equals( dfSum, 103.5 );
+        ensure_equals( dfMin, 0.5 );
+        ensure_equals( dfMax, 100.0 );
+
+        // A name cannot be registered with two types
+        CPLPushErrorHandler(CPLQuietErrorHandler);
+        ensure( CPLMetricGetHistogram("test_cpl.counter") == NULL );
+        CPLPopErrorHandler();
+
+        // Reads through /vsimem/ are accounted
+        GIntBig nBytesReadBefore = 0;
+        CPLMetricGetValue("vsi.vsimem.bytes_read", &nBytesReadBefore);
+        VSILFILE* fp = VSIFOpenL("/vsimem/test_cpl_metrics.bin", "wb+");
+        ensure( fp != NULL );
+        ensure_equals( VSIFWriteL("0123456789", 1, 10, fp), 10U );
+        VSIFSeekL(fp, 0, SEEK_SET);
+        char szBuffer[10];
+        ensure_equals( VSIFReadL(szBuffer, 1, 10, fp), 10U );
+        VSIFCloseL(fp);
+        VSIUnlink("/vsimem/test_cpl_metrics.bin");
+        GIntBig nBytesRead = 0;
+        ensure( CPLMetricGetValue("vsi.vsimem.bytes_read", &nBytesRead) );
+        ensure_equals( nBytesRead - nBytesReadBefore, 10 );
+
+        char** papszNames = CPLMetricsGetNames();
+        ensure( CSLFindString(papszNames, "test_cpl.counter") >= 0 );
+        ensure( CSLFindString(papszNames, "test_cpl.histogram") >= 0 );
+        CSLDestroy(papszNames);
+
+        char* pszJSON = CPLMetricsGetAsJSON();
+        ensure( strstr(pszJSON, "\"test_cpl.counter\": 7") != NULL );
+        ensure( strstr(pszJSON, "\"test_cpl.histogram\": { \"count\": 3, "
+                                "\"sum\": 103.5, \"min\": 0.5, \"max\": 100, "
+                                "\"buckets\": [[1, 1], [4, 1], [128, 1]] }") != NULL );
+        CPLFree(pszJSON);
+
+        CPLMetricsReset();
+        ensure( CPLMetricGetValue("test_cpl.counter", &nValue) );
+        ensure_equals( nValue, 0 );
+    }
+
 } // namespace tut
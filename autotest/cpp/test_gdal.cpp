@@ -36,6 +36,7 @@
 #include <gdal_utils.h>
 #include <string>
 #include <limits>
+#include <vector>
 
 namespace tut
 {
@@ -282,4 +283,142 @@ namespace tut
         GetGDALDriverManager()->DeregisterDriver( poDriver );
         delete poDriver;
     }
+
+    static void CPL_STDCALL AsyncRasterIOCountCompletion(
+        GDALAsyncRasterIORequestH, CPLErr eErr, void* pUserData )
+    {
+        if( eErr == CE_None )
+            CPLAtomicInc( static_cast<int*>(pUserData) );
+    }
+
+    // Test GDALDatasetAsyncRasterIO()
+    template<> template<> void object::test<10>()
+    {
+        GDALDatasetH hDS = GDALOpen("../gcore/data/byte.tif", GA_ReadOnly);
+        ensure(hDS != NULL);
+        const int nXSize = GDALGetRasterXSize(hDS);
+        const int nYSize = GDALGetRasterYSize(hDS);
+
+        std::vector<GByte> abyRef(nXSize * nYSize);
+        ensure_equals( GDALDatasetRasterIO(hDS, GF_Read, 0, 0, nXSize, nYSize,
+                                           &abyRef[0], nXSize, nYSize,
+                                           GDT_Byte, 1, NULL, 0, 0, 0),
+                       CE_None );
+
+        // One request per line, serviced by 2 threads that each use
+        // their own handle on the file.
+        std::vector<GByte> abyAsync(nXSize * nYSize);
+        std::vector<GDALAsyncRasterIORequestH> ahReq;
+        char** papszOptions = CSLSetNameValue(NULL, "NUM_THREADS", "2");
+        int nCompleted = 0;
+        for( int iLine = 0; iLine < nYSize; iLine++ )
+        {
+            GDALAsyncRasterIORequestH hReq = GDALDatasetAsyncRasterIO(
+                hDS, 0, iLine, nXSize, 1, &abyAsync[iLine * nXSize],
+                nXSize, 1, GDT_Byte, 1, NULL, 0, 0, 0,
+                AsyncRasterIOCountCompletion, &nCompleted, papszOptions );
+            ensure(hReq != NULL);
+            ahReq.push_back(hReq);
+        }
+        CSLDestroy(papszOptions);
+
+        int nReported = 0;
+        while( GDALDatasetAsyncRasterIOWaitAny(hDS, -1.0) != NULL )
+            nReported ++;
+        ensure_equals( nReported, nYSize );
+        for( size_t i = 0; i < ahReq.size(); i++ )
+        {
+            ensure_equals( GDALAsyncRasterIOWait(ahReq[i], 0.0),
+                           GARIO_COMPLETE );
+            ensure( GDALAsyncRasterIOGetUserData(ahReq[i]) == &nCompleted );
+            GDALAsyncRasterIORelease(ahReq[i]);
+        }
+        ensure_equals( nCompleted, nYSize );
+        ensure( abyRef == abyAsync );
+
+        // Invalid window
+        CPLPushErrorHandler(CPLQuietErrorHandler);
+        ensure( GDALDatasetAsyncRasterIO(
+                    hDS, 0, 0, nXSize + 1, 1, &abyAsync[0],
+                    nXSize, 1, GDT_Byte, 1, NULL, 0, 0, 0,
+                    NULL, NULL, NULL ) == NULL );
+        CPLPopErrorHandler();
+
+        GDALClose(hDS);
+    }
+
+    // Test per-dataset block cache quota, priority and statistics
+    template<> template<> void object::test<11>()
+    {
+        GDALDriverH hDrv = GDALGetDriverByName("GTiff");
+        if( hDrv == NULL )
+            return;
+        const char* apszOptions[] = { "BLOCKYSIZE=1", NULL };
+        GDALDatasetH hDS = GDALCreate(hDrv, "/vsimem/test_block_cache.tif",
+                                      64, 64, 1, GDT_Byte,
+                                      (char**)apszOptions);
+        ensure(hDS != NULL);
+        GDALClose(hDS);
+        hDS = GDALOpen("/vsimem/test_block_cache.tif", GA_ReadOnly);
+        ensure(hDS != NULL);
+
+        ensure_equals( GDALDatasetGetCachePriority(hDS), GBCP_NORMAL );
+        GDALDatasetSetCachePriority(hDS, GBCP_SCAN_RESISTANT);
+        ensure_equals( GDALDatasetGetCachePriority(hDS), GBCP_SCAN_RESISTANT );
+        GDALDatasetSetCachePriority(hDS, GBCP_NORMAL);
+
+        GByte abyBuf[64 * 64];
+        GDALRasterBandH hBand = GDALGetRasterBand(hDS, 1);
+        ensure_equals( GDALRasterIO(hBand, GF_Read, 0, 0, 64, 64,
+                                    abyBuf, 64, 64, GDT_Byte, 0, 0),
+                       CE_None );
+        GIntBig nUsed, nHits, nMisses, nEvictions;
+        GDALDatasetGetCacheStatistics(hDS, &nUsed, &nHits, &nMisses,
+                                      &nEvictions);
+        ensure_equals( nUsed, 64 * 64 );
+        ensure_equals( nMisses, 64 );
+        ensure_equals( nHits, 0 );
+
+        ensure_equals( GDALRasterIO(hBand, GF_Read, 0, 0, 64, 64,
+                                    abyBuf, 64, 64, GDT_Byte, 0, 0),
+                       CE_None );
+        GDALDatasetGetCacheStatistics(hDS, NULL, &nHits, &nMisses, NULL);
+        ensure_equals( nMisses, 64 );
+        ensure_equals( nHits, 64 );
+
+        // Reducing the quota flushes the blocks in excess
+        GDALDatasetSetCacheQuota(hDS, 10 * 64);
+        ensure_equals( GDALDatasetGetCacheQuota(hDS), 10 * 64 );
+        GDALDatasetGetCacheStatistics(hDS, &nUsed, NULL, NULL, &nEvictions);
+        ensure( nUsed <= 10 * 64 );
+        ensure_equals( nEvictions, 54 );
+
+        // and it is enforced when reading
+        ensure_equals( GDALRasterIO(hBand, GF_Read, 0, 0, 64, 64,
+                                    abyBuf, 64, 64, GDT_Byte, 0, 0),
+                       CE_None );
+        GDALDatasetGetCacheStatistics(hDS, &nUsed, NULL, NULL, NULL);
+        ensure( nUsed <= 10 * 64 );
+
+        // Blocks of overviews are accounted with the base dataset
+        GDALDatasetSetCacheQuota(hDS, 0);
+        int nOvrLevel = 2;
+        ensure_equals( GDALBuildOverviews(hDS, "NEAREST", 1, &nOvrLevel,
+                                          0, NULL, NULL, NULL), CE_None );
+        GIntBig nHitsBefore, nMissesBefore;
+        GDALDatasetGetCacheStatistics(hDS, NULL, &nHitsBefore,
+                                      &nMissesBefore, NULL);
+        GDALRasterBandH hOvrBand = GDALGetOverview(hBand, 0);
+        ensure( hOvrBand != NULL );
+        ensure_equals( GDALRasterIO(hOvrBand, GF_Read, 0, 0, 32, 32,
+                                    abyBuf, 32, 32, GDT_Byte, 0, 0),
+                       CE_None );
+        GDALDatasetGetCacheStatistics(hDS, &nUsed, &nHits, &nMisses, NULL);
+        ensure( nHits + nMisses > nHitsBefore + nMissesBefore );
+        ensure( nUsed >= 32 * 32 );
+
+        GDALClose(hDS);
+        VSIUnlink("/vsimem/test_block_cache.tif");
+        VSIUnlink("/vsimem/test_block_cache.tif.ovr");
+    }
 } // namespace tut
@@ -531,6 +531,61 @@ abc***NEWFILE***:""")
 
     return 'success'
 
+###############################################################################
+# Test writing /vsigzip/ files made of several members with an index of
+# access points, and reading them back with several threads
+
+def vsifile_11():
+
+    data = ''.join(['%08d\n' % i for i in range(400000)]).encode('ascii')
+
+    gdal.SetConfigOption('CPL_VSIL_GZIP_MEMBER_SIZE', '500000')
+    gdal.SetConfigOption('CPL_VSIL_GZIP_WRITE_INDEX', 'YES')
+    gdal.SetConfigOption('GDAL_NUM_THREADS', '4')
+    fp = gdal.VSIFOpenL('/vsigzip//vsimem/vsifile_11.gz', 'wb')
+    gdal.VSIFWriteL(data, 1, len(data), fp)
+    gdal.VSIFCloseL(fp)
+    gdal.SetConfigOption('CPL_VSIL_GZIP_MEMBER_SIZE', None)
+
+    # Write a single member file, and index it when stat'ing it
+    fp = gdal.VSIFOpenL('/vsigzip//vsimem/vsifile_11_single.gz', 'wb')
+    gdal.VSIFWriteL(data, 1, len(data), fp)
+    gdal.VSIFCloseL(fp)
+    statBuf = gdal.VSIStatL('/vsigzip//vsimem/vsifile_11_single.gz')
+    gdal.SetConfigOption('CPL_VSIL_GZIP_WRITE_INDEX', None)
+    if statBuf is None or statBuf.size != len(data):
+        gdaltest.post_reason('fail')
+        gdal.SetConfigOption('GDAL_NUM_THREADS', None)
+        return 'fail'
+
+    ret = 'success'
+    for filename in [ 'vsifile_11.gz', 'vsifile_11_single.gz' ]:
+        if gdal.VSIStatL('/vsimem/' + filename + '.idx') is None:
+            gdaltest.post_reason('fail')
+            print(filename)
+            ret = 'fail'
+
+        fp = gdal.VSIFOpenL('/vsigzip//vsimem/' + filename, 'rb')
+        if gdal.VSIFReadL(1, len(data) + 1, fp) != data:
+            gdaltest.post_reason('fail')
+            print(filename)
+            ret = 'fail'
+        for (offset, size) in [ (3000000, 100), (1234567, 2500000), (10, 3500000), (0, 1) ]:
+            gdal.VSIFSeekL(fp, offset, 0)
+            if gdal.VSIFReadL(1, size, fp) != data[offset:offset+size]:
+                gdaltest.post_reason('fail')
+                print(filename, offset, size)
+                ret = 'fail'
+        gdal.VSIFCloseL(fp)
+
+        gdal.Unlink('/vsimem/' + filename)
+        gdal.Unlink('/vsimem/' + filename + '.idx')
+        gdal.Unlink('/vsimem/' + filename + '.properties')
+
+    gdal.SetConfigOption('GDAL_NUM_THREADS', None)
+
+    return ret
+
 gdaltest_list = [ vsifile_1,
                   vsifile_2,
                   vsifile_3,
@@ -540,7 +595,8 @@ gdaltest_list = [ vsifile_1,
                   vsifile_7,
                   vsifile_8,
                   vsifile_9,
-                  vsifile_10 ]
+                  vsifile_10,
+                  vsifile_11 ]
 
 if __name__ == '__main__':
 
@@ -37,6 +37,7 @@ import sys
 sys.path.append( '../pymod' )
 
 import gdaltest
+import ogrtest
 import shutil
 
 from osgeo import gdal
@@ -193,7 +194,7 @@ def gnm_graph_dijkstra():
     dn.ReleaseResultSet(lyr)
     dn = None
     return 'success'
-import ogrtest
+
 ###############################################################################
 # KShortest Paths
 
@@ -249,6 +250,118 @@ def gnm_graph_connectedcomponents():
     dn = None
     return 'success'
 
+###############################################################################
+# Shortest path with a contraction hierarchy
+
+def gnm_graph_contraction_hierarchy():
+
+    if not ogrtest.have_gnm:
+        return 'skip'
+
+    ds = gdal.OpenEx( 'tmp/test_gnm' )
+    dgn = gnm.CastToGenericNetwork(ds)
+    if dgn is None:
+        gdaltest.post_reason('cast to GNMGenericNetwork failed')
+        return 'fail'
+
+    lyr = dgn.GetPath(61, 50, gnm.GATDijkstraShortestPath)
+    expected = [ f.ExportToJson() for f in lyr ]
+    dgn.ReleaseResultSet(lyr)
+
+    ret = dgn.BuildContractionHierarchy()
+    if ret != 0:
+        gdaltest.post_reason('failed to build contraction hierarchy')
+        return 'fail'
+
+    lyr = dgn.GetPath(61, 50, gnm.GATDijkstraShortestPath)
+    got = [ f.ExportToJson() for f in lyr ]
+    dgn.ReleaseResultSet(lyr)
+    if got != expected:
+        gdaltest.post_reason('fail')
+        print(got)
+        print(expected)
+        return 'fail'
+    dgn = None
+    ds = None
+
+    # The hierarchy is stored with the network
+    files = gdal.ReadDir('tmp/test_gnm')
+    if len([ x for x in files if x.startswith('_gnm_contraction') ]) != 1:
+        gdaltest.post_reason('fail')
+        print(files)
+        return 'fail'
+
+    ds = gdal.OpenEx( 'tmp/test_gnm' )
+    dn = gnm.CastToNetwork(ds)
+    lyr = dn.GetPath(61, 50, gnm.GATDijkstraShortestPath)
+    got = [ f.ExportToJson() for f in lyr ]
+    dn.ReleaseResultSet(lyr)
+    if got != expected:
+        gdaltest.post_reason('fail')
+        print(got)
+        print(expected)
+        return 'fail'
+
+    dn = None
+    ds = None
+
+    # Remove the hierarchy so that the following tests use the plain graph
+    for filename in gdal.ReadDir('tmp/test_gnm'):
+        if filename.startswith('_gnm_contraction'):
+            gdal.Unlink('tmp/test_gnm/' + filename)
+
+    return 'success'
+
+###############################################################################
+# One to many shortest path costs
+
+def gnm_graph_shortest_path_costs():
+
+    if not ogrtest.have_gnm:
+        return 'skip'
+
+    ds = gdal.OpenEx( 'tmp/test_gnm' )
+    dgn = gnm.CastToGenericNetwork(ds)
+    if dgn is None:
+        gdaltest.post_reason('cast to GNMGenericNetwork failed')
+        return 'fail'
+
+    lyr = dgn.GetLayerByName('wells')
+    end_fids = [ f.GetFID() for f in lyr ][0:20]
+    if 50 not in end_fids:
+        end_fids.append(50)
+
+    costs = dgn.GetShortestPathCosts(61, end_fids)
+    if len(costs) != len(end_fids):
+        gdaltest.post_reason('fail')
+        print(costs)
+        return 'fail'
+
+    # All the edges were connected with a cost of 1, so the cost of a
+    # path is its number of edges
+    for i in range(len(end_fids)):
+        lyr = dgn.GetPath(61, end_fids[i], gnm.GATDijkstraShortestPath)
+        nb_edges = len([ f for f in lyr if f.GetField('ftype') == 'EDGE' ])
+        nb_features = lyr.GetFeatureCount()
+        dgn.ReleaseResultSet(lyr)
+        if end_fids[i] == 61:
+            expected = 0
+        elif nb_features == 0:
+            expected = float('inf')
+        else:
+            expected = nb_edges
+        if costs[i] != expected:
+            gdaltest.post_reason('fail')
+            print(end_fids[i], costs[i], expected)
+            return 'fail'
+
+    if dgn.GetShortestPathCosts(61, []) != []:
+        gdaltest.post_reason('fail')
+        return 'fail'
+
+    dgn = None
+    return 'success'
+
 ###############################################################################
 # Network deleting
 
@@ -277,6 +390,8 @@ gdaltest_list = [
     gnm_graph_dijkstra,
     gnm_graph_kshortest,
     gnm_graph_connectedcomponents,
+    gnm_graph_contraction_hierarchy,
+    gnm_graph_shortest_path_costs,
     gnm_delete
     ]
 
@@ -2447,6 +2447,97 @@ def ogr_csv_47():
 
     return 'success'
 
+###############################################################################
+# Test parallel parsing of records (NUM_THREADS open option)
+
+def ogr_csv_48():
+
+    content = 'id,int64,real,str\r\n'
+    for i in range(40000):
+        if (i % 1000) == 999:
+            content += '\r\n'
+        if (i % 7) == 0:
+            content += '%d,%d,%.17g,"multi\nline ""%d"",\r\n"\r\n' % (i, i * 1234567890123, i / 7.0, i)
+        else:
+            content += '%d,%d,%.3f,foo%d\r\n' % (i, -i * 1234567890123, i / 8.0, i)
+    gdal.FileFromMemBuffer('/vsimem/ogr_csv_48.csv', content)
+    gdal.FileFromMemBuffer('/vsimem/ogr_csv_48.csvt', 'Integer,Integer64,Real,String')
+
+    ds_ref = gdal.OpenEx('/vsimem/ogr_csv_48.csv', gdal.OF_VECTOR)
+    lyr_ref = ds_ref.GetLayer(0)
+    ds = gdal.OpenEx('/vsimem/ogr_csv_48.csv', gdal.OF_VECTOR,
+                     open_options = ['NUM_THREADS=4'])
+    lyr = ds.GetLayer(0)
+
+    for iter in range(2):
+        lyr_ref.ResetReading()
+        lyr.ResetReading()
+        count = 0
+        while True:
+            f_ref = lyr_ref.GetNextFeature()
+            f = lyr.GetNextFeature()
+            if f_ref is None:
+                if f is not None:
+                    gdaltest.post_reason('fail')
+                    return 'fail'
+                break
+            # Features of both datasets have distinct OGRFeatureDefn, so
+            # Equal() cannot be used: compare FID and fields one by one.
+            ok = f is not None and f.GetFID() == f_ref.GetFID() and \
+                 f.GetFieldCount() == f_ref.GetFieldCount()
+            if ok:
+                for i in range(f_ref.GetFieldCount()):
+                    if f.IsFieldSet(i) != f_ref.IsFieldSet(i) or \
+                       f.GetField(i) != f_ref.GetField(i):
+                        ok = False
+                        break
+            if not ok:
+                gdaltest.post_reason('fail')
+                f_ref.DumpReadable()
+                if f is not None:
+                    f.DumpReadable()
+                return 'fail'
+            count += 1
+        if count != 40000:
+            gdaltest.post_reason('fail')
+            print(count)
+            return 'fail'
+
+    f = lyr.GetFeature(8)
+    if f['id'] != 7 or f['str'] != 'multi\nline "7",\n':
+        gdaltest.post_reason('fail')
+        f.DumpReadable()
+        return 'fail'
+
+    # Interrupted parallel reading, then restart
+    lyr.ResetReading()
+    for i in range(10):
+        f = lyr.GetNextFeature()
+    lyr.ResetReading()
+    f = lyr.GetNextFeature()
+    if f['id'] != 0 or f.GetFID() != 1:
+        gdaltest.post_reason('fail')
+        f.DumpReadable()
+        return 'fail'
+    if lyr.GetFeatureCount() != 40000:
+        gdaltest.post_reason('fail')
+        return 'fail'
+
+    lyr.SetAttributeFilter('id = 39999')
+    lyr.ResetReading()
+    f = lyr.GetNextFeature()
+    if f is None or f['int64'] != -39999 * 1234567890123:
+        gdaltest.post_reason('fail')
+        return 'fail'
+
+    ds = None
+    ds_ref = None
+
+    gdal.Unlink('/vsimem/ogr_csv_48.csv')
+    gdal.Unlink('/vsimem/ogr_csv_48.csvt')
+
+    return 'success'
+
 ###############################################################################
 #
 
@@ -2529,6 +2620,7 @@ gdaltest_list = [
     ogr_csv_45,
     ogr_csv_46,
     ogr_csv_47,
+    ogr_csv_48,
     ogr_csv_cleanup ]
 
 if __name__ == '__main__':
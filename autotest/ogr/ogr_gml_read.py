@@ -3932,6 +3932,80 @@ def ogr_gml_76():
 
     return 'success'
 
+###############################################################################
+# Test multi-threaded reading (NUM_THREADS open option)
+
+def ogr_gml_77():
+
+    if not gdaltest.have_gml_reader:
+        return 'skip'
+
+    for filename in [ 'gnis_pop_100.gml', 'archsites.gml', 'citygml.gml',
+                      'expected_gml_gml32.gml', 'wfs_200_multiplelayers.gml' ]:
+        shutil.copy('data/' + filename, 'tmp/' + filename)
+        ds_ref = gdal.OpenEx('tmp/' + filename)
+        ref = []
+        for i in range(ds_ref.GetLayerCount()):
+            lyr = ds_ref.GetLayer(i)
+            for f in lyr:
+                ref.append(f.ExportToJson())
+        ds_ref = None
+
+        # Use small pieces so that the file is split between several jobs
+        gdal.SetConfigOption('GML_PARALLEL_CHUNK_SIZE', '100')
+        ds = gdal.OpenEx('tmp/' + filename, open_options = ['NUM_THREADS=4'])
+        got = []
+        for i in range(ds.GetLayerCount()):
+            lyr = ds.GetLayer(i)
+            for f in lyr:
+                got.append(f.ExportToJson())
+            # Reading a second time must give the same result
+            lyr.ResetReading()
+            got2 = []
+            for f in lyr:
+                got2.append(f.ExportToJson())
+            if got2 != got[len(got)-len(got2):]:
+                gdaltest.post_reason('fail')
+                print(filename)
+                gdal.SetConfigOption('GML_PARALLEL_CHUNK_SIZE', None)
+                return 'fail'
+        ds = None
+        gdal.SetConfigOption('GML_PARALLEL_CHUNK_SIZE', None)
+
+        if got != ref:
+            gdaltest.post_reason('fail')
+            print(filename)
+            return 'fail'
+
+        gdal.Unlink('tmp/' + filename)
+        gdal.Unlink('tmp/' + filename[0:-4] + '.gfs')
+
+    # Truncated file: the features before the error are returned
+    data = open('data/gnis_pop_100.gml', 'rb').read()
+    gdal.FileFromMemBuffer('/vsimem/ogr_gml_77.gml', data)
+    # Generate the .gfs file
+    ds = ogr.Open('/vsimem/ogr_gml_77.gml')
+    ds = None
+    gdal.FileFromMemBuffer('/vsimem/ogr_gml_77.gml', data[0:len(data)//2])
+    gdal.SetConfigOption('GML_PARALLEL_CHUNK_SIZE', '100')
+    with gdaltest.error_handler():
+        ds = gdal.OpenEx('/vsimem/ogr_gml_77.gml', open_options = ['NUM_THREADS=4'])
+        lyr = ds.GetLayer(0)
+        count = 0
+        for f in lyr:
+            count += 1
+    gdal.SetConfigOption('GML_PARALLEL_CHUNK_SIZE', None)
+    ds = None
+    gdal.Unlink('/vsimem/ogr_gml_77.gml')
+    gdal.Unlink('/vsimem/ogr_gml_77.gfs')
+    if count == 0 or gdal.GetLastErrorMsg().find('XML parsing of GML file failed') < 0:
+        gdaltest.post_reason('fail')
+        print(count)
+        print(gdal.GetLastErrorMsg())
+        return 'fail'
+
+    return 'success'
+
 ###############################################################################
 #  Cleanup
 
@@ -4140,6 +4214,7 @@ gdaltest_list = [
     ogr_gml_74,
     ogr_gml_75,
     ogr_gml_76,
+    ogr_gml_77,
     ogr_gml_cleanup ]
 
 disabled_gdaltest_list = [
@@ -798,6 +798,85 @@ def ogr_kml_two_layers():
 
     return compare_output(content, expected_content)
 
+###############################################################################
+# Compare two features read from different datasets. Their OGRFeatureDefn
+# differ, so OGRFeature::Equal() cannot be used.
+
+def ogr_kml_same_feature(feat, feat_ref):
+
+    if feat.GetFID() != feat_ref.GetFID() or \
+       feat.GetFieldCount() != feat_ref.GetFieldCount():
+        return False
+    for i in range(feat_ref.GetFieldCount()):
+        if feat.IsFieldSet(i) != feat_ref.IsFieldSet(i) or \
+           feat.GetField(i) != feat_ref.GetField(i):
+            return False
+    if feat_ref.GetGeometryRef() is None:
+        return feat.GetGeometryRef() is None
+    return ogrtest.check_feature_geometry(feat, feat_ref.GetGeometryRef()) == 0
+
+###############################################################################
+# Test that the streaming mode, where Placemarks are parsed again from the
+# byte range of their container, returns the same content as the default mode
+
+def ogr_kml_read_streaming():
+
+    if not ogrtest.have_read_kml:
+        return 'skip'
+
+    for filename in [ 'data/samples.kml', 'data/geometries.kml',
+                      'data/description_with_xml.kml',
+                      'data/emptylayers.kml', 'data/test_schema.kml' ]:
+
+        ds_ref = ogr.Open(filename)
+        gdal.SetConfigOption('KML_STREAMING', 'YES')
+        ds = ogr.Open(filename)
+        gdal.SetConfigOption('KML_STREAMING', None)
+
+        if ds.GetLayerCount() != ds_ref.GetLayerCount():
+            gdaltest.post_reason('failed')
+            print(filename)
+            return 'fail'
+
+        for i in range(ds_ref.GetLayerCount()):
+            lyr_ref = ds_ref.GetLayer(i)
+            lyr = ds.GetLayer(i)
+            if lyr.GetName() != lyr_ref.GetName() or \
+               lyr.GetGeomType() != lyr_ref.GetGeomType() or \
+               lyr.GetFeatureCount() != lyr_ref.GetFeatureCount():
+                gdaltest.post_reason('failed')
+                print(filename, lyr_ref.GetName())
+                return 'fail'
+
+            # Read twice to check that the stream is restarted
+            for j in range(2):
+                lyr.ResetReading()
+                lyr_ref.ResetReading()
+                while True:
+                    feat_ref = lyr_ref.GetNextFeature()
+                    feat = lyr.GetNextFeature()
+                    if feat_ref is None and feat is None:
+                        break
+                    if feat_ref is None or feat is None or \
+                       not ogr_kml_same_feature(feat, feat_ref):
+                        gdaltest.post_reason('failed')
+                        print(filename, lyr_ref.GetName())
+                        return 'fail'
+
+    # Interleaved reading of two layers
+    ds_ref = ogr.Open('data/samples.kml')
+    gdal.SetConfigOption('KML_STREAMING', 'YES')
+    ds = ogr.Open('data/samples.kml')
+    gdal.SetConfigOption('KML_STREAMING', None)
+    for i in [0, 2, 0, 2, 0]:
+        feat_ref = ds_ref.GetLayer(i).GetNextFeature()
+        feat = ds.GetLayer(i).GetNextFeature()
+        if feat is None or not ogr_kml_same_feature(feat, feat_ref):
+            gdaltest.post_reason('failed')
+            return 'fail'
+
+    return 'success'
+
 ###############################################################################
 #  Cleanup
 
@@ -842,6 +921,7 @@ gdaltest_list = [
     ogr_kml_write_schema,
     ogr_kml_empty_layer,
     ogr_kml_two_layers,
+    ogr_kml_read_streaming,
     ogr_kml_cleanup ]
 
 if __name__ == '__main__':
@@ -2234,6 +2234,61 @@ def ogr_mitab_43():
 
     return 'success'
 
+###############################################################################
+# Test spatial index bulk-loaded in quick spatial index mode
+
+def ogr_mitab_44():
+
+    if gdaltest.mapinfo_drv is None:
+        return 'skip'
+
+    ds = gdaltest.mapinfo_drv.CreateDataSource('/vsimem/ogr_mitab_44.tab')
+    lyr = ds.CreateLayer('ogr_mitab_44')
+    lyr.CreateField(ogr.FieldDefn('ID', ogr.OFTInteger))
+    # Pseudo random order so that consecutive object blocks are far apart
+    for i in range(5000):
+        x = (i * 7919) % 5000 / 25.0 - 100
+        y = (i * 104729) % 5000 / 50.0 - 50
+        f = ogr.Feature(lyr.GetLayerDefn())
+        f.SetField('ID', i)
+        if (i % 3) == 0:
+            f.SetGeometry(ogr.CreateGeometryFromWkt('LINESTRING(%f %f,%f %f)' % (x, y, x + 0.5, y + 0.5)))
+        else:
+            f.SetGeometry(ogr.CreateGeometryFromWkt('POINT(%f %f)' % (x, y)))
+        lyr.CreateFeature(f)
+    ds = None
+
+    ds = ogr.Open('/vsimem/ogr_mitab_44.tab')
+    lyr = ds.GetLayer(0)
+    if lyr.GetFeatureCount() != 5000:
+        gdaltest.post_reason('fail')
+        return 'fail'
+
+    for (minx, miny, maxx, maxy) in [ (-10, -10, 10, 10), (50, 20, 60, 50),
+                                      (-200, -100, 200, 100), (-80, 30, -70, 40) ]:
+        expected_ids = []
+        lyr.SetSpatialFilter(None)
+        for f in lyr:
+            if f.GetGeometryRef().Intersects(ogr.CreateGeometryFromWkt(
+                    'POLYGON((%f %f,%f %f,%f %f,%f %f,%f %f))' %
+                    (minx, miny, minx, maxy, maxx, maxy, maxx, miny, minx, miny))):
+                expected_ids.append(f.GetField('ID'))
+        lyr.SetSpatialFilterRect(minx, miny, maxx, maxy)
+        got_ids = []
+        for f in lyr:
+            got_ids.append(f.GetField('ID'))
+        lyr.SetSpatialFilter(None)
+        missing_ids = set(expected_ids) - set(got_ids)
+        if len(expected_ids) == 0 or len(missing_ids) != 0:
+            gdaltest.post_reason('fail')
+            print(minx, miny, maxx, maxy, len(expected_ids), missing_ids)
+            return 'fail'
+    ds = None
+
+    gdaltest.mapinfo_drv.DeleteDataSource('/vsimem/ogr_mitab_44.tab')
+
+    return 'success'
+
 ###############################################################################
 #
 
@@ -2291,6 +2346,7 @@ gdaltest_list = [
     ogr_mitab_41,
     ogr_mitab_42,
     ogr_mitab_43,
+    ogr_mitab_44,
     ogr_mitab_cleanup
     ]
 
@@ -1110,6 +1110,14 @@ def get_spi_state(ds, lyr):
 
 def ogr_openfilegdb_11():
 
+    # The in-memory spatial index is only built for layers without .spx
+    gdal.SetConfigOption('OPENFILEGDB_USE_SPATIAL_INDEX', 'NO')
+    ret = ogr_openfilegdb_11_internal()
+    gdal.SetConfigOption('OPENFILEGDB_USE_SPATIAL_INDEX', None)
+    return ret
+
+def ogr_openfilegdb_11_internal():
+
     # Test building spatial index with GetFeatureCount()
     ds = ogr.Open('data/testopenfilegdb.gdb.zip')
     lyr = ds.GetLayerByName('several_polygons')
@@ -1427,6 +1435,68 @@ def ogr_openfilegdb_16():
 
     return 'success'
 
+###############################################################################
+# Test spatial filtering with the .spx spatial index
+
+def ogr_openfilegdb_17():
+
+    ds = ogr.Open('data/testopenfilegdb.gdb.zip')
+    for lyr_name in [ 'multipoint', 'linestring', 'multilinestring',
+                      'polygon', 'multipolygon', 'several_polygons' ]:
+        lyr = ds.GetLayerByName(lyr_name)
+        # The in-memory spatial index is not built when the .spx is used
+        if get_spi_state(ds, lyr) != SPI_INVALID:
+            gdaltest.post_reason('failure')
+            print(lyr_name)
+            return 'fail'
+
+        for (minx, miny, maxx, maxy) in [ (0.25,0.25,0.5,0.5),
+                                          (1.4,0.4,1.6,0.6),
+                                          (2.5,3.5,2.6,3.6),
+                                          (-10,-10,-5,-5),
+                                          (0.9,1.9,1.1,2.1) ]:
+            lyr.SetSpatialFilterRect(minx, miny, maxx, maxy)
+            fids = [ f.GetFID() for f in lyr ]
+            count = lyr.GetFeatureCount()
+
+            gdal.SetConfigOption('OPENFILEGDB_USE_SPATIAL_INDEX', 'NO')
+            gdal.SetConfigOption('OPENFILEGDB_IN_MEMORY_SPI', 'NO')
+            ds_ref = ogr.Open('data/testopenfilegdb.gdb.zip')
+            gdal.SetConfigOption('OPENFILEGDB_USE_SPATIAL_INDEX', None)
+            gdal.SetConfigOption('OPENFILEGDB_IN_MEMORY_SPI', None)
+            lyr_ref = ds_ref.GetLayerByName(lyr_name)
+            lyr_ref.SetSpatialFilterRect(minx, miny, maxx, maxy)
+            expected_fids = [ f.GetFID() for f in lyr_ref ]
+            ds_ref = None
+
+            if fids != expected_fids or count != len(expected_fids):
+                gdaltest.post_reason('failure')
+                print(lyr_name, minx, miny, maxx, maxy)
+                print(fids, expected_fids, count)
+                return 'fail'
+
+    # SetNextByIndex() with candidate rows from the spatial index
+    lyr = ds.GetLayerByName('several_polygons')
+    lyr.SetSpatialFilterRect(0.5,0.5,2.5,2.5)
+    fids = [ f.GetFID() for f in lyr ]
+    if len(fids) < 2:
+        gdaltest.post_reason('failure')
+        print(fids)
+        return 'fail'
+    if lyr.TestCapability(ogr.OLCFastSetNextByIndex) != 0:
+        gdaltest.post_reason('failure')
+        return 'fail'
+    if lyr.SetNextByIndex(1) != 0:
+        gdaltest.post_reason('failure')
+        return 'fail'
+    f = lyr.GetNextFeature()
+    if f.GetFID() != fids[1]:
+        gdaltest.post_reason('failure')
+        f.DumpReadable()
+        return 'fail'
+
+    return 'success'
+
 ###############################################################################
 # Cleanup
 
@@ -1474,6 +1544,7 @@ gdaltest_list = [
     ogr_openfilegdb_14,
     ogr_openfilegdb_15,
     ogr_openfilegdb_16,
+    ogr_openfilegdb_17,
     ogr_openfilegdb_cleanup,
     ]
 
@@ -326,6 +326,18 @@ def ogr_osm_3_sqlite_nodes():
 def ogr_osm_3_custom_compress_nodes():
     return ogr_osm_3(options = '--config OSM_COMPRESS_NODES YES')
 
+###############################################################################
+# Test ogr2ogr with flat node and way stores, entirely on disk
+
+def ogr_osm_3_flat_stores():
+    return ogr_osm_3(options = '--config OSM_FLAT_NODES YES --config OSM_FLAT_NODES_MAX_RAM 0 --config OSM_FLAT_WAYS YES --config OSM_FLAT_WAYS_MAX_RAM 0')
+
+###############################################################################
+# Test ogr2ogr with flat node and way stores in RAM
+
+def ogr_osm_3_flat_stores_ram():
+    return ogr_osm_3(options = '--config OSM_FLAT_NODES YES --config OSM_FLAT_WAYS YES')
+
 ###############################################################################
 # Test optimization when reading only the points layer through a SQL request
 
@@ -722,12 +734,67 @@ def ogr_osm_13():
 
     return 'success'
 
+###############################################################################
+# Test decoding PBF blocks with worker threads (NUM_THREADS open option)
+
+def ogr_osm_14():
+
+    if ogrtest.osm_drv is None:
+        return 'skip'
+
+    for filename in [ 'data/test.pbf',
+                      'data/test_uncompressed_dense_false.pbf' ]:
+        ds_ref = gdal.OpenEx(filename)
+        ds = gdal.OpenEx(filename, open_options = ['NUM_THREADS=4'])
+        for i in range(ds_ref.GetLayerCount()):
+            lyr_ref = ds_ref.GetLayer(i)
+            lyr = ds.GetLayer(i)
+            for iter in range(2):
+                lyr_ref.ResetReading()
+                lyr.ResetReading()
+                while True:
+                    f_ref = lyr_ref.GetNextFeature()
+                    f = lyr.GetNextFeature()
+                    if f_ref is None and f is None:
+                        break
+                    # Features of both datasets have distinct
+                    # OGRFeatureDefn, so Equal() cannot be used.
+                    ok = f_ref is not None and f is not None and \
+                         f.GetFID() == f_ref.GetFID() and \
+                         f.GetFieldCount() == f_ref.GetFieldCount()
+                    if ok:
+                        for j in range(f_ref.GetFieldCount()):
+                            if f.IsFieldSet(j) != f_ref.IsFieldSet(j) or \
+                               f.GetField(j) != f_ref.GetField(j):
+                                ok = False
+                                break
+                    if ok:
+                        if f_ref.GetGeometryRef() is None:
+                            ok = f.GetGeometryRef() is None
+                        else:
+                            ok = ogrtest.check_feature_geometry(
+                                f, f_ref.GetGeometryRef()) == 0
+                    if not ok:
+                        gdaltest.post_reason('fail')
+                        print(filename, lyr.GetName())
+                        if f is not None:
+                            f.DumpReadable()
+                        if f_ref is not None:
+                            f_ref.DumpReadable()
+                        return 'fail'
+        ds = None
+        ds_ref = None
+
+    return 'success'
+
 gdaltest_list = [
     ogr_osm_1,
     ogr_osm_2,
     ogr_osm_3,
     ogr_osm_3_sqlite_nodes,
     ogr_osm_3_custom_compress_nodes,
+    ogr_osm_3_flat_stores,
+    ogr_osm_3_flat_stores_ram,
     ogr_osm_4,
     ogr_osm_5,
     ogr_osm_6,
@@ -740,6 +807,7 @@ gdaltest_list = [
     ogr_osm_test_uncompressed_dense_true_nometadata_pbf,
     ogr_osm_test_uncompressed_dense_false_pbf,
     ogr_osm_13,
+    ogr_osm_14,
     ]
 
 if __name__ == '__main__':
@@ -30,6 +30,7 @@
 import os
 import sys
 import shutil
+import struct
 
 sys.path.append( '../pymod' )
 
@@ -5299,6 +5300,107 @@ def ogr_pg_85():
 
     return 'success'
 
+###############################################################################
+# Test binary COPY
+
+def ogr_pg_86():
+
+    if gdaltest.pg_ds is None or gdaltest.ogr_pg_second_run :
+        return 'skip'
+
+    srs = osr.SpatialReference()
+    srs.ImportFromEPSG(4326)
+    lyr = gdaltest.pg_ds.CreateLayer('ogr_pg_86', geom_type = ogr.wkbPoint, srs = srs)
+    lyr.CreateField(ogr.FieldDefn('int', ogr.OFTInteger))
+    fld = ogr.FieldDefn('bool', ogr.OFTInteger)
+    fld.SetSubType(ogr.OFSTBoolean)
+    lyr.CreateField(fld)
+    fld = ogr.FieldDefn('int16', ogr.OFTInteger)
+    fld.SetSubType(ogr.OFSTInt16)
+    lyr.CreateField(fld)
+    lyr.CreateField(ogr.FieldDefn('int64', ogr.OFTInteger64))
+    lyr.CreateField(ogr.FieldDefn('real', ogr.OFTReal))
+    fld = ogr.FieldDefn('numeric', ogr.OFTReal)
+    fld.SetWidth(12)
+    fld.SetPrecision(3)
+    lyr.CreateField(fld)
+    fld = ogr.FieldDefn('str', ogr.OFTString)
+    fld.SetWidth(4)
+    lyr.CreateField(fld)
+    lyr.CreateField(ogr.FieldDefn('date', ogr.OFTDate))
+    lyr.CreateField(ogr.FieldDefn('time', ogr.OFTTime))
+    lyr.CreateField(ogr.FieldDefn('intlist', ogr.OFTIntegerList))
+    lyr.CreateField(ogr.FieldDefn('int64list', ogr.OFTInteger64List))
+    lyr.CreateField(ogr.FieldDefn('reallist', ogr.OFTRealList))
+    lyr.CreateField(ogr.FieldDefn('strlist', ogr.OFTStringList))
+    lyr.CreateField(ogr.FieldDefn('binary', ogr.OFTBinary))
+    gdaltest.pg_ds.ExecuteSQL('SELECT 1') # make sure the layer is well created
+
+    old_copy = gdal.GetConfigOption('PG_USE_COPY')
+    gdal.SetConfigOption('PG_USE_COPY', 'YES')
+    gdal.SetConfigOption('PG_USE_BINARY_COPY', 'YES')
+    ds = ogr.Open( 'PG:' + gdaltest.pg_connection_string, update = 1 )
+    lyr = ds.GetLayerByName('ogr_pg_86')
+    for i in range(100):
+        f = ogr.Feature(lyr.GetLayerDefn())
+        if i % 10 != 0:
+            f.SetField('int', i)
+            f.SetField('bool', i % 2)
+            f.SetField('int16', -i)
+            f.SetField('int64', 1234567890123 * i)
+            f.SetField('real', 1.25 * i)
+            f.SetField('numeric', -12345.678 + i)
+            f.SetField('str', 'abc\t\\%d' % i)
+            f.SetField('date', '%04d/02/28' % (1900 + i))
+            f.SetField('time', '12:34:%02d' % (i % 60))
+            f.SetFieldIntegerList(lyr.GetLayerDefn().GetFieldIndex('intlist'), [i, -i])
+            f.SetFieldInteger64List(lyr.GetLayerDefn().GetFieldIndex('int64list'), [1234567890123 * i])
+            f.SetFieldDoubleList(lyr.GetLayerDefn().GetFieldIndex('reallist'), [0.5 * i, 1.5])
+            f.SetFieldStringList(lyr.GetLayerDefn().GetFieldIndex('strlist'), ['a,"b', 'c{%d}' % i])
+            f.SetFieldBinaryFromHexString('binary', '00FF%02X' % i)
+            f.SetGeometry(ogr.CreateGeometryFromWkt('POINT (%d %d)' % (i, -i)))
+        if lyr.CreateFeature(f) != 0:
+            gdaltest.post_reason('fail')
+            return 'fail'
+    ds = None
+    gdal.SetConfigOption('PG_USE_BINARY_COPY', None)
+    gdal.SetConfigOption('PG_USE_COPY', old_copy)
+
+    lyr = gdaltest.pg_ds.GetLayerByName('ogr_pg_86')
+    if lyr.GetFeatureCount() != 100:
+        gdaltest.post_reason('fail')
+        print(lyr.GetFeatureCount())
+        return 'fail'
+    lyr.SetAttributeFilter('int = 13')
+    f = lyr.GetNextFeature()
+    lyr.SetAttributeFilter(None)
+    if f.GetField('bool') != 1 or f.GetField('int16') != -13 or \
+       f.GetField('int64') != 1234567890123 * 13 or \
+       f.GetField('real') != 1.25 * 13 or \
+       abs(f.GetField('numeric') - (-12345.678 + 13)) > 1e-6 or \
+       f.GetField('str') != 'abc\t' or \
+       f.GetField('date') != '1913/02/28' or \
+       f.GetField('time') != '12:34:13' or \
+       f.GetField('intlist') != [13, -13] or \
+       f.GetField('int64list') != [1234567890123 * 13] or \
+       f.GetField('reallist') != [6.5, 1.5] or \
+       f.GetField('strlist') != ['a,"b', 'c{13}'] or \
+       f.GetFieldAsBinary('binary') != struct.pack('BBB', 0, 255, 13) or \
+       f.GetGeometryRef().ExportToWkt() != 'POINT (13 -13)' or \
+       f.GetGeometryRef().GetSpatialReference().GetAuthorityCode(None) != '4326':
+        gdaltest.post_reason('fail')
+        f.DumpReadable()
+        return 'fail'
+    lyr.SetAttributeFilter('int IS NULL')
+    f = lyr.GetNextFeature()
+    lyr.SetAttributeFilter(None)
+    if f.IsFieldSet('str') or f.IsFieldSet('intlist') or f.GetGeometryRef() is not None:
+        gdaltest.post_reason('fail')
+        f.DumpReadable()
+        return 'fail'
+
+    return 'success'
+
 ###############################################################################
 #
 
@@ -5365,6 +5467,7 @@ def ogr_pg_table_cleanup():
     gdaltest.pg_ds.ExecuteSQL( 'DELLAYER:ogr_pg_84' )
     gdaltest.pg_ds.ExecuteSQL( 'DELLAYER:ogr_pg_85_1' )
     gdaltest.pg_ds.ExecuteSQL( 'DELLAYER:ogr_pg_85_2' )
+    gdaltest.pg_ds.ExecuteSQL( 'DELLAYER:ogr_pg_86' )
 
     # Drop second 'tpoly' from schema 'AutoTest-schema' (do NOT quote names here)
     gdaltest.pg_ds.ExecuteSQL( 'DELLAYER:AutoTest-schema.tpoly' )
@@ -5482,6 +5585,7 @@ gdaltest_list_internal = [
     ogr_pg_83,
     ogr_pg_84,
     ogr_pg_85,
+    ogr_pg_86,
     ogr_pg_cleanup
 ]
 
@@ -4478,6 +4478,129 @@ def ogr_shape_97():
 
     return 'success'
 
+###############################################################################
+# Test reading attributes by batches (SHAPE_DBF_BATCH_READ)
+
+def ogr_shape_98():
+
+    ds = ogr.GetDriverByName('ESRI Shapefile').CreateDataSource('/vsimem/ogr_shape_98.shp')
+    lyr = ds.CreateLayer('ogr_shape_98', geom_type = ogr.wkbPoint)
+    lyr.CreateField(ogr.FieldDefn('int', ogr.OFTInteger))
+    lyr.CreateField(ogr.FieldDefn('int64', ogr.OFTInteger64))
+    lyr.CreateField(ogr.FieldDefn('real', ogr.OFTReal))
+    lyr.CreateField(ogr.FieldDefn('str', ogr.OFTString))
+    lyr.CreateField(ogr.FieldDefn('date', ogr.OFTDate))
+    # Enough records to span several batches
+    for i in range(12000):
+        f = ogr.Feature(lyr.GetLayerDefn())
+        if (i % 5) != 0:
+            f.SetField('int', i - 6000)
+            f.SetField('int64', (i - 6000) * 1234567890)
+            f.SetField('real', i / 7.0)
+            f.SetField('str', ' val %d ' % i)
+            f.SetField('date', '%04d/%02d/%02d' % (1900 + i % 200, 1 + i % 12, 1 + i % 28))
+        f.SetGeometry(ogr.CreateGeometryFromWkt('POINT(%d %d)' % (i, -i)))
+        lyr.CreateFeature(f)
+    for i in range(0, 12000, 1001):
+        lyr.DeleteFeature(i)
+    ds = None
+
+    def read_all(ignored_fields_at = -1):
+        ds = ogr.Open('/vsimem/ogr_shape_98.shp')
+        lyr = ds.GetLayer(0)
+        ret = []
+        for f in lyr:
+            if f.GetFID() == ignored_fields_at:
+                lyr.SetIgnoredFields(['str', 'real'])
+            if f.GetFID() == 2 * ignored_fields_at:
+                lyr.SetIgnoredFields([])
+            ret.append(f.ExportToJson())
+        lyr.SetNextByIndex(7000)
+        f = lyr.GetNextFeature()
+        ret.append(f.ExportToJson())
+        return ret
+
+    for ignored_fields_at in [ -1, 5000 ]:
+        gdal.SetConfigOption('SHAPE_DBF_BATCH_READ', 'NO')
+        ref = read_all(ignored_fields_at)
+        gdal.SetConfigOption('SHAPE_DBF_BATCH_READ', None)
+        got = read_all(ignored_fields_at)
+        if len(ref) != 12000 - 12 + 1 or got != ref:
+            gdaltest.post_reason('fail')
+            print(len(ref), len(got))
+            return 'fail'
+
+    ogr.GetDriverByName('ESRI Shapefile').DeleteDataSource('/vsimem/ogr_shape_98.shp')
+
+    return 'success'
+
+###############################################################################
+# Test that geometries decoded directly from the .shp records, and the
+# bounding box prefiltering, give the same results as through SHPObject
+
+def ogr_shape_99():
+
+    geoms = {
+        ogr.wkbPoint: [ 'POINT (%d %d)', 'POINT (%d.5 %d.5)' ],
+        ogr.wkbLineString: [ 'LINESTRING (%d %d,1 2,3 4)',
+                             'MULTILINESTRING ((%d %d,1 2),(5 6,7 8,9 10))' ],
+        ogr.wkbPolygon: [ 'POLYGON ((%d %d,%d 1,1 1,1 0,%d %d))',
+                          'MULTIPOLYGON (((0 0,0 10,10 10,10 0,0 0),(%d %d,2 1,1 1,1 2,%d %d)),((20 20,20 30,30 30,%d %d,20 20)))' ] }
+
+    for geom_type in geoms:
+        ds = ogr.GetDriverByName('ESRI Shapefile').CreateDataSource('/vsimem/ogr_shape_99.shp')
+        lyr = ds.CreateLayer('ogr_shape_99', geom_type = geom_type)
+        for i in range(1000):
+            f = ogr.Feature(lyr.GetLayerDefn())
+            if (i % 7) != 0:
+                wkt = geoms[geom_type][i % 2]
+                x = (i % 30) + 2
+                y = (i % 40) + 2
+                if geom_type == ogr.wkbPolygon:
+                    if i % 2 == 0:
+                        wkt = wkt % (x, y, x, x, y)
+                    else:
+                        wkt = wkt % (x % 8 + 1, y % 8 + 1, x % 8 + 1, y % 8 + 1, x % 8 + 21, y % 8 + 21)
+                else:
+                    wkt = wkt % (x, y)
+                f.SetGeometry(ogr.CreateGeometryFromWkt(wkt))
+            lyr.CreateFeature(f)
+        ds = None
+
+        def read_all(spatial_filter = None):
+            ds = ogr.Open('/vsimem/ogr_shape_99.shp')
+            lyr = ds.GetLayer(0)
+            if spatial_filter is not None:
+                lyr.SetSpatialFilterRect(spatial_filter[0], spatial_filter[1],
+                                         spatial_filter[2], spatial_filter[3])
+            ret = []
+            for f in lyr:
+                ret.append(f.ExportToJson())
+            ret.append(lyr.GetFeature(999).ExportToJson())
+            return ret
+
+        for spatial_filter in [ None, [ 5, 5, 15, 25 ], [ 100, 100, 200, 200 ] ]:
+            gdal.SetConfigOption('SHAPE_DIRECT_GEOM_READ', 'NO')
+            ref = read_all(spatial_filter)
+            gdal.SetConfigOption('SHAPE_DIRECT_GEOM_READ', None)
+            got = read_all(spatial_filter)
+            if got != ref:
+                gdaltest.post_reason('fail')
+                print(geom_type, spatial_filter, len(ref), len(got))
+                return 'fail'
+            if spatial_filter is None and len(ref) != 1000 + 1:
+                gdaltest.post_reason('fail')
+                print(geom_type, len(ref))
+                return 'fail'
+            if spatial_filter == [ 100, 100, 200, 200 ] and len(ref) != 1:
+                gdaltest.post_reason('fail')
+                print(geom_type, len(ref))
+                return 'fail'
+
+        ogr.GetDriverByName('ESRI Shapefile').DeleteDataSource('/vsimem/ogr_shape_99.shp')
+
+    return 'success'
+
 ###############################################################################
 #
 
@@ -4619,6 +4742,8 @@ gdaltest_list = [
     ogr_shape_95,
     ogr_shape_96,
     ogr_shape_97,
+    ogr_shape_98,
+    ogr_shape_99,
     ogr_shape_cleanup ]
 
 #gdaltest_list = [ ogr_shape_94 ]
@@ -76,6 +76,39 @@ def test_gdal_fillnodata_2():
 
     return 'success'
 
+###############################################################################
+# Check that the result does not depend on the number of threads, and that
+# the transform search fills the same pixels.
+
+def test_gdal_fillnodata_3():
+
+    src_ds = gdal.Open('../gcore/data/byte.tif')
+    data = src_ds.ReadRaster()
+    src_ds = None
+
+    cs = []
+    for options in [ ['NUM_THREADS=1'], ['NUM_THREADS=4'],
+                     ['SEARCH=TRANSFORM', 'NUM_THREADS=4'] ]:
+        ds = gdal.GetDriverByName('MEM').Create('', 20, 20)
+        ds.WriteRaster(0, 0, 20, 20, data)
+        band = ds.GetRasterBand(1)
+        band.SetNoDataValue(0)
+        band.WriteRaster(2, 3, 10, 12, '\x00' * (10 * 12))
+        band.WriteRaster(15, 0, 5, 20, '\x00' * (5 * 20))
+        gdal.FillNodata(band, None, 0, 2, options)
+        if band.GetMaskBand().Checksum() != 4873:
+            gdaltest.post_reason('fail')
+            print(options)
+            return 'fail'
+        cs.append(band.Checksum())
+        ds = None
+
+    if cs[0] != 4473 or cs[1] != 4473:
+        gdaltest.post_reason('fail')
+        print(cs)
+        return 'fail'
+
+    return 'success'
 
 ###############################################################################
 # Cleanup
@@ -94,6 +127,7 @@ def test_gdal_fillnodata_cleanup():
 gdaltest_list = [
     test_gdal_fillnodata_1,
     test_gdal_fillnodata_2,
+    test_gdal_fillnodata_3,
     test_gdal_fillnodata_cleanup
     ]
 
@@ -400,6 +400,107 @@ def test_gdal_contour_5():
     else:
         return 'success'
 
+###############################################################################
+# Test -p option (contour polygons)
+
+def test_gdal_contour_6():
+    if test_cli_utilities.get_gdal_contour_path() is None:
+        return 'skip'
+
+    try:
+        os.stat('tmp/contour_polygons.shp')
+        ogr.GetDriverByName('ESRI Shapefile').DeleteDataSource('tmp/contour_polygons.shp')
+    except:
+        pass
+
+    gdaltest.runexternal(test_cli_utilities.get_gdal_contour_path() + ' -p -amin elev_min -amax elev_max -i 10 ../gdrivers/data/n43.dt0 tmp/contour_polygons.shp')
+
+    src_ds = gdal.Open('../gdrivers/data/n43.dt0')
+    gt = src_ds.GetGeoTransform()
+    expected_area = src_ds.RasterXSize * gt[1] * src_ds.RasterYSize * -gt[5]
+    src_ds = None
+
+    ds = ogr.Open('tmp/contour_polygons.shp')
+    lyr = ds.GetLayer(0)
+    if lyr.GetGeomType() != ogr.wkbPolygon:
+        print(lyr.GetGeomType())
+        return 'fail'
+
+    area = 0
+    feat = lyr.GetNextFeature()
+    while feat is not None:
+        if feat.GetField('elev_max') - feat.GetField('elev_min') > 10 + 1e-8:
+            feat.DumpReadable()
+            return 'fail'
+        area = area + feat.GetGeometryRef().GetArea()
+        feat = lyr.GetNextFeature()
+    ds = None
+
+    if abs(area - expected_area) > 1e-6 * expected_area:
+        print('Got area %.12g. Expected %.12g' % (area, expected_area))
+        return 'fail'
+
+    return 'success'
+
+###############################################################################
+# Test that a multi-threaded run gives the same lines as a single threaded one
+
+def test_gdal_contour_7():
+    if test_cli_utilities.get_gdal_contour_path() is None:
+        return 'skip'
+
+    # The second run has nodata areas with lines ending on strip boundaries
+    for options in [ '', '-snodata 75' ]:
+
+        for filename in [ 'tmp/contour_mt.shp', 'tmp/contour_st.shp' ]:
+            try:
+                os.stat(filename)
+                ogr.GetDriverByName('ESRI Shapefile').DeleteDataSource(filename)
+            except:
+                pass
+
+        gdaltest.runexternal(test_cli_utilities.get_gdal_contour_path() + ' --config GDAL_NUM_THREADS 4 -a elev -i 10 ' + options + ' ../gdrivers/data/n43.dt0 tmp/contour_mt.shp')
+        gdaltest.runexternal(test_cli_utilities.get_gdal_contour_path() + ' -a elev -i 10 ' + options + ' ../gdrivers/data/n43.dt0 tmp/contour_st.shp')
+
+        # Count features and sum line lengths per level (OGR SQL has no
+        # GROUP BY)
+        stats = []
+        for filename in [ 'tmp/contour_mt.shp', 'tmp/contour_st.shp' ]:
+            ds = ogr.Open(filename)
+            lyr = ds.GetLayer(0)
+            dict_stats = {}
+            feat = lyr.GetNextFeature()
+            while feat is not None:
+                elev = feat.GetField('elev')
+                (count, length) = dict_stats.get(elev, (0, 0.0))
+                dict_stats[elev] = (count + 1,
+                                    length + feat.GetGeometryRef().Length())
+                feat = lyr.GetNextFeature()
+            ds = None
+            stats.append(dict_stats)
+        (stats_mt, stats_st) = stats
+
+        ret = 'success'
+        if sorted(stats_mt.keys()) != sorted(stats_st.keys()):
+            print(options)
+            print(sorted(stats_mt.keys()), sorted(stats_st.keys()))
+            ret = 'fail'
+        else:
+            for elev in sorted(stats_st.keys()):
+                (count_mt, length_mt) = stats_mt[elev]
+                (count_st, length_st) = stats_st[elev]
+                if count_mt != count_st or \
+                   abs(length_mt - length_st) > 1e-10 * length_st:
+                    print(options)
+                    print(elev, count_mt, count_st, length_mt, length_st)
+                    ret = 'fail'
+                    break
+
+        if ret != 'success':
+            return ret
+
+    return 'success'
+
 ###############################################################################
 # Cleanup
 
@@ -410,6 +511,9 @@ def test_gdal_contour_cleanup():
     ogr.GetDriverByName('ESRI Shapefile').DeleteDataSource('tmp/contour.shp')
     ogr.GetDriverByName('ESRI Shapefile').DeleteDataSource('tmp/contour_orientation1.shp')
     ogr.GetDriverByName('ESRI Shapefile').DeleteDataSource('tmp/contour_orientation2.shp')
+    ogr.GetDriverByName('ESRI Shapefile').DeleteDataSource('tmp/contour_polygons.shp')
+    ogr.GetDriverByName('ESRI Shapefile').DeleteDataSource('tmp/contour_mt.shp')
+    ogr.GetDriverByName('ESRI Shapefile').DeleteDataSource('tmp/contour_st.shp')
     try:
         os.remove('tmp/gdal_contour.tif')
         os.remove('tmp/gdal_contour_orientation.tif')
@@ -425,6 +529,8 @@ gdaltest_list = [
     test_gdal_contour_3,
     test_gdal_contour_4,
     test_gdal_contour_5,
+    test_gdal_contour_6,
+    test_gdal_contour_7,
     test_gdal_contour_cleanup
     ]
 
@@ -907,6 +907,70 @@ def test_gdal_grid_12():
 
     return 'success'
 
+###############################################################################
+# Test that the point index gives the same results as scanning all points
+
+def test_gdal_grid_13():
+    if gdal_grid is None:
+        return 'skip'
+
+    #################
+    # Nearest point without search ellipse (searched with the point index)
+    # versus nearest point in a search ellipse that covers all the points.
+    outfiles.append('tmp/grid_nearest_index.tif')
+    gdaltest.runexternal(gdal_grid + ' -txe 440721.0 441920.0 -tye 3751321.0 3750120.0 -outsize 20 20 -ot Float64 -l grid -a nearest:radius1=0.0:radius2=0.0:angle=0.0:nodata=0.0 data/grid.vrt ' + outfiles[-1])
+    outfiles.append('tmp/grid_nearest_noindex.tif')
+    gdaltest.runexternal(gdal_grid + ' -txe 440721.0 441920.0 -tye 3751321.0 3750120.0 -outsize 20 20 -ot Float64 -l grid -a nearest:radius1=100000.0:radius2=100000.0:angle=0.0:nodata=0.0 data/grid.vrt ' + outfiles[-1])
+
+    ds = gdal.Open(outfiles[-2])
+    ds_ref = gdal.Open(outfiles[-1])
+    maxdiff = gdaltest.compare_ds(ds, ds_ref, verbose = 0)
+    if maxdiff != 0:
+        gdaltest.compare_ds(ds, ds_ref, verbose = 1)
+        gdaltest.post_reason('Image too different from the reference')
+        return 'fail'
+    ds_ref = None
+    ds = None
+
+    #################
+    # Search circle without AVX: same values as in
+    # "ref_data/grid_invdist_90_90_8p.tif"
+    outfiles.append('tmp/grid_invdist_90_90_8p_noavx.tif')
+    gdaltest.runexternal(gdal_grid + ' --config GDAL_USE_AVX NO -txe 440721.0 441920.0 -tye 3751321.0 3750120.0 -outsize 20 20 -ot Float64 -l grid -a invdist:power=2.0:radius1=90.0:radius2=90.0:angle=0.0:max_points=0:min_points=8:nodata=0.0 data/grid.vrt ' + outfiles[-1])
+
+    ds = gdal.Open(outfiles[-1])
+    ds_ref = gdal.Open('ref_data/grid_invdist_90_90_8p.tif')
+    maxdiff = gdaltest.compare_ds(ds, ds_ref, verbose = 0)
+    if maxdiff > 0.00001:
+        gdaltest.compare_ds(ds, ds_ref, verbose = 1)
+        gdaltest.post_reason('Image too different from the reference')
+        return 'fail'
+    ds_ref = None
+    ds = None
+
+    #################
+    # invdistnn without distance limit: the max_points nearest points are used
+    outfiles.append('tmp/grid_invdistnn_nolimit.tif')
+    gdaltest.runexternal(gdal_grid + ' -txe 440721.0 441920.0 -tye 3751321.0 3750120.0 -outsize 20 20 -ot Float64 -l grid -a invdistnn:power=2.0:radius=0.0:max_points=12:min_points=12:nodata=0.0 data/grid.vrt ' + outfiles[-1])
+    outfiles.append('tmp/grid_invdistnn_100000.tif')
+    gdaltest.runexternal(gdal_grid + ' -txe 440721.0 441920.0 -tye 3751321.0 3750120.0 -outsize 20 20 -ot Float64 -l grid -a invdistnn:power=2.0:radius=100000.0:max_points=12:min_points=12:nodata=0.0 data/grid.vrt ' + outfiles[-1])
+
+    ds = gdal.Open(outfiles[-2])
+    ds_ref = gdal.Open(outfiles[-1])
+    maxdiff = gdaltest.compare_ds(ds, ds_ref, verbose = 0)
+    if maxdiff != 0:
+        gdaltest.compare_ds(ds, ds_ref, verbose = 1)
+        gdaltest.post_reason('Image too different from the reference')
+        return 'fail'
+    # All nodes have 12 points, so none should be nodata
+    if ds.GetRasterBand(1).ComputeRasterMinMax()[0] <= 0:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    ds_ref = None
+    ds = None
+
+    return 'success'
+
 ###############################################################################
 # Cleanup
 
@@ -932,6 +996,7 @@ gdaltest_list = [
     test_gdal_grid_10,
     test_gdal_grid_11,
     test_gdal_grid_12,
+    test_gdal_grid_13,
     test_gdal_grid_cleanup
     ]
 
@@ -149,9 +149,50 @@ def test_gdal_rasterize_lib_3():
 
     return 'success'
 
+###############################################################################
+# Test that burning tiles in parallel gives the same result as a single thread
+
+def test_gdal_rasterize_lib_4():
+
+    vector_ds = gdal.GetDriverByName('Memory').Create( '', 0, 0, 0 )
+    lyr = vector_ds.CreateLayer('lyr')
+    lyr.CreateField(ogr.FieldDefn('val', ogr.OFTReal))
+    for i in range(100):
+        x = (i * 37) % 100
+        y = (i * 61) % 200
+        r = 3 + (i * 13) % 40
+        if i % 3 == 0:
+            wkt = 'POLYGON ((%d %d,%d %d,%d %d,%d %d))' % (x, -y, x + r, -y - r / 3, x + r / 2, -y - r, x, -y)
+        elif i % 3 == 1:
+            wkt = 'LINESTRING (%d %d,%f %f,%d %d)' % (x, -y, x + r / 3.0, -y - r, x + r, -y - r / 2)
+        else:
+            wkt = 'MULTIPOINT ((%f %f),(%f %f))' % (x + 0.5, -y - 0.5, x + r + 0.5, -y - 0.5)
+        feat = ogr.Feature(lyr.GetLayerDefn())
+        feat.SetField('val', 1 + i % 5)
+        feat.SetGeometry(ogr.CreateGeometryFromWkt(wkt))
+        lyr.CreateFeature(feat)
+
+    for options in [ '', '-at', '-add', '-at -add' ]:
+        cs = []
+        for num_threads in [ '1', '4' ]:
+            gdal.SetConfigOption('GDAL_NUM_THREADS', num_threads)
+            ds = gdal.Rasterize('', vector_ds, options = '-of MEM -ot Byte '
+                                '-te 0 -200 100 0 -ts 100 200 -a val ' + options)
+            gdal.SetConfigOption('GDAL_NUM_THREADS', None)
+            cs.append(ds.GetRasterBand(1).Checksum())
+            ds = None
+        if cs[0] != cs[1] or cs[0] == 0:
+            gdaltest.post_reason('fail')
+            print(options)
+            print(cs)
+            return 'fail'
+
+    return 'success'
+
 gdaltest_list = [
     test_gdal_rasterize_lib_1,
     test_gdal_rasterize_lib_3,
+    test_gdal_rasterize_lib_4,
     ]
 
 if __name__ == '__main__':
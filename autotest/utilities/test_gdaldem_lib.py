@@ -164,6 +164,36 @@ def test_gdaldem_lib_hillshade_azimuth():
 
     return 'success'
 
+###############################################################################
+# Test gdaldem with several threads
+
+def test_gdaldem_lib_multithreaded():
+
+    src_ds = gdal.Open('../gdrivers/data/n43.dt0')
+
+    gdal.SetConfigOption('GDAL_NUM_THREADS', '4')
+    ds = gdal.DEMProcessing('', src_ds, 'hillshade', format = 'MEM', computeEdges = True, scale = 111120, zFactor = 30)
+    ds_slope = gdal.DEMProcessing('', src_ds, 'slope', format = 'MEM', scale = 111120)
+    gdal.SetConfigOption('GDAL_NUM_THREADS', None)
+
+    cs = ds.GetRasterBand(1).Checksum()
+    if cs != 50239:
+        gdaltest.post_reason('Bad checksum')
+        print(cs)
+        return 'fail'
+
+    cs = ds_slope.GetRasterBand(1).Checksum()
+    if cs != 63748:
+        gdaltest.post_reason('Bad checksum')
+        print(cs)
+        return 'fail'
+
+    src_ds = None
+    ds = None
+    ds_slope = None
+
+    return 'success'
+
 ###############################################################################
 # Test gdaldem color relief
 
@@ -211,6 +241,7 @@ gdaltest_list = [
     test_gdaldem_lib_hillshade_combined,
     test_gdaldem_lib_hillshade_compute_edges,
     test_gdaldem_lib_hillshade_azimuth,
+    test_gdaldem_lib_multithreaded,
     test_gdaldem_lib_color_relief
     ]
 
@@ -32,6 +32,12 @@
 #include "gdal_priv.h"
 #include "gdal_alg.h"
 #include "ogr_api.h"
+#include "ogr_geometry.h"
+#include "cpl_worker_thread_pool.h"
+
+#include <algorithm>
+#include <map>
+#include <vector>
 
 CPL_CVSID("$Id$");
 
@@ -97,6 +103,104 @@ public:
     int    InsertContour( GDALContourItem * );
 };
 
+/************************************************************************/
+/*                      GDALContourPolygonBuilder                       */
+/*                                                                      */
+/*      Cuts each rect handled by the generator into pieces along the   */
+/*      contour segments generated in it, and accumulates the piece     */
+/*      outlines as directed edges per elevation band.  Edges shared    */
+/*      by two pieces of the same band cancel out, so only the band     */
+/*      boundaries survive.                                             */
+/************************************************************************/
+
+typedef struct
+{
+    double dfX;
+    double dfY;
+    double dfValue;
+} GDALContourVertex;
+
+typedef struct
+{
+    double dfLevel;
+    double dfX1;
+    double dfY1;
+    double dfX2;
+    double dfY2;
+} GDALContourChord;
+
+struct GDALContourEdge
+{
+    int    nBand;
+    double dfX1;
+    double dfY1;
+    double dfX2;
+    double dfY2;
+
+    bool operator<( const GDALContourEdge& other ) const
+    {
+        if( nBand != other.nBand ) return nBand < other.nBand;
+        if( dfX1 != other.dfX1 ) return dfX1 < other.dfX1;
+        if( dfY1 != other.dfY1 ) return dfY1 < other.dfY1;
+        if( dfX2 != other.dfX2 ) return dfX2 < other.dfX2;
+        return dfY2 < other.dfY2;
+    }
+};
+
+class GDALContourPolygonBuilder
+{
+    int     bFixedLevels;
+    double  dfContourInterval;
+    double  dfContourOffset;
+    std::vector<double> adfFixedLevels;
+
+    // Edges along rect outlines, waiting for the neighbouring rect to
+    // cancel them, and edges along contour segments that never cancel.
+    // Side edges of the current and previous rects, most of which
+    // cancel out right away against each other.
+    std::vector<GDALContourEdge> asRectEdges;
+    std::vector<GDALContourEdge> asLastRectEdges;
+
+    std::vector<GDALContourEdge> asSideSlots;
+    std::vector<bool>            abSideSlotUsed;
+    size_t                       nSideEdges;
+    std::vector<GDALContourEdge> asChordEdges;
+
+    std::vector<GDALContourVertex> asVertices;
+    std::vector<GDALContourChord>  asChords;
+    std::vector<double>            adfLevels;
+    std::vector< std::vector<int> > aanPieces;
+
+    void   AddCrossings( GDALContourVertex sFrom, GDALContourVertex sTo );
+    int    FindVertex( double dfLevel, double dfX, double dfY );
+    bool   OnSameSide( const int *panCorners, int i, int j );
+    void   AddPiece( const std::vector<int>& anPiece );
+    size_t GetSideSlot( const GDALContourEdge& sEdge ) const;
+    void   AddSideEdge( const GDALContourEdge& sEdge );
+    void   GrowSideSlots();
+    void   CancelRectEdges();
+    void   FlushRectEdges();
+
+public:
+    GDALContourPolygonBuilder( double dfContourIntervalIn,
+                               double dfContourOffsetIn,
+                               int nFixedLevelCount,
+                               const double *padfFixedLevels );
+
+    int    GetBand( double dfValue ) const;
+    void   GetBandRange( int nBand, double dfDataMin, double dfDataMax,
+                         double *pdfLow, double *pdfHigh ) const;
+
+    void   AddChord( double dfLevel, double dfX1, double dfY1,
+                     double dfX2, double dfY2 );
+    void   AddRect( const double *padfValues,
+                    const double *padfX, const double *padfY );
+    void   Merge( GDALContourPolygonBuilder *poOther );
+    CPLErr WritePolygons( OGRContourWriterInfo *psInfo,
+                          int iElevFieldMin, int iElevFieldMax,
+                          double dfDataMin, double dfDataMax );
+};
+
 /************************************************************************/
 /*                         GDALContourGenerator                         */
 /************************************************************************/
@@ -120,15 +224,23 @@ class GDALContourGenerator
     double  dfContourInterval;
     double  dfContourOffset;
 
+    GDALContourPolygonBuilder *poPolygonBuilder;
+
     CPLErr AddSegment( double dfLevel,
                        double dfXStart, double dfYStart,
                        double dfXEnd, double dfYEnd, int bLeftHigh );
 
+    void   FudgeLine( double *padfLine );
+
     CPLErr ProcessPixel( int iPixel );
     CPLErr ProcessRect( double, double, double,
                         double, double, double,
                         double, double, double,
                         double, double, double );
+    CPLErr ProcessRectLevels( double, double, double,
+                              double, double, double,
+                              double, double, double,
+                              double, double, double );
 
     void   Intersect( double, double, double,
                       double, double, double,
@@ -153,6 +265,10 @@ public:
           dfContourOffset = dfContourOffsetIn; }
 
     void                SetFixedLevels( int, double * );
+    void                SetPolygonBuilder( GDALContourPolygonBuilder *poB )
+        { poPolygonBuilder = poB; }
+    void                SetStartLine( int iStartLine,
+                                      const double *padfPrevScanline );
     CPLErr              FeedLine( double *padfScanline );
     CPLErr              EjectContours( int bOnlyUnused = FALSE );
 
@@ -234,6 +350,8 @@ GDALContourGenerator::GDALContourGenerator( int nWidthIn, int nHeightIn,
     nLevelCount = 0;
     papoLevels = NULL;
     bFixedLevels = FALSE;
+
+    poPolygonBuilder = NULL;
 }
 
 /************************************************************************/
@@ -288,6 +406,47 @@ void GDALContourGenerator::SetNoData( double dfNewValue )
     dfNoDataValue = dfNewValue;
 }
 
+/************************************************************************/
+/*                            SetStartLine()                            */
+/*                                                                      */
+/*      Position the generator so that the next scanline fed is line    */
+/*      iStartLine, padfPrevScanline holding line iStartLine-1.  This   */
+/*      allows a band to be contoured as independent strips.            */
+/************************************************************************/
+
+void GDALContourGenerator::SetStartLine( int iStartLine,
+                                         const double *padfPrevScanline )
+
+{
+    memcpy( padfThisLine, padfPrevScanline, sizeof(double) * nWidth );
+    FudgeLine( padfThisLine );
+    iLine = iStartLine;
+}
+
+/************************************************************************/
+/*                             FudgeLine()                              */
+/*                                                                      */
+/*      Perturb any values that occur exactly on level boundaries.      */
+/************************************************************************/
+
+void GDALContourGenerator::FudgeLine( double *padfLine )
+
+{
+    for( int iPixel = 0; iPixel < nWidth; iPixel++ )
+    {
+        if( bNoDataActive && padfLine[iPixel] == dfNoDataValue )
+            continue;
+
+        double dfLevel = (padfLine[iPixel] - dfContourOffset)
+            / dfContourInterval;
+
+        if( dfLevel - (int) dfLevel == 0.0 )
+        {
+            padfLine[iPixel] += dfContourInterval * FUDGE_EXACT;
+        }
+    }
+}
+
 /************************************************************************/
 /*                            ProcessPixel()                            */
 /************************************************************************/
@@ -455,6 +614,37 @@ CPLErr GDALContourGenerator::ProcessRect(
     double dfLoRight, double dfLoRightX, double dfLoRightY,
     double dfUpRight, double dfUpRightX, double dfUpRightY )
 
+{
+    CPLErr eErr = ProcessRectLevels( dfUpLeft, dfUpLeftX, dfUpLeftY,
+                                     dfLoLeft, dfLoLeftX, dfLoLeftY,
+                                     dfLoRight, dfLoRightX, dfLoRightY,
+                                     dfUpRight, dfUpRightX, dfUpRightY );
+
+    if( eErr == CE_None && poPolygonBuilder != NULL )
+    {
+        const double adfValues[4] = { dfUpLeft, dfLoLeft,
+                                      dfLoRight, dfUpRight };
+        const double adfX[4] = { dfUpLeftX, dfLoLeftX,
+                                 dfLoRightX, dfUpRightX };
+        const double adfY[4] = { dfUpLeftY, dfLoLeftY,
+                                 dfLoRightY, dfUpRightY };
+
+        poPolygonBuilder->AddRect( adfValues, adfX, adfY );
+    }
+
+    return eErr;
+}
+
+/************************************************************************/
+/*                         ProcessRectLevels()                          */
+/************************************************************************/
+
+CPLErr GDALContourGenerator::ProcessRectLevels(
+    double dfUpLeft, double dfUpLeftX, double dfUpLeftY,
+    double dfLoLeft, double dfLoLeftX, double dfLoLeftY,
+    double dfLoRight, double dfLoRightX, double dfLoRightY,
+    double dfUpRight, double dfUpRightX, double dfUpRightY )
+
 {
 /* -------------------------------------------------------------------- */
 /*      Identify the range of elevations over this rect.                */
@@ -690,6 +880,9 @@ CPLErr GDALContourGenerator::AddSegment( double dfLevel,
     GDALContourItem *poTarget;
     int iTarget;
 
+    if( poPolygonBuilder != NULL )
+        poPolygonBuilder->AddChord( dfLevel, dfX1, dfY1, dfX2, dfY2 );
+
 /* -------------------------------------------------------------------- */
 /*      Check all active contours for any that this might attach        */
 /*      to. Eventually this should be recoded to find the contours      */
@@ -755,21 +948,7 @@ CPLErr GDALContourGenerator::FeedLine( double *padfScanline )
 /* -------------------------------------------------------------------- */
 /*      Perturb any values that occur exactly on level boundaries.      */
 /* -------------------------------------------------------------------- */
-    int iPixel;
-
-    for( iPixel = 0; iPixel < nWidth; iPixel++ )
-    {
-        if( bNoDataActive && padfThisLine[iPixel] == dfNoDataValue )
-            continue;
-
-        double dfLevel = (padfThisLine[iPixel] - dfContourOffset)
-            / dfContourInterval;
-
-        if( dfLevel - (int) dfLevel == 0.0 )
-        {
-            padfThisLine[iPixel] += dfContourInterval * FUDGE_EXACT;
-        }
-    }
+    FudgeLine( padfThisLine );
 
 /* -------------------------------------------------------------------- */
 /*      If this is the first line we need to initialize the previous    */
@@ -798,7 +977,7 @@ CPLErr GDALContourGenerator::FeedLine( double *padfScanline )
 /* -------------------------------------------------------------------- */
 /*      Process each pixel.                                             */
 /* -------------------------------------------------------------------- */
-    for( iPixel = 0; iPixel < nWidth+1; iPixel++ )
+    for( int iPixel = 0; iPixel < nWidth+1; iPixel++ )
     {
         CPLErr eErr = ProcessPixel( iPixel );
         if( eErr != CE_None )
@@ -1353,155 +1532,1010 @@ void GDALContourItem::PrepareEjection()
 
 /************************************************************************/
 /* ==================================================================== */
-/*                   Additional C Callable Functions                    */
+/*                      GDALContourPolygonBuilder                       */
 /* ==================================================================== */
 /************************************************************************/
 
 /************************************************************************/
-/*                          OGRContourWriter()                          */
+/*                     GDALContourPolygonBuilder()                      */
 /************************************************************************/
 
-CPLErr OGRContourWriter( double dfLevel,
-                         int nPoints, double *padfX, double *padfY,
-                         void *pInfo )
+GDALContourPolygonBuilder::GDALContourPolygonBuilder(
+    double dfContourIntervalIn, double dfContourOffsetIn,
+    int nFixedLevelCount, const double *padfFixedLevels )
 
 {
-    OGRContourWriterInfo *poInfo = (OGRContourWriterInfo *) pInfo;
-    OGRFeatureH hFeat;
-    OGRGeometryH hGeom;
-    int iPoint;
+    bFixedLevels = nFixedLevelCount > 0;
+    dfContourInterval = dfContourIntervalIn;
+    dfContourOffset = dfContourOffsetIn;
+    nSideEdges = 0;
+    asSideSlots.resize( 4096 );
+    abSideSlotUsed.resize( 4096, false );
 
-    hFeat = OGR_F_Create( OGR_L_GetLayerDefn( (OGRLayerH) poInfo->hLayer ) );
+    if( bFixedLevels )
+    {
+        adfFixedLevels.assign( padfFixedLevels,
+                               padfFixedLevels + nFixedLevelCount );
+        std::sort( adfFixedLevels.begin(), adfFixedLevels.end() );
+        adfFixedLevels.erase( std::unique( adfFixedLevels.begin(),
+                                           adfFixedLevels.end() ),
+                              adfFixedLevels.end() );
+    }
+}
 
-    if( poInfo->nIDField != -1 )
-        OGR_F_SetFieldInteger( hFeat, poInfo->nIDField, poInfo->nNextID++ );
+/************************************************************************/
+/*                              GetBand()                               */
+/*                                                                      */
+/*      Band n lies between level n-1 and level n.                      */
+/************************************************************************/
 
-    if( poInfo->nElevField != -1 )
-        OGR_F_SetFieldDouble( hFeat, poInfo->nElevField, dfLevel );
+int GDALContourPolygonBuilder::GetBand( double dfValue ) const
 
-    hGeom = OGR_G_CreateGeometry( wkbLineString );
+{
+    if( bFixedLevels )
+        return (int) (std::upper_bound( adfFixedLevels.begin(),
+                                        adfFixedLevels.end(), dfValue )
+                      - adfFixedLevels.begin());
 
-    for( iPoint = nPoints-1; iPoint >= 0; iPoint-- )
+    return (int) floor( (dfValue - dfContourOffset) / dfContourInterval );
+}
+
+/************************************************************************/
+/*                            GetBandRange()                            */
+/************************************************************************/
+
+void GDALContourPolygonBuilder::GetBandRange( int nBand,
+                                              double dfDataMin,
+                                              double dfDataMax,
+                                              double *pdfLow,
+                                              double *pdfHigh ) const
+
+{
+    if( bFixedLevels )
     {
-        OGR_G_SetPoint( hGeom, iPoint,
-                        poInfo->adfGeoTransform[0]
-                        + poInfo->adfGeoTransform[1] * padfX[iPoint]
-                        + poInfo->adfGeoTransform[2] * padfY[iPoint],
-                        poInfo->adfGeoTransform[3]
-                        + poInfo->adfGeoTransform[4] * padfX[iPoint]
-                        + poInfo->adfGeoTransform[5] * padfY[iPoint],
-                        dfLevel );
+        *pdfLow = nBand == 0 ? dfDataMin : adfFixedLevels[nBand-1];
+        *pdfHigh = nBand == (int) adfFixedLevels.size() ?
+            dfDataMax : adfFixedLevels[nBand];
+    }
+    else
+    {
+        *pdfLow = nBand * dfContourInterval + dfContourOffset;
+        *pdfHigh = (nBand + 1) * dfContourInterval + dfContourOffset;
     }
+}
 
-    OGR_F_SetGeometryDirectly( hFeat, hGeom );
+/************************************************************************/
+/*                              AddChord()                              */
+/*                                                                      */
+/*      Record a contour segment of the rect currently processed.       */
+/************************************************************************/
 
-    OGRErr eErr = OGR_L_CreateFeature( (OGRLayerH) poInfo->hLayer, hFeat );
-    OGR_F_Destroy( hFeat );
+void GDALContourPolygonBuilder::AddChord( double dfLevel,
+                                          double dfX1, double dfY1,
+                                          double dfX2, double dfY2 )
 
-    return (eErr == OGRERR_NONE) ? CE_None : CE_Failure;
+{
+    GDALContourChord sChord;
+
+    sChord.dfLevel = dfLevel;
+    sChord.dfX1 = dfX1;
+    sChord.dfY1 = dfY1;
+    sChord.dfX2 = dfX2;
+    sChord.dfY2 = dfY2;
+    asChords.push_back( sChord );
 }
 
+/************************************************************************/
+/*                            AddCrossings()                            */
+/*                                                                      */
+/*      Append the level crossings strictly between two vertices.       */
+/*      They are always computed walking from the top-left end, so      */
+/*      that both rects sharing the side get bit identical points.      */
+/************************************************************************/
+
+void GDALContourPolygonBuilder::AddCrossings( GDALContourVertex sFrom,
+                                              GDALContourVertex sTo )
+
+{
+    const bool bSwap = sFrom.dfY > sTo.dfY
+        || (sFrom.dfY == sTo.dfY && sFrom.dfX > sTo.dfX);
+    const GDALContourVertex &sA = bSwap ? sTo : sFrom;
+    const GDALContourVertex &sB = bSwap ? sFrom : sTo;
+
+    const double dfLow = MIN(sA.dfValue, sB.dfValue);
+    const double dfHigh = MAX(sA.dfValue, sB.dfValue);
+
+    if( !(dfLow < dfHigh) )
+        return;
+
+    adfLevels.resize( 0 );
+    if( bFixedLevels )
+    {
+        std::vector<double>::const_iterator oIter =
+            std::upper_bound( adfFixedLevels.begin(), adfFixedLevels.end(),
+                              dfLow );
+        for( ; oIter != adfFixedLevels.end() && *oIter < dfHigh; ++oIter )
+            adfLevels.push_back( *oIter );
+    }
+    else
+    {
+        const int iStartLevel = (int)
+            ceil((dfLow - dfContourOffset) / dfContourInterval);
+        const int iEndLevel = (int)
+            floor((dfHigh - dfContourOffset) / dfContourInterval);
+
+        for( int iLevel = iStartLevel; iLevel <= iEndLevel; iLevel++ )
+        {
+            const double dfLevel =
+                iLevel * dfContourInterval + dfContourOffset;
+            if( dfLevel > dfLow && dfLevel < dfHigh )
+                adfLevels.push_back( dfLevel );
+        }
+    }
+
+    // Levels are ascending: they come in walking order if the value
+    // increases from sFrom to sTo.
+    const bool bReverse = (sTo.dfValue < sFrom.dfValue);
+    const int nLevels = (int) adfLevels.size();
+
+    for( int i = 0; i < nLevels; i++ )
+    {
+        const double dfLevel = adfLevels[bReverse ? nLevels - 1 - i : i];
+        const double dfRatio =
+            (dfLevel - sA.dfValue) / (sB.dfValue - sA.dfValue);
+        GDALContourVertex sVertex;
+
+        sVertex.dfX = sA.dfX + dfRatio * (sB.dfX - sA.dfX);
+        sVertex.dfY = sA.dfY + dfRatio * (sB.dfY - sA.dfY);
+        sVertex.dfValue = dfLevel;
+        asVertices.push_back( sVertex );
+    }
+}
 
 /************************************************************************/
-/*                        GDALContourGenerate()                         */
+/*                             FindVertex()                             */
+/*                                                                      */
+/*      Find the rect outline vertex at the given level nearest to      */
+/*      a contour segment end.                                          */
 /************************************************************************/
 
-/**
- * Create vector contours from raster DEM.
- *
- * This algorithm will generate contour vectors for the input raster band
- * on the requested set of contour levels.  The vector contours are written
- * to the passed in OGR vector layer.  Also, a NODATA value may be specified
- * to identify pixels that should not be considered in contour line generation.
- *
- * The gdal/apps/gdal_contour.cpp mainline can be used as an example of
- * how to use this function.
- *
- * ALGORITHM RULES
+int GDALContourPolygonBuilder::FindVertex( double dfLevel,
+                                           double dfX, double dfY )
 
-For contouring purposes raster pixel values are assumed to represent a point
-value at the center of the corresponding pixel region.  For the purpose of
-contour generation we virtually connect each pixel center to the values to
-the left, right, top and bottom.  We assume that the pixel value is linearly
-interpolated between the pixel centers along each line, and determine where
-(if any) contour lines will appear along these line segments.  Then the
-contour crossings are connected.
+{
+    int iBest = -1;
+    double dfBestDist = 0.0;
 
-This means that contour lines' nodes will not actually be on pixel edges, but
-rather along vertical and horizontal lines connecting the pixel centers.
+    for( int i = 0; i < (int) asVertices.size(); i++ )
+    {
+        if( asVertices[i].dfValue != dfLevel )
+            continue;
 
-\verbatim
-General Case:
+        const double dfDX = asVertices[i].dfX - dfX;
+        const double dfDY = asVertices[i].dfY - dfY;
+        const double dfDist = dfDX * dfDX + dfDY * dfDY;
 
-      5 |                  | 3
-     -- + ---------------- + --
-        |                  |
-        |                  |
-        |                  |
-        |                  |
-     10 +                  |
-        |\                 |
-        | \                |
-     -- + -+-------------- + --
-     12 |  10              | 1
+        if( iBest < 0 || dfDist < dfBestDist )
+        {
+            iBest = i;
+            dfBestDist = dfDist;
+        }
+    }
 
+    return iBest;
+}
 
-Saddle Point:
+/************************************************************************/
+/*                             OnSameSide()                             */
+/************************************************************************/
 
-      5 |                  | 12
-     -- + -------------+-- + --
-        |               \  |
-        |                 \|
-        |                  +
-        |                  |
-        +                  |
-        |\                 |
-        | \                |
-     -- + -+-------------- + --
-     12 |                  | 1
+bool GDALContourPolygonBuilder::OnSameSide( const int *panCorners,
+                                            int i, int j )
 
-or:
+{
+    const int nVertices = (int) asVertices.size();
 
-      5 |                  | 12
-     -- + -------------+-- + --
-        |          __/     |
-        |      ___/        |
-        |  ___/          __+
-        | /           __/  |
-        +'         __/     |
-        |       __/        |
-        |   ,__/           |
-     -- + -+-------------- + --
-     12 |                  | 1
-\endverbatim
+    for( int iSide = 0; iSide < 4; iSide++ )
+    {
+        const int nStart = panCorners[iSide];
+        const int nEnd = iSide == 3 ? nVertices : panCorners[iSide+1];
 
-Nodata:
+        // The closing corner of the last side is vertex 0.
+        const bool bIIn = (i >= nStart && i <= nEnd)
+            || (iSide == 3 && i == 0);
+        const bool bJIn = (j >= nStart && j <= nEnd)
+            || (iSide == 3 && j == 0);
 
-In the "nodata" case we treat the whole nodata pixel as a no-mans land.
-We extend the corner pixels near the nodata out to half way and then
-construct extra lines from those points to the center which is assigned
-an averaged value from the two nearby points (in this case (12+3+5)/3).
+        if( bIIn && bJIn )
+            return true;
+    }
 
-\verbatim
-      5 |                  | 3
-     -- + ---------------- + --
-        |                  |
-        |                  |
-        |      6.7         |
-        |        +---------+ 3
-     10 +___     |
-        |   \____+ 10
-        |        |
-     -- + -------+        +
-     12 |       12           (nodata)
+    return false;
+}
 
-\endverbatim
+/************************************************************************/
+/*                            GetSideSlot()                             */
+/*                                                                      */
+/*      Home slot of an edge in the side edge hash table.  The hash     */
+/*      does not depend on the edge direction, so that an edge and      */
+/*      its reverse land in the same probe sequence.                    */
+/************************************************************************/
 
- *
- * @param hBand The band to read raster data from.  The whole band will be
- * processed.
- *
- * @param dfContourInterval The elevation interval between contours generated.
+static GUIntBig GDALContourHashPoint( double dfX, double dfY )
+
+{
+    GUIntBig nX, nY;
+
+    memcpy( &nX, &dfX, sizeof(nX) );
+    memcpy( &nY, &dfY, sizeof(nY) );
+
+    const GUIntBig nMul1 = ((GUIntBig) 0x9E3779B9U << 32) | 0x7F4A7C15U;
+    const GUIntBig nMul2 = ((GUIntBig) 0xBF58476DU << 32) | 0x1CE4E5B9U;
+
+    const GUIntBig nHash = (nX ^ (nY * nMul1)) * nMul2;
+    return nHash ^ (nHash >> 31);
+}
+
+size_t GDALContourPolygonBuilder::GetSideSlot(
+    const GDALContourEdge& sEdge ) const
+
+{
+    GUIntBig nHash = GDALContourHashPoint( sEdge.dfX1, sEdge.dfY1 )
+        + GDALContourHashPoint( sEdge.dfX2, sEdge.dfY2 )
+        + (GUIntBig) sEdge.nBand;
+
+    nHash = (nHash ^ (nHash >> 29))
+        * (((GUIntBig) 0x94D049BBU << 32) | 0x133111EBU);
+    return (size_t) (nHash >> 32) & (asSideSlots.size() - 1);
+}
+
+/************************************************************************/
+/*                           GrowSideSlots()                            */
+/************************************************************************/
+
+void GDALContourPolygonBuilder::GrowSideSlots()
+
+{
+    std::vector<GDALContourEdge> asOldSlots;
+    std::vector<bool> abOldUsed;
+
+    asOldSlots.swap( asSideSlots );
+    abOldUsed.swap( abSideSlotUsed );
+
+    asSideSlots.resize( asOldSlots.size() * 2 );
+    abSideSlotUsed.resize( asOldSlots.size() * 2, false );
+    nSideEdges = 0;
+
+    for( size_t i = 0; i < asOldSlots.size(); i++ )
+    {
+        if( abOldUsed[i] )
+            AddSideEdge( asOldSlots[i] );
+    }
+}
+
+/************************************************************************/
+/*                            AddSideEdge()                             */
+/*                                                                      */
+/*      Add a directed rect side edge, or cancel it against the         */
+/*      reverse edge added by the neighbouring rect.  Only the          */
+/*      outline of the area processed so far stays in the table.        */
+/************************************************************************/
+
+void GDALContourPolygonBuilder::AddSideEdge( const GDALContourEdge& sEdge )
+
+{
+    if( sEdge.dfX1 == sEdge.dfX2 && sEdge.dfY1 == sEdge.dfY2 )
+        return;
+
+    const size_t nMask = asSideSlots.size() - 1;
+    size_t iSlot = GetSideSlot( sEdge );
+
+    while( abSideSlotUsed[iSlot] )
+    {
+        const GDALContourEdge &sOther = asSideSlots[iSlot];
+
+        if( sOther.nBand == sEdge.nBand
+            && sOther.dfX1 == sEdge.dfX2 && sOther.dfY1 == sEdge.dfY2
+            && sOther.dfX2 == sEdge.dfX1 && sOther.dfY2 == sEdge.dfY1 )
+            break;
+        iSlot = (iSlot + 1) & nMask;
+    }
+
+    if( !abSideSlotUsed[iSlot] )
+    {
+        asSideSlots[iSlot] = sEdge;
+        abSideSlotUsed[iSlot] = true;
+        nSideEdges++;
+        if( nSideEdges * 2 > asSideSlots.size() )
+            GrowSideSlots();
+        return;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Remove the reverse edge, shifting back the following entries    */
+/*      of the probe sequence that would no longer be reachable.        */
+/* -------------------------------------------------------------------- */
+    nSideEdges--;
+    size_t iNext = iSlot;
+    while( true )
+    {
+        iNext = (iNext + 1) & nMask;
+        if( !abSideSlotUsed[iNext] )
+            break;
+
+        const size_t iHome = GetSideSlot( asSideSlots[iNext] );
+        const bool bMove = iSlot <= iNext ?
+            (iHome <= iSlot || iHome > iNext) :
+            (iHome <= iSlot && iHome > iNext);
+        if( bMove )
+        {
+            asSideSlots[iSlot] = asSideSlots[iNext];
+            iSlot = iNext;
+        }
+    }
+    abSideSlotUsed[iSlot] = false;
+}
+
+/************************************************************************/
+/*                              AddPiece()                              */
+/************************************************************************/
+
+void GDALContourPolygonBuilder::AddPiece( const std::vector<int>& anPiece )
+
+{
+    const int nCount = (int) anPiece.size();
+    double dfMin = asVertices[anPiece[0]].dfValue;
+    double dfMax = dfMin;
+
+    for( int i = 1; i < nCount; i++ )
+    {
+        dfMin = MIN(dfMin, asVertices[anPiece[i]].dfValue);
+        dfMax = MAX(dfMax, asVertices[anPiece[i]].dfValue);
+    }
+
+    GDALContourEdge sEdge;
+
+    sEdge.nBand = GetBand( (dfMin + dfMax) / 2.0 );
+
+    const int nVertices = (int) asVertices.size();
+
+    for( int i = 0; i < nCount; i++ )
+    {
+        const int iFrom = anPiece[i];
+        const int iTo = anPiece[(i+1) % nCount];
+        const GDALContourVertex &sFrom = asVertices[iFrom];
+        const GDALContourVertex &sTo = asVertices[iTo];
+
+        sEdge.dfX1 = sFrom.dfX;
+        sEdge.dfY1 = sFrom.dfY;
+        sEdge.dfX2 = sTo.dfX;
+        sEdge.dfY2 = sTo.dfY;
+
+        // Consecutive outline vertices make a side edge, anything else
+        // is a contour segment.
+        if( iTo == (iFrom + 1) % nVertices )
+            asRectEdges.push_back( sEdge );
+        else
+            asChordEdges.push_back( sEdge );
+    }
+}
+
+/************************************************************************/
+/*                              AddRect()                               */
+/*                                                                      */
+/*      The corners are passed in outline order: upper left, lower      */
+/*      left, lower right, upper right.  Sides a full pixel long get    */
+/*      a vertex at their middle, matching the half sides of the        */
+/*      subdivided nodata rects that may share them.                    */
+/************************************************************************/
+
+void GDALContourPolygonBuilder::AddRect( const double *padfValues,
+                                         const double *padfX,
+                                         const double *padfY )
+
+{
+    int anCorners[4];
+
+    asVertices.resize( 0 );
+
+/* -------------------------------------------------------------------- */
+/*      Most rects lie within a single band: no level crosses their     */
+/*      outline, which is output as is.                                 */
+/* -------------------------------------------------------------------- */
+    if( asChords.empty() )
+    {
+        const double dfMin = MIN(MIN(padfValues[0], padfValues[1]),
+                                 MIN(padfValues[2], padfValues[3]));
+        const double dfMax = MAX(MAX(padfValues[0], padfValues[1]),
+                                 MAX(padfValues[2], padfValues[3]));
+        const int nBand = GetBand( dfMin );
+
+        if( GetBand( dfMax ) == nBand )
+        {
+            for( int iSide = 0; iSide < 4; iSide++ )
+            {
+                GDALContourVertex sVertex;
+
+                sVertex.dfX = padfX[iSide];
+                sVertex.dfY = padfY[iSide];
+                sVertex.dfValue = padfValues[iSide];
+                asVertices.push_back( sVertex );
+
+                const int iNext = (iSide + 1) % 4;
+                if( fabs(padfX[iNext] - padfX[iSide])
+                    + fabs(padfY[iNext] - padfY[iSide]) == 1.0 )
+                {
+                    sVertex.dfX = (padfX[iSide] + padfX[iNext]) / 2.0;
+                    sVertex.dfY = (padfY[iSide] + padfY[iNext]) / 2.0;
+                    asVertices.push_back( sVertex );
+                }
+            }
+
+            aanPieces.resize( 1 );
+            aanPieces[0].resize( asVertices.size() );
+            for( int i = 0; i < (int) asVertices.size(); i++ )
+                aanPieces[0][i] = i;
+            AddPiece( aanPieces[0] );
+
+            CancelRectEdges();
+            return;
+        }
+    }
+
+    for( int iSide = 0; iSide < 4; iSide++ )
+    {
+        const int iNext = (iSide + 1) % 4;
+        GDALContourVertex sCorner, sNext;
+
+        sCorner.dfX = padfX[iSide];
+        sCorner.dfY = padfY[iSide];
+        sCorner.dfValue = padfValues[iSide];
+        sNext.dfX = padfX[iNext];
+        sNext.dfY = padfY[iNext];
+        sNext.dfValue = padfValues[iNext];
+
+        anCorners[iSide] = (int) asVertices.size();
+        asVertices.push_back( sCorner );
+
+        if( fabs(sNext.dfX - sCorner.dfX)
+            + fabs(sNext.dfY - sCorner.dfY) == 1.0 )
+        {
+            GDALContourVertex sMiddle;
+
+            sMiddle.dfX = (sCorner.dfX + sNext.dfX) / 2.0;
+            sMiddle.dfY = (sCorner.dfY + sNext.dfY) / 2.0;
+            sMiddle.dfValue = (sCorner.dfValue + sNext.dfValue) / 2.0;
+
+            AddCrossings( sCorner, sMiddle );
+            asVertices.push_back( sMiddle );
+            AddCrossings( sMiddle, sNext );
+        }
+        else
+        {
+            AddCrossings( sCorner, sNext );
+        }
+    }
+
+    const int nVertices = (int) asVertices.size();
+
+    aanPieces.resize( 1 );
+    aanPieces[0].resize( nVertices );
+    for( int i = 0; i < nVertices; i++ )
+        aanPieces[0][i] = i;
+
+/* -------------------------------------------------------------------- */
+/*      Split the outline along each contour segment.  Segments never   */
+/*      cross, so each one cuts exactly one of the current pieces.      */
+/* -------------------------------------------------------------------- */
+    for( size_t iChord = 0; iChord < asChords.size(); iChord++ )
+    {
+        const GDALContourChord &sChord = asChords[iChord];
+        const int i = FindVertex( sChord.dfLevel, sChord.dfX1, sChord.dfY1 );
+        const int j = FindVertex( sChord.dfLevel, sChord.dfX2, sChord.dfY2 );
+
+        if( i < 0 || j < 0 || i == j || OnSameSide( anCorners, i, j ) )
+            continue;
+
+        for( size_t iPiece = 0; iPiece < aanPieces.size(); iPiece++ )
+        {
+            std::vector<int> &anPiece = aanPieces[iPiece];
+            const int nCount = (int) anPiece.size();
+            const int iPos = (int) (std::find( anPiece.begin(),
+                                               anPiece.end(), i )
+                                    - anPiece.begin());
+            const int jPos = (int) (std::find( anPiece.begin(),
+                                               anPiece.end(), j )
+                                    - anPiece.begin());
+
+            if( iPos == nCount || jPos == nCount )
+                continue;
+            if( abs(iPos - jPos) == 1 || abs(iPos - jPos) == nCount - 1 )
+                break;
+
+            std::vector<int> anFirst, anSecond;
+            for( int k = iPos; k != jPos; k = (k + 1) % nCount )
+                anFirst.push_back( anPiece[k] );
+            anFirst.push_back( anPiece[jPos] );
+            for( int k = jPos; k != iPos; k = (k + 1) % nCount )
+                anSecond.push_back( anPiece[k] );
+            anSecond.push_back( anPiece[iPos] );
+
+            anPiece.swap( anFirst );
+            aanPieces.push_back( anSecond );
+            break;
+        }
+    }
+
+    for( size_t iPiece = 0; iPiece < aanPieces.size(); iPiece++ )
+        AddPiece( aanPieces[iPiece] );
+
+    asChords.resize( 0 );
+
+    CancelRectEdges();
+}
+
+/************************************************************************/
+/*                          CancelRectEdges()                           */
+/*                                                                      */
+/*      Cancel the sides shared with the previous rect, which is        */
+/*      usually the left neighbour, and queue the others.               */
+/************************************************************************/
+
+void GDALContourPolygonBuilder::CancelRectEdges()
+
+{
+    size_t nKept = 0;
+
+    for( size_t i = 0; i < asRectEdges.size(); i++ )
+    {
+        const GDALContourEdge &sEdge = asRectEdges[i];
+        size_t j = 0;
+
+        for( ; j < asLastRectEdges.size(); j++ )
+        {
+            const GDALContourEdge &sOther = asLastRectEdges[j];
+
+            if( sOther.nBand == sEdge.nBand
+                && sOther.dfX1 == sEdge.dfX2 && sOther.dfY1 == sEdge.dfY2
+                && sOther.dfX2 == sEdge.dfX1 && sOther.dfY2 == sEdge.dfY1 )
+                break;
+        }
+
+        if( j < asLastRectEdges.size() )
+        {
+            asLastRectEdges[j] = asLastRectEdges.back();
+            asLastRectEdges.pop_back();
+        }
+        else
+            asRectEdges[nKept++] = sEdge;
+    }
+    asRectEdges.resize( nKept );
+
+    FlushRectEdges();
+    asLastRectEdges.swap( asRectEdges );
+}
+
+/************************************************************************/
+/*                           FlushRectEdges()                           */
+/************************************************************************/
+
+void GDALContourPolygonBuilder::FlushRectEdges()
+
+{
+    for( size_t i = 0; i < asLastRectEdges.size(); i++ )
+        AddSideEdge( asLastRectEdges[i] );
+    asLastRectEdges.resize( 0 );
+}
+
+/************************************************************************/
+/*                               Merge()                                */
+/*                                                                      */
+/*      Absorb the edges of another builder, typically the one of the   */
+/*      neighbouring strip, cancelling the edges along the seam.        */
+/************************************************************************/
+
+void GDALContourPolygonBuilder::Merge( GDALContourPolygonBuilder *poOther )
+
+{
+    FlushRectEdges();
+    poOther->FlushRectEdges();
+
+    for( size_t i = 0; i < poOther->asSideSlots.size(); i++ )
+    {
+        if( poOther->abSideSlotUsed[i] )
+            AddSideEdge( poOther->asSideSlots[i] );
+    }
+    poOther->asSideSlots.clear();
+    poOther->abSideSlotUsed.clear();
+    poOther->nSideEdges = 0;
+
+    asChordEdges.insert( asChordEdges.end(), poOther->asChordEdges.begin(),
+                         poOther->asChordEdges.end() );
+    poOther->asChordEdges.clear();
+}
+
+/************************************************************************/
+/*                       GDALContourEdgeStartLess                       */
+/************************************************************************/
+
+struct GDALContourEdgeStartLess
+{
+    bool operator()( const GDALContourEdge& a,
+                     const GDALContourEdge& b ) const
+    {
+        if( a.nBand != b.nBand ) return a.nBand < b.nBand;
+        if( a.dfX1 != b.dfX1 ) return a.dfX1 < b.dfX1;
+        return a.dfY1 < b.dfY1;
+    }
+};
+
+/************************************************************************/
+/*                           WritePolygons()                            */
+/*                                                                      */
+/*      Chain the remaining edges into rings and write one              */
+/*      multipolygon feature per band.  Rect outlines run clockwise     */
+/*      in pixel space (y pointing down), so rings with a negative      */
+/*      signed area are outer rings and the others are holes.          */
+/************************************************************************/
+
+CPLErr GDALContourPolygonBuilder::WritePolygons( OGRContourWriterInfo *psInfo,
+                                                 int iElevFieldMin,
+                                                 int iElevFieldMax,
+                                                 double dfDataMin,
+                                                 double dfDataMax )
+
+{
+    std::vector<GDALContourEdge> asEdges;
+
+    FlushRectEdges();
+    asEdges.swap( asChordEdges );
+    for( size_t i = 0; i < asSideSlots.size(); i++ )
+    {
+        if( abSideSlotUsed[i] )
+            asEdges.push_back( asSideSlots[i] );
+    }
+    std::sort( asEdges.begin(), asEdges.end() );
+
+    std::vector<bool> abUsed( asEdges.size(), false );
+    const double *padfGT = psInfo->adfGeoTransform;
+    CPLErr eErr = CE_None;
+
+    size_t iBandStart = 0;
+    while( iBandStart < asEdges.size() && eErr == CE_None )
+    {
+        const int nBand = asEdges[iBandStart].nBand;
+        size_t iBandEnd = iBandStart;
+        while( iBandEnd < asEdges.size() && asEdges[iBandEnd].nBand == nBand )
+            iBandEnd++;
+
+        std::vector<OGRGeometry*> apoRings;
+
+        for( size_t iEdge = iBandStart; iEdge < iBandEnd; iEdge++ )
+        {
+            if( abUsed[iEdge] )
+                continue;
+
+/* -------------------------------------------------------------------- */
+/*      Walk a ring.  Where several edges leave a vertex, take the      */
+/*      sharpest turn so that rings touching at a point stay apart.     */
+/* -------------------------------------------------------------------- */
+            std::vector<double> adfX, adfY;
+            size_t iCur = iEdge;
+            bool bClosed = false;
+
+            adfX.push_back( asEdges[iCur].dfX1 );
+            adfY.push_back( asEdges[iCur].dfY1 );
+
+            while( true )
+            {
+                const GDALContourEdge &sCur = asEdges[iCur];
+                abUsed[iCur] = true;
+
+                if( sCur.dfX2 == adfX[0] && sCur.dfY2 == adfY[0] )
+                {
+                    bClosed = true;
+                    break;
+                }
+                adfX.push_back( sCur.dfX2 );
+                adfY.push_back( sCur.dfY2 );
+
+                GDALContourEdge sKey;
+                sKey.nBand = nBand;
+                sKey.dfX1 = sCur.dfX2;
+                sKey.dfY1 = sCur.dfY2;
+                sKey.dfX2 = 0.0;
+                sKey.dfY2 = 0.0;
+
+                const double dfBackAngle =
+                    atan2( sCur.dfY1 - sCur.dfY2, sCur.dfX1 - sCur.dfX2 );
+                size_t iNext = asEdges.size();
+                double dfBestTurn = 0.0;
+
+                for( size_t iCand = std::lower_bound(
+                                        asEdges.begin() + iBandStart,
+                                        asEdges.begin() + iBandEnd, sKey,
+                                        GDALContourEdgeStartLess() )
+                                    - asEdges.begin();
+                     iCand < iBandEnd
+                         && asEdges[iCand].dfX1 == sKey.dfX1
+                         && asEdges[iCand].dfY1 == sKey.dfY1;
+                     iCand++ )
+                {
+                    if( abUsed[iCand] )
+                        continue;
+
+                    double dfTurn = atan2( asEdges[iCand].dfY2 - sKey.dfY1,
+                                           asEdges[iCand].dfX2 - sKey.dfX1 )
+                        - dfBackAngle;
+                    while( dfTurn <= 0.0 )
+                        dfTurn += 2 * M_PI;
+
+                    if( iNext == asEdges.size() || dfTurn < dfBestTurn )
+                    {
+                        iNext = iCand;
+                        dfBestTurn = dfTurn;
+                    }
+                }
+
+                if( iNext == asEdges.size() )
+                    break;
+                iCur = iNext;
+            }
+
+            if( !bClosed )
+            {
+                CPLDebug( "CONTOUR", "Dropping unclosed ring in band %d.",
+                          nBand );
+                continue;
+            }
+
+/* -------------------------------------------------------------------- */
+/*      Drop the vertices lying on straight runs, such as the many      */
+/*      pixel edges along the raster border.                            */
+/* -------------------------------------------------------------------- */
+            std::vector<double> adfOutX, adfOutY;
+            const int nCount = (int) adfX.size();
+
+            for( int i = 0; i < nCount; i++ )
+            {
+                const int iPrev = (i + nCount - 1) % nCount;
+                const int iNextVtx = (i + 1) % nCount;
+                const double dfCross =
+                    (adfX[i] - adfX[iPrev]) * (adfY[iNextVtx] - adfY[i])
+                    - (adfY[i] - adfY[iPrev]) * (adfX[iNextVtx] - adfX[i]);
+
+                if( dfCross != 0.0 )
+                {
+                    adfOutX.push_back( adfX[i] );
+                    adfOutY.push_back( adfY[i] );
+                }
+            }
+
+            const int nOut = (int) adfOutX.size();
+            if( nOut < 3 )
+                continue;
+
+            double dfArea = 0.0;
+            for( int i = 0; i < nOut; i++ )
+            {
+                const int iNextVtx = (i + 1) % nOut;
+                dfArea += adfOutX[i] * adfOutY[iNextVtx]
+                    - adfOutX[iNextVtx] * adfOutY[i];
+            }
+            const bool bOuter = dfArea < 0.0;
+
+            OGRLinearRing *poRing = new OGRLinearRing();
+            poRing->setNumPoints( nOut + 1 );
+            for( int i = 0; i <= nOut; i++ )
+            {
+                const double dfX = adfOutX[i % nOut];
+                const double dfY = adfOutY[i % nOut];
+
+                poRing->setPoint( i,
+                                  padfGT[0] + padfGT[1] * dfX
+                                  + padfGT[2] * dfY,
+                                  padfGT[3] + padfGT[4] * dfX
+                                  + padfGT[5] * dfY );
+            }
+
+            // organizePolygons() expects clockwise outer rings.
+            if( CPL_TO_BOOL(poRing->isClockwise()) != bOuter )
+                poRing->reversePoints();
+
+            OGRPolygon *poPoly = new OGRPolygon();
+            poPoly->addRingDirectly( poRing );
+            apoRings.push_back( poPoly );
+        }
+
+        if( !apoRings.empty() )
+        {
+            const char *apszOptions[] = { "METHOD=ONLY_CCW", NULL };
+            int bIsValid = FALSE;
+            OGRGeometry *poGeom = OGRGeometryFactory::organizePolygons(
+                &apoRings[0], (int) apoRings.size(), &bIsValid,
+                apszOptions );
+            poGeom = OGRGeometryFactory::forceToMultiPolygon( poGeom );
+
+            double dfLow, dfHigh;
+            GetBandRange( nBand, dfDataMin, dfDataMax, &dfLow, &dfHigh );
+
+            OGRFeatureH hFeat = OGR_F_Create(
+                OGR_L_GetLayerDefn( (OGRLayerH) psInfo->hLayer ) );
+
+            if( psInfo->nIDField != -1 )
+                OGR_F_SetFieldInteger( hFeat, psInfo->nIDField,
+                                       psInfo->nNextID++ );
+            if( iElevFieldMin != -1 )
+                OGR_F_SetFieldDouble( hFeat, iElevFieldMin, dfLow );
+            if( iElevFieldMax != -1 )
+                OGR_F_SetFieldDouble( hFeat, iElevFieldMax, dfHigh );
+
+            OGR_F_SetGeometryDirectly( hFeat, (OGRGeometryH) poGeom );
+
+            if( OGR_L_CreateFeature( (OGRLayerH) psInfo->hLayer, hFeat )
+                != OGRERR_NONE )
+                eErr = CE_Failure;
+            OGR_F_Destroy( hFeat );
+        }
+
+        iBandStart = iBandEnd;
+    }
+
+    return eErr;
+}
+
+
+/************************************************************************/
+/* ==================================================================== */
+/*                   Additional C Callable Functions                    */
+/* ==================================================================== */
+/************************************************************************/
+
+/************************************************************************/
+/*                          OGRContourWriter()                          */
+/************************************************************************/
+
+CPLErr OGRContourWriter( double dfLevel,
+                         int nPoints, double *padfX, double *padfY,
+                         void *pInfo )
+
+{
+    OGRContourWriterInfo *poInfo = (OGRContourWriterInfo *) pInfo;
+    OGRFeatureH hFeat;
+    OGRGeometryH hGeom;
+    int iPoint;
+
+    hFeat = OGR_F_Create( OGR_L_GetLayerDefn( (OGRLayerH) poInfo->hLayer ) );
+
+    if( poInfo->nIDField != -1 )
+        OGR_F_SetFieldInteger( hFeat, poInfo->nIDField, poInfo->nNextID++ );
+
+    if( poInfo->nElevField != -1 )
+        OGR_F_SetFieldDouble( hFeat, poInfo->nElevField, dfLevel );
+
+    hGeom = OGR_G_CreateGeometry( wkbLineString );
+
+    for( iPoint = nPoints-1; iPoint >= 0; iPoint-- )
+    {
+        OGR_G_SetPoint( hGeom, iPoint,
+                        poInfo->adfGeoTransform[0]
+                        + poInfo->adfGeoTransform[1] * padfX[iPoint]
+                        + poInfo->adfGeoTransform[2] * padfY[iPoint],
+                        poInfo->adfGeoTransform[3]
+                        + poInfo->adfGeoTransform[4] * padfX[iPoint]
+                        + poInfo->adfGeoTransform[5] * padfY[iPoint],
+                        dfLevel );
+    }
+
+    OGR_F_SetGeometryDirectly( hFeat, hGeom );
+
+    OGRErr eErr = OGR_L_CreateFeature( (OGRLayerH) poInfo->hLayer, hFeat );
+    OGR_F_Destroy( hFeat );
+
+    return (eErr == OGRERR_NONE) ? CE_None : CE_Failure;
+}
+
+
+/************************************************************************/
+/*                        GDALContourGenerate()                         */
+/************************************************************************/
+
+/**
+ * Create vector contours from raster DEM.
+ *
+ * This algorithm will generate contour vectors for the input raster band
+ * on the requested set of contour levels.  The vector contours are written
+ * to the passed in OGR vector layer.  Also, a NODATA value may be specified
+ * to identify pixels that should not be considered in contour line generation.
+ *
+ * The gdal/apps/gdal_contour.cpp mainline can be used as an example of
+ * how to use this function.
+ *
+ * ALGORITHM RULES
+
+For contouring purposes raster pixel values are assumed to represent a point
+value at the center of the corresponding pixel region.  For the purpose of
+contour generation we virtually connect each pixel center to the values to
+the left, right, top and bottom.  We assume that the pixel value is linearly
+interpolated between the pixel centers along each line, and determine where
+(if any) contour lines will appear along these line segments.  Then the
+contour crossings are connected.
+
+This means that contour lines' nodes will not actually be on pixel edges, but
+rather along vertical and horizontal lines connecting the pixel centers.
+
+\verbatim
+General Case:
+
+      5 |                  | 3
+     -- + ---------------- + --
+        |                  |
+        |                  |
+        |                  |
+        |                  |
+     10 +                  |
+        |\                 |
+        | \                |
+     -- + -+-------------- + --
+     12 |  10              | 1
+
+
+Saddle Point:
+
+      5 |                  | 12
+     -- + -------------+-- + --
+        |               \  |
+        |                 \|
+        |                  +
+        |                  |
+        +                  |
+        |\                 |
+        | \                |
+     -- + -+-------------- + --
+     12 |                  | 1
+
+or:
+
+      5 |                  | 12
+     -- + -------------+-- + --
+        |          __/     |
+        |      ___/        |
+        |  ___/          __+
+        | /           __/  |
+        +'         __/     |
+        |       __/        |
+        |   ,__/           |
+     -- + -+-------------- + --
+     12 |                  | 1
+\endverbatim
+
+Nodata:
+
+In the "nodata" case we treat the whole nodata pixel as a no-mans land.
+We extend the corner pixels near the nodata out to half way and then
+construct extra lines from those points to the center which is assigned
+an averaged value from the two nearby points (in this case (12+3+5)/3).
+
+\verbatim
+      5 |                  | 3
+     -- + ---------------- + --
+        |                  |
+        |                  |
+        |      6.7         |
+        |        +---------+ 3
+     10 +___     |
+        |   \____+ 10
+        |        |
+     -- + -------+        +
+     12 |       12           (nodata)
+
+\endverbatim
+
+ *
+ * @param hBand The band to read raster data from.  The whole band will be
+ * processed.
+ *
+ * @param dfContourInterval The elevation interval between contours generated.
  *
  * @param dfContourBase The "base" relative to which contour intervals are
  * applied.  This is normally zero, but could be different.  To generate 10m
@@ -1634,3 +2668,652 @@ CPLErr GDALContourGenerate( GDALRasterBandH hBand,
 
     return eErr;
 }
+
+/************************************************************************/
+/* ==================================================================== */
+/*                      Tiled contour generation                        */
+/* ==================================================================== */
+/************************************************************************/
+
+typedef struct
+{
+    GDALRasterBandH hBand;
+    int     nXSize;
+    int     nYSize;
+    double  dfContourInterval;
+    double  dfContourBase;
+    int     nFixedLevelCount;
+    double *padfFixedLevels;
+    int     bUseNoData;
+    double  dfNoDataValue;
+} GDALContourParams;
+
+/* A strip covers generator lines nYStart to nYEnd-1, so it needs the   */
+/* scanlines nYStart-1 to nYEnd-1.  Lines ending on the scanline         */
+/* shared with a neighbouring strip are kept aside as fragments, to be  */
+/* joined once that strip is done.                                      */
+typedef struct
+{
+    const GDALContourParams *psParams;
+    int     nYStart;
+    int     nYEnd;
+
+    // Scanlines MAX(0,nYStart-1) to nYEnd-1, or NULL to read them.
+    double *padfData;
+
+    GDALContourWriter pfnWriter;
+    void   *pWriterCBData;
+    GDALContourPolygonBuilder *poPolygonBuilder;
+
+    std::vector<GDALContourItem*> apoLines;
+    std::vector<GDALContourItem*> apoFragments;
+
+    int     bHasData;
+    double  dfDataMin;
+    double  dfDataMax;
+
+    GDALProgressFunc pfnProgress;
+    void   *pProgressArg;
+    CPLErr  eErr;
+} GDALContourStrip;
+
+/************************************************************************/
+/*                       GDALContourStripWriter()                       */
+/************************************************************************/
+
+static CPLErr GDALContourStripWriter( double dfLevel, int nPoints,
+                                      double *padfX, double *padfY,
+                                      void *pInfo )
+
+{
+    GDALContourStrip *psStrip = (GDALContourStrip *) pInfo;
+    GDALContourItem *poItem = new GDALContourItem( dfLevel );
+
+    // The points already went through PrepareEjection().
+    poItem->MakeRoomFor( nPoints );
+    memcpy( poItem->padfX, padfX, sizeof(double) * nPoints );
+    memcpy( poItem->padfY, padfY, sizeof(double) * nPoints );
+    poItem->nPoints = nPoints;
+    poItem->dfTailX = padfX[nPoints-1];
+
+    const bool bClosed = fabs(padfX[0] - padfX[nPoints-1]) < JOIN_DIST
+        && fabs(padfY[0] - padfY[nPoints-1]) < JOIN_DIST;
+    bool bOnSeam = false;
+
+    for( int iEnd = 0; iEnd < 2 && !bClosed; iEnd++ )
+    {
+        const double dfY = padfY[iEnd == 0 ? 0 : nPoints-1];
+
+        if( psStrip->nYStart > 0
+            && fabs(dfY - (psStrip->nYStart - 0.5)) < JOIN_DIST )
+            bOnSeam = true;
+        if( psStrip->nYEnd < psStrip->psParams->nYSize
+            && fabs(dfY - (psStrip->nYEnd - 0.5)) < JOIN_DIST )
+            bOnSeam = true;
+    }
+
+    if( bOnSeam )
+        psStrip->apoFragments.push_back( poItem );
+    else
+        psStrip->apoLines.push_back( poItem );
+
+    return CE_None;
+}
+
+/************************************************************************/
+/*                       GDALContourProcessStrip()                      */
+/************************************************************************/
+
+static void GDALContourProcessStrip( void *pData )
+
+{
+    GDALContourStrip *psStrip = (GDALContourStrip *) pData;
+    const GDALContourParams *psParams = psStrip->psParams;
+    const int nXSize = psParams->nXSize;
+    const int nFirstLine = MAX(0, psStrip->nYStart - 1);
+
+    psStrip->eErr = CE_Failure;
+
+    GDALContourGenerator oCG( nXSize, psParams->nYSize,
+                              psStrip->pfnWriter, psStrip->pWriterCBData );
+    if( !oCG.Init() )
+        return;
+
+    if( psParams->nFixedLevelCount > 0 )
+        oCG.SetFixedLevels( psParams->nFixedLevelCount,
+                            psParams->padfFixedLevels );
+    else
+        oCG.SetContourLevels( psParams->dfContourInterval,
+                              psParams->dfContourBase );
+
+    if( psParams->bUseNoData )
+        oCG.SetNoData( psParams->dfNoDataValue );
+
+    oCG.SetPolygonBuilder( psStrip->poPolygonBuilder );
+
+    double *padfScanline = NULL;
+    if( psStrip->padfData == NULL )
+    {
+        padfScanline = (double *) VSI_MALLOC2_VERBOSE(sizeof(double), nXSize);
+        if( padfScanline == NULL )
+            return;
+    }
+
+    CPLErr eErr = CE_None;
+
+    for( int iLine = nFirstLine; iLine < psStrip->nYEnd && eErr == CE_None;
+         iLine++ )
+    {
+        double *padfLine = padfScanline;
+
+        if( psStrip->padfData != NULL )
+            padfLine = psStrip->padfData
+                + (size_t) (iLine - nFirstLine) * nXSize;
+        else
+            eErr = GDALRasterIO( psParams->hBand, GF_Read, 0, iLine,
+                                 nXSize, 1, padfLine, nXSize, 1,
+                                 GDT_Float64, 0, 0 );
+        if( eErr != CE_None )
+            break;
+
+        if( iLine < psStrip->nYStart )
+        {
+            oCG.SetStartLine( psStrip->nYStart, padfLine );
+            continue;
+        }
+
+        for( int iPixel = 0; iPixel < nXSize; iPixel++ )
+        {
+            const double dfValue = padfLine[iPixel];
+
+            if( psParams->bUseNoData && dfValue == psParams->dfNoDataValue )
+                continue;
+            if( !psStrip->bHasData )
+            {
+                psStrip->bHasData = TRUE;
+                psStrip->dfDataMin = dfValue;
+                psStrip->dfDataMax = dfValue;
+            }
+            else if( dfValue < psStrip->dfDataMin )
+                psStrip->dfDataMin = dfValue;
+            else if( dfValue > psStrip->dfDataMax )
+                psStrip->dfDataMax = dfValue;
+        }
+
+        eErr = oCG.FeedLine( padfLine );
+
+        if( eErr == CE_None && psStrip->pfnProgress != NULL
+            && !psStrip->pfnProgress(
+                (iLine + 1 - psStrip->nYStart)
+                / (double) (psStrip->nYEnd - psStrip->nYStart),
+                "", psStrip->pProgressArg ) )
+        {
+            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+            eErr = CE_Failure;
+        }
+    }
+
+/* -------------------------------------------------------------------- */
+/*      The last line flushes the generator by itself.  Otherwise       */
+/*      eject what is still pending, it ends on the seam.               */
+/* -------------------------------------------------------------------- */
+    if( eErr == CE_None && psStrip->nYEnd < psParams->nYSize )
+        eErr = oCG.EjectContours( FALSE );
+
+    CPLFree( padfScanline );
+
+    psStrip->eErr = eErr;
+}
+
+/************************************************************************/
+/*                        GDALContourFlushStrip()                       */
+/*                                                                      */
+/*      Join the fragments of a strip to the lines left open by the     */
+/*      strips above it, and write out everything that is complete.     */
+/*      Strips must be flushed in order.                                */
+/************************************************************************/
+
+typedef std::map<double, std::vector<GDALContourItem*> > GDALContourOpenMap;
+
+static CPLErr GDALContourFlushStrip( GDALContourStrip *psStrip,
+                                     GDALContourOpenMap &oOpen,
+                                     OGRContourWriterInfo *psInfo )
+
+{
+    CPLErr eErr = CE_None;
+
+    for( size_t i = 0; i < psStrip->apoFragments.size(); i++ )
+    {
+        GDALContourItem *poCur = psStrip->apoFragments[i];
+        std::vector<GDALContourItem*> &apoOpen = oOpen[poCur->dfLevel];
+        bool bMerged = true;
+
+        while( bMerged )
+        {
+            bMerged = false;
+            for( size_t j = 0; j < apoOpen.size(); j++ )
+            {
+                if( apoOpen[j]->Merge( poCur ) )
+                {
+                    delete poCur;
+                    poCur = apoOpen[j];
+                    apoOpen.erase( apoOpen.begin() + j );
+                    bMerged = true;
+                    break;
+                }
+            }
+        }
+
+        apoOpen.push_back( poCur );
+    }
+    psStrip->apoFragments.clear();
+
+    for( size_t i = 0; i < psStrip->apoLines.size(); i++ )
+    {
+        GDALContourItem *poLine = psStrip->apoLines[i];
+
+        if( eErr == CE_None )
+            eErr = OGRContourWriter( poLine->dfLevel, poLine->nPoints,
+                                     poLine->padfX, poLine->padfY, psInfo );
+        delete poLine;
+    }
+    psStrip->apoLines.clear();
+
+/* -------------------------------------------------------------------- */
+/*      Lines not reaching the bottom seam of this strip are done.      */
+/* -------------------------------------------------------------------- */
+    const bool bLastStrip = psStrip->nYEnd >= psStrip->psParams->nYSize;
+    const double dfSeamY = psStrip->nYEnd - 0.5;
+
+    for( GDALContourOpenMap::iterator oIter = oOpen.begin();
+         oIter != oOpen.end(); ++oIter )
+    {
+        std::vector<GDALContourItem*> &apoOpen = oIter->second;
+        size_t nKept = 0;
+
+        for( size_t i = 0; i < apoOpen.size(); i++ )
+        {
+            GDALContourItem *poLine = apoOpen[i];
+            const int nLast = poLine->nPoints - 1;
+            const bool bClosed =
+                fabs(poLine->padfX[0] - poLine->padfX[nLast]) < JOIN_DIST
+                && fabs(poLine->padfY[0] - poLine->padfY[nLast]) < JOIN_DIST;
+
+            if( !bLastStrip && !bClosed
+                && (fabs(poLine->padfY[0] - dfSeamY) < JOIN_DIST
+                    || fabs(poLine->padfY[nLast] - dfSeamY) < JOIN_DIST) )
+            {
+                apoOpen[nKept++] = poLine;
+                continue;
+            }
+
+            if( eErr == CE_None )
+                eErr = OGRContourWriter( poLine->dfLevel, poLine->nPoints,
+                                         poLine->padfX, poLine->padfY,
+                                         psInfo );
+            delete poLine;
+        }
+        apoOpen.resize( nKept );
+    }
+
+    return eErr;
+}
+
+/************************************************************************/
+/*                       GDALContourGenerateEx()                        */
+/************************************************************************/
+
+/**
+ * Create vector contours or filled contour bands from raster DEM.
+ *
+ * This is a variant of GDALContourGenerate() taking its settings as
+ * options.  The band can be split into strips of scanlines contoured in
+ * parallel by worker threads.  Lines crossing the strip boundaries are
+ * joined back, and lines are written to the layer as soon as the strips
+ * they lie on are complete.  With a single thread and no TILE_HEIGHT,
+ * the output is identical to the one of GDALContourGenerate().
+ *
+ * When the band is split, the same lines are produced, including next to
+ * nodata pixels, but they may be written in a different order and closed
+ * lines may start at a different vertex.  Line ends are matched with a
+ * tolerance of 1e-4 pixel, both within a strip and across strips, so
+ * where several ends of the same level lie that close to each other
+ * (around a pixel whose value is almost exactly on a level), the pieces
+ * may be joined differently and a sliver may come out as a separate
+ * feature.
+ *
+ * Supported options:
+ * <ul>
+ * <li>LEVEL_INTERVAL=f: elevation interval between contours.</li>
+ * <li>LEVEL_BASE=f: elevation relative to which the intervals are
+ *     applied.  Defaults to 0.</li>
+ * <li>FIXED_LEVELS=f[,f]*: comma separated list of fixed levels, used
+ *     instead of LEVEL_INTERVAL and LEVEL_BASE.</li>
+ * <li>NODATA=f: pixel value to ignore.</li>
+ * <li>ID_FIELD=n: index of the field receiving a unique feature id.</li>
+ * <li>ELEV_FIELD=n: index of the field receiving the contour elevation.</li>
+ * <li>ELEV_FIELD_MIN=n, ELEV_FIELD_MAX=n: with POLYGONIZE=YES, index of
+ *     the fields receiving the lower and upper elevations of a band.</li>
+ * <li>POLYGONIZE=YES/NO: whether to write one MULTIPOLYGON feature per
+ *     elevation band, covering the area between two consecutive levels,
+ *     instead of contour lines.  Defaults to NO.  With fixed levels, the
+ *     lowest and highest bands are bounded by the band minimum and
+ *     maximum.</li>
+ * <li>NUM_THREADS=number_of_threads/ALL_CPUS: number of worker threads.
+ *     Defaults to the value of the GDAL_NUM_THREADS configuration option,
+ *     or 1.</li>
+ * <li>TILE_HEIGHT=n: number of scanlines per strip.  Defaults to the whole
+ *     band with one thread, and to about one strip per thread (at most
+ *     1024 scanlines) otherwise.</li>
+ * </ul>
+ *
+ * Polygons are assembled once the whole band has been processed, so with
+ * POLYGONIZE=YES nothing is written before the end.
+ *
+ * @param hBand The band to read raster data from.
+ * @param hLayer The layer to which new features will be written.  This is
+ * really of type OGRLayerH.
+ * @param papszOptions List of options as described above, or NULL.
+ * @param pfnProgress A GDALProgressFunc that may be used to report progress
+ * to the user, or to interrupt the algorithm.  May be NULL if not required.
+ * @param pProgressArg The callback data for the pfnProgress function.
+ *
+ * @return CE_None on success or CE_Failure if an error occurs.
+ *
+ * @since GDAL 2.2
+ */
+
+CPLErr GDALContourGenerateEx( GDALRasterBandH hBand, void *hLayer,
+                              char **papszOptions,
+                              GDALProgressFunc pfnProgress,
+                              void *pProgressArg )
+
+{
+    VALIDATE_POINTER1( hBand, "GDALContourGenerateEx", CE_Failure );
+    VALIDATE_POINTER1( hLayer, "GDALContourGenerateEx", CE_Failure );
+
+    if( pfnProgress == NULL )
+        pfnProgress = GDALDummyProgress;
+
+    if( !pfnProgress( 0.0, "", pProgressArg ) )
+    {
+        CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+        return CE_Failure;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Collect the options.                                            */
+/* -------------------------------------------------------------------- */
+    GDALContourParams sParams;
+    std::vector<double> adfFixedLevels;
+
+    sParams.hBand = hBand;
+    sParams.nXSize = GDALGetRasterBandXSize( hBand );
+    sParams.nYSize = GDALGetRasterBandYSize( hBand );
+    sParams.dfContourInterval =
+        CPLAtof( CSLFetchNameValueDef( papszOptions, "LEVEL_INTERVAL", "0" ) );
+    sParams.dfContourBase =
+        CPLAtof( CSLFetchNameValueDef( papszOptions, "LEVEL_BASE", "0" ) );
+
+    const char *pszFixedLevels =
+        CSLFetchNameValue( papszOptions, "FIXED_LEVELS" );
+    if( pszFixedLevels != NULL )
+    {
+        char **papszLevels = CSLTokenizeString2( pszFixedLevels, ",", 0 );
+        for( int i = 0; papszLevels[i] != NULL; i++ )
+            adfFixedLevels.push_back( CPLAtof( papszLevels[i] ) );
+        CSLDestroy( papszLevels );
+    }
+    sParams.nFixedLevelCount = (int) adfFixedLevels.size();
+    sParams.padfFixedLevels =
+        adfFixedLevels.empty() ? NULL : &adfFixedLevels[0];
+
+    if( sParams.nFixedLevelCount == 0 && !(sParams.dfContourInterval > 0.0) )
+    {
+        CPLError( CE_Failure, CPLE_IllegalArg,
+                  "LEVEL_INTERVAL must be strictly positive when "
+                  "FIXED_LEVELS is not set." );
+        return CE_Failure;
+    }
+    // The generator fudges values on levels with the interval, even when
+    // using fixed levels.
+    if( sParams.nFixedLevelCount > 0 )
+        sParams.dfContourInterval = 10.0;
+
+    const char *pszNoData = CSLFetchNameValue( papszOptions, "NODATA" );
+    sParams.bUseNoData = pszNoData != NULL;
+    sParams.dfNoDataValue = pszNoData ? CPLAtof( pszNoData ) : 0.0;
+
+    OGRContourWriterInfo oCWI;
+
+    oCWI.hLayer = (OGRLayerH) hLayer;
+    oCWI.nIDField =
+        atoi( CSLFetchNameValueDef( papszOptions, "ID_FIELD", "-1" ) );
+    oCWI.nElevField =
+        atoi( CSLFetchNameValueDef( papszOptions, "ELEV_FIELD", "-1" ) );
+    oCWI.nNextID = 0;
+    oCWI.adfGeoTransform[0] = 0.0;
+    oCWI.adfGeoTransform[1] = 1.0;
+    oCWI.adfGeoTransform[2] = 0.0;
+    oCWI.adfGeoTransform[3] = 0.0;
+    oCWI.adfGeoTransform[4] = 0.0;
+    oCWI.adfGeoTransform[5] = 1.0;
+    GDALDatasetH hSrcDS = GDALGetBandDataset( hBand );
+    if( hSrcDS != NULL )
+        GDALGetGeoTransform( hSrcDS, oCWI.adfGeoTransform );
+
+    const int iElevFieldMin =
+        atoi( CSLFetchNameValueDef( papszOptions, "ELEV_FIELD_MIN", "-1" ) );
+    const int iElevFieldMax =
+        atoi( CSLFetchNameValueDef( papszOptions, "ELEV_FIELD_MAX", "-1" ) );
+    const bool bPolygonize =
+        CPLTestBool( CSLFetchNameValueDef( papszOptions, "POLYGONIZE", "NO" ) );
+
+    const char *pszThreads = CSLFetchNameValue( papszOptions, "NUM_THREADS" );
+    if( pszThreads == NULL )
+        pszThreads = CPLGetConfigOption( "GDAL_NUM_THREADS", "1" );
+    int nThreads = EQUAL(pszThreads, "ALL_CPUS") ?
+        CPLGetNumCPUs() : atoi( pszThreads );
+    nThreads = MAX(1, MIN(128, nThreads));
+
+    int nTileHeight = sParams.nYSize;
+    const char *pszTileHeight =
+        CSLFetchNameValue( papszOptions, "TILE_HEIGHT" );
+    if( pszTileHeight != NULL )
+        nTileHeight = atoi( pszTileHeight );
+    else if( nThreads > 1 )
+        nTileHeight = MIN(1024, (sParams.nYSize + nThreads - 1) / nThreads);
+    nTileHeight = MAX(1, MIN(sParams.nYSize, nTileHeight));
+
+    const int nStrips = (sParams.nYSize + nTileHeight - 1) / nTileHeight;
+
+/* -------------------------------------------------------------------- */
+/*      A single strip is written straight to the layer, like           */
+/*      GDALContourGenerate() does.                                     */
+/* -------------------------------------------------------------------- */
+    GDALContourWriter pfnWriter = GDALContourStripWriter;
+    if( bPolygonize )
+        pfnWriter = NULL;
+    else if( nStrips == 1 )
+        pfnWriter = OGRContourWriter;
+
+    GDALContourPolygonBuilder *poPolygons = NULL;
+    if( bPolygonize )
+        poPolygons = new GDALContourPolygonBuilder(
+            sParams.dfContourInterval, sParams.dfContourBase,
+            sParams.nFixedLevelCount, sParams.padfFixedLevels );
+
+    CPLWorkerThreadPool *poPool = NULL;
+    if( nThreads > 1 && nStrips > 1 )
+    {
+        poPool = new (std::nothrow) CPLWorkerThreadPool();
+        if( poPool == NULL || !poPool->Setup( nThreads, NULL, NULL ) )
+        {
+            delete poPool;
+            poPool = NULL;
+            nThreads = 1;
+        }
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Process the strips by batches of one per thread.  Without       */
+/*      worker threads, strips read their scanlines themselves.         */
+/* -------------------------------------------------------------------- */
+    const int nBatch = poPool != NULL ? nThreads : 1;
+    std::vector<GDALContourStrip> asStrips( nBatch );
+    GDALContourOpenMap oOpen;
+    bool bHasData = false;
+    double dfDataMin = 0.0;
+    double dfDataMax = 0.0;
+    CPLErr eErr = CE_None;
+
+    for( int iFirst = 0; iFirst < nStrips && eErr == CE_None;
+         iFirst += nBatch )
+    {
+        const int nCount = MIN(nBatch, nStrips - iFirst);
+        std::vector<void*> apJobs;
+
+        for( int i = 0; i < nCount; i++ )
+        {
+            GDALContourStrip *psStrip = &asStrips[i];
+
+            psStrip->psParams = &sParams;
+            psStrip->nYStart = (iFirst + i) * nTileHeight;
+            psStrip->nYEnd =
+                MIN(sParams.nYSize, psStrip->nYStart + nTileHeight);
+            psStrip->padfData = NULL;
+            psStrip->pfnWriter = pfnWriter;
+            psStrip->pWriterCBData = psStrip;
+            if( pfnWriter == OGRContourWriter )
+                psStrip->pWriterCBData = &oCWI;
+            psStrip->poPolygonBuilder = poPolygons;
+            psStrip->bHasData = FALSE;
+            psStrip->dfDataMin = 0.0;
+            psStrip->dfDataMax = 0.0;
+            psStrip->pfnProgress = NULL;
+            psStrip->pProgressArg = NULL;
+            psStrip->eErr = CE_None;
+            if( poPool != NULL && bPolygonize )
+                psStrip->poPolygonBuilder = new GDALContourPolygonBuilder(
+                    sParams.dfContourInterval, sParams.dfContourBase,
+                    sParams.nFixedLevelCount, sParams.padfFixedLevels );
+        }
+
+        for( int i = 0; i < nCount && eErr == CE_None; i++ )
+        {
+            GDALContourStrip *psStrip = &asStrips[i];
+
+            if( poPool == NULL )
+            {
+                psStrip->pProgressArg = GDALCreateScaledProgress(
+                    (iFirst + i) / (double) nStrips,
+                    (iFirst + i + 1) / (double) nStrips,
+                    pfnProgress, pProgressArg );
+                psStrip->pfnProgress = GDALScaledProgress;
+
+                GDALContourProcessStrip( psStrip );
+
+                GDALDestroyScaledProgress( psStrip->pProgressArg );
+                continue;
+            }
+
+            const int nFirstLine = MAX(0, psStrip->nYStart - 1);
+            const int nLines = psStrip->nYEnd - nFirstLine;
+
+            psStrip->padfData = (double *)
+                VSI_MALLOC3_VERBOSE( sizeof(double), sParams.nXSize, nLines );
+            if( psStrip->padfData == NULL )
+                eErr = CE_Failure;
+            else
+                eErr = GDALRasterIO( hBand, GF_Read, 0, nFirstLine,
+                                     sParams.nXSize, nLines,
+                                     psStrip->padfData,
+                                     sParams.nXSize, nLines,
+                                     GDT_Float64, 0, 0 );
+            apJobs.push_back( psStrip );
+        }
+
+        if( poPool != NULL && eErr == CE_None )
+        {
+            poPool->SubmitJobs( GDALContourProcessStrip, apJobs );
+            poPool->WaitCompletion();
+        }
+
+/* -------------------------------------------------------------------- */
+/*      Flush the batch in strip order.                                 */
+/* -------------------------------------------------------------------- */
+        for( int i = 0; i < nCount; i++ )
+        {
+            GDALContourStrip *psStrip = &asStrips[i];
+
+            if( eErr == CE_None )
+                eErr = psStrip->eErr;
+
+            if( eErr == CE_None && psStrip->bHasData )
+            {
+                if( !bHasData )
+                {
+                    dfDataMin = psStrip->dfDataMin;
+                    dfDataMax = psStrip->dfDataMax;
+                    bHasData = true;
+                }
+                dfDataMin = MIN(dfDataMin, psStrip->dfDataMin);
+                dfDataMax = MAX(dfDataMax, psStrip->dfDataMax);
+            }
+
+            if( eErr == CE_None && pfnWriter == GDALContourStripWriter )
+                eErr = GDALContourFlushStrip( psStrip, oOpen, &oCWI );
+
+            if( psStrip->poPolygonBuilder != poPolygons )
+            {
+                if( eErr == CE_None )
+                    poPolygons->Merge( psStrip->poPolygonBuilder );
+                delete psStrip->poPolygonBuilder;
+            }
+
+            for( size_t j = 0; j < psStrip->apoLines.size(); j++ )
+                delete psStrip->apoLines[j];
+            psStrip->apoLines.clear();
+            for( size_t j = 0; j < psStrip->apoFragments.size(); j++ )
+                delete psStrip->apoFragments[j];
+            psStrip->apoFragments.clear();
+
+            CPLFree( psStrip->padfData );
+            psStrip->padfData = NULL;
+        }
+
+        if( eErr == CE_None && poPool != NULL
+            && !pfnProgress( (iFirst + nCount) / (double) nStrips, "",
+                             pProgressArg ) )
+        {
+            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+            eErr = CE_Failure;
+        }
+    }
+
+    delete poPool;
+
+    for( GDALContourOpenMap::iterator oIter = oOpen.begin();
+         oIter != oOpen.end(); ++oIter )
+    {
+        for( size_t i = 0; i < oIter->second.size(); i++ )
+            delete oIter->second[i];
+    }
+
+    if( poPolygons != NULL )
+    {
+        if( eErr == CE_None )
+            eErr = poPolygons->WritePolygons( &oCWI,
+                                              iElevFieldMin, iElevFieldMax,
+                                              dfDataMin, dfDataMax );
+        delete poPolygons;
+    }
+
+    if( eErr == CE_None && !pfnProgress( 1.0, "", pProgressArg ) )
+    {
+        CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+        eErr = CE_Failure;
+    }
+
+    return eErr;
+}
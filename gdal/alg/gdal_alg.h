@@ -106,6 +106,15 @@ GDALSieveFilter( GDALRasterBandH hSrcBand, GDALRasterBandH hMaskBand,
                  GDALProgressFunc pfnProgress,
                  void * pProgressArg );
 
+CPLErr CPL_DLL CPL_STDCALL
+GDALLabelConnectedComponents( GDALRasterBandH hSrcBand,
+                              GDALRasterBandH hMaskBand,
+                              GDALRasterBandH hDstBand,
+                              int nConnectedness,
+                              char **papszOptions,
+                              GDALProgressFunc pfnProgress,
+                              void * pProgressArg );
+
 /*
  * Warp Related.
  */
@@ -229,6 +238,19 @@ int  CPL_DLL GDALApproxTransform(
     void *pTransformArg, int bDstToSrc, int nPointCount,
     double *x, double *y, double *z, int *panSuccess );
 
+/* Transform grid transformer */
+void CPL_DLL *
+GDALCreateTransformGridTransformer( GDALTransformerFunc pfnBaseTransformer,
+                                    void *pBaseTransformerArg,
+                                    int nDstXSize, int nDstYSize,
+                                    double dfMaxError, char **papszOptions );
+void CPL_DLL GDALTransformGridTransformerOwnsSubtransformer( void *pCBData,
+                                                             int bOwnFlag );
+void CPL_DLL GDALDestroyTransformGridTransformer( void *pTransformArg );
+int  CPL_DLL GDALTransformGridTransform(
+    void *pTransformArg, int bDstToSrc, int nPointCount,
+    double *x, double *y, double *z, int *panSuccess );
+
 
 int CPL_DLL CPL_STDCALL
 GDALSimpleImageWarp( GDALDatasetH hSrcDS,
@@ -311,6 +333,11 @@ GDALContourGenerate( GDALRasterBandH hBand,
                             void *hLayer, int iIDField, int iElevField,
                             GDALProgressFunc pfnProgress, void *pProgressArg );
 
+CPLErr CPL_DLL
+GDALContourGenerateEx( GDALRasterBandH hBand, void *hLayer,
+                       char **papszOptions,
+                       GDALProgressFunc pfnProgress, void *pProgressArg );
+
 /************************************************************************/
 /*      Rasterizer API - geometries burned into GDAL raster.            */
 /************************************************************************/
@@ -411,7 +438,8 @@ typedef struct
 {
     /*! Weighting power. */
     double  dfPower;
-    /*! The radius of search circle. */
+    /*! The radius of search circle. Zero means no distance limit
+     *  (since GDAL 2.2). */
     double  dfRadius;
 
     /*! Maximum number of data points to use.
@@ -33,6 +33,9 @@
 #define GDAL_ALG_PRIV_H_INCLUDED
 
 #include "gdal_alg.h"
+#include "cpl_multiproc.h"
+
+#include <vector>
 
 CPL_C_START
 
@@ -57,6 +60,10 @@ typedef struct {
     double *padfBurnValue;
     GDALBurnValueSrc eBurnValueSource;
     GDALRasterMergeAlg eMergeAlg;
+    /* Window of lines [nYMin,nYMax[ that may be burnt.  Lines outside */
+    /* of it belong to another tile burnt concurrently. */
+    int nYMin;
+    int nYMax;
 } GDALRasterizeInfo;
 
 /************************************************************************/
@@ -122,6 +129,9 @@ public:
                           int nXSize );
 
     void     CompleteMerges();
+    int      ResolveMerges();
+    int      RenumberPolygons( GInt32 *panLineId, int nXSize,
+                               GInt32 *panNewIdMap );
 
     void     Clear();
 };
@@ -133,6 +143,93 @@ struct IntEqualityTest
 
 typedef GDALRasterPolygonEnumeratorT<GInt32, IntEqualityTest> GDALRasterPolygonEnumerator;
 
+/************************************************************************/
+/*                      Connected component labeling                    */
+/************************************************************************/
+
+/* Called for each line by GDALConnectedComponents::ProcessLines(), possibly
+ * from several threads at once but with a given strip always processed by
+ * the same thread, in line order. panVal has the unmasked pixel values,
+ * panComp and panLastComp the component ids of this line and of the previous
+ * one (NULL for the first line of the raster), -1 for masked pixels.
+ * panOutVal is written to the output band, if any. */
+typedef CPLErr (*GDALComponentLineFunc)( void *pUserData, int iStrip, int iY,
+                                         int nXSize, const GInt32 *panVal,
+                                         const GInt32 *panComp,
+                                         const GInt32 *panLastComp,
+                                         GInt32 *panOutVal );
+
+struct GDALCCStrip;
+
+class GDALConnectedComponents
+{
+    GDALRasterBandH     hSrcBand;
+    GDALRasterBandH     hMaskBand;
+    int                 nConnectedness;
+    int                 nXSize;
+    int                 nYSize;
+    int                 nNumThreads;
+
+    std::vector<GDALCCStrip*> apsStrips;
+
+    // Per component, in the order of their first pixel in the raster.
+    std::vector<int>    anCompSize;
+    std::vector<GInt32> anCompValue;
+
+    // State of a pass over the strips.
+    int                 nPass;
+    GDALComponentLineFunc pfnLineFunc;
+    void               *pLineUserData;
+    GDALRasterBandH     hDstBand;
+    int                 iNextStrip;
+    int                 nLinesDone;
+    bool                bStop;
+    CPLMutex           *hMutex;
+    CPLCond            *hCond;
+    GDALProgressFunc    pfnProgress;
+    void               *pProgressArg;
+
+    static void         WorkerThreadFunction( void *pData );
+    CPLErr              RunPass( int nPassIn, GDALProgressFunc pfnProgressIn,
+                                 void *pProgressArgIn );
+    CPLErr              ProcessStrip( int iStrip );
+    CPLErr              LabelStrip( GDALCCStrip *psStrip );
+    CPLErr              ProcessStripLines( int iStrip );
+    CPLErr              ReadLine( int iY, GInt32 *panRawVal, GInt32 *panVal,
+                                  GByte *pabyMaskLine );
+    bool                ReportLine();
+    void                MergeStrips();
+
+  public:
+                        GDALConnectedComponents( GDALRasterBandH hSrcBandIn,
+                                                 GDALRasterBandH hMaskBandIn,
+                                                 int nConnectednessIn,
+                                                 char **papszOptions );
+                       ~GDALConnectedComponents();
+
+    CPLErr              Label( GDALProgressFunc pfnProgressIn,
+                               void *pProgressArgIn );
+    CPLErr              ProcessLines( GDALComponentLineFunc pfnFunc,
+                                      void *pUserData,
+                                      GDALRasterBandH hDstBandIn,
+                                      GDALProgressFunc pfnProgressIn,
+                                      void *pProgressArgIn );
+
+    int                 GetConnectedness() const { return nConnectedness; }
+    int                 GetComponentCount() const
+                            { return static_cast<int>(anCompSize.size()); }
+    int                 GetComponentSize( int iComp ) const
+                            { return anCompSize[iComp]; }
+    GInt32              GetComponentValue( int iComp ) const
+                            { return anCompValue[iComp]; }
+
+    int                 GetStripCount() const
+                            { return static_cast<int>(apsStrips.size()); }
+    int                 GetStripYOff( int iStrip ) const;
+    void                GetStripComponents( int iStrip, int *pnFirst,
+                                            int *pnEnd ) const;
+};
+
 typedef void* (*GDALTransformDeserializeFunc)( CPLXMLNode *psTree );
 
 void* GDALRegisterTransformDeserializer(const char* pszTransformName,
@@ -149,6 +246,11 @@ void* GDALCreateTPSTransformerInt( int nGCPCount, const GDAL_GCP *pasGCPList,
 
 void CPL_DLL * GDALCloneTransformer( void *pTransformerArg );
 
+int GDALGetApproxTransformerInfo( void *pApproxArg,
+                                  GDALTransformerFunc *ppfnBaseTransformer,
+                                  void **ppBaseTransformerArg,
+                                  double *pdfMaxError );
+
 /************************************************************************/
 /*      Color table related                                             */
 /************************************************************************/
@@ -0,0 +1,864 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  GDAL
+ * Purpose:  Parallel connected component labeling of raster bands.
+ * Author:   Even Rouault, <even dot rouault at mines-paris dot org>
+ *
+ ******************************************************************************
+ * Copyright (c) 2016, Even Rouault <even dot rouault at mines-paris dot org>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "gdal_alg_priv.h"
+#include "cpl_conv.h"
+#include "cpl_string.h"
+
+CPL_CVSID("$Id$");
+
+#define MY_MAX_INT 2147483647
+
+/*
+ * General Plan
+ *
+ * The raster is split into strips of lines, that are labeled independently,
+ * possibly by several threads, with the polygon enumerator. The components
+ * of each strip are then merged across the strip seams with a union-find,
+ * and numbered in the order of their first pixel in the raster, so that the
+ * result does not depend on the strip height.
+ *
+ * Users then make passes over the strips with ProcessLines(), which
+ * redoes the strip enumeration and provides the component id of each
+ * pixel.
+ */
+
+#define CC_PASS_LABEL   0
+#define CC_PASS_LINES   1
+
+/************************************************************************/
+/*                             GDALCCStrip                              */
+/************************************************************************/
+
+struct GDALCCStrip
+{
+    int                 nYOff;
+    int                 nYEnd;          // exclusive
+
+    // Enumerator polygon id to strip component id.
+    std::vector<GInt32> anPolyToLocal;
+    std::vector<int>    anLocalSize;
+    std::vector<GInt32> anLocalValue;
+
+    // Strip components of the first and last lines, and pixel values.
+    std::vector<GInt32> anTopLocal;
+    std::vector<GInt32> anBottomLocal;
+    std::vector<GInt32> anTopVal;
+    std::vector<GInt32> anBottomVal;
+
+    // Strip component id to final component id.
+    std::vector<GInt32> anLocalToComp;
+
+    // Final components of the last line.
+    std::vector<GInt32> anBottomComp;
+
+    // Range of the components whose first pixel is in this strip.
+    int                 nFirstComp;
+    int                 nEndComp;
+
+    CPLErr              eErr;
+};
+
+/************************************************************************/
+/*                              CCFindRoot()                            */
+/************************************************************************/
+
+static int CCFindRoot( std::vector<int>& anParent, int i )
+{
+    int nRoot = i;
+    while( anParent[nRoot] != nRoot )
+        nRoot = anParent[nRoot];
+    while( anParent[i] != nRoot )
+    {
+        int nNext = anParent[i];
+        anParent[i] = nRoot;
+        i = nNext;
+    }
+    return nRoot;
+}
+
+/************************************************************************/
+/*                               CCUnion()                              */
+/************************************************************************/
+
+static void CCUnion( std::vector<int>& anParent, int i, int j )
+{
+    const int nRoot1 = CCFindRoot( anParent, i );
+    const int nRoot2 = CCFindRoot( anParent, j );
+
+    // Keep the smallest index as the root, which is the component seen
+    // first.
+    if( nRoot1 < nRoot2 )
+        anParent[nRoot2] = nRoot1;
+    else if( nRoot2 < nRoot1 )
+        anParent[nRoot1] = nRoot2;
+}
+
+/************************************************************************/
+/*                      GDALConnectedComponents()                       */
+/*                                                                      */
+/*      Supported options are NUM_THREADS and TILE_HEIGHT.              */
+/************************************************************************/
+
+GDALConnectedComponents::GDALConnectedComponents( GDALRasterBandH hSrcBandIn,
+                                                  GDALRasterBandH hMaskBandIn,
+                                                  int nConnectednessIn,
+                                                  char **papszOptions ) :
+    hSrcBand(hSrcBandIn),
+    hMaskBand(hMaskBandIn),
+    nConnectedness(nConnectednessIn),
+    nXSize(GDALGetRasterBandXSize(hSrcBandIn)),
+    nYSize(GDALGetRasterBandYSize(hSrcBandIn)),
+    nNumThreads(1),
+    nPass(CC_PASS_LABEL),
+    pfnLineFunc(NULL),
+    pLineUserData(NULL),
+    hDstBand(NULL),
+    iNextStrip(0),
+    nLinesDone(0),
+    bStop(false),
+    hMutex(NULL),
+    hCond(NULL),
+    pfnProgress(NULL),
+    pProgressArg(NULL)
+{
+    const char *pszNumThreads = CSLFetchNameValue( papszOptions, "NUM_THREADS" );
+    if( pszNumThreads != NULL )
+    {
+        if( EQUAL(pszNumThreads, "ALL_CPUS") )
+            nNumThreads = CPLGetNumCPUs();
+        else
+            nNumThreads = atoi(pszNumThreads);
+        if( nNumThreads > 128 )
+            nNumThreads = 128;
+        if( nNumThreads < 1 )
+            nNumThreads = 1;
+    }
+
+    int nTileHeight;
+    const char *pszTileHeight = CSLFetchNameValue( papszOptions, "TILE_HEIGHT" );
+    if( pszTileHeight != NULL )
+        nTileHeight = atoi(pszTileHeight);
+    else
+        nTileHeight = MIN(1024, (nYSize + nNumThreads - 1) / nNumThreads);
+    if( nTileHeight < 1 )
+        nTileHeight = 1;
+
+    for( int nYOff = 0; nYOff < nYSize; nYOff += nTileHeight )
+    {
+        GDALCCStrip *psStrip = new GDALCCStrip;
+        psStrip->nYOff = nYOff;
+        psStrip->nYEnd = MIN(nYOff + nTileHeight, nYSize);
+        psStrip->nFirstComp = 0;
+        psStrip->nEndComp = 0;
+        psStrip->eErr = CE_None;
+        apsStrips.push_back( psStrip );
+    }
+
+    if( nNumThreads > static_cast<int>(apsStrips.size()) )
+        nNumThreads = MAX(1, static_cast<int>(apsStrips.size()));
+}
+
+/************************************************************************/
+/*                      ~GDALConnectedComponents()                      */
+/************************************************************************/
+
+GDALConnectedComponents::~GDALConnectedComponents()
+{
+    for( size_t i = 0; i < apsStrips.size(); i++ )
+        delete apsStrips[i];
+}
+
+/************************************************************************/
+/*                            GetStripYOff()                            */
+/************************************************************************/
+
+int GDALConnectedComponents::GetStripYOff( int iStrip ) const
+{
+    return apsStrips[iStrip]->nYOff;
+}
+
+/************************************************************************/
+/*                         GetStripComponents()                         */
+/*                                                                      */
+/*      Return the range of the components whose first pixel is in      */
+/*      the strip. The other components found in a strip all have a     */
+/*      pixel on its first line.                                        */
+/************************************************************************/
+
+void GDALConnectedComponents::GetStripComponents( int iStrip, int *pnFirst,
+                                                  int *pnEnd ) const
+{
+    *pnFirst = apsStrips[iStrip]->nFirstComp;
+    *pnEnd = apsStrips[iStrip]->nEndComp;
+}
+
+/************************************************************************/
+/*                              ReadLine()                              */
+/*                                                                      */
+/*      Read a line, and mask out the pixels of the mask band that      */
+/*      are zero with a special nodata value in panVal.                 */
+/************************************************************************/
+
+CPLErr GDALConnectedComponents::ReadLine( int iY, GInt32 *panRawVal,
+                                          GInt32 *panVal,
+                                          GByte *pabyMaskLine )
+{
+    if( hMutex != NULL )
+        CPLAcquireMutex( hMutex, 1000.0 );
+
+    CPLErr eErr = GDALRasterIO( hSrcBand, GF_Read, 0, iY, nXSize, 1,
+                                panRawVal, nXSize, 1, GDT_Int32, 0, 0 );
+    if( eErr == CE_None && hMaskBand != NULL )
+        eErr = GDALRasterIO( hMaskBand, GF_Read, 0, iY, nXSize, 1,
+                             pabyMaskLine, nXSize, 1, GDT_Byte, 0, 0 );
+
+    if( hMutex != NULL )
+        CPLReleaseMutex( hMutex );
+
+    if( eErr == CE_None )
+    {
+        memcpy( panVal, panRawVal, sizeof(GInt32) * nXSize );
+        if( hMaskBand != NULL )
+        {
+            for( int i = 0; i < nXSize; i++ )
+            {
+                if( pabyMaskLine[i] == 0 )
+                    panVal[i] = GP_NODATA_MARKER;
+            }
+        }
+    }
+
+    return eErr;
+}
+
+/************************************************************************/
+/*                             ReportLine()                             */
+/*                                                                      */
+/*      Account for a processed line. Progress is reported directly     */
+/*      in single threaded mode, or by the calling thread while it      */
+/*      waits for the workers. Returns false if processing must stop.   */
+/************************************************************************/
+
+bool GDALConnectedComponents::ReportLine()
+{
+    if( hMutex == NULL )
+    {
+        nLinesDone++;
+        if( !pfnProgress( nLinesDone / (double) nYSize, "", pProgressArg ) )
+        {
+            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+            bStop = true;
+        }
+        return !bStop;
+    }
+
+    CPLAcquireMutex( hMutex, 1000.0 );
+    nLinesDone++;
+    bool bContinue = !bStop;
+    CPLCondSignal( hCond );
+    CPLReleaseMutex( hMutex );
+
+    return bContinue;
+}
+
+/************************************************************************/
+/*                             LabelStrip()                             */
+/*                                                                      */
+/*      Enumerate the polygons of a strip, and number them in the       */
+/*      order of their first pixel, which is the order of their first   */
+/*      enumerator id.                                                  */
+/************************************************************************/
+
+CPLErr GDALConnectedComponents::LabelStrip( GDALCCStrip *psStrip )
+{
+    std::vector<GInt32> anRawVal( nXSize );
+    std::vector<GInt32> anLastLineVal( nXSize );
+    std::vector<GInt32> anThisLineVal( nXSize );
+    std::vector<GInt32> anLastLineId( nXSize );
+    std::vector<GInt32> anThisLineId( nXSize );
+    std::vector<GByte> abyMaskLine( hMaskBand != NULL ? nXSize : 0 );
+    GByte *pabyMaskLine = abyMaskLine.empty() ? NULL : &abyMaskLine[0];
+
+    GDALRasterPolygonEnumerator oEnum( nConnectedness );
+    std::vector<int> anPolySize;
+    CPLErr eErr = CE_None;
+
+    for( int iY = psStrip->nYOff; eErr == CE_None && iY < psStrip->nYEnd; iY++ )
+    {
+        eErr = ReadLine( iY, &anRawVal[0], &anThisLineVal[0], pabyMaskLine );
+        if( eErr != CE_None )
+            break;
+
+        if( iY == psStrip->nYOff )
+            oEnum.ProcessLine( NULL, &anThisLineVal[0],
+                               NULL, &anThisLineId[0], nXSize );
+        else
+            oEnum.ProcessLine( &anLastLineVal[0], &anThisLineVal[0],
+                               &anLastLineId[0], &anThisLineId[0], nXSize );
+
+        if( oEnum.nNextPolygonId > (int) anPolySize.size() )
+            anPolySize.resize( oEnum.nNextPolygonId );
+
+        for( int iX = 0; iX < nXSize; iX++ )
+        {
+            const int iPoly = anThisLineId[iX];
+            if( iPoly >= 0 && anPolySize[iPoly] < MY_MAX_INT )
+                anPolySize[iPoly] += 1;
+        }
+
+        if( iY == psStrip->nYOff )
+        {
+            psStrip->anTopLocal = anThisLineId;
+            psStrip->anTopVal = anThisLineVal;
+        }
+        if( iY == psStrip->nYEnd - 1 )
+        {
+            psStrip->anBottomLocal = anThisLineId;
+            psStrip->anBottomVal = anThisLineVal;
+        }
+
+        anLastLineVal.swap( anThisLineVal );
+        anLastLineId.swap( anThisLineId );
+
+        if( !ReportLine() )
+            eErr = CE_Failure;
+    }
+
+    if( eErr != CE_None )
+        return eErr;
+
+/* -------------------------------------------------------------------- */
+/*      Number the strip components.                                    */
+/* -------------------------------------------------------------------- */
+    oEnum.ResolveMerges();
+
+    const int nPolyCount = oEnum.nNextPolygonId;
+    std::vector<GInt32> anRootToLocal( nPolyCount, -1 );
+    psStrip->anPolyToLocal.resize( nPolyCount );
+
+    for( int iPoly = 0; iPoly < nPolyCount; iPoly++ )
+    {
+        const int nRoot = oEnum.panPolyIdMap[iPoly];
+        if( anRootToLocal[nRoot] < 0 )
+        {
+            anRootToLocal[nRoot] =
+                static_cast<int>(psStrip->anLocalSize.size());
+            psStrip->anLocalSize.push_back( 0 );
+            psStrip->anLocalValue.push_back( oEnum.panPolyValue[nRoot] );
+        }
+
+        const int iLocal = anRootToLocal[nRoot];
+        psStrip->anPolyToLocal[iPoly] = iLocal;
+
+        GIntBig nSize = psStrip->anLocalSize[iLocal];
+        nSize += anPolySize[iPoly];
+        if( nSize > MY_MAX_INT )
+            nSize = MY_MAX_INT;
+        psStrip->anLocalSize[iLocal] = static_cast<int>(nSize);
+    }
+
+    for( int iX = 0; iX < nXSize; iX++ )
+    {
+        if( psStrip->anTopLocal[iX] >= 0 )
+            psStrip->anTopLocal[iX] =
+                psStrip->anPolyToLocal[psStrip->anTopLocal[iX]];
+        if( psStrip->anBottomLocal[iX] >= 0 )
+            psStrip->anBottomLocal[iX] =
+                psStrip->anPolyToLocal[psStrip->anBottomLocal[iX]];
+    }
+
+    return CE_None;
+}
+
+/************************************************************************/
+/*                         ProcessStripLines()                          */
+/************************************************************************/
+
+CPLErr GDALConnectedComponents::ProcessStripLines( int iStrip )
+{
+    GDALCCStrip *psStrip = apsStrips[iStrip];
+
+    std::vector<GInt32> anRawVal( nXSize );
+    std::vector<GInt32> anOutVal( nXSize );
+    std::vector<GInt32> anLastLineVal( nXSize );
+    std::vector<GInt32> anThisLineVal( nXSize );
+    std::vector<GInt32> anLastLineId( nXSize );
+    std::vector<GInt32> anThisLineId( nXSize );
+    std::vector<GInt32> anLastComp( nXSize );
+    std::vector<GInt32> anThisComp( nXSize );
+    std::vector<GByte> abyMaskLine( hMaskBand != NULL ? nXSize : 0 );
+    GByte *pabyMaskLine = abyMaskLine.empty() ? NULL : &abyMaskLine[0];
+
+    if( iStrip > 0 )
+        anLastComp = apsStrips[iStrip-1]->anBottomComp;
+
+    GDALRasterPolygonEnumerator oEnum( nConnectedness );
+    CPLErr eErr = CE_None;
+
+    for( int iY = psStrip->nYOff; eErr == CE_None && iY < psStrip->nYEnd; iY++ )
+    {
+        eErr = ReadLine( iY, &anRawVal[0], &anThisLineVal[0], pabyMaskLine );
+        if( eErr != CE_None )
+            break;
+
+/* -------------------------------------------------------------------- */
+/*      Redo the enumeration of the labeling pass, which gives the      */
+/*      same polygon ids, and map them to the final components.         */
+/* -------------------------------------------------------------------- */
+        if( iY == psStrip->nYOff )
+            oEnum.ProcessLine( NULL, &anThisLineVal[0],
+                               NULL, &anThisLineId[0], nXSize );
+        else
+            oEnum.ProcessLine( &anLastLineVal[0], &anThisLineVal[0],
+                               &anLastLineId[0], &anThisLineId[0], nXSize );
+
+        for( int iX = 0; iX < nXSize; iX++ )
+        {
+            const int iPoly = anThisLineId[iX];
+            anThisComp[iX] = (iPoly >= 0) ?
+                psStrip->anLocalToComp[psStrip->anPolyToLocal[iPoly]] : -1;
+        }
+
+        memcpy( &anOutVal[0], &anRawVal[0], sizeof(GInt32) * nXSize );
+        eErr = pfnLineFunc( pLineUserData, iStrip, iY, nXSize,
+                            &anRawVal[0], &anThisComp[0],
+                            (iY > 0) ? &anLastComp[0] : NULL,
+                            &anOutVal[0] );
+
+        if( eErr == CE_None && hDstBand != NULL )
+        {
+            if( hMutex != NULL )
+                CPLAcquireMutex( hMutex, 1000.0 );
+            eErr = GDALRasterIO( hDstBand, GF_Write, 0, iY, nXSize, 1,
+                                 &anOutVal[0], nXSize, 1, GDT_Int32, 0, 0 );
+            if( hMutex != NULL )
+                CPLReleaseMutex( hMutex );
+        }
+
+        anLastLineVal.swap( anThisLineVal );
+        anLastLineId.swap( anThisLineId );
+        anLastComp.swap( anThisComp );
+
+        if( eErr == CE_None && !ReportLine() )
+            eErr = CE_Failure;
+    }
+
+    return eErr;
+}
+
+/************************************************************************/
+/*                            ProcessStrip()                            */
+/************************************************************************/
+
+CPLErr GDALConnectedComponents::ProcessStrip( int iStrip )
+{
+    if( nPass == CC_PASS_LABEL )
+        return LabelStrip( apsStrips[iStrip] );
+    return ProcessStripLines( iStrip );
+}
+
+/************************************************************************/
+/*                        WorkerThreadFunction()                        */
+/************************************************************************/
+
+void GDALConnectedComponents::WorkerThreadFunction( void *pData )
+{
+    GDALConnectedComponents *poThis = (GDALConnectedComponents *) pData;
+
+    while( true )
+    {
+        int iStrip = -1;
+
+        CPLAcquireMutex( poThis->hMutex, 1000.0 );
+        if( !poThis->bStop &&
+            poThis->iNextStrip < static_cast<int>(poThis->apsStrips.size()) )
+            iStrip = poThis->iNextStrip++;
+        CPLReleaseMutex( poThis->hMutex );
+
+        if( iStrip < 0 )
+            break;
+
+        CPLErr eErr = poThis->ProcessStrip( iStrip );
+
+        CPLAcquireMutex( poThis->hMutex, 1000.0 );
+        poThis->apsStrips[iStrip]->eErr = eErr;
+        if( eErr != CE_None )
+            poThis->bStop = true;
+        CPLCondSignal( poThis->hCond );
+        CPLReleaseMutex( poThis->hMutex );
+    }
+}
+
+/************************************************************************/
+/*                              RunPass()                               */
+/************************************************************************/
+
+CPLErr GDALConnectedComponents::RunPass( int nPassIn,
+                                         GDALProgressFunc pfnProgressIn,
+                                         void *pProgressArgIn )
+{
+    nPass = nPassIn;
+    iNextStrip = 0;
+    nLinesDone = 0;
+    bStop = false;
+    pfnProgress = pfnProgressIn ? pfnProgressIn : GDALDummyProgress;
+    pProgressArg = pProgressArgIn;
+
+    CPLErr eErr = CE_None;
+    const int nStrips = static_cast<int>(apsStrips.size());
+
+    if( nNumThreads <= 1 )
+    {
+        for( int iStrip = 0; eErr == CE_None && iStrip < nStrips; iStrip++ )
+            eErr = ProcessStrip( iStrip );
+        return eErr;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Launch the workers, and report progress while waiting for       */
+/*      them.                                                           */
+/* -------------------------------------------------------------------- */
+    hMutex = CPLCreateMutex();  // created locked
+    hCond = CPLCreateCond();
+
+    std::vector<CPLJoinableThread*> ahThreads;
+    for( int i = 0; i < nNumThreads; i++ )
+    {
+        CPLJoinableThread *hThread =
+            CPLCreateJoinableThread( WorkerThreadFunction, this );
+        if( hThread != NULL )
+            ahThreads.push_back( hThread );
+    }
+    if( ahThreads.empty() )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined, "Cannot create thread" );
+        eErr = CE_Failure;
+    }
+
+    int nLastLinesDone = 0;
+    while( eErr == CE_None && !bStop && nLinesDone < nYSize )
+    {
+        if( nLinesDone != nLastLinesDone )
+        {
+            nLastLinesDone = nLinesDone;
+            if( !pfnProgress( nLastLinesDone / (double) nYSize,
+                              "", pProgressArg ) )
+            {
+                CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+                eErr = CE_Failure;
+                break;
+            }
+        }
+        CPLCondWait( hCond, hMutex );
+    }
+
+    bStop = true;
+    CPLReleaseMutex( hMutex );
+
+    for( size_t i = 0; i < ahThreads.size(); i++ )
+        CPLJoinThread( ahThreads[i] );
+
+    CPLDestroyCond( hCond );
+    CPLDestroyMutex( hMutex );
+    hCond = NULL;
+    hMutex = NULL;
+
+    for( int iStrip = 0; iStrip < nStrips; iStrip++ )
+    {
+        if( apsStrips[iStrip]->eErr != CE_None )
+            eErr = CE_Failure;
+    }
+    if( eErr == CE_None && nLinesDone < nYSize )
+        eErr = CE_Failure;
+
+    if( eErr == CE_None )
+        pfnProgress( 1.0, "", pProgressArg );
+
+    return eErr;
+}
+
+/************************************************************************/
+/*                            MergeStrips()                             */
+/*                                                                      */
+/*      Merge the strip components connected across seams, and          */
+/*      number the final components.                                    */
+/************************************************************************/
+
+void GDALConnectedComponents::MergeStrips()
+{
+    const int nStrips = static_cast<int>(apsStrips.size());
+    std::vector<int> anStripOffset( nStrips + 1, 0 );
+    for( int iStrip = 0; iStrip < nStrips; iStrip++ )
+        anStripOffset[iStrip+1] = anStripOffset[iStrip] +
+            static_cast<int>(apsStrips[iStrip]->anLocalSize.size());
+
+    std::vector<int> anParent( anStripOffset[nStrips] );
+    for( int i = 0; i < anStripOffset[nStrips]; i++ )
+        anParent[i] = i;
+
+/* -------------------------------------------------------------------- */
+/*      Union the components that touch across each seam.               */
+/* -------------------------------------------------------------------- */
+    for( int iStrip = 1; iStrip < nStrips; iStrip++ )
+    {
+        const GDALCCStrip *psAbove = apsStrips[iStrip-1];
+        const GDALCCStrip *psBelow = apsStrips[iStrip];
+        const int nOffAbove = anStripOffset[iStrip-1];
+        const int nOffBelow = anStripOffset[iStrip];
+
+        for( int iX = 0; iX < nXSize; iX++ )
+        {
+            const int iBelow = psBelow->anTopLocal[iX];
+            if( iBelow < 0 )
+                continue;
+            const GInt32 nVal = psBelow->anTopVal[iX];
+
+            for( int iDX = -1; iDX <= 1; iDX++ )
+            {
+                if( iDX != 0 && nConnectedness != 8 )
+                    continue;
+                const int iXAbove = iX + iDX;
+                if( iXAbove < 0 || iXAbove >= nXSize )
+                    continue;
+
+                const int iAbove = psAbove->anBottomLocal[iXAbove];
+                if( iAbove >= 0 && psAbove->anBottomVal[iXAbove] == nVal )
+                    CCUnion( anParent, nOffAbove + iAbove, nOffBelow + iBelow );
+            }
+        }
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Number the components in the order of their first pixel, and    */
+/*      accumulate their sizes.                                         */
+/* -------------------------------------------------------------------- */
+    std::vector<GInt32> anRootToComp( anStripOffset[nStrips], -1 );
+    anCompSize.clear();
+    anCompValue.clear();
+
+    for( int iStrip = 0; iStrip < nStrips; iStrip++ )
+    {
+        GDALCCStrip *psStrip = apsStrips[iStrip];
+        const int nLocals = static_cast<int>(psStrip->anLocalSize.size());
+
+        psStrip->nFirstComp = static_cast<int>(anCompSize.size());
+        psStrip->anLocalToComp.resize( nLocals );
+
+        for( int iLocal = 0; iLocal < nLocals; iLocal++ )
+        {
+            const int nRoot = CCFindRoot( anParent,
+                                          anStripOffset[iStrip] + iLocal );
+            if( anRootToComp[nRoot] < 0 )
+            {
+                anRootToComp[nRoot] = static_cast<int>(anCompSize.size());
+                anCompSize.push_back( 0 );
+                anCompValue.push_back( psStrip->anLocalValue[iLocal] );
+            }
+
+            const int iComp = anRootToComp[nRoot];
+            psStrip->anLocalToComp[iLocal] = iComp;
+
+            GIntBig nSize = anCompSize[iComp];
+            nSize += psStrip->anLocalSize[iLocal];
+            if( nSize > MY_MAX_INT )
+                nSize = MY_MAX_INT;
+            anCompSize[iComp] = static_cast<int>(nSize);
+        }
+
+        psStrip->nEndComp = static_cast<int>(anCompSize.size());
+
+        psStrip->anBottomComp.resize( nXSize );
+        for( int iX = 0; iX < nXSize; iX++ )
+        {
+            const int iLocal = psStrip->anBottomLocal[iX];
+            psStrip->anBottomComp[iX] =
+                (iLocal >= 0) ? psStrip->anLocalToComp[iLocal] : -1;
+        }
+
+        // Only needed for the seams.
+        std::vector<GInt32>().swap( psStrip->anTopLocal );
+        std::vector<GInt32>().swap( psStrip->anTopVal );
+        std::vector<GInt32>().swap( psStrip->anBottomLocal );
+        std::vector<GInt32>().swap( psStrip->anBottomVal );
+        std::vector<int>().swap( psStrip->anLocalSize );
+        std::vector<GInt32>().swap( psStrip->anLocalValue );
+    }
+
+    CPLDebug( "GDALConnectedComponents",
+              "%d components found in %d strips",
+              static_cast<int>(anCompSize.size()), nStrips );
+}
+
+/************************************************************************/
+/*                               Label()                                */
+/*                                                                      */
+/*      Find the connected components of the source band. This must     */
+/*      be called before ProcessLines().                                */
+/************************************************************************/
+
+CPLErr GDALConnectedComponents::Label( GDALProgressFunc pfnProgressIn,
+                                       void *pProgressArgIn )
+{
+    CPLErr eErr = RunPass( CC_PASS_LABEL, pfnProgressIn, pProgressArgIn );
+    if( eErr == CE_None )
+        MergeStrips();
+    return eErr;
+}
+
+/************************************************************************/
+/*                            ProcessLines()                            */
+/*                                                                      */
+/*      Call pfnFunc on every line with the component id of each        */
+/*      pixel, and write the output values to hDstBandIn if it is not   */
+/*      NULL.                                                           */
+/************************************************************************/
+
+CPLErr GDALConnectedComponents::ProcessLines( GDALComponentLineFunc pfnFunc,
+                                              void *pUserData,
+                                              GDALRasterBandH hDstBandIn,
+                                              GDALProgressFunc pfnProgressIn,
+                                              void *pProgressArgIn )
+{
+    pfnLineFunc = pfnFunc;
+    pLineUserData = pUserData;
+    hDstBand = hDstBandIn;
+
+    CPLErr eErr = RunPass( CC_PASS_LINES, pfnProgressIn, pProgressArgIn );
+
+    pfnLineFunc = NULL;
+    pLineUserData = NULL;
+    hDstBand = NULL;
+
+    return eErr;
+}
+
+/************************************************************************/
+/*                          GPLabelLineFunc()                           */
+/************************************************************************/
+
+static CPLErr GPLabelLineFunc( void * /* pUserData */, int /* iStrip */,
+                               int /* iY */, int nXSize,
+                               const GInt32 * /* panVal */,
+                               const GInt32 *panComp,
+                               const GInt32 * /* panLastComp */,
+                               GInt32 *panOutVal )
+{
+    for( int iX = 0; iX < nXSize; iX++ )
+        panOutVal[iX] = panComp[iX] + 1;
+    return CE_None;
+}
+
+/************************************************************************/
+/*                    GDALLabelConnectedComponents()                    */
+/************************************************************************/
+
+/**
+ * Label the connected components of a raster.
+ *
+ * Connected components are determined (per GDALRasterPolygonEnumerator) as
+ * regions of the raster where the pixels all have the same value, and that
+ * are contiguous (connected). Each pixel of the output band is set to the
+ * number of its component, starting at 1, with the components numbered in
+ * the order of their first pixel in the raster. Pixels determined to be
+ * "nodata" per hMaskBand are set to 0.
+ *
+ * The raster is processed by strips of lines, that can be labeled by
+ * several threads, and merged together afterwards. The result does not
+ * depend on the strip height nor on the number of threads.
+ *
+ * The output band should be of a data type large enough to hold the number
+ * of components, typically GDT_Int32 or GDT_UInt32.
+ *
+ * @param hSrcBand the source raster band to be processed.
+ * @param hMaskBand an optional mask band.  All pixels in the mask band with a
+ * value other than zero will be considered suitable for inclusion in
+ * components.
+ * @param hDstBand the output raster band.
+ * @param nConnectedness either 4 indicating that diagonal pixels are not
+ * considered directly adjacent for component membership purposes or 8
+ * indicating they are.
+ * @param papszOptions algorithm options in name=value list form.
+ * <ul>
+ * <li>NUM_THREADS=number or ALL_CPUS: number of worker threads. Defaults
+ * to 1.</li>
+ * <li>TILE_HEIGHT=number: height in lines of the strips. Defaults to
+ * the raster height divided by the number of threads, with a maximum of
+ * 1024.</li>
+ * </ul>
+ * @param pfnProgress callback for reporting algorithm progress matching the
+ * GDALProgressFunc() semantics.  May be NULL.
+ * @param pProgressArg callback argument passed to pfnProgress.
+ *
+ * @return CE_None on success or CE_Failure if an error occurs.
+ *
+ * @since GDAL 2.2
+ */
+
+CPLErr CPL_STDCALL
+GDALLabelConnectedComponents( GDALRasterBandH hSrcBand,
+                              GDALRasterBandH hMaskBand,
+                              GDALRasterBandH hDstBand,
+                              int nConnectedness,
+                              char **papszOptions,
+                              GDALProgressFunc pfnProgress,
+                              void *pProgressArg )
+{
+    VALIDATE_POINTER1( hSrcBand, "GDALLabelConnectedComponents", CE_Failure );
+    VALIDATE_POINTER1( hDstBand, "GDALLabelConnectedComponents", CE_Failure );
+
+    if( nConnectedness != 4 && nConnectedness != 8 )
+    {
+        CPLError( CE_Failure, CPLE_IllegalArg,
+                  "Invalid connectedness: %d", nConnectedness );
+        return CE_Failure;
+    }
+
+    if( pfnProgress == NULL )
+        pfnProgress = GDALDummyProgress;
+
+    GDALConnectedComponents oCC( hSrcBand, hMaskBand, nConnectedness,
+                                 papszOptions );
+
+    void *pScaledProgress =
+        GDALCreateScaledProgress( 0.0, 0.5, pfnProgress, pProgressArg );
+    CPLErr eErr = oCC.Label( GDALScaledProgress, pScaledProgress );
+    GDALDestroyScaledProgress( pScaledProgress );
+
+    if( eErr == CE_None )
+    {
+        pScaledProgress =
+            GDALCreateScaledProgress( 0.5, 1.0, pfnProgress, pProgressArg );
+        eErr = oCC.ProcessLines( GPLabelLineFunc, NULL, hDstBand,
+                                 GDALScaledProgress, pScaledProgress );
+        GDALDestroyScaledProgress( pScaledProgress );
+    }
+
+    return eErr;
+}
@@ -29,11 +29,13 @@
  ****************************************************************************/
 
 #include "cpl_vsi.h"
+#include "cpl_quad_tree.h"
 #include "cpl_string.h"
 #include "gdalgrid.h"
 #include <float.h>
 #include <limits.h>
-#include <map>
+#include <algorithm>
+#include <vector>
 #include "cpl_worker_thread_pool.h"
 #include "gdalgrid_priv.h"
 #include <cstdlib>
@@ -51,21 +53,369 @@ CPL_CVSID("$Id$");
 #endif /* DBL_MAX */
 
 /************************************************************************/
-/*                        GDALGridGetPointBounds()                      */
+/*                      GDALGridReserveCandidates()                     */
 /************************************************************************/
 
-static void GDALGridGetPointBounds(const void* hFeature, CPLRectObj* pBounds)
+static bool GDALGridReserveCandidates( GDALGridExtraParameters* psExtraParams,
+                                       size_t nCount )
 {
-    GDALGridPoint* psPoint = (GDALGridPoint*) hFeature;
-    GDALGridXYArrays* psXYArrays = psPoint->psXYArrays;
-    int i = psPoint->i;
-    double dfX = psXYArrays->padfX[i];
-    double dfY = psXYArrays->padfY[i];
-    pBounds->minx = dfX;
-    pBounds->miny = dfY;
-    pBounds->maxx = dfX;
-    pBounds->maxy = dfY;
-};
+    if( nCount <= psExtraParams->nCandidatesAlloc )
+        return true;
+    size_t nNewAlloc = nCount + nCount / 2 + 64;
+    GUInt32* panNew = (GUInt32*) VSI_REALLOC_VERBOSE(
+        psExtraParams->panCandidates, nNewAlloc * sizeof(GUInt32) );
+    if( panNew == NULL )
+        return false;
+    psExtraParams->panCandidates = panNew;
+    psExtraParams->nCandidatesAlloc = nNewAlloc;
+    return true;
+}
+
+/************************************************************************/
+/*                      GDALGridReserveNeighbours()                     */
+/************************************************************************/
+
+static bool GDALGridReserveNeighbours( GDALGridExtraParameters* psExtraParams,
+                                       size_t nCount )
+{
+    if( nCount <= psExtraParams->nNeighboursAlloc )
+        return true;
+    size_t nNewAlloc = nCount + nCount / 2 + 64;
+    GDALGridPointDist* pasNew = (GDALGridPointDist*) VSI_REALLOC_VERBOSE(
+        psExtraParams->pasNeighbours, nNewAlloc * sizeof(GDALGridPointDist) );
+    if( pasNew == NULL )
+        return false;
+    psExtraParams->pasNeighbours = pasNew;
+    psExtraParams->nNeighboursAlloc = nNewAlloc;
+    return true;
+}
+
+/************************************************************************/
+/*                     GDALGridPointIndexCellRange()                    */
+/************************************************************************/
+
+/* Compute the range of cells intersecting [dfMin, dfMax] along one axis. */
+/* Returns false if the range is outside of the index. */
+static bool GDALGridPointIndexCellRange( double dfMin, double dfMax,
+                                         double dfOrigin, double dfInvCellSize,
+                                         int nCells, int* pnFirst, int* pnLast )
+{
+    const double dfFirst = floor( (dfMin - dfOrigin) * dfInvCellSize );
+    const double dfLast = floor( (dfMax - dfOrigin) * dfInvCellSize );
+    if( !(dfLast >= 0) || !(dfFirst < nCells) )
+        return false;
+    *pnFirst = dfFirst < 0 ? 0 : (int)dfFirst;
+    *pnLast = dfLast >= nCells - 1 ? nCells - 1 : (int)dfLast;
+    return true;
+}
+
+/************************************************************************/
+/*                    GDALGridPointIndexGetCellRect()                   */
+/************************************************************************/
+
+/**
+ * Compute the rectangle of cells of the point index that intersect the
+ * rectangle of half-width dfHalfWidthX and half-height dfHalfWidthY centered
+ * on (dfXPoint, dfYPoint). The rectangle is enlarged a bit so that rounding
+ * errors in the ellipse tests of the callers cannot accept a point of a cell
+ * outside of it.
+ *
+ * @return false if no cell intersects the rectangle.
+ */
+
+bool GDALGridPointIndexGetCellRect( const GDALGridPointIndex* psIndex,
+                                    double dfXPoint, double dfYPoint,
+                                    double dfHalfWidthX, double dfHalfWidthY,
+                                    int* pnCellX0, int* pnCellY0,
+                                    int* pnCellX1, int* pnCellY1 )
+{
+    dfHalfWidthX += 1e-9 * (dfHalfWidthX + fabs(dfXPoint));
+    dfHalfWidthY += 1e-9 * (dfHalfWidthY + fabs(dfYPoint));
+
+    return GDALGridPointIndexCellRange( dfXPoint - dfHalfWidthX,
+                                        dfXPoint + dfHalfWidthX,
+                                        psIndex->dfMinX,
+                                        psIndex->dfInvCellSize,
+                                        psIndex->nCellsX,
+                                        pnCellX0, pnCellX1 ) &&
+           GDALGridPointIndexCellRange( dfYPoint - dfHalfWidthY,
+                                        dfYPoint + dfHalfWidthY,
+                                        psIndex->dfMinY,
+                                        psIndex->dfInvCellSize,
+                                        psIndex->nCellsY,
+                                        pnCellY0, pnCellY1 );
+}
+
+/************************************************************************/
+/*                        GDALGridGetCandidates()                       */
+/************************************************************************/
+
+/**
+ * Collect the points of the cells of the point index that intersect the
+ * rectangle of half-width dfHalfWidthX and half-height dfHalfWidthY centered
+ * on (dfXPoint, dfYPoint). This is a superset of the points located in the
+ * search ellipse inscribed in that rectangle.
+ *
+ * The candidates are returned in increasing index order, so that callers
+ * visit them in the same order as a scan of the whole point array would.
+ *
+ * @return the array of candidate point indices, or NULL if there is no point
+ * index or if the candidates are a large part of the points, in which case
+ * *pnCount is left unchanged and the caller must scan all the points.
+ */
+
+static const GUInt32* GDALGridGetCandidates( void* hExtraParamsIn,
+                                             double dfXPoint, double dfYPoint,
+                                             double dfHalfWidthX,
+                                             double dfHalfWidthY,
+                                             GUInt32* pnCount )
+{
+    GDALGridExtraParameters* psExtraParams =
+        (GDALGridExtraParameters*) hExtraParamsIn;
+    if( psExtraParams == NULL || psExtraParams->psPointIndex == NULL )
+        return NULL;
+    const GDALGridPointIndex* psIndex = psExtraParams->psPointIndex;
+
+    // Make sure a non NULL array is returned, even if empty.
+    if( !GDALGridReserveCandidates( psExtraParams, 1 ) )
+        return NULL;
+
+    int nCellX0, nCellX1, nCellY0, nCellY1;
+    if( !GDALGridPointIndexGetCellRect( psIndex, dfXPoint, dfYPoint,
+                                        dfHalfWidthX, dfHalfWidthY,
+                                        &nCellX0, &nCellY0,
+                                        &nCellX1, &nCellY1 ) )
+    {
+        *pnCount = 0;
+        return psExtraParams->panCandidates;
+    }
+
+    const GUInt32* panCellStart = psIndex->panCellStart;
+    size_t nCount = 0;
+    for( int iY = nCellY0; iY <= nCellY1; iY++ )
+    {
+        const size_t iRow = (size_t)iY * psIndex->nCellsX;
+        nCount += panCellStart[iRow + nCellX1 + 1] -
+                  panCellStart[iRow + nCellX0];
+    }
+    // When the search area covers a large part of the points, scanning all
+    // of them is cheaper than sorting the candidates.
+    const size_t nPoints = panCellStart[(size_t)psIndex->nCellsX *
+                                        psIndex->nCellsY];
+    if( nCount > nPoints / 4 ||
+        !GDALGridReserveCandidates( psExtraParams, nCount ) )
+        return NULL;
+
+    GUInt32* panCandidates = psExtraParams->panCandidates;
+    nCount = 0;
+    for( int iY = nCellY0; iY <= nCellY1; iY++ )
+    {
+        const size_t iRow = (size_t)iY * psIndex->nCellsX;
+        const GUInt32 nStart = panCellStart[iRow + nCellX0];
+        const GUInt32 nEnd = panCellStart[iRow + nCellX1 + 1];
+        memcpy( panCandidates + nCount, psIndex->panPointIdx + nStart,
+                (nEnd - nStart) * sizeof(GUInt32) );
+        nCount += nEnd - nStart;
+    }
+    std::sort( panCandidates, panCandidates + nCount );
+
+    *pnCount = (GUInt32)nCount;
+    return panCandidates;
+}
+
+/************************************************************************/
+/*                     GDALGridGetEllipseCandidates()                   */
+/************************************************************************/
+
+/* Same as GDALGridGetCandidates(), for a search ellipse with the given */
+/* radii and rotation. A zero radius means that all points are searched. */
+static const GUInt32* GDALGridGetEllipseCandidates( void* hExtraParamsIn,
+                                                    double dfXPoint,
+                                                    double dfYPoint,
+                                                    double dfRadius1,
+                                                    double dfRadius2,
+                                                    bool bRotated,
+                                                    GUInt32* pnCount )
+{
+    if( dfRadius1 <= 0.0 || dfRadius2 <= 0.0 )
+        return NULL;
+    if( bRotated )
+    {
+        dfRadius1 = MAX(dfRadius1, dfRadius2);
+        dfRadius2 = dfRadius1;
+    }
+    return GDALGridGetCandidates( hExtraParamsIn, dfXPoint, dfYPoint,
+                                  dfRadius1, dfRadius2, pnCount );
+}
+
+/************************************************************************/
+/*                      GDALGridPointDistCompare()                      */
+/************************************************************************/
+
+/* Orders the neighbours by increasing distance, then by nOrder, which is */
+/* the order in which the points are found by a search of the quadtree of */
+/* the points (or the input order without point index).                  */
+static bool GDALGridPointDistCompare( const GDALGridPointDist& sA,
+                                      const GDALGridPointDist& sB )
+{
+    if( sA.dfR2 != sB.dfR2 )
+        return sA.dfR2 < sB.dfR2;
+    return sA.nOrder < sB.nOrder;
+}
+
+/************************************************************************/
+/*                    GDALGridPointDistCompareLast()                    */
+/************************************************************************/
+
+/* Same as GDALGridPointDistCompare(), except that among points at the    */
+/* same distance, the one with the highest index comes first, as the      */
+/* brute force nearest neighbour search keeps the last one it finds.      */
+static bool GDALGridPointDistCompareLast( const GDALGridPointDist& sA,
+                                          const GDALGridPointDist& sB )
+{
+    if( sA.dfR2 != sB.dfR2 )
+        return sA.dfR2 < sB.dfR2;
+    return sA.nIdx > sB.nIdx;
+}
+
+/************************************************************************/
+/*                       GDALGridGetNearestPoints()                     */
+/************************************************************************/
+
+/**
+ * Find the nMaxPoints nearest points of (dfXPoint, dfYPoint) that are
+ * within a distance whose square is dfMaxR2, with the point index.
+ *
+ * The cells are visited by rings of increasing distance around the cell of
+ * the grid node, until the nMaxPoints found points are closer than any
+ * point of the cells not yet visited.
+ *
+ * @param nMaxPoints maximum number of points to return, or 0 to return
+ * all points within the search distance.
+ * @param dfMaxR2 squared search distance, or a negative value for no limit.
+ *
+ * @return the number of points found, stored in the pasNeighbours buffer of
+ * the extra parameters, sorted with pfnCompare, or -1 in case of memory
+ * allocation failure.
+ */
+
+typedef bool (*GDALGridPointDistCompareFunc)( const GDALGridPointDist&,
+                                              const GDALGridPointDist& );
+
+static int GDALGridGetNearestPoints( GDALGridExtraParameters* psExtraParams,
+                                     const double *padfX, const double *padfY,
+                                     double dfXPoint, double dfYPoint,
+                                     GUInt32 nMaxPoints, double dfMaxR2,
+                                     GDALGridPointDistCompareFunc pfnCompare )
+{
+    const GDALGridPointIndex* psIndex = psExtraParams->psPointIndex;
+    const int nCellsX = psIndex->nCellsX;
+    const int nCellsY = psIndex->nCellsY;
+    const double dfCellSize = psIndex->dfCellSize;
+
+    // Cell of the grid node, or nearest cell if it is outside of the index.
+    double dfCell = floor( (dfXPoint - psIndex->dfMinX) *
+                           psIndex->dfInvCellSize );
+    const int nCenterX = dfCell < 0 ? 0 :
+                         dfCell >= nCellsX - 1 ? nCellsX - 1 : (int)dfCell;
+    dfCell = floor( (dfYPoint - psIndex->dfMinY) * psIndex->dfInvCellSize );
+    const int nCenterY = dfCell < 0 ? 0 :
+                         dfCell >= nCellsY - 1 ? nCellsY - 1 : (int)dfCell;
+
+    size_t nFound = 0;
+    for( int nRing = 0; ; nRing++ )
+    {
+        const int nX0 = nCenterX - nRing;
+        const int nX1 = nCenterX + nRing;
+        const int nY0 = nCenterY - nRing;
+        const int nY1 = nCenterY + nRing;
+
+        for( int iY = MAX(nY0, 0); iY <= MIN(nY1, nCellsY - 1); iY++ )
+        {
+            // Only the border of the square of cells is not visited yet.
+            const int nStep = ( iY == nY0 || iY == nY1 ) ? 1 : nX1 - nX0;
+            for( int iX = nX0; iX <= nX1; iX += MAX(nStep, 1) )
+            {
+                if( iX < 0 || iX >= nCellsX )
+                    continue;
+                const size_t iCell = (size_t)iY * nCellsX + iX;
+                const GUInt32 nStart = psIndex->panCellStart[iCell];
+                const GUInt32 nEnd = psIndex->panCellStart[iCell + 1];
+                if( !GDALGridReserveNeighbours( psExtraParams,
+                                                nFound + nEnd - nStart ) )
+                    return -1;
+                GDALGridPointDist* pasNeighbours = psExtraParams->pasNeighbours;
+                for( GUInt32 k = nStart; k < nEnd; k++ )
+                {
+                    const GUInt32 i = psIndex->panPointIdx[k];
+                    const double dfRX = padfX[i] - dfXPoint;
+                    const double dfRY = padfY[i] - dfYPoint;
+                    const double dfR2 = dfRX * dfRX + dfRY * dfRY;
+                    if( dfMaxR2 < 0 || dfR2 <= dfMaxR2 )
+                    {
+                        pasNeighbours[nFound].dfR2 = dfR2;
+                        pasNeighbours[nFound].nIdx = i;
+                        pasNeighbours[nFound].nOrder =
+                            psIndex->panSearchOrder ?
+                                psIndex->panSearchOrder[i] : i;
+                        nFound++;
+                    }
+                }
+            }
+        }
+
+        if( nX0 <= 0 && nY0 <= 0 && nX1 >= nCellsX - 1 && nY1 >= nCellsY - 1 )
+            break;
+
+        // Lower bound of the distance to the points of the cells that have
+        // not been visited yet, reduced a bit against rounding errors.
+        double dfMinDist = DBL_MAX;
+        if( nX0 > 0 )
+            dfMinDist = MIN( dfMinDist, dfXPoint -
+                             (psIndex->dfMinX + nX0 * dfCellSize) );
+        if( nX1 < nCellsX - 1 )
+            dfMinDist = MIN( dfMinDist, psIndex->dfMinX +
+                             (nX1 + 1) * dfCellSize - dfXPoint );
+        if( nY0 > 0 )
+            dfMinDist = MIN( dfMinDist, dfYPoint -
+                             (psIndex->dfMinY + nY0 * dfCellSize) );
+        if( nY1 < nCellsY - 1 )
+            dfMinDist = MIN( dfMinDist, psIndex->dfMinY +
+                             (nY1 + 1) * dfCellSize - dfYPoint );
+        dfMinDist -= 1e-9 * dfCellSize;
+        if( dfMinDist <= 0 )
+            continue;
+        const double dfMinR2 = dfMinDist * dfMinDist;
+
+        if( dfMaxR2 >= 0 && dfMinR2 > dfMaxR2 )
+            break;
+        if( nMaxPoints > 0 && nFound >= nMaxPoints )
+        {
+            std::nth_element( psExtraParams->pasNeighbours,
+                              psExtraParams->pasNeighbours + nMaxPoints - 1,
+                              psExtraParams->pasNeighbours + nFound,
+                              pfnCompare );
+            if( psExtraParams->pasNeighbours[nMaxPoints - 1].dfR2 < dfMinR2 )
+                break;
+        }
+    }
+
+    if( nMaxPoints > 0 && nFound > nMaxPoints )
+    {
+        std::partial_sort( psExtraParams->pasNeighbours,
+                           psExtraParams->pasNeighbours + nMaxPoints,
+                           psExtraParams->pasNeighbours + nFound,
+                           pfnCompare );
+        nFound = nMaxPoints;
+    }
+    else
+    {
+        std::sort( psExtraParams->pasNeighbours,
+                   psExtraParams->pasNeighbours + nFound,
+                   pfnCompare );
+    }
+    return (int)nFound;
+}
 
 /************************************************************************/
 /*                   GDALGridInverseDistanceToAPower()                  */
@@ -123,7 +473,7 @@ GDALGridInverseDistanceToAPower( const void *poOptions, GUInt32 nPoints,
                                  const double *padfZ,
                                  double dfXPoint, double dfYPoint,
                                  double *pdfValue,
-                                 CPL_UNUSED void* hExtraParamsIn )
+                                 void* hExtraParamsIn )
 {
     // TODO: For optimization purposes pre-computed parameters should be moved
     // out of this routine to the calling function.
@@ -135,6 +485,12 @@ GDALGridInverseDistanceToAPower( const void *poOptions, GUInt32 nPoints,
         ((GDALGridInverseDistanceToAPowerOptions *)poOptions)->dfRadius2;
     double  dfR12;
 
+    GUInt32 nCandidates = nPoints;
+    const GUInt32* panCandidates = GDALGridGetEllipseCandidates(
+        hExtraParamsIn, dfXPoint, dfYPoint, dfRadius1, dfRadius2,
+        ((GDALGridInverseDistanceToAPowerOptions *)poOptions)->dfAngle != 0.0,
+        &nCandidates );
+
     dfRadius1 *= dfRadius1;
     dfRadius2 *= dfRadius2;
     dfR12 = dfRadius1 * dfRadius2;
@@ -157,10 +513,11 @@ GDALGridInverseDistanceToAPower( const void *poOptions, GUInt32 nPoints,
     const GUInt32   nMaxPoints =
         ((GDALGridInverseDistanceToAPowerOptions *)poOptions)->nMaxPoints;
     double  dfNominator = 0.0, dfDenominator = 0.0;
-    GUInt32 i, n = 0;
+    GUInt32 n = 0;
 
-    for ( i = 0; i < nPoints; i++ )
+    for ( GUInt32 k = 0; k < nCandidates; k++ )
     {
+        const GUInt32 i = panCandidates ? panCandidates[k] : k;
         double  dfRX = padfX[i] - dfXPoint;
         double  dfRY = padfY[i] - dfYPoint;
         const double dfR2 =
@@ -218,6 +575,10 @@ GDALGridInverseDistanceToAPower( const void *poOptions, GUInt32 nPoints,
  * Inverse distance to a power with nearest neighbor search, ideal when
  * max_points used.
  *
+ * The max_points nearest points within the search radius are used. Starting
+ * with GDAL 2.2, if the radius is zero, the max_points nearest points are
+ * used, whatever their distance.
+ *
  * The Inverse Distance to a Power gridding method is a weighted average
  * interpolator. You should supply the input arrays with the scattered data
  * values including coordinates of every data point and output grid geometry.
@@ -278,50 +639,43 @@ GDALGridInverseDistanceToAPowerNearestNeighbor( const void *poOptions, GUInt32 n
     GUInt32 n = 0;
 
     GDALGridExtraParameters* psExtraParams = (GDALGridExtraParameters*) hExtraParamsIn;
-    CPLQuadTree* phQuadTree = psExtraParams->hQuadTree;
 
     const double dfRPower2 = psExtraParams->dfRadiusPower2PreComp;
     const double dfRPower4 = psExtraParams->dfRadiusPower4PreComp;
 
     const double dfPowerDiv2 = psExtraParams->dfPowerDiv2PreComp;
 
-    std::multimap<double, double> oMapDistanceToZValues;
-    if (phQuadTree != NULL)
-    {
-        CPLRectObj sAoi;
-        double dfSearchRadius = dfRadius;
-        sAoi.minx = dfXPoint - dfSearchRadius;
-        sAoi.miny = dfYPoint - dfSearchRadius;
-        sAoi.maxx = dfXPoint + dfSearchRadius;
-        sAoi.maxy = dfYPoint + dfSearchRadius;
-        int nFeatureCount = 0;
-        GDALGridPoint** papsPoints = (GDALGridPoint**)
-                CPLQuadTreeSearch(phQuadTree, &sAoi, &nFeatureCount);
-        if (nFeatureCount != 0)
+    if (psExtraParams->psPointIndex != NULL)
+    {
+        /**
+         * Search the max_points nearest points within the radius (or without
+         * distance limit if the radius is zero) with the point index, and
+         * accumulate them from the nearest to the furthest.
+         */
+        const int nFound = GDALGridGetNearestPoints(
+            psExtraParams, padfX, padfY, dfXPoint, dfYPoint, nMaxPoints,
+            dfRadius > 0 ? dfRPower2 : -1.0, GDALGridPointDistCompare );
+        if (nFound < 0)
+            return CE_Failure;
+
+        const GDALGridPointDist* pasNeighbours = psExtraParams->pasNeighbours;
+        if (nFound > 0 && pasNeighbours[0].dfR2 < 0.0000000000001)
         {
-            for(int k = 0; k < nFeatureCount; k++)
-            {
-                int i = papsPoints[k]->i;
-                double  dfRX = padfX[i] - dfXPoint;
-                double  dfRY = padfY[i] - dfYPoint;
-
-                const double dfR2 = dfRX * dfRX + dfRY * dfRY;
-                if (dfR2 < 0.0000000000001)
-                {
-                    (*pdfValue) = padfZ[i];
-                    CPLFree(papsPoints);
-                    return CE_None;
-                }
-                if(dfR2 <= dfRPower2)
-                {
-                    oMapDistanceToZValues.insert(std::make_pair(dfR2, padfZ[i]));
-                }
-            }
+            (*pdfValue) = padfZ[pasNeighbours[0].nIdx];
+            return CE_None;
+        }
+        for (int k = 0; k < nFound; k++)
+        {
+            const double dfW = pow(pasNeighbours[k].dfR2, dfPowerDiv2);
+            double dfInvW = 1.0 / dfW;
+            dfNominator += dfInvW * padfZ[pasNeighbours[k].nIdx];
+            dfDenominator += dfInvW;
+            n++;
         }
-        CPLFree(papsPoints);
     }
     else
     {
+        std::vector<GDALGridPointDist> asNeighbours;
         for (GUInt32 i = 0; i < nPoints; i++)
         {
             double dfRX = padfX[i] - dfXPoint;
@@ -329,7 +683,8 @@ GDALGridInverseDistanceToAPowerNearestNeighbor( const void *poOptions, GUInt32 n
             const double dfR2 =    dfRX * dfRX + dfRY * dfRY;
 
             // Is this point located inside the search circle?
-            if (dfRPower2 * dfRX * dfRX + dfRPower2 * dfRY * dfRY <= dfRPower4)
+            if (dfRadius <= 0 ||
+                dfRPower2 * dfRX * dfRX + dfRPower2 * dfRY * dfRY <= dfRPower4)
             {
                 // If the test point is close to the grid node, use the point
                 // value directly as a node value to avoid singularity.
@@ -340,31 +695,32 @@ GDALGridInverseDistanceToAPowerNearestNeighbor( const void *poOptions, GUInt32 n
                 }
                 else
                 {
-                    oMapDistanceToZValues.insert(std::make_pair(dfR2, padfZ[i]));
+                    GDALGridPointDist sNeighbour;
+                    sNeighbour.dfR2 = dfR2;
+                    sNeighbour.nIdx = i;
+                    sNeighbour.nOrder = i;
+                    asNeighbours.push_back(sNeighbour);
                 }
             }
         }
-    }
-
-    /**
-     * Examine all "neighbors" within the radius (sorted by distance via the multimap), and use the
-     * closest n points based on distance until the max is reached.
-     */
-    for(std::multimap<double, double>::iterator oMapDistanceToZValuesIter = oMapDistanceToZValues.begin();
-        oMapDistanceToZValuesIter != oMapDistanceToZValues.end();
-        ++oMapDistanceToZValuesIter)
-    {
-        double dfR2 = (*oMapDistanceToZValuesIter).first;
-        double dfZ = (*oMapDistanceToZValuesIter).second;
 
-        const double dfW = pow(dfR2, dfPowerDiv2);
-        double dfInvW = 1.0 / dfW;
-        dfNominator += dfInvW * dfZ;
-        dfDenominator += dfInvW;
-        n++;
-        if (nMaxPoints > 0 && n >= nMaxPoints)
+        /**
+         * Examine all "neighbors" within the radius (sorted by distance), and use the
+         * closest n points based on distance until the max is reached.
+         */
+        std::sort(asNeighbours.begin(), asNeighbours.end(),
+                  GDALGridPointDistCompare);
+        for (size_t k = 0; k < asNeighbours.size(); k++)
         {
-            break;
+            const double dfW = pow(asNeighbours[k].dfR2, dfPowerDiv2);
+            double dfInvW = 1.0 / dfW;
+            dfNominator += dfInvW * padfZ[asNeighbours[k].nIdx];
+            dfDenominator += dfInvW;
+            n++;
+            if (nMaxPoints > 0 && n >= nMaxPoints)
+            {
+                break;
+            }
         }
     }
 
@@ -541,7 +897,7 @@ GDALGridMovingAverage( const void *poOptions, GUInt32 nPoints,
                        const double *padfX, const double *padfY,
                        const double *padfZ,
                        double dfXPoint, double dfYPoint, double *pdfValue,
-                       CPL_UNUSED void* hExtraParamsIn )
+                       void* hExtraParamsIn )
 {
     // TODO: For optimization purposes pre-computed parameters should be moved
     // out of this routine to the calling function.
@@ -551,6 +907,12 @@ GDALGridMovingAverage( const void *poOptions, GUInt32 nPoints,
     double  dfRadius2 = ((GDALGridMovingAverageOptions *)poOptions)->dfRadius2;
     double  dfR12;
 
+    GUInt32 nCandidates = nPoints;
+    const GUInt32* panCandidates = GDALGridGetEllipseCandidates(
+        hExtraParamsIn, dfXPoint, dfYPoint, dfRadius1, dfRadius2,
+        ((GDALGridMovingAverageOptions *)poOptions)->dfAngle != 0.0,
+        &nCandidates );
+
     dfRadius1 *= dfRadius1;
     dfRadius2 *= dfRadius2;
     dfR12 = dfRadius1 * dfRadius2;
@@ -567,10 +929,11 @@ GDALGridMovingAverage( const void *poOptions, GUInt32 nPoints,
     }
 
     double  dfAccumulator = 0.0;
-    GUInt32 i = 0, n = 0;
+    GUInt32 n = 0;
 
-    while ( i < nPoints )
+    for ( GUInt32 k = 0; k < nCandidates; k++ )
     {
+        const GUInt32 i = panCandidates ? panCandidates[k] : k;
         double  dfRX = padfX[i] - dfXPoint;
         double  dfRY = padfY[i] - dfYPoint;
 
@@ -589,8 +952,6 @@ GDALGridMovingAverage( const void *poOptions, GUInt32 nPoints,
             dfAccumulator += padfZ[i];
             n++;
         }
-
-        i++;
     }
 
     if ( n < ((GDALGridMovingAverageOptions *)poOptions)->nMinPoints
@@ -648,7 +1009,26 @@ GDALGridNearestNeighbor( const void *poOptions, GUInt32 nPoints,
         ((GDALGridNearestNeighborOptions *)poOptions)->dfRadius2;
     double  dfR12;
     GDALGridExtraParameters* psExtraParams = (GDALGridExtraParameters*) hExtraParamsIn;
-    CPLQuadTree* hQuadTree = psExtraParams->hQuadTree;
+
+    // Without search ellipse, find the nearest point with the point index.
+    if( dfRadius1 == 0.0 && dfRadius2 == 0.0 &&
+        psExtraParams != NULL && psExtraParams->psPointIndex != NULL )
+    {
+        const int nFound = GDALGridGetNearestPoints(
+            psExtraParams, padfX, padfY, dfXPoint, dfYPoint, 1, -1.0,
+            GDALGridPointDistCompareLast );
+        if( nFound < 0 )
+            return CE_Failure;
+        (*pdfValue) = nFound > 0 ? padfZ[psExtraParams->pasNeighbours[0].nIdx] :
+                ((GDALGridNearestNeighborOptions *)poOptions)->dfNoDataValue;
+        return CE_None;
+    }
+
+    GUInt32 nCandidates = nPoints;
+    const GUInt32* panCandidates = GDALGridGetEllipseCandidates(
+        hExtraParamsIn, dfXPoint, dfYPoint, dfRadius1, dfRadius2,
+        ((GDALGridNearestNeighborOptions *)poOptions)->dfAngle != 0.0,
+        &nCandidates );
 
     dfRadius1 *= dfRadius1;
     dfRadius2 *= dfRadius2;
@@ -671,82 +1051,31 @@ GDALGridNearestNeighbor( const void *poOptions, GUInt32 nPoints,
     // Nearest distance will be initialized with the distance to the first
     // point in array.
     double      dfNearestR = DBL_MAX;
-    GUInt32 i = 0;
 
-    double dfSearchRadius = psExtraParams->dfInitialSearchRadius;
-    if( hQuadTree != NULL && dfRadius1 == dfRadius2 && dfSearchRadius > 0 )
+    for ( GUInt32 k = 0; k < nCandidates; k++ )
     {
-        CPLRectObj sAoi;
-        if( dfRadius1 > 0 )
-            dfSearchRadius = ((GDALGridNearestNeighborOptions *)poOptions)->dfRadius1;
-        while(dfSearchRadius > 0)
-        {
-            sAoi.minx = dfXPoint - dfSearchRadius;
-            sAoi.miny = dfYPoint - dfSearchRadius;
-            sAoi.maxx = dfXPoint + dfSearchRadius;
-            sAoi.maxy = dfYPoint + dfSearchRadius;
-            int nFeatureCount = 0;
-            GDALGridPoint** papsPoints = (GDALGridPoint**)
-                    CPLQuadTreeSearch(hQuadTree, &sAoi, &nFeatureCount);
-            if( nFeatureCount != 0 )
-            {
-                if( dfRadius1 > 0 )
-                    dfNearestR = dfRadius1;
-                for(int k=0; k<nFeatureCount; k++)
-                {
-                    int idx = papsPoints[k]->i;
-                    double  dfRX = padfX[idx] - dfXPoint;
-                    double  dfRY = padfY[idx] - dfYPoint;
-
-                    const double    dfR2 = dfRX * dfRX + dfRY * dfRY;
-                    if( dfR2 <= dfNearestR )
-                    {
-                        dfNearestR = dfR2;
-                        dfNearestValue = padfZ[idx];
-                    }
-                }
+        const GUInt32 i = panCandidates ? panCandidates[k] : k;
+        double  dfRX = padfX[i] - dfXPoint;
+        double  dfRY = padfY[i] - dfYPoint;
 
-                CPLFree(papsPoints);
-                break;
-            }
-            else
-            {
-                CPLFree(papsPoints);
-                if( dfRadius1 > 0 )
-                    break;
-                dfSearchRadius *= 2;
-                //CPLDebug("GDAL_GRID", "Increasing search radius to %.16g", dfSearchRadius);
-            }
-        }
-    }
-    else
-    {
-        while ( i < nPoints )
+        if ( bRotated )
         {
-            double  dfRX = padfX[i] - dfXPoint;
-            double  dfRY = padfY[i] - dfYPoint;
-
-            if ( bRotated )
-            {
-                double dfRXRotated = dfRX * dfCoeff1 + dfRY * dfCoeff2;
-                double dfRYRotated = dfRY * dfCoeff1 - dfRX * dfCoeff2;
+            double dfRXRotated = dfRX * dfCoeff1 + dfRY * dfCoeff2;
+            double dfRYRotated = dfRY * dfCoeff1 - dfRX * dfCoeff2;
 
-                dfRX = dfRXRotated;
-                dfRY = dfRYRotated;
-            }
+            dfRX = dfRXRotated;
+            dfRY = dfRYRotated;
+        }
 
-            // Is this point located inside the search ellipse?
-            if ( dfRadius2 * dfRX * dfRX + dfRadius1 * dfRY * dfRY <= dfR12 )
+        // Is this point located inside the search ellipse?
+        if ( dfRadius2 * dfRX * dfRX + dfRadius1 * dfRY * dfRY <= dfR12 )
+        {
+            const double    dfR2 = dfRX * dfRX + dfRY * dfRY;
+            if ( dfR2 <= dfNearestR )
             {
-                const double    dfR2 = dfRX * dfRX + dfRY * dfRY;
-                if ( dfR2 <= dfNearestR )
-                {
-                    dfNearestR = dfR2;
-                    dfNearestValue = padfZ[i];
-                }
+                dfNearestR = dfR2;
+                dfNearestValue = padfZ[i];
             }
-
-            i++;
         }
     }
 
@@ -795,7 +1124,7 @@ GDALGridDataMetricMinimum( const void *poOptions, GUInt32 nPoints,
                            const double *padfX, const double *padfY,
                            const double *padfZ,
                            double dfXPoint, double dfYPoint, double *pdfValue,
-                           CPL_UNUSED void* hExtraParamsIn )
+                           void* hExtraParamsIn )
 {
     // TODO: For optimization purposes pre-computed parameters should be moved
     // out of this routine to the calling function.
@@ -807,6 +1136,12 @@ GDALGridDataMetricMinimum( const void *poOptions, GUInt32 nPoints,
         ((GDALGridDataMetricsOptions *)poOptions)->dfRadius2;
     double  dfR12;
 
+    GUInt32 nCandidates = nPoints;
+    const GUInt32* panCandidates = GDALGridGetEllipseCandidates(
+        hExtraParamsIn, dfXPoint, dfYPoint, dfRadius1, dfRadius2,
+        ((GDALGridDataMetricsOptions *)poOptions)->dfAngle != 0.0,
+        &nCandidates );
+
     dfRadius1 *= dfRadius1;
     dfRadius2 *= dfRadius2;
     dfR12 = dfRadius1 * dfRadius2;
@@ -823,10 +1158,11 @@ GDALGridDataMetricMinimum( const void *poOptions, GUInt32 nPoints,
     }
 
     double      dfMinimumValue=0.0;
-    GUInt32     i = 0, n = 0;
+    GUInt32     n = 0;
 
-    while ( i < nPoints )
+    for ( GUInt32 k = 0; k < nCandidates; k++ )
     {
+        const GUInt32 i = panCandidates ? panCandidates[k] : k;
         double  dfRX = padfX[i] - dfXPoint;
         double  dfRY = padfY[i] - dfYPoint;
 
@@ -851,8 +1187,6 @@ GDALGridDataMetricMinimum( const void *poOptions, GUInt32 nPoints,
                 dfMinimumValue = padfZ[i];
             n++;
         }
-
-        i++;
     }
 
     if ( n < ((GDALGridDataMetricsOptions *)poOptions)->nMinPoints
@@ -907,7 +1241,7 @@ GDALGridDataMetricMaximum( const void *poOptions, GUInt32 nPoints,
                            const double *padfX, const double *padfY,
                            const double *padfZ,
                            double dfXPoint, double dfYPoint, double *pdfValue,
-                           CPL_UNUSED void* hExtraParamsIn )
+                           void* hExtraParamsIn )
 {
     // TODO: For optimization purposes pre-computed parameters should be moved
     // out of this routine to the calling function.
@@ -919,6 +1253,12 @@ GDALGridDataMetricMaximum( const void *poOptions, GUInt32 nPoints,
         ((GDALGridDataMetricsOptions *)poOptions)->dfRadius2;
     double  dfR12;
 
+    GUInt32 nCandidates = nPoints;
+    const GUInt32* panCandidates = GDALGridGetEllipseCandidates(
+        hExtraParamsIn, dfXPoint, dfYPoint, dfRadius1, dfRadius2,
+        ((GDALGridDataMetricsOptions *)poOptions)->dfAngle != 0.0,
+        &nCandidates );
+
     dfRadius1 *= dfRadius1;
     dfRadius2 *= dfRadius2;
     dfR12 = dfRadius1 * dfRadius2;
@@ -935,10 +1275,11 @@ GDALGridDataMetricMaximum( const void *poOptions, GUInt32 nPoints,
     }
 
     double      dfMaximumValue=0.0;
-    GUInt32     i = 0, n = 0;
+    GUInt32     n = 0;
 
-    while ( i < nPoints )
+    for ( GUInt32 k = 0; k < nCandidates; k++ )
     {
+        const GUInt32 i = panCandidates ? panCandidates[k] : k;
         double  dfRX = padfX[i] - dfXPoint;
         double  dfRY = padfY[i] - dfYPoint;
 
@@ -963,8 +1304,6 @@ GDALGridDataMetricMaximum( const void *poOptions, GUInt32 nPoints,
                 dfMaximumValue = padfZ[i];
             n++;
         }
-
-        i++;
     }
 
     if ( n < ((GDALGridDataMetricsOptions *)poOptions)->nMinPoints
@@ -1020,7 +1359,7 @@ GDALGridDataMetricRange( const void *poOptions, GUInt32 nPoints,
                          const double *padfX, const double *padfY,
                          const double *padfZ,
                          double dfXPoint, double dfYPoint, double *pdfValue,
-                         CPL_UNUSED void* hExtraParamsIn )
+                         void* hExtraParamsIn )
 {
     // TODO: For optimization purposes pre-computed parameters should be moved
     // out of this routine to the calling function.
@@ -1032,6 +1371,12 @@ GDALGridDataMetricRange( const void *poOptions, GUInt32 nPoints,
         ((GDALGridDataMetricsOptions *)poOptions)->dfRadius2;
     double  dfR12;
 
+    GUInt32 nCandidates = nPoints;
+    const GUInt32* panCandidates = GDALGridGetEllipseCandidates(
+        hExtraParamsIn, dfXPoint, dfYPoint, dfRadius1, dfRadius2,
+        ((GDALGridDataMetricsOptions *)poOptions)->dfAngle != 0.0,
+        &nCandidates );
+
     dfRadius1 *= dfRadius1;
     dfRadius2 *= dfRadius2;
     dfR12 = dfRadius1 * dfRadius2;
@@ -1048,10 +1393,11 @@ GDALGridDataMetricRange( const void *poOptions, GUInt32 nPoints,
     }
 
     double      dfMaximumValue=0.0, dfMinimumValue=0.0;
-    GUInt32     i = 0, n = 0;
+    GUInt32     n = 0;
 
-    while ( i < nPoints )
+    for ( GUInt32 k = 0; k < nCandidates; k++ )
     {
+        const GUInt32 i = panCandidates ? panCandidates[k] : k;
         double  dfRX = padfX[i] - dfXPoint;
         double  dfRY = padfY[i] - dfYPoint;
 
@@ -1078,8 +1424,6 @@ GDALGridDataMetricRange( const void *poOptions, GUInt32 nPoints,
                 dfMinimumValue = dfMaximumValue = padfZ[i];
             n++;
         }
-
-        i++;
     }
 
     if ( n < ((GDALGridDataMetricsOptions *)poOptions)->nMinPoints
@@ -1132,7 +1476,7 @@ GDALGridDataMetricCount( const void *poOptions, GUInt32 nPoints,
                          const double *padfX, const double *padfY,
                          CPL_UNUSED const double *padfZ,
                          double dfXPoint, double dfYPoint, double *pdfValue,
-                         CPL_UNUSED void* hExtraParamsIn )
+                         void* hExtraParamsIn )
 {
     // TODO: For optimization purposes pre-computed parameters should be moved
     // out of this routine to the calling function.
@@ -1144,6 +1488,12 @@ GDALGridDataMetricCount( const void *poOptions, GUInt32 nPoints,
         ((GDALGridDataMetricsOptions *)poOptions)->dfRadius2;
     double  dfR12;
 
+    GUInt32 nCandidates = nPoints;
+    const GUInt32* panCandidates = GDALGridGetEllipseCandidates(
+        hExtraParamsIn, dfXPoint, dfYPoint, dfRadius1, dfRadius2,
+        ((GDALGridDataMetricsOptions *)poOptions)->dfAngle != 0.0,
+        &nCandidates );
+
     dfRadius1 *= dfRadius1;
     dfRadius2 *= dfRadius2;
     dfR12 = dfRadius1 * dfRadius2;
@@ -1159,10 +1509,11 @@ GDALGridDataMetricCount( const void *poOptions, GUInt32 nPoints,
         dfCoeff2 = sin(dfAngle);
     }
 
-    GUInt32     i = 0, n = 0;
+    GUInt32     n = 0;
 
-    while ( i < nPoints )
+    for ( GUInt32 k = 0; k < nCandidates; k++ )
     {
+        const GUInt32 i = panCandidates ? panCandidates[k] : k;
         double  dfRX = padfX[i] - dfXPoint;
         double  dfRY = padfY[i] - dfYPoint;
 
@@ -1178,8 +1529,6 @@ GDALGridDataMetricCount( const void *poOptions, GUInt32 nPoints,
         // Is this point located inside the search ellipse?
         if ( dfRadius2 * dfRX * dfRX + dfRadius1 * dfRY * dfRY <= dfR12 )
             n++;
-
-        i++;
     }
 
     if ( n < ((GDALGridDataMetricsOptions *)poOptions)->nMinPoints )
@@ -1236,7 +1585,7 @@ GDALGridDataMetricAverageDistance( const void *poOptions, GUInt32 nPoints,
                                    CPL_UNUSED const double *padfZ,
                                    double dfXPoint, double dfYPoint,
                                    double *pdfValue,
-                                   CPL_UNUSED void* hExtraParamsIn )
+                                   void* hExtraParamsIn )
 {
     // TODO: For optimization purposes pre-computed parameters should be moved
     // out of this routine to the calling function.
@@ -1248,6 +1597,12 @@ GDALGridDataMetricAverageDistance( const void *poOptions, GUInt32 nPoints,
         ((GDALGridDataMetricsOptions *)poOptions)->dfRadius2;
     double  dfR12;
 
+    GUInt32 nCandidates = nPoints;
+    const GUInt32* panCandidates = GDALGridGetEllipseCandidates(
+        hExtraParamsIn, dfXPoint, dfYPoint, dfRadius1, dfRadius2,
+        ((GDALGridDataMetricsOptions *)poOptions)->dfAngle != 0.0,
+        &nCandidates );
+
     dfRadius1 *= dfRadius1;
     dfRadius2 *= dfRadius2;
     dfR12 = dfRadius1 * dfRadius2;
@@ -1264,10 +1619,11 @@ GDALGridDataMetricAverageDistance( const void *poOptions, GUInt32 nPoints,
     }
 
     double      dfAccumulator = 0.0;
-    GUInt32     i = 0, n = 0;
+    GUInt32     n = 0;
 
-    while ( i < nPoints )
+    for ( GUInt32 k = 0; k < nCandidates; k++ )
     {
+        const GUInt32 i = panCandidates ? panCandidates[k] : k;
         double  dfRX = padfX[i] - dfXPoint;
         double  dfRY = padfY[i] - dfYPoint;
 
@@ -1286,8 +1642,6 @@ GDALGridDataMetricAverageDistance( const void *poOptions, GUInt32 nPoints,
             dfAccumulator += sqrt( dfRX * dfRX + dfRY * dfRY );
             n++;
         }
-
-        i++;
     }
 
     if ( n < ((GDALGridDataMetricsOptions *)poOptions)->nMinPoints
@@ -1347,7 +1701,7 @@ GDALGridDataMetricAverageDistancePts( const void *poOptions, GUInt32 nPoints,
                                       CPL_UNUSED const double *padfZ,
                                       double dfXPoint, double dfYPoint,
                                       double *pdfValue,
-                                      CPL_UNUSED void* hExtraParamsIn )
+                                      void* hExtraParamsIn )
 {
     // TODO: For optimization purposes pre-computed parameters should be moved
     // out of this routine to the calling function.
@@ -1359,6 +1713,12 @@ GDALGridDataMetricAverageDistancePts( const void *poOptions, GUInt32 nPoints,
         ((GDALGridDataMetricsOptions *)poOptions)->dfRadius2;
     double  dfR12;
 
+    GUInt32 nCandidates = nPoints;
+    const GUInt32* panCandidates = GDALGridGetEllipseCandidates(
+        hExtraParamsIn, dfXPoint, dfYPoint, dfRadius1, dfRadius2,
+        ((GDALGridDataMetricsOptions *)poOptions)->dfAngle != 0.0,
+        &nCandidates );
+
     dfRadius1 *= dfRadius1;
     dfRadius2 *= dfRadius2;
     dfR12 = dfRadius1 * dfRadius2;
@@ -1375,11 +1735,12 @@ GDALGridDataMetricAverageDistancePts( const void *poOptions, GUInt32 nPoints,
     }
 
     double      dfAccumulator = 0.0;
-    GUInt32     i = 0, n = 0;
+    GUInt32     n = 0;
 
     // Search for the first point within the search ellipse
-    while ( i < nPoints - 1 )
+    for ( GUInt32 k = 0; k + 1 < nCandidates; k++ )
     {
+        const GUInt32 i = panCandidates ? panCandidates[k] : k;
         double  dfRX1 = padfX[i] - dfXPoint;
         double  dfRY1 = padfY[i] - dfYPoint;
 
@@ -1395,12 +1756,11 @@ GDALGridDataMetricAverageDistancePts( const void *poOptions, GUInt32 nPoints,
         // Is this point located inside the search ellipse?
         if ( dfRadius2 * dfRX1 * dfRX1 + dfRadius1 * dfRY1 * dfRY1 <= dfR12 )
         {
-            GUInt32 j;
-
             // Search all the remaining points within the ellipse and compute
             // distances between them and the first point
-            for ( j = i + 1; j < nPoints; j++ )
+            for ( GUInt32 l = k + 1; l < nCandidates; l++ )
             {
+                const GUInt32 j = panCandidates ? panCandidates[l] : l;
                 double  dfRX2 = padfX[j] - dfXPoint;
                 double  dfRY2 = padfY[j] - dfYPoint;
 
@@ -1423,8 +1783,6 @@ GDALGridDataMetricAverageDistancePts( const void *poOptions, GUInt32 nPoints,
                 }
             }
         }
-
-        i++;
     }
 
     if ( n < ((GDALGridDataMetricsOptions *)poOptions)->nMinPoints
@@ -1640,8 +1998,12 @@ static void GDALGridJobProcess(void* user_data)
     const void *poOptions = psJob->poOptions;
     GDALGridFunction  pfnGDALGridMethod = psJob->pfnGDALGridMethod;
     // Have a local copy of sExtraParameters since we want to modify
-    // nInitialFacetIdx
+    // nInitialFacetIdx and use our own scratch buffers
     GDALGridExtraParameters sExtraParameters = *(psJob->psExtraParameters);
+    sExtraParameters.panCandidates = NULL;
+    sExtraParameters.nCandidatesAlloc = 0;
+    sExtraParameters.pasNeighbours = NULL;
+    sExtraParameters.nNeighboursAlloc = 0;
     GDALDataType eType = psJob->eType;
     int (*pfnProgress)(GDALGridJob* psJob) = psJob->pfnProgress;
 
@@ -1694,6 +2056,8 @@ static void GDALGridJobProcess(void* user_data)
     }
 
     CPLFree(padfValues);
+    CPLFree(sExtraParameters.panCandidates);
+    CPLFree(sExtraParameters.pasNeighbours);
 }
 
 /************************************************************************/
@@ -1707,8 +2071,7 @@ struct GDALGridContext
     GDALGridFunction    pfnGDALGridMethod;
 
     GUInt32             nPoints;
-    GDALGridPoint      *pasGridPoints;
-    GDALGridXYArrays    sXYArrays;
+    GDALGridPointIndex  sPointIndex;
 
     GDALGridExtraParameters sExtraParameters;
     double*             padfX;
@@ -1723,7 +2086,17 @@ struct GDALGridContext
     CPLWorkerThreadPool *poWorkerThreadPool;
 };
 
-static void GDALGridContextCreateQuadTree(GDALGridContext* psContext);
+static bool GDALGridContextCreatePointIndex( GDALGridContext* psContext,
+                                             bool bWithFloatArrays );
+static void GDALGridContextFreePointIndex( GDALGridContext* psContext );
+static bool GDALGridContextCreateSearchOrder( GDALGridContext* psContext );
+
+/* Whether the search ellipse of data metrics is set (both radii non-zero) */
+static bool GDALGridDataMetricsHasSearchEllipse( const void *poOptions )
+{
+    return ((GDALGridDataMetricsOptions *)poOptions)->dfRadius1 > 0.0 &&
+           ((GDALGridDataMetricsOptions *)poOptions)->dfRadius2 > 0.0;
+}
 
 /**
  * Creates a context to do regular gridding from the scattered data.
@@ -1742,7 +2115,14 @@ static void GDALGridContextCreateQuadTree(GDALGridContext* psContext);
  * GDAL_USE_SSE configuration option to NO.
  * A further optimized version can use the AVX
  * instruction set. This can be disabled by setting the GDAL_USE_AVX
- * configuration option to NO.
+ * configuration option to NO. Starting with GDAL 2.2, an AVX version is
+ * also available for the 'invdist' algorithm with power 2, no smoothing,
+ * no max_points and a search circle (equal radii).
+ *
+ * Starting with GDAL 2.2, when the algorithm uses a search ellipse (both
+ * radii non-zero), or for the 'nearest' and 'invdistnn' algorithms, the
+ * points are stored in a spatial index (a regular grid of cells), so that
+ * only the points near a grid node are examined.
  *
  * It is possible to set the GDAL_NUM_THREADS
  * configuration option to parallelize the processing. The value to set is
@@ -1776,7 +2156,8 @@ GDALGridContextCreate( GDALGridAlgorithm eAlgorithm, const void *poOptions,
     CPLAssert( padfX );
     CPLAssert( padfY );
     CPLAssert( padfZ );
-    int bCreateQuadTree = FALSE;
+    bool bCreatePointIndex = false;
+    bool bPointIndexWithFloatArrays = false;
 
     /* Potentially unaligned pointers */
     void* pabyX = NULL;
@@ -1882,7 +2263,30 @@ GDALGridContextCreate( GDALGridAlgorithm eAlgorithm, const void *poOptions,
                 }
             }
             else
+            {
+                const GDALGridInverseDistanceToAPowerOptions* psOptions =
+                    (const GDALGridInverseDistanceToAPowerOptions *)poOptions;
+
                 pfnGDALGridMethod = GDALGridInverseDistanceToAPower;
+                bCreatePointIndex = psOptions->dfRadius1 > 0.0 &&
+                                    psOptions->dfRadius2 > 0.0;
+#ifdef HAVE_AVX_AT_COMPILE_TIME
+                if( bCreatePointIndex &&
+                    psOptions->dfRadius1 == psOptions->dfRadius2 &&
+                    psOptions->dfPower == 2.0 &&
+                    psOptions->dfSmoothing == 0.0 &&
+                    psOptions->nMaxPoints == 0 &&
+                    CPLTestBool(CPLGetConfigOption("GDAL_USE_AVX", "YES")) &&
+                    CPLHaveRuntimeAVX() )
+                {
+                    CPLDebug("GDAL_GRID",
+                             "Using AVX optimized version with search circle");
+                    pfnGDALGridMethod =
+                        GDALGridInverseDistanceToAPower2NoSmoothingCircleAVX;
+                    bPointIndexWithFloatArrays = true;
+                }
+#endif
+            }
             break;
 
         case GGA_InverseDistanceToAPowerNearestNeighbor:
@@ -1890,7 +2294,7 @@ GDALGridContextCreate( GDALGridAlgorithm eAlgorithm, const void *poOptions,
             memcpy(poOptionsNew, poOptions, sizeof(GDALGridInverseDistanceToAPowerNearestNeighborOptions));
 
             pfnGDALGridMethod = GDALGridInverseDistanceToAPowerNearestNeighbor;
-            bCreateQuadTree = TRUE;
+            bCreatePointIndex = true;
             break;
 
         case GGA_MovingAverage:
@@ -1898,6 +2302,9 @@ GDALGridContextCreate( GDALGridAlgorithm eAlgorithm, const void *poOptions,
             memcpy(poOptionsNew, poOptions, sizeof(GDALGridMovingAverageOptions));
 
             pfnGDALGridMethod = GDALGridMovingAverage;
+            bCreatePointIndex =
+                ((GDALGridMovingAverageOptions *)poOptions)->dfRadius1 > 0.0 &&
+                ((GDALGridMovingAverageOptions *)poOptions)->dfRadius2 > 0.0;
             break;
 
         case GGA_NearestNeighbor:
@@ -1905,9 +2312,10 @@ GDALGridContextCreate( GDALGridAlgorithm eAlgorithm, const void *poOptions,
             memcpy(poOptionsNew, poOptions, sizeof(GDALGridNearestNeighborOptions));
 
             pfnGDALGridMethod = GDALGridNearestNeighbor;
-            bCreateQuadTree = (nPoints > 100 &&
-                (((GDALGridNearestNeighborOptions *)poOptions)->dfRadius1 ==
-                ((GDALGridNearestNeighborOptions *)poOptions)->dfRadius2));
+            // Either the nearest point, or the nearest one in search ellipse
+            bCreatePointIndex =
+                (((GDALGridNearestNeighborOptions *)poOptions)->dfRadius1 > 0.0) ==
+                (((GDALGridNearestNeighborOptions *)poOptions)->dfRadius2 > 0.0);
             break;
 
         case GGA_MetricMinimum:
@@ -1915,6 +2323,7 @@ GDALGridContextCreate( GDALGridAlgorithm eAlgorithm, const void *poOptions,
             memcpy(poOptionsNew, poOptions, sizeof(GDALGridDataMetricsOptions));
 
             pfnGDALGridMethod = GDALGridDataMetricMinimum;
+            bCreatePointIndex = GDALGridDataMetricsHasSearchEllipse(poOptions);
             break;
 
         case GGA_MetricMaximum:
@@ -1922,6 +2331,7 @@ GDALGridContextCreate( GDALGridAlgorithm eAlgorithm, const void *poOptions,
             memcpy(poOptionsNew, poOptions, sizeof(GDALGridDataMetricsOptions));
 
             pfnGDALGridMethod = GDALGridDataMetricMaximum;
+            bCreatePointIndex = GDALGridDataMetricsHasSearchEllipse(poOptions);
             break;
 
         case GGA_MetricRange:
@@ -1929,6 +2339,7 @@ GDALGridContextCreate( GDALGridAlgorithm eAlgorithm, const void *poOptions,
             memcpy(poOptionsNew, poOptions, sizeof(GDALGridDataMetricsOptions));
 
             pfnGDALGridMethod = GDALGridDataMetricRange;
+            bCreatePointIndex = GDALGridDataMetricsHasSearchEllipse(poOptions);
             break;
 
         case GGA_MetricCount:
@@ -1936,6 +2347,7 @@ GDALGridContextCreate( GDALGridAlgorithm eAlgorithm, const void *poOptions,
             memcpy(poOptionsNew, poOptions, sizeof(GDALGridDataMetricsOptions));
 
             pfnGDALGridMethod = GDALGridDataMetricCount;
+            bCreatePointIndex = GDALGridDataMetricsHasSearchEllipse(poOptions);
             break;
 
         case GGA_MetricAverageDistance:
@@ -1943,6 +2355,7 @@ GDALGridContextCreate( GDALGridAlgorithm eAlgorithm, const void *poOptions,
             memcpy(poOptionsNew, poOptions, sizeof(GDALGridDataMetricsOptions));
 
             pfnGDALGridMethod = GDALGridDataMetricAverageDistance;
+            bCreatePointIndex = GDALGridDataMetricsHasSearchEllipse(poOptions);
             break;
 
         case GGA_MetricAverageDistancePts:
@@ -1950,6 +2363,7 @@ GDALGridContextCreate( GDALGridAlgorithm eAlgorithm, const void *poOptions,
             memcpy(poOptionsNew, poOptions, sizeof(GDALGridDataMetricsOptions));
 
             pfnGDALGridMethod = GDALGridDataMetricAverageDistancePts;
+            bCreatePointIndex = GDALGridDataMetricsHasSearchEllipse(poOptions);
             break;
 
         case GGA_Linear:
@@ -1992,16 +2406,16 @@ GDALGridContextCreate( GDALGridAlgorithm eAlgorithm, const void *poOptions,
     psContext->poOptions = poOptionsNew;
     psContext->pfnGDALGridMethod = pfnGDALGridMethod;
     psContext->nPoints = nPoints;
-    psContext->pasGridPoints = NULL;
-    psContext->sXYArrays.padfX = padfX;
-    psContext->sXYArrays.padfY = padfY;
-    psContext->sExtraParameters.hQuadTree = NULL;
-    psContext->sExtraParameters.dfInitialSearchRadius = 0;
+    psContext->sExtraParameters.psPointIndex = NULL;
     psContext->sExtraParameters.pafX = pafXAligned;
     psContext->sExtraParameters.pafY = pafYAligned;
     psContext->sExtraParameters.pafZ = pafZAligned;
     psContext->sExtraParameters.psTriangulation = NULL;
     psContext->sExtraParameters.nInitialFacetIdx = 0;
+    psContext->sExtraParameters.panCandidates = NULL;
+    psContext->sExtraParameters.nCandidatesAlloc = 0;
+    psContext->sExtraParameters.pasNeighbours = NULL;
+    psContext->sExtraParameters.nNeighboursAlloc = 0;
     psContext->padfX = pafXAligned ? NULL : (double*)padfX;
     psContext->padfY = pafXAligned ? NULL : (double*)padfY;
     psContext->padfZ = pafXAligned ? NULL : (double*)padfZ;
@@ -2011,11 +2425,21 @@ GDALGridContextCreate( GDALGridAlgorithm eAlgorithm, const void *poOptions,
     psContext->pabyZ = pabyZ;
 
 /* -------------------------------------------------------------------- */
-/*  Create quadtree if requested and possible.                          */
+/*  Create the point index if requested and possible. Otherwise, the    */
+/*  gridding functions fall back to scanning all the points.            */
 /* -------------------------------------------------------------------- */
-    if( bCreateQuadTree )
+    if( bCreatePointIndex &&
+        !GDALGridContextCreatePointIndex(psContext,
+                                         bPointIndexWithFloatArrays) &&
+        bPointIndexWithFloatArrays )
+    {
+        psContext->pfnGDALGridMethod = GDALGridInverseDistanceToAPower;
+    }
+    if( eAlgorithm == GGA_InverseDistanceToAPowerNearestNeighbor &&
+        psContext->sExtraParameters.psPointIndex != NULL &&
+        !GDALGridContextCreateSearchOrder(psContext) )
     {
-        GDALGridContextCreateQuadTree(psContext);
+        GDALGridContextFreePointIndex(psContext);
     }
 
     /* -------------------------------------------------------------------- */
@@ -2077,52 +2501,201 @@ GDALGridContextCreate( GDALGridAlgorithm eAlgorithm, const void *poOptions,
 }
 
 /************************************************************************/
-/*                      GDALGridContextCreateQuadTree()                 */
+/*                     GDALGridContextFreePointIndex()                  */
 /************************************************************************/
 
-void GDALGridContextCreateQuadTree(GDALGridContext* psContext)
+static void GDALGridContextFreePointIndex( GDALGridContext* psContext )
 {
-    GUInt32 nPoints = psContext->nPoints;
-    psContext->pasGridPoints = (GDALGridPoint*)
-            VSI_MALLOC2_VERBOSE(nPoints, sizeof(GDALGridPoint));
-    if( psContext->pasGridPoints != NULL )
-    {
-        const double* padfX = psContext->padfX;
-        const double* padfY = psContext->padfY;
-
-        CPLRectObj sRect;
-        GUInt32 i;
-
-        /* Determine point extents */
-        sRect.minx = padfX[0];
-        sRect.miny = padfY[0];
-        sRect.maxx = padfX[0];
-        sRect.maxy = padfY[0];
-        for(i = 1; i < nPoints; i++)
-        {
-            if( padfX[i] < sRect.minx ) sRect.minx = padfX[i];
-            if( padfY[i] < sRect.miny ) sRect.miny = padfY[i];
-            if( padfX[i] > sRect.maxx ) sRect.maxx = padfX[i];
-            if( padfY[i] > sRect.maxy ) sRect.maxy = padfY[i];
-        }
+    GDALGridPointIndex* psIndex = &(psContext->sPointIndex);
+    CPLFree(psIndex->panCellStart);
+    CPLFree(psIndex->panPointIdx);
+    CPLFree(psIndex->pafX);
+    CPLFree(psIndex->pafY);
+    CPLFree(psIndex->pafZ);
+    CPLFree(psIndex->panSearchOrder);
+    memset(psIndex, 0, sizeof(GDALGridPointIndex));
+    psContext->sExtraParameters.psPointIndex = NULL;
+}
+
+/************************************************************************/
+/*                   GDALGridContextCreateSearchOrder()                 */
+/************************************************************************/
+
+/* Compute the rank of each point in the result of a search of a quadtree */
+/* of all the points, so that invdistnn picks the same points as with a   */
+/* quadtree search when several are at the same distance of a grid node.  */
+static bool GDALGridContextCreateSearchOrder( GDALGridContext* psContext )
+{
+    const GUInt32 nPoints = psContext->nPoints;
+    const double* padfX = psContext->padfX;
+    const double* padfY = psContext->padfY;
+    GDALGridPointIndex* psIndex = &(psContext->sPointIndex);
+
+    psIndex->panSearchOrder = (GUInt32*)
+        VSI_MALLOC2_VERBOSE(nPoints, sizeof(GUInt32));
+    if( psIndex->panSearchOrder == NULL )
+        return false;
+
+    CPLRectObj sRect;
+    sRect.minx = padfX[0];
+    sRect.miny = padfY[0];
+    sRect.maxx = padfX[0];
+    sRect.maxy = padfY[0];
+    for( GUInt32 i = 1; i < nPoints; i++ )
+    {
+        if( padfX[i] < sRect.minx ) sRect.minx = padfX[i];
+        if( padfY[i] < sRect.miny ) sRect.miny = padfY[i];
+        if( padfX[i] > sRect.maxx ) sRect.maxx = padfX[i];
+        if( padfY[i] > sRect.maxy ) sRect.maxy = padfY[i];
+    }
 
-        /* Initial value for search radius is the typical dimension of a */
-        /* "pixel" of the point array (assuming rather uniform distribution) */
-        psContext->sExtraParameters.dfInitialSearchRadius =
-                                sqrt((sRect.maxx - sRect.minx) *
-                                        (sRect.maxy - sRect.miny) / nPoints);
+    CPLQuadTree* hQuadTree = CPLQuadTreeCreate(&sRect, NULL);
+    for( GUInt32 i = 0; i < nPoints; i++ )
+    {
+        CPLRectObj sBounds;
+        sBounds.minx = padfX[i];
+        sBounds.miny = padfY[i];
+        sBounds.maxx = padfX[i];
+        sBounds.maxy = padfY[i];
+        CPLQuadTreeInsertWithBounds(hQuadTree,
+                                    psIndex->panSearchOrder + i, &sBounds);
+    }
 
-        psContext->sExtraParameters.hQuadTree =
-                    CPLQuadTreeCreate(&sRect, GDALGridGetPointBounds );
+    int nFeatureCount = 0;
+    GUInt32** papanPoints = (GUInt32**)
+        CPLQuadTreeSearch(hQuadTree, &sRect, &nFeatureCount);
+    for( int k = 0; k < nFeatureCount; k++ )
+        *(papanPoints[k]) = (GUInt32)k;
+    CPLFree(papanPoints);
+    CPLQuadTreeDestroy(hQuadTree);
+
+    return nFeatureCount == (int)nPoints;
+}
+
+/************************************************************************/
+/*                    GDALGridContextCreatePointIndex()                 */
+/************************************************************************/
 
-        for(i = 0; i < nPoints; i++)
+bool GDALGridContextCreatePointIndex( GDALGridContext* psContext,
+                                      bool bWithFloatArrays )
+{
+    const GUInt32 nPoints = psContext->nPoints;
+    const double* padfX = psContext->padfX;
+    const double* padfY = psContext->padfY;
+    const double* padfZ = psContext->padfZ;
+    GDALGridPointIndex* psIndex = &(psContext->sPointIndex);
+
+    if( nPoints == 0 )
+        return false;
+
+    /* Determine point extents */
+    double dfMinX = padfX[0];
+    double dfMinY = padfY[0];
+    double dfMaxX = padfX[0];
+    double dfMaxY = padfY[0];
+    for( GUInt32 i = 1; i < nPoints; i++ )
+    {
+        if( padfX[i] < dfMinX ) dfMinX = padfX[i];
+        if( padfY[i] < dfMinY ) dfMinY = padfY[i];
+        if( padfX[i] > dfMaxX ) dfMaxX = padfX[i];
+        if( padfY[i] > dfMaxY ) dfMaxY = padfY[i];
+    }
+    const double dfWidth = dfMaxX - dfMinX;
+    const double dfHeight = dfMaxY - dfMinY;
+    if( !CPLIsFinite(dfWidth) || !CPLIsFinite(dfHeight) )
+        return false;
+
+    /* Aim at 2 points per cell, assuming a rather uniform distribution */
+    double dfCellSize;
+    if( dfWidth > 0 && dfHeight > 0 )
+        dfCellSize = sqrt( 2.0 * dfWidth * dfHeight / nPoints );
+    else
+        dfCellSize = 2.0 * MAX(dfWidth, dfHeight) / nPoints;
+    if( !(dfCellSize > 0) )
+        dfCellSize = 1.0;
+
+    /* But do not allocate many more cells than points */
+    double dfCellsX, dfCellsY;
+    while( true )
+    {
+        dfCellsX = floor(dfWidth / dfCellSize) + 1;
+        dfCellsY = floor(dfHeight / dfCellSize) + 1;
+        if( dfCellsX * dfCellsY <= 2.0 * nPoints + 16 )
+            break;
+        dfCellSize *= 1.5;
+    }
+
+    psIndex->dfMinX = dfMinX;
+    psIndex->dfMinY = dfMinY;
+    psIndex->dfCellSize = dfCellSize;
+    psIndex->dfInvCellSize = 1.0 / dfCellSize;
+    psIndex->nCellsX = (int)dfCellsX;
+    psIndex->nCellsY = (int)dfCellsY;
+
+    const size_t nCells = (size_t)psIndex->nCellsX * psIndex->nCellsY;
+    psIndex->panCellStart = (GUInt32*)
+        VSI_CALLOC_VERBOSE(nCells + 1, sizeof(GUInt32));
+    psIndex->panPointIdx = (GUInt32*)
+        VSI_MALLOC2_VERBOSE(nPoints, sizeof(GUInt32));
+    GUInt32* panPointCell = (GUInt32*)
+        VSI_MALLOC2_VERBOSE(nPoints, sizeof(GUInt32));
+    if( bWithFloatArrays )
+    {
+        psIndex->pafX = (float*) VSI_MALLOC2_VERBOSE(nPoints, sizeof(float));
+        psIndex->pafY = (float*) VSI_MALLOC2_VERBOSE(nPoints, sizeof(float));
+        psIndex->pafZ = (float*) VSI_MALLOC2_VERBOSE(nPoints, sizeof(float));
+    }
+    if( psIndex->panCellStart == NULL || psIndex->panPointIdx == NULL ||
+        panPointCell == NULL ||
+        (bWithFloatArrays && (psIndex->pafX == NULL ||
+                              psIndex->pafY == NULL ||
+                              psIndex->pafZ == NULL)) )
+    {
+        CPLFree(panPointCell);
+        GDALGridContextFreePointIndex(psContext);
+        return false;
+    }
+
+    /* Counting sort of the points by cell, which keeps them in increasing */
+    /* index order within each cell. */
+    GUInt32* panCellStart = psIndex->panCellStart;
+    for( GUInt32 i = 0; i < nPoints; i++ )
+    {
+        const double dfCellX = (padfX[i] - dfMinX) * psIndex->dfInvCellSize;
+        const double dfCellY = (padfY[i] - dfMinY) * psIndex->dfInvCellSize;
+        // NaN coordinates end up in the first cell, and will never be
+        // selected by the distance tests anyway.
+        const int nCellX = !(dfCellX >= 0) ? 0 :
+            dfCellX >= psIndex->nCellsX - 1 ? psIndex->nCellsX - 1 : (int)dfCellX;
+        const int nCellY = !(dfCellY >= 0) ? 0 :
+            dfCellY >= psIndex->nCellsY - 1 ? psIndex->nCellsY - 1 : (int)dfCellY;
+        panPointCell[i] = (GUInt32)nCellY * psIndex->nCellsX + nCellX;
+        panCellStart[panPointCell[i] + 1] ++;
+    }
+    for( size_t iCell = 0; iCell < nCells; iCell++ )
+        panCellStart[iCell + 1] += panCellStart[iCell];
+    for( GUInt32 i = 0; i < nPoints; i++ )
+        psIndex->panPointIdx[ panCellStart[panPointCell[i]] ++ ] = i;
+    for( size_t iCell = nCells; iCell > 0; iCell-- )
+        panCellStart[iCell] = panCellStart[iCell - 1];
+    panCellStart[0] = 0;
+    CPLFree(panPointCell);
+
+    if( bWithFloatArrays )
+    {
+        for( GUInt32 k = 0; k < nPoints; k++ )
         {
-            psContext->pasGridPoints[i].psXYArrays = &(psContext->sXYArrays);
-            psContext->pasGridPoints[i].i = i;
-            CPLQuadTreeInsert(psContext->sExtraParameters.hQuadTree,
-                                psContext->pasGridPoints + i);
+            const GUInt32 i = psIndex->panPointIdx[k];
+            psIndex->pafX[k] = (float)(padfX[i] - dfMinX);
+            psIndex->pafY[k] = (float)(padfY[i] - dfMinY);
+            psIndex->pafZ[k] = (float)padfZ[i];
         }
     }
+
+    CPLDebug( "GDAL_GRID", "Using a point index of %d x %d cells",
+              psIndex->nCellsX, psIndex->nCellsY );
+    psContext->sExtraParameters.psPointIndex = psIndex;
+    return true;
 }
 
 /************************************************************************/
@@ -2141,9 +2714,7 @@ void GDALGridContextFree(GDALGridContext* psContext)
     if( psContext )
     {
         CPLFree( psContext->poOptions );
-        CPLFree( psContext->pasGridPoints );
-        if( psContext->sExtraParameters.hQuadTree != NULL )
-            CPLQuadTreeDestroy( psContext->sExtraParameters.hQuadTree );
+        GDALGridContextFreePointIndex( psContext );
         if( psContext->bFreePadfXYZArrays )
         {
             CPLFree(psContext->padfX);
@@ -2212,7 +2783,7 @@ CPLErr GDALGridContextProcess(GDALGridContext* psContext,
     // by sampling along the edges (if all points on edges are within triangles,
     // then interior points will also be!)
     if( psContext->eAlgorithm == GGA_Linear &&
-        psContext->sExtraParameters.hQuadTree == NULL )
+        psContext->sExtraParameters.psPointIndex == NULL )
     {
         int bNeedNearest = FALSE;
         int nStartLeft = 0, nStartRight = 0;
@@ -2262,7 +2833,7 @@ CPLErr GDALGridContextProcess(GDALGridContext* psContext,
         if( bNeedNearest )
         {
             CPLDebug("GDAL_GRID", "Will need nearest neighbour");
-            GDALGridContextCreateQuadTree(psContext);
+            GDALGridContextCreatePointIndex(psContext, false);
         }
     }
 
@@ -2325,9 +2896,10 @@ CPLErr GDALGridContextProcess(GDALGridContext* psContext,
         }
 
 /* -------------------------------------------------------------------- */
-/*      Report progress.                                                */
+/*      Report progress. Jobs only signal progress if there is a        */
+/*      progress function to call.                                      */
 /* -------------------------------------------------------------------- */
-        while(nCounter < (int)nYSize && !bStop)
+        while(sJob.pfnProgress != NULL && nCounter < (int)nYSize && !bStop)
         {
             CPLCondWait(sJob.hCond, sJob.hCondMutex);
 
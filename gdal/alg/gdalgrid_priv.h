@@ -28,24 +28,47 @@
  ****************************************************************************/
 
 #include "cpl_error.h"
-#include "cpl_quad_tree.h"
 
+/*! Spatial index of the input points, made of a regular grid of square
+    cells. The point indices are stored cell by cell (row major order), in
+    increasing order within a cell, so that the points of a row of cells
+    form a contiguous run. */
 typedef struct
 {
-    const double* padfX;
-    const double* padfY;
-} GDALGridXYArrays;
+    double   dfMinX;
+    double   dfMinY;
+    double   dfCellSize;
+    double   dfInvCellSize;
+    int      nCellsX;
+    int      nCellsY;
+    /*! Offset in panPointIdx of the first point of each cell
+        (nCellsX * nCellsY + 1 values). */
+    GUInt32 *panCellStart;
+    /*! Point indices, sorted by cell. */
+    GUInt32 *panPointIdx;
+    /*! Coordinates relative to (dfMinX, dfMinY) and values of the points,
+        in the order of panPointIdx. Only set for the AVX kernel. */
+    float   *pafX;
+    float   *pafY;
+    float   *pafZ;
+    /*! Rank of each point in the search order of a CPLQuadTree of the
+        points, to order the points at the same distance of a grid node.
+        Only set for invdistnn. */
+    GUInt32 *panSearchOrder;
+} GDALGridPointIndex;
 
+/*! A point found by a nearest neighbour search. */
 typedef struct
 {
-    GDALGridXYArrays* psXYArrays;
-    int               i;
-} GDALGridPoint;
+    double  dfR2;
+    GUInt32 nIdx;
+    /*! Order of the point among the points at the same distance. */
+    GUInt32 nOrder;
+} GDALGridPointDist;
 
 typedef struct
 {
-    CPLQuadTree* hQuadTree;
-    double       dfInitialSearchRadius;
+    const GDALGridPointIndex* psPointIndex;
     const float *pafX;
     const float *pafY;
     const float *pafZ;
@@ -57,8 +80,20 @@ typedef struct
     double  dfRadiusPower2PreComp;
     /*! The radius of search circle to power 4 (pre-computation). */
     double  dfRadiusPower4PreComp;
+    /*! Scratch buffers for the point index searches. They belong to the
+        job using these parameters, and are freed at the end of it. */
+    GUInt32*           panCandidates;
+    size_t             nCandidatesAlloc;
+    GDALGridPointDist* pasNeighbours;
+    size_t             nNeighboursAlloc;
 } GDALGridExtraParameters;
 
+bool GDALGridPointIndexGetCellRect( const GDALGridPointIndex* psIndex,
+                                    double dfXPoint, double dfYPoint,
+                                    double dfHalfWidthX, double dfHalfWidthY,
+                                    int* pnCellX0, int* pnCellY0,
+                                    int* pnCellX1, int* pnCellY1 );
+
 #ifdef HAVE_SSE_AT_COMPILE_TIME
 int CPLHaveRuntimeSSE();
 
@@ -86,6 +121,16 @@ CPLErr GDALGridInverseDistanceToAPower2NoSmoothingNoSearchAVX(
                                         double dfXPoint, double dfYPoint,
                                         double *pdfValue,
                                         void* hExtraParamsIn );
+
+CPLErr GDALGridInverseDistanceToAPower2NoSmoothingCircleAVX(
+                                        const void *poOptions,
+                                        GUInt32 nPoints,
+                                        const double *unused_padfX,
+                                        const double *unused_padfY,
+                                        const double *unused_padfZ,
+                                        double dfXPoint, double dfYPoint,
+                                        double *pdfValue,
+                                        void* hExtraParamsIn );
 #endif
 #if defined(__GNUC__)
 #if defined(__x86_64)
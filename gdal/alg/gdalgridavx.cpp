@@ -198,4 +198,159 @@ GDALGridInverseDistanceToAPower2NoSmoothingNoSearchAVX(
     return CE_None;
 }
 
+/************************************************************************/
+/*         GDALGridInverseDistanceToAPower2NoSmoothingCircleAVX()       */
+/************************************************************************/
+
+/* Same as GDALGridInverseDistanceToAPower() with a power of 2, no smoothing, */
+/* no max_points and a search circle. The points are read from the point    */
+/* index, where the points of each row of cells are contiguous.             */
+
+CPLErr
+GDALGridInverseDistanceToAPower2NoSmoothingCircleAVX(
+    const void *poOptions,
+    CPL_UNUSED GUInt32 nPoints,
+    CPL_UNUSED const double *unused_padfX,
+    CPL_UNUSED const double *unused_padfY,
+    CPL_UNUSED const double *unused_padfZ,
+    double dfXPoint, double dfYPoint,
+    double *pdfValue,
+    void* hExtraParamsIn )
+{
+    const GDALGridInverseDistanceToAPowerOptions* psOptions =
+        (const GDALGridInverseDistanceToAPowerOptions*) poOptions;
+    GDALGridExtraParameters* psExtraParams = (GDALGridExtraParameters*) hExtraParamsIn;
+    const GDALGridPointIndex* psIndex = psExtraParams->psPointIndex;
+    const float* pafX = psIndex->pafX;
+    const float* pafY = psIndex->pafY;
+    const float* pafZ = psIndex->pafZ;
+
+    int nCellX0, nCellY0, nCellX1, nCellY1;
+    if( !GDALGridPointIndexGetCellRect( psIndex, dfXPoint, dfYPoint,
+                                        psOptions->dfRadius1,
+                                        psOptions->dfRadius1,
+                                        &nCellX0, &nCellY0,
+                                        &nCellX1, &nCellY1 ) )
+    {
+        (*pdfValue) = psOptions->dfNoDataValue;
+        return CE_None;
+    }
+
+    /* Work with coordinates relative to the origin of the index, to keep */
+    /* as much precision as possible in single precision */
+    const float fEpsilon = 0.0000000000001f;
+    const float fXPoint = (float)(dfXPoint - psIndex->dfMinX);
+    const float fYPoint = (float)(dfYPoint - psIndex->dfMinY);
+    const float fRadius2 = (float)(psOptions->dfRadius1 * psOptions->dfRadius1);
+    const __m256 ymm_small = GDAL_mm256_load1_ps(fEpsilon);
+    const __m256 ymm_x = GDAL_mm256_load1_ps(fXPoint);
+    const __m256 ymm_y = GDAL_mm256_load1_ps(fYPoint);
+    const __m256 ymm_radius2 = GDAL_mm256_load1_ps(fRadius2);
+    const __m256 ymm_one = GDAL_mm256_load1_ps(1.0f);
+    __m256 ymm_nominator = _mm256_setzero_ps();
+    __m256 ymm_denominator = _mm256_setzero_ps();
+    __m256 ymm_count = _mm256_setzero_ps();
+    float fNominator = 0.0f;
+    float fDenominator = 0.0f;
+    GUInt32 n = 0;
+
+    for( int iY = nCellY0; iY <= nCellY1; iY++ )
+    {
+        const size_t iRow = (size_t)iY * psIndex->nCellsX;
+        const size_t nEnd = psIndex->panCellStart[iRow + nCellX1 + 1];
+        size_t i = psIndex->panCellStart[iRow + nCellX0];
+
+        for( ; i + 8 <= nEnd; i += 8 )
+        {
+            __m256 ymm_rx = _mm256_sub_ps(_mm256_loadu_ps(pafX + i), ymm_x);       /* rx = pafX[i] - fXPoint */
+            __m256 ymm_ry = _mm256_sub_ps(_mm256_loadu_ps(pafY + i), ymm_y);       /* ry = pafY[i] - fYPoint */
+            __m256 ymm_r2 = _mm256_add_ps(_mm256_mul_ps(ymm_rx, ymm_rx),          /* r2 = rx * rx + ry * ry */
+                                          _mm256_mul_ps(ymm_ry, ymm_ry));
+            __m256 ymm_in = _mm256_cmp_ps(ymm_r2, ymm_radius2, _CMP_LE_OQ);       /* in = r2 <= fRadius2 */
+            int mask = _mm256_movemask_ps(_mm256_and_ps(ymm_in,                   /* if( in && r2 < fEpsilon ) */
+                                _mm256_cmp_ps(ymm_r2, ymm_small, _CMP_LT_OS)));
+            if( mask )
+            {
+                for( int j = 0; j < 8; j++ )
+                {
+                    if( mask & (1 << j) )
+                    {
+                        (*pdfValue) = pafZ[i + j];
+
+                        // GCC and MSVC need explicit zeroing
+#if !defined(__clang__)
+                        _mm256_zeroupper();
+#endif
+                        return CE_None;
+                    }
+                }
+            }
+            __m256 ymm_invr2 = _mm256_and_ps(_mm256_rcp_ps(ymm_r2), ymm_in);      /* invr2 = in ? 1.0f / r2 : 0 */
+            ymm_nominator = _mm256_add_ps(ymm_nominator,                          /* nominator += invr2 * pafZ[i] */
+                                _mm256_mul_ps(ymm_invr2, _mm256_loadu_ps(pafZ + i)));
+            ymm_denominator = _mm256_add_ps(ymm_denominator, ymm_invr2);          /* denominator += invr2 */
+            ymm_count = _mm256_add_ps(ymm_count, _mm256_and_ps(ymm_one, ymm_in)); /* count += in */
+        }
+
+        /* Do the few remaining loop iterations */
+        for( ; i < nEnd; i++ )
+        {
+            const float fRX = pafX[i] - fXPoint;
+            const float fRY = pafY[i] - fYPoint;
+            const float fR2 = fRX * fRX + fRY * fRY;
+
+            if( fR2 <= fRadius2 )
+            {
+                // If the test point is close to the grid node, use the point
+                // value directly as a node value to avoid singularity.
+                if( fR2 < fEpsilon )
+                {
+                    (*pdfValue) = pafZ[i];
+#if !defined(__clang__)
+                    _mm256_zeroupper();
+#endif
+                    return CE_None;
+                }
+                const float fInvR2 = 1.0f / fR2;
+                fNominator += fInvR2 * pafZ[i];
+                fDenominator += fInvR2;
+                n++;
+            }
+        }
+    }
+
+    /* Get back nominator, denominator and count values for YMM registers */
+    float afNominator[8], afDenominator[8], afCount[8];
+    _mm256_storeu_ps(afNominator, ymm_nominator);
+    _mm256_storeu_ps(afDenominator, ymm_denominator);
+    _mm256_storeu_ps(afCount, ymm_count);
+
+    // MSVC doesn't emit AVX afterwards but may use SSE, so clear upper bits
+    // Other compilers will continue using AVX for the below floating points operations
+#if defined(_MSC_FULL_VER)
+    _mm256_zeroupper();
+#endif
+
+    for( int j = 0; j < 8; j++ )
+    {
+        fNominator += afNominator[j];
+        fDenominator += afDenominator[j];
+        n += (GUInt32)afCount[j];
+    }
+
+    if( n < psOptions->nMinPoints || fDenominator == 0.0 )
+    {
+        (*pdfValue) = psOptions->dfNoDataValue;
+    }
+    else
+        (*pdfValue) = fNominator / fDenominator;
+
+    // GCC needs explicit zeroing
+#if defined(__GNUC__) && !defined(__clang__)
+    _mm256_zeroupper();
+#endif
+
+    return CE_None;
+}
+
 #endif /* HAVE_AVX_AT_COMPILE_TIME */
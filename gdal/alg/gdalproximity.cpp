@@ -31,14 +31,219 @@
 #include "gdal_alg.h"
 #include "cpl_conv.h"
 #include "cpl_string.h"
+#include "cpl_worker_thread_pool.h"
+
+#include <vector>
 
 CPL_CVSID("$Id$");
 
-static CPLErr
-ProcessProximityLine( GInt32 *panSrcScanline, int *panNearX, int *panNearY,
-                      int bForward, int iLine, int nXSize, double nMaxDist,
-                      float *pafProximity, double *pdfSrcNoDataValue,
-                      int nTargetValues, int *panTargetValues );
+typedef enum
+{
+    GPO_DISTANCE,
+    GPO_NEAREST_VALUE,
+    GPO_NEAREST_X,
+    GPO_NEAREST_Y
+} GDALProximityOutput;
+
+/************************************************************************/
+/*                         GDALProximityContext                         */
+/*                                                                      */
+/*      State of the second pass, shared by the line jobs.  The         */
+/*      buffers hold a chunk of lines.                                  */
+/************************************************************************/
+
+typedef struct
+{
+    int                 nXSize;
+    GDALProximityOutput eOutput;
+    double              dfMaxDist;
+    double              dfDistMult;
+    int                 bFixedBufVal;
+    double              dfFixedBufVal;
+    double              dfNoDataValue;
+    int                 bGeoCoords;
+    double              adfGeoTransform[6];
+
+    // For each pixel of the chunk, the vertical distance to the nearest
+    // target of its column (-1 if none), the line of that target and its
+    // value, and whether the pixel is an input nodata pixel.
+    GInt32             *panColDist;
+    GInt32             *panColTargetY;
+    GInt32             *panColTargetVal;
+    GByte              *pabyNoData;
+
+    double             *padfOut;
+    int                 nChunkYOff;
+} GDALProximityContext;
+
+typedef struct
+{
+    const GDALProximityContext *psCtxt;
+    int                 iFirstLine;     // in the chunk
+    int                 iEndLine;
+
+    // Lower envelope of the parabolas.
+    int                *panV;
+    double             *padfZ;
+} GDALProximityJob;
+
+/************************************************************************/
+/*                         GPIsTargetValue()                            */
+/************************************************************************/
+
+static inline bool GPIsTargetValue( GInt32 nValue, int nTargetValues,
+                                    const int *panTargetValues )
+{
+    if( nTargetValues == 0 )
+        return nValue != 0;
+
+    for( int i = 0; i < nTargetValues; i++ )
+    {
+        if( nValue == panTargetValues[i] )
+            return true;
+    }
+    return false;
+}
+
+/************************************************************************/
+/*                        ProcessProximityLine()                        */
+/*                                                                      */
+/*      Compute the output values of one line of the chunk from the     */
+/*      column distances, by finding the lower envelope of the          */
+/*      parabolas (x - q)^2 + d(q)^2.                                   */
+/************************************************************************/
+
+static void ProcessProximityLine( const GDALProximityContext *psCtxt,
+                                  int iLine, int *panV, double *padfZ )
+
+{
+    const int nXSize = psCtxt->nXSize;
+    const size_t nOffset = static_cast<size_t>(iLine) * nXSize;
+    const GInt32 *panColDist = psCtxt->panColDist + nOffset;
+    const GInt32 *panColTargetY = psCtxt->panColTargetY + nOffset;
+    const GInt32 *panColTargetVal = psCtxt->panColTargetVal + nOffset;
+    const GByte *pabyNoData = psCtxt->pabyNoData + nOffset;
+    double *padfOut = psCtxt->padfOut + nOffset;
+    const double dfMaxDist2 = psCtxt->dfMaxDist * psCtxt->dfMaxDist;
+
+/* -------------------------------------------------------------------- */
+/*      Build the lower envelope.  Columns whose nearest target is      */
+/*      further than MAXDIST cannot contribute.                         */
+/* -------------------------------------------------------------------- */
+    int k = -1;
+    for( int q = 0; q < nXSize; q++ )
+    {
+        if( panColDist[q] < 0 || panColDist[q] > psCtxt->dfMaxDist )
+            continue;
+
+        const double dfFq = (double)panColDist[q] * panColDist[q] +
+                            (double)q * q;
+        if( k < 0 )
+        {
+            k = 0;
+            panV[0] = q;
+            padfZ[0] = -1e300;
+            padfZ[1] = 1e300;
+            continue;
+        }
+
+        // padfZ[0] is -infinity, so this stops at k == 0.
+        double dfS;
+        while( true )
+        {
+            const int nVk = panV[k];
+            const double dfFv = (double)panColDist[nVk] * panColDist[nVk] +
+                                (double)nVk * nVk;
+            dfS = (dfFq - dfFv) / (2.0 * (q - nVk));
+            if( dfS > padfZ[k] )
+                break;
+            k--;
+        }
+
+        k++;
+        panV[k] = q;
+        padfZ[k] = dfS;
+        padfZ[k+1] = 1e300;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      No target within reach of this line.                            */
+/* -------------------------------------------------------------------- */
+    if( k < 0 )
+    {
+        for( int p = 0; p < nXSize; p++ )
+            padfOut[p] = psCtxt->dfNoDataValue;
+        return;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Evaluate it.                                                    */
+/* -------------------------------------------------------------------- */
+    k = 0;
+    for( int p = 0; p < nXSize; p++ )
+    {
+        while( padfZ[k+1] < p )
+            k++;
+
+        const int nQ = panV[k];
+        const GIntBig nDX = p - nQ;
+        const GIntBig nDistSq = nDX * nDX +
+            static_cast<GIntBig>(panColDist[nQ]) * panColDist[nQ];
+
+        if( pabyNoData[p] || (double) nDistSq > dfMaxDist2 )
+        {
+            padfOut[p] = psCtxt->dfNoDataValue;
+            continue;
+        }
+
+        switch( psCtxt->eOutput )
+        {
+          case GPO_DISTANCE:
+            if( nDistSq == 0 )
+                padfOut[p] = 0.0;
+            else if( psCtxt->bFixedBufVal )
+                padfOut[p] = psCtxt->dfFixedBufVal;
+            else
+                padfOut[p] = sqrt((double)nDistSq) * psCtxt->dfDistMult;
+            break;
+
+          case GPO_NEAREST_VALUE:
+            padfOut[p] = panColTargetVal[nQ];
+            break;
+
+          case GPO_NEAREST_X:
+            if( psCtxt->bGeoCoords )
+                padfOut[p] = psCtxt->adfGeoTransform[0]
+                    + (nQ + 0.5) * psCtxt->adfGeoTransform[1]
+                    + (panColTargetY[nQ] + 0.5) * psCtxt->adfGeoTransform[2];
+            else
+                padfOut[p] = nQ;
+            break;
+
+          case GPO_NEAREST_Y:
+            if( psCtxt->bGeoCoords )
+                padfOut[p] = psCtxt->adfGeoTransform[3]
+                    + (nQ + 0.5) * psCtxt->adfGeoTransform[4]
+                    + (panColTargetY[nQ] + 0.5) * psCtxt->adfGeoTransform[5];
+            else
+                padfOut[p] = panColTargetY[nQ];
+            break;
+        }
+    }
+}
+
+/************************************************************************/
+/*                       ProcessProximityJob()                          */
+/************************************************************************/
+
+static void ProcessProximityJob( void *pData )
+{
+    GDALProximityJob *psJob = (GDALProximityJob *) pData;
+
+    for( int iLine = psJob->iFirstLine; iLine < psJob->iEndLine; iLine++ )
+        ProcessProximityLine( psJob->psCtxt, iLine,
+                              psJob->panV, psJob->padfZ );
+}
 
 /************************************************************************/
 /*                        GDALComputeProximity()                        */
@@ -48,8 +253,8 @@ ProcessProximityLine( GInt32 *panSrcScanline, int *panNearX, int *panNearY,
 Compute the proximity of all pixels in the image to a set of pixels in
 the source image.
 
-This function attempts to compute the proximity of all pixels in
-the image to a set of pixels in the source image.  The following
+This function computes the exact euclidean distance of all pixels in
+the image to the nearest pixel of a set of pixels in the source image.  The following
 options are used to define the behavior of the function.  By
 default all non-zero pixels in hSrcBand will be considered the
 "target", and all proximities will be computed in pixels.  Note
@@ -96,9 +301,30 @@ the proximity output.
 
 If this option is set, all pixels within the MAXDIST threadhold are
 set to this fixed value instead of to a proximity distance.
+
+  OUTPUT=[DISTANCE]/NEAREST_VALUE/NEAREST_X/NEAREST_Y
+
+(GDAL &gt;= 2.2) What is written in the output band: the distance to the
+nearest target pixel (the default), its pixel value, or its column or
+line.  With DISTUNITS=GEO, NEAREST_X and NEAREST_Y are the georeferenced
+coordinates of the center of the nearest target pixel.  Pixels beyond
+MAXDIST are set to the NODATA value.
+
+  NUM_THREADS=n/ALL_CPUS
+
+(GDAL &gt;= 2.2) Number of worker threads used to compute the distances.
+Defaults to 1.
+
+The distances are computed with the separable algorithm of Meijster et al.
+(also described by Felzenszwalb and Huttenlocher).  A top to bottom pass
+finds, for each pixel, the nearest target in its column above it, and a
+bottom to top pass the nearest one below it.  Lines are then processed
+independently by computing the lower envelope of the parabolas rooted at
+each column, which gives the distance to the nearest target in linear time.
 */
 
 
+
 CPLErr CPL_STDCALL
 GDALComputeProximity( GDALRasterBandH hSrcBand,
                       GDALRasterBandH hProximityBand,
@@ -107,10 +333,8 @@ GDALComputeProximity( GDALRasterBandH hSrcBand,
                       void * pProgressArg )
 
 {
-    int nXSize, nYSize, i, bFixedBufVal = FALSE;
     const char *pszOpt;
     double dfMaxDist;
-    double dfFixedBufVal = 0.0;
 
     VALIDATE_POINTER1( hSrcBand, "GDALComputeProximity", CE_Failure );
     VALIDATE_POINTER1( hProximityBand, "GDALComputeProximity", CE_Failure );
@@ -118,6 +342,9 @@ GDALComputeProximity( GDALRasterBandH hSrcBand,
     if( pfnProgress == NULL )
         pfnProgress = GDALDummyProgress;
 
+    GDALProximityContext sCtxt;
+    memset( &sCtxt, 0, sizeof(sCtxt) );
+
 /* -------------------------------------------------------------------- */
 /*      Are we using pixels or georeferenced coordinates for distances? */
 /* -------------------------------------------------------------------- */
@@ -137,6 +364,10 @@ GDALComputeProximity( GDALRasterBandH hSrcBand,
                     CPLError( CE_Warning, CPLE_AppDefined,
                               "Pixels not square, distances will be inaccurate." );
                 dfDistMult = ABS(adfGeoTransform[1]);
+
+                memcpy( sCtxt.adfGeoTransform, adfGeoTransform,
+                        sizeof(adfGeoTransform) );
+                sCtxt.bGeoCoords = TRUE;
             }
         }
         else if( !EQUAL(pszOpt,"PIXEL") )
@@ -149,6 +380,29 @@ GDALComputeProximity( GDALRasterBandH hSrcBand,
         }
     }
 
+/* -------------------------------------------------------------------- */
+/*      What do we write in the output band?                            */
+/* -------------------------------------------------------------------- */
+    GDALProximityOutput eOutput = GPO_DISTANCE;
+    pszOpt = CSLFetchNameValue( papszOptions, "OUTPUT" );
+    if( pszOpt )
+    {
+        if( EQUAL(pszOpt,"NEAREST_VALUE") )
+            eOutput = GPO_NEAREST_VALUE;
+        else if( EQUAL(pszOpt,"NEAREST_X") )
+            eOutput = GPO_NEAREST_X;
+        else if( EQUAL(pszOpt,"NEAREST_Y") )
+            eOutput = GPO_NEAREST_Y;
+        else if( !EQUAL(pszOpt,"DISTANCE") )
+        {
+            CPLError( CE_Failure, CPLE_AppDefined,
+                      "Unrecognized OUTPUT value '%s', should be DISTANCE, "
+                      "NEAREST_VALUE, NEAREST_X or NEAREST_Y.",
+                      pszOpt );
+            return CE_Failure;
+        }
+    }
+
 /* -------------------------------------------------------------------- */
 /*      What is our maxdist value?                                      */
 /* -------------------------------------------------------------------- */
@@ -163,8 +417,8 @@ GDALComputeProximity( GDALRasterBandH hSrcBand,
 /* -------------------------------------------------------------------- */
 /*      Verify the source and destination are compatible.               */
 /* -------------------------------------------------------------------- */
-    nXSize = GDALGetRasterBandXSize( hSrcBand );
-    nYSize = GDALGetRasterBandYSize( hSrcBand );
+    const int nXSize = GDALGetRasterBandXSize( hSrcBand );
+    const int nYSize = GDALGetRasterBandYSize( hSrcBand );
     if( nXSize != GDALGetRasterBandXSize( hProximityBand )
         || nYSize != GDALGetRasterBandYSize( hProximityBand ))
     {
@@ -208,15 +462,14 @@ GDALComputeProximity( GDALRasterBandH hSrcBand,
     pszOpt = CSLFetchNameValue( papszOptions, "FIXED_BUF_VAL" );
     if( pszOpt )
     {
-        dfFixedBufVal = CPLAtof(pszOpt);
-        bFixedBufVal = TRUE;
+        sCtxt.dfFixedBufVal = CPLAtof(pszOpt);
+        sCtxt.bFixedBufVal = TRUE;
     }
 
 /* -------------------------------------------------------------------- */
 /*      Get the target value(s).                                        */
 /* -------------------------------------------------------------------- */
-    int *panTargetValues = NULL;
-    int  nTargetValues = 0;
+    std::vector<int> anTargetValues;
 
     pszOpt = CSLFetchNameValue( papszOptions, "VALUES" );
     if( pszOpt != NULL )
@@ -225,13 +478,30 @@ GDALComputeProximity( GDALRasterBandH hSrcBand,
 
         papszValuesTokens = CSLTokenizeStringComplex( pszOpt, ",", FALSE,FALSE);
 
-        nTargetValues = CSLCount(papszValuesTokens);
-        panTargetValues = (int *) CPLCalloc(sizeof(int),nTargetValues);
-
-        for( i = 0; i < nTargetValues; i++ )
-            panTargetValues[i] = atoi(papszValuesTokens[i]);
+        for( int i = 0; papszValuesTokens[i] != NULL; i++ )
+            anTargetValues.push_back( atoi(papszValuesTokens[i]) );
         CSLDestroy( papszValuesTokens );
     }
+    const int nTargetValues = static_cast<int>(anTargetValues.size());
+    const int *panTargetValues =
+        anTargetValues.empty() ? NULL : &anTargetValues[0];
+
+/* -------------------------------------------------------------------- */
+/*      How many threads?                                               */
+/* -------------------------------------------------------------------- */
+    int nThreads = 1;
+    pszOpt = CSLFetchNameValue( papszOptions, "NUM_THREADS" );
+    if( pszOpt != NULL )
+    {
+        if( EQUAL(pszOpt, "ALL_CPUS") )
+            nThreads = CPLGetNumCPUs();
+        else
+            nThreads = atoi(pszOpt);
+        if( nThreads > 128 )
+            nThreads = 128;
+        if( nThreads < 1 )
+            nThreads = 1;
+    }
 
 /* -------------------------------------------------------------------- */
 /*      Initialize progress counter.                                    */
@@ -239,27 +509,37 @@ GDALComputeProximity( GDALRasterBandH hSrcBand,
     if( !pfnProgress( 0.0, "", pProgressArg ) )
     {
         CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
-        CPLFree(panTargetValues);
         return CE_Failure;
     }
 
 /* -------------------------------------------------------------------- */
-/*      We need a signed type for the working proximity values kept     */
-/*      on disk.  If our proximity band is not signed, then create a    */
-/*      temporary file for this purpose.                                */
+/*      The first pass saves, for each pixel, the line of the nearest   */
+/*      target above it in its column (and the value of that target     */
+/*      for NEAREST_VALUE).  If the proximity band can hold these       */
+/*      lines exactly, use it, otherwise create a temporary file for    */
+/*      this purpose.                                                   */
 /* -------------------------------------------------------------------- */
-    GDALRasterBandH hWorkProximityBand = hProximityBand;
+    GDALRasterBandH hWorkBand = hProximityBand;
+    GDALRasterBandH hWorkValueBand = NULL;
     GDALDatasetH hWorkProximityDS = NULL;
     GDALDataType eProxType = GDALGetRasterDataType( hProximityBand );
-    int   *panNearX = NULL, *panNearY = NULL;
-    float *pafProximity = NULL;
-    GInt32 *panSrcScanline = NULL;
-    int iLine;
     CPLErr eErr = CE_None;
+    CPLWorkerThreadPool *poThreadPool = NULL;
+    std::vector<GDALProximityJob> asJobs;
+    std::vector<int> anV;
+    std::vector<double> adfZ;
+    GInt32 *panSrcScanline = NULL;
+    GInt32 *panNearY = NULL;
+    GInt32 *panNearVal = NULL;
+    GInt32 *panWorkY = NULL;
+    GInt32 *panWorkVal = NULL;
+    int nChunkLines = 0;
+
+    const bool bProxBandUsable =
+        eProxType == GDT_Int32 || eProxType == GDT_Float64
+        || (eProxType == GDT_Float32 && nYSize <= (1 << 24));
 
-    if( eProxType == GDT_Byte
-        || eProxType == GDT_UInt16
-        || eProxType == GDT_UInt32 )
+    if( !bProxBandUsable || eOutput == GPO_NEAREST_VALUE )
     {
         GDALDriverH hDriver = GDALGetDriverByName("GTiff");
         if (hDriver == NULL)
@@ -272,41 +552,87 @@ GDALComputeProximity( GDALRasterBandH hSrcBand,
         CPLString osTmpFile = CPLGenerateTempFilename( "proximity" );
         hWorkProximityDS =
             GDALCreate( hDriver, osTmpFile,
-                        nXSize, nYSize, 1, GDT_Float32, NULL );
+                        nXSize, nYSize,
+                        (eOutput == GPO_NEAREST_VALUE) ? 2 : 1,
+                        GDT_Int32, NULL );
         if (hWorkProximityDS == NULL)
         {
             eErr = CE_Failure;
             goto end;
         }
-        hWorkProximityBand = GDALGetRasterBand( hWorkProximityDS, 1 );
+        hWorkBand = GDALGetRasterBand( hWorkProximityDS, 1 );
+        if( eOutput == GPO_NEAREST_VALUE )
+            hWorkValueBand = GDALGetRasterBand( hWorkProximityDS, 2 );
     }
 
 /* -------------------------------------------------------------------- */
-/*      Allocate buffer for two scanlines of distances as floats        */
-/*      (the current and last line).                                    */
+/*      Allocate buffers.  The second pass processes chunks of lines,   */
+/*      that are split between the threads.                             */
 /* -------------------------------------------------------------------- */
-    pafProximity = (float *) VSI_MALLOC2_VERBOSE(sizeof(float), nXSize);
-    panNearX = (int *) VSI_MALLOC2_VERBOSE(sizeof(int), nXSize);
-    panNearY = (int *) VSI_MALLOC2_VERBOSE(sizeof(int), nXSize);
-    panSrcScanline = (GInt32 *) VSI_MALLOC2_VERBOSE(sizeof(GInt32), nXSize);
+    nChunkLines = MIN( nYSize, 32 * nThreads );
 
-    if( pafProximity== NULL
-        || panNearX == NULL
-        || panNearY == NULL
-        || panSrcScanline == NULL)
+    panSrcScanline = (GInt32 *) VSI_MALLOC2_VERBOSE(sizeof(GInt32), nXSize);
+    panNearY = (GInt32 *) VSI_MALLOC2_VERBOSE(sizeof(GInt32), nXSize);
+    panNearVal = (GInt32 *) VSI_MALLOC2_VERBOSE(sizeof(GInt32), nXSize);
+    panWorkY = (GInt32 *) VSI_MALLOC2_VERBOSE(sizeof(GInt32), nXSize);
+    panWorkVal = (GInt32 *) VSI_MALLOC2_VERBOSE(sizeof(GInt32), nXSize);
+    sCtxt.panColDist = (GInt32 *)
+        VSI_MALLOC3_VERBOSE(sizeof(GInt32), nXSize, nChunkLines);
+    sCtxt.panColTargetY = (GInt32 *)
+        VSI_MALLOC3_VERBOSE(sizeof(GInt32), nXSize, nChunkLines);
+    sCtxt.panColTargetVal = (GInt32 *)
+        VSI_MALLOC3_VERBOSE(sizeof(GInt32), nXSize, nChunkLines);
+    sCtxt.pabyNoData = (GByte *)
+        VSI_MALLOC2_VERBOSE(nXSize, nChunkLines);
+    sCtxt.padfOut = (double *)
+        VSI_MALLOC3_VERBOSE(sizeof(double), nXSize, nChunkLines);
+
+    if( panSrcScanline == NULL || panNearY == NULL || panNearVal == NULL
+        || panWorkY == NULL || panWorkVal == NULL
+        || sCtxt.panColDist == NULL || sCtxt.panColTargetY == NULL
+        || sCtxt.panColTargetVal == NULL || sCtxt.pabyNoData == NULL
+        || sCtxt.padfOut == NULL )
     {
         eErr = CE_Failure;
         goto end;
     }
 
+    sCtxt.nXSize = nXSize;
+    sCtxt.eOutput = eOutput;
+    sCtxt.dfMaxDist = dfMaxDist;
+    sCtxt.dfDistMult = dfDistMult;
+    sCtxt.dfNoDataValue = fNoDataValue;
+
+    if( nThreads > 1 )
+    {
+        poThreadPool = new (std::nothrow) CPLWorkerThreadPool();
+        if( poThreadPool == NULL ||
+            !poThreadPool->Setup( nThreads, NULL, NULL ) )
+        {
+            delete poThreadPool;
+            poThreadPool = NULL;
+            nThreads = 1;
+        }
+    }
+
+    asJobs.resize( nThreads );
+    anV.resize( static_cast<size_t>(nThreads) * nXSize );
+    adfZ.resize( static_cast<size_t>(nThreads) * (nXSize + 1) );
+    for( int i = 0; i < nThreads; i++ )
+    {
+        asJobs[i].psCtxt = &sCtxt;
+        asJobs[i].panV = &anV[static_cast<size_t>(i) * nXSize];
+        asJobs[i].padfZ = &adfZ[static_cast<size_t>(i) * (nXSize + 1)];
+    }
+
 /* -------------------------------------------------------------------- */
-/*      Loop from top to bottom of the image.                           */
+/*      Loop from top to bottom of the image, saving the nearest        */
+/*      target above each pixel.                                        */
 /* -------------------------------------------------------------------- */
+    for( int i = 0; i < nXSize; i++ )
+        panNearY[i] = -1;
 
-    for( i = 0; i < nXSize; i++ )
-        panNearX[i] = panNearY[i] = -1;
-
-    for( iLine = 0; eErr == CE_None && iLine < nYSize; iLine++ )
+    for( int iLine = 0; eErr == CE_None && iLine < nYSize; iLine++ )
     {
         // Read for target values.
         eErr = GDALRasterIO( hSrcBand, GF_Read, 0, iLine, nXSize, 1,
@@ -314,23 +640,22 @@ GDALComputeProximity( GDALRasterBandH hSrcBand,
         if( eErr != CE_None )
             break;
 
-        for( i = 0; i < nXSize; i++ )
-            pafProximity[i] = -1.0;
-
-        // Left to right
-        ProcessProximityLine( panSrcScanline, panNearX, panNearY,
-                              TRUE, iLine, nXSize, dfMaxDist, pafProximity,
-                              pdfSrcNoData, nTargetValues, panTargetValues );
-
-        // Right to Left
-        ProcessProximityLine( panSrcScanline, panNearX, panNearY,
-                              FALSE, iLine, nXSize, dfMaxDist, pafProximity,
-                              pdfSrcNoData, nTargetValues, panTargetValues );
+        for( int i = 0; i < nXSize; i++ )
+        {
+            if( GPIsTargetValue( panSrcScanline[i], nTargetValues,
+                                 panTargetValues ) )
+            {
+                panNearY[i] = iLine;
+                panNearVal[i] = panSrcScanline[i];
+            }
+        }
 
         // Write out results.
-        eErr =
-            GDALRasterIO( hWorkProximityBand, GF_Write, 0, iLine, nXSize, 1,
-                          pafProximity, nXSize, 1, GDT_Float32, 0, 0 );
+        eErr = GDALRasterIO( hWorkBand, GF_Write, 0, iLine, nXSize, 1,
+                             panNearY, nXSize, 1, GDT_Int32, 0, 0 );
+        if( eErr == CE_None && hWorkValueBand != NULL )
+            eErr = GDALRasterIO( hWorkValueBand, GF_Write, 0, iLine, nXSize, 1,
+                                 panNearVal, nXSize, 1, GDT_Int32, 0, 0 );
 
         if( eErr != CE_None )
             break;
@@ -344,61 +669,113 @@ GDALComputeProximity( GDALRasterBandH hSrcBand,
     }
 
 /* -------------------------------------------------------------------- */
-/*      Loop from bottom to top of the image.                           */
+/*      Loop from bottom to top of the image by chunks of lines,        */
+/*      completing the column distances with the nearest target         */
+/*      below each pixel, then computing the final distances.           */
 /* -------------------------------------------------------------------- */
-    for( i = 0; i < nXSize; i++ )
-        panNearX[i] = panNearY[i] = -1;
+    for( int i = 0; i < nXSize; i++ )
+        panNearY[i] = -1;
 
-    for( iLine = nYSize-1; eErr == CE_None && iLine >= 0; iLine-- )
+    for( int nChunkEnd = nYSize; eErr == CE_None && nChunkEnd > 0; )
     {
-        // Read first pass proximity
-        eErr =
-            GDALRasterIO( hWorkProximityBand, GF_Read, 0, iLine, nXSize, 1,
-                          pafProximity, nXSize, 1, GDT_Float32, 0, 0 );
-
-        if( eErr != CE_None )
-            break;
-
-        // Read pixel values.
-
-        eErr = GDALRasterIO( hSrcBand, GF_Read, 0, iLine, nXSize, 1,
-                             panSrcScanline, nXSize, 1, GDT_Int32, 0, 0 );
-        if( eErr != CE_None )
-            break;
-
-        // Right to left
-        ProcessProximityLine( panSrcScanline, panNearX, panNearY,
-                              FALSE, iLine, nXSize, dfMaxDist, pafProximity,
-                              pdfSrcNoData, nTargetValues, panTargetValues );
+        const int nChunkYOff = MAX( 0, nChunkEnd - nChunkLines );
+        const int nLines = nChunkEnd - nChunkYOff;
 
-        // Left to right
-        ProcessProximityLine( panSrcScanline, panNearX, panNearY,
-                              TRUE, iLine, nXSize, dfMaxDist, pafProximity,
-                              pdfSrcNoData, nTargetValues, panTargetValues );
-
-        // Final post processing of distances.
-        for( i = 0; i < nXSize; i++ )
+        for( int iLine = nChunkEnd - 1;
+             eErr == CE_None && iLine >= nChunkYOff; iLine-- )
         {
-            if( pafProximity[i] < 0.0 )
-                pafProximity[i] = fNoDataValue;
-            else if( pafProximity[i] > 0.0 )
+            // Read nearest targets above.
+            eErr = GDALRasterIO( hWorkBand, GF_Read, 0, iLine, nXSize, 1,
+                                 panWorkY, nXSize, 1, GDT_Int32, 0, 0 );
+            if( eErr == CE_None && hWorkValueBand != NULL )
+                eErr = GDALRasterIO( hWorkValueBand, GF_Read, 0, iLine,
+                                     nXSize, 1, panWorkVal, nXSize, 1,
+                                     GDT_Int32, 0, 0 );
+
+            // Read pixel values.
+            if( eErr == CE_None )
+                eErr = GDALRasterIO( hSrcBand, GF_Read, 0, iLine, nXSize, 1,
+                                     panSrcScanline, nXSize, 1, GDT_Int32,
+                                     0, 0 );
+            if( eErr != CE_None )
+                break;
+
+            const size_t nOffset =
+                static_cast<size_t>(iLine - nChunkYOff) * nXSize;
+            GInt32 *panColDist = sCtxt.panColDist + nOffset;
+            GInt32 *panColTargetY = sCtxt.panColTargetY + nOffset;
+            GInt32 *panColTargetVal = sCtxt.panColTargetVal + nOffset;
+            GByte *pabyNoData = sCtxt.pabyNoData + nOffset;
+
+            for( int i = 0; i < nXSize; i++ )
             {
-                if( bFixedBufVal )
-                    pafProximity[i] = (float) dfFixedBufVal;
+                const bool bIsTarget =
+                    GPIsTargetValue( panSrcScanline[i], nTargetValues,
+                                     panTargetValues );
+                if( bIsTarget )
+                {
+                    panNearY[i] = iLine;
+                    panNearVal[i] = panSrcScanline[i];
+                }
+
+                pabyNoData[i] = !bIsTarget && pdfSrcNoData != NULL
+                    && panSrcScanline[i] == *pdfSrcNoData;
+
+                // Prefer the target above on ties.
+                if( panWorkY[i] >= 0
+                    && (panNearY[i] < 0
+                        || iLine - panWorkY[i] <= panNearY[i] - iLine) )
+                {
+                    panColDist[i] = iLine - panWorkY[i];
+                    panColTargetY[i] = panWorkY[i];
+                    panColTargetVal[i] = panWorkVal[i];
+                }
+                else if( panNearY[i] >= 0 )
+                {
+                    panColDist[i] = panNearY[i] - iLine;
+                    panColTargetY[i] = panNearY[i];
+                    panColTargetVal[i] = panNearVal[i];
+                }
                 else
-                    pafProximity[i] = (float)(pafProximity[i] * dfDistMult);
+                {
+                    panColDist[i] = -1;
+                }
             }
         }
+        if( eErr != CE_None )
+            break;
 
-        // Write out results.
-        eErr =
-            GDALRasterIO( hProximityBand, GF_Write, 0, iLine, nXSize, 1,
-                          pafProximity, nXSize, 1, GDT_Float32, 0, 0 );
+        // Compute the lines, split between the threads.
+        const int nJobs = MIN( nThreads, nLines );
+        for( int i = 0; i < nJobs; i++ )
+        {
+            asJobs[i].iFirstLine = (int)((GIntBig)nLines * i / nJobs);
+            asJobs[i].iEndLine = (int)((GIntBig)nLines * (i + 1) / nJobs);
+        }
+        if( poThreadPool != NULL && nJobs > 1 )
+        {
+            std::vector<void*> apJobs;
+            for( int i = 0; i < nJobs; i++ )
+                apJobs.push_back( &asJobs[i] );
+            poThreadPool->SubmitJobs( ProcessProximityJob, apJobs );
+            poThreadPool->WaitCompletion();
+        }
+        else
+        {
+            for( int i = 0; i < nJobs; i++ )
+                ProcessProximityJob( &asJobs[i] );
+        }
 
+        // Write out results.
+        eErr = GDALRasterIO( hProximityBand, GF_Write, 0, nChunkYOff,
+                             nXSize, nLines, sCtxt.padfOut, nXSize, nLines,
+                             GDT_Float64, 0, 0 );
         if( eErr != CE_None )
             break;
 
-        if( !pfnProgress( 0.5 + 0.5 * (nYSize-iLine) / (double) nYSize,
+        nChunkEnd = nChunkYOff;
+
+        if( !pfnProgress( 0.5 + 0.5 * (nYSize-nChunkEnd) / (double) nYSize,
                           "", pProgressArg ) )
         {
             CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
@@ -410,11 +787,17 @@ GDALComputeProximity( GDALRasterBandH hSrcBand,
 /*      Cleanup                                                         */
 /* -------------------------------------------------------------------- */
 end:
-    CPLFree( panNearX );
-    CPLFree( panNearY );
+    delete poThreadPool;
     CPLFree( panSrcScanline );
-    CPLFree( pafProximity );
-    CPLFree(panTargetValues);
+    CPLFree( panNearY );
+    CPLFree( panNearVal );
+    CPLFree( panWorkY );
+    CPLFree( panWorkVal );
+    CPLFree( sCtxt.panColDist );
+    CPLFree( sCtxt.panColTargetY );
+    CPLFree( sCtxt.panColTargetVal );
+    CPLFree( sCtxt.pabyNoData );
+    CPLFree( sCtxt.padfOut );
 
     if( hWorkProximityDS != NULL )
     {
@@ -425,136 +808,3 @@ end:
 
     return eErr;
 }
-
-/************************************************************************/
-/*                        ProcessProximityLine()                        */
-/************************************************************************/
-
-static CPLErr
-ProcessProximityLine( GInt32 *panSrcScanline, int *panNearX, int *panNearY,
-                      int bForward, int iLine, int nXSize, double dfMaxDist,
-                      float *pafProximity, double *pdfSrcNoDataValue,
-                      int nTargetValues, int *panTargetValues )
-
-{
-    int iStart, iEnd, iStep, iPixel;
-
-    if( bForward )
-    {
-        iStart = 0;
-        iEnd = nXSize;
-        iStep = 1;
-    }
-    else
-    {
-        iStart = nXSize-1;
-        iEnd = -1;
-        iStep = -1;
-    }
-
-    for( iPixel = iStart; iPixel != iEnd; iPixel += iStep )
-    {
-        int bIsTarget = FALSE;
-
-/* -------------------------------------------------------------------- */
-/*      Is the current pixel a target pixel?                            */
-/* -------------------------------------------------------------------- */
-        if( nTargetValues == 0 )
-            bIsTarget = (panSrcScanline[iPixel] != 0);
-        else
-        {
-            int i;
-
-            for( i = 0; i < nTargetValues; i++ )
-            {
-                if( panSrcScanline[iPixel] == panTargetValues[i] )
-                    bIsTarget = TRUE;
-            }
-        }
-
-        if( bIsTarget )
-        {
-            pafProximity[iPixel] = 0.0;
-            panNearX[iPixel] = iPixel;
-            panNearY[iPixel] = iLine;
-            continue;
-        }
-
-/* -------------------------------------------------------------------- */
-/*      Are we near(er) to the closest target to the above (below)      */
-/*      pixel?                                                          */
-/* -------------------------------------------------------------------- */
-        float fNearDistSq = (float) (MAX(dfMaxDist,nXSize) * MAX(dfMaxDist,nXSize) * 2);
-        float fDistSq;
-
-        if( panNearX[iPixel] != -1 )
-        {
-            fDistSq = (float)
-                ((panNearX[iPixel] - iPixel) * (panNearX[iPixel] - iPixel)
-                 + (panNearY[iPixel] - iLine) * (panNearY[iPixel] - iLine));
-
-            if( fDistSq < fNearDistSq )
-            {
-                fNearDistSq = fDistSq;
-            }
-            else
-            {
-                panNearX[iPixel] = -1;
-                panNearY[iPixel] = -1;
-            }
-        }
-
-/* -------------------------------------------------------------------- */
-/*      Are we near(er) to the closest target to the left (right)       */
-/*      pixel?                                                          */
-/* -------------------------------------------------------------------- */
-        int iLast = iPixel-iStep;
-
-        if( iPixel != iStart && panNearX[iLast] != -1 )
-        {
-            fDistSq = (float)
-                ((panNearX[iLast] - iPixel) * (panNearX[iLast] - iPixel)
-                 + (panNearY[iLast] - iLine) * (panNearY[iLast] - iLine));
-
-            if( fDistSq < fNearDistSq )
-            {
-                fNearDistSq = fDistSq;
-                panNearX[iPixel] = panNearX[iLast];
-                panNearY[iPixel] = panNearY[iLast];
-            }
-        }
-
-/* -------------------------------------------------------------------- */
-/*      Are we near(er) to the closest target to the topright           */
-/*      (bottom left) pixel?                                            */
-/* -------------------------------------------------------------------- */
-        int iTR = iPixel+iStep;
-
-        if( iTR != iEnd && panNearX[iTR] != -1 )
-        {
-            fDistSq = (float)
-                ((panNearX[iTR] - iPixel) * (panNearX[iTR] - iPixel)
-                 + (panNearY[iTR] - iLine) * (panNearY[iTR] - iLine));
-
-            if( fDistSq < fNearDistSq )
-            {
-                fNearDistSq = fDistSq;
-                panNearX[iPixel] = panNearX[iTR];
-                panNearY[iPixel] = panNearY[iTR];
-            }
-        }
-
-/* -------------------------------------------------------------------- */
-/*      Update our proximity value.                                     */
-/* -------------------------------------------------------------------- */
-        if( panNearX[iPixel] != -1
-            && (pdfSrcNoDataValue == NULL
-                || panSrcScanline[iPixel] != *pdfSrcNoDataValue)
-            && fNearDistSq <= dfMaxDist * dfMaxDist
-            && (pafProximity[iPixel] < 0
-                || fNearDistSq < pafProximity[iPixel] * pafProximity[iPixel]) )
-            pafProximity[iPixel] = sqrt(fNearDistSq);
-    }
-
-    return CE_None;
-}
@@ -33,6 +33,7 @@
 #include "gdal_alg.h"
 #include "gdal_alg_priv.h"
 #include "gdal_priv.h"
+#include "cpl_worker_thread_pool.h"
 #include "ogr_api.h"
 #include "ogr_geometry.h"
 #include "ogr_spatialref.h"
@@ -54,6 +55,8 @@ void gvBurnScanline( void *pCBData, int nY, int nXStart, int nXEnd,
         return;
 
     CPLAssert( nY >= 0 && nY < psInfo->nYSize );
+    if( nY < psInfo->nYMin || nY >= psInfo->nYMax )
+        return;
     CPLAssert( nXStart <= nXEnd );
     CPLAssert( nXStart < psInfo->nXSize );
     CPLAssert( nXEnd >= 0 );
@@ -127,6 +130,8 @@ void gvBurnPoint( void *pCBData, int nY, int nX, double dfVariant )
 
     CPLAssert( nY >= 0 && nY < psInfo->nYSize );
     CPLAssert( nX >= 0 && nX < psInfo->nXSize );
+    if( nY < psInfo->nYMin || nY >= psInfo->nYMax )
+        return;
 
     if( psInfo->eType == GDT_Byte )
     {
@@ -300,6 +305,73 @@ static void GDALCollectRingsFromGeometry(
     }
 }
 
+/************************************************************************/
+/*                    GDALRasterizeIsLinearOrPoint()                    */
+/************************************************************************/
+
+static bool GDALRasterizeIsLinearOrPoint( OGRwkbGeometryType eFlatType )
+{
+    return eFlatType == wkbPoint || eFlatType == wkbMultiPoint ||
+           eFlatType == wkbLineString || eFlatType == wkbMultiLineString;
+}
+
+/************************************************************************/
+/*                         gv_rasterize_parts()                         */
+/*                                                                      */
+/*      Burn the parts of a shape, already in pixel/line coordinates    */
+/*      of the buffer of psInfo.  padfVariant is NULL when burning      */
+/*      user values.                                                    */
+/************************************************************************/
+
+static void
+gv_rasterize_parts( GDALRasterizeInfo *psInfo, OGRwkbGeometryType eFlatType,
+                    int bAllTouched, int nPartCount, int *panPartSize,
+                    double *padfX, double *padfY, double *padfVariant )
+
+{
+    switch ( eFlatType )
+    {
+      case wkbPoint:
+      case wkbMultiPoint:
+        GDALdllImagePoint( psInfo->nXSize, psInfo->nYSize,
+                           nPartCount, panPartSize,
+                           padfX, padfY, padfVariant,
+                           gvBurnPoint, psInfo );
+        break;
+      case wkbLineString:
+      case wkbMultiLineString:
+      {
+          if( bAllTouched )
+              GDALdllImageLineAllTouched( psInfo->nXSize, psInfo->nYSize,
+                                          nPartCount, panPartSize,
+                                          padfX, padfY, padfVariant,
+                                          gvBurnPoint, psInfo );
+          else
+              GDALdllImageLine( psInfo->nXSize, psInfo->nYSize,
+                                nPartCount, panPartSize,
+                                padfX, padfY, padfVariant,
+                                gvBurnPoint, psInfo );
+      }
+      break;
+
+      default:
+      {
+          GDALdllImageFilledPolygon( psInfo->nXSize, psInfo->nYSize,
+                                     nPartCount, panPartSize,
+                                     padfX, padfY, padfVariant,
+                                     gvBurnScanline, psInfo );
+          if( bAllTouched )
+          {
+              GDALdllImageLineAllTouched( psInfo->nXSize, psInfo->nYSize,
+                                          nPartCount, panPartSize,
+                                          padfX, padfY, padfVariant,
+                                          gvBurnPoint, psInfo );
+          }
+      }
+      break;
+    }
+}
+
 /************************************************************************/
 /*                       gv_rasterize_one_shape()                       */
 /************************************************************************/
@@ -327,6 +399,8 @@ gv_rasterize_one_shape( unsigned char *pabyChunkBuf, int nYOff,
     sInfo.padfBurnValue = padfBurnValue;
     sInfo.eBurnValueSource = eBurnValueSrc;
     sInfo.eMergeAlg = eMergeAlg;
+    sInfo.nYMin = 0;
+    sInfo.nYMax = nYSize;
 
 /* -------------------------------------------------------------------- */
 /*      Transform polygon geometries into a set of rings and a part     */
@@ -339,6 +413,8 @@ gv_rasterize_one_shape( unsigned char *pabyChunkBuf, int nYOff,
 
     GDALCollectRingsFromGeometry( poShape, aPointX, aPointY, aPointVariant,
                                   aPartSize, eBurnValueSrc );
+    if( aPointX.empty() )
+        return;
 
 /* -------------------------------------------------------------------- */
 /*      Transform points if needed.                                     */
@@ -363,89 +439,26 @@ gv_rasterize_one_shape( unsigned char *pabyChunkBuf, int nYOff,
 
 /* -------------------------------------------------------------------- */
 /*      Perform the rasterization.                                      */
-/*      According to the C++ Standard/23.2.4, elements of a vector are  */
-/*      stored in continuous memory block.                              */
 /* -------------------------------------------------------------------- */
-
-    // TODO - mloskot: Check if vectors are empty, otherwise it may
-    // lead to undefined behavior by returning non-referencable pointer.
-    // if (!aPointX.empty())
-    //    /* fill polygon */
-    // else
-    //    /* How to report this problem? */
-    switch ( wkbFlatten(poShape->getGeometryType()) )
+    const OGRwkbGeometryType eFlatType =
+        wkbFlatten(poShape->getGeometryType());
+
+    /* The polygon is filled using the variant from the first point of */
+    /* the first segment, and with ALL_TOUCHED its outline is burnt with */
+    /* that same variant.  Should be removed when the code to fill */
+    /* polygons more appropriately is added. */
+    if( eBurnValueSrc != GBV_UserBurnValue && bAllTouched &&
+        !GDALRasterizeIsLinearOrPoint( eFlatType ) )
     {
-      case wkbPoint:
-      case wkbMultiPoint:
-        GDALdllImagePoint( sInfo.nXSize, nYSize,
-                           static_cast<int>(aPartSize.size()), &(aPartSize[0]),
-                           &(aPointX[0]), &(aPointY[0]),
-                           (eBurnValueSrc == GBV_UserBurnValue)?
-                           NULL : &(aPointVariant[0]),
-                           gvBurnPoint, &sInfo );
-        break;
-      case wkbLineString:
-      case wkbMultiLineString:
-      {
-          if( bAllTouched )
-              GDALdllImageLineAllTouched( sInfo.nXSize, nYSize,
-                                          static_cast<int>(aPartSize.size()), &(aPartSize[0]),
-                                          &(aPointX[0]), &(aPointY[0]),
-                                          (eBurnValueSrc == GBV_UserBurnValue)?
-                                          NULL : &(aPointVariant[0]),
-                                          gvBurnPoint, &sInfo );
-          else
-              GDALdllImageLine( sInfo.nXSize, nYSize,
-                                static_cast<int>(aPartSize.size()), &(aPartSize[0]),
-                                &(aPointX[0]), &(aPointY[0]),
-                                (eBurnValueSrc == GBV_UserBurnValue)?
-                                NULL : &(aPointVariant[0]),
-                                gvBurnPoint, &sInfo );
-      }
-      break;
-
-      default:
-      {
-          GDALdllImageFilledPolygon( sInfo.nXSize, nYSize,
-                                     static_cast<int>(aPartSize.size()), &(aPartSize[0]),
-                                     &(aPointX[0]), &(aPointY[0]),
-                                     (eBurnValueSrc == GBV_UserBurnValue)?
-                                     NULL : &(aPointVariant[0]),
-                                     gvBurnScanline, &sInfo );
-          if( bAllTouched )
-          {
-              /* Reverting the variants to the first value because the
-                 polygon is filled using the variant from the first point of
-                 the first segment. Should be removed when the code to full
-                 polygons more appropriately is added. */
-              if(eBurnValueSrc == GBV_UserBurnValue)
-              {
-                  GDALdllImageLineAllTouched( sInfo.nXSize, nYSize,
-                                              static_cast<int>(aPartSize.size()), &(aPartSize[0]),
-                                              &(aPointX[0]), &(aPointY[0]),
-                                              NULL,
-                                              gvBurnPoint, &sInfo );
-              }
-              else
-              {
-                  unsigned int n;
-                  for ( i = 0, n = 0; i < static_cast<unsigned int>(aPartSize.size()); i++ )
-                  {
-                      int j;
-                      for ( j = 0; j < aPartSize[i]; j++ )
-                          aPointVariant[n++] = aPointVariant[0];
-                  }
-
-                  GDALdllImageLineAllTouched( sInfo.nXSize, nYSize,
-                                              static_cast<int>(aPartSize.size()), &(aPartSize[0]),
-                                              &(aPointX[0]), &(aPointY[0]),
-                                              &(aPointVariant[0]),
-                                              gvBurnPoint, &sInfo );
-              }
-          }
-      }
-      break;
+        const double dfVariant = aPointVariant[0];
+        aPointVariant.assign( aPointX.size(), dfVariant );
     }
+
+    gv_rasterize_parts( &sInfo, eFlatType, bAllTouched,
+                        static_cast<int>(aPartSize.size()), &(aPartSize[0]),
+                        &(aPointX[0]), &(aPointY[0]),
+                        (eBurnValueSrc == GBV_UserBurnValue)?
+                        NULL : &(aPointVariant[0]) );
 }
 
 /************************************************************************/
@@ -502,6 +515,215 @@ static CPLErr GDALRasterizeOptions(char **papszOptions,
     return CE_None;
 }
 
+/************************************************************************/
+/*                    Tiled burning of geometries.                      */
+/*                                                                      */
+/*      GDALRasterizeGeometries() transforms each geometry to           */
+/*      pixel/line coordinates once, and bins it into the tiles of      */
+/*      lines it may touch, according to its vertical extent.  The      */
+/*      tiles of a chunk are burnt independently, possibly by several   */
+/*      threads, each one going through its own list of geometries in   */
+/*      their original order and only writing its own lines.  Pixels    */
+/*      thus receive the same burns in the same order whatever the      */
+/*      tiling and the number of threads.                               */
+/************************************************************************/
+
+typedef struct
+{
+    OGRwkbGeometryType eFlatType;
+    int         nPartCount;
+    size_t      nPartStart;
+    size_t      nPointStart;
+    size_t      nPointCount;
+    double     *padfBurnValue;
+    int         nYMin;  // lines that may be touched, in raster coordinates
+    int         nYMax;
+} GDALRasterizeShape;
+
+typedef struct
+{
+    std::vector<GDALRasterizeShape> asShapes;
+    std::vector<int>    anPartSize;
+    std::vector<double> adfX;
+    std::vector<double> adfY;
+    std::vector<double> adfVariant;
+
+    // Collection of the current geometry.
+    std::vector<double> adfScratchX;
+    std::vector<double> adfScratchY;
+    std::vector<double> adfScratchVariant;
+    std::vector<int>    anScratchPartSize;
+
+    // Shapes of tile i are anTileShapes[anTileStart[i]] to
+    // anTileShapes[anTileStart[i+1]-1], in input order.
+    std::vector<size_t> anTileStart;
+    std::vector<int>    anTileShapes;
+
+    int         nXSize;
+    int         nBands;
+    GDALDataType eType;
+    int         bAllTouched;
+    GDALBurnValueSrc eBurnValueSource;
+    GDALRasterMergeAlg eMergeAlg;
+
+    // Chunk being burnt.
+    unsigned char *pabyChunkBuf;
+    int         nChunkYOff;
+    int         nChunkYSize;
+} GDALRasterizeTiledContext;
+
+typedef struct
+{
+    GDALRasterizeTiledContext *psCtxt;
+    int         iTile;
+    int         nTileYOff;  // relative to the chunk
+    int         nTileYSize;
+    std::vector<double> adfY;
+} GDALRasterizeTileJob;
+
+/************************************************************************/
+/*                     GDALRasterizePrepareShape()                      */
+/*                                                                      */
+/*      Collect the rings of a geometry, transform them to              */
+/*      pixel/line and append them to the context.                      */
+/************************************************************************/
+
+static void GDALRasterizePrepareShape( GDALRasterizeTiledContext *psCtxt,
+                                       OGRGeometry *poShape,
+                                       double *padfBurnValue,
+                                       int nRasterYSize,
+                                       GDALTransformerFunc pfnTransformer,
+                                       void *pTransformArg )
+
+{
+    if( poShape == NULL )
+        return;
+
+/* -------------------------------------------------------------------- */
+/*      Collect in scratch vectors first: appending directly to the     */
+/*      arrays of the context would defeat their geometric growth.      */
+/* -------------------------------------------------------------------- */
+    std::vector<double> &aPointX = psCtxt->adfScratchX;
+    std::vector<double> &aPointY = psCtxt->adfScratchY;
+    std::vector<double> &aPointVariant = psCtxt->adfScratchVariant;
+    std::vector<int> &aPartSize = psCtxt->anScratchPartSize;
+    aPointX.clear();
+    aPointY.clear();
+    aPointVariant.clear();
+    aPartSize.clear();
+
+    GDALCollectRingsFromGeometry( poShape, aPointX, aPointY, aPointVariant,
+                                  aPartSize, psCtxt->eBurnValueSource );
+    if( aPointX.empty() )
+        return;
+
+    GDALRasterizeShape sShape;
+    sShape.eFlatType = wkbFlatten(poShape->getGeometryType());
+    sShape.nPartCount = static_cast<int>(aPartSize.size());
+    sShape.nPartStart = psCtxt->anPartSize.size();
+    sShape.nPointStart = psCtxt->adfX.size();
+    sShape.nPointCount = aPointX.size();
+    sShape.padfBurnValue = padfBurnValue;
+
+/* -------------------------------------------------------------------- */
+/*      Keep one variant per point.  Polygons only use the variant of   */
+/*      their first point (see gv_rasterize_one_shape()).               */
+/* -------------------------------------------------------------------- */
+    if( psCtxt->eBurnValueSource != GBV_UserBurnValue &&
+        (aPointVariant.size() != aPointX.size() ||
+         !GDALRasterizeIsLinearOrPoint( sShape.eFlatType )) )
+    {
+        const double dfVariant =
+            aPointVariant.empty() ? 0.0 : aPointVariant[0];
+        aPointVariant.assign( aPointX.size(), dfVariant );
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Transform points if needed, and find the lines touched.         */
+/* -------------------------------------------------------------------- */
+    if( pfnTransformer != NULL )
+    {
+        int *panSuccess = (int *) CPLCalloc(sizeof(int), aPointX.size());
+
+        pfnTransformer( pTransformArg, FALSE,
+                        static_cast<int>(aPointX.size()),
+                        &(aPointX[0]), &(aPointY[0]), NULL, panSuccess );
+        CPLFree( panSuccess );
+    }
+
+    double dfYMin = aPointY[0];
+    double dfYMax = aPointY[0];
+    for( size_t i = 1; i < aPointY.size(); i++ )
+    {
+        if( aPointY[i] < dfYMin )
+            dfYMin = aPointY[i];
+        if( aPointY[i] > dfYMax )
+            dfYMax = aPointY[i];
+    }
+
+    // One line of margin for the rounding of the line drawing algorithms.
+    if( !(dfYMax >= -1.0 && dfYMin < nRasterYSize + 1.0) )
+        return;
+    sShape.nYMin = dfYMin < 1.0 ? 0 : static_cast<int>(floor(dfYMin)) - 1;
+    sShape.nYMax = dfYMax >= nRasterYSize - 2 ?
+        nRasterYSize - 1 : static_cast<int>(floor(dfYMax)) + 1;
+
+    psCtxt->adfX.insert( psCtxt->adfX.end(), aPointX.begin(), aPointX.end() );
+    psCtxt->adfY.insert( psCtxt->adfY.end(), aPointY.begin(), aPointY.end() );
+    if( psCtxt->eBurnValueSource != GBV_UserBurnValue )
+        psCtxt->adfVariant.insert( psCtxt->adfVariant.end(),
+                                   aPointVariant.begin(),
+                                   aPointVariant.end() );
+    psCtxt->anPartSize.insert( psCtxt->anPartSize.end(),
+                               aPartSize.begin(), aPartSize.end() );
+    psCtxt->asShapes.push_back( sShape );
+}
+
+/************************************************************************/
+/*                         GDALRasterizeTile()                          */
+/************************************************************************/
+
+static void GDALRasterizeTile( void *pData )
+
+{
+    GDALRasterizeTileJob *psJob = (GDALRasterizeTileJob *) pData;
+    GDALRasterizeTiledContext *psCtxt = psJob->psCtxt;
+
+    GDALRasterizeInfo sInfo;
+    sInfo.pabyChunkBuf = psCtxt->pabyChunkBuf;
+    sInfo.nXSize = psCtxt->nXSize;
+    sInfo.nYSize = psCtxt->nChunkYSize;
+    sInfo.nBands = psCtxt->nBands;
+    sInfo.eType = psCtxt->eType;
+    sInfo.eBurnValueSource = psCtxt->eBurnValueSource;
+    sInfo.eMergeAlg = psCtxt->eMergeAlg;
+    sInfo.nYMin = psJob->nTileYOff;
+    sInfo.nYMax = psJob->nTileYOff + psJob->nTileYSize;
+
+    for( size_t k = psCtxt->anTileStart[psJob->iTile];
+         k < psCtxt->anTileStart[psJob->iTile + 1]; k++ )
+    {
+        const GDALRasterizeShape &sShape =
+            psCtxt->asShapes[psCtxt->anTileShapes[k]];
+
+        // Shift to account for the buffer offset of this chunk, the same
+        // way whatever the tile so that results do not depend on it.
+        psJob->adfY.resize( sShape.nPointCount );
+        const double *padfSrcY = &(psCtxt->adfY[sShape.nPointStart]);
+        for( size_t i = 0; i < sShape.nPointCount; i++ )
+            psJob->adfY[i] = padfSrcY[i] - psCtxt->nChunkYOff;
+
+        sInfo.padfBurnValue = sShape.padfBurnValue;
+        gv_rasterize_parts( &sInfo, sShape.eFlatType, psCtxt->bAllTouched,
+                            sShape.nPartCount,
+                            &(psCtxt->anPartSize[sShape.nPartStart]),
+                            &(psCtxt->adfX[sShape.nPointStart]),
+                            &(psJob->adfY[0]),
+                            psCtxt->eBurnValueSource == GBV_UserBurnValue ?
+                            NULL : &(psCtxt->adfVariant[sShape.nPointStart]) );
+    }
+}
+
 /************************************************************************/
 /*                      GDALRasterizeGeometries()                       */
 /************************************************************************/
@@ -548,6 +770,10 @@ static CPLErr GDALRasterizeOptions(char **papszOptions,
  * dfBurnValue is burned. This is implemented only for points and lines for
  * now. The M value may be supported in the future.</dd>
  * <dt>"MERGE_ALG":</dt> <dd>May be REPLACE (the default) or ADD.  REPLACE results in overwriting of value, while ADD adds the new value to the existing raster, suitable for heatmaps for instance.</dd>
+ * <dt>"NUM_THREADS":</dt> <dd>(GDAL &gt;= 2.2) Number of worker threads
+ * burning tiles of lines of the raster in parallel, or ALL_CPUS.  Defaults
+ * to the value of the GDAL_NUM_THREADS configuration option, or 1.  The
+ * result does not depend on the number of threads.</dd>
  * </dl>
  * @param pfnProgress the progress function to report completion.
  * @param pProgressArg callback data for progress function.
@@ -639,18 +865,113 @@ CPLErr GDALRasterizeGeometries( GDALDatasetH hDS,
         nYChunkSize = 10000000 / nScanlineBytes;
     }
 
+    if( nYChunkSize < 1 )
+        nYChunkSize = 1;
     if( nYChunkSize > poDS->GetRasterYSize() )
         nYChunkSize = poDS->GetRasterYSize();
 
-    CPLDebug( "GDAL", "Rasterizer operating on %d swaths of %d scanlines.",
-              (poDS->GetRasterYSize()+nYChunkSize-1) / nYChunkSize,
-              nYChunkSize );
+/* -------------------------------------------------------------------- */
+/*      Split chunks in tiles of lines to burn in parallel.             */
+/* -------------------------------------------------------------------- */
+    const char *pszThreads = CSLFetchNameValue( papszOptions, "NUM_THREADS" );
+    if( pszThreads == NULL )
+        pszThreads = CPLGetConfigOption( "GDAL_NUM_THREADS", "1" );
+    int nThreads = EQUAL(pszThreads, "ALL_CPUS") ?
+        CPLGetNumCPUs() : atoi( pszThreads );
+    nThreads = MAX(1, MIN(128, nThreads));
+
+    int nTileHeight = nYChunkSize;
+    if( nThreads > 1 )
+        nTileHeight = MIN( nYChunkSize,
+                           MAX( 16, (nYChunkSize + 4 * nThreads - 1) /
+                                        (4 * nThreads) ) );
+    const int nTilesPerChunk = (nYChunkSize + nTileHeight - 1) / nTileHeight;
+    const int nChunks =
+        (poDS->GetRasterYSize() + nYChunkSize - 1) / nYChunkSize;
+
+    CPLDebug( "GDAL", "Rasterizer operating on %d swaths of %d scanlines, "
+              "in tiles of %d scanlines.",
+              nChunks, nYChunkSize, nTileHeight );
+
+/* -------------------------------------------------------------------- */
+/*      Transform the geometries once, and bin them in the tiles of     */
+/*      lines they may touch.                                           */
+/* -------------------------------------------------------------------- */
+    GDALRasterizeTiledContext sCtxt;
+    sCtxt.nXSize = poDS->GetRasterXSize();
+    sCtxt.nBands = nBandCount;
+    sCtxt.eType = eType;
+    sCtxt.bAllTouched = bAllTouched;
+    sCtxt.eBurnValueSource = eBurnValueSource;
+    sCtxt.eMergeAlg = eMergeAlg;
+    sCtxt.pabyChunkBuf = NULL;
+    sCtxt.nChunkYOff = 0;
+    sCtxt.nChunkYSize = 0;
+
+    for( int iShape = 0; iShape < nGeomCount; iShape++ )
+    {
+        GDALRasterizePrepareShape( &sCtxt,
+                                   (OGRGeometry *) pahGeometries[iShape],
+                                   padfGeomBurnValue + iShape*nBandCount,
+                                   poDS->GetRasterYSize(),
+                                   pfnTransformer, pTransformArg );
+    }
+
+    if( bNeedToFreeTransformer )
+        GDALDestroyTransformer( pTransformArg );
+
+    const int nTiles = nChunks * nTilesPerChunk;
+    const int nShapes = static_cast<int>(sCtxt.asShapes.size());
+#define TILE_OF_LINE(y) \
+    (((y) / nYChunkSize) * nTilesPerChunk + ((y) % nYChunkSize) / nTileHeight)
+
+    sCtxt.anTileStart.resize( nTiles + 1, 0 );
+    for( int iShape = 0; iShape < nShapes; iShape++ )
+    {
+        const int iLastTile = TILE_OF_LINE(sCtxt.asShapes[iShape].nYMax);
+        for( int iTile = TILE_OF_LINE(sCtxt.asShapes[iShape].nYMin);
+             iTile <= iLastTile; iTile++ )
+            sCtxt.anTileStart[iTile + 1]++;
+    }
+    for( int iTile = 0; iTile < nTiles; iTile++ )
+        sCtxt.anTileStart[iTile + 1] += sCtxt.anTileStart[iTile];
+
+    sCtxt.anTileShapes.resize( sCtxt.anTileStart[nTiles] );
+    {
+        std::vector<size_t> anTileFill( sCtxt.anTileStart.begin(),
+                                        sCtxt.anTileStart.end() - 1 );
+        for( int iShape = 0; iShape < nShapes; iShape++ )
+        {
+            const int iLastTile = TILE_OF_LINE(sCtxt.asShapes[iShape].nYMax);
+            for( int iTile = TILE_OF_LINE(sCtxt.asShapes[iShape].nYMin);
+                 iTile <= iLastTile; iTile++ )
+                sCtxt.anTileShapes[anTileFill[iTile]++] = iShape;
+        }
+    }
+#undef TILE_OF_LINE
 
     pabyChunkBuf = (unsigned char *) VSI_MALLOC2_VERBOSE(nYChunkSize, nScanlineBytes);
     if( pabyChunkBuf == NULL )
     {
         return CE_Failure;
     }
+    sCtxt.pabyChunkBuf = pabyChunkBuf;
+
+    CPLWorkerThreadPool *poThreadPool = NULL;
+    if( nThreads > 1 && nTilesPerChunk > 1 )
+    {
+        poThreadPool = new (std::nothrow) CPLWorkerThreadPool();
+        if( poThreadPool == NULL ||
+            !poThreadPool->Setup( MIN(nThreads, nTilesPerChunk), NULL, NULL ) )
+        {
+            delete poThreadPool;
+            poThreadPool = NULL;
+        }
+    }
+
+    std::vector<GDALRasterizeTileJob> asJobs( nTilesPerChunk );
+    for( int i = 0; i < nTilesPerChunk; i++ )
+        asJobs[i].psCtxt = &sCtxt;
 
 /* ==================================================================== */
 /*      Loop over image in designated chunks.                           */
@@ -664,38 +985,58 @@ CPLErr GDALRasterizeGeometries( GDALDatasetH hDS,
          iY += nYChunkSize )
     {
         int	nThisYChunkSize;
-        int     iShape;
 
         nThisYChunkSize = nYChunkSize;
         if( nThisYChunkSize + iY > poDS->GetRasterYSize() )
             nThisYChunkSize = poDS->GetRasterYSize() - iY;
 
-        eErr =
-            poDS->RasterIO(GF_Read,
-                           0, iY, poDS->GetRasterXSize(), nThisYChunkSize,
-                           pabyChunkBuf,poDS->GetRasterXSize(),nThisYChunkSize,
-                           eType, nBandCount, panBandList,
-                           0, 0, 0, NULL );
-        if( eErr != CE_None )
-            break;
-
-        for( iShape = 0; iShape < nGeomCount; iShape++ )
+        // Collect the tiles of this chunk that have something to burn.
+        const int iFirstTile = (iY / nYChunkSize) * nTilesPerChunk;
+        std::vector<void*> apJobs;
+        for( int i = 0; i < nTilesPerChunk; i++ )
         {
-            gv_rasterize_one_shape( pabyChunkBuf, iY,
-                                    poDS->GetRasterXSize(), nThisYChunkSize,
-                                    nBandCount, eType, bAllTouched,
-                                    (OGRGeometry *) pahGeometries[iShape],
-                                    padfGeomBurnValue + iShape*nBandCount,
-                                    eBurnValueSource, eMergeAlg,
-                                    pfnTransformer, pTransformArg );
+            const int iTile = iFirstTile + i;
+            if( sCtxt.anTileStart[iTile] == sCtxt.anTileStart[iTile + 1] )
+                continue;
+            asJobs[i].iTile = iTile;
+            asJobs[i].nTileYOff = i * nTileHeight;
+            asJobs[i].nTileYSize =
+                MIN(nTileHeight, nThisYChunkSize - i * nTileHeight);
+            apJobs.push_back( &asJobs[i] );
         }
 
-        eErr =
-            poDS->RasterIO( GF_Write, 0, iY,
-                            poDS->GetRasterXSize(), nThisYChunkSize,
-                            pabyChunkBuf,
-                            poDS->GetRasterXSize(), nThisYChunkSize,
-                            eType, nBandCount, panBandList, 0, 0, 0, NULL);
+        if( !apJobs.empty() )
+        {
+            eErr =
+                poDS->RasterIO(GF_Read,
+                               0, iY, poDS->GetRasterXSize(), nThisYChunkSize,
+                               pabyChunkBuf,poDS->GetRasterXSize(),nThisYChunkSize,
+                               eType, nBandCount, panBandList,
+                               0, 0, 0, NULL );
+            if( eErr != CE_None )
+                break;
+
+            sCtxt.nChunkYOff = iY;
+            sCtxt.nChunkYSize = nThisYChunkSize;
+
+            if( poThreadPool != NULL && apJobs.size() > 1 )
+            {
+                poThreadPool->SubmitJobs( GDALRasterizeTile, apJobs );
+                poThreadPool->WaitCompletion();
+            }
+            else
+            {
+                for( size_t i = 0; i < apJobs.size(); i++ )
+                    GDALRasterizeTile( apJobs[i] );
+            }
+
+            eErr =
+                poDS->RasterIO( GF_Write, 0, iY,
+                                poDS->GetRasterXSize(), nThisYChunkSize,
+                                pabyChunkBuf,
+                                poDS->GetRasterXSize(), nThisYChunkSize,
+                                eType, nBandCount, panBandList, 0, 0, 0, NULL);
+        }
 
         if( !pfnProgress((iY+nThisYChunkSize)/((double)poDS->GetRasterYSize()),
                          "", pProgressArg ) )
@@ -708,11 +1049,9 @@ CPLErr GDALRasterizeGeometries( GDALDatasetH hDS,
 /* -------------------------------------------------------------------- */
 /*      cleanup                                                         */
 /* -------------------------------------------------------------------- */
+    delete poThreadPool;
     VSIFree( pabyChunkBuf );
 
-    if( bNeedToFreeTransformer )
-        GDALDestroyTransformer( pTransformArg );
-
     return eErr;
 }
 
@@ -153,6 +153,24 @@ int GDALRasterPolygonEnumeratorT<DataType,EqualityTest>::NewPolygon( DataType nV
 template<class DataType, class EqualityTest>
 void GDALRasterPolygonEnumeratorT<DataType,EqualityTest>::CompleteMerges()
 
+{
+    int nFinalPolyCount = ResolveMerges();
+
+    CPLDebug( "GDALRasterPolygonEnumerator",
+              "Counted %d polygon fragments forming %d final polygons.",
+              nNextPolygonId, nFinalPolyCount );
+}
+
+/************************************************************************/
+/*                           ResolveMerges()                            */
+/*                                                                      */
+/*      Same as CompleteMerges(), but silent, so that it can be         */
+/*      called after each line. Returns the number of final polygons.   */
+/************************************************************************/
+
+template<class DataType, class EqualityTest>
+int GDALRasterPolygonEnumeratorT<DataType,EqualityTest>::ResolveMerges()
+
 {
     int iPoly;
     int nFinalPolyCount = 0;
@@ -180,9 +198,56 @@ void GDALRasterPolygonEnumeratorT<DataType,EqualityTest>::CompleteMerges()
             nFinalPolyCount++;
     }
 
-    CPLDebug( "GDALRasterPolygonEnumerator",
-              "Counted %d polygon fragments forming %d final polygons.",
-              nNextPolygonId, nFinalPolyCount );
+    return nFinalPolyCount;
+}
+
+/************************************************************************/
+/*                          RenumberPolygons()                          */
+/*                                                                      */
+/*      Renumber the final polygons referenced by a line of ids so      */
+/*      that they are 0..N-1, and forget about all other ids. This      */
+/*      keeps the maps bounded by the line width when processing a      */
+/*      raster in a single pass. ResolveMerges() must have been         */
+/*      called before. panNewIdMap must have room for                   */
+/*      nNextPolygonId values, and is set with the new id of each       */
+/*      final polygon, or -1 if it is not referenced by the line.       */
+/*      Returns the new number of polygons.                             */
+/************************************************************************/
+
+template<class DataType, class EqualityTest>
+int GDALRasterPolygonEnumeratorT<DataType,EqualityTest>::RenumberPolygons(
+    GInt32 *panLineId, int nXSize, GInt32 *panNewIdMap )
+
+{
+    int i;
+    int nNewPolygonCount = 0;
+    std::vector<DataType> anNewValue;
+
+    for( i = 0; i < nNextPolygonId; i++ )
+        panNewIdMap[i] = -1;
+
+    for( i = 0; i < nXSize; i++ )
+    {
+        if( panLineId[i] == -1 )
+            continue;
+
+        int nId = panPolyIdMap[panLineId[i]];
+        if( panNewIdMap[nId] < 0 )
+        {
+            panNewIdMap[nId] = nNewPolygonCount++;
+            anNewValue.push_back( panPolyValue[nId] );
+        }
+        panLineId[i] = panNewIdMap[nId];
+    }
+
+    for( i = 0; i < nNewPolygonCount; i++ )
+    {
+        panPolyIdMap[i] = i;
+        panPolyValue[i] = anNewValue[i];
+    }
+    nNextPolygonId = nNewPolygonCount;
+
+    return nNewPolygonCount;
 }
 
 /************************************************************************/
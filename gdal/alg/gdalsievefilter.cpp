@@ -30,62 +30,68 @@
 
 #include "gdal_alg_priv.h"
 #include "cpl_conv.h"
+#include <algorithm>
 #include <vector>
 #include <set>
 
 CPL_CVSID("$Id$");
 
-#define MY_MAX_INT 2147483647
-
 /*
  * General Plan
  *
- * 1) make a pass with the polygon enumerator to build up the
- *    polygon map array.  Also accumulate polygon size information.
- *
- * 2) Identify the polygons that need to be merged.
+ * 1) label the connected components of the raster with
+ *    GDALConnectedComponents, which also accumulates their sizes.
  *
- * 3) Make a pass with the polygon enumerator.  For each "to be merged"
- *    polygon keep track of its largest neighbour.
+ * 2) Make a pass over the components.  For each polygon keep track of
+ *    its largest neighbour.  Each strip of lines keeps its own largest
+ *    neighbours, that are merged in strip order afterwards.
  *
- * 4) Fix up remappings that would go to polygons smaller than the seive
+ * 3) Fix up remappings that would go to polygons smaller than the seive
  *    size.  Ensure these in term map to the largest neighbour of the
  *    "to be sieved" polygons.
  *
- * 5) Make another pass with the polygon enumerator. This time we remap
+ * 4) Make another pass over the components. This time we remap
  *    the actual pixel values of all polygons to be merged.
  */
 
 /************************************************************************/
-/*                          GPMaskImageData()                           */
+/*                            GPSieveStrip                              */
 /*                                                                      */
-/*      Mask out image pixels to a special nodata value if the mask     */
-/*      band is zero.                                                   */
+/*      Largest neighbours found in a strip, for the components whose   */
+/*      first pixel is in the strip, followed by the ones of the        */
+/*      components of the strip first line (or of the line above) that  */
+/*      started in a previous strip.                                    */
 /************************************************************************/
 
-static CPLErr
-GPMaskImageData( GDALRasterBandH hMaskBand, GByte *pabyMaskLine, int iY, int nXSize,
-                 GInt32 *panImageLine )
+struct GPSieveStrip
+{
+    int              nFirstComp;
+    int              nEndComp;
+    std::vector<int> anForeignComp;     // sorted
+    std::vector<int> anBigNeighbour;
+};
 
+struct GPSieveContext
 {
-    CPLErr eErr;
+    GDALConnectedComponents  *poCC;
+    std::vector<GPSieveStrip> asStrips;
+    std::vector<int>          anBigNeighbour;
+};
 
-    eErr = GDALRasterIO( hMaskBand, GF_Read, 0, iY, nXSize, 1,
-                         pabyMaskLine, nXSize, 1, GDT_Byte, 0, 0 );
-    if( eErr == CE_None )
-    {
-        int i;
-        for( i = 0; i < nXSize; i++ )
-        {
-            if( pabyMaskLine[i] == 0 )
-                panImageLine[i] = GP_NODATA_MARKER;
-        }
-    }
+/************************************************************************/
+/*                             GPSieveSlot()                            */
+/************************************************************************/
 
-    return eErr;
-}
+static inline int GPSieveSlot( const GPSieveStrip &sStrip, int iComp )
+{
+    if( iComp >= sStrip.nFirstComp && iComp < sStrip.nEndComp )
+        return iComp - sStrip.nFirstComp;
 
-// TODO: What is "eaches" supposed to be?
+    return sStrip.nEndComp - sStrip.nFirstComp + static_cast<int>(
+        std::lower_bound( sStrip.anForeignComp.begin(),
+                          sStrip.anForeignComp.end(), iComp ) -
+        sStrip.anForeignComp.begin() );
+}
 
 /************************************************************************/
 /*                          CompareNeighbour()                          */
@@ -101,39 +107,126 @@ GPMaskImageData( GDALRasterBandH hMaskBand, GByte *pabyMaskLine, int iY, int nXS
 /*      smaller than our sieve threshold.                               */
 /************************************************************************/
 
-static inline void CompareNeighbour( int nPolyId1, int nPolyId2,
-                                     int *panPolyIdMap,
-                                     int * /* panPolyValue */,
-                                     std::vector<int> &anPolySizes,
-                                     std::vector<int> &anBigNeighbour )
+static inline void CompareNeighbour( int iComp1, int iComp2,
+                                     const GDALConnectedComponents *poCC,
+                                     GPSieveStrip &sStrip )
 
 {
     // nodata polygon do not need neighbours, and cannot be neighbours
     // to valid polygons.
-    if( nPolyId1 < 0 || nPolyId2 < 0 )
+    if( iComp1 < 0 || iComp2 < 0 )
         return;
 
-    // make sure we are working with the final merged polygon ids.
-    nPolyId1 = panPolyIdMap[nPolyId1];
-    nPolyId2 = panPolyIdMap[nPolyId2];
-
-    if( nPolyId1 == nPolyId2 )
+    if( iComp1 == iComp2 )
         return;
 
-    // nodata polygon do not need neighbours, and cannot be neighbours
-    // to valid polygons.
-    // should no longer happen with r28826 optimization
-    //if( panPolyValue[nPolyId1] == GP_NODATA_MARKER
-    //    || panPolyValue[nPolyId2] == GP_NODATA_MARKER )
-    //    return;
-
-    if( anBigNeighbour[nPolyId1] == -1
-        || anPolySizes[anBigNeighbour[nPolyId1]] < anPolySizes[nPolyId2] )
-        anBigNeighbour[nPolyId1] = nPolyId2;
-
-    if( anBigNeighbour[nPolyId2] == -1
-        || anPolySizes[anBigNeighbour[nPolyId2]] < anPolySizes[nPolyId1] )
-        anBigNeighbour[nPolyId2] = nPolyId1;
+    int &nBig1 = sStrip.anBigNeighbour[GPSieveSlot( sStrip, iComp1 )];
+    if( nBig1 == -1
+        || poCC->GetComponentSize(nBig1) < poCC->GetComponentSize(iComp2) )
+        nBig1 = iComp2;
+
+    int &nBig2 = sStrip.anBigNeighbour[GPSieveSlot( sStrip, iComp2 )];
+    if( nBig2 == -1
+        || poCC->GetComponentSize(nBig2) < poCC->GetComponentSize(iComp1) )
+        nBig2 = iComp1;
+}
+
+/************************************************************************/
+/*                         GPSieveNeighbourLine()                       */
+/************************************************************************/
+
+static CPLErr GPSieveNeighbourLine( void *pUserData, int iStrip, int iY,
+                                    int nXSize,
+                                    const GInt32 * /* panVal */,
+                                    const GInt32 *panComp,
+                                    const GInt32 *panLastComp,
+                                    GInt32 * /* panOutVal */ )
+{
+    GPSieveContext *psCtxt = (GPSieveContext *) pUserData;
+    const GDALConnectedComponents *poCC = psCtxt->poCC;
+    GPSieveStrip &sStrip = psCtxt->asStrips[iStrip];
+
+/* -------------------------------------------------------------------- */
+/*      On the first line of the strip, collect the components that     */
+/*      started in a previous strip.                                    */
+/* -------------------------------------------------------------------- */
+    if( iY == poCC->GetStripYOff( iStrip ) )
+    {
+        poCC->GetStripComponents( iStrip, &sStrip.nFirstComp,
+                                  &sStrip.nEndComp );
+        for( int iX = 0; iX < nXSize; iX++ )
+        {
+            if( panComp[iX] >= 0 && panComp[iX] < sStrip.nFirstComp )
+                sStrip.anForeignComp.push_back( panComp[iX] );
+            if( panLastComp != NULL && panLastComp[iX] >= 0 )
+                sStrip.anForeignComp.push_back( panLastComp[iX] );
+        }
+        std::sort( sStrip.anForeignComp.begin(), sStrip.anForeignComp.end() );
+        sStrip.anForeignComp.erase(
+            std::unique( sStrip.anForeignComp.begin(),
+                         sStrip.anForeignComp.end() ),
+            sStrip.anForeignComp.end() );
+
+        sStrip.anBigNeighbour.resize(
+            sStrip.nEndComp - sStrip.nFirstComp +
+            sStrip.anForeignComp.size(), -1 );
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Check our neighbours, and update our biggest neighbour map      */
+/*      as appropriate.                                                 */
+/* -------------------------------------------------------------------- */
+    const bool b8Connected = poCC->GetConnectedness() == 8;
+    for( int iX = 0; iX < nXSize; iX++ )
+    {
+        if( panLastComp != NULL )
+        {
+            CompareNeighbour( panComp[iX], panLastComp[iX], poCC, sStrip );
+
+            if( iX > 0 && b8Connected )
+                CompareNeighbour( panComp[iX], panLastComp[iX-1],
+                                  poCC, sStrip );
+
+            if( iX < nXSize-1 && b8Connected )
+                CompareNeighbour( panComp[iX], panLastComp[iX+1],
+                                  poCC, sStrip );
+        }
+
+        if( iX > 0 )
+            CompareNeighbour( panComp[iX], panComp[iX-1], poCC, sStrip );
+
+        // We don't need to compare to next pixel or next line
+        // since they will be compared to us.
+    }
+
+    return CE_None;
+}
+
+/************************************************************************/
+/*                           GPSieveWriteLine()                         */
+/************************************************************************/
+
+static CPLErr GPSieveWriteLine( void *pUserData, int /* iStrip */,
+                                int /* iY */, int nXSize,
+                                const GInt32 * /* panVal */,
+                                const GInt32 *panComp,
+                                const GInt32 * /* panLastComp */,
+                                GInt32 *panOutVal )
+{
+    const GPSieveContext *psCtxt = (const GPSieveContext *) pUserData;
+
+    for( int iX = 0; iX < nXSize; iX++ )
+    {
+        const int iComp = panComp[iX];
+        if( iComp >= 0 && psCtxt->anBigNeighbour[iComp] != -1 )
+        {
+            panOutVal[iX] =
+                psCtxt->poCC->GetComponentValue(
+                    psCtxt->anBigNeighbour[iComp] );
+        }
+    }
+
+    return CE_None;
 }
 
 /************************************************************************/
@@ -160,7 +253,10 @@ static inline void CompareNeighbour( int nPolyId1, int nPolyId2,
  * will therefore not be altered.
  *
  * The algorithm makes three passes over the input file to enumerate the
- * polygons and collect limited information about them.  Memory use is
+ * polygons and collect limited information about them.  The raster is
+ * processed by strips of lines, that can be handled by several threads
+ * (see GDALLabelConnectedComponents()).  The result does not depend on the
+ * number of threads nor on the strip height.  Memory use is
  * proportional to the number of polygons (roughly 24 bytes per polygon), but
  * is not directly related to the size of the raster.  So very large raster
  * files can be processed effectively if there aren't too many polygons.  But
@@ -177,8 +273,14 @@ static inline void CompareNeighbour( int nPolyId1, int nPolyId2,
  * @param nConnectedness either 4 indicating that diagonal pixels are not
  * considered directly adjacent for polygon membership purposes or 8
  * indicating they are.
- * @param papszOptions algorithm options in name=value list form.  None currently
- * supported.
+ * @param papszOptions algorithm options in name=value list form.
+ * <ul>
+ * <li>NUM_THREADS=number or ALL_CPUS: (GDAL &gt;= 2.2) number of worker
+ * threads. Defaults to 1.</li>
+ * <li>TILE_HEIGHT=number: (GDAL &gt;= 2.2) height in lines of the strips.
+ * Defaults to the raster height divided by the number of threads, with a
+ * maximum of 1024.</li>
+ * </ul>
  * @param pfnProgress callback for reporting algorithm progress matching the
  * GDALProgressFunc() semantics.  May be NULL.
  * @param pProgressArg callback argument passed to pfnProgress.
@@ -190,7 +292,7 @@ CPLErr CPL_STDCALL
 GDALSieveFilter( GDALRasterBandH hSrcBand, GDALRasterBandH hMaskBand,
                  GDALRasterBandH hDstBand,
                  int nSizeThreshold, int nConnectedness,
-                 CPL_UNUSED char **papszOptions,
+                 char **papszOptions,
                  GDALProgressFunc pfnProgress,
                  void * pProgressArg )
 {
@@ -201,228 +303,71 @@ GDALSieveFilter( GDALRasterBandH hSrcBand, GDALRasterBandH hMaskBand,
         pfnProgress = GDALDummyProgress;
 
 /* -------------------------------------------------------------------- */
-/*      Allocate working buffers.                                       */
-/* -------------------------------------------------------------------- */
-    CPLErr eErr = CE_None;
-    int nXSize = GDALGetRasterBandXSize( hSrcBand );
-    int nYSize = GDALGetRasterBandYSize( hSrcBand );
-    GInt32 *panLastLineVal = (GInt32 *) VSI_MALLOC2_VERBOSE(sizeof(GInt32), nXSize);
-    GInt32 *panThisLineVal = (GInt32 *) VSI_MALLOC2_VERBOSE(sizeof(GInt32), nXSize);
-    GInt32 *panLastLineId =  (GInt32 *) VSI_MALLOC2_VERBOSE(sizeof(GInt32), nXSize);
-    GInt32 *panThisLineId =  (GInt32 *) VSI_MALLOC2_VERBOSE(sizeof(GInt32), nXSize);
-    GInt32 *panThisLineWriteVal = (GInt32 *) VSI_MALLOC2_VERBOSE(sizeof(GInt32), nXSize);
-    GByte *pabyMaskLine = (hMaskBand != NULL) ? (GByte *) VSI_MALLOC_VERBOSE(nXSize) : NULL;
-    if (panLastLineVal == NULL || panThisLineVal == NULL ||
-        panLastLineId == NULL || panThisLineId == NULL ||
-        panThisLineWriteVal == NULL ||
-        (hMaskBand != NULL && pabyMaskLine == NULL))
-    {
-        CPLFree( panThisLineId );
-        CPLFree( panLastLineId );
-        CPLFree( panThisLineVal );
-        CPLFree( panLastLineVal );
-        CPLFree( panThisLineWriteVal );
-        CPLFree( pabyMaskLine );
-        return CE_Failure;
-    }
-
-/* -------------------------------------------------------------------- */
-/*      The first pass over the raster is only used to build up the     */
-/*      polygon id map so we will know in advance what polygons are     */
-/*      what on the second pass.                                        */
-/* -------------------------------------------------------------------- */
-    int iY, iX, iPoly;
-    GDALRasterPolygonEnumerator oFirstEnum( nConnectedness );
-    std::vector<int> anPolySizes;
-
-    for( iY = 0; eErr == CE_None && iY < nYSize; iY++ )
-    {
-        eErr = GDALRasterIO(
-            hSrcBand,
-            GF_Read, 0, iY, nXSize, 1,
-            panThisLineVal, nXSize, 1, GDT_Int32, 0, 0 );
-
-        if( eErr == CE_None && hMaskBand != NULL )
-            eErr = GPMaskImageData( hMaskBand, pabyMaskLine, iY, nXSize, panThisLineVal );
-
-        if( iY == 0 )
-            oFirstEnum.ProcessLine(
-                NULL, panThisLineVal, NULL, panThisLineId, nXSize );
-        else
-            oFirstEnum.ProcessLine(
-                panLastLineVal, panThisLineVal,
-                panLastLineId,  panThisLineId,
-                nXSize );
-
-/* -------------------------------------------------------------------- */
-/*      Accumulate polygon sizes.                                       */
-/* -------------------------------------------------------------------- */
-        if( oFirstEnum.nNextPolygonId > (int) anPolySizes.size() )
-            anPolySizes.resize( oFirstEnum.nNextPolygonId );
-
-        for( iX = 0; iX < nXSize; iX++ )
-        {
-            iPoly = panThisLineId[iX];
-
-            if( iPoly >= 0 && anPolySizes[iPoly] < MY_MAX_INT )
-                anPolySizes[iPoly] += 1;
-        }
-
-/* -------------------------------------------------------------------- */
-/*      swap this/last lines.                                           */
-/* -------------------------------------------------------------------- */
-        GInt32 *panTmp = panLastLineVal;
-        panLastLineVal = panThisLineVal;
-        panThisLineVal = panTmp;
-
-        panTmp = panThisLineId;
-        panThisLineId = panLastLineId;
-        panLastLineId = panTmp;
-
-/* -------------------------------------------------------------------- */
-/*      Report progress, and support interrupts.                        */
-/* -------------------------------------------------------------------- */
-        if( eErr == CE_None
-            && !pfnProgress( 0.25 * ((iY+1) / (double) nYSize),
-                             "", pProgressArg ) )
-        {
-            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
-            eErr = CE_Failure;
-        }
-    }
-
-/* -------------------------------------------------------------------- */
-/*      Make a pass through the maps, ensuring every polygon id         */
-/*      points to the final id it should use, not an intermediate       */
-/*      value.                                                          */
-/* -------------------------------------------------------------------- */
-    oFirstEnum.CompleteMerges();
-
-/* -------------------------------------------------------------------- */
-/*      Push the sizes of merged polygon fragments into the             */
-/*      merged polygon id's count.                                      */
-/* -------------------------------------------------------------------- */
-    for( iPoly = 0; iPoly < oFirstEnum.nNextPolygonId; iPoly++ )
-    {
-        if( oFirstEnum.panPolyIdMap[iPoly] != iPoly )
-        {
-            GIntBig nSize = anPolySizes[oFirstEnum.panPolyIdMap[iPoly]];
-
-            nSize += anPolySizes[iPoly];
-
-            if( nSize > MY_MAX_INT )
-                nSize = MY_MAX_INT;
-
-            anPolySizes[oFirstEnum.panPolyIdMap[iPoly]] = (int)nSize;
-            anPolySizes[iPoly] = 0;
-        }
-    }
-
-/* -------------------------------------------------------------------- */
-/*      We will use a new enumerator for the second pass primarily      */
-/*      so we can preserve the first pass map.                          */
+/*      The first pass over the raster is only used to label the        */
+/*      polygons, so we will know in advance what polygons are what     */
+/*      on the second pass.                                             */
 /* -------------------------------------------------------------------- */
-    GDALRasterPolygonEnumerator oSecondEnum( nConnectedness );
+    GDALConnectedComponents oCC( hSrcBand, hMaskBand, nConnectedness,
+                                 papszOptions );
 
-    std::vector<int> anBigNeighbour;
-    anBigNeighbour.resize( anPolySizes.size() );
+    void *pScaledProgress =
+        GDALCreateScaledProgress( 0.0, 0.25, pfnProgress, pProgressArg );
+    CPLErr eErr = oCC.Label( GDALScaledProgress, pScaledProgress );
+    GDALDestroyScaledProgress( pScaledProgress );
 
-    for( iPoly = 0; iPoly < (int) anPolySizes.size(); iPoly++ )
-        anBigNeighbour[iPoly] = -1;
+    if( eErr != CE_None )
+        return eErr;
 
 /* ==================================================================== */
 /*      Second pass ... identify the largest neighbour for each         */
 /*      polygon.                                                        */
 /* ==================================================================== */
-    for( iY = 0; eErr == CE_None && iY < nYSize; iY++ )
-    {
-/* -------------------------------------------------------------------- */
-/*      Read the image data.                                            */
-/* -------------------------------------------------------------------- */
-        eErr = GDALRasterIO( hSrcBand, GF_Read, 0, iY, nXSize, 1,
-                             panThisLineVal, nXSize, 1, GDT_Int32, 0, 0 );
-
-        if( eErr == CE_None && hMaskBand != NULL )
-            eErr = GPMaskImageData( hMaskBand, pabyMaskLine, iY, nXSize, panThisLineVal );
-
-        if( eErr != CE_None )
-            continue;
-
-/* -------------------------------------------------------------------- */
-/*      Determine what polygon the various pixels belong to (redoing    */
-/*      the same thing done in the first pass above).                   */
-/* -------------------------------------------------------------------- */
-        if( iY == 0 )
-            oSecondEnum.ProcessLine(
-                NULL, panThisLineVal, NULL, panThisLineId, nXSize );
-        else
-            oSecondEnum.ProcessLine(
-                panLastLineVal, panThisLineVal,
-                panLastLineId,  panThisLineId,
-                nXSize );
-
-/* -------------------------------------------------------------------- */
-/*      Check our neighbours, and update our biggest neighbour map      */
-/*      as appropriate.                                                 */
-/* -------------------------------------------------------------------- */
-        for( iX = 0; iX < nXSize; iX++ )
-        {
-            if( iY > 0 )
-            {
-                CompareNeighbour( panThisLineId[iX],
-                                  panLastLineId[iX],
-                                  oFirstEnum.panPolyIdMap,
-                                  oFirstEnum.panPolyValue,
-                                  anPolySizes, anBigNeighbour );
-
-                if( iX > 0 && nConnectedness == 8 )
-                    CompareNeighbour( panThisLineId[iX],
-                                      panLastLineId[iX-1],
-                                      oFirstEnum.panPolyIdMap,
-                                      oFirstEnum.panPolyValue,
-                                      anPolySizes, anBigNeighbour );
-
-                if( iX < nXSize-1 && nConnectedness == 8 )
-                    CompareNeighbour( panThisLineId[iX],
-                                      panLastLineId[iX+1],
-                                      oFirstEnum.panPolyIdMap,
-                                      oFirstEnum.panPolyValue,
-                                      anPolySizes, anBigNeighbour );
-            }
+    GPSieveContext sCtxt;
+    sCtxt.poCC = &oCC;
+    sCtxt.asStrips.resize( oCC.GetStripCount() );
 
-            if( iX > 0 )
-                CompareNeighbour( panThisLineId[iX],
-                                  panThisLineId[iX-1],
-                                  oFirstEnum.panPolyIdMap,
-                                  oFirstEnum.panPolyValue,
-                                  anPolySizes, anBigNeighbour );
+    pScaledProgress =
+        GDALCreateScaledProgress( 0.25, 0.5, pfnProgress, pProgressArg );
+    eErr = oCC.ProcessLines( GPSieveNeighbourLine, &sCtxt, NULL,
+                             GDALScaledProgress, pScaledProgress );
+    GDALDestroyScaledProgress( pScaledProgress );
 
-            // We don't need to compare to next pixel or next line
-            // since they will be compared to us.
-        }
+    if( eErr != CE_None )
+        return eErr;
 
 /* -------------------------------------------------------------------- */
-/*      Swap pixel value, and polygon id lines to be ready for the      */
-/*      next line.                                                      */
+/*      Merge the largest neighbours of the strips.  Taking them in     */
+/*      strip order and only replacing by strictly larger ones gives    */
+/*      the same result as a single pass over the raster.               */
 /* -------------------------------------------------------------------- */
-        GInt32 *panTmp = panLastLineVal;
-        panLastLineVal = panThisLineVal;
-        panThisLineVal = panTmp;
+    const int nCompCount = oCC.GetComponentCount();
+    std::vector<int> &anBigNeighbour = sCtxt.anBigNeighbour;
+    anBigNeighbour.resize( nCompCount, -1 );
 
-        panTmp = panThisLineId;
-        panThisLineId = panLastLineId;
-        panLastLineId = panTmp;
+    for( size_t iStrip = 0; iStrip < sCtxt.asStrips.size(); iStrip++ )
+    {
+        GPSieveStrip &sStrip = sCtxt.asStrips[iStrip];
+        const int nOwn = sStrip.nEndComp - sStrip.nFirstComp;
 
-/* -------------------------------------------------------------------- */
-/*      Report progress, and support interrupts.                        */
-/* -------------------------------------------------------------------- */
-        if( eErr == CE_None
-            && !pfnProgress( 0.25 + 0.25 * ((iY+1) / (double) nYSize),
-                             "", pProgressArg ) )
+        for( int iSlot = 0; iSlot < (int) sStrip.anBigNeighbour.size();
+             iSlot++ )
         {
-            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
-            eErr = CE_Failure;
+            const int iNeighbour = sStrip.anBigNeighbour[iSlot];
+            if( iNeighbour == -1 )
+                continue;
+
+            const int iComp = (iSlot < nOwn) ?
+                sStrip.nFirstComp + iSlot :
+                sStrip.anForeignComp[iSlot - nOwn];
+
+            if( anBigNeighbour[iComp] == -1
+                || oCC.GetComponentSize(anBigNeighbour[iComp])
+                   < oCC.GetComponentSize(iNeighbour) )
+                anBigNeighbour[iComp] = iNeighbour;
         }
+
+        std::vector<int>().swap( sStrip.anForeignComp );
+        std::vector<int>().swap( sStrip.anBigNeighbour );
     }
 
 /* -------------------------------------------------------------------- */
@@ -434,17 +379,10 @@ GDALSieveFilter( GDALRasterBandH hSrcBand, GDALRasterBandH hMaskBand,
     int nIsolatedSmall = 0;
     int nSieveTargets = 0;
 
-    for( iPoly = 0; iPoly < (int) anPolySizes.size(); iPoly++ )
+    for( int iPoly = 0; iPoly < nCompCount; iPoly++ )
     {
-        if( oFirstEnum.panPolyIdMap[iPoly] != iPoly )
-            continue;
-
-        // Ignore nodata polygons.
-        if( oFirstEnum.panPolyValue[iPoly] == GP_NODATA_MARKER )
-            continue;
-
         // Don't try to merge polygons larger than the threshold.
-        if( anPolySizes[iPoly] >= nSizeThreshold )
+        if( oCC.GetComponentSize(iPoly) >= nSizeThreshold )
         {
             anBigNeighbour[iPoly] = -1;
             continue;
@@ -474,7 +412,7 @@ GDALSieveFilter( GDALRasterBandH hSrcBand, GDALRasterBandH hMaskBand,
             }
             // If the biggest neighbour is larger than the threshold
             // then we are golden.
-            if( anPolySizes[iFinalId] >= nSizeThreshold )
+            if( oCC.GetComponentSize(iFinalId) >= nSizeThreshold )
             {
                 bFoundBigEnoughPoly = true;
                 break;
@@ -508,99 +446,13 @@ GDALSieveFilter( GDALRasterBandH hSrcBand, GDALRasterBandH hMaskBand,
 
 /* ==================================================================== */
 /*      Make a third pass over the image, actually applying the         */
-/*      merges.  We reuse the second enumerator but preserve the        */
-/*      "final maps" from the first.                                    */
+/*      merges.                                                         */
 /* ==================================================================== */
-    oSecondEnum.Clear();
-
-    for( iY = 0; eErr == CE_None && iY < nYSize; iY++ )
-    {
-/* -------------------------------------------------------------------- */
-/*      Read the image data.                                            */
-/* -------------------------------------------------------------------- */
-        eErr = GDALRasterIO( hSrcBand, GF_Read, 0, iY, nXSize, 1,
-                             panThisLineVal, nXSize, 1, GDT_Int32, 0, 0 );
-
-        memcpy( panThisLineWriteVal, panThisLineVal, 4 * nXSize );
-
-        if( eErr == CE_None && hMaskBand != NULL )
-            eErr = GPMaskImageData( hMaskBand, pabyMaskLine, iY, nXSize, panThisLineVal );
-
-        if( eErr != CE_None )
-            continue;
-
-/* -------------------------------------------------------------------- */
-/*      Determine what polygon the various pixels belong to (redoing    */
-/*      the same thing done in the first pass above).                   */
-/* -------------------------------------------------------------------- */
-        if( iY == 0 )
-            oSecondEnum.ProcessLine(
-                NULL, panThisLineVal, NULL, panThisLineId, nXSize );
-        else
-            oSecondEnum.ProcessLine(
-                panLastLineVal, panThisLineVal,
-                panLastLineId,  panThisLineId,
-                nXSize );
-
-/* -------------------------------------------------------------------- */
-/*      Reprocess the actual pixel values according to the polygon      */
-/*      merging, and write out this line of image data.                 */
-/* -------------------------------------------------------------------- */
-        for( iX = 0; iX < nXSize; iX++ )
-        {
-            int iThisPoly = panThisLineId[iX];
-            if( iThisPoly >= 0 )
-            {
-                iThisPoly = oFirstEnum.panPolyIdMap[iThisPoly];
-
-                if( anBigNeighbour[iThisPoly] != -1 )
-                {
-                    panThisLineWriteVal[iX] =
-                        oFirstEnum.panPolyValue[
-                            anBigNeighbour[iThisPoly]];
-                }
-            }
-        }
-
-/* -------------------------------------------------------------------- */
-/*      Write the update data out.                                      */
-/* -------------------------------------------------------------------- */
-        eErr = GDALRasterIO( hDstBand, GF_Write, 0, iY, nXSize, 1,
-                             panThisLineWriteVal, nXSize, 1, GDT_Int32, 0, 0 );
-
-/* -------------------------------------------------------------------- */
-/*      Swap pixel value, and polygon id lines to be ready for the      */
-/*      next line.                                                      */
-/* -------------------------------------------------------------------- */
-        GInt32 *panTmp = panLastLineVal;
-        panLastLineVal = panThisLineVal;
-        panThisLineVal = panTmp;
-
-        panTmp = panThisLineId;
-        panThisLineId = panLastLineId;
-        panLastLineId = panTmp;
-
-/* -------------------------------------------------------------------- */
-/*      Report progress, and support interrupts.                        */
-/* -------------------------------------------------------------------- */
-        if( eErr == CE_None
-            && !pfnProgress( 0.5 + 0.5 * ((iY+1) / (double) nYSize),
-                             "", pProgressArg ) )
-        {
-            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
-            eErr = CE_Failure;
-        }
-    }
-
-/* -------------------------------------------------------------------- */
-/*      Cleanup                                                         */
-/* -------------------------------------------------------------------- */
-    CPLFree( panThisLineId );
-    CPLFree( panLastLineId );
-    CPLFree( panThisLineVal );
-    CPLFree( panLastLineVal );
-    CPLFree( panThisLineWriteVal );
-    CPLFree( pabyMaskLine );
+    pScaledProgress =
+        GDALCreateScaledProgress( 0.5, 1.0, pfnProgress, pProgressArg );
+    eErr = oCC.ProcessLines( GPSieveWriteLine, &sCtxt, hDstBand,
+                             GDALScaledProgress, pScaledProgress );
+    GDALDestroyScaledProgress( pScaledProgress );
 
     return eErr;
 }
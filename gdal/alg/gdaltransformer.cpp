@@ -44,6 +44,7 @@ void *GDALDeserializeGCPTransformer( CPLXMLNode *psTree );
 void *GDALDeserializeTPSTransformer( CPLXMLNode *psTree );
 void *GDALDeserializeGeoLocTransformer( CPLXMLNode *psTree );
 void *GDALDeserializeRPCTransformer( CPLXMLNode *psTree );
+void *GDALDeserializeTransformGridTransformer( CPLXMLNode *psTree );
 CPL_C_END
 
 static CPLXMLNode *GDALSerializeReprojectionTransformer( void *pTransformArg );
@@ -2641,6 +2642,33 @@ void GDALApproxTransformerOwnsSubtransformer( void *pCBData, int bOwnFlag )
     psATInfo->bOwnSubtransformer = bOwnFlag;
 }
 
+/************************************************************************/
+/*                    GDALGetApproxTransformerInfo()                    */
+/************************************************************************/
+
+/* Return the base transformer and error threshold of an approximate */
+/* transformer, or FALSE if pApproxArg is not an approximate transformer. */
+
+int GDALGetApproxTransformerInfo( void *pApproxArg,
+                                  GDALTransformerFunc *ppfnBaseTransformer,
+                                  void **ppBaseTransformerArg,
+                                  double *pdfMaxError )
+
+{
+    GDALTransformerInfo *psInfo = (GDALTransformerInfo *) pApproxArg;
+    if( psInfo == NULL ||
+        memcmp(psInfo->abySignature, GDAL_GTI2_SIGNATURE,
+               strlen(GDAL_GTI2_SIGNATURE)) != 0 ||
+        !EQUAL(psInfo->pszClassName, "GDALApproxTransformer") )
+        return FALSE;
+
+    ApproxTransformInfo *psATInfo = (ApproxTransformInfo *) pApproxArg;
+    *ppfnBaseTransformer = psATInfo->pfnBaseTransformer;
+    *ppBaseTransformerArg = psATInfo->pBaseCBData;
+    *pdfMaxError = psATInfo->dfMaxError;
+    return TRUE;
+}
+
 /************************************************************************/
 /*                    GDALDestroyApproxTransformer()                    */
 /************************************************************************/
@@ -3290,6 +3318,11 @@ CPLErr GDALDeserializeTransformer( CPLXMLNode *psTree,
         *ppfnFunc = GDALApproxTransform;
         *ppTransformArg = GDALDeserializeApproxTransformer( psTree );
     }
+    else if( EQUAL(psTree->pszValue,"TransformGridTransformer") )
+    {
+        *ppfnFunc = GDALTransformGridTransform;
+        *ppTransformArg = GDALDeserializeTransformGridTransformer( psTree );
+    }
     else
     {
         GDALTransformDeserializeFunc pfnDeserializeFunc = NULL;
@@ -0,0 +1,1084 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  GDAL
+ * Purpose:  Transformer interpolating a cached grid of transformed points.
+ *
+ ******************************************************************************
+ * Copyright (c) 2016, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "gdal_alg.h"
+#include "gdal_alg_priv.h"
+#include "cpl_multiproc.h"
+#include "cpl_string.h"
+#include "cpl_vsi.h"
+
+#include <algorithm>
+#include <vector>
+
+CPL_CVSID("$Id$");
+
+CPL_C_START
+CPLXMLNode *GDALSerializeTransformGridTransformer( void *pTransformArg );
+void *GDALDeserializeTransformGridTransformer( CPLXMLNode *psTree );
+CPL_C_END
+
+/* Number of cells, in each dimension, computed at once. */
+#define TG_BLOCK_CELLS          16
+
+#define TG_FILE_SIGNATURE       "GDALTGRD"
+#define TG_FILE_VERSION         1
+
+/* Node states */
+#define TG_NODE_UNKNOWN         0
+#define TG_NODE_OK              1
+#define TG_NODE_FAILED          2
+
+/* Block states */
+#define TG_BLOCK_TODO           0
+#define TG_BLOCK_DONE           1
+#define TG_BLOCK_BUSY           2
+
+/************************************************************************/
+/* ==================================================================== */
+/*                          GDALTransformGrid                           */
+/* ==================================================================== */
+/************************************************************************/
+
+/* The grid itself, shared by a transformer and all its clones. */
+
+typedef struct
+{
+    int          nRefCount;
+    CPLMutex    *hMutex;
+    CPLCond     *hCond;     /* signaled when blocks are published */
+
+    int          nDstXSize;
+    int          nDstYSize;
+    int          nStep;
+    double       dfMaxError;
+
+    int          nCellsX;
+    int          nCellsY;
+    int          nBlocksX;
+    int          nBlocksY;
+
+    /* (nCellsX+1) * (nCellsY+1) nodes */
+    double      *padfX;
+    double      *padfY;
+    double      *padfZ;
+    GByte       *pabyNodeState;
+
+    /* nCellsX * nCellsY cells: TRUE if bilinear interpolation is accurate */
+    GByte       *pabyCellOK;
+
+    /* nBlocksX * nBlocksY blocks: TG_BLOCK_xxx */
+    GByte       *pabyBlockDone;
+    int          nBlocksComputed;
+
+    char        *pszCacheFile;
+    char        *pszSignature;
+} GDALTransformGrid;
+
+typedef struct
+{
+    GDALTransformerInfo sTI;
+
+    GDALTransformerFunc pfnBaseTransformer;
+    void               *pBaseCBData;
+    int                 bOwnSubtransformer;
+
+    GDALTransformGrid  *psGrid;
+} TransformGridInfo;
+
+/************************************************************************/
+/*                          GDALTGNodeCoord()                           */
+/************************************************************************/
+
+static CPL_INLINE double GDALTGNodeCoord( int iNode, int nStep, int nSize )
+{
+    GIntBig nCoord = static_cast<GIntBig>(iNode) * nStep;
+    return static_cast<double>( nCoord > nSize ? nSize : nCoord );
+}
+
+/************************************************************************/
+/*                         GDALTGBlockPoints                            */
+/************************************************************************/
+
+/* Points of a block transformed by the base transformer: the nodes, */
+/* line by line, then the 5 check points of each cell. */
+
+struct GDALTGBlockPoints
+{
+    int                 iBlockX;
+    int                 iBlockY;
+    std::vector<double> adfX;
+    std::vector<double> adfY;
+    std::vector<double> adfZ;
+    std::vector<int>    anSuccess;
+};
+
+/************************************************************************/
+/*                        GDALTGTransformBlock()                        */
+/*                                                                      */
+/*      Transform the nodes of a block of cells, as well as the         */
+/*      center and the edge middles of each cell. Only reads the        */
+/*      immutable members of the grid, so it is called without the      */
+/*      grid mutex.                                                     */
+/************************************************************************/
+
+static void GDALTGTransformBlock( TransformGridInfo* psInfo,
+                                  GDALTGBlockPoints* psPoints )
+{
+    const GDALTransformGrid* psGrid = psInfo->psGrid;
+    const int nCellX0 = psPoints->iBlockX * TG_BLOCK_CELLS;
+    const int nCellY0 = psPoints->iBlockY * TG_BLOCK_CELLS;
+    const int nCellX1 = MIN(nCellX0 + TG_BLOCK_CELLS, psGrid->nCellsX);
+    const int nCellY1 = MIN(nCellY0 + TG_BLOCK_CELLS, psGrid->nCellsY);
+
+    std::vector<double>& adfX = psPoints->adfX;
+    std::vector<double>& adfY = psPoints->adfY;
+    std::vector<double>& adfZ = psPoints->adfZ;
+
+    for( int iY = nCellY0; iY <= nCellY1; iY++ )
+    {
+        for( int iX = nCellX0; iX <= nCellX1; iX++ )
+        {
+            adfX.push_back(GDALTGNodeCoord(iX, psGrid->nStep,
+                                           psGrid->nDstXSize));
+            adfY.push_back(GDALTGNodeCoord(iY, psGrid->nStep,
+                                           psGrid->nDstYSize));
+            adfZ.push_back(0.0);
+        }
+    }
+
+    for( int iY = nCellY0; iY < nCellY1; iY++ )
+    {
+        const double dfY0 = GDALTGNodeCoord(iY, psGrid->nStep,
+                                            psGrid->nDstYSize);
+        const double dfY1 = GDALTGNodeCoord(iY + 1, psGrid->nStep,
+                                            psGrid->nDstYSize);
+        const double dfYM = (dfY0 + dfY1) / 2;
+        for( int iX = nCellX0; iX < nCellX1; iX++ )
+        {
+            const double dfX0 = GDALTGNodeCoord(iX, psGrid->nStep,
+                                                psGrid->nDstXSize);
+            const double dfX1 = GDALTGNodeCoord(iX + 1, psGrid->nStep,
+                                                psGrid->nDstXSize);
+            const double dfXM = (dfX0 + dfX1) / 2;
+            const double adfCheckX[5] = { dfXM, dfXM, dfXM, dfX0, dfX1 };
+            const double adfCheckY[5] = { dfYM, dfY0, dfY1, dfYM, dfYM };
+            for( int i = 0; i < 5; i++ )
+            {
+                adfX.push_back(adfCheckX[i]);
+                adfY.push_back(adfCheckY[i]);
+                adfZ.push_back(0.0);
+            }
+        }
+    }
+
+    psPoints->anSuccess.resize(adfX.size(), FALSE);
+    if( !psInfo->pfnBaseTransformer( psInfo->pBaseCBData, TRUE,
+                                     static_cast<int>(adfX.size()),
+                                     &adfX[0], &adfY[0], &adfZ[0],
+                                     &psPoints->anSuccess[0] ) )
+    {
+        std::fill(psPoints->anSuccess.begin(), psPoints->anSuccess.end(),
+                  FALSE);
+    }
+}
+
+/************************************************************************/
+/*                         GDALTGPublishBlock()                         */
+/*                                                                      */
+/*      Store the transformed nodes that are not yet known (the ones    */
+/*      on the block borders may have been published by a              */
+/*      neighbouring block), and flag the cells where bilinear          */
+/*      interpolation of the nodes is within the error threshold.       */
+/*      Must be called with the grid mutex held.                        */
+/************************************************************************/
+
+static void GDALTGPublishBlock( GDALTransformGrid* psGrid,
+                                const GDALTGBlockPoints* psPoints )
+{
+    const int nCellX0 = psPoints->iBlockX * TG_BLOCK_CELLS;
+    const int nCellY0 = psPoints->iBlockY * TG_BLOCK_CELLS;
+    const int nCellX1 = MIN(nCellX0 + TG_BLOCK_CELLS, psGrid->nCellsX);
+    const int nCellY1 = MIN(nCellY0 + TG_BLOCK_CELLS, psGrid->nCellsY);
+    const int nNodesPerLine = psGrid->nCellsX + 1;
+    const std::vector<double>& adfX = psPoints->adfX;
+    const std::vector<double>& adfY = psPoints->adfY;
+    const std::vector<int>& anSuccess = psPoints->anSuccess;
+
+    size_t iPoint = 0;
+    for( int iY = nCellY0; iY <= nCellY1; iY++ )
+    {
+        for( int iX = nCellX0; iX <= nCellX1; iX++, iPoint++ )
+        {
+            const int iNode = iY * nNodesPerLine + iX;
+            if( psGrid->pabyNodeState[iNode] != TG_NODE_UNKNOWN )
+                continue;
+            psGrid->padfX[iNode] = adfX[iPoint];
+            psGrid->padfY[iNode] = adfY[iPoint];
+            psGrid->padfZ[iNode] = psPoints->adfZ[iPoint];
+            psGrid->pabyNodeState[iNode] = static_cast<GByte>(
+                anSuccess[iPoint] ? TG_NODE_OK : TG_NODE_FAILED );
+        }
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Compare the check points with the interpolated values.          */
+/* -------------------------------------------------------------------- */
+    size_t iCheck = iPoint;
+    for( int iY = nCellY0; iY < nCellY1; iY++ )
+    {
+        for( int iX = nCellX0; iX < nCellX1; iX++, iCheck += 5 )
+        {
+            const int i00 = iY * nNodesPerLine + iX;
+            const int i10 = i00 + 1;
+            const int i01 = i00 + nNodesPerLine;
+            const int i11 = i01 + 1;
+            bool bOK = psGrid->pabyNodeState[i00] == TG_NODE_OK &&
+                       psGrid->pabyNodeState[i10] == TG_NODE_OK &&
+                       psGrid->pabyNodeState[i01] == TG_NODE_OK &&
+                       psGrid->pabyNodeState[i11] == TG_NODE_OK;
+            for( int i = 0; bOK && i < 5; i++ )
+                bOK = anSuccess[iCheck + i] != FALSE;
+
+            if( bOK )
+            {
+                const double* padfGX = psGrid->padfX;
+                const double* padfGY = psGrid->padfY;
+                /* center, top, bottom, left, right */
+                const double adfInterpX[5] = {
+                    (padfGX[i00] + padfGX[i10] + padfGX[i01] + padfGX[i11]) / 4,
+                    (padfGX[i00] + padfGX[i10]) / 2,
+                    (padfGX[i01] + padfGX[i11]) / 2,
+                    (padfGX[i00] + padfGX[i01]) / 2,
+                    (padfGX[i10] + padfGX[i11]) / 2 };
+                const double adfInterpY[5] = {
+                    (padfGY[i00] + padfGY[i10] + padfGY[i01] + padfGY[i11]) / 4,
+                    (padfGY[i00] + padfGY[i10]) / 2,
+                    (padfGY[i01] + padfGY[i11]) / 2,
+                    (padfGY[i00] + padfGY[i01]) / 2,
+                    (padfGY[i10] + padfGY[i11]) / 2 };
+                for( int i = 0; bOK && i < 5; i++ )
+                {
+                    const double dfError =
+                        fabs(adfInterpX[i] - adfX[iCheck + i]) +
+                        fabs(adfInterpY[i] - adfY[iCheck + i]);
+                    /* Negated test so that NaN are rejected too. */
+                    if( !(dfError <= psGrid->dfMaxError) )
+                        bOK = false;
+                }
+            }
+
+            psGrid->pabyCellOK[iY * psGrid->nCellsX + iX] =
+                static_cast<GByte>(bOK ? TRUE : FALSE);
+        }
+    }
+
+    psGrid->pabyBlockDone[psPoints->iBlockY * psGrid->nBlocksX +
+                          psPoints->iBlockX] = TG_BLOCK_DONE;
+    psGrid->nBlocksComputed ++;
+}
+
+/************************************************************************/
+/*                       GDALTGWrite/ReadValues()                       */
+/*                                                                      */
+/*      Cache files are little endian.                                  */
+/************************************************************************/
+
+static bool GDALTGWriteDoubles( VSILFILE* fp, const double* padf, size_t n )
+{
+#ifdef CPL_MSB
+    double adfBuf[1024];
+    for( size_t i = 0; i < n; i += 1024 )
+    {
+        const size_t nThis = MIN(n - i, 1024);
+        memcpy( adfBuf, padf + i, nThis * sizeof(double) );
+        for( size_t j = 0; j < nThis; j++ )
+            CPL_LSBPTR64( adfBuf + j );
+        if( VSIFWriteL( adfBuf, sizeof(double), nThis, fp ) != nThis )
+            return false;
+    }
+    return true;
+#else
+    return VSIFWriteL( padf, sizeof(double), n, fp ) == n;
+#endif
+}
+
+static bool GDALTGReadDoubles( VSILFILE* fp, double* padf, size_t n )
+{
+    if( VSIFReadL( padf, sizeof(double), n, fp ) != n )
+        return false;
+#ifdef CPL_MSB
+    for( size_t i = 0; i < n; i++ )
+        CPL_LSBPTR64( padf + i );
+#endif
+    return true;
+}
+
+static bool GDALTGWriteInt( VSILFILE* fp, GInt32 nVal )
+{
+    CPL_LSBPTR32( &nVal );
+    return VSIFWriteL( &nVal, sizeof(nVal), 1, fp ) == 1;
+}
+
+static bool GDALTGReadInt( VSILFILE* fp, GInt32* pnVal )
+{
+    if( VSIFReadL( pnVal, sizeof(GInt32), 1, fp ) != 1 )
+        return false;
+    CPL_LSBPTR32( pnVal );
+    return true;
+}
+
+/************************************************************************/
+/*                          GDALTGSaveCache()                           */
+/************************************************************************/
+
+static void GDALTGSaveCache( GDALTransformGrid* psGrid )
+{
+    VSILFILE* fp = VSIFOpenL( psGrid->pszCacheFile, "wb" );
+    if( fp == NULL )
+    {
+        CPLError( CE_Warning, CPLE_OpenFailed,
+                  "Cannot create transform grid cache file %s",
+                  psGrid->pszCacheFile );
+        return;
+    }
+
+    const size_t nNodes = static_cast<size_t>(psGrid->nCellsX + 1) *
+                          (psGrid->nCellsY + 1);
+    const size_t nCells = static_cast<size_t>(psGrid->nCellsX) *
+                          psGrid->nCellsY;
+    const size_t nBlocks = static_cast<size_t>(psGrid->nBlocksX) *
+                           psGrid->nBlocksY;
+    const GInt32 nSigLen = static_cast<GInt32>(strlen(psGrid->pszSignature));
+
+    bool bOK = VSIFWriteL( TG_FILE_SIGNATURE, 8, 1, fp ) == 1;
+    bOK &= GDALTGWriteInt( fp, TG_FILE_VERSION );
+    bOK &= GDALTGWriteInt( fp, psGrid->nDstXSize );
+    bOK &= GDALTGWriteInt( fp, psGrid->nDstYSize );
+    bOK &= GDALTGWriteInt( fp, psGrid->nStep );
+    bOK &= GDALTGWriteDoubles( fp, &psGrid->dfMaxError, 1 );
+    bOK &= GDALTGWriteInt( fp, nSigLen );
+    bOK &= VSIFWriteL( psGrid->pszSignature, 1, nSigLen, fp ) ==
+                                            static_cast<size_t>(nSigLen);
+    bOK &= GDALTGWriteDoubles( fp, psGrid->padfX, nNodes );
+    bOK &= GDALTGWriteDoubles( fp, psGrid->padfY, nNodes );
+    bOK &= GDALTGWriteDoubles( fp, psGrid->padfZ, nNodes );
+    bOK &= VSIFWriteL( psGrid->pabyNodeState, 1, nNodes, fp ) == nNodes;
+    bOK &= VSIFWriteL( psGrid->pabyCellOK, 1, nCells, fp ) == nCells;
+    bOK &= VSIFWriteL( psGrid->pabyBlockDone, 1, nBlocks, fp ) == nBlocks;
+    if( VSIFCloseL( fp ) != 0 )
+        bOK = false;
+
+    if( !bOK )
+    {
+        CPLError( CE_Warning, CPLE_FileIO,
+                  "Cannot write transform grid cache file %s",
+                  psGrid->pszCacheFile );
+        VSIUnlink( psGrid->pszCacheFile );
+    }
+}
+
+/************************************************************************/
+/*                          GDALTGLoadCache()                           */
+/*                                                                      */
+/*      Silently ignore cache files that do not exist, or that were     */
+/*      written for another grid or another base transformer.          */
+/************************************************************************/
+
+static void GDALTGLoadCache( GDALTransformGrid* psGrid )
+{
+    VSILFILE* fp = VSIFOpenL( psGrid->pszCacheFile, "rb" );
+    if( fp == NULL )
+        return;
+
+    const size_t nNodes = static_cast<size_t>(psGrid->nCellsX + 1) *
+                          (psGrid->nCellsY + 1);
+    const size_t nCells = static_cast<size_t>(psGrid->nCellsX) *
+                          psGrid->nCellsY;
+    const size_t nBlocks = static_cast<size_t>(psGrid->nBlocksX) *
+                           psGrid->nBlocksY;
+    const GInt32 nSigLen = static_cast<GInt32>(strlen(psGrid->pszSignature));
+
+    char szHeader[8];
+    GInt32 nVersion = 0, nXSize = 0, nYSize = 0, nStep = 0, nFileSigLen = 0;
+    double dfMaxError = 0.0;
+    bool bOK = VSIFReadL( szHeader, 8, 1, fp ) == 1 &&
+               memcmp( szHeader, TG_FILE_SIGNATURE, 8 ) == 0 &&
+               GDALTGReadInt( fp, &nVersion ) &&
+               nVersion == TG_FILE_VERSION &&
+               GDALTGReadInt( fp, &nXSize ) &&
+               nXSize == psGrid->nDstXSize &&
+               GDALTGReadInt( fp, &nYSize ) &&
+               nYSize == psGrid->nDstYSize &&
+               GDALTGReadInt( fp, &nStep ) &&
+               nStep == psGrid->nStep &&
+               GDALTGReadDoubles( fp, &dfMaxError, 1 ) &&
+               dfMaxError == psGrid->dfMaxError &&
+               GDALTGReadInt( fp, &nFileSigLen ) &&
+               nFileSigLen == nSigLen;
+    if( bOK )
+    {
+        char* pszFileSig = static_cast<char*>(CPLMalloc(nSigLen + 1));
+        pszFileSig[nSigLen] = '\0';
+        bOK = VSIFReadL( pszFileSig, 1, nSigLen, fp ) ==
+                                            static_cast<size_t>(nSigLen) &&
+              strcmp( pszFileSig, psGrid->pszSignature ) == 0;
+        CPLFree( pszFileSig );
+    }
+    if( !bOK )
+    {
+        CPLDebug( "GDAL", "Transform grid cache file %s does not match "
+                  "the current transformation. Ignoring it.",
+                  psGrid->pszCacheFile );
+        VSIFCloseL( fp );
+        return;
+    }
+
+    bOK = GDALTGReadDoubles( fp, psGrid->padfX, nNodes ) &&
+          GDALTGReadDoubles( fp, psGrid->padfY, nNodes ) &&
+          GDALTGReadDoubles( fp, psGrid->padfZ, nNodes ) &&
+          VSIFReadL( psGrid->pabyNodeState, 1, nNodes, fp ) == nNodes &&
+          VSIFReadL( psGrid->pabyCellOK, 1, nCells, fp ) == nCells &&
+          VSIFReadL( psGrid->pabyBlockDone, 1, nBlocks, fp ) == nBlocks;
+    VSIFCloseL( fp );
+
+    if( !bOK )
+    {
+        CPLError( CE_Warning, CPLE_FileIO,
+                  "Transform grid cache file %s is truncated. Ignoring it.",
+                  psGrid->pszCacheFile );
+        memset( psGrid->pabyNodeState, TG_NODE_UNKNOWN, nNodes );
+        memset( psGrid->pabyBlockDone, 0, nBlocks );
+        return;
+    }
+
+    /* Blocks that were not done must be computed again. */
+    for( size_t i = 0; i < nBlocks; i++ )
+    {
+        if( psGrid->pabyBlockDone[i] != TG_BLOCK_DONE )
+            psGrid->pabyBlockDone[i] = TG_BLOCK_TODO;
+    }
+
+    /* Only rewrite the file at the end if new blocks are computed. */
+    psGrid->nBlocksComputed = 0;
+}
+
+/************************************************************************/
+/*                          GDALTGCreateGrid()                          */
+/************************************************************************/
+
+static GDALTransformGrid* GDALTGCreateGrid( TransformGridInfo* psInfo,
+                                            int nDstXSize, int nDstYSize,
+                                            int nStep, double dfMaxError,
+                                            const char* pszCacheFile )
+{
+    GDALTransformGrid* psGrid = static_cast<GDALTransformGrid*>(
+        CPLCalloc(1, sizeof(GDALTransformGrid)) );
+    psGrid->nRefCount = 1;
+    psGrid->nDstXSize = nDstXSize;
+    psGrid->nDstYSize = nDstYSize;
+    psGrid->nStep = nStep;
+    psGrid->dfMaxError = dfMaxError;
+    psGrid->nCellsX = (nDstXSize + nStep - 1) / nStep;
+    psGrid->nCellsY = (nDstYSize + nStep - 1) / nStep;
+    psGrid->nBlocksX = (psGrid->nCellsX + TG_BLOCK_CELLS - 1) / TG_BLOCK_CELLS;
+    psGrid->nBlocksY = (psGrid->nCellsY + TG_BLOCK_CELLS - 1) / TG_BLOCK_CELLS;
+
+    const size_t nNodes = static_cast<size_t>(psGrid->nCellsX + 1) *
+                          (psGrid->nCellsY + 1);
+    const size_t nCells = static_cast<size_t>(psGrid->nCellsX) *
+                          psGrid->nCellsY;
+    const size_t nBlocks = static_cast<size_t>(psGrid->nBlocksX) *
+                           psGrid->nBlocksY;
+    psGrid->padfX = static_cast<double*>(
+        VSI_MALLOC2_VERBOSE(nNodes, sizeof(double)) );
+    psGrid->padfY = static_cast<double*>(
+        VSI_MALLOC2_VERBOSE(nNodes, sizeof(double)) );
+    psGrid->padfZ = static_cast<double*>(
+        VSI_MALLOC2_VERBOSE(nNodes, sizeof(double)) );
+    psGrid->pabyNodeState = static_cast<GByte*>(
+        VSI_CALLOC_VERBOSE(nNodes, 1) );
+    psGrid->pabyCellOK = static_cast<GByte*>( VSI_CALLOC_VERBOSE(nCells, 1) );
+    psGrid->pabyBlockDone = static_cast<GByte*>(
+        VSI_CALLOC_VERBOSE(nBlocks, 1) );
+    if( psGrid->padfX == NULL || psGrid->padfY == NULL ||
+        psGrid->padfZ == NULL || psGrid->pabyNodeState == NULL ||
+        psGrid->pabyCellOK == NULL || psGrid->pabyBlockDone == NULL )
+    {
+        CPLFree( psGrid->padfX );
+        CPLFree( psGrid->padfY );
+        CPLFree( psGrid->padfZ );
+        CPLFree( psGrid->pabyNodeState );
+        CPLFree( psGrid->pabyCellOK );
+        CPLFree( psGrid->pabyBlockDone );
+        CPLFree( psGrid );
+        return NULL;
+    }
+
+    psGrid->hMutex = CPLCreateMutex();
+    CPLReleaseMutex( psGrid->hMutex );
+    psGrid->hCond = CPLCreateCond();
+
+/* -------------------------------------------------------------------- */
+/*      The cache file is only valid for the same base transformer,     */
+/*      which is identified by its serialized form.                     */
+/* -------------------------------------------------------------------- */
+    if( pszCacheFile != NULL && pszCacheFile[0] != '\0' )
+    {
+        CPLXMLNode* psTree =
+            GDALSerializeTransformer( psInfo->pfnBaseTransformer,
+                                      psInfo->pBaseCBData );
+        if( psTree == NULL )
+        {
+            CPLError( CE_Warning, CPLE_NotSupported,
+                      "Base transformer cannot be serialized. "
+                      "Transform grid cache file %s will not be used.",
+                      pszCacheFile );
+        }
+        else
+        {
+            psGrid->pszSignature = CPLSerializeXMLTree( psTree );
+            CPLDestroyXMLNode( psTree );
+            psGrid->pszCacheFile = CPLStrdup( pszCacheFile );
+            GDALTGLoadCache( psGrid );
+        }
+    }
+
+    return psGrid;
+}
+
+/************************************************************************/
+/*                         GDALTGReleaseGrid()                          */
+/************************************************************************/
+
+static void GDALTGReleaseGrid( GDALTransformGrid* psGrid )
+{
+    {
+        CPLMutexHolderD( &psGrid->hMutex );
+        psGrid->nRefCount --;
+        if( psGrid->nRefCount > 0 )
+            return;
+    }
+
+    if( psGrid->pszCacheFile != NULL && psGrid->nBlocksComputed > 0 )
+        GDALTGSaveCache( psGrid );
+
+    CPLDestroyCond( psGrid->hCond );
+    CPLDestroyMutex( psGrid->hMutex );
+    CPLFree( psGrid->padfX );
+    CPLFree( psGrid->padfY );
+    CPLFree( psGrid->padfZ );
+    CPLFree( psGrid->pabyNodeState );
+    CPLFree( psGrid->pabyCellOK );
+    CPLFree( psGrid->pabyBlockDone );
+    CPLFree( psGrid->pszCacheFile );
+    CPLFree( psGrid->pszSignature );
+    CPLFree( psGrid );
+}
+
+/************************************************************************/
+/*                  GDALCreateSimilarTransformGridTransformer()         */
+/************************************************************************/
+
+static void* GDALCreateSimilarTransformGridTransformer( void *hTransformArg,
+                                                        double dfSrcRatioX,
+                                                        double dfSrcRatioY )
+{
+    VALIDATE_POINTER1( hTransformArg,
+                       "GDALCreateSimilarTransformGridTransformer", NULL );
+
+    TransformGridInfo *psInfo = static_cast<TransformGridInfo *>(hTransformArg);
+    GDALTransformGrid *psGrid = psInfo->psGrid;
+
+/* -------------------------------------------------------------------- */
+/*      A clone for the same source shares the grid, so that points     */
+/*      computed by one thread benefit to the others.                   */
+/* -------------------------------------------------------------------- */
+    if( dfSrcRatioX == 1.0 && dfSrcRatioY == 1.0 )
+    {
+        void* pBaseCBData = GDALCloneTransformer( psInfo->pBaseCBData );
+        if( pBaseCBData == NULL )
+            return NULL;
+
+        TransformGridInfo *psClonedInfo = static_cast<TransformGridInfo *>(
+            CPLMalloc(sizeof(TransformGridInfo)) );
+        memcpy( psClonedInfo, psInfo, sizeof(TransformGridInfo) );
+        psClonedInfo->pBaseCBData = pBaseCBData;
+        psClonedInfo->bOwnSubtransformer = TRUE;
+
+        CPLMutexHolderD( &psGrid->hMutex );
+        psGrid->nRefCount ++;
+
+        return psClonedInfo;
+    }
+
+    void* pBaseCBData = GDALCreateSimilarTransformer( psInfo->pBaseCBData,
+                                                      dfSrcRatioX,
+                                                      dfSrcRatioY );
+    if( pBaseCBData == NULL )
+        return NULL;
+
+    char** papszOptions = NULL;
+    papszOptions = CSLSetNameValue( papszOptions, "STEP",
+                                    CPLSPrintf("%d", psGrid->nStep) );
+    void* pTransformArg = GDALCreateTransformGridTransformer(
+        psInfo->pfnBaseTransformer, pBaseCBData,
+        psGrid->nDstXSize, psGrid->nDstYSize, psGrid->dfMaxError,
+        papszOptions );
+    CSLDestroy( papszOptions );
+    if( pTransformArg == NULL )
+    {
+        GDALDestroyTransformer( pBaseCBData );
+        return NULL;
+    }
+    GDALTransformGridTransformerOwnsSubtransformer( pTransformArg, TRUE );
+    return pTransformArg;
+}
+
+/************************************************************************/
+/*                 GDALCreateTransformGridTransformer()                 */
+/************************************************************************/
+
+/**
+ * Create a transformer interpolating a cached grid of transformed points.
+ *
+ * This transformer is an alternative to GDALCreateApproxTransformer() for
+ * warping operations. The destination to source transformation is computed
+ * with the base transformer at the nodes of a regular grid covering the
+ * nDstXSize x nDstYSize destination raster, and is bilinearly interpolated
+ * between them. The grid is computed by blocks of cells, when they are first
+ * needed, and then reused for all subsequent calls, so that expensive base
+ * transformers (RPC with DEM, TPS, geolocation arrays, ...) are invoked only
+ * once for a given area, whatever the number of chunks or scanlines that
+ * cover it.
+ *
+ * For each cell, the base transformer is also evaluated at the center and
+ * the middle of the edges. If the interpolated values differ by more than
+ * dfMaxError (sum of the absolute differences in X and Y, in source pixels)
+ * at one of those points, or if one of the points cannot be transformed, the
+ * points falling in the cell are transformed with the base transformer.
+ * Points outside of the destination raster, points with a non-zero Z, and
+ * source to destination transformations are always handled by the base
+ * transformer.
+ *
+ * Clones of this transformer created by GDALCloneTransformer() share the
+ * same grid, and can be used concurrently from several threads.
+ *
+ * Supported options are:
+ * <ul>
+ * <li>STEP=n: spacing of the grid nodes, in destination pixels. Defaults
+ * to 32.</li>
+ * <li>CACHE_FILE=filename: file in which the computed part of the grid is
+ * saved when the transformer (and all its clones) is destroyed, and from
+ * which it is reloaded by a later transformer with the same base transformer,
+ * destination size, step and error threshold. The base transformer must
+ * support serialization for this option to be taken into account.</li>
+ * </ul>
+ *
+ * @param pfnBaseTransformer the high precision transformer.
+ * @param pBaseTransformArg the callback argument for the high precision
+ * transformer.
+ * @param nDstXSize width of the destination raster.
+ * @param nDstYSize height of the destination raster.
+ * @param dfMaxError the maximum error, in source pixels, accepted for
+ * interpolated points.
+ * @param papszOptions NULL terminated list of options, or NULL.
+ *
+ * @return callback pointer suitable for use with GDALTransformGridTransform(),
+ * or NULL in case of error.  It should be deallocated with
+ * GDALDestroyTransformGridTransformer().
+ *
+ * @since GDAL 2.2
+ */
+
+void *GDALCreateTransformGridTransformer( GDALTransformerFunc pfnBaseTransformer,
+                                          void *pBaseTransformArg,
+                                          int nDstXSize, int nDstYSize,
+                                          double dfMaxError,
+                                          char** papszOptions )
+
+{
+    if( nDstXSize <= 0 || nDstYSize <= 0 )
+    {
+        CPLError( CE_Failure, CPLE_IllegalArg,
+                  "Invalid destination size for transform grid." );
+        return NULL;
+    }
+
+    const int nStep = atoi( CSLFetchNameValueDef(papszOptions, "STEP", "32") );
+    if( nStep <= 0 )
+    {
+        CPLError( CE_Failure, CPLE_IllegalArg,
+                  "Invalid STEP value for transform grid." );
+        return NULL;
+    }
+
+    TransformGridInfo *psInfo = static_cast<TransformGridInfo *>(
+        CPLCalloc(1, sizeof(TransformGridInfo)) );
+    psInfo->pfnBaseTransformer = pfnBaseTransformer;
+    psInfo->pBaseCBData = pBaseTransformArg;
+    psInfo->bOwnSubtransformer = FALSE;
+
+    memcpy( psInfo->sTI.abySignature, GDAL_GTI2_SIGNATURE,
+            strlen(GDAL_GTI2_SIGNATURE) );
+    psInfo->sTI.pszClassName = "GDALTransformGridTransformer";
+    psInfo->sTI.pfnTransform = GDALTransformGridTransform;
+    psInfo->sTI.pfnCleanup = GDALDestroyTransformGridTransformer;
+    psInfo->sTI.pfnSerialize = GDALSerializeTransformGridTransformer;
+    psInfo->sTI.pfnCreateSimilar = GDALCreateSimilarTransformGridTransformer;
+
+    psInfo->psGrid = GDALTGCreateGrid( psInfo, nDstXSize, nDstYSize,
+                                       nStep, dfMaxError,
+                                       CSLFetchNameValue(papszOptions,
+                                                         "CACHE_FILE") );
+    if( psInfo->psGrid == NULL )
+    {
+        CPLFree( psInfo );
+        return NULL;
+    }
+
+    return psInfo;
+}
+
+/************************************************************************/
+/*            GDALTransformGridTransformerOwnsSubtransformer()          */
+/************************************************************************/
+
+void GDALTransformGridTransformerOwnsSubtransformer( void *pCBData,
+                                                     int bOwnFlag )
+
+{
+    TransformGridInfo *psInfo = static_cast<TransformGridInfo *>(pCBData);
+
+    psInfo->bOwnSubtransformer = bOwnFlag;
+}
+
+/************************************************************************/
+/*                GDALDestroyTransformGridTransformer()                 */
+/************************************************************************/
+
+/**
+ * Cleanup transform grid transformer.
+ *
+ * Deallocates the resources allocated by GDALCreateTransformGridTransformer().
+ * The grid is released when the last of the clones that share it is
+ * destroyed, and is then written to the cache file if one was specified.
+ *
+ * @param pCBData callback data originally returned by
+ * GDALCreateTransformGridTransformer().
+ *
+ * @since GDAL 2.2
+ */
+
+void GDALDestroyTransformGridTransformer( void * pCBData )
+
+{
+    if( pCBData == NULL )
+        return;
+
+    TransformGridInfo *psInfo = static_cast<TransformGridInfo *>(pCBData);
+
+    GDALTGReleaseGrid( psInfo->psGrid );
+
+    if( psInfo->bOwnSubtransformer )
+        GDALDestroyTransformer( psInfo->pBaseCBData );
+
+    CPLFree( pCBData );
+}
+
+/************************************************************************/
+/*                     GDALTransformGridTransform()                     */
+/************************************************************************/
+
+/**
+ * Perform transformation using a transform grid.
+ *
+ * Actually performs the transformation described in
+ * GDALCreateTransformGridTransformer().  This function matches the
+ * GDALTransformerFunc() signature.  Details of the arguments are described
+ * there.
+ *
+ * @since GDAL 2.2
+ */
+
+int GDALTransformGridTransform( void *pCBData, int bDstToSrc, int nPoints,
+                                double *x, double *y, double *z,
+                                int *panSuccess )
+
+{
+    TransformGridInfo *psInfo = static_cast<TransformGridInfo *>(pCBData);
+    GDALTransformGrid *psGrid = psInfo->psGrid;
+
+    if( !bDstToSrc || nPoints <= 0 )
+        return psInfo->pfnBaseTransformer( psInfo->pBaseCBData, bDstToSrc,
+                                           nPoints, x, y, z, panSuccess );
+
+/* -------------------------------------------------------------------- */
+/*      Locate the cell of each point, and make sure the blocks we      */
+/*      need are computed. -1 means the base transformer must be used.  */
+/* -------------------------------------------------------------------- */
+    std::vector<int> anCell(nPoints, -1);
+    std::vector<GDALTGBlockPoints> asClaimedBlocks;
+    std::vector<int> anBusyBlocks;
+    const double dfStep = psGrid->nStep;
+    {
+        /* Claim the blocks to compute. */
+        CPLMutexHolderD( &psGrid->hMutex );
+        int iLastBlock = -1;
+        for( int i = 0; i < nPoints; i++ )
+        {
+            if( !(x[i] >= 0.0 && x[i] <= psGrid->nDstXSize &&
+                  y[i] >= 0.0 && y[i] <= psGrid->nDstYSize) ||
+                (z != NULL && z[i] != 0.0) )
+                continue;
+
+            const int iCellX = MIN(static_cast<int>(x[i] / dfStep),
+                                   psGrid->nCellsX - 1);
+            const int iCellY = MIN(static_cast<int>(y[i] / dfStep),
+                                   psGrid->nCellsY - 1);
+            const int iBlockX = iCellX / TG_BLOCK_CELLS;
+            const int iBlockY = iCellY / TG_BLOCK_CELLS;
+            const int iBlock = iBlockY * psGrid->nBlocksX + iBlockX;
+            if( iBlock != iLastBlock )
+            {
+                if( psGrid->pabyBlockDone[iBlock] == TG_BLOCK_TODO )
+                {
+                    psGrid->pabyBlockDone[iBlock] = TG_BLOCK_BUSY;
+                    asClaimedBlocks.resize(asClaimedBlocks.size() + 1);
+                    asClaimedBlocks.back().iBlockX = iBlockX;
+                    asClaimedBlocks.back().iBlockY = iBlockY;
+                }
+                else if( psGrid->pabyBlockDone[iBlock] == TG_BLOCK_BUSY )
+                {
+                    anBusyBlocks.push_back(iBlock);
+                }
+                iLastBlock = iBlock;
+            }
+
+            anCell[i] = iCellY * psGrid->nCellsX + iCellX;
+        }
+    }
+
+    /* Run the base transformer without holding the mutex, so that the */
+    /* threads sharing the grid compute different blocks concurrently. */
+    for( size_t i = 0; i < asClaimedBlocks.size(); i++ )
+        GDALTGTransformBlock( psInfo, &asClaimedBlocks[i] );
+
+    {
+        /* Publish them, and wait for the ones claimed by other threads. */
+        CPLMutexHolderD( &psGrid->hMutex );
+        for( size_t i = 0; i < asClaimedBlocks.size(); i++ )
+            GDALTGPublishBlock( psGrid, &asClaimedBlocks[i] );
+        if( !asClaimedBlocks.empty() )
+            CPLCondBroadcast( psGrid->hCond );
+        for( size_t i = 0; i < anBusyBlocks.size(); i++ )
+        {
+            while( psGrid->pabyBlockDone[anBusyBlocks[i]] != TG_BLOCK_DONE )
+                CPLCondWait( psGrid->hCond, psGrid->hMutex );
+        }
+
+        for( int i = 0; i < nPoints; i++ )
+        {
+            if( anCell[i] >= 0 && !psGrid->pabyCellOK[anCell[i]] )
+                anCell[i] = -1;
+        }
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Interpolate. Computed blocks are never modified, so this can    */
+/*      be done without holding the mutex.                              */
+/* -------------------------------------------------------------------- */
+    std::vector<int> anExact;
+    const int nNodesPerLine = psGrid->nCellsX + 1;
+    for( int i = 0; i < nPoints; i++ )
+    {
+        const int iCell = anCell[i];
+        if( iCell < 0 )
+        {
+            anExact.push_back(i);
+            continue;
+        }
+
+        const int iCellX = iCell % psGrid->nCellsX;
+        const int iCellY = iCell / psGrid->nCellsX;
+        const double dfX0 = GDALTGNodeCoord(iCellX, psGrid->nStep,
+                                            psGrid->nDstXSize);
+        const double dfX1 = GDALTGNodeCoord(iCellX + 1, psGrid->nStep,
+                                            psGrid->nDstXSize);
+        const double dfY0 = GDALTGNodeCoord(iCellY, psGrid->nStep,
+                                            psGrid->nDstYSize);
+        const double dfY1 = GDALTGNodeCoord(iCellY + 1, psGrid->nStep,
+                                            psGrid->nDstYSize);
+        const double dfU = (x[i] - dfX0) / (dfX1 - dfX0);
+        const double dfV = (y[i] - dfY0) / (dfY1 - dfY0);
+        const double dfW00 = (1.0 - dfU) * (1.0 - dfV);
+        const double dfW10 = dfU * (1.0 - dfV);
+        const double dfW01 = (1.0 - dfU) * dfV;
+        const double dfW11 = dfU * dfV;
+
+        const int i00 = iCellY * nNodesPerLine + iCellX;
+        const int i10 = i00 + 1;
+        const int i01 = i00 + nNodesPerLine;
+        const int i11 = i01 + 1;
+
+        x[i] = dfW00 * psGrid->padfX[i00] + dfW10 * psGrid->padfX[i10] +
+               dfW01 * psGrid->padfX[i01] + dfW11 * psGrid->padfX[i11];
+        y[i] = dfW00 * psGrid->padfY[i00] + dfW10 * psGrid->padfY[i10] +
+               dfW01 * psGrid->padfY[i01] + dfW11 * psGrid->padfY[i11];
+        if( z != NULL )
+            z[i] = dfW00 * psGrid->padfZ[i00] + dfW10 * psGrid->padfZ[i10] +
+                   dfW01 * psGrid->padfZ[i01] + dfW11 * psGrid->padfZ[i11];
+        panSuccess[i] = TRUE;
+    }
+
+    if( anExact.empty() )
+        return TRUE;
+
+    if( static_cast<int>(anExact.size()) == nPoints )
+        return psInfo->pfnBaseTransformer( psInfo->pBaseCBData, bDstToSrc,
+                                           nPoints, x, y, z, panSuccess );
+
+/* -------------------------------------------------------------------- */
+/*      Transform the remaining points with the base transformer.       */
+/* -------------------------------------------------------------------- */
+    const int nExact = static_cast<int>(anExact.size());
+    std::vector<double> adfX(nExact), adfY(nExact), adfZ(nExact, 0.0);
+    std::vector<int> anSuccess(nExact, FALSE);
+    for( int i = 0; i < nExact; i++ )
+    {
+        adfX[i] = x[anExact[i]];
+        adfY[i] = y[anExact[i]];
+        if( z != NULL )
+            adfZ[i] = z[anExact[i]];
+    }
+
+    const int bRet = psInfo->pfnBaseTransformer( psInfo->pBaseCBData,
+                                                 bDstToSrc, nExact,
+                                                 &adfX[0], &adfY[0], &adfZ[0],
+                                                 &anSuccess[0] );
+
+    for( int i = 0; i < nExact; i++ )
+    {
+        x[anExact[i]] = adfX[i];
+        y[anExact[i]] = adfY[i];
+        if( z != NULL )
+            z[anExact[i]] = adfZ[i];
+        panSuccess[anExact[i]] = bRet ? anSuccess[i] : FALSE;
+    }
+
+    return bRet;
+}
+
+/************************************************************************/
+/*               GDALSerializeTransformGridTransformer()                */
+/************************************************************************/
+
+CPLXMLNode *GDALSerializeTransformGridTransformer( void *pTransformArg )
+
+{
+    TransformGridInfo *psInfo = static_cast<TransformGridInfo *>(pTransformArg);
+    GDALTransformGrid *psGrid = psInfo->psGrid;
+
+    CPLXMLNode *psTree =
+        CPLCreateXMLNode( NULL, CXT_Element, "TransformGridTransformer" );
+
+    CPLCreateXMLElementAndValue( psTree, "DstXSize",
+                                 CPLSPrintf("%d", psGrid->nDstXSize) );
+    CPLCreateXMLElementAndValue( psTree, "DstYSize",
+                                 CPLSPrintf("%d", psGrid->nDstYSize) );
+    CPLCreateXMLElementAndValue( psTree, "Step",
+                                 CPLSPrintf("%d", psGrid->nStep) );
+    CPLCreateXMLElementAndValue( psTree, "MaxError",
+                                 CPLString().Printf("%.17g", psGrid->dfMaxError) );
+    if( psGrid->pszCacheFile != NULL )
+        CPLCreateXMLElementAndValue( psTree, "CacheFile",
+                                     psGrid->pszCacheFile );
+
+    CPLXMLNode *psTransformerContainer =
+        CPLCreateXMLNode( psTree, CXT_Element, "BaseTransformer" );
+
+    CPLXMLNode *psTransformer =
+        GDALSerializeTransformer( psInfo->pfnBaseTransformer,
+                                  psInfo->pBaseCBData );
+    if( psTransformer != NULL )
+        CPLAddXMLChild( psTransformerContainer, psTransformer );
+
+    return psTree;
+}
+
+/************************************************************************/
+/*              GDALDeserializeTransformGridTransformer()               */
+/************************************************************************/
+
+void *GDALDeserializeTransformGridTransformer( CPLXMLNode *psTree )
+
+{
+    GDALTransformerFunc pfnBaseTransform = NULL;
+    void *pBaseCBData = NULL;
+
+    CPLXMLNode *psContainer = CPLGetXMLNode( psTree, "BaseTransformer" );
+
+    if( psContainer != NULL && psContainer->psChild != NULL )
+    {
+        GDALDeserializeTransformer( psContainer->psChild,
+                                    &pfnBaseTransform,
+                                    &pBaseCBData );
+    }
+
+    if( pfnBaseTransform == NULL )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "Cannot get base transform for transform grid "
+                  "transformer." );
+        return NULL;
+    }
+
+    char** papszOptions = NULL;
+    papszOptions = CSLSetNameValue( papszOptions, "STEP",
+                                    CPLGetXMLValue( psTree, "Step", "32" ) );
+    const char* pszCacheFile = CPLGetXMLValue( psTree, "CacheFile", NULL );
+    if( pszCacheFile != NULL )
+        papszOptions = CSLSetNameValue( papszOptions, "CACHE_FILE",
+                                        pszCacheFile );
+
+    void *pTransformArg = GDALCreateTransformGridTransformer(
+        pfnBaseTransform, pBaseCBData,
+        atoi(CPLGetXMLValue( psTree, "DstXSize", "0" )),
+        atoi(CPLGetXMLValue( psTree, "DstYSize", "0" )),
+        CPLAtof(CPLGetXMLValue( psTree, "MaxError", "0.125" )),
+        papszOptions );
+    CSLDestroy( papszOptions );
+
+    if( pTransformArg == NULL )
+    {
+        GDALDestroyTransformer( pBaseCBData );
+        return NULL;
+    }
+    GDALTransformGridTransformerOwnsSubtransformer( pTransformArg, TRUE );
+
+    return pTransformArg;
+}
@@ -913,6 +913,36 @@ GDALWarpDstAlphaMasker( void *pMaskFuncArg, int nBandCount,
  * set the number of threads to use to parallelize the computation part of the
  * warping. If not set, computation will be done in a single thread.
  *
+ * - MULTI_CHUNK_PIPELINE: (GDAL >= 2.2) Only used by
+ * GDALWarpOperation::ChunkAndWarpMulti() (gdalwarp -multi). When NUM_THREADS
+ * is greater than one, NUM_THREADS chunks are read, warped and written
+ * concurrently, each of them by a worker with its own copy of the
+ * transformer. Reads and writes are serialized, and overlap with the
+ * warping of the other chunks. The warp memory limit is shared by the chunks
+ * in progress. This defaults to TRUE, and may be set to FALSE to use one
+ * thread for input/output and one thread for computation instead, the
+ * computation part being itself parallelized over NUM_THREADS threads.
+ *
+ * - TRANSFORM_GRID: (GDAL >= 2.2) This defaults to FALSE. When set to TRUE,
+ * the destination to source transformation is computed once on a regular
+ * grid covering the destination dataset, and bilinearly interpolated in
+ * cells where the interpolation error is below a threshold. The grid is
+ * shared by all the chunks and threads of the operation. See
+ * GDALCreateTransformGridTransformer(). If the transformer is an approximate
+ * transformer, the grid replaces it.
+ *
+ * - TRANSFORM_GRID_MAX_ERROR: (GDAL >= 2.2) Maximum error, in source
+ * pixels, of the transform grid. Defaults to the error threshold of the
+ * approximate transformer if there is one, or 0.125 otherwise.
+ *
+ * - TRANSFORM_GRID_STEP: (GDAL >= 2.2) Spacing of the transform grid nodes,
+ * in destination pixels. Defaults to 32.
+ *
+ * - TRANSFORM_GRID_CACHE_FILE: (GDAL >= 2.2) File where the computed part of
+ * the transform grid is saved at the end of the operation, and from which it
+ * is reloaded by later operations with the same transformer and destination
+ * grid.
+ *
  * - STREAMABLE_OUTPUT: (GDAL >= 2.0) This defaults to FALSE, but may
  * be set to TRUE typically when writing to a streamed file. The
  * gdalwarp utility automatically sets this option when writing to
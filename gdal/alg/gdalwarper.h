@@ -364,7 +364,8 @@ private:
                                          int *pnSrcXOff, int *pnSrcYOff,
                                          int *pnSrcXSize, int *pnSrcYSize,
                                          int *pnSrcXExtraSize, int *pnSrcYExtraSize,
-                                         double* pdfSrcFillRatio );
+                                         double* pdfSrcFillRatio,
+                                         void *pTransformerArg );
 
     CPLErr          CreateKernelMask( GDALWarpKernel *, int iBand,
                                       const char *pszType );
@@ -381,11 +382,48 @@ private:
 
     void           *psThreadData;
 
+    /* Transformer actually used: the one of psOptions, or a transform */
+    /* grid wrapping it (pTransformGridArg) if TRANSFORM_GRID is set. */
+    GDALTransformerFunc pfnWarpTransformer;
+    void           *pWarpTransformerArg;
+    void           *pTransformGridArg;
+
+    CPLErr          CreateTransformGrid();
+
     void            WipeChunkList();
     CPLErr          CollectChunkList( int nDstXOff, int nDstYOff,
                                       int nDstXSize, int nDstYSize );
     void            ReportTiming( const char * );
 
+    CPLErr          WarpRegionInternal( int nDstXOff, int nDstYOff,
+                                        int nDstXSize, int nDstYSize,
+                                        int nSrcXOff, int nSrcYOff,
+                                        int nSrcXSize, int nSrcYSize,
+                                        int nSrcXExtraSize, int nSrcYExtraSize,
+                                        double dfProgressBase,
+                                        double dfProgressScale,
+                                        void *pTransformerArg,
+                                        void *psThreadDataIn,
+                                        GDALProgressFunc pfnProgress,
+                                        void *pProgressArg );
+    CPLErr          WarpRegionToBufferInternal( int nDstXOff, int nDstYOff,
+                                        int nDstXSize, int nDstYSize,
+                                        void *pDataBuf,
+                                        GDALDataType eBufDataType,
+                                        int nSrcXOff, int nSrcYOff,
+                                        int nSrcXSize, int nSrcYSize,
+                                        int nSrcXExtraSize, int nSrcYExtraSize,
+                                        double dfProgressBase,
+                                        double dfProgressScale,
+                                        void *pTransformerArg,
+                                        void *psThreadDataIn,
+                                        GDALProgressFunc pfnProgress,
+                                        void *pProgressArg );
+
+    int             GetPipelineThreadCount();
+    CPLErr          ChunkAndWarpPipelined( int nThreads );
+    static void     PipelineWorkerThread( void *pData );
+
 public:
                     GDALWarpOperation();
     virtual        ~GDALWarpOperation();
@@ -29,10 +29,13 @@
  ****************************************************************************/
 
 #include "gdalwarper.h"
+#include "gdal_alg_priv.h"
 #include "cpl_string.h"
 #include "cpl_multiproc.h"
 #include "ogr_api.h"
 
+#include <vector>
+
 CPL_CVSID("$Id$");
 
 struct _GDALWarpChunk {
@@ -133,6 +136,10 @@ GDALWarpOperation::GDALWarpOperation()
     bReportTimings = FALSE;
     nLastTimeReported = 0;
     psThreadData = NULL;
+
+    pfnWarpTransformer = NULL;
+    pWarpTransformerArg = NULL;
+    pTransformGridArg = NULL;
 }
 
 /************************************************************************/
@@ -145,10 +152,9 @@ GDALWarpOperation::~GDALWarpOperation()
     WipeOptions();
 
     if( hIOMutex != NULL )
-    {
         CPLDestroyMutex( hIOMutex );
+    if( hWarpMutex != NULL )
         CPLDestroyMutex( hWarpMutex );
-    }
 
     WipeChunkList();
     if( psThreadData )
@@ -177,6 +183,14 @@ void GDALWarpOperation::WipeOptions()
         GDALDestroyWarpOptions( psOptions );
         psOptions = NULL;
     }
+
+    if( pTransformGridArg != NULL )
+    {
+        GDALDestroyTransformGridTransformer( pTransformGridArg );
+        pTransformGridArg = NULL;
+    }
+    pfnWarpTransformer = NULL;
+    pWarpTransformerArg = NULL;
 }
 
 /************************************************************************/
@@ -575,13 +589,30 @@ CPLErr GDALWarpOperation::Initialize( const GDALWarpOptions *psNewOptions )
     if( !ValidateOptions() )
         eErr = CE_Failure;
 
+/* -------------------------------------------------------------------- */
+/*      Optionally replace the transformer by a transform grid, shared  */
+/*      by all the chunks and threads of this operation.                */
+/* -------------------------------------------------------------------- */
+    if( eErr == CE_None )
+    {
+        pfnWarpTransformer = psOptions->pfnTransformer;
+        pWarpTransformerArg = psOptions->pTransformerArg;
+
+        if( CSLFetchBoolean( psOptions->papszWarpOptions,
+                             "TRANSFORM_GRID", FALSE )
+            && psOptions->hDstDS != NULL )
+        {
+            eErr = CreateTransformGrid();
+        }
+    }
+
     if( eErr != CE_None )
         WipeOptions();
     else
     {
         psThreadData = GWKThreadsCreate(psOptions->papszWarpOptions,
-                                        psOptions->pfnTransformer,
-                                        psOptions->pTransformerArg);
+                                        pfnWarpTransformer,
+                                        pWarpTransformerArg);
         if( psThreadData == NULL )
             eErr = CE_Failure;
     }
@@ -589,6 +620,60 @@ CPLErr GDALWarpOperation::Initialize( const GDALWarpOptions *psNewOptions )
     return eErr;
 }
 
+/************************************************************************/
+/*                        CreateTransformGrid()                         */
+/*                                                                      */
+/*      Wrap the transformer of the options into a transform grid       */
+/*      covering the destination dataset. If the transformer is an      */
+/*      approximate transformer, the grid replaces it and uses its      */
+/*      error threshold.                                                */
+/************************************************************************/
+
+CPLErr GDALWarpOperation::CreateTransformGrid()
+
+{
+    GDALTransformerFunc pfnBaseTransformer = psOptions->pfnTransformer;
+    void *pBaseTransformerArg = psOptions->pTransformerArg;
+    double dfMaxError = 0.125;
+
+    if( pfnBaseTransformer == GDALApproxTransform )
+        GDALGetApproxTransformerInfo( psOptions->pTransformerArg,
+                                      &pfnBaseTransformer,
+                                      &pBaseTransformerArg,
+                                      &dfMaxError );
+
+    const char* pszMaxError = CSLFetchNameValue( psOptions->papszWarpOptions,
+                                                 "TRANSFORM_GRID_MAX_ERROR" );
+    if( pszMaxError != NULL )
+        dfMaxError = CPLAtof( pszMaxError );
+
+    char **papszGridOptions = NULL;
+    const char* pszStep = CSLFetchNameValue( psOptions->papszWarpOptions,
+                                             "TRANSFORM_GRID_STEP" );
+    if( pszStep != NULL )
+        papszGridOptions = CSLSetNameValue( papszGridOptions, "STEP", pszStep );
+    const char* pszCacheFile = CSLFetchNameValue( psOptions->papszWarpOptions,
+                                                  "TRANSFORM_GRID_CACHE_FILE" );
+    if( pszCacheFile != NULL )
+        papszGridOptions = CSLSetNameValue( papszGridOptions, "CACHE_FILE",
+                                            pszCacheFile );
+
+    pTransformGridArg = GDALCreateTransformGridTransformer(
+        pfnBaseTransformer, pBaseTransformerArg,
+        GDALGetRasterXSize( psOptions->hDstDS ),
+        GDALGetRasterYSize( psOptions->hDstDS ),
+        dfMaxError, papszGridOptions );
+    CSLDestroy( papszGridOptions );
+
+    if( pTransformGridArg == NULL )
+        return CE_Failure;
+
+    pfnWarpTransformer = GDALTransformGridTransform;
+    pWarpTransformerArg = pTransformGridArg;
+
+    return CE_None;
+}
+
 /************************************************************************/
 /*                         GDALCreateWarpOperation()                    */
 /************************************************************************/
@@ -827,6 +912,12 @@ static void ChunkThreadMain( void *pThreadData )
  * internally this method uses multiple threads to interleave input/output
  * for one region while the processing is being done for another.
  *
+ * If the NUM_THREADS warp option (or the GDAL_NUM_THREADS configuration
+ * option) allows several threads, and the output is large enough to be
+ * split in as many chunks, each thread reads, warps and writes its own
+ * chunks, so that the warping of several chunks runs concurrently with
+ * input/output. See the MULTI_CHUNK_PIPELINE warp option.
+ *
  * @param nDstXOff X offset to window of destination data to be produced.
  * @param nDstYOff Y offset to window of destination data to be produced.
  * @param nDstXSize Width of output window on destination file to be produced.
@@ -839,6 +930,30 @@ CPLErr GDALWarpOperation::ChunkAndWarpMulti(
     int nDstXOff, int nDstYOff,  int nDstXSize, int nDstYSize )
 
 {
+/* -------------------------------------------------------------------- */
+/*      If several threads are allowed, try to read, warp and write     */
+/*      several chunks concurrently.                                    */
+/* -------------------------------------------------------------------- */
+    const int nPipelineThreads = GetPipelineThreadCount();
+    if( nPipelineThreads > 1 )
+    {
+        // The warp memory limit is shared by the chunks in progress.
+        const double dfWarpMemoryLimit = psOptions->dfWarpMemoryLimit;
+        psOptions->dfWarpMemoryLimit = dfWarpMemoryLimit / nPipelineThreads;
+        WipeChunkList();
+        CollectChunkList( nDstXOff, nDstYOff, nDstXSize, nDstYSize );
+        psOptions->dfWarpMemoryLimit = dfWarpMemoryLimit;
+
+        // With fewer chunks than threads, multi-threading the warp kernel
+        // of each chunk is more efficient.
+        if( nChunkListCount >= nPipelineThreads )
+            return ChunkAndWarpPipelined( nPipelineThreads );
+
+        CPLDebug( "WARP", "Only %d chunks for %d threads: "
+                  "not using pipelined mode.",
+                  nChunkListCount, nPipelineThreads );
+    }
+
     hIOMutex = CPLCreateMutex();
     hWarpMutex = CPLCreateMutex();
 
@@ -965,6 +1080,284 @@ CPLErr GDALWarpOperation::ChunkAndWarpMulti(
     return eErr;
 }
 
+/************************************************************************/
+/*                       GetPipelineThreadCount()                       */
+/*                                                                      */
+/*      Return the number of chunks that ChunkAndWarpMulti() may        */
+/*      process concurrently, or 1 if the pipelined mode cannot be      */
+/*      used.                                                           */
+/************************************************************************/
+
+int GDALWarpOperation::GetPipelineThreadCount()
+
+{
+    if( !CSLFetchBoolean( psOptions->papszWarpOptions,
+                          "MULTI_CHUNK_PIPELINE", TRUE ) )
+        return 1;
+
+    // Chunks are written in an unpredictable order.
+    if( CSLFetchBoolean( psOptions->papszWarpOptions,
+                         "STREAMABLE_OUTPUT", FALSE ) )
+        return 1;
+
+    // Application provided chunk processors may not be reentrant.
+    if( psOptions->pfnPreWarpChunkProcessor != NULL ||
+        psOptions->pfnPostWarpChunkProcessor != NULL )
+        return 1;
+
+    const char* pszWarpThreads =
+        CSLFetchNameValue( psOptions->papszWarpOptions, "NUM_THREADS" );
+    if( pszWarpThreads == NULL )
+        pszWarpThreads = CPLGetConfigOption( "GDAL_NUM_THREADS", "1" );
+    int nThreads;
+    if( EQUAL(pszWarpThreads, "ALL_CPUS") )
+        nThreads = CPLGetNumCPUs();
+    else
+        nThreads = atoi(pszWarpThreads);
+    if( nThreads > 128 )
+        nThreads = 128;
+    return MAX(1, nThreads);
+}
+
+/************************************************************************/
+/*                        PipelineWorkerThread()                        */
+/************************************************************************/
+
+typedef struct _GDALWarpPipelineWorker GDALWarpPipelineWorker;
+
+typedef struct
+{
+    GDALWarpOperation      *poOperation;
+    const GDALWarpOptions  *psOptions;
+    GDALWarpChunk          *pasChunkList;
+    int                     nChunkListCount;
+    CPLMutex               *hIOMutex;
+
+    /* Fields below are protected by hMutex */
+    CPLMutex               *hMutex;
+    int                     iNextChunk;
+    double                  dfTotalPixels;
+    double                  dfPixelsProcessed;
+    int                     bStop;
+    CPLErr                  eErr;
+    GDALWarpPipelineWorker *pasWorkers;
+    int                     nWorkers;
+} GDALWarpPipelineState;
+
+struct _GDALWarpPipelineWorker
+{
+    GDALWarpPipelineState  *psState;
+    CPLJoinableThread      *hThread;
+    int                     bCloneTransformer;
+
+    /* Protected by psState->hMutex */
+    double                  dfChunkPixels;
+    double                  dfChunkProgress;
+};
+
+/* Progress of a chunk, reported as the overall progress of the operation */
+static int CPL_STDCALL GDALWarpPipelineProgress( double dfComplete,
+                                                 const char *pszMessage,
+                                                 void *pProgressArg )
+{
+    GDALWarpPipelineWorker* psWorker =
+        static_cast<GDALWarpPipelineWorker*>(pProgressArg);
+    GDALWarpPipelineState* psState = psWorker->psState;
+
+    CPLMutexHolderD( &(psState->hMutex) );
+    if( psState->bStop )
+        return FALSE;
+
+    psWorker->dfChunkProgress = MAX(psWorker->dfChunkProgress,
+                                    MIN(1.0, dfComplete));
+    double dfPixels = psState->dfPixelsProcessed;
+    for( int i = 0; i < psState->nWorkers; i++ )
+        dfPixels += psState->pasWorkers[i].dfChunkPixels *
+                    psState->pasWorkers[i].dfChunkProgress;
+
+    if( !psState->psOptions->pfnProgress( dfPixels / psState->dfTotalPixels,
+                                          pszMessage,
+                                          psState->psOptions->pProgressArg ) )
+    {
+        psState->bStop = TRUE;
+        return FALSE;
+    }
+    return TRUE;
+}
+
+void GDALWarpOperation::PipelineWorkerThread( void *pData )
+
+{
+    GDALWarpPipelineWorker* psWorker =
+        static_cast<GDALWarpPipelineWorker*>(pData);
+    GDALWarpPipelineState* psState = psWorker->psState;
+    GDALWarpOperation* poOperation = psState->poOperation;
+
+/* -------------------------------------------------------------------- */
+/*      Each worker needs its own transformer. It is cloned in this     */
+/*      thread, so that datasets lazily opened by the transformer (for  */
+/*      example a RPC DEM) belong to this thread.                       */
+/* -------------------------------------------------------------------- */
+    void* pTransformerArg = poOperation->pWarpTransformerArg;
+    if( psWorker->bCloneTransformer )
+    {
+        pTransformerArg = GDALCloneTransformer( pTransformerArg );
+        if( pTransformerArg == NULL )
+        {
+            CPLDebug( "WARP", "Cannot duplicate transformer function. "
+                      "Pipeline worker exiting." );
+            return;
+        }
+    }
+
+    while( true )
+    {
+        GDALWarpChunk* psChunk;
+        {
+            CPLMutexHolderD( &(psState->hMutex) );
+            if( psState->bStop ||
+                psState->iNextChunk == psState->nChunkListCount )
+                break;
+            psChunk = psState->pasChunkList + psState->iNextChunk;
+            psState->iNextChunk ++;
+            psWorker->dfChunkPixels = psChunk->dsx * (double) psChunk->dsy;
+            psWorker->dfChunkProgress = 0.0;
+        }
+
+        CPLErr eErr;
+        if( !CPLAcquireMutex( psState->hIOMutex, 600.0 ) )
+        {
+            CPLError( CE_Failure, CPLE_AppDefined,
+                      "Failed to acquire IOMutex in WarpRegion()." );
+            eErr = CE_Failure;
+        }
+        else
+        {
+            // The source and destination reads and writes are done with
+            // hIOMutex held. It is released by WarpRegionToBufferInternal()
+            // while the kernel runs. The kernel of each chunk is run in
+            // the calling thread.
+            eErr = poOperation->WarpRegionInternal(
+                                    psChunk->dx, psChunk->dy,
+                                    psChunk->dsx, psChunk->dsy,
+                                    psChunk->sx, psChunk->sy,
+                                    psChunk->ssx, psChunk->ssy,
+                                    psChunk->sExtraSx, psChunk->sExtraSy,
+                                    0.0, 1.0,
+                                    pTransformerArg, NULL,
+                                    GDALWarpPipelineProgress, psWorker );
+            CPLReleaseMutex( psState->hIOMutex );
+        }
+
+        CPLMutexHolderD( &(psState->hMutex) );
+        psState->dfPixelsProcessed += psWorker->dfChunkPixels;
+        psWorker->dfChunkPixels = 0.0;
+        if( eErr != CE_None )
+        {
+            psState->eErr = eErr;
+            psState->bStop = TRUE;
+        }
+    }
+
+    if( psWorker->bCloneTransformer )
+        GDALDestroyTransformer( pTransformerArg );
+}
+
+/************************************************************************/
+/*                       ChunkAndWarpPipelined()                        */
+/*                                                                      */
+/*      Warp the chunks of the chunk list with nThreads workers, each   */
+/*      of them taking the next chunk to process, and doing the read,   */
+/*      warp and write steps. Reads and writes are serialized on        */
+/*      hIOMutex, since datasets are not thread-safe, but overlap       */
+/*      with the warping of other chunks.                               */
+/************************************************************************/
+
+CPLErr GDALWarpOperation::ChunkAndWarpPipelined( int nThreads )
+
+{
+    /* Sort chucks from top to bottom, and for equal y, from left to right */
+    if( pasChunkList )
+        qsort(pasChunkList, nChunkListCount, sizeof(GDALWarpChunk), OrderWarpChunk);
+
+    CPLDebug( "WARP", "Pipelined warping of %d chunks with %d threads.",
+              nChunkListCount, nThreads );
+
+    // There is no warp mutex in pipelined mode.
+    CPLMutex* hWarpMutexBackup = hWarpMutex;
+    hWarpMutex = NULL;
+    const bool bOwnIOMutex = (hIOMutex == NULL);
+    if( bOwnIOMutex )
+    {
+        hIOMutex = CPLCreateMutex();
+        CPLReleaseMutex( hIOMutex );
+    }
+
+    GDALWarpPipelineState sState;
+    memset( &sState, 0, sizeof(sState) );
+    sState.poOperation = this;
+    sState.psOptions = psOptions;
+    sState.pasChunkList = pasChunkList;
+    sState.nChunkListCount = nChunkListCount;
+    sState.hIOMutex = hIOMutex;
+    sState.eErr = CE_None;
+    for( int iChunk = 0; iChunk < nChunkListCount; iChunk++ )
+        sState.dfTotalPixels +=
+            pasChunkList[iChunk].dsx * (double) pasChunkList[iChunk].dsy;
+
+    std::vector<GDALWarpPipelineWorker> asWorkers(nThreads);
+    sState.pasWorkers = &asWorkers[0];
+    sState.nWorkers = nThreads;
+
+    // Thread 0 uses the transformer of the operation, which is not used
+    // by anything else while the chunks are processed.
+    for( int i = 0; i < nThreads; i++ )
+    {
+        asWorkers[i].psState = &sState;
+        asWorkers[i].bCloneTransformer = (i > 0);
+        asWorkers[i].dfChunkPixels = 0.0;
+        asWorkers[i].dfChunkProgress = 0.0;
+        asWorkers[i].hThread =
+            CPLCreateJoinableThread( PipelineWorkerThread, &asWorkers[i] );
+        if( asWorkers[i].hThread == NULL )
+        {
+            CPLError( CE_Failure, CPLE_AppDefined,
+                      "CPLCreateJoinableThread() failed in ChunkAndWarpMulti()" );
+            CPLMutexHolderD( &(sState.hMutex) );
+            sState.eErr = CE_Failure;
+            sState.bStop = TRUE;
+            break;
+        }
+    }
+
+    for( int i = 0; i < nThreads; i++ )
+    {
+        if( asWorkers[i].hThread != NULL )
+            CPLJoinThread( asWorkers[i].hThread );
+    }
+
+    CPLErr eErr = sState.eErr;
+    if( eErr == CE_None && sState.iNextChunk != nChunkListCount )
+    {
+        if( sState.bStop )
+            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+        eErr = CE_Failure;
+    }
+
+    if( sState.hMutex != NULL )
+        CPLDestroyMutex( sState.hMutex );
+    if( bOwnIOMutex )
+    {
+        CPLDestroyMutex( hIOMutex );
+        hIOMutex = NULL;
+    }
+    hWarpMutex = hWarpMutexBackup;
+
+    WipeChunkList();
+
+    return eErr;
+}
+
 /************************************************************************/
 /*                         GDALChunkAndWarpMulti()                      */
 /************************************************************************/
@@ -1014,7 +1407,8 @@ CPLErr GDALWarpOperation::CollectChunkList(
 
     eErr = ComputeSourceWindow( nDstXOff, nDstYOff, nDstXSize, nDstYSize,
                                 &nSrcXOff, &nSrcYOff, &nSrcXSize, &nSrcYSize,
-                                &nSrcXExtraSize, &nSrcYExtraSize, &dfSrcFillRatio );
+                                &nSrcXExtraSize, &nSrcYExtraSize, &dfSrcFillRatio,
+                                pWarpTransformerArg );
 
     if( eErr != CE_None )
     {
@@ -1261,6 +1655,38 @@ CPLErr GDALWarpOperation::WarpRegion( int nDstXOff, int nDstYOff,
                                       double dfProgressBase,
                                       double dfProgressScale)
 
+{
+    return WarpRegionInternal( nDstXOff, nDstYOff, nDstXSize, nDstYSize,
+                               nSrcXOff, nSrcYOff, nSrcXSize, nSrcYSize,
+                               nSrcXExtraSize, nSrcYExtraSize,
+                               dfProgressBase, dfProgressScale,
+                               pWarpTransformerArg, psThreadData,
+                               psOptions->pfnProgress,
+                               psOptions->pProgressArg );
+}
+
+/************************************************************************/
+/*                         WarpRegionInternal()                         */
+/*                                                                      */
+/*      Same as WarpRegion(), but with the transformer, the kernel      */
+/*      thread pool and the progress callback to use for this region.   */
+/*      This is used by the pipelined mode of ChunkAndWarpMulti(),      */
+/*      where several regions are warped concurrently.                  */
+/************************************************************************/
+
+CPLErr GDALWarpOperation::WarpRegionInternal( int nDstXOff, int nDstYOff,
+                                              int nDstXSize, int nDstYSize,
+                                              int nSrcXOff, int nSrcYOff,
+                                              int nSrcXSize, int nSrcYSize,
+                                              int nSrcXExtraSize,
+                                              int nSrcYExtraSize,
+                                              double dfProgressBase,
+                                              double dfProgressScale,
+                                              void *pTransformerArg,
+                                              void *psThreadDataIn,
+                                              GDALProgressFunc pfnProgress,
+                                              void *pProgressArg )
+
 {
     CPLErr eErr;
     int   iBand;
@@ -1379,11 +1805,14 @@ CPLErr GDALWarpOperation::WarpRegion( int nDstXOff, int nDstYOff,
 /* -------------------------------------------------------------------- */
 /*      Perform the warp.                                               */
 /* -------------------------------------------------------------------- */
-    eErr = WarpRegionToBuffer( nDstXOff, nDstYOff, nDstXSize, nDstYSize,
-                               pDstBuffer, psOptions->eWorkingDataType,
-                               nSrcXOff, nSrcYOff, nSrcXSize, nSrcYSize,
-                               nSrcXExtraSize, nSrcYExtraSize,
-                               dfProgressBase, dfProgressScale);
+    eErr = WarpRegionToBufferInternal( nDstXOff, nDstYOff,
+                                       nDstXSize, nDstYSize,
+                                       pDstBuffer, psOptions->eWorkingDataType,
+                                       nSrcXOff, nSrcYOff, nSrcXSize, nSrcYSize,
+                                       nSrcXExtraSize, nSrcYExtraSize,
+                                       dfProgressBase, dfProgressScale,
+                                       pTransformerArg, psThreadDataIn,
+                                       pfnProgress, pProgressArg );
 
 /* -------------------------------------------------------------------- */
 /*      Write the output data back to disk if all went well.            */
@@ -1502,6 +1931,31 @@ CPLErr GDALWarpOperation::WarpRegionToBuffer(
     int nSrcXExtraSize, int nSrcYExtraSize,
     double dfProgressBase, double dfProgressScale)
 
+{
+    return WarpRegionToBufferInternal( nDstXOff, nDstYOff,
+                                       nDstXSize, nDstYSize,
+                                       pDataBuf, eBufDataType,
+                                       nSrcXOff, nSrcYOff, nSrcXSize, nSrcYSize,
+                                       nSrcXExtraSize, nSrcYExtraSize,
+                                       dfProgressBase, dfProgressScale,
+                                       pWarpTransformerArg, psThreadData,
+                                       psOptions->pfnProgress,
+                                       psOptions->pProgressArg );
+}
+
+/************************************************************************/
+/*                     WarpRegionToBufferInternal()                     */
+/************************************************************************/
+
+CPLErr GDALWarpOperation::WarpRegionToBufferInternal(
+    int nDstXOff, int nDstYOff, int nDstXSize, int nDstYSize,
+    void *pDataBuf, GDALDataType eBufDataType,
+    int nSrcXOff, int nSrcYOff, int nSrcXSize, int nSrcYSize,
+    int nSrcXExtraSize, int nSrcYExtraSize,
+    double dfProgressBase, double dfProgressScale,
+    void *pTransformerArg, void *psThreadDataIn,
+    GDALProgressFunc pfnProgress, void *pProgressArg )
+
 {
     CPLErr eErr = CE_None;
     int    i;
@@ -1518,7 +1972,8 @@ CPLErr GDALWarpOperation::WarpRegionToBuffer(
         eErr = ComputeSourceWindow( nDstXOff, nDstYOff, nDstXSize, nDstYSize,
                                     &nSrcXOff, &nSrcYOff,
                                     &nSrcXSize, &nSrcYSize,
-                                    &nSrcXExtraSize, &nSrcYExtraSize, NULL );
+                                    &nSrcXExtraSize, &nSrcYExtraSize, NULL,
+                                    pTransformerArg );
         if( eErr != CE_None )
             return eErr;
     }
@@ -1532,16 +1987,16 @@ CPLErr GDALWarpOperation::WarpRegionToBuffer(
     oWK.nBands = psOptions->nBandCount;
     oWK.eWorkingDataType = psOptions->eWorkingDataType;
 
-    oWK.pfnTransformer = psOptions->pfnTransformer;
-    oWK.pTransformerArg = psOptions->pTransformerArg;
+    oWK.pfnTransformer = pfnWarpTransformer;
+    oWK.pTransformerArg = pTransformerArg;
 
-    oWK.pfnProgress = psOptions->pfnProgress;
-    oWK.pProgress = psOptions->pProgressArg;
+    oWK.pfnProgress = pfnProgress;
+    oWK.pProgress = pProgressArg;
     oWK.dfProgressBase = dfProgressBase;
     oWK.dfProgressScale = dfProgressScale;
 
     oWK.papszWarpOptions = psOptions->papszWarpOptions;
-    oWK.psThreadData = psThreadData;
+    oWK.psThreadData = psThreadDataIn;
 
     oWK.padfDstNoDataReal = psOptions->padfDstNoDataReal;
 
@@ -1868,12 +2323,14 @@ CPLErr GDALWarpOperation::WarpRegionToBuffer(
     }
 
 /* -------------------------------------------------------------------- */
-/*      Release IO Mutex, and acquire warper mutex.                     */
+/*      Release IO Mutex, and acquire warper mutex. In pipelined        */
+/*      mode, there is no warper mutex as each region has its own       */
+/*      transformer.                                                    */
 /* -------------------------------------------------------------------- */
     if( hIOMutex != NULL )
     {
         CPLReleaseMutex( hIOMutex );
-        if( !CPLAcquireMutex( hWarpMutex, 600.0 ) )
+        if( hWarpMutex != NULL && !CPLAcquireMutex( hWarpMutex, 600.0 ) )
         {
             CPLError( CE_Failure, CPLE_AppDefined,
                       "Failed to acquire WarpMutex in WarpRegion()." );
@@ -1909,7 +2366,8 @@ CPLErr GDALWarpOperation::WarpRegionToBuffer(
 /* -------------------------------------------------------------------- */
     if( hIOMutex != NULL )
     {
-        CPLReleaseMutex( hWarpMutex );
+        if( hWarpMutex != NULL )
+            CPLReleaseMutex( hWarpMutex );
         if( !CPLAcquireMutex( hIOMutex, 600.0 ) )
         {
             CPLError( CE_Failure, CPLE_AppDefined,
@@ -2087,7 +2545,8 @@ CPLErr GDALWarpOperation::ComputeSourceWindow(int nDstXOff, int nDstYOff,
                                               int *pnSrcXOff, int *pnSrcYOff,
                                               int *pnSrcXSize, int *pnSrcYSize,
                                               int *pnSrcXExtraSize, int *pnSrcYExtraSize,
-                                              double *pdfSrcFillRatio)
+                                              double *pdfSrcFillRatio,
+                                              void *pTransformerArg)
 
 {
 /* -------------------------------------------------------------------- */
@@ -2207,9 +2666,9 @@ CPLErr GDALWarpOperation::ComputeSourceWindow(int nDstXOff, int nDstYOff,
 /* -------------------------------------------------------------------- */
 /*      Transform them to the input pixel coordinate space              */
 /* -------------------------------------------------------------------- */
-    if( !psOptions->pfnTransformer( psOptions->pTransformerArg,
-                                    TRUE, nSamplePoints,
-                                    padfX, padfY, padfZ, pabSuccess ) )
+    if( !pfnWarpTransformer( pTransformerArg,
+                             TRUE, nSamplePoints,
+                             padfX, padfY, padfZ, pabSuccess ) )
     {
         CPLFree( padfX );
         CPLFree( pabSuccess );
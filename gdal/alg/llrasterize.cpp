@@ -142,6 +142,13 @@ No known bug
     if( maxy >= nRasterYSize )
         maxy = nRasterYSize-1;
 
+    /* Only scan the lines of the window being burnt */
+    const GDALRasterizeInfo *psInfo = (const GDALRasterizeInfo *) pCBData;
+    if( miny < psInfo->nYMin )
+        miny = psInfo->nYMin;
+    if( maxy >= psInfo->nYMax )
+        maxy = psInfo->nYMax - 1;
+
     minx = 0;
     maxx = nRasterXSize - 1;
 
@@ -291,6 +298,13 @@ void GDALdllImageLine( int nRasterXSize, int nRasterYSize,
             const int iX1 = (int)floor( padfX[n + j] );
             const int iY1 = (int)floor( padfY[n + j] );
 
+            // Skip segments that are off the window being burnt.
+            const GDALRasterizeInfo *psInfo =
+                (const GDALRasterizeInfo *) pCBData;
+            if( (iY < psInfo->nYMin && iY1 < psInfo->nYMin)
+                || (iY >= psInfo->nYMax && iY1 >= psInfo->nYMax) )
+                continue;
+
             double dfVariant = 0, dfVariant1 = 0;
             if( padfVariant != NULL &&
                 ((GDALRasterizeInfo *)pCBData)->eBurnValueSource !=
@@ -419,6 +433,14 @@ GDALdllImageLineAllTouched(int nRasterXSize, int nRasterYSize,
                 || (dfX > nRasterXSize && dfXEnd > nRasterXSize) )
                 continue;
 
+            // Skip segments that are off the window being burnt, with a
+            // margin for the small steps along the segment.
+            const GDALRasterizeInfo *psInfo =
+                (const GDALRasterizeInfo *) pCBData;
+            if( (dfY < psInfo->nYMin - 1 && dfYEnd < psInfo->nYMin - 1)
+                || (dfY > psInfo->nYMax + 1 && dfYEnd > psInfo->nYMax + 1) )
+                continue;
+
             // Swap if needed so we can proceed from left2right (X increasing)
             if( dfX > dfXEnd )
             {
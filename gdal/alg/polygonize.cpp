@@ -30,6 +30,8 @@
 #include "gdal_alg_priv.h"
 #include "cpl_conv.h"
 #include "cpl_string.h"
+#include "cpl_multiproc.h"
+#include <algorithm>
 #include <vector>
 
 CPL_CVSID("$Id$");
@@ -46,17 +48,34 @@ CPL_CVSID("$Id$");
 
 class RPolygon {
 public:
-    RPolygon(  double dfValue ) { dfPolyValue = dfValue; nLastLineUpdated = -1; }
+    RPolygon(  double dfValue ) { dfPolyValue = dfValue; nLastLineUpdated = -1;
+                                  nFirstX = -1; nFirstY = -1; nSeamLabel = -1;
+                                  bCornerTouch = false; }
 
     double              dfPolyValue;
     int              nLastLineUpdated;
 
+    // Top-left corner of the first segment added. The string holding it
+    // belongs to the outer ring.
+    int              nFirstX;
+    int              nFirstY;
+
+    // Used by the tiled mode to identify polygons touching the top seam
+    // of a strip.
+    int              nSeamLabel;
+
+    // Set when two pixels of the polygon touch only by a corner, which
+    // makes the rings ambiguous for Coalesce().
+    bool             bCornerTouch;
+
     std::vector< std::vector<int> > aanXY;
 
     void             AddSegment( int x1, int y1, int x2, int y2 );
     void             Dump();
     void             Coalesce();
+    void             RebuildRings();
     void             Merge( int iBaseString, int iSrcString, int iDirection );
+    void             Absorb( RPolygon *poOther );
 };
 
 /************************************************************************/
@@ -144,6 +163,246 @@ void RPolygon::Coalesce()
 
 }
 
+/************************************************************************/
+/*                            RebuildRings()                            */
+/*                                                                      */
+/*      Alternative to Coalesce() that does not depend on the order     */
+/*      in which the strings were collected. Coalesce() can join the    */
+/*      edges around a vertex where two pixels of the polygon touch     */
+/*      by a corner the wrong way, so this is used for such polygons    */
+/*      with 8-connectedness, and in the tiled mode where polygon       */
+/*      parts are merged as they are discovered.                        */
+/*                                                                      */
+/*      The strings are split into unit edges, that are oriented with   */
+/*      the polygon on their left by counting the vertical edges met    */
+/*      on each line. Rings are then walked from the top-left vertex,   */
+/*      which belongs to the outer ring, turning right where two        */
+/*      rings touch at a vertex, so that a hole touching the outer      */
+/*      ring or another hole at a single vertex stays a separate ring.  */
+/************************************************************************/
+
+struct RPUnitEdge
+{
+    int nX;
+    int nY;
+    int nDX;
+    int nDY;
+
+    bool operator<( const RPUnitEdge& other ) const
+    {
+        if( nY != other.nY )
+            return nY < other.nY;
+        if( nX != other.nX )
+            return nX < other.nX;
+        if( nDY != other.nDY )
+            return nDY < other.nDY;
+        return nDX < other.nDX;
+    }
+};
+
+static bool RPStartsBefore( const RPUnitEdge& a, const RPUnitEdge& b )
+{
+    return a.nY < b.nY || (a.nY == b.nY && a.nX < b.nX);
+}
+
+void RPolygon::RebuildRings()
+
+{
+/* -------------------------------------------------------------------- */
+/*      Collect the unit edges, as a start vertex and an increasing     */
+/*      direction. An edge present twice is internal to the polygon.    */
+/* -------------------------------------------------------------------- */
+    std::vector<RPUnitEdge> asEdges;
+    size_t iString;
+    size_t nLength = 0;
+
+    for( iString = 0; iString < aanXY.size(); iString++ )
+    {
+        const std::vector<int> &anString = aanXY[iString];
+        for( size_t iVert = 2; iVert + 1 < anString.size(); iVert += 2 )
+            nLength += ABS(anString[iVert] - anString[iVert-2])
+                + ABS(anString[iVert+1] - anString[iVert-1]);
+    }
+    asEdges.reserve( nLength );
+
+    for( iString = 0; iString < aanXY.size(); iString++ )
+    {
+        const std::vector<int> &anString = aanXY[iString];
+
+        for( size_t iVert = 2; iVert + 1 < anString.size(); iVert += 2 )
+        {
+            int nX1 = anString[iVert-2];
+            int nY1 = anString[iVert-1];
+            int nX2 = anString[iVert];
+            int nY2 = anString[iVert+1];
+
+            if( nX1 > nX2 || nY1 > nY2 )
+            {
+                std::swap( nX1, nX2 );
+                std::swap( nY1, nY2 );
+            }
+
+            RPUnitEdge sEdge;
+            sEdge.nDX = (nX2 > nX1) ? 1 : 0;
+            sEdge.nDY = (nY2 > nY1) ? 1 : 0;
+            for( sEdge.nX = nX1, sEdge.nY = nY1;
+                 sEdge.nX != nX2 || sEdge.nY != nY2;
+                 sEdge.nX += sEdge.nDX, sEdge.nY += sEdge.nDY )
+            {
+                asEdges.push_back( sEdge );
+            }
+        }
+    }
+
+    std::sort( asEdges.begin(), asEdges.end() );
+
+    size_t nEdges = 0;
+    for( size_t i = 0; i < asEdges.size(); )
+    {
+        if( i + 1 < asEdges.size()
+            && !(asEdges[i] < asEdges[i+1]) )
+        {
+            i += 2;
+            continue;
+        }
+        asEdges[nEdges++] = asEdges[i++];
+    }
+    asEdges.resize( nEdges );
+
+/* -------------------------------------------------------------------- */
+/*      A pixel belongs to the polygon if an odd number of vertical     */
+/*      edges is found on its line up to its left side. The edges are  */
+/*      sorted by line then column, so this is counted in one sweep.    */
+/* -------------------------------------------------------------------- */
+    bool bInside = false;
+    int nCurY = 0;
+
+    for( size_t i = 0; i < nEdges; )
+    {
+        const int nY = asEdges[i].nY;
+        const int nX = asEdges[i].nX;
+        if( i == 0 || nY != nCurY )
+        {
+            bInside = false;
+            nCurY = nY;
+        }
+
+        // The edges starting at the top-left corner of the pixel.
+        size_t iEnd = i;
+        for( ; iEnd < nEdges && asEdges[iEnd].nY == nY
+               && asEdges[iEnd].nX == nX; iEnd++ )
+        {
+            if( asEdges[iEnd].nDY != 0 )
+                bInside = !bInside;
+        }
+
+        // Keep the polygon on the left: westward above it, southward
+        // on its left side (y growing downwards).
+        for( ; i < iEnd; i++ )
+        {
+            RPUnitEdge &sEdge = asEdges[i];
+            if( sEdge.nDX != 0 && bInside )
+            {
+                sEdge.nX += 1;
+                sEdge.nDX = -1;
+            }
+            else if( sEdge.nDY != 0 && !bInside )
+            {
+                sEdge.nY += 1;
+                sEdge.nDY = -1;
+            }
+        }
+    }
+
+    std::sort( asEdges.begin(), asEdges.end(), RPStartsBefore );
+
+    // Index of the first edge starting on each line, to look the edges
+    // starting from a vertex up in its line only.
+    const int nMinY = nEdges ? asEdges[0].nY : 0;
+    const int nLines = nEdges ? asEdges[nEdges-1].nY - nMinY + 1 : 0;
+    std::vector<size_t> anLineStart( nLines + 1, nEdges );
+    for( size_t i = nEdges; i > 0; i-- )
+        anLineStart[asEdges[i-1].nY - nMinY] = i - 1;
+    for( int iLine = nLines - 1; iLine >= 0; iLine-- )
+    {
+        if( anLineStart[iLine] == nEdges )
+            anLineStart[iLine] = anLineStart[iLine+1];
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Walk the rings. At most two edges start from a vertex.          */
+/* -------------------------------------------------------------------- */
+    std::vector<bool> abUsed( nEdges, false );
+    std::vector< std::vector<int> > aanRings;
+
+    for( size_t iFirst = 0; iFirst < nEdges; iFirst++ )
+    {
+        if( abUsed[iFirst] )
+            continue;
+
+        aanRings.resize( aanRings.size() + 1 );
+        std::vector<int> &anRing = aanRings.back();
+        size_t iEdge = iFirst;
+        int nX = asEdges[iFirst].nX;
+        int nY = asEdges[iFirst].nY;
+        int nDX = 0;
+        int nDY = 0;
+
+        while( true )
+        {
+            const RPUnitEdge &sEdge = asEdges[iEdge];
+            abUsed[iEdge] = true;
+            if( sEdge.nDX != nDX || sEdge.nDY != nDY )
+            {
+                anRing.push_back( nX );
+                anRing.push_back( nY );
+            }
+            nDX = sEdge.nDX;
+            nDY = sEdge.nDY;
+            nX += nDX;
+            nY += nDY;
+
+            if( nY < nMinY || nY - nMinY >= nLines )
+                break;
+            RPUnitEdge sKey;
+            sKey.nX = nX;
+            sKey.nY = nY;
+            std::pair< std::vector<RPUnitEdge>::iterator,
+                       std::vector<RPUnitEdge>::iterator > oRange =
+                std::equal_range( asEdges.begin() + anLineStart[nY - nMinY],
+                                  asEdges.begin() + anLineStart[nY - nMinY + 1],
+                                  sKey, RPStartsBefore );
+            size_t iNext = nEdges;
+            for( std::vector<RPUnitEdge>::iterator oIter = oRange.first;
+                 oIter != oRange.second; ++oIter )
+            {
+                const size_t iCandidate = oIter - asEdges.begin();
+                if( oIter->nDX == -nDY && oIter->nDY == nDX )
+                {
+                    iNext = iCandidate;
+                    break;
+                }
+                if( iNext == nEdges
+                    && (iCandidate == iFirst || !abUsed[iCandidate]) )
+                    iNext = iCandidate;
+            }
+
+            if( iNext == iFirst || iNext == nEdges || abUsed[iNext] )
+                break;
+            iEdge = iNext;
+        }
+
+        // Skip the first vertex if it is in the middle of a side.
+        if( anRing.size() >= 4
+            && asEdges[iFirst].nDX == nDX && asEdges[iFirst].nDY == nDY )
+            anRing.erase( anRing.begin(), anRing.begin() + 2 );
+        anRing.push_back( anRing[0] );
+        anRing.push_back( anRing[1] );
+    }
+
+    aanXY.swap( aanRings );
+}
+
 /************************************************************************/
 /*                               Merge()                                */
 /************************************************************************/
@@ -188,6 +447,12 @@ void RPolygon::AddSegment( int x1, int y1, int x2, int y2 )
 {
     nLastLineUpdated = MAX(y1, y2);
 
+    if( nFirstY < 0 )
+    {
+        nFirstX = x1;
+        nFirstY = y1;
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Is there an existing string ending with this?                   */
 /* -------------------------------------------------------------------- */
@@ -252,6 +517,33 @@ void RPolygon::AddSegment( int x1, int y1, int x2, int y2 )
     return;
 }
 
+/************************************************************************/
+/*                               Absorb()                               */
+/*                                                                      */
+/*      Take over the strings of another part of the same polygon.      */
+/*      The strings of the part starting first are kept in front, so    */
+/*      that the first string still belongs to the outer ring.          */
+/************************************************************************/
+
+void RPolygon::Absorb( RPolygon *poOther )
+
+{
+    if( poOther->nFirstY >= 0
+        && (nFirstY < 0 || poOther->nFirstY < nFirstY
+            || (poOther->nFirstY == nFirstY && poOther->nFirstX < nFirstX)) )
+    {
+        aanXY.swap( poOther->aanXY );
+        nFirstX = poOther->nFirstX;
+        nFirstY = poOther->nFirstY;
+    }
+
+    aanXY.insert( aanXY.end(), poOther->aanXY.begin(), poOther->aanXY.end() );
+    poOther->aanXY.clear();
+
+    nLastLineUpdated = MAX(nLastLineUpdated, poOther->nLastLineUpdated);
+    bCornerTouch = bCornerTouch || poOther->bCornerTouch;
+}
+
 /************************************************************************/
 /* ==================================================================== */
 /*     End of RPolygon                                                  */
@@ -264,13 +556,15 @@ void RPolygon::AddSegment( int x1, int y1, int x2, int y2 )
 /*      Examine one pixel and compare to its neighbour above            */
 /*      (previous) and right.  If they are different polygon ids        */
 /*      then add the pixel edge to this polygon and the one on the      */
-/*      other side of the edge.                                         */
+/*      other side of the edge. Edges with the line above are skipped   */
+/*      if bHorizontalEdges is false.                                   */
 /************************************************************************/
 
 template<class DataType>
 static void AddEdges( GInt32 *panThisLineId, GInt32 *panLastLineId,
                       GInt32 *panPolyIdMap, DataType *panPolyValue,
-                      RPolygon **papoPoly, int iX, int iY )
+                      RPolygon **papoPoly, int iX, int iY,
+                      bool bHorizontalEdges = true )
 
 {
     int nThisId = panThisLineId[iX];
@@ -285,7 +579,7 @@ static void AddEdges( GInt32 *panThisLineId, GInt32 *panLastLineId,
     if( nPreviousId != -1 )
         nPreviousId = panPolyIdMap[nPreviousId];
 
-    if( nThisId != nPreviousId )
+    if( bHorizontalEdges && nThisId != nPreviousId )
     {
         if( nThisId != -1 )
         {
@@ -323,13 +617,71 @@ static void AddEdges( GInt32 *panThisLineId, GInt32 *panLastLineId,
     }
 }
 
+/************************************************************************/
+/*                        FlagCornerTouches()                           */
+/*                                                                      */
+/*      Flag the polygons having two pixels of the same value that      */
+/*      touch only by a corner, on the vertices between the previous    */
+/*      line and this one. The pixels may still be parts of different   */
+/*      polygons not merged yet. Id arrays start at the first pixel.    */
+/************************************************************************/
+
+template<class DataType, class EqualityTest>
+static void FlagCornerTouches( const GInt32 *panLastLineId,
+                               const GInt32 *panThisLineId,
+                               const DataType *panLastLineVal,
+                               const DataType *panThisLineVal,
+                               const GInt32 *panPolyIdMap,
+                               RPolygon **papoPoly, int nXSize )
+
+{
+    EqualityTest oEqual;
+
+    for( int iX = 1; iX < nXSize; iX++ )
+    {
+        // Pixels around the vertex:  A B
+        //                            C D
+        int nA = panLastLineId[iX-1];
+        int nB = panLastLineId[iX];
+        int nC = panThisLineId[iX-1];
+        int nD = panThisLineId[iX];
+
+        if( nA != -1 )
+            nA = panPolyIdMap[nA];
+        if( nB != -1 )
+            nB = panPolyIdMap[nB];
+        if( nC != -1 )
+            nC = panPolyIdMap[nC];
+        if( nD != -1 )
+            nD = panPolyIdMap[nD];
+
+        if( nA == nB || nA == nC || nD == nB || nD == nC )
+            continue;
+
+        if( nA != -1 && nD != -1
+            && oEqual( panLastLineVal[iX-1], panThisLineVal[iX] ) )
+        {
+            papoPoly[nA]->bCornerTouch = true;
+            papoPoly[nD]->bCornerTouch = true;
+        }
+        if( nB != -1 && nC != -1
+            && oEqual( panLastLineVal[iX], panThisLineVal[iX-1] ) )
+        {
+            papoPoly[nB]->bCornerTouch = true;
+            papoPoly[nC]->bCornerTouch = true;
+        }
+    }
+}
+
 /************************************************************************/
 /*                         EmitPolygonToLayer()                         */
 /************************************************************************/
 
 static CPLErr
 EmitPolygonToLayer( OGRLayerH hOutLayer, int iPixValField,
-                    RPolygon *poRPoly, double *padfGeoTransform )
+                    RPolygon *poRPoly, double *padfGeoTransform,
+                    CPLMutex *hLayerMutex = NULL,
+                    bool bRebuildRings = false )
 
 {
     OGRFeatureH hFeat;
@@ -338,7 +690,10 @@ EmitPolygonToLayer( OGRLayerH hOutLayer, int iPixValField,
 /* -------------------------------------------------------------------- */
 /*      Turn bits of lines into coherent rings.                         */
 /* -------------------------------------------------------------------- */
-    poRPoly->Coalesce();
+    if( bRebuildRings && poRPoly->bCornerTouch )
+        poRPoly->RebuildRings();
+    else
+        poRPoly->Coalesce();
 
 /* -------------------------------------------------------------------- */
 /*      Create the polygon geometry.                                    */
@@ -392,8 +747,12 @@ EmitPolygonToLayer( OGRLayerH hOutLayer, int iPixValField,
 /* -------------------------------------------------------------------- */
     CPLErr eErr = CE_None;
 
+    if( hLayerMutex != NULL )
+        CPLAcquireMutex( hLayerMutex, 1000.0 );
     if( OGR_L_CreateFeature( hOutLayer, hFeat ) != OGRERR_NONE )
         eErr = CE_Failure;
+    if( hLayerMutex != NULL )
+        CPLReleaseMutex( hLayerMutex );
 
     OGR_F_Destroy( hFeat );
 
@@ -430,6 +789,812 @@ GPMaskImageData( GDALRasterBandH hMaskBand, GByte* pabyMaskLine, int iY, int nXS
     return eErr;
 }
 
+/************************************************************************/
+/* ==================================================================== */
+/*                         Tiled polygonization                         */
+/*                                                                      */
+/*      The raster is split into strips of full lines that can be       */
+/*      processed by several threads. Each strip is processed in a      */
+/*      single pass: polygon ids are renumbered after each line, so     */
+/*      that the maps stay bounded by the line width, and polygons are  */
+/*      written as soon as they no longer appear on the current line.   */
+/*      Polygons touching the seam between two strips are kept aside,   */
+/*      without their seam edges, and are stitched and written by the   */
+/*      calling thread once the strips on both sides are done.          */
+/* ==================================================================== */
+/************************************************************************/
+
+#define GP_SEAM_TOP     1
+#define GP_SEAM_BOTTOM  2
+
+/************************************************************************/
+/*                               GPStrip                                */
+/************************************************************************/
+
+template<class DataType>
+class GPStrip
+{
+public:
+    GPStrip( int nYOffIn, int nYEndIn ) : nYOff(nYOffIn), nYEnd(nYEndIn),
+        bDone(false), eErr(CE_None), nFirstSeamPoly(-1) {}
+    ~GPStrip()
+    {
+        for( size_t i = 0; i < apoSeamPoly.size(); i++ )
+            delete apoSeamPoly[i];
+    }
+
+    int                     nYOff;
+    int                     nYEnd;          // exclusive
+    bool                    bDone;
+    CPLErr                  eErr;
+
+    // Polygons touching the top and/or bottom seam of the strip.
+    std::vector<RPolygon*>  apoSeamPoly;
+    std::vector<int>        anSeamFlags;
+
+    // Index in apoSeamPoly of the polygon of each pixel of the first
+    // and last lines (or -1), and the pixel values of these lines.
+    std::vector<GInt32>     anTopPoly;
+    std::vector<GInt32>     anBottomPoly;
+    std::vector<DataType>   anTopVal;
+    std::vector<DataType>   anBottomVal;
+
+    // Index of apoSeamPoly[0] in the seam stitcher, once added.
+    int                     nFirstSeamPoly;
+};
+
+/************************************************************************/
+/*                            GPTiledContext                            */
+/************************************************************************/
+
+template<class DataType>
+struct GPTiledContext
+{
+    GDALRasterBandH     hSrcBand;
+    GDALRasterBandH     hMaskBand;
+    GDALDataType        eDT;
+    OGRLayerH           hOutLayer;
+    int                 iPixValField;
+    double              adfGeoTransform[6];
+    int                 nConnectedness;
+    int                 nXSize;
+    int                 nYSize;
+
+    std::vector< GPStrip<DataType>* > apoStrips;
+    int                 iNextStrip;
+
+    // When several threads are used, protects the raster reads, the
+    // output layer and the members below. NULL otherwise.
+    CPLMutex           *hMutex;
+    CPLCond            *hCond;
+    int                 nLinesDone;
+    bool                bStop;
+
+    GDALProgressFunc    pfnProgress;
+    void               *pProgressArg;
+};
+
+/************************************************************************/
+/*                             GPFindRoot()                             */
+/************************************************************************/
+
+static int GPFindRoot( std::vector<int>& anParent, int i )
+{
+    int nRoot = i;
+    while( anParent[nRoot] != nRoot )
+        nRoot = anParent[nRoot];
+    while( anParent[i] != nRoot )
+    {
+        int nNext = anParent[i];
+        anParent[i] = nRoot;
+        i = nNext;
+    }
+    return nRoot;
+}
+
+/************************************************************************/
+/*                             GPReadLine()                             */
+/************************************************************************/
+
+template<class DataType>
+static CPLErr GPReadLine( GPTiledContext<DataType> *psCtx, int iY,
+                          DataType *panLineVal, GByte *pabyMaskLine )
+{
+    if( psCtx->hMutex != NULL )
+        CPLAcquireMutex( psCtx->hMutex, 1000.0 );
+
+    CPLErr eErr = GDALRasterIO( psCtx->hSrcBand, GF_Read, 0, iY,
+                                psCtx->nXSize, 1, panLineVal,
+                                psCtx->nXSize, 1, psCtx->eDT, 0, 0 );
+    if( eErr == CE_None && psCtx->hMaskBand != NULL )
+        eErr = GPMaskImageData( psCtx->hMaskBand, pabyMaskLine, iY,
+                                psCtx->nXSize, panLineVal );
+
+    if( psCtx->hMutex != NULL )
+        CPLReleaseMutex( psCtx->hMutex );
+
+    return eErr;
+}
+
+/************************************************************************/
+/*                            GPReportLine()                            */
+/*                                                                      */
+/*      Account for a processed line. Progress is reported directly     */
+/*      when running in the calling thread, or by the calling thread    */
+/*      when it is waiting for workers. Returns false if processing     */
+/*      must stop.                                                      */
+/************************************************************************/
+
+template<class DataType>
+static bool GPReportLine( GPTiledContext<DataType> *psCtx )
+{
+    if( psCtx->hMutex == NULL )
+    {
+        psCtx->nLinesDone++;
+        if( !psCtx->pfnProgress( psCtx->nLinesDone / (double) psCtx->nYSize,
+                                 "", psCtx->pProgressArg ) )
+        {
+            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+            psCtx->bStop = true;
+        }
+        return !psCtx->bStop;
+    }
+
+    CPLAcquireMutex( psCtx->hMutex, 1000.0 );
+    psCtx->nLinesDone++;
+    bool bContinue = !psCtx->bStop;
+    CPLCondSignal( psCtx->hCond );
+    CPLReleaseMutex( psCtx->hMutex );
+
+    return bContinue;
+}
+
+/************************************************************************/
+/*                         GPPolygonizeStrip()                          */
+/************************************************************************/
+
+template<class DataType, class EqualityTest>
+static CPLErr GPPolygonizeStrip( GPTiledContext<DataType> *psCtx,
+                                 GPStrip<DataType> *psStrip )
+{
+    const int nXSize = psCtx->nXSize;
+    const bool bTopSeam = psStrip->nYOff > 0;
+    const bool bBottomSeam = psStrip->nYEnd < psCtx->nYSize;
+    // The last strip also processes a virtual nodata line after the
+    // raster to close its polygons.
+    const int nYLast = bBottomSeam ? psStrip->nYEnd - 1 : psStrip->nYEnd;
+
+    std::vector<DataType> anLastLineVal( nXSize );
+    std::vector<DataType> anThisLineVal( nXSize );
+    std::vector<GInt32> anLastLineId( nXSize + 2, -1 );
+    std::vector<GInt32> anThisLineId( nXSize + 2, -1 );
+    std::vector<GByte> abyMaskLine( psCtx->hMaskBand != NULL ? nXSize : 0 );
+    GByte *pabyMaskLine = abyMaskLine.empty() ? NULL : &abyMaskLine[0];
+
+    GDALRasterPolygonEnumeratorT<DataType, EqualityTest>
+        oEnum( psCtx->nConnectedness );
+    std::vector<RPolygon*> apoPoly;
+    std::vector<GInt32> anNewIdMap;
+
+    // Union-find on the labels of the polygons of the first line, to
+    // track which seam polygon each top pixel ends up in.
+    std::vector<int> anLabelParent;
+    std::vector<int> anLabelSeamPoly;
+
+    CPLErr eErr = CE_None;
+
+    for( int iY = psStrip->nYOff; eErr == CE_None && iY <= nYLast; iY++ )
+    {
+        const bool bFirstLine = ( iY == psStrip->nYOff );
+
+/* -------------------------------------------------------------------- */
+/*      Read the line and assign polygon ids.                           */
+/* -------------------------------------------------------------------- */
+        if( iY < psCtx->nYSize )
+        {
+            eErr = GPReadLine( psCtx, iY, &anThisLineVal[0], pabyMaskLine );
+            if( eErr != CE_None )
+                break;
+
+            if( bFirstLine )
+                oEnum.ProcessLine( NULL, &anThisLineVal[0],
+                                   NULL, &anThisLineId[1], nXSize );
+            else
+                oEnum.ProcessLine( &anLastLineVal[0], &anThisLineVal[0],
+                                   &anLastLineId[1], &anThisLineId[1],
+                                   nXSize );
+        }
+        else
+        {
+            for( int iX = 1; iX <= nXSize; iX++ )
+                anThisLineId[iX] = -1;
+        }
+
+/* -------------------------------------------------------------------- */
+/*      Merge the parts of polygons found to be connected.              */
+/* -------------------------------------------------------------------- */
+        oEnum.ResolveMerges();
+        apoPoly.resize( oEnum.nNextPolygonId, NULL );
+
+        for( int iPoly = 0; iPoly < oEnum.nNextPolygonId; iPoly++ )
+        {
+            const int nFinalId = oEnum.panPolyIdMap[iPoly];
+            RPolygon *poPart = apoPoly[iPoly];
+            if( nFinalId == iPoly || poPart == NULL )
+                continue;
+
+            apoPoly[iPoly] = NULL;
+            RPolygon *poFinal = apoPoly[nFinalId];
+            if( poFinal == NULL )
+            {
+                apoPoly[nFinalId] = poPart;
+                continue;
+            }
+
+            if( poPart->nSeamLabel >= 0 )
+            {
+                if( poFinal->nSeamLabel >= 0 )
+                    anLabelParent[GPFindRoot(anLabelParent,
+                                             poPart->nSeamLabel)] =
+                        GPFindRoot(anLabelParent, poFinal->nSeamLabel);
+                else
+                    poFinal->nSeamLabel = poPart->nSeamLabel;
+            }
+            poFinal->Absorb( poPart );
+            delete poPart;
+        }
+
+/* -------------------------------------------------------------------- */
+/*      Add polygon edges. Those along the top seam are added when      */
+/*      stitching.                                                      */
+/* -------------------------------------------------------------------- */
+        for( int iX = 0; iX < nXSize+1; iX++ )
+        {
+            AddEdges( &anThisLineId[0], &anLastLineId[0],
+                      oEnum.panPolyIdMap, oEnum.panPolyValue,
+                      apoPoly.empty() ? NULL : &apoPoly[0], iX, iY,
+                      !(bTopSeam && bFirstLine) );
+        }
+        if( !bFirstLine && iY < psCtx->nYSize )
+            FlagCornerTouches<DataType, EqualityTest>(
+                &anLastLineId[1], &anThisLineId[1],
+                &anLastLineVal[0], &anThisLineVal[0],
+                oEnum.panPolyIdMap, &apoPoly[0], nXSize );
+
+        if( bTopSeam && bFirstLine )
+        {
+            anLabelParent.resize( oEnum.nNextPolygonId );
+            anLabelSeamPoly.resize( oEnum.nNextPolygonId, -1 );
+            for( int iPoly = 0; iPoly < oEnum.nNextPolygonId; iPoly++ )
+            {
+                anLabelParent[iPoly] = iPoly;
+                if( apoPoly[iPoly] != NULL )
+                    apoPoly[iPoly]->nSeamLabel = iPoly;
+            }
+            psStrip->anTopPoly.assign( anThisLineId.begin() + 1,
+                                       anThisLineId.begin() + 1 + nXSize );
+            psStrip->anTopVal = anThisLineVal;
+        }
+
+/* -------------------------------------------------------------------- */
+/*      Renumber the polygons of this line. Those not found on it are   */
+/*      complete, unless they touch the top seam.                       */
+/* -------------------------------------------------------------------- */
+        const int nPolyCount = oEnum.nNextPolygonId;
+        anNewIdMap.resize( nPolyCount );
+        const int nNewPolyCount =
+            oEnum.RenumberPolygons( &anThisLineId[1], nXSize,
+                                    anNewIdMap.empty() ? NULL : &anNewIdMap[0] );
+
+        std::vector<RPolygon*> apoNewPoly( nNewPolyCount, (RPolygon*) NULL );
+        for( int iPoly = 0; iPoly < nPolyCount; iPoly++ )
+        {
+            RPolygon *poPoly = apoPoly[iPoly];
+            if( poPoly == NULL )
+                continue;
+
+            if( anNewIdMap[iPoly] >= 0 )
+            {
+                apoNewPoly[anNewIdMap[iPoly]] = poPoly;
+            }
+            else if( poPoly->nSeamLabel >= 0 )
+            {
+                anLabelSeamPoly[GPFindRoot(anLabelParent,
+                                           poPoly->nSeamLabel)] =
+                    static_cast<int>(psStrip->apoSeamPoly.size());
+                psStrip->apoSeamPoly.push_back( poPoly );
+                psStrip->anSeamFlags.push_back( GP_SEAM_TOP );
+            }
+            else
+            {
+                if( eErr == CE_None )
+                    eErr = EmitPolygonToLayer( psCtx->hOutLayer,
+                                               psCtx->iPixValField, poPoly,
+                                               psCtx->adfGeoTransform,
+                                               psCtx->hMutex, true );
+                delete poPoly;
+            }
+        }
+        apoPoly.swap( apoNewPoly );
+
+/* -------------------------------------------------------------------- */
+/*      At the end of a strip, the remaining polygons touch the         */
+/*      bottom seam.                                                    */
+/* -------------------------------------------------------------------- */
+        if( bBottomSeam && iY == nYLast )
+        {
+            std::vector<GInt32> anSeamPolyOfId( apoPoly.size() );
+            for( size_t iPoly = 0; iPoly < apoPoly.size(); iPoly++ )
+            {
+                RPolygon *poPoly = apoPoly[iPoly];
+                int nFlags = GP_SEAM_BOTTOM;
+                anSeamPolyOfId[iPoly] =
+                    static_cast<int>(psStrip->apoSeamPoly.size());
+                if( poPoly->nSeamLabel >= 0 )
+                {
+                    anLabelSeamPoly[GPFindRoot(anLabelParent,
+                                               poPoly->nSeamLabel)] =
+                        anSeamPolyOfId[iPoly];
+                    nFlags |= GP_SEAM_TOP;
+                }
+                psStrip->apoSeamPoly.push_back( poPoly );
+                psStrip->anSeamFlags.push_back( nFlags );
+            }
+            apoPoly.clear();
+
+            psStrip->anBottomPoly.resize( nXSize );
+            for( int iX = 0; iX < nXSize; iX++ )
+            {
+                const int nId = anThisLineId[iX+1];
+                psStrip->anBottomPoly[iX] =
+                    (nId >= 0) ? anSeamPolyOfId[nId] : -1;
+            }
+            psStrip->anBottomVal = anThisLineVal;
+        }
+
+        anLastLineVal.swap( anThisLineVal );
+        anLastLineId.swap( anThisLineId );
+
+        if( eErr == CE_None && iY < psCtx->nYSize && !GPReportLine( psCtx ) )
+            eErr = CE_Failure;
+    }
+
+    for( size_t iPoly = 0; iPoly < apoPoly.size(); iPoly++ )
+        delete apoPoly[iPoly];
+
+/* -------------------------------------------------------------------- */
+/*      Map the pixels of the first line to their seam polygon.         */
+/* -------------------------------------------------------------------- */
+    if( eErr == CE_None && bTopSeam )
+    {
+        for( int iX = 0; iX < nXSize; iX++ )
+        {
+            const int nLabel = psStrip->anTopPoly[iX];
+            if( nLabel >= 0 )
+                psStrip->anTopPoly[iX] =
+                    anLabelSeamPoly[GPFindRoot(anLabelParent, nLabel)];
+        }
+    }
+
+    return eErr;
+}
+
+/************************************************************************/
+/*                           GPTiledWorker()                            */
+/************************************************************************/
+
+template<class DataType, class EqualityTest>
+static void GPTiledWorker( void *pData )
+{
+    GPTiledContext<DataType> *psCtx = (GPTiledContext<DataType> *) pData;
+
+    while( true )
+    {
+        GPStrip<DataType> *psStrip = NULL;
+
+        CPLAcquireMutex( psCtx->hMutex, 1000.0 );
+        if( !psCtx->bStop &&
+            psCtx->iNextStrip < static_cast<int>(psCtx->apoStrips.size()) )
+            psStrip = psCtx->apoStrips[psCtx->iNextStrip++];
+        CPLReleaseMutex( psCtx->hMutex );
+
+        if( psStrip == NULL )
+            break;
+
+        CPLErr eErr = GPPolygonizeStrip<DataType, EqualityTest>( psCtx,
+                                                                 psStrip );
+
+        CPLAcquireMutex( psCtx->hMutex, 1000.0 );
+        psStrip->eErr = eErr;
+        psStrip->bDone = true;
+        if( eErr != CE_None )
+            psCtx->bStop = true;
+        CPLCondSignal( psCtx->hCond );
+        CPLReleaseMutex( psCtx->hMutex );
+    }
+}
+
+/************************************************************************/
+/* ==================================================================== */
+/*                            GPSeamStitcher                            */
+/*                                                                      */
+/*      Collects the polygons touching strip seams, merges those        */
+/*      connected across a seam and writes them once all the seams      */
+/*      they touch have been stitched.                                  */
+/* ==================================================================== */
+/************************************************************************/
+
+template<class DataType, class EqualityTest>
+class GPSeamStitcher
+{
+    std::vector<RPolygon*>  apoPoly;
+    std::vector<int>        anParent;
+    std::vector<int>        anPending;  // seams left to stitch, for roots
+    std::vector<int>        anNextPart; // list of the parts of a polygon
+    std::vector<int>        anLastPart; // for roots
+
+    void        AddStrip( GPStrip<DataType> *psStrip );
+    void        Union( int iPoly1, int iPoly2 );
+    CPLErr      EmitCompleted( GPStrip<DataType> *psStrip,
+                               GPTiledContext<DataType> *psCtx );
+
+public:
+                GPSeamStitcher() {}
+               ~GPSeamStitcher();
+
+    CPLErr      StitchSeam( GPStrip<DataType> *psAbove,
+                            GPStrip<DataType> *psBelow,
+                            GPTiledContext<DataType> *psCtx );
+};
+
+/************************************************************************/
+/*                          ~GPSeamStitcher()                           */
+/************************************************************************/
+
+template<class DataType, class EqualityTest>
+GPSeamStitcher<DataType, EqualityTest>::~GPSeamStitcher()
+{
+    for( size_t i = 0; i < apoPoly.size(); i++ )
+        delete apoPoly[i];
+}
+
+/************************************************************************/
+/*                              AddStrip()                              */
+/************************************************************************/
+
+template<class DataType, class EqualityTest>
+void GPSeamStitcher<DataType, EqualityTest>::AddStrip(
+    GPStrip<DataType> *psStrip )
+{
+    if( psStrip->nFirstSeamPoly >= 0 )
+        return;
+
+    psStrip->nFirstSeamPoly = static_cast<int>(apoPoly.size());
+    for( size_t i = 0; i < psStrip->apoSeamPoly.size(); i++ )
+    {
+        const int iPoly = static_cast<int>(apoPoly.size());
+        const int nFlags = psStrip->anSeamFlags[i];
+
+        apoPoly.push_back( psStrip->apoSeamPoly[i] );
+        psStrip->apoSeamPoly[i] = NULL;
+        anParent.push_back( iPoly );
+        anPending.push_back( ((nFlags & GP_SEAM_TOP) ? 1 : 0) +
+                             ((nFlags & GP_SEAM_BOTTOM) ? 1 : 0) );
+        anNextPart.push_back( -1 );
+        anLastPart.push_back( iPoly );
+    }
+}
+
+/************************************************************************/
+/*                               Union()                                */
+/************************************************************************/
+
+template<class DataType, class EqualityTest>
+void GPSeamStitcher<DataType, EqualityTest>::Union( int iPoly1, int iPoly2 )
+{
+    const int nRoot1 = GPFindRoot( anParent, iPoly1 );
+    const int nRoot2 = GPFindRoot( anParent, iPoly2 );
+    if( nRoot1 == nRoot2 )
+        return;
+
+    anParent[nRoot2] = nRoot1;
+    anPending[nRoot1] += anPending[nRoot2];
+    anNextPart[anLastPart[nRoot1]] = nRoot2;
+    anLastPart[nRoot1] = anLastPart[nRoot2];
+}
+
+/************************************************************************/
+/*                             StitchSeam()                             */
+/************************************************************************/
+
+template<class DataType, class EqualityTest>
+CPLErr GPSeamStitcher<DataType, EqualityTest>::StitchSeam(
+    GPStrip<DataType> *psAbove, GPStrip<DataType> *psBelow,
+    GPTiledContext<DataType> *psCtx )
+{
+    EqualityTest eq;
+    const int nXSize = psCtx->nXSize;
+    const int nY = psBelow->nYOff;
+
+    AddStrip( psAbove );
+    AddStrip( psBelow );
+
+/* -------------------------------------------------------------------- */
+/*      Merge the polygons connected across the seam, and add the       */
+/*      seam edges of the others.                                       */
+/* -------------------------------------------------------------------- */
+    for( int iX = 0; iX < nXSize; iX++ )
+    {
+        int iAbove = psAbove->anBottomPoly[iX];
+        int iBelow = psBelow->anTopPoly[iX];
+        if( iAbove >= 0 )
+            iAbove += psAbove->nFirstSeamPoly;
+        if( iBelow >= 0 )
+            iBelow += psBelow->nFirstSeamPoly;
+
+        if( iAbove >= 0 && iBelow >= 0
+            && eq.operator()(psAbove->anBottomVal[iX],
+                             psBelow->anTopVal[iX]) )
+        {
+            Union( iAbove, iBelow );
+        }
+        else
+        {
+            if( iAbove >= 0 )
+                apoPoly[iAbove]->AddSegment( iX, nY, iX+1, nY );
+            if( iBelow >= 0 )
+                apoPoly[iBelow]->AddSegment( iX, nY, iX+1, nY );
+        }
+
+        if( psCtx->nConnectedness == 8 && iAbove >= 0 )
+        {
+            for( int iXDiag = iX - 1; iXDiag <= iX + 1; iXDiag += 2 )
+            {
+                if( iXDiag < 0 || iXDiag >= nXSize
+                    || psBelow->anTopPoly[iXDiag] < 0 )
+                    continue;
+                if( eq.operator()(psAbove->anBottomVal[iX],
+                                  psBelow->anTopVal[iXDiag]) )
+                    Union( iAbove, psBelow->anTopPoly[iXDiag]
+                                   + psBelow->nFirstSeamPoly );
+            }
+        }
+    }
+
+/* -------------------------------------------------------------------- */
+/*      This seam is done.                                              */
+/* -------------------------------------------------------------------- */
+    for( size_t i = 0; i < psAbove->anSeamFlags.size(); i++ )
+    {
+        if( psAbove->anSeamFlags[i] & GP_SEAM_BOTTOM )
+            anPending[GPFindRoot(anParent,
+                                 psAbove->nFirstSeamPoly + (int)i)]--;
+    }
+    for( size_t i = 0; i < psBelow->anSeamFlags.size(); i++ )
+    {
+        if( psBelow->anSeamFlags[i] & GP_SEAM_TOP )
+            anPending[GPFindRoot(anParent,
+                                 psBelow->nFirstSeamPoly + (int)i)]--;
+    }
+
+    std::vector<GInt32>().swap( psAbove->anBottomPoly );
+    std::vector<DataType>().swap( psAbove->anBottomVal );
+    std::vector<GInt32>().swap( psBelow->anTopPoly );
+    std::vector<DataType>().swap( psBelow->anTopVal );
+
+    CPLErr eErr = EmitCompleted( psAbove, psCtx );
+    if( eErr == CE_None )
+        eErr = EmitCompleted( psBelow, psCtx );
+    return eErr;
+}
+
+/************************************************************************/
+/*                           EmitCompleted()                            */
+/*                                                                      */
+/*      Write the polygons of a strip that have no seam left to         */
+/*      stitch.                                                         */
+/************************************************************************/
+
+template<class DataType, class EqualityTest>
+CPLErr GPSeamStitcher<DataType, EqualityTest>::EmitCompleted(
+    GPStrip<DataType> *psStrip, GPTiledContext<DataType> *psCtx )
+{
+    CPLErr eErr = CE_None;
+
+    for( size_t i = 0; eErr == CE_None && i < psStrip->anSeamFlags.size(); i++ )
+    {
+        const int nRoot =
+            GPFindRoot( anParent, psStrip->nFirstSeamPoly + (int)i );
+        if( apoPoly[nRoot] == NULL || anPending[nRoot] != 0 )
+            continue;
+
+        RPolygon *poPoly = apoPoly[nRoot];
+        apoPoly[nRoot] = NULL;
+        for( int iPart = anNextPart[nRoot]; iPart >= 0;
+             iPart = anNextPart[iPart] )
+        {
+            poPoly->Absorb( apoPoly[iPart] );
+            delete apoPoly[iPart];
+            apoPoly[iPart] = NULL;
+        }
+
+        // The seam edges are added in no particular order.
+        poPoly->bCornerTouch = true;
+
+        // The calling thread holds the mutex, if any, while stitching.
+        eErr = EmitPolygonToLayer( psCtx->hOutLayer, psCtx->iPixValField,
+                                   poPoly, psCtx->adfGeoTransform,
+                                   NULL, true );
+        delete poPoly;
+    }
+
+    return eErr;
+}
+
+/************************************************************************/
+/*                        GDALPolygonizeTiledT()                        */
+/************************************************************************/
+
+template<class DataType, class EqualityTest>
+static CPLErr
+GDALPolygonizeTiledT( GDALRasterBandH hSrcBand,
+                      GDALRasterBandH hMaskBand,
+                      OGRLayerH hOutLayer, int iPixValField,
+                      int nConnectedness,
+                      int nTileHeight, int nNumThreads,
+                      GDALProgressFunc pfnProgress,
+                      void * pProgressArg,
+                      GDALDataType eDT )
+
+{
+    GPTiledContext<DataType> sCtx;
+
+    sCtx.hSrcBand = hSrcBand;
+    sCtx.hMaskBand = hMaskBand;
+    sCtx.eDT = eDT;
+    sCtx.hOutLayer = hOutLayer;
+    sCtx.iPixValField = iPixValField;
+    sCtx.nConnectedness = nConnectedness;
+    sCtx.nXSize = GDALGetRasterBandXSize( hSrcBand );
+    sCtx.nYSize = GDALGetRasterBandYSize( hSrcBand );
+    sCtx.iNextStrip = 0;
+    sCtx.hMutex = NULL;
+    sCtx.hCond = NULL;
+    sCtx.nLinesDone = 0;
+    sCtx.bStop = false;
+    sCtx.pfnProgress = pfnProgress;
+    sCtx.pProgressArg = pProgressArg;
+
+    sCtx.adfGeoTransform[0] = 0.0;
+    sCtx.adfGeoTransform[1] = 1.0;
+    sCtx.adfGeoTransform[2] = 0.0;
+    sCtx.adfGeoTransform[3] = 0.0;
+    sCtx.adfGeoTransform[4] = 0.0;
+    sCtx.adfGeoTransform[5] = 1.0;
+
+    GDALDatasetH hSrcDS = GDALGetBandDataset( hSrcBand );
+    if( hSrcDS )
+        GDALGetGeoTransform( hSrcDS, sCtx.adfGeoTransform );
+
+    for( int nYOff = 0; nYOff < sCtx.nYSize; nYOff += nTileHeight )
+    {
+        sCtx.apoStrips.push_back(
+            new GPStrip<DataType>( nYOff,
+                                   MIN(nYOff + nTileHeight, sCtx.nYSize) ) );
+    }
+    const int nStrips = static_cast<int>(sCtx.apoStrips.size());
+    if( nNumThreads > nStrips )
+        nNumThreads = nStrips;
+
+    CPLDebug( "GDALPolygonize", "Processing %d strips with %d thread(s)",
+              nStrips, nNumThreads );
+
+    GPSeamStitcher<DataType, EqualityTest> oStitcher;
+    CPLErr eErr = CE_None;
+
+/* -------------------------------------------------------------------- */
+/*      Single threaded case: process the strips in order, stitching    */
+/*      each with the previous one.                                     */
+/* -------------------------------------------------------------------- */
+    if( nNumThreads <= 1 )
+    {
+        for( int iStrip = 0; eErr == CE_None && iStrip < nStrips; iStrip++ )
+        {
+            eErr = GPPolygonizeStrip<DataType, EqualityTest>(
+                                        &sCtx, sCtx.apoStrips[iStrip] );
+            if( eErr == CE_None && iStrip > 0 )
+                eErr = oStitcher.StitchSeam( sCtx.apoStrips[iStrip-1],
+                                             sCtx.apoStrips[iStrip], &sCtx );
+        }
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Otherwise worker threads pick strips in order, and we stitch    */
+/*      seams as soon as the strips on both sides are done.             */
+/* -------------------------------------------------------------------- */
+    else
+    {
+        sCtx.hMutex = CPLCreateMutex();  // created locked
+        sCtx.hCond = CPLCreateCond();
+
+        std::vector<CPLJoinableThread*> ahThreads;
+        for( int i = 0; i < nNumThreads; i++ )
+        {
+            CPLJoinableThread *hThread = CPLCreateJoinableThread(
+                GPTiledWorker<DataType, EqualityTest>, &sCtx );
+            if( hThread != NULL )
+                ahThreads.push_back( hThread );
+        }
+        if( ahThreads.empty() )
+        {
+            CPLError( CE_Failure, CPLE_AppDefined, "Cannot create thread" );
+            eErr = CE_Failure;
+        }
+
+        int iNextSeam = 0;
+        int nLastLinesDone = 0;
+        while( eErr == CE_None )
+        {
+            while( eErr == CE_None && iNextSeam + 1 < nStrips
+                   && sCtx.apoStrips[iNextSeam]->bDone
+                   && sCtx.apoStrips[iNextSeam+1]->bDone
+                   && sCtx.apoStrips[iNextSeam]->eErr == CE_None
+                   && sCtx.apoStrips[iNextSeam+1]->eErr == CE_None )
+            {
+                eErr = oStitcher.StitchSeam( sCtx.apoStrips[iNextSeam],
+                                             sCtx.apoStrips[iNextSeam+1],
+                                             &sCtx );
+                iNextSeam++;
+            }
+
+            int nStripsDone = 0;
+            for( int iStrip = 0; iStrip < nStrips; iStrip++ )
+            {
+                if( sCtx.apoStrips[iStrip]->bDone )
+                {
+                    nStripsDone++;
+                    if( sCtx.apoStrips[iStrip]->eErr != CE_None )
+                        eErr = CE_Failure;
+                }
+            }
+            if( eErr != CE_None || sCtx.bStop || nStripsDone == nStrips )
+                break;
+
+            if( sCtx.nLinesDone != nLastLinesDone )
+            {
+                nLastLinesDone = sCtx.nLinesDone;
+                if( !pfnProgress( nLastLinesDone / (double) sCtx.nYSize,
+                                  "", pProgressArg ) )
+                {
+                    CPLError( CE_Failure, CPLE_UserInterrupt,
+                              "User terminated" );
+                    eErr = CE_Failure;
+                    break;
+                }
+            }
+
+            CPLCondWait( sCtx.hCond, sCtx.hMutex );
+        }
+
+        sCtx.bStop = true;
+        CPLReleaseMutex( sCtx.hMutex );
+
+        for( size_t i = 0; i < ahThreads.size(); i++ )
+            CPLJoinThread( ahThreads[i] );
+
+        CPLDestroyCond( sCtx.hCond );
+        CPLDestroyMutex( sCtx.hMutex );
+    }
+
+    for( int iStrip = 0; iStrip < nStrips; iStrip++ )
+        delete sCtx.apoStrips[iStrip];
+
+    if( eErr == CE_None )
+        pfnProgress( 1.0, "", pProgressArg );
+
+    return eErr;
+}
+
 /************************************************************************/
 /*                           GDALPolygonizeT()                          */
 /************************************************************************/
@@ -464,6 +1629,41 @@ GDALPolygonizeT( GDALRasterBandH hSrcBand,
         return CE_Failure;
     }
 
+/* -------------------------------------------------------------------- */
+/*      Use the tiled single pass algorithm if requested.               */
+/* -------------------------------------------------------------------- */
+    int nNumThreads = 1;
+    const char *pszNumThreads = CSLFetchNameValue( papszOptions, "NUM_THREADS" );
+    if( pszNumThreads != NULL )
+    {
+        if( EQUAL(pszNumThreads, "ALL_CPUS") )
+            nNumThreads = CPLGetNumCPUs();
+        else
+            nNumThreads = atoi(pszNumThreads);
+        if( nNumThreads > 128 )
+            nNumThreads = 128;
+        if( nNumThreads < 1 )
+            nNumThreads = 1;
+    }
+
+    const char *pszTileHeight = CSLFetchNameValue( papszOptions, "TILE_HEIGHT" );
+    if( nNumThreads > 1 || pszTileHeight != NULL
+        || CPLFetchBool( (const char**) papszOptions, "TILED", false ) )
+    {
+        const int nYSize = GDALGetRasterBandYSize( hSrcBand );
+        int nTileHeight;
+        if( pszTileHeight != NULL )
+            nTileHeight = MAX(1, atoi(pszTileHeight));
+        else
+            nTileHeight = MIN(1024, (nYSize + nNumThreads - 1) / nNumThreads);
+        if( nTileHeight < 1 )
+            nTileHeight = 1;
+
+        return GDALPolygonizeTiledT<DataType, EqualityTest>(
+            hSrcBand, hMaskBand, hOutLayer, iPixValField, nConnectedness,
+            nTileHeight, nNumThreads, pfnProgress, pProgressArg, eDT );
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Allocate working buffers.                                       */
 /* -------------------------------------------------------------------- */
@@ -622,6 +1822,11 @@ GDALPolygonizeT( GDALRasterBandH hSrcBand,
                       oFirstEnum.panPolyIdMap, oFirstEnum.panPolyValue,
                       papoPoly, iX, iY );
         }
+        if( nConnectedness == 8 && iY > 0 && iY < nYSize )
+            FlagCornerTouches<DataType, EqualityTest>(
+                panLastLineId + 1, panThisLineId + 1,
+                panLastLineVal, panThisLineVal,
+                oFirstEnum.panPolyIdMap, papoPoly, nXSize );
 
 /* -------------------------------------------------------------------- */
 /*      Periodically we scan out polygons and write out those that      */
@@ -638,7 +1843,8 @@ GDALPolygonizeT( GDALRasterBandH hSrcBand,
                 {
                     eErr =
                         EmitPolygonToLayer( hOutLayer, iPixValField,
-                                            papoPoly[iX], adfGeoTransform );
+                                            papoPoly[iX], adfGeoTransform,
+                                            NULL, nConnectedness == 8 );
 
                     delete papoPoly[iX];
                     papoPoly[iX] = NULL;
@@ -679,7 +1885,8 @@ GDALPolygonizeT( GDALRasterBandH hSrcBand,
         {
             eErr =
                 EmitPolygonToLayer( hOutLayer, iPixValField,
-                                    papoPoly[iX], adfGeoTransform );
+                                    papoPoly[iX], adfGeoTransform,
+                                    NULL, nConnectedness == 8 );
 
             delete papoPoly[iX];
             papoPoly[iX] = NULL;
@@ -804,6 +2011,19 @@ GBool GDALFloatEquals(float A, float B)
  * <dl>
  * <dt>"8CONNECTED":</dt> May be set to "8" to use 8 connectedness.
  * Otherwise 4 connectedness will be applied to the algorithm
+ * <dt>"TILED":</dt> (GDAL &gt;= 2.2) May be set to "YES" to process the
+ * raster in a single pass, by strips of lines.  Polygons are written as
+ * soon as they are complete, and polygons crossing strip boundaries are
+ * stitched together, so that memory use only depends on the raster width
+ * and not on the number of polygons.  The order in which features are
+ * written differs from the default mode.
+ * <dt>"TILE_HEIGHT":</dt> (GDAL &gt;= 2.2) Height in lines of the strips.
+ * Implies TILED=YES.  Defaults to 1024, or less so that each thread gets at
+ * least one strip.
+ * <dt>"NUM_THREADS":</dt> (GDAL &gt;= 2.2) Number of worker threads
+ * processing strips, or ALL_CPUS.  A value greater than 1 implies
+ * TILED=YES.  Raster reads and feature writes are serialized, so the
+ * order of the output features is not deterministic.  Defaults to 1.
  * </dl>
  * @param pfnProgress callback for reporting algorithm progress matching the
  * GDALProgressFunc() semantics.  May be NULL.
@@ -881,6 +2101,19 @@ GDALPolygonize( GDALRasterBandH hSrcBand,
  * <dl>
  * <dt>"8CONNECTED":</dt> May be set to "8" to use 8 connectedness.
  * Otherwise 4 connectedness will be applied to the algorithm
+ * <dt>"TILED":</dt> (GDAL &gt;= 2.2) May be set to "YES" to process the
+ * raster in a single pass, by strips of lines.  Polygons are written as
+ * soon as they are complete, and polygons crossing strip boundaries are
+ * stitched together, so that memory use only depends on the raster width
+ * and not on the number of polygons.  The order in which features are
+ * written differs from the default mode.
+ * <dt>"TILE_HEIGHT":</dt> (GDAL &gt;= 2.2) Height in lines of the strips.
+ * Implies TILED=YES.  Defaults to 1024, or less so that each thread gets at
+ * least one strip.
+ * <dt>"NUM_THREADS":</dt> (GDAL &gt;= 2.2) Number of worker threads
+ * processing strips, or ALL_CPUS.  A value greater than 1 implies
+ * TILED=YES.  Raster reads and feature writes are serialized, so the
+ * order of the output features is not deterministic.  Defaults to 1.
  * </dl>
  * @param pfnProgress callback for reporting algorithm progress matching the
  * GDALProgressFunc() semantics.  May be NULL.
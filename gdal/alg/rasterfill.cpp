@@ -32,6 +32,10 @@
 #include "gdal_alg.h"
 #include "cpl_conv.h"
 #include "cpl_string.h"
+#include "cpl_worker_thread_pool.h"
+
+#include <new>
+#include <vector>
 
 CPL_CVSID("$Id$");
 
@@ -127,224 +131,527 @@ GDALFilterLine( float *pafLastLine, float *pafThisLine, float *pafNextLine,
 }
 
 /************************************************************************/
-/*                          GDALMultiFilter()                           */
-/*                                                                      */
-/*      Apply multiple iterations of a 3x3 smoothing filter over a      */
-/*      band with masking controlling what pixels should be             */
-/*      filtered (FiltMaskBand non zero) and which pixels can be        */
-/*      considered valid contributors to the filter                     */
-/*      (TargetMaskBand non zero).                                      */
+/*                        GDALFillNodataParams                          */
 /*                                                                      */
-/*      This implementation attempts to apply many iterations in        */
-/*      one IO pass by managing the filtering over a rolling buffer     */
-/*      of nIternations+2 scanlines.  While possibly clever this        */
-/*      makes the algorithm implementation largely                      */
-/*      incomprehensible.                                               */
+/*      The raster is processed by strips of lines, possibly by         */
+/*      several threads.  The interpolation of a pixel only depends     */
+/*      on the nearest valid pixel above and below it in each column,   */
+/*      so a strip only needs, for each column, the last valid pixel    */
+/*      above it and the first valid pixel below it.  The former is     */
+/*      carried from strip to strip, the latter is collected by a       */
+/*      first pass over the raster.  The smoothing filter passes only   */
+/*      see one line further at each iteration, so strips are read      */
+/*      with a halo of nSmoothingIterations lines.                      */
 /************************************************************************/
 
-static CPLErr
-GDALMultiFilter( GDALRasterBandH hTargetBand,
-                 GDALRasterBandH hTargetMaskBand,
-                 GDALRasterBandH hFiltMaskBand,
-                 int nIterations,
-                 GDALProgressFunc pfnProgress,
-                 void * pProgressArg )
+typedef struct
+{
+    int         nXSize;
+    int         nYSize;
+    double      dfMaxSearchDist;
+    int         nMaxSearchDist;
+    int         bTransformSearch;
+    int         nSmoothingIterations;
+    GDALDataType eBandType;
+} GDALFillNodataParams;
+
+typedef struct
+{
+    const GDALFillNodataParams *psParams;
+
+    // Lines read, halo included.
+    int         nYOff;
+    int         nLines;
+    // Lines written.
+    int         nOutYOff;
+    int         nOutLines;
+
+    std::vector<float> afData;      // values, filled in place
+    std::vector<GByte> abyMask;     // zero for pixels to fill
+
+    // For each column, last valid line above nYOff and its value, and
+    // first valid line from nYOff+nLines and its value.  -1 if none.
+    std::vector<GInt32> anTopSeedY;
+    std::vector<float>  afTopSeedValue;
+    std::vector<GInt32> anBottomSeedY;
+    std::vector<float>  afBottomSeedValue;
+
+    bool        bModified;
+} GDALFillNodataStrip;
+
+/************************************************************************/
+/*                        GDALFillNodataCheck()                         */
+/*                                                                      */
+/*      Check whether a candidate is nearer than the existing closest   */
+/*      point of a quadrant.                                            */
+/************************************************************************/
 
+static inline void GDALFillNodataCheck( double &dfQuadDist,
+                                        double &dfQuadValue,
+                                        int nTargetX, GInt32 nTargetY,
+                                        int nOriginX, int nOriginY,
+                                        float fTargetValue )
 {
-    float *paf3PassLineBuf;
-    GByte *pabyTMaskBuf;
-    GByte *pabyFMaskBuf;
-    float *pafThisPass, *pafLastPass, *pafSLastPass;
-
-    int   nBufLines = nIterations + 2;
-    int   iPassCounter = 0;
-    int   nNewLine; // the line being loaded this time (zero based scanline)
-    int   nXSize = GDALGetRasterBandXSize( hTargetBand );
-    int   nYSize = GDALGetRasterBandYSize( hTargetBand );
-    CPLErr eErr = CE_None;
+    if( nTargetY < 0 )
+        return;
 
-/* -------------------------------------------------------------------- */
-/*      Report starting progress value.                                 */
-/* -------------------------------------------------------------------- */
-    if( !pfnProgress( 0.0, "Smoothing Filter...", pProgressArg ) )
+    double dfDx = (double)nTargetX - (double)nOriginX;
+    double dfDy = (double)nTargetY - (double)nOriginY;
+    double dfDistSq = dfDx * dfDx + dfDy * dfDy;
+
+    if( dfDistSq < dfQuadDist * dfQuadDist )
     {
-        CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
-        return CE_Failure;
+        CPLAssert( dfDistSq > 0.0 );
+        dfQuadDist = sqrt(dfDistSq);
+        dfQuadValue = fTargetValue;
     }
+}
 
-/* -------------------------------------------------------------------- */
-/*      Allocate rotating buffers.                                      */
-/* -------------------------------------------------------------------- */
-    pabyTMaskBuf = (GByte *) VSI_MALLOC2_VERBOSE(nXSize, nBufLines);
-    pabyFMaskBuf = (GByte *) VSI_MALLOC2_VERBOSE(nXSize, nBufLines);
+/************************************************************************/
+/*                     GDALFillNodataConicSearch()                      */
+/*                                                                      */
+/*      Step left and right by one pixel searching for the closest      */
+/*      target value for each quadrant.  panTopY / panBottomY give      */
+/*      for each column the line of the nearest valid pixel above       */
+/*      (current line included) and below (current line excluded)       */
+/*      within the search distance, or -1.                              */
+/************************************************************************/
+
+static void
+GDALFillNodataConicSearch( const GDALFillNodataParams *psParams,
+                           int iX, int iY,
+                           const GInt32 *panTopY, const float *pafTopValue,
+                           const GInt32 *panBottomY,
+                           const float *pafBottomValue,
+                           double *padfQuadDist, double *padfQuadValue )
+{
+    const int nXSize = psParams->nXSize;
+    int nThisMaxSearchDist = psParams->nMaxSearchDist;
 
-    paf3PassLineBuf = (float *) VSI_MALLOC3_VERBOSE(nXSize, nBufLines, 3 * sizeof(float));
-    if (pabyTMaskBuf == NULL || pabyFMaskBuf == NULL || paf3PassLineBuf == NULL)
+    // Quadrants 0:topleft, 1:bottomleft, 2:topright, 3:bottomright
+    for( int iQuad = 0; iQuad < 4; iQuad++ )
     {
-        eErr = CE_Failure;
-        goto end;
+        padfQuadDist[iQuad] = psParams->dfMaxSearchDist + 1.0;
+        padfQuadValue[iQuad] = 0.0;
     }
 
-/* -------------------------------------------------------------------- */
-/*      Process rotating buffers.                                       */
-/* -------------------------------------------------------------------- */
-    for( nNewLine = 0;
-         eErr == CE_None && nNewLine < nYSize+nIterations;
-         nNewLine++ )
+    for( int iStep = 0; iStep < nThisMaxSearchDist; iStep++ )
     {
-/* -------------------------------------------------------------------- */
-/*      Rotate pass buffers.                                            */
-/* -------------------------------------------------------------------- */
-        iPassCounter = (iPassCounter + 1) % 3;
+        const int iLeftX = MAX(0,iX - iStep);
+        const int iRightX = MIN(nXSize-1,iX + iStep);
 
-        pafSLastPass = paf3PassLineBuf
-            + ((iPassCounter+0)%3) * nXSize*nBufLines;
-        pafLastPass = paf3PassLineBuf
-            + ((iPassCounter+1)%3) * nXSize*nBufLines;
-        pafThisPass = paf3PassLineBuf
-            + ((iPassCounter+2)%3) * nXSize*nBufLines;
+        // top left includes current line
+        GDALFillNodataCheck( padfQuadDist[0], padfQuadValue[0],
+                             iLeftX, panTopY[iLeftX], iX, iY,
+                             pafTopValue[iLeftX] );
 
-/* -------------------------------------------------------------------- */
-/*      Where does the new line go in the rotating buffer?              */
-/* -------------------------------------------------------------------- */
-        int iBufOffset = nNewLine % nBufLines;
+        // bottom left
+        GDALFillNodataCheck( padfQuadDist[1], padfQuadValue[1],
+                             iLeftX, panBottomY[iLeftX], iX, iY,
+                             pafBottomValue[iLeftX] );
 
-/* -------------------------------------------------------------------- */
-/*      Read the new data line if it is't off the bottom of the         */
-/*      image.                                                          */
-/* -------------------------------------------------------------------- */
-        if( nNewLine < nYSize )
-        {
-            eErr =
-                GDALRasterIO( hTargetMaskBand, GF_Read,
-                              0, nNewLine, nXSize, 1,
-                              pabyTMaskBuf + nXSize * iBufOffset, nXSize, 1,
-                              GDT_Byte, 0, 0 );
+        // top right and bottom right do no include center pixel.
+        if( iStep == 0 )
+            continue;
 
-            if( eErr != CE_None )
-                break;
+        // top right includes current line
+        GDALFillNodataCheck( padfQuadDist[2], padfQuadValue[2],
+                             iRightX, panTopY[iRightX], iX, iY,
+                             pafTopValue[iRightX] );
+
+        // bottom right
+        GDALFillNodataCheck( padfQuadDist[3], padfQuadValue[3],
+                             iRightX, panBottomY[iRightX], iX, iY,
+                             pafBottomValue[iRightX] );
+
+        // every four steps, recompute maximum distance.
+        if( (iStep & 0x3) == 0 )
+            nThisMaxSearchDist = (int) floor(
+                MAX(MAX(padfQuadDist[0],padfQuadDist[1]),
+                    MAX(padfQuadDist[2],padfQuadDist[3])) );
+    }
+}
 
-            eErr =
-                GDALRasterIO( hFiltMaskBand, GF_Read,
-                              0, nNewLine, nXSize, 1,
-                              pabyFMaskBuf + nXSize * iBufOffset, nXSize, 1,
-                              GDT_Byte, 0, 0 );
+/************************************************************************/
+/*                    GDALFillNodataNearestOnSide()                     */
+/*                                                                      */
+/*      For each pixel of line iY, find the nearest candidate among     */
+/*      the columns on its left (current column included) or on its     */
+/*      right (current column excluded), where each column has at      */
+/*      most one candidate given by panCandY.  This is the second       */
+/*      stage of a separable euclidean distance transform, with the     */
+/*      lower envelope of the parabolas (x-x')^2 + (iY-y')^2 built      */
+/*      while moving along the line.                                    */
+/************************************************************************/
 
-            if( eErr != CE_None )
-                break;
+static void
+GDALFillNodataNearestOnSide( int nXSize, int iY, bool bLeft,
+                             const GInt32 *panCandY, const float *pafCandValue,
+                             double dfNoneDist,
+                             double *padfDist, double *padfValue,
+                             int *panV, double *padfZ )
+{
+    // Positions are counted along the walk: from the left edge for the
+    // left side, from the right edge for the right side.
+    int k = -1;     // last parabola of the envelope
+    int j = 0;      // parabola of the envelope at the current position
 
-            eErr =
-                GDALRasterIO( hTargetBand, GF_Read,
-                              0, nNewLine, nXSize, 1,
-                              pafThisPass + nXSize * iBufOffset, nXSize, 1,
-                              GDT_Float32, 0, 0 );
+    for( int i = 0; i < nXSize; i++ )
+    {
+        const int iX = bLeft ? i : nXSize - 1 - i;
 
-            if( eErr != CE_None )
-                break;
+        for( int iPass = 0; iPass < 2; iPass++ )
+        {
+            // The left side includes the current column, so insert its
+            // candidate before querying.  The right side excludes it.
+            if( (iPass == 0) != bLeft )
+            {
+                if( k < 0 )
+                {
+                    // Like the conic search, the right side of the last
+                    // column is the column itself.
+                    if( i == 0 && panCandY[iX] >= 0 )
+                    {
+                        padfDist[iX] = fabs( (double)panCandY[iX] - iY );
+                        padfValue[iX] = pafCandValue[iX];
+                    }
+                    else
+                    {
+                        padfDist[iX] = dfNoneDist;
+                        padfValue[iX] = 0.0;
+                    }
+                    continue;
+                }
+                j = MIN(j, k);
+                while( j > 0 && padfZ[j] > i )
+                    j--;
+                while( j < k && padfZ[j+1] <= i )
+                    j++;
+                const int iCandX = bLeft ? panV[j] : nXSize - 1 - panV[j];
+                const double dfDx = panV[j] - i;
+                const double dfDy = panCandY[iCandX] - iY;
+                padfDist[iX] = sqrt( dfDx * dfDx + dfDy * dfDy );
+                padfValue[iX] = pafCandValue[iCandX];
+            }
+            else if( panCandY[iX] >= 0 )
+            {
+                const double dfDy = panCandY[iX] - iY;
+                const double dfF = dfDy * dfDy + (double)i * i;
+                if( k < 0 )
+                {
+                    k = 0;
+                    panV[0] = i;
+                    padfZ[0] = -HUGE_VAL;
+                    continue;
+                }
+                double dfS;
+                while( true )
+                {
+                    const int iPrevX = bLeft ? panV[k] : nXSize - 1 - panV[k];
+                    const double dfPrevDy = panCandY[iPrevX] - iY;
+                    dfS = (dfF - (dfPrevDy * dfPrevDy
+                                  + (double)panV[k] * panV[k]))
+                          / (2.0 * (i - panV[k]));
+                    if( dfS > padfZ[k] )
+                        break;
+                    k--;
+                }
+                k++;
+                panV[k] = i;
+                padfZ[k] = dfS;
+            }
         }
+    }
+}
 
-/* -------------------------------------------------------------------- */
-/*      Loop over the loaded data, applying the filter to all loaded    */
-/*      lines with neighbours.                                          */
-/* -------------------------------------------------------------------- */
-        int iFLine;
+/************************************************************************/
+/*                       GDALFillNodataSmooth()                         */
+/*                                                                      */
+/*      Apply nSmoothingIterations passes of the 3x3 averaging filter   */
+/*      to the filled pixels of a strip (pabyFiltMask non zero), using  */
+/*      the valid and filled pixels as contributors (pabyTargetMask     */
+/*      non zero).  Lines at distance d of the edges of the strip are   */
+/*      exact up to iteration d, so only the lines of the strip out of  */
+/*      the halo are exact in the end.  The first and last lines of     */
+/*      the raster are not filtered.                                    */
+/************************************************************************/
 
-        for( iFLine = nNewLine-1;
-             eErr == CE_None && iFLine >= nNewLine-nIterations;
-             iFLine-- )
-        {
-            int iLastOffset, iThisOffset, iNextOffset;
+static void GDALFillNodataSmooth( GDALFillNodataStrip *psStrip,
+                                  const GByte *pabyTargetMask,
+                                  const GByte *pabyFiltMask )
+{
+    const GDALFillNodataParams *psParams = psStrip->psParams;
+    const int nXSize = psParams->nXSize;
+    const int nLines = psStrip->nLines;
 
-            iLastOffset = (iFLine-1) % nBufLines;
-            iThisOffset = (iFLine  ) % nBufLines;
-            iNextOffset = (iFLine+1) % nBufLines;
+    std::vector<float> afOtherPass( psStrip->afData.size() );
+    float *pafLastPass = &(psStrip->afData[0]);
+    float *pafThisPass = &(afOtherPass[0]);
 
-            // default to preserving the old value.
-            if( iFLine >= 0 )
-                memcpy( pafThisPass + iThisOffset * nXSize,
-                        pafLastPass + iThisOffset * nXSize,
-                        sizeof(float) * nXSize );
+    for( int iIter = 0; iIter < psParams->nSmoothingIterations; iIter++ )
+    {
+        for( int iLine = 0; iLine < nLines; iLine++ )
+        {
+            const int iY = psStrip->nYOff + iLine;
+            const size_t nOffset = static_cast<size_t>(iLine) * nXSize;
 
-            // currently this skips the first and last line.  Eventually
-            // we will enable these too.  TODO
-            if( iFLine < 1 || iFLine >= nYSize-1 )
+            if( iLine == 0 || iLine == nLines - 1 ||
+                iY < 1 || iY >= psParams->nYSize - 1 )
             {
+                memcpy( pafThisPass + nOffset, pafLastPass + nOffset,
+                        sizeof(float) * nXSize );
                 continue;
             }
 
-            GDALFilterLine(
-                pafSLastPass + iLastOffset * nXSize,
-                pafLastPass  + iThisOffset * nXSize,
-                pafThisPass  + iNextOffset * nXSize,
-                pafThisPass  + iThisOffset * nXSize,
-                pabyTMaskBuf + iLastOffset * nXSize,
-                pabyTMaskBuf + iThisOffset * nXSize,
-                pabyTMaskBuf + iNextOffset * nXSize,
-                pabyFMaskBuf + iThisOffset * nXSize,
-                nXSize );
+            GDALFilterLine( pafLastPass + nOffset - nXSize,
+                            pafLastPass + nOffset,
+                            pafLastPass + nOffset + nXSize,
+                            pafThisPass + nOffset,
+                            const_cast<GByte*>(pabyTargetMask) + nOffset - nXSize,
+                            const_cast<GByte*>(pabyTargetMask) + nOffset,
+                            const_cast<GByte*>(pabyTargetMask) + nOffset + nXSize,
+                            const_cast<GByte*>(pabyFiltMask) + nOffset,
+                            nXSize );
         }
 
+        float *pafTmp = pafLastPass;
+        pafLastPass = pafThisPass;
+        pafThisPass = pafTmp;
+    }
+
+    if( pafLastPass != &(psStrip->afData[0]) )
+        psStrip->afData.swap( afOtherPass );
+}
+
+/************************************************************************/
+/*                       GDALFillNodataStripJob()                       */
+/************************************************************************/
+
+static void GDALFillNodataStripJob( void *pData )
+
+{
+    GDALFillNodataStrip *psStrip = (GDALFillNodataStrip *) pData;
+    const GDALFillNodataParams *psParams = psStrip->psParams;
+    const int nXSize = psParams->nXSize;
+    const int nLines = psStrip->nLines;
+    const double dfMaxSearchDist = psParams->dfMaxSearchDist;
+    float *pafData = &(psStrip->afData[0]);
+    const GByte *pabyMask = &(psStrip->abyMask[0]);
+
+    psStrip->bModified = false;
+
 /* -------------------------------------------------------------------- */
-/*      Write out the top data line that will be rolling out of our     */
-/*      buffer.                                                         */
+/*      Collect from top to bottom the last valid line of each          */
+/*      column, current line included.                                  */
 /* -------------------------------------------------------------------- */
-        int iLineToSave = nNewLine - nIterations;
-
-        if( iLineToSave >= 0 && eErr == CE_None )
+    std::vector<GInt32> anTopDownY( static_cast<size_t>(nLines) * nXSize );
+    for( int iLine = 0; iLine < nLines; iLine++ )
+    {
+        const size_t nOffset = static_cast<size_t>(iLine) * nXSize;
+        const GInt32 *panLastY = iLine == 0 ?
+            &(psStrip->anTopSeedY[0]) : &(anTopDownY[nOffset - nXSize]);
+        for( int iX = 0; iX < nXSize; iX++ )
         {
-            iBufOffset = iLineToSave % nBufLines;
-
-            eErr =
-                GDALRasterIO( hTargetBand, GF_Write,
-                              0, iLineToSave, nXSize, 1,
-                              pafThisPass + nXSize * iBufOffset, nXSize, 1,
-                              GDT_Float32, 0, 0 );
+            anTopDownY[nOffset + iX] = pabyMask[nOffset + iX] ?
+                psStrip->nYOff + iLine : panLastY[iX];
         }
+    }
 
 /* -------------------------------------------------------------------- */
-/*      Report progress.                                                */
+/*      Now go from bottom to top collecting the first valid line       */
+/*      below each pixel, and interpolate the pixels that are nodata.   */
 /* -------------------------------------------------------------------- */
-        if( eErr == CE_None
-            && !pfnProgress( (nNewLine+1) / (double) (nYSize+nIterations),
-                             "Smoothing Filter...", pProgressArg ) )
+    std::vector<GInt32> anBottomUpY( psStrip->anBottomSeedY );
+    std::vector<float>  afBottomUpValue( psStrip->afBottomSeedValue );
+    std::vector<GInt32> anTopY( nXSize );
+    std::vector<float>  afTopValue( nXSize );
+    std::vector<GInt32> anBottomY( nXSize );
+    std::vector<float>  afBottomValue( nXSize );
+    std::vector<GByte>  abyFiltMask( static_cast<size_t>(nLines) * nXSize, 0 );
+
+    std::vector<double> adfSideDist;
+    std::vector<double> adfSideValue;
+    std::vector<int>    anV;
+    std::vector<double> adfZ;
+    if( psParams->bTransformSearch )
+    {
+        adfSideDist.resize( 4 * static_cast<size_t>(nXSize) );
+        adfSideValue.resize( 4 * static_cast<size_t>(nXSize) );
+        anV.resize( nXSize );
+        adfZ.resize( nXSize + 1 );
+    }
+
+    for( int iLine = nLines - 1; iLine >= 0; iLine-- )
+    {
+        const int iY = psStrip->nYOff + iLine;
+        const size_t nOffset = static_cast<size_t>(iLine) * nXSize;
+
+        bool bHasNodata = false;
+        for( int iX = 0; iX < nXSize; iX++ )
         {
-            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
-            eErr = CE_Failure;
+            if( !pabyMask[nOffset + iX] )
+            {
+                bHasNodata = true;
+                break;
+            }
+        }
+
+        if( bHasNodata )
+        {
+            // Candidates within the search distance.  The bottom ones
+            // are relative to the next line.
+            for( int iX = 0; iX < nXSize; iX++ )
+            {
+                GInt32 nY = anTopDownY[nOffset + iX];
+                if( nY >= 0 && iY - nY <= dfMaxSearchDist )
+                {
+                    anTopY[iX] = nY;
+                    afTopValue[iX] = nY >= psStrip->nYOff ?
+                        pafData[static_cast<size_t>(nY - psStrip->nYOff)
+                                * nXSize + iX] :
+                        psStrip->afTopSeedValue[iX];
+                }
+                else
+                    anTopY[iX] = -1;
+
+                nY = anBottomUpY[iX];
+                if( nY >= 0 && nY - (iY + 1) <= dfMaxSearchDist )
+                {
+                    anBottomY[iX] = nY;
+                    afBottomValue[iX] = afBottomUpValue[iX];
+                }
+                else
+                    anBottomY[iX] = -1;
+            }
+
+            // The last line has nothing below: its bottom quadrants are
+            // searched with the top candidates, which gives the same
+            // weighting but bounds the conic search the same way.
+            if( iY == psParams->nYSize - 1 )
+            {
+                anBottomY = anTopY;
+                afBottomValue = afTopValue;
+            }
+
+            if( psParams->bTransformSearch )
+            {
+                const double dfNoneDist = dfMaxSearchDist + 1.0;
+                GDALFillNodataNearestOnSide( nXSize, iY, true,
+                                             &anTopY[0], &afTopValue[0],
+                                             dfNoneDist,
+                                             &adfSideDist[0],
+                                             &adfSideValue[0],
+                                             &anV[0], &adfZ[0] );
+                GDALFillNodataNearestOnSide( nXSize, iY, true,
+                                             &anBottomY[0], &afBottomValue[0],
+                                             dfNoneDist,
+                                             &adfSideDist[nXSize],
+                                             &adfSideValue[nXSize],
+                                             &anV[0], &adfZ[0] );
+                GDALFillNodataNearestOnSide( nXSize, iY, false,
+                                             &anTopY[0], &afTopValue[0],
+                                             dfNoneDist,
+                                             &adfSideDist[2 * nXSize],
+                                             &adfSideValue[2 * nXSize],
+                                             &anV[0], &adfZ[0] );
+                GDALFillNodataNearestOnSide( nXSize, iY, false,
+                                             &anBottomY[0], &afBottomValue[0],
+                                             dfNoneDist,
+                                             &adfSideDist[3 * nXSize],
+                                             &adfSideValue[3 * nXSize],
+                                             &anV[0], &adfZ[0] );
+            }
+
+            for( int iX = 0; iX < nXSize; iX++ )
+            {
+                // If this was a valid target - no change.
+                if( pabyMask[nOffset + iX] )
+                    continue;
+
+                double adfQuadDist[4];
+                double adfQuadValue[4];
+
+                if( psParams->bTransformSearch )
+                {
+                    for( int iQuad = 0; iQuad < 4; iQuad++ )
+                    {
+                        adfQuadDist[iQuad] =
+                            adfSideDist[iQuad * nXSize + iX];
+                        adfQuadValue[iQuad] =
+                            adfSideValue[iQuad * nXSize + iX];
+                    }
+                }
+                else
+                {
+                    GDALFillNodataConicSearch( psParams, iX, iY,
+                                               &anTopY[0], &afTopValue[0],
+                                               &anBottomY[0],
+                                               &afBottomValue[0],
+                                               adfQuadDist, adfQuadValue );
+                }
+
+                double dfWeightSum = 0.0;
+                double dfValueSum = 0.0;
+
+                for( int iQuad = 0; iQuad < 4; iQuad++ )
+                {
+                    if( adfQuadDist[iQuad] <= dfMaxSearchDist )
+                    {
+                        double dfWeight = 1.0 / adfQuadDist[iQuad];
+
+                        dfWeightSum += dfWeight;
+                        dfValueSum += adfQuadValue[iQuad] * dfWeight;
+                    }
+                }
+
+                if( dfWeightSum > 0.0 )
+                {
+                    abyFiltMask[nOffset + iX] = 255;
+                    pafData[nOffset + iX] = (float) (dfValueSum / dfWeightSum);
+                    if( iY >= psStrip->nOutYOff &&
+                        iY < psStrip->nOutYOff + psStrip->nOutLines )
+                        psStrip->bModified = true;
+                }
+            }
+        }
+
+        // Update the first valid line below for the next line (from the
+        // original values: valid pixels are not modified).
+        for( int iX = 0; iX < nXSize; iX++ )
+        {
+            if( pabyMask[nOffset + iX] )
+            {
+                anBottomUpY[iX] = iY;
+                afBottomUpValue[iX] = pafData[nOffset + iX];
+            }
         }
     }
 
 /* -------------------------------------------------------------------- */
-/*      Cleanup                                                         */
+/*      Smooth the interpolated values.  The filter works on the        */
+/*      values as stored in the band.                                   */
 /* -------------------------------------------------------------------- */
-end:
-    CPLFree( pabyTMaskBuf );
-    CPLFree( pabyFMaskBuf );
-    CPLFree( paf3PassLineBuf );
+    if( psParams->nSmoothingIterations > 0 && psStrip->bModified )
+    {
+        const size_t nPixels = static_cast<size_t>(nLines) * nXSize;
+        if( psParams->eBandType != GDT_Float32 )
+        {
+            const int nDTSize = GDALGetDataTypeSizeBytes( psParams->eBandType );
+            std::vector<GByte> abyTmp( nPixels * nDTSize );
+            GDALCopyWords( pafData, GDT_Float32, sizeof(float),
+                           &abyTmp[0], psParams->eBandType, nDTSize,
+                           static_cast<int>(nPixels) );
+            GDALCopyWords( &abyTmp[0], psParams->eBandType, nDTSize,
+                           pafData, GDT_Float32, sizeof(float),
+                           static_cast<int>(nPixels) );
+        }
 
-    return eErr;
-}
+        std::vector<GByte> abyTargetMask( nPixels );
+        for( size_t i = 0; i < nPixels; i++ )
+            abyTargetMask[i] = pabyMask[i] | abyFiltMask[i];
 
-/************************************************************************/
-/*                             QUAD_CHECK()                             */
-/*                                                                      */
-/*      macro for checking whether a point is nearer than the           */
-/*      existing closest point.                                         */
-/************************************************************************/
-#define QUAD_CHECK(quad_dist, quad_value, 				\
-target_x, target_y, origin_x, origin_y, target_value )			\
-									\
-if( quad_value != nNoDataVal ) 						\
-{									\
-    double dfDx = (double)target_x - (double)origin_x;			\
-    double dfDy = (double)target_y - (double)origin_y;			\
-    double dfDistSq = dfDx * dfDx + dfDy * dfDy;			\
-    									\
-    if( dfDistSq < quad_dist*quad_dist )				\
-    {									\
-	CPLAssert( dfDistSq > 0.0 );                                    \
-        quad_dist = sqrt(dfDistSq); 					\
-        quad_value = target_value;					\
-    }									\
+        GDALFillNodataSmooth( psStrip, &abyTargetMask[0], &abyFiltMask[0] );
+    }
 }
 
 /************************************************************************/
@@ -369,6 +676,9 @@ if( quad_value != nNoDataVal ) 						\
  * is generally not so great for interpolating a raster from sparse
  * point data - see the algorithms defined in gdal_grid.h for that case.
  *
+ * Starting with GDAL 2.2, the raster is processed in memory by strips of
+ * lines, and no temporary file is used any longer.
+ *
  * @param hTargetBand the raster band to be modified in place.
  * @param hMaskBand a mask band indicating pixels to be interpolated (zero valued
  * @param dfMaxSearchDist the maximum number of pixels to search in all
@@ -376,8 +686,19 @@ if( quad_value != nNoDataVal ) 						\
  * @param bDeprecatedOption unused argument, should be zero.
  * @param nSmoothingIterations the number of 3x3 smoothing filter passes to
  * run (0 or more).
- * @param papszOptions additional name=value options in a string list (the
- * temporary file driver can be specified like TEMP_FILE_DRIVER=MEM).
+ * @param papszOptions additional name=value options in a string list:
+ * <ul>
+ * <li>NUM_THREADS=number or ALL_CPUS: (GDAL &gt;= 2.2) number of worker
+ * threads processing strips.  Defaults to the value of the GDAL_NUM_THREADS
+ * configuration option, or 1.  The result does not depend on it.</li>
+ * <li>SEARCH=CONIC/TRANSFORM: (GDAL &gt;= 2.2) how the nearest valid pixel of
+ * each quadrant is found.  CONIC (the default) steps left and right from
+ * the pixel, with a cost proportional to the distance to the values.
+ * TRANSFORM derives the exact nearest pixels of each line from the lower
+ * envelope of a distance transform, with a cost independent of the
+ * distance, which is much faster on large voids.</li>
+ * <li>TEMP_FILE_DRIVER: ignored since GDAL 2.2.</li>
+ * </ul>
  * @param pfnProgress the progress function to report completion.
  * @param pProgressArg callback data for progress function.
  *
@@ -397,435 +718,281 @@ GDALFillNodata( GDALRasterBandH hTargetBand,
 {
     VALIDATE_POINTER1( hTargetBand, "GDALFillNodata", CE_Failure );
 
-    int nXSize = GDALGetRasterBandXSize( hTargetBand );
-    int nYSize = GDALGetRasterBandYSize( hTargetBand );
+    const int nXSize = GDALGetRasterBandXSize( hTargetBand );
+    const int nYSize = GDALGetRasterBandYSize( hTargetBand );
     CPLErr eErr = CE_None;
 
-    // Special "x" pixel values identifying pixels as special.
-    GUInt32 nNoDataVal;
-    GDALDataType eType;
-
     if( dfMaxSearchDist == 0.0 )
         dfMaxSearchDist = MAX(nXSize,nYSize) + 1;
 
-    int nMaxSearchDist = (int) floor(dfMaxSearchDist);
-
-    if( nXSize > 65533 || nYSize > 65533 )
-    {
-        eType = GDT_UInt32;
-        nNoDataVal = 4000002;
-    }
-    else
-    {
-        eType = GDT_UInt16;
-        nNoDataVal = 65535;
-    }
+    if( nSmoothingIterations < 0 )
+        nSmoothingIterations = 0;
 
     if( hMaskBand == NULL )
         hMaskBand = GDALGetMaskBand( hTargetBand );
 
-    /* If there are smoothing iterations, reserve 10% of the progress for them */
-    double dfProgressRatio = (nSmoothingIterations > 0) ? 0.9 : 1.0;
-
-/* -------------------------------------------------------------------- */
-/*      Initialize progress counter.                                    */
-/* -------------------------------------------------------------------- */
-    if( pfnProgress == NULL )
-        pfnProgress = GDALDummyProgress;
-
-    if( !pfnProgress( 0.0, "Filling...", pProgressArg ) )
-    {
-        CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
-        return CE_Failure;
-    }
-
-/* -------------------------------------------------------------------- */
-/*      Determine format driver for temp work files.                    */
-/* -------------------------------------------------------------------- */
-    CPLString osTmpFileDriver = CSLFetchNameValueDef(
-            papszOptions, "TEMP_FILE_DRIVER", "GTiff");
-    GDALDriverH hDriver = GDALGetDriverByName((const char *) osTmpFileDriver);
-
-    if (hDriver == NULL)
-    {
-        CPLError(CE_Failure, CPLE_AppDefined,
-                 "Given driver is not registered");
-        return CE_Failure;
-    }
-
-    if (GDALGetMetadataItem(hDriver, GDAL_DCAP_CREATE, NULL) == NULL)
-    {
-        CPLError(CE_Failure, CPLE_AppDefined,
-                 "Given driver is incapable of creating temp work files");
-        return CE_Failure;
-    }
-
-    char **papszWorkFileOptions = NULL;
-    if (osTmpFileDriver == "GTiff") {
-        papszWorkFileOptions = CSLSetNameValue(
-                papszWorkFileOptions, "COMPRESS", "LZW");
-        papszWorkFileOptions = CSLSetNameValue(
-                papszWorkFileOptions, "BIGTIFF", "IF_SAFER");
-    }
-
 /* -------------------------------------------------------------------- */
-/*      Create a work file to hold the Y "last value" indices.          */
+/*      Options.                                                        */
 /* -------------------------------------------------------------------- */
-    GDALDatasetH hYDS;
-    GDALRasterBandH hYBand;
-
-    CPLString osTmpFile = CPLGenerateTempFilename("");
-    CPLString osYTmpFile = osTmpFile + "fill_y_work.tif";
-
-    hYDS = GDALCreate( hDriver, osYTmpFile, nXSize, nYSize, 1,
-                       eType, (char **) papszWorkFileOptions );
+    GDALFillNodataParams sParams;
+    sParams.nXSize = nXSize;
+    sParams.nYSize = nYSize;
+    sParams.dfMaxSearchDist = dfMaxSearchDist;
+    sParams.nMaxSearchDist = (int) floor(MIN(dfMaxSearchDist, INT_MAX - 1.0));
+    sParams.nSmoothingIterations = nSmoothingIterations;
+    sParams.eBandType = GDALGetRasterDataType( hTargetBand );
 
-    if ( hYDS == NULL )
+    const char *pszSearch = CSLFetchNameValueDef( papszOptions, "SEARCH",
+                                                  "CONIC" );
+    if( EQUAL(pszSearch, "CONIC") )
+        sParams.bTransformSearch = FALSE;
+    else if( EQUAL(pszSearch, "TRANSFORM") )
+        sParams.bTransformSearch = TRUE;
+    else
     {
-        CPLError(CE_Failure, CPLE_AppDefined,
-            "Could not create Y index work file. Check driver capabilities.");
+        CPLError( CE_Failure, CPLE_NotSupported,
+                  "Unsupported value for SEARCH: %s", pszSearch );
         return CE_Failure;
     }
 
-    hYBand = GDALGetRasterBand( hYDS, 1 );
+    const char *pszThreads = CSLFetchNameValue( papszOptions, "NUM_THREADS" );
+    if( pszThreads == NULL )
+        pszThreads = CPLGetConfigOption( "GDAL_NUM_THREADS", "1" );
+    int nThreads = EQUAL(pszThreads, "ALL_CPUS") ?
+        CPLGetNumCPUs() : atoi( pszThreads );
+    nThreads = MAX(1, MIN(128, nThreads));
 
 /* -------------------------------------------------------------------- */
-/*      Create a work file to hold the pixel value associated with      */
-/*      the "last xy value" pixel.                                      */
+/*      Initialize progress counter.                                    */
 /* -------------------------------------------------------------------- */
-    GDALDatasetH hValDS;
-    GDALRasterBandH hValBand;
-    CPLString osValTmpFile = osTmpFile + "fill_val_work.tif";
-
-    hValDS = GDALCreate( hDriver, osValTmpFile, nXSize, nYSize, 1,
-                         GDALGetRasterDataType( hTargetBand ),
-                         (char **) papszWorkFileOptions );
+    if( pfnProgress == NULL )
+        pfnProgress = GDALDummyProgress;
 
-    if ( hValDS == NULL )
+    if( !pfnProgress( 0.0, "Filling...", pProgressArg ) )
     {
-        CPLError(CE_Failure, CPLE_AppDefined,
-            "Could not create XY value work file. Check driver capabilities.");
+        CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
         return CE_Failure;
     }
 
-    hValBand = GDALGetRasterBand( hValDS, 1 );
-
 /* -------------------------------------------------------------------- */
-/*      Create a mask file to make it clear what pixels can be filtered */
-/*      on the filtering pass.                                          */
+/*      Split the raster in strips of lines, of a few tens of           */
+/*      megabytes of working memory each.                               */
 /* -------------------------------------------------------------------- */
-    GDALDatasetH hFiltMaskDS;
-    GDALRasterBandH hFiltMaskBand;
-    CPLString osFiltMaskTmpFile = osTmpFile + "fill_filtmask_work.tif";
-
-    hFiltMaskDS =
-        GDALCreate( hDriver, osFiltMaskTmpFile, nXSize, nYSize, 1,
-                    GDT_Byte, (char **) papszWorkFileOptions );
+    const int nHalo = nSmoothingIterations;
+    int nStripHeight = static_cast<int>(
+        MIN( (GIntBig)nYSize, (32 * 1024 * 1024) / (16 * (GIntBig)nXSize) ) );
+    if( nThreads > 1 )
+        nStripHeight = MIN( nStripHeight, (nYSize + nThreads - 1) / nThreads );
+    nStripHeight = MIN( nYSize, MAX( nStripHeight, MAX( 16, 2 * nHalo ) ) );
 
-    if ( hFiltMaskDS == NULL )
+    const int nStrips = (nYSize + nStripHeight - 1) / nStripHeight;
+    std::vector<int> anStripYOff( nStrips );
+    std::vector<int> anStripYEnd( nStrips );   // halo included
+    for( int i = 0; i < nStrips; i++ )
     {
-        CPLError(CE_Failure, CPLE_AppDefined,
-            "Could not create mask work file. Check driver capabilities.");
-        return CE_Failure;
+        anStripYOff[i] = MAX(0, i * nStripHeight - nHalo);
+        anStripYEnd[i] = MIN(nYSize, (i + 1) * nStripHeight + nHalo);
     }
 
-    hFiltMaskBand = GDALGetRasterBand( hFiltMaskDS, 1 );
-
-/* -------------------------------------------------------------------- */
-/*      Allocate buffers for last scanline and this scanline.           */
-/* -------------------------------------------------------------------- */
-    GUInt32 *panLastY, *panThisY, *panTopDownY;
-    float   *pafLastValue, *pafThisValue, *pafScanline, *pafTopDownValue;
-    GByte   *pabyMask, *pabyFiltMask;
-    int     iX;
-    int     iY;
-
-    panLastY = (GUInt32 *) VSI_CALLOC_VERBOSE(nXSize,sizeof(GUInt32));
-    panThisY = (GUInt32 *) VSI_CALLOC_VERBOSE(nXSize,sizeof(GUInt32));
-    panTopDownY = (GUInt32 *) VSI_CALLOC_VERBOSE(nXSize,sizeof(GUInt32));
-    pafLastValue = (float *) VSI_CALLOC_VERBOSE(nXSize,sizeof(float));
-    pafThisValue = (float *) VSI_CALLOC_VERBOSE(nXSize,sizeof(float));
-    pafTopDownValue = (float *) VSI_CALLOC_VERBOSE(nXSize,sizeof(float));
-    pafScanline = (float *) VSI_CALLOC_VERBOSE(nXSize,sizeof(float));
-    pabyMask = (GByte *) VSI_CALLOC_VERBOSE(nXSize,1);
-    pabyFiltMask = (GByte *) VSI_CALLOC_VERBOSE(nXSize,1);
-    if (panLastY == NULL || panThisY == NULL || panTopDownY == NULL ||
-        pafLastValue == NULL || pafThisValue == NULL || pafTopDownValue == NULL ||
-        pafScanline == NULL || pabyMask == NULL || pabyFiltMask == NULL)
-    {
-        eErr = CE_Failure;
-        goto end;
-    }
-
-    for( iX = 0; iX < nXSize; iX++ )
-    {
-        panLastY[iX] = nNoDataVal;
-    }
+    CPLDebug( "GDAL", "GDALFillNodata(): %d strips of %d lines, halo %d",
+              nStrips, nStripHeight, nHalo );
 
 /* ==================================================================== */
-/*      Make first pass from top to bottom collecting the "last         */
-/*      known value" for each column and writing it out to the work     */
-/*      files.                                                          */
+/*      First pass from top to bottom collecting for each strip and     */
+/*      column the first valid pixel below the strip.                   */
 /* ==================================================================== */
-
-    for( iY = 0; iY < nYSize && eErr == CE_None; iY++ )
+    std::vector<GInt32> anBottomSeedY( static_cast<size_t>(nStrips) * nXSize,
+                                       -1 );
+    std::vector<float>  afBottomSeedValue(
+        static_cast<size_t>(nStrips) * nXSize, 0.0f );
+    std::vector<int>    anPendingStrip( nXSize, 0 );
+    std::vector<float>  afLines( static_cast<size_t>(nStripHeight) * nXSize );
+    std::vector<GByte>  abyLines( static_cast<size_t>(nStripHeight) * nXSize );
+    bool bHasNodata = false;
+
+    for( int iY0 = 0; iY0 < nYSize && eErr == CE_None; iY0 += nStripHeight )
     {
-/* -------------------------------------------------------------------- */
-/*      Read data and mask for this line.                               */
-/* -------------------------------------------------------------------- */
-        eErr =
-            GDALRasterIO( hMaskBand, GF_Read, 0, iY, nXSize, 1,
-                          pabyMask, nXSize, 1, GDT_Byte, 0, 0 );
-
-        if( eErr != CE_None )
-            break;
-
-        eErr =
-            GDALRasterIO( hTargetBand, GF_Read, 0, iY, nXSize, 1,
-                          pafScanline, nXSize, 1, GDT_Float32, 0, 0 );
-
+        const int nLines = MIN(nStripHeight, nYSize - iY0);
+
+        eErr = GDALRasterIO( hMaskBand, GF_Read, 0, iY0, nXSize, nLines,
+                             &abyLines[0], nXSize, nLines, GDT_Byte, 0, 0 );
+        if( eErr == CE_None )
+            eErr = GDALRasterIO( hTargetBand, GF_Read, 0, iY0, nXSize, nLines,
+                                 &afLines[0], nXSize, nLines, GDT_Float32,
+                                 0, 0 );
         if( eErr != CE_None )
             break;
 
-/* -------------------------------------------------------------------- */
-/*      Figure out the most recent pixel for each column.               */
-/* -------------------------------------------------------------------- */
-
-        for( iX = 0; iX < nXSize; iX++ )
+        for( int iLine = 0; iLine < nLines; iLine++ )
         {
-            if( pabyMask[iX] )
-            {
-                pafThisValue[iX] = pafScanline[iX];
-                panThisY[iX] = iY;
-            }
-            else if( iY <= dfMaxSearchDist + panLastY[iX] )
+            const int iY = iY0 + iLine;
+            const size_t nOffset = static_cast<size_t>(iLine) * nXSize;
+            for( int iX = 0; iX < nXSize; iX++ )
             {
-                pafThisValue[iX] = pafLastValue[iX];
-                panThisY[iX] = panLastY[iX];
-            }
-            else
-            {
-                panThisY[iX] = nNoDataVal;
+                if( !abyLines[nOffset + iX] )
+                {
+                    bHasNodata = true;
+                    continue;
+                }
+                while( anPendingStrip[iX] < nStrips &&
+                       anStripYEnd[anPendingStrip[iX]] <= iY )
+                {
+                    const size_t nSeed =
+                        static_cast<size_t>(anPendingStrip[iX]) * nXSize + iX;
+                    anBottomSeedY[nSeed] = iY;
+                    afBottomSeedValue[nSeed] = afLines[nOffset + iX];
+                    anPendingStrip[iX]++;
+                }
             }
         }
 
-/* -------------------------------------------------------------------- */
-/*      Write out best index/value to working files.                    */
-/* -------------------------------------------------------------------- */
-        eErr = GDALRasterIO( hYBand, GF_Write, 0, iY, nXSize, 1,
-                             panThisY, nXSize, 1, GDT_UInt32, 0, 0 );
-        if( eErr != CE_None )
-            break;
-
-        eErr = GDALRasterIO( hValBand, GF_Write, 0, iY, nXSize, 1,
-                             pafThisValue, nXSize, 1, GDT_Float32, 0, 0 );
-        if( eErr != CE_None )
-            break;
-
-/* -------------------------------------------------------------------- */
-/*      Flip this/last buffers.                                         */
-/* -------------------------------------------------------------------- */
-        {
-            float *pafTmp = pafThisValue;
-            pafThisValue = pafLastValue;
-            pafLastValue = pafTmp;
-
-            GUInt32 *panTmp = panThisY;
-            panThisY = panLastY;
-            panLastY = panTmp;
-        }
-
-/* -------------------------------------------------------------------- */
-/*      report progress.                                                */
-/* -------------------------------------------------------------------- */
-        if( eErr == CE_None
-            && !pfnProgress( dfProgressRatio * (0.5*(iY+1) / (double)nYSize),
-                             "Filling...", pProgressArg ) )
+        if( !pfnProgress( 0.25 * (iY0 + nLines) / nYSize,
+                          "Filling...", pProgressArg ) )
         {
             CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
             eErr = CE_Failure;
         }
     }
 
+    std::vector<float>().swap( afLines );
+    std::vector<GByte>().swap( abyLines );
+
+    if( eErr != CE_None || !bHasNodata )
+    {
+        if( eErr == CE_None )
+            pfnProgress( 1.0, "", pProgressArg );
+        return eErr;
+    }
+
 /* ==================================================================== */
-/*      Now we will do collect similar this/last information from       */
-/*      bottom to top and use it in combination with the top to         */
-/*      bottom search info to interpolate.                              */
+/*      Process the strips by batches, one per thread: read them, with  */
+/*      their halo, interpolate and smooth, and write them.             */
 /* ==================================================================== */
-    for( iY = nYSize-1; iY >= 0 && eErr == CE_None; iY-- )
+    CPLWorkerThreadPool *poThreadPool = NULL;
+    if( nThreads > 1 && nStrips > 1 )
     {
-        eErr =
-            GDALRasterIO( hMaskBand, GF_Read, 0, iY, nXSize, 1,
-                          pabyMask, nXSize, 1, GDT_Byte, 0, 0 );
-
-        if( eErr != CE_None )
-            break;
-
-        eErr =
-            GDALRasterIO( hTargetBand, GF_Read, 0, iY, nXSize, 1,
-                          pafScanline, nXSize, 1, GDT_Float32, 0, 0 );
-
-        if( eErr != CE_None )
-            break;
-
-/* -------------------------------------------------------------------- */
-/*      Figure out the most recent pixel for each column.               */
-/* -------------------------------------------------------------------- */
-
-        for( iX = 0; iX < nXSize; iX++ )
+        nThreads = MIN(nThreads, nStrips);
+        poThreadPool = new (std::nothrow) CPLWorkerThreadPool();
+        if( poThreadPool == NULL ||
+            !poThreadPool->Setup( nThreads, NULL, NULL ) )
         {
-            if( pabyMask[iX] )
-            {
-                pafThisValue[iX] = pafScanline[iX];
-                panThisY[iX] = iY;
-            }
-            else if( panLastY[iX] - iY <= dfMaxSearchDist )
-            {
-                pafThisValue[iX] = pafLastValue[iX];
-                panThisY[iX] = panLastY[iX];
-            }
-            else
-            {
-                panThisY[iX] = nNoDataVal;
-            }
+            delete poThreadPool;
+            poThreadPool = NULL;
+            nThreads = 1;
         }
+    }
+    else
+        nThreads = 1;
 
-/* -------------------------------------------------------------------- */
-/*      Load the last y and corresponding value from the top down pass. */
-/* -------------------------------------------------------------------- */
-        eErr =
-            GDALRasterIO( hYBand, GF_Read, 0, iY, nXSize, 1,
-                          panTopDownY, nXSize, 1, GDT_UInt32, 0, 0 );
-
-        if( eErr != CE_None )
-            break;
+    std::vector<GDALFillNodataStrip> asStrips( nThreads );
 
-        eErr =
-            GDALRasterIO( hValBand, GF_Read, 0, iY, nXSize, 1,
-                          pafTopDownValue, nXSize, 1, GDT_Float32, 0, 0 );
+    // Last valid line above the next strip, and its value, for each column.
+    std::vector<GInt32> anTopDownY( nXSize, -1 );
+    std::vector<float>  afTopDownValue( nXSize, 0.0f );
 
-        if( eErr != CE_None )
-            break;
+    for( int iStrip0 = 0; iStrip0 < nStrips && eErr == CE_None;
+         iStrip0 += nThreads )
+    {
+        const int nBatch = MIN(nThreads, nStrips - iStrip0);
 
-/* -------------------------------------------------------------------- */
-/*      Attempt to interpolate any pixels that are nodata.              */
-/* -------------------------------------------------------------------- */
-        memset( pabyFiltMask, 0, nXSize );
-        for( iX = 0; iX < nXSize; iX++ )
+        for( int i = 0; i < nBatch && eErr == CE_None; i++ )
         {
-            int iStep, iQuad;
-            int nThisMaxSearchDist = nMaxSearchDist;
-
-            // If this was a valid target - no change.
-            if( pabyMask[iX] )
-                continue;
-
-            // Quadrants 0:topleft, 1:bottomleft, 2:topright, 3:bottomright
-            double adfQuadDist[4];
-            double adfQuadValue[4];
-
-            for( iQuad = 0; iQuad < 4; iQuad++ )
-            {
-                adfQuadDist[iQuad] = dfMaxSearchDist + 1.0;
-                adfQuadValue[iQuad] = 0.0;
-            }
-
-            // Step left and right by one pixel searching for the closest
-            // target value for each quadrant.
-            for( iStep = 0; iStep < nThisMaxSearchDist; iStep++ )
-            {
-                int iLeftX = MAX(0,iX - iStep);
-                int iRightX = MIN(nXSize-1,iX + iStep);
-
-                // top left includes current line
-                QUAD_CHECK(adfQuadDist[0],adfQuadValue[0],
-                           iLeftX, panTopDownY[iLeftX], iX, iY,
-                           pafTopDownValue[iLeftX] );
-
-                // bottom left
-                QUAD_CHECK(adfQuadDist[1],adfQuadValue[1],
-                           iLeftX, panLastY[iLeftX], iX, iY,
-                           pafLastValue[iLeftX] );
-
-                // top right and bottom right do no include center pixel.
-                if( iStep == 0 )
-                     continue;
-
-                // top right includes current line
-                QUAD_CHECK(adfQuadDist[2],adfQuadValue[2],
-                           iRightX, panTopDownY[iRightX], iX, iY,
-                           pafTopDownValue[iRightX] );
-
-                // bottom right
-                QUAD_CHECK(adfQuadDist[3],adfQuadValue[3],
-                           iRightX, panLastY[iRightX], iX, iY,
-                           pafLastValue[iRightX] );
-
-                // every four steps, recompute maximum distance.
-                if( (iStep & 0x3) == 0 )
-                    nThisMaxSearchDist = (int) floor(
-                        MAX(MAX(adfQuadDist[0],adfQuadDist[1]),
-                            MAX(adfQuadDist[2],adfQuadDist[3])) );
-            }
-
-            double dfWeightSum = 0.0;
-            double dfValueSum = 0.0;
+            const int iStrip = iStrip0 + i;
+            GDALFillNodataStrip *psStrip = &asStrips[i];
+            psStrip->psParams = &sParams;
+            psStrip->nYOff = anStripYOff[iStrip];
+            psStrip->nLines = anStripYEnd[iStrip] - anStripYOff[iStrip];
+            psStrip->nOutYOff = iStrip * nStripHeight;
+            psStrip->nOutLines = MIN(nStripHeight, nYSize - psStrip->nOutYOff);
+
+            const size_t nPixels =
+                static_cast<size_t>(psStrip->nLines) * nXSize;
+            psStrip->afData.resize( nPixels );
+            psStrip->abyMask.resize( nPixels );
+
+            eErr = GDALRasterIO( hMaskBand, GF_Read, 0, psStrip->nYOff,
+                                 nXSize, psStrip->nLines,
+                                 &(psStrip->abyMask[0]),
+                                 nXSize, psStrip->nLines, GDT_Byte, 0, 0 );
+            if( eErr == CE_None )
+                eErr = GDALRasterIO( hTargetBand, GF_Read, 0, psStrip->nYOff,
+                                     nXSize, psStrip->nLines,
+                                     &(psStrip->afData[0]),
+                                     nXSize, psStrip->nLines, GDT_Float32,
+                                     0, 0 );
+            if( eErr != CE_None )
+                break;
 
-            for( iQuad = 0; iQuad < 4; iQuad++ )
+            psStrip->anTopSeedY = anTopDownY;
+            psStrip->afTopSeedValue = afTopDownValue;
+            psStrip->anBottomSeedY.assign(
+                anBottomSeedY.begin() + static_cast<size_t>(iStrip) * nXSize,
+                anBottomSeedY.begin() + static_cast<size_t>(iStrip + 1) * nXSize );
+            psStrip->afBottomSeedValue.assign(
+                afBottomSeedValue.begin() + static_cast<size_t>(iStrip) * nXSize,
+                afBottomSeedValue.begin() + static_cast<size_t>(iStrip + 1) * nXSize );
+
+            // Carry the last valid lines down to the top of the next strip.
+            if( iStrip + 1 < nStrips )
             {
-                if( adfQuadDist[iQuad] <= dfMaxSearchDist )
+                for( int iY = psStrip->nYOff; iY < anStripYOff[iStrip + 1];
+                     iY++ )
                 {
-                    double dfWeight = 1.0 / adfQuadDist[iQuad];
-
-                    dfWeightSum += dfWeight;
-                    dfValueSum += adfQuadValue[iQuad] * dfWeight;
+                    const size_t nOffset =
+                        static_cast<size_t>(iY - psStrip->nYOff) * nXSize;
+                    for( int iX = 0; iX < nXSize; iX++ )
+                    {
+                        if( psStrip->abyMask[nOffset + iX] )
+                        {
+                            anTopDownY[iX] = iY;
+                            afTopDownValue[iX] = psStrip->afData[nOffset + iX];
+                        }
+                    }
                 }
             }
-
-            if( dfWeightSum > 0.0 )
-            {
-                pabyMask[iX] = 255;
-                pabyFiltMask[iX] = 255;
-                pafScanline[iX] = (float) (dfValueSum / dfWeightSum);
-            }
-
         }
-
-/* -------------------------------------------------------------------- */
-/*      Write out the updated data and mask information.                */
-/* -------------------------------------------------------------------- */
-        eErr =
-            GDALRasterIO( hTargetBand, GF_Write, 0, iY, nXSize, 1,
-                          pafScanline, nXSize, 1, GDT_Float32, 0, 0 );
-
         if( eErr != CE_None )
             break;
 
-        eErr =
-            GDALRasterIO( hFiltMaskBand, GF_Write, 0, iY, nXSize, 1,
-                          pabyFiltMask, nXSize, 1, GDT_Byte, 0, 0 );
-
-        if( eErr != CE_None )
-            break;
+        if( poThreadPool != NULL && nBatch > 1 )
+        {
+            std::vector<void*> apJobs;
+            for( int i = 0; i < nBatch; i++ )
+                apJobs.push_back( &asStrips[i] );
+            poThreadPool->SubmitJobs( GDALFillNodataStripJob, apJobs );
+            poThreadPool->WaitCompletion();
+        }
+        else
+        {
+            for( int i = 0; i < nBatch; i++ )
+                GDALFillNodataStripJob( &asStrips[i] );
+        }
 
 /* -------------------------------------------------------------------- */
-/*      Flip this/last buffers.                                         */
+/*      Write out the updated lines.                                    */
 /* -------------------------------------------------------------------- */
+        for( int i = 0; i < nBatch && eErr == CE_None; i++ )
         {
-            float *pafTmp = pafThisValue;
-            pafThisValue = pafLastValue;
-            pafLastValue = pafTmp;
-
-            GUInt32 *panTmp = panThisY;
-            panThisY = panLastY;
-            panLastY = panTmp;
+            GDALFillNodataStrip *psStrip = &asStrips[i];
+            if( !psStrip->bModified )
+                continue;
+            const size_t nOffset =
+                static_cast<size_t>(psStrip->nOutYOff - psStrip->nYOff)
+                * nXSize;
+            eErr = GDALRasterIO( hTargetBand, GF_Write,
+                                 0, psStrip->nOutYOff,
+                                 nXSize, psStrip->nOutLines,
+                                 &(psStrip->afData[nOffset]),
+                                 nXSize, psStrip->nOutLines, GDT_Float32,
+                                 0, 0 );
         }
 
 /* -------------------------------------------------------------------- */
 /*      report progress.                                                */
 /* -------------------------------------------------------------------- */
+        const int nDoneLines = MIN(nYSize, (iStrip0 + nBatch) * nStripHeight);
         if( eErr == CE_None
-            && !pfnProgress( dfProgressRatio*(0.5+0.5*(nYSize-iY) / (double)nYSize),
+            && !pfnProgress( 0.25 + 0.75 * nDoneLines / (double)nYSize,
                              "Filling...", pProgressArg ) )
         {
             CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
@@ -833,50 +1000,10 @@ GDALFillNodata( GDALRasterBandH hTargetBand,
         }
     }
 
-/* ==================================================================== */
-/*      Now we will do iterative average filters over the               */
-/*      interpolated values to smooth things out and make linear        */
-/*      artifacts less obvious.                                         */
-/* ==================================================================== */
-    if( eErr == CE_None && nSmoothingIterations > 0 )
-    {
-        // force masks to be to flushed and recomputed.
-        GDALFlushRasterCache( hMaskBand );
-
-        void *pScaledProgress;
-        pScaledProgress =
-            GDALCreateScaledProgress( dfProgressRatio, 1.0, pfnProgress, NULL );
-
-        eErr = GDALMultiFilter( hTargetBand, hMaskBand, hFiltMaskBand,
-                                nSmoothingIterations,
-                                GDALScaledProgress, pScaledProgress );
+    delete poThreadPool;
 
-        GDALDestroyScaledProgress( pScaledProgress );
-    }
-
-/* -------------------------------------------------------------------- */
-/*      Close and clean up temporary files. Free working buffers        */
-/* -------------------------------------------------------------------- */
-end:
-    CPLFree(panLastY);
-    CPLFree(panThisY);
-    CPLFree(panTopDownY);
-    CPLFree(pafLastValue);
-    CPLFree(pafThisValue);
-    CPLFree(pafTopDownValue);
-    CPLFree(pafScanline);
-    CPLFree(pabyMask);
-    CPLFree(pabyFiltMask);
-
-    GDALClose( hYDS );
-    GDALClose( hValDS );
-    GDALClose( hFiltMaskDS );
-
-    CSLDestroy(papszWorkFileOptions);
-
-    GDALDeleteDataset( hDriver, osYTmpFile );
-    GDALDeleteDataset( hDriver, osValTmpFile );
-    GDALDeleteDataset( hDriver, osFiltMaskTmpFile );
+    // force masks to be to flushed and recomputed.
+    GDALFlushRasterCache( hMaskBand );
 
     return eErr;
 }
@@ -57,6 +57,7 @@ static void Usage(const char* pszErrorMsg = NULL)
     printf(
         "Usage: gdal_contour [-b <band>] [-a <attribute_name>] [-3d] [-inodata]\n"
         "                    [-snodata n] [-f <formatname>] [-i <interval>]\n"
+        "                    [-p] [-amin <attribute_name>] [-amax <attribute_name>]\n"
         "                    [-f <formatname>] [[-dsco NAME=VALUE] ...] [[-lco NAME=VALUE] ...]\n"
         "                    [-off <offset>] [-fl <level> <level>...]\n"
         "                    [-nln <outlayername>] [-q]\n"
@@ -86,6 +87,9 @@ int main( int argc, char ** argv )
     const char *pszSrcFilename = NULL;
     const char *pszDstFilename = NULL;
     const char *pszElevAttrib = NULL;
+    const char *pszElevAttribMin = NULL;
+    const char *pszElevAttribMax = NULL;
+    int bPolygonize = FALSE;
     const char *pszFormat = "ESRI Shapefile";
     char        **papszDSCO = NULL, **papszLCO = NULL;
     double adfFixedLevels[1000];
@@ -127,6 +131,20 @@ int main( int argc, char ** argv )
             CHECK_HAS_ENOUGH_ADDITIONAL_ARGS(1);
             pszElevAttrib = argv[++i];
         }
+        else if( EQUAL(argv[i],"-amin") )
+        {
+            CHECK_HAS_ENOUGH_ADDITIONAL_ARGS(1);
+            pszElevAttribMin = argv[++i];
+        }
+        else if( EQUAL(argv[i],"-amax") )
+        {
+            CHECK_HAS_ENOUGH_ADDITIONAL_ARGS(1);
+            pszElevAttribMax = argv[++i];
+        }
+        else if( EQUAL(argv[i],"-p") )
+        {
+            bPolygonize = TRUE;
+        }
         else if( EQUAL(argv[i],"-off") )
         {
             CHECK_HAS_ENOUGH_ADDITIONAL_ARGS(1);
@@ -270,8 +288,11 @@ int main( int argc, char ** argv )
     if( hDS == NULL )
         exit( 1 );
 
-    hLayer = OGR_DS_CreateLayer( hDS, pszNewLayerName, hSRS,
-                                 b3D ? wkbLineString25D : wkbLineString,
+    OGRwkbGeometryType eType = b3D ? wkbLineString25D : wkbLineString;
+    if( bPolygonize )
+        eType = wkbMultiPolygon;
+
+    hLayer = OGR_DS_CreateLayer( hDS, pszNewLayerName, hSRS, eType,
                                  papszLCO );
     if( hLayer == NULL )
         exit( 1 );
@@ -281,9 +302,14 @@ int main( int argc, char ** argv )
     OGR_L_CreateField( hLayer, hFld, FALSE );
     OGR_Fld_Destroy( hFld );
 
-    if( pszElevAttrib )
+    const char *apszElevAttribs[3] =
+        { pszElevAttrib, pszElevAttribMin, pszElevAttribMax };
+    for( int iAttr = 0; iAttr < 3; iAttr++ )
     {
-        hFld = OGR_Fld_Create( pszElevAttrib, OFTReal );
+        if( apszElevAttribs[iAttr] == NULL )
+            continue;
+
+        hFld = OGR_Fld_Create( apszElevAttribs[iAttr], OFTReal );
         OGR_Fld_SetWidth( hFld, 12 );
         OGR_Fld_SetPrecision( hFld, 3 );
         OGR_L_CreateField( hLayer, hFld, FALSE );
@@ -291,18 +317,57 @@ int main( int argc, char ** argv )
     }
 
 /* -------------------------------------------------------------------- */
-/*      Invoke.                                                         */
+/*      Invoke.  The number of threads is taken from the                */
+/*      GDAL_NUM_THREADS configuration option.                          */
 /* -------------------------------------------------------------------- */
+    OGRFeatureDefnH hDefn = OGR_L_GetLayerDefn( hLayer );
+    char **papszOptions = NULL;
+
+    if( nFixedLevelCount > 0 )
+    {
+        CPLString osLevels;
+        for( int iLevel = 0; iLevel < nFixedLevelCount; iLevel++ )
+        {
+            if( iLevel > 0 )
+                osLevels += ",";
+            osLevels += CPLSPrintf( "%.18g", adfFixedLevels[iLevel] );
+        }
+        papszOptions = CSLSetNameValue( papszOptions, "FIXED_LEVELS",
+                                        osLevels );
+    }
+    else
+    {
+        papszOptions = CSLSetNameValue( papszOptions, "LEVEL_INTERVAL",
+                                        CPLSPrintf( "%.18g", dfInterval ) );
+        papszOptions = CSLSetNameValue( papszOptions, "LEVEL_BASE",
+                                        CPLSPrintf( "%.18g", dfOffset ) );
+    }
+
+    if( bNoDataSet )
+        papszOptions = CSLSetNameValue( papszOptions, "NODATA",
+                                        CPLSPrintf( "%.18g", dfNoData ) );
+
+    papszOptions = CSLSetNameValue( papszOptions, "ID_FIELD",
+        CPLSPrintf( "%d", OGR_FD_GetFieldIndex( hDefn, "ID" ) ) );
+
+    const char *apszElevOptions[3] =
+        { "ELEV_FIELD", "ELEV_FIELD_MIN", "ELEV_FIELD_MAX" };
+    for( int iAttr = 0; iAttr < 3; iAttr++ )
+    {
+        if( apszElevAttribs[iAttr] != NULL )
+            papszOptions = CSLSetNameValue( papszOptions,
+                apszElevOptions[iAttr],
+                CPLSPrintf( "%d", OGR_FD_GetFieldIndex(
+                                    hDefn, apszElevAttribs[iAttr] ) ) );
+    }
+
+    if( bPolygonize )
+        papszOptions = CSLSetNameValue( papszOptions, "POLYGONIZE", "YES" );
+
     /* CPLErr eErr = */
-    GDALContourGenerate( hBand, dfInterval, dfOffset,
-                         nFixedLevelCount, adfFixedLevels,
-                         bNoDataSet, dfNoData, hLayer,
-                         OGR_FD_GetFieldIndex( OGR_L_GetLayerDefn( hLayer ),
-                                               "ID" ),
-                         (pszElevAttrib == NULL) ? -1 :
-                         OGR_FD_GetFieldIndex( OGR_L_GetLayerDefn( hLayer ),
-                                               pszElevAttrib ),
-                         pfnProgress, NULL );
+    GDALContourGenerateEx( hBand, hLayer, papszOptions, pfnProgress, NULL );
+
+    CSLDestroy( papszOptions );
 
     OGR_DS_Destroy( hDS );
     GDALClose( hSrcDS );
@@ -95,6 +95,9 @@
 #include "gdal.h"
 #include "gdal_priv.h"
 #include "gdal_utils_priv.h"
+#include "cpl_worker_thread_pool.h"
+
+#include <vector>
 
 CPL_CVSID("$Id$");
 
@@ -140,6 +143,17 @@ struct GDALDEMProcessingOptions
 
 typedef float (*GDALGeneric3x3ProcessingAlg) (float* pafWindow, float fDstNoDataValue, void* pData);
 
+/* Processes the pixels 1 to nXSize - 2 of a line whose source lines above, */
+/* at and below are pafLine1, pafLine2 and pafLine3, none of them */
+/* containing nodata. */
+typedef void (*GDALGeneric3x3ProcessingRowAlg) (const float* pafLine1,
+                                                const float* pafLine2,
+                                                const float* pafLine3,
+                                                int nXSize,
+                                                float* pafOutLine,
+                                                float fDstNoDataValue,
+                                                void* pData);
+
 static float ComputeVal(int bSrcHasNoData, float fSrcNoDataValue,
                         int bIsSrcNoDataNan,
                         float* afWin, float fDstNoDataValue,
@@ -173,59 +187,103 @@ static float ComputeVal(int bSrcHasNoData, float fSrcNoDataValue,
 }
 
 /************************************************************************/
-/*                  GDALGeneric3x3Processing()                          */
+/*                  GDALGeneric3x3ProcessingParams                      */
 /************************************************************************/
 
-static
-CPLErr GDALGeneric3x3Processing  ( GDALRasterBandH hSrcBand,
-                                   GDALRasterBandH hDstBand,
-                                   GDALGeneric3x3ProcessingAlg pfnAlg,
-                                   void* pData,
-                                   int bComputeAtEdges,
-                                   GDALProgressFunc pfnProgress,
-                                   void * pProgressData)
+typedef struct
 {
-    CPLErr eErr;
-    float *pafThreeLineWin; /* 3 line rotating source buffer */
-    float *pafOutputBuf;     /* 1 line destination buffer */
-    int i, j;
-
-    int bSrcHasNoData, bDstHasNoData;
-    float fSrcNoDataValue = 0.0, fDstNoDataValue = 0.0;
+    GDALRasterBandH                 hSrcBand;
+    GDALGeneric3x3ProcessingAlg     pfnAlg;
+    GDALGeneric3x3ProcessingRowAlg  pfnRowAlg;
+    void                           *pData;
+    int                             bComputeAtEdges;
+    int                             bSrcHasNoData;
+    float                           fSrcNoDataValue;
+    int                             bIsSrcNoDataNan;
+    float                           fDstNoDataValue;
+    int                             nXSize;
+    int                             nYSize;
+} GDALGeneric3x3ProcessingParams;
+
+static void GDALGeneric3x3InitParams( GDALGeneric3x3ProcessingParams* psParams,
+                                      GDALRasterBandH hSrcBand,
+                                      GDALGeneric3x3ProcessingAlg pfnAlg,
+                                      GDALGeneric3x3ProcessingRowAlg pfnRowAlg,
+                                      void* pData,
+                                      int bComputeAtEdges,
+                                      float fDstNoDataValue )
+{
+    psParams->hSrcBand = hSrcBand;
+    psParams->pfnAlg = pfnAlg;
+    psParams->pfnRowAlg = pfnRowAlg;
+    psParams->pData = pData;
+    psParams->bComputeAtEdges = bComputeAtEdges;
+    psParams->bSrcHasNoData = FALSE;
+    psParams->fSrcNoDataValue = (float)
+        GDALGetRasterNoDataValue(hSrcBand, &psParams->bSrcHasNoData);
+    psParams->bIsSrcNoDataNan = psParams->bSrcHasNoData &&
+                                CPLIsNan(psParams->fSrcNoDataValue);
+    psParams->fDstNoDataValue = fDstNoDataValue;
+    psParams->nXSize = GDALGetRasterBandXSize(hSrcBand);
+    psParams->nYSize = GDALGetRasterBandYSize(hSrcBand);
+}
 
-    int nXSize = GDALGetRasterBandXSize(hSrcBand);
-    int nYSize = GDALGetRasterBandYSize(hSrcBand);
+/************************************************************************/
+/*                      GDALGeneric3x3LineHasNoData()                   */
+/************************************************************************/
 
-    if (pfnProgress == NULL)
-        pfnProgress = GDALDummyProgress;
+static bool GDALGeneric3x3LineHasNoData( const GDALGeneric3x3ProcessingParams* psParams,
+                                         const float* pafLine )
+{
+    if( !psParams->bSrcHasNoData )
+        return false;
 
-/* -------------------------------------------------------------------- */
-/*      Initialize progress counter.                                    */
-/* -------------------------------------------------------------------- */
-    if( !pfnProgress( 0.0, NULL, pProgressData ) )
+    const int nXSize = psParams->nXSize;
+    if( psParams->bIsSrcNoDataNan )
     {
-        CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
-        return CE_Failure;
+        for( int j = 0; j < nXSize; j++ )
+        {
+            if( CPLIsNan(pafLine[j]) )
+                return true;
+        }
     }
-
-    pafOutputBuf = (float *) VSI_MALLOC2_VERBOSE(sizeof(float),nXSize);
-    pafThreeLineWin  = (float *) VSI_MALLOC2_VERBOSE(3*sizeof(float),(nXSize+1));
-    if( pafOutputBuf == NULL || pafThreeLineWin == NULL )
+    else
     {
-        VSIFree(pafOutputBuf);
-        VSIFree(pafThreeLineWin);
-        return CE_Failure;
+        const float fSrcNoDataValue = psParams->fSrcNoDataValue;
+        for( int j = 0; j < nXSize; j++ )
+        {
+            if( ARE_REAL_EQUAL(pafLine[j], fSrcNoDataValue) )
+                return true;
+        }
     }
+    return false;
+}
 
-    fSrcNoDataValue = (float) GDALGetRasterNoDataValue(hSrcBand, &bSrcHasNoData);
-    fDstNoDataValue = (float) GDALGetRasterNoDataValue(hDstBand, &bDstHasNoData);
-    if (!bDstHasNoData)
-        fDstNoDataValue = 0.0;
-    int bIsSrcNoDataNan = bSrcHasNoData && CPLIsNan(fSrcNoDataValue);
+/************************************************************************/
+/*                      GDALGeneric3x3ProcessLine()                     */
+/*                                                                      */
+/*      Computes the output line iLine from the source lines above,     */
+/*      at and below it.  pafPrev is NULL for the first line and        */
+/*      pafNext for the last one.                                       */
+/************************************************************************/
 
-    int nLine1Off = 0*nXSize;
-    int nLine2Off = 1*nXSize;
-    int nLine3Off = 2*nXSize;
+static void GDALGeneric3x3ProcessLine( const GDALGeneric3x3ProcessingParams* psParams,
+                                       const float* pafPrev,
+                                       const float* pafCur,
+                                       const float* pafNext,
+                                       int iLine,
+                                       float* pafOutputBuf )
+{
+    const int nXSize = psParams->nXSize;
+    const int nYSize = psParams->nYSize;
+    const int bSrcHasNoData = psParams->bSrcHasNoData;
+    const float fSrcNoDataValue = psParams->fSrcNoDataValue;
+    const int bIsSrcNoDataNan = psParams->bIsSrcNoDataNan;
+    const float fDstNoDataValue = psParams->fDstNoDataValue;
+    const int bComputeAtEdges = psParams->bComputeAtEdges;
+    GDALGeneric3x3ProcessingAlg pfnAlg = psParams->pfnAlg;
+    void* pData = psParams->pData;
+    int j;
 
     // Move a 3x3 pafWindow over each cell
     // (where the cell in question is #4)
@@ -234,24 +292,42 @@ CPLErr GDALGeneric3x3Processing  ( GDALRasterBandH hSrcBand,
     //      3 4 5
     //      6 7 8
 
-    /* Preload the first 2 lines */
-    for ( i = 0; i < 2 && i < nYSize; i++)
+    if( (iLine == 0 || iLine == nYSize - 1) &&
+        !(bComputeAtEdges && nXSize >= 2 && nYSize >= 2) )
     {
-        if( GDALRasterIO(   hSrcBand,
-                        GF_Read,
-                        0, i,
-                        nXSize, 1,
-                        pafThreeLineWin + i * nXSize,
-                        nXSize, 1,
-                        GDT_Float32,
-                        0, 0) != CE_None )
+        // Exclude the edges
+        for (j = 0; j < nXSize; j++)
+            pafOutputBuf[j] = fDstNoDataValue;
+        return;
+    }
+
+    if (iLine == 0)
+    {
+        for (j = 0; j < nXSize; j++)
         {
-            eErr = CE_Failure;
-            goto end;
+            float afWin[9];
+            int jmin = (j == 0) ? j : j - 1;
+            int jmax = (j == nXSize - 1) ? j : j + 1;
+
+            afWin[0] = INTERPOL(pafCur[jmin], pafNext[jmin]);
+            afWin[1] = INTERPOL(pafCur[j],    pafNext[j]);
+            afWin[2] = INTERPOL(pafCur[jmax], pafNext[jmax]);
+            afWin[3] = pafCur[jmin];
+            afWin[4] = pafCur[j];
+            afWin[5] = pafCur[jmax];
+            afWin[6] = pafNext[jmin];
+            afWin[7] = pafNext[j];
+            afWin[8] = pafNext[jmax];
+
+            pafOutputBuf[j] = ComputeVal(bSrcHasNoData, fSrcNoDataValue,
+                                         bIsSrcNoDataNan,
+                                         afWin, fDstNoDataValue,
+                                         pfnAlg, pData, bComputeAtEdges);
         }
+        return;
     }
 
-    if (bComputeAtEdges && nXSize >= 2 && nYSize >= 2)
+    if (iLine == nYSize - 1)
     {
         for (j = 0; j < nXSize; j++)
         {
@@ -259,181 +335,326 @@ CPLErr GDALGeneric3x3Processing  ( GDALRasterBandH hSrcBand,
             int jmin = (j == 0) ? j : j - 1;
             int jmax = (j == nXSize - 1) ? j : j + 1;
 
-            afWin[0] = INTERPOL(pafThreeLineWin[jmin], pafThreeLineWin[nXSize + jmin]);
-            afWin[1] = INTERPOL(pafThreeLineWin[j],    pafThreeLineWin[nXSize + j]);
-            afWin[2] = INTERPOL(pafThreeLineWin[jmax], pafThreeLineWin[nXSize + jmax]);
-            afWin[3] = pafThreeLineWin[jmin];
-            afWin[4] = pafThreeLineWin[j];
-            afWin[5] = pafThreeLineWin[jmax];
-            afWin[6] = pafThreeLineWin[nXSize + jmin];
-            afWin[7] = pafThreeLineWin[nXSize + j];
-            afWin[8] = pafThreeLineWin[nXSize + jmax];
+            afWin[0] = pafPrev[jmin];
+            afWin[1] = pafPrev[j];
+            afWin[2] = pafPrev[jmax];
+            afWin[3] = pafCur[jmin];
+            afWin[4] = pafCur[j];
+            afWin[5] = pafCur[jmax];
+            afWin[6] = INTERPOL(pafCur[jmin], pafPrev[jmin]);
+            afWin[7] = INTERPOL(pafCur[j],    pafPrev[j]);
+            afWin[8] = INTERPOL(pafCur[jmax], pafPrev[jmax]);
 
             pafOutputBuf[j] = ComputeVal(bSrcHasNoData, fSrcNoDataValue,
                                          bIsSrcNoDataNan,
                                          afWin, fDstNoDataValue,
                                          pfnAlg, pData, bComputeAtEdges);
         }
-        eErr = GDALRasterIO(hDstBand, GF_Write,
-                    0, 0, nXSize, 1,
-                    pafOutputBuf, nXSize, 1, GDT_Float32, 0, 0);
+        return;
+    }
+
+    if (bComputeAtEdges && nXSize >= 2)
+    {
+        float afWin[9];
+
+        j = 0;
+        afWin[0] = INTERPOL(pafPrev[j], pafPrev[j+1]);
+        afWin[1] = pafPrev[j];
+        afWin[2] = pafPrev[j+1];
+        afWin[3] = INTERPOL(pafCur[j], pafCur[j+1]);
+        afWin[4] = pafCur[j];
+        afWin[5] = pafCur[j+1];
+        afWin[6] = INTERPOL(pafNext[j], pafNext[j+1]);
+        afWin[7] = pafNext[j];
+        afWin[8] = pafNext[j+1];
+
+        pafOutputBuf[j] = ComputeVal(bSrcHasNoData, fSrcNoDataValue,
+                                     bIsSrcNoDataNan,
+                                     afWin, fDstNoDataValue,
+                                     pfnAlg, pData, bComputeAtEdges);
+        j = nXSize - 1;
+
+        afWin[0] = pafPrev[j-1];
+        afWin[1] = pafPrev[j];
+        afWin[2] = INTERPOL(pafPrev[j], pafPrev[j-1]);
+        afWin[3] = pafCur[j-1];
+        afWin[4] = pafCur[j];
+        afWin[5] = INTERPOL(pafCur[j], pafCur[j-1]);
+        afWin[6] = pafNext[j-1];
+        afWin[7] = pafNext[j];
+        afWin[8] = INTERPOL(pafNext[j], pafNext[j-1]);
+
+        pafOutputBuf[j] = ComputeVal(bSrcHasNoData, fSrcNoDataValue,
+                                     bIsSrcNoDataNan,
+                                     afWin, fDstNoDataValue,
+                                     pfnAlg, pData, bComputeAtEdges);
     }
     else
     {
         // Exclude the edges
-        for (j = 0; j < nXSize; j++)
-        {
-            pafOutputBuf[j] = fDstNoDataValue;
-        }
-        eErr = GDALRasterIO(hDstBand, GF_Write,
-                    0, 0, nXSize, 1,
-                    pafOutputBuf, nXSize, 1, GDT_Float32, 0, 0);
+        pafOutputBuf[0] = fDstNoDataValue;
+        if (nXSize > 1)
+            pafOutputBuf[nXSize - 1] = fDstNoDataValue;
+    }
 
-        if (eErr == CE_None && nYSize > 1)
-        {
-            eErr = GDALRasterIO(hDstBand, GF_Write,
-                        0, nYSize - 1, nXSize, 1,
-                        pafOutputBuf, nXSize, 1, GDT_Float32, 0, 0);
-        }
+/* -------------------------------------------------------------------- */
+/*      When none of the 3 source lines has nodata, the inner pixels    */
+/*      are computed by the row version of the algorithm which does     */
+/*      not go through a function pointer for each pixel.               */
+/* -------------------------------------------------------------------- */
+    if( psParams->pfnRowAlg != NULL &&
+        !GDALGeneric3x3LineHasNoData(psParams, pafPrev) &&
+        !GDALGeneric3x3LineHasNoData(psParams, pafCur) &&
+        !GDALGeneric3x3LineHasNoData(psParams, pafNext) )
+    {
+        psParams->pfnRowAlg(pafPrev, pafCur, pafNext, nXSize,
+                            pafOutputBuf, fDstNoDataValue, pData);
+        return;
     }
+
+    for (j = 1; j < nXSize - 1; j++)
+    {
+        float afWin[9];
+        afWin[0] = pafPrev[j-1];
+        afWin[1] = pafPrev[j];
+        afWin[2] = pafPrev[j+1];
+        afWin[3] = pafCur[j-1];
+        afWin[4] = pafCur[j];
+        afWin[5] = pafCur[j+1];
+        afWin[6] = pafNext[j-1];
+        afWin[7] = pafNext[j];
+        afWin[8] = pafNext[j+1];
+
+        pafOutputBuf[j] = ComputeVal(bSrcHasNoData, fSrcNoDataValue,
+                                     bIsSrcNoDataNan,
+                                     afWin, fDstNoDataValue,
+                                     pfnAlg, pData, bComputeAtEdges);
+    }
+}
+
+/************************************************************************/
+/*                      GDALGeneric3x3ProcessJob()                      */
+/************************************************************************/
+
+typedef struct
+{
+    const GDALGeneric3x3ProcessingParams *psParams;
+    const float *pafSrcBuf;     /* source lines from nSrcYOff */
+    int          nSrcYOff;
+    int          nYOff;
+    int          nYCount;
+    float       *pafDstBuf;     /* output lines from nYOff */
+} GDALGeneric3x3Job;
+
+static void GDALGeneric3x3ProcessJob( void* pData )
+{
+    GDALGeneric3x3Job* psJob = (GDALGeneric3x3Job*) pData;
+    const GDALGeneric3x3ProcessingParams* psParams = psJob->psParams;
+    const int nXSize = psParams->nXSize;
+
+    for( int i = psJob->nYOff; i < psJob->nYOff + psJob->nYCount; i++ )
+    {
+        const float* pafCur = psJob->pafSrcBuf +
+                              (size_t)(i - psJob->nSrcYOff) * nXSize;
+        GDALGeneric3x3ProcessLine( psParams,
+                                   (i > 0) ? pafCur - nXSize : NULL,
+                                   pafCur,
+                                   (i < psParams->nYSize - 1) ?
+                                                pafCur + nXSize : NULL,
+                                   i,
+                                   psJob->pafDstBuf +
+                                    (size_t)(i - psJob->nYOff) * nXSize );
+    }
+}
+
+/************************************************************************/
+/*                     GDALGeneric3x3ProcessLines()                     */
+/*                                                                      */
+/*      Computes nYCount output lines starting at nYOff into            */
+/*      pafDstBuf.  The needed source lines, including one line of      */
+/*      margin on each side, are read into pafSrcBuf, which must be     */
+/*      able to hold nYCount + 2 lines.  The lines are then split       */
+/*      between the threads of poThreadPool if there is one.            */
+/************************************************************************/
+
+static CPLErr GDALGeneric3x3ProcessLines( const GDALGeneric3x3ProcessingParams* psParams,
+                                          CPLWorkerThreadPool* poThreadPool,
+                                          int nThreads,
+                                          int nYOff, int nYCount,
+                                          float* pafSrcBuf,
+                                          float* pafDstBuf )
+{
+    const int nXSize = psParams->nXSize;
+    const int nSrcYOff = MAX(0, nYOff - 1);
+    const int nSrcYEnd = MIN(psParams->nYSize, nYOff + nYCount + 1);
+
+    CPLErr eErr = GDALRasterIO( psParams->hSrcBand, GF_Read,
+                                0, nSrcYOff, nXSize, nSrcYEnd - nSrcYOff,
+                                pafSrcBuf, nXSize, nSrcYEnd - nSrcYOff,
+                                GDT_Float32, 0, 0 );
     if( eErr != CE_None )
-        goto end;
+        return eErr;
 
+    const int nJobs = (poThreadPool != NULL) ? MIN(nThreads, nYCount) : 1;
+    std::vector<GDALGeneric3x3Job> asJobs(nJobs);
+    std::vector<void*> apJobs;
+    for( int iJob = 0; iJob < nJobs; iJob++ )
+    {
+        const int nStart = (int)(((GIntBig)nYCount * iJob) / nJobs);
+        const int nEnd = (int)(((GIntBig)nYCount * (iJob + 1)) / nJobs);
+        GDALGeneric3x3Job* psJob = &asJobs[iJob];
+        psJob->psParams = psParams;
+        psJob->pafSrcBuf = pafSrcBuf;
+        psJob->nSrcYOff = nSrcYOff;
+        psJob->nYOff = nYOff + nStart;
+        psJob->nYCount = nEnd - nStart;
+        psJob->pafDstBuf = pafDstBuf + (size_t)nStart * nXSize;
+        apJobs.push_back(psJob);
+    }
 
-    for ( i = 1; i < nYSize-1; i++)
+    if( nJobs > 1 )
     {
-        /* Read third line of the line buffer */
-        eErr = GDALRasterIO(   hSrcBand,
-                        GF_Read,
-                        0, i+1,
-                        nXSize, 1,
-                        pafThreeLineWin + nLine3Off,
-                        nXSize, 1,
-                        GDT_Float32,
-                        0, 0);
-        if (eErr != CE_None)
-            goto end;
+        poThreadPool->SubmitJobs(GDALGeneric3x3ProcessJob, apJobs);
+        poThreadPool->WaitCompletion();
+    }
+    else
+    {
+        GDALGeneric3x3ProcessJob(apJobs[0]);
+    }
 
-        if (bComputeAtEdges && nXSize >= 2)
-        {
-            float afWin[9];
+    return CE_None;
+}
 
-            j = 0;
-            afWin[0] = INTERPOL(pafThreeLineWin[nLine1Off + j], pafThreeLineWin[nLine1Off + j+1]);
-            afWin[1] = pafThreeLineWin[nLine1Off + j];
-            afWin[2] = pafThreeLineWin[nLine1Off + j+1];
-            afWin[3] = INTERPOL(pafThreeLineWin[nLine2Off + j], pafThreeLineWin[nLine2Off + j+1]);
-            afWin[4] = pafThreeLineWin[nLine2Off + j];
-            afWin[5] = pafThreeLineWin[nLine2Off + j+1];
-            afWin[6] = INTERPOL(pafThreeLineWin[nLine3Off + j], pafThreeLineWin[nLine3Off + j+1]);
-            afWin[7] = pafThreeLineWin[nLine3Off + j];
-            afWin[8] = pafThreeLineWin[nLine3Off + j+1];
+/************************************************************************/
+/*                     GDALGeneric3x3GetThreadCount()                   */
+/************************************************************************/
 
-            pafOutputBuf[j] = ComputeVal(bSrcHasNoData, fSrcNoDataValue,
-                                         bIsSrcNoDataNan,
-                                         afWin, fDstNoDataValue,
-                                         pfnAlg, pData, bComputeAtEdges);
-            j = nXSize - 1;
-
-            afWin[0] = pafThreeLineWin[nLine1Off + j-1];
-            afWin[1] = pafThreeLineWin[nLine1Off + j];
-            afWin[2] = INTERPOL(pafThreeLineWin[nLine1Off + j], pafThreeLineWin[nLine1Off + j-1]);
-            afWin[3] = pafThreeLineWin[nLine2Off + j-1];
-            afWin[4] = pafThreeLineWin[nLine2Off + j];
-            afWin[5] = INTERPOL(pafThreeLineWin[nLine2Off + j], pafThreeLineWin[nLine2Off + j-1]);
-            afWin[6] = pafThreeLineWin[nLine3Off + j-1];
-            afWin[7] = pafThreeLineWin[nLine3Off + j];
-            afWin[8] = INTERPOL(pafThreeLineWin[nLine3Off + j], pafThreeLineWin[nLine3Off + j-1]);
+static int GDALGeneric3x3GetThreadCount()
+{
+    const char* pszThreads = CPLGetConfigOption("GDAL_NUM_THREADS", "1");
+    int nThreads;
+    if( EQUAL(pszThreads, "ALL_CPUS") )
+        nThreads = CPLGetNumCPUs();
+    else
+        nThreads = atoi(pszThreads);
+    if( nThreads < 1 )
+        nThreads = 1;
+    if( nThreads > 128 )
+        nThreads = 128;
+    return nThreads;
+}
 
-            pafOutputBuf[j] = ComputeVal(bSrcHasNoData, fSrcNoDataValue,
-                                         bIsSrcNoDataNan,
-                                         afWin, fDstNoDataValue,
-                                         pfnAlg, pData, bComputeAtEdges);
-        }
-        else
-        {
-            // Exclude the edges
-            pafOutputBuf[0] = fDstNoDataValue;
-            if (nXSize > 1)
-                pafOutputBuf[nXSize - 1] = fDstNoDataValue;
-        }
+/************************************************************************/
+/*                  GDALGeneric3x3CreateThreadPool()                    */
+/************************************************************************/
 
-        for (j = 1; j < nXSize - 1; j++)
-        {
-            float afWin[9];
-            afWin[0] = pafThreeLineWin[nLine1Off + j-1];
-            afWin[1] = pafThreeLineWin[nLine1Off + j];
-            afWin[2] = pafThreeLineWin[nLine1Off + j+1];
-            afWin[3] = pafThreeLineWin[nLine2Off + j-1];
-            afWin[4] = pafThreeLineWin[nLine2Off + j];
-            afWin[5] = pafThreeLineWin[nLine2Off + j+1];
-            afWin[6] = pafThreeLineWin[nLine3Off + j-1];
-            afWin[7] = pafThreeLineWin[nLine3Off + j];
-            afWin[8] = pafThreeLineWin[nLine3Off + j+1];
+static CPLWorkerThreadPool* GDALGeneric3x3CreateThreadPool( int nThreads )
+{
+    if( nThreads <= 1 )
+        return NULL;
 
-            pafOutputBuf[j] = ComputeVal(bSrcHasNoData, fSrcNoDataValue,
-                                         bIsSrcNoDataNan,
-                                         afWin, fDstNoDataValue,
-                                         pfnAlg, pData, bComputeAtEdges);
-        }
+    CPLWorkerThreadPool* poThreadPool = new (std::nothrow) CPLWorkerThreadPool();
+    if( poThreadPool != NULL && !poThreadPool->Setup(nThreads, NULL, NULL) )
+    {
+        delete poThreadPool;
+        poThreadPool = NULL;
+    }
+    return poThreadPool;
+}
 
-        /* -----------------------------------------
-         * Write Line to Raster
-         */
-        eErr = GDALRasterIO(hDstBand, GF_Write, 0, i, nXSize, 1,
-                     pafOutputBuf, nXSize, 1, GDT_Float32, 0, 0);
-        if (eErr != CE_None)
-            goto end;
+/************************************************************************/
+/*                  GDALGeneric3x3Processing()                          */
+/************************************************************************/
 
-        if( !pfnProgress( 1.0 * (i+1) / nYSize, NULL, pProgressData ) )
-        {
-            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
-            eErr = CE_Failure;
-            goto end;
-        }
+static
+CPLErr GDALGeneric3x3Processing  ( GDALRasterBandH hSrcBand,
+                                   GDALRasterBandH hDstBand,
+                                   GDALGeneric3x3ProcessingAlg pfnAlg,
+                                   GDALGeneric3x3ProcessingRowAlg pfnRowAlg,
+                                   void* pData,
+                                   int bComputeAtEdges,
+                                   GDALProgressFunc pfnProgress,
+                                   void * pProgressData)
+{
+    int bDstHasNoData;
+    float fDstNoDataValue = 0.0;
 
-        int nTemp = nLine1Off;
-        nLine1Off = nLine2Off;
-        nLine2Off = nLine3Off;
-        nLine3Off = nTemp;
+    if (pfnProgress == NULL)
+        pfnProgress = GDALDummyProgress;
+
+/* -------------------------------------------------------------------- */
+/*      Initialize progress counter.                                    */
+/* -------------------------------------------------------------------- */
+    if( !pfnProgress( 0.0, NULL, pProgressData ) )
+    {
+        CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+        return CE_Failure;
     }
 
-    if (bComputeAtEdges && nXSize >= 2 && nYSize >= 2)
+    fDstNoDataValue = (float) GDALGetRasterNoDataValue(hDstBand, &bDstHasNoData);
+    if (!bDstHasNoData)
+        fDstNoDataValue = 0.0;
+
+    GDALGeneric3x3ProcessingParams sParams;
+    GDALGeneric3x3InitParams(&sParams, hSrcBand, pfnAlg, pfnRowAlg, pData,
+                             bComputeAtEdges, fDstNoDataValue);
+    const int nXSize = sParams.nXSize;
+    const int nYSize = sParams.nYSize;
+
+/* -------------------------------------------------------------------- */
+/*      The raster is processed by chunks of lines that are a multiple  */
+/*      of the output block height when it is reasonable, so that       */
+/*      each chunk completes whole output blocks.  Each chunk is        */
+/*      shared between the threads.                                     */
+/* -------------------------------------------------------------------- */
+    const int nThreads = GDALGeneric3x3GetThreadCount();
+    int nBlockXSize, nBlockYSize;
+    GDALGetBlockSize(hDstBand, &nBlockXSize, &nBlockYSize);
+
+    int nChunkLines = 32 * nThreads;
+    if( nBlockYSize > 0 && nBlockYSize <= 1024 )
+        nChunkLines = ((nChunkLines + nBlockYSize - 1) / nBlockYSize) * nBlockYSize;
+    nChunkLines = MIN(nChunkLines, nYSize);
+
+    float* pafSrcBuf = (float *)
+        VSI_MALLOC3_VERBOSE(sizeof(float), nXSize, nChunkLines + 2);
+    float* pafDstBuf = (float *)
+        VSI_MALLOC3_VERBOSE(sizeof(float), nXSize, nChunkLines);
+    if( pafSrcBuf == NULL || pafDstBuf == NULL )
     {
-        for (j = 0; j < nXSize; j++)
-        {
-            float afWin[9];
-            int jmin = (j == 0) ? j : j - 1;
-            int jmax = (j == nXSize - 1) ? j : j + 1;
+        VSIFree(pafSrcBuf);
+        VSIFree(pafDstBuf);
+        return CE_Failure;
+    }
 
-            afWin[0] = pafThreeLineWin[nLine1Off + jmin];
-            afWin[1] = pafThreeLineWin[nLine1Off + j];
-            afWin[2] = pafThreeLineWin[nLine1Off + jmax];
-            afWin[3] = pafThreeLineWin[nLine2Off + jmin];
-            afWin[4] = pafThreeLineWin[nLine2Off + j];
-            afWin[5] = pafThreeLineWin[nLine2Off + jmax];
-            afWin[6] = INTERPOL(pafThreeLineWin[nLine2Off + jmin], pafThreeLineWin[nLine1Off + jmin]);
-            afWin[7] = INTERPOL(pafThreeLineWin[nLine2Off + j],    pafThreeLineWin[nLine1Off + j]);
-            afWin[8] = INTERPOL(pafThreeLineWin[nLine2Off + jmax], pafThreeLineWin[nLine1Off + jmax]);
+    CPLWorkerThreadPool* poThreadPool = GDALGeneric3x3CreateThreadPool(nThreads);
 
-            pafOutputBuf[j] = ComputeVal(bSrcHasNoData, fSrcNoDataValue,
-                                         bIsSrcNoDataNan,
-                                         afWin, fDstNoDataValue,
-                                         pfnAlg, pData, bComputeAtEdges);
-        }
-        eErr = GDALRasterIO(hDstBand, GF_Write,
-                     0, i, nXSize, 1,
-                     pafOutputBuf, nXSize, 1, GDT_Float32, 0, 0);
+    CPLErr eErr = CE_None;
+    for( int nYOff = 0; nYOff < nYSize && eErr == CE_None; nYOff += nChunkLines )
+    {
+        const int nYCount = MIN(nChunkLines, nYSize - nYOff);
+
+        eErr = GDALGeneric3x3ProcessLines(&sParams, poThreadPool, nThreads,
+                                          nYOff, nYCount,
+                                          pafSrcBuf, pafDstBuf);
         if( eErr != CE_None )
-            goto end;
-    }
+            break;
 
-    pfnProgress( 1.0, NULL, pProgressData );
-    eErr = CE_None;
+        eErr = GDALRasterIO(hDstBand, GF_Write, 0, nYOff, nXSize, nYCount,
+                            pafDstBuf, nXSize, nYCount, GDT_Float32, 0, 0);
+        if( eErr != CE_None )
+            break;
 
-end:
-    CPLFree(pafOutputBuf);
-    CPLFree(pafThreeLineWin);
+        if( !pfnProgress( 1.0 * (nYOff + nYCount) / nYSize, NULL, pProgressData ) )
+        {
+            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+            eErr = CE_Failure;
+        }
+    }
+
+    delete poThreadPool;
+    CPLFree(pafSrcBuf);
+    CPLFree(pafDstBuf);
 
     return eErr;
 }
@@ -450,6 +671,8 @@ typedef struct
     double sin_altRadians;
     double cos_altRadians_mul_z_scale_factor;
     double azRadians;
+    double cos_az_mul_cos_alt_mul_z;
+    double sin_az_mul_cos_alt_mul_z;
     double square_z_scale_factor;
     double square_M_PI_2;
 } GDALHillshadeAlgData;
@@ -472,11 +695,16 @@ typedef struct
            cos(az * degreesToRadians - M_PI/2 - aspect);
 */
 
+/* In the implementations below, sqrt(x*x + y*y) * sin(aspect - az) is
+   expanded as y * cos(az) - x * sin(az), which avoids calling atan2() and
+   sin() for each pixel.
+*/
+
 static
 float GDALHillshadeAlg (float* afWin, CPL_UNUSED float fDstNoDataValue, void* pData)
 {
     GDALHillshadeAlgData* psData = (GDALHillshadeAlgData*)pData;
-    double x, y, aspect, xx_plus_yy, cang;
+    double x, y, xx_plus_yy, cang;
 
     // First Slope ...
     x = ((afWin[0] + afWin[3] + afWin[3] + afWin[6]) -
@@ -487,13 +715,11 @@ float GDALHillshadeAlg (float* afWin, CPL_UNUSED float fDstNoDataValue, void* pD
 
     xx_plus_yy = x * x + y * y;
 
-    // ... then aspect...
-    aspect = atan2(y,x);
 
     // ... then the shade value
     cang = (psData->sin_altRadians -
-           psData->cos_altRadians_mul_z_scale_factor * sqrt(xx_plus_yy) *
-           sin(aspect - psData->azRadians)) /
+           (y * psData->cos_az_mul_cos_alt_mul_z -
+            x * psData->sin_az_mul_cos_alt_mul_z)) /
            sqrt(1 + psData->square_z_scale_factor * xx_plus_yy);
 
     if (cang <= 0.0)
@@ -508,7 +734,7 @@ static
 float GDALHillshadeCombinedAlg (float* afWin, CPL_UNUSED float fDstNoDataValue, void* pData)
 {
     GDALHillshadeAlgData* psData = (GDALHillshadeAlgData*)pData;
-    double x, y, aspect, xx_plus_yy, cang;
+    double x, y, xx_plus_yy, cang;
 
     // First Slope ...
     x = ((afWin[0] + afWin[3] + afWin[3] + afWin[6]) -
@@ -519,14 +745,12 @@ float GDALHillshadeCombinedAlg (float* afWin, CPL_UNUSED float fDstNoDataValue,
 
     xx_plus_yy = x * x + y * y;
 
-    // ... then aspect...
-    aspect = atan2(y,x);
     double slope = xx_plus_yy * psData->square_z_scale_factor;
 
     // ... then the shade value
     cang = acos((psData->sin_altRadians -
-           psData->cos_altRadians_mul_z_scale_factor * sqrt(xx_plus_yy) *
-           sin(aspect - psData->azRadians)) /
+           (y * psData->cos_az_mul_cos_alt_mul_z -
+            x * psData->sin_az_mul_cos_alt_mul_z)) /
            sqrt(1 + slope));
 
     // combined shading
@@ -544,7 +768,7 @@ static
 float GDALHillshadeZevenbergenThorneAlg (float* afWin, CPL_UNUSED float fDstNoDataValue, void* pData)
 {
     GDALHillshadeAlgData* psData = (GDALHillshadeAlgData*)pData;
-    double x, y, aspect, xx_plus_yy, cang;
+    double x, y, xx_plus_yy, cang;
 
     // First Slope ...
     x = (afWin[3] - afWin[5]) / psData->ewres;
@@ -553,13 +777,11 @@ float GDALHillshadeZevenbergenThorneAlg (float* afWin, CPL_UNUSED float fDstNoDa
 
     xx_plus_yy = x * x + y * y;
 
-    // ... then aspect...
-    aspect = atan2(y,x);
 
     // ... then the shade value
     cang = (psData->sin_altRadians -
-           psData->cos_altRadians_mul_z_scale_factor * sqrt(xx_plus_yy) *
-           sin(aspect - psData->azRadians)) /
+           (y * psData->cos_az_mul_cos_alt_mul_z -
+            x * psData->sin_az_mul_cos_alt_mul_z)) /
            sqrt(1 + psData->square_z_scale_factor * xx_plus_yy);
 
     if (cang <= 0.0)
@@ -574,7 +796,7 @@ static
 float GDALHillshadeZevenbergenThorneCombinedAlg (float* afWin, CPL_UNUSED float fDstNoDataValue, void* pData)
 {
     GDALHillshadeAlgData* psData = (GDALHillshadeAlgData*)pData;
-    double x, y, aspect, xx_plus_yy, cang;
+    double x, y, xx_plus_yy, cang;
 
     // First Slope ...
     x = (afWin[3] - afWin[5]) / psData->ewres;
@@ -583,14 +805,12 @@ float GDALHillshadeZevenbergenThorneCombinedAlg (float* afWin, CPL_UNUSED float
 
     xx_plus_yy = x * x + y * y;
 
-    // ... then aspect...
-    aspect = atan2(y,x);
     double slope = xx_plus_yy * psData->square_z_scale_factor;
 
     // ... then the shade value
     cang = acos((psData->sin_altRadians -
-           psData->cos_altRadians_mul_z_scale_factor * sqrt(xx_plus_yy) *
-           sin(aspect - psData->azRadians)) /
+           (y * psData->cos_az_mul_cos_alt_mul_z -
+            x * psData->sin_az_mul_cos_alt_mul_z)) /
            sqrt(1 + slope));
 
     // combined shading
@@ -623,6 +843,10 @@ void*  GDALCreateHillshadeData(double* adfGeoTransform,
     double z_scale_factor = z / (((bZevenbergenThorne) ? 2 : 8) * scale);
     pData->cos_altRadians_mul_z_scale_factor =
         cos(alt * degreesToRadians) * z_scale_factor;
+    pData->cos_az_mul_cos_alt_mul_z =
+        pData->cos_altRadians_mul_z_scale_factor * cos(pData->azRadians);
+    pData->sin_az_mul_cos_alt_mul_z =
+        pData->cos_altRadians_mul_z_scale_factor * sin(pData->azRadians);
     pData->square_z_scale_factor = z_scale_factor * z_scale_factor;
     pData->square_M_PI_2 = (M_PI*M_PI)/4;
     return pData;
@@ -1943,6 +2167,50 @@ float GDALRoughnessAlg (float* afWin, CPL_UNUSED float fDstNoDataValue, CPL_UNUS
     return pafRoughnessMax - pafRoughnessMin;
 }
 
+/************************************************************************/
+/*                       Row versions of the algorithms                 */
+/************************************************************************/
+
+/* The per pixel algorithm is called directly, and not through a function */
+/* pointer, so that the compiler can inline it in the loop. */
+#define GDAL_DEFINE_3X3_ROW_ALG(RowAlgName, AlgName)                       \
+static void RowAlgName (const float* pafLine1, const float* pafLine2,      \
+                        const float* pafLine3, int nXSize,                 \
+                        float* pafOutLine, float fDstNoDataValue,          \
+                        void* pData)                                       \
+{                                                                          \
+    for( int j = 1; j < nXSize - 1; j++ )                                  \
+    {                                                                      \
+        float afWin[9];                                                    \
+        afWin[0] = pafLine1[j-1];                                          \
+        afWin[1] = pafLine1[j];                                            \
+        afWin[2] = pafLine1[j+1];                                          \
+        afWin[3] = pafLine2[j-1];                                          \
+        afWin[4] = pafLine2[j];                                            \
+        afWin[5] = pafLine2[j+1];                                          \
+        afWin[6] = pafLine3[j-1];                                          \
+        afWin[7] = pafLine3[j];                                            \
+        afWin[8] = pafLine3[j+1];                                          \
+        pafOutLine[j] = AlgName(afWin, fDstNoDataValue, pData);            \
+    }                                                                      \
+}
+
+GDAL_DEFINE_3X3_ROW_ALG(GDALHillshadeRowAlg, GDALHillshadeAlg)
+GDAL_DEFINE_3X3_ROW_ALG(GDALHillshadeCombinedRowAlg, GDALHillshadeCombinedAlg)
+GDAL_DEFINE_3X3_ROW_ALG(GDALHillshadeZevenbergenThorneRowAlg,
+                        GDALHillshadeZevenbergenThorneAlg)
+GDAL_DEFINE_3X3_ROW_ALG(GDALHillshadeZevenbergenThorneCombinedRowAlg,
+                        GDALHillshadeZevenbergenThorneCombinedAlg)
+GDAL_DEFINE_3X3_ROW_ALG(GDALSlopeHornRowAlg, GDALSlopeHornAlg)
+GDAL_DEFINE_3X3_ROW_ALG(GDALSlopeZevenbergenThorneRowAlg,
+                        GDALSlopeZevenbergenThorneAlg)
+GDAL_DEFINE_3X3_ROW_ALG(GDALAspectRowAlg, GDALAspectAlg)
+GDAL_DEFINE_3X3_ROW_ALG(GDALAspectZevenbergenThorneRowAlg,
+                        GDALAspectZevenbergenThorneAlg)
+GDAL_DEFINE_3X3_ROW_ALG(GDALTRIRowAlg, GDALTRIAlg)
+GDAL_DEFINE_3X3_ROW_ALG(GDALTPIRowAlg, GDALTPIAlg)
+GDAL_DEFINE_3X3_ROW_ALG(GDALRoughnessRowAlg, GDALRoughnessAlg)
+
 /************************************************************************/
 /* ==================================================================== */
 /*                       GDALGeneric3x3Dataset                        */
@@ -1955,15 +2223,14 @@ class GDALGeneric3x3Dataset : public GDALDataset
 {
     friend class GDALGeneric3x3RasterBand;
 
-    GDALGeneric3x3ProcessingAlg pfnAlg;
-    void*              pAlgData;
     GDALDatasetH       hSrcDS;
-    GDALRasterBandH    hSrcBand;
-    float*             apafSourceBuf[3];
+    GDALGeneric3x3ProcessingParams sParams;
+    int                nThreads;
+    CPLWorkerThreadPool* poThreadPool;
+    float*             pafSourceBuf;
+    float*             pafOutputBuf;
     int                bDstHasNoData;
     double             dfDstNoDataValue;
-    int                nCurLine;
-    int                bComputeAtEdges;
 
   public:
                         GDALGeneric3x3Dataset(GDALDatasetH hSrcDS,
@@ -1972,13 +2239,13 @@ class GDALGeneric3x3Dataset : public GDALDataset
                                               int bDstHasNoData,
                                               double dfDstNoDataValue,
                                               GDALGeneric3x3ProcessingAlg pfnAlg,
+                                              GDALGeneric3x3ProcessingRowAlg pfnRowAlg,
                                               void* pAlgData,
                                               int bComputeAtEdges);
                        ~GDALGeneric3x3Dataset();
 
-    bool                InitOK() const { return apafSourceBuf[0] != NULL &&
-                                                apafSourceBuf[1] != NULL &&
-                                                apafSourceBuf[2] != NULL; }
+    bool                InitOK() const { return pafSourceBuf != NULL &&
+                                                pafOutputBuf != NULL; }
 
     CPLErr      GetGeoTransform( double * padfGeoTransform );
     const char *GetProjectionRef();
@@ -1993,15 +2260,11 @@ class GDALGeneric3x3Dataset : public GDALDataset
 class GDALGeneric3x3RasterBand : public GDALRasterBand
 {
     friend class GDALGeneric3x3Dataset;
-    int bSrcHasNoData;
-    float fSrcNoDataValue;
-    int bIsSrcNoDataNan;
-
-    void                    InitWidthNoData(void* pImage);
 
   public:
                  GDALGeneric3x3RasterBand( GDALGeneric3x3Dataset *poDS,
-                                           GDALDataType eDstDataType );
+                                           GDALDataType eDstDataType,
+                                           int nBlockYSize );
 
     virtual CPLErr          IReadBlock( int, int, void * );
     virtual double          GetNoDataValue( int* pbHasNoData );
@@ -2014,36 +2277,43 @@ GDALGeneric3x3Dataset::GDALGeneric3x3Dataset(
                                      int bDstHasNoDataIn,
                                      double dfDstNoDataValueIn,
                                      GDALGeneric3x3ProcessingAlg pfnAlgIn,
+                                     GDALGeneric3x3ProcessingRowAlg pfnRowAlgIn,
                                      void* pAlgDataIn,
                                      int bComputeAtEdgesIn)
 {
     hSrcDS = hSrcDSIn;
-    hSrcBand = hSrcBandIn;
-    pfnAlg = pfnAlgIn;
-    pAlgData = pAlgDataIn;
     bDstHasNoData = bDstHasNoDataIn;
     dfDstNoDataValue = dfDstNoDataValueIn;
-    bComputeAtEdges = bComputeAtEdgesIn;
+
+    GDALGeneric3x3InitParams(&sParams, hSrcBandIn, pfnAlgIn, pfnRowAlgIn,
+                             pAlgDataIn, bComputeAtEdgesIn,
+                             (float) dfDstNoDataValueIn);
 
     CPLAssert(eDstDataType == GDT_Byte || eDstDataType == GDT_Float32);
 
     nRasterXSize = GDALGetRasterXSize(hSrcDS);
     nRasterYSize = GDALGetRasterYSize(hSrcDS);
 
-    SetBand(1, new GDALGeneric3x3RasterBand(this, eDstDataType));
+    // Blocks of several lines, so that each one can be shared between
+    // the threads.
+    nThreads = GDALGeneric3x3GetThreadCount();
+    const int nBlockYSize = MIN(32 * nThreads, nRasterYSize);
 
-    apafSourceBuf[0] = (float *) VSI_MALLOC2_VERBOSE(sizeof(float),nRasterXSize);
-    apafSourceBuf[1] = (float *) VSI_MALLOC2_VERBOSE(sizeof(float),nRasterXSize);
-    apafSourceBuf[2] = (float *) VSI_MALLOC2_VERBOSE(sizeof(float),nRasterXSize);
+    SetBand(1, new GDALGeneric3x3RasterBand(this, eDstDataType, nBlockYSize));
 
-    nCurLine = -1;
+    pafSourceBuf = (float *)
+        VSI_MALLOC3_VERBOSE(sizeof(float), nRasterXSize, nBlockYSize + 2);
+    pafOutputBuf = (float *)
+        VSI_MALLOC3_VERBOSE(sizeof(float), nRasterXSize, nBlockYSize);
+
+    poThreadPool = GDALGeneric3x3CreateThreadPool(nThreads);
 }
 
 GDALGeneric3x3Dataset::~GDALGeneric3x3Dataset()
 {
-    CPLFree(apafSourceBuf[0]);
-    CPLFree(apafSourceBuf[1]);
-    CPLFree(apafSourceBuf[2]);
+    delete poThreadPool;
+    CPLFree(pafSourceBuf);
+    CPLFree(pafOutputBuf);
 }
 
 CPLErr GDALGeneric3x3Dataset::GetGeoTransform( double * padfGeoTransform )
@@ -2057,296 +2327,49 @@ const char *GDALGeneric3x3Dataset::GetProjectionRef()
 }
 
 GDALGeneric3x3RasterBand::GDALGeneric3x3RasterBand(GDALGeneric3x3Dataset *poDSIn,
-                                                   GDALDataType eDstDataType)
+                                                   GDALDataType eDstDataType,
+                                                   int nBlockYSizeIn)
 {
     poDS = poDSIn;
     this->nBand = 1;
     eDataType = eDstDataType;
     nBlockXSize = poDS->GetRasterXSize();
-    nBlockYSize = 1;
-
-    bSrcHasNoData = FALSE;
-    fSrcNoDataValue = (float)GDALGetRasterNoDataValue(poDSIn->hSrcBand,
-                                                      &bSrcHasNoData);
-    bIsSrcNoDataNan = bSrcHasNoData && CPLIsNan(fSrcNoDataValue);
-}
-
-void   GDALGeneric3x3RasterBand::InitWidthNoData(void* pImage)
-{
-    int j;
-    GDALGeneric3x3Dataset * poGDS = (GDALGeneric3x3Dataset *) poDS;
-    if (eDataType == GDT_Byte)
-    {
-        for(j=0;j<nBlockXSize;j++)
-            ((GByte*)pImage)[j] = (GByte) poGDS->dfDstNoDataValue;
-    }
-    else
-    {
-        for(j=0;j<nBlockXSize;j++)
-            ((float*)pImage)[j] = (float) poGDS->dfDstNoDataValue;
-    }
+    nBlockYSize = nBlockYSizeIn;
 }
 
 CPLErr GDALGeneric3x3RasterBand::IReadBlock( CPL_UNUSED int nBlockXOff,
                                              int nBlockYOff,
                                              void *pImage )
 {
-    int i, j;
-    float fVal;
     GDALGeneric3x3Dataset * poGDS = (GDALGeneric3x3Dataset *) poDS;
 
-    if (poGDS->bComputeAtEdges && nRasterXSize >= 2 && nRasterYSize >= 2)
-    {
-        if (nBlockYOff == 0)
-        {
-            for(i=0;i<2;i++)
-            {
-                CPLErr eErr = GDALRasterIO( poGDS->hSrcBand,
-                                    GF_Read,
-                                    0, i, nBlockXSize, 1,
-                                    poGDS->apafSourceBuf[i+1],
-                                    nBlockXSize, 1,
-                                    GDT_Float32,
-                                    0, 0);
-                if (eErr != CE_None)
-                {
-                    InitWidthNoData(pImage);
-                    return eErr;
-                }
-            }
-            poGDS->nCurLine = 0;
-
-            for (j = 0; j < nRasterXSize; j++)
-            {
-                float afWin[9];
-                int jmin = (j == 0) ? j : j - 1;
-                int jmax = (j == nRasterXSize - 1) ? j : j + 1;
-
-                afWin[0] = INTERPOL(poGDS->apafSourceBuf[1][jmin], poGDS->apafSourceBuf[2][jmin]);
-                afWin[1] = INTERPOL(poGDS->apafSourceBuf[1][j],    poGDS->apafSourceBuf[2][j]);
-                afWin[2] = INTERPOL(poGDS->apafSourceBuf[1][jmax], poGDS->apafSourceBuf[2][jmax]);
-                afWin[3] = poGDS->apafSourceBuf[1][jmin];
-                afWin[4] = poGDS->apafSourceBuf[1][j];
-                afWin[5] = poGDS->apafSourceBuf[1][jmax];
-                afWin[6] = poGDS->apafSourceBuf[2][jmin];
-                afWin[7] = poGDS->apafSourceBuf[2][j];
-                afWin[8] = poGDS->apafSourceBuf[2][jmax];
-
-                fVal = ComputeVal(bSrcHasNoData, fSrcNoDataValue,
-                                  bIsSrcNoDataNan,
-                                    afWin, (float) poGDS->dfDstNoDataValue,
-                                    poGDS->pfnAlg,
-                                    poGDS->pAlgData,
-                                    poGDS->bComputeAtEdges);
-
-                if (eDataType == GDT_Byte)
-                    ((GByte*)pImage)[j] = (GByte) (fVal + 0.5);
-                else
-                    ((float*)pImage)[j] = fVal;
-            }
-
-            return CE_None;
-        }
-        else if (nBlockYOff == nRasterYSize - 1)
-        {
-            if (poGDS->nCurLine != nRasterYSize - 2)
-            {
-                for(i=0;i<2;i++)
-                {
-                    CPLErr eErr = GDALRasterIO( poGDS->hSrcBand,
-                                        GF_Read,
-                                        0, nRasterYSize - 2 + i, nBlockXSize, 1,
-                                        poGDS->apafSourceBuf[i+1],
-                                        nBlockXSize, 1,
-                                        GDT_Float32,
-                                        0, 0);
-                    if (eErr != CE_None)
-                    {
-                        InitWidthNoData(pImage);
-                        return eErr;
-                    }
-                }
-            }
-
-            for (j = 0; j < nRasterXSize; j++)
-            {
-                float afWin[9];
-                int jmin = (j == 0) ? j : j - 1;
-                int jmax = (j == nRasterXSize - 1) ? j : j + 1;
-
-                afWin[0] = poGDS->apafSourceBuf[1][jmin];
-                afWin[1] = poGDS->apafSourceBuf[1][j];
-                afWin[2] = poGDS->apafSourceBuf[1][jmax];
-                afWin[3] = poGDS->apafSourceBuf[2][jmin];
-                afWin[4] = poGDS->apafSourceBuf[2][j];
-                afWin[5] = poGDS->apafSourceBuf[2][jmax];
-                afWin[6] = INTERPOL(poGDS->apafSourceBuf[2][jmin], poGDS->apafSourceBuf[1][jmin]);
-                afWin[7] = INTERPOL(poGDS->apafSourceBuf[2][j],    poGDS->apafSourceBuf[1][j]);
-                afWin[8] = INTERPOL(poGDS->apafSourceBuf[2][jmax], poGDS->apafSourceBuf[1][jmax]);
-
-                fVal = ComputeVal(bSrcHasNoData, fSrcNoDataValue,
-                                  bIsSrcNoDataNan,
-                                    afWin, (float) poGDS->dfDstNoDataValue,
-                                    poGDS->pfnAlg,
-                                    poGDS->pAlgData,
-                                    poGDS->bComputeAtEdges);
-
-                if (eDataType == GDT_Byte)
-                    ((GByte*)pImage)[j] = (GByte) (fVal + 0.5);
-                else
-                    ((float*)pImage)[j] = fVal;
-            }
+    const int nYOff = nBlockYOff * nBlockYSize;
+    const int nYCount = MIN(nBlockYSize, nRasterYSize - nYOff);
+    const size_t nValues = (size_t)nBlockXSize * nYCount;
 
-            return CE_None;
-        }
-    }
-    else if ( nBlockYOff == 0 || nBlockYOff == nRasterYSize - 1)
+    CPLErr eErr = GDALGeneric3x3ProcessLines(&poGDS->sParams,
+                                             poGDS->poThreadPool,
+                                             poGDS->nThreads,
+                                             nYOff, nYCount,
+                                             poGDS->pafSourceBuf,
+                                             poGDS->pafOutputBuf);
+    if (eErr != CE_None)
     {
-        InitWidthNoData(pImage);
-        return CE_None;
+        for(size_t i = 0; i < nValues; i++)
+            poGDS->pafOutputBuf[i] = (float) poGDS->dfDstNoDataValue;
     }
 
-    if ( poGDS->nCurLine != nBlockYOff )
-    {
-        if (poGDS->nCurLine + 1 == nBlockYOff)
-        {
-            float* pafTmp =  poGDS->apafSourceBuf[0];
-            poGDS->apafSourceBuf[0] = poGDS->apafSourceBuf[1];
-            poGDS->apafSourceBuf[1] = poGDS->apafSourceBuf[2];
-            poGDS->apafSourceBuf[2] = pafTmp;
-
-            CPLErr eErr = GDALRasterIO( poGDS->hSrcBand,
-                                    GF_Read,
-                                    0, nBlockYOff + 1, nBlockXSize, 1,
-                                    poGDS->apafSourceBuf[2],
-                                    nBlockXSize, 1,
-                                    GDT_Float32,
-                                    0, 0);
-
-            if (eErr != CE_None)
-            {
-                InitWidthNoData(pImage);
-                return eErr;
-            }
-        }
-        else
-        {
-            for(i=0;i<3;i++)
-            {
-                CPLErr eErr = GDALRasterIO( poGDS->hSrcBand,
-                                    GF_Read,
-                                    0, nBlockYOff + i - 1, nBlockXSize, 1,
-                                    poGDS->apafSourceBuf[i],
-                                    nBlockXSize, 1,
-                                    GDT_Float32,
-                                    0, 0);
-                if (eErr != CE_None)
-                {
-                    InitWidthNoData(pImage);
-                    return eErr;
-                }
-            }
-        }
-
-        poGDS->nCurLine = nBlockYOff;
-    }
-
-    if (poGDS->bComputeAtEdges && nRasterXSize >= 2)
+    if (eDataType == GDT_Byte)
     {
-        float afWin[9];
-
-        j = 0;
-        afWin[0] = INTERPOL(poGDS->apafSourceBuf[0][j], poGDS->apafSourceBuf[0][j+1]);
-        afWin[1] = poGDS->apafSourceBuf[0][j];
-        afWin[2] = poGDS->apafSourceBuf[0][j+1];
-        afWin[3] = INTERPOL(poGDS->apafSourceBuf[1][j], poGDS->apafSourceBuf[1][j+1]);
-        afWin[4] = poGDS->apafSourceBuf[1][j];
-        afWin[5] = poGDS->apafSourceBuf[1][j+1];
-        afWin[6] = INTERPOL(poGDS->apafSourceBuf[2][j], poGDS->apafSourceBuf[2][j+1]);
-        afWin[7] = poGDS->apafSourceBuf[2][j];
-        afWin[8] = poGDS->apafSourceBuf[2][j+1];
-
-        fVal = ComputeVal(bSrcHasNoData, fSrcNoDataValue,
-                          bIsSrcNoDataNan,
-                                    afWin, (float) poGDS->dfDstNoDataValue,
-                                    poGDS->pfnAlg,
-                                    poGDS->pAlgData,
-                                    poGDS->bComputeAtEdges);
-
-        if (eDataType == GDT_Byte)
-            ((GByte*)pImage)[j] = (GByte) (fVal + 0.5);
-        else
-            ((float*)pImage)[j] = fVal;
-
-        j = nRasterXSize - 1;
-
-        afWin[0] = poGDS->apafSourceBuf[0][j-1];
-        afWin[1] = poGDS->apafSourceBuf[0][j];
-        afWin[2] = INTERPOL(poGDS->apafSourceBuf[0][j], poGDS->apafSourceBuf[0][j-1]);
-        afWin[3] = poGDS->apafSourceBuf[1][j-1];
-        afWin[4] = poGDS->apafSourceBuf[1][j];
-        afWin[5] = INTERPOL(poGDS->apafSourceBuf[1][j], poGDS->apafSourceBuf[1][j-1]);
-        afWin[6] = poGDS->apafSourceBuf[2][j-1];
-        afWin[7] = poGDS->apafSourceBuf[2][j];
-        afWin[8] = INTERPOL(poGDS->apafSourceBuf[2][j], poGDS->apafSourceBuf[2][j-1]);
-
-        fVal = ComputeVal(bSrcHasNoData, fSrcNoDataValue,
-                          bIsSrcNoDataNan,
-                                    afWin, (float) poGDS->dfDstNoDataValue,
-                                    poGDS->pfnAlg,
-                                    poGDS->pAlgData,
-                                    poGDS->bComputeAtEdges);
-
-        if (eDataType == GDT_Byte)
-            ((GByte*)pImage)[j] = (GByte) (fVal + 0.5);
-        else
-            ((float*)pImage)[j] = fVal;
+        for(size_t i = 0; i < nValues; i++)
+            ((GByte*)pImage)[i] = (GByte) (poGDS->pafOutputBuf[i] + 0.5);
     }
     else
     {
-        if (eDataType == GDT_Byte)
-        {
-            ((GByte*)pImage)[0] = (GByte) poGDS->dfDstNoDataValue;
-            if (nBlockXSize > 1)
-                ((GByte*)pImage)[nBlockXSize - 1] = (GByte) poGDS->dfDstNoDataValue;
-        }
-        else
-        {
-            ((float*)pImage)[0] = (float) poGDS->dfDstNoDataValue;
-            if (nBlockXSize > 1)
-                ((float*)pImage)[nBlockXSize - 1] = (float) poGDS->dfDstNoDataValue;
-        }
+        memcpy(pImage, poGDS->pafOutputBuf, nValues * sizeof(float));
     }
 
-
-    for(j=1;j<nBlockXSize - 1;j++)
-    {
-        float afWin[9];
-        afWin[0] = poGDS->apafSourceBuf[0][j-1];
-        afWin[1] = poGDS->apafSourceBuf[0][j];
-        afWin[2] = poGDS->apafSourceBuf[0][j+1];
-        afWin[3] = poGDS->apafSourceBuf[1][j-1];
-        afWin[4] = poGDS->apafSourceBuf[1][j];
-        afWin[5] = poGDS->apafSourceBuf[1][j+1];
-        afWin[6] = poGDS->apafSourceBuf[2][j-1];
-        afWin[7] = poGDS->apafSourceBuf[2][j];
-        afWin[8] = poGDS->apafSourceBuf[2][j+1];
-
-        fVal = ComputeVal(bSrcHasNoData, fSrcNoDataValue,
-                          bIsSrcNoDataNan,
-                                afWin, (float) poGDS->dfDstNoDataValue,
-                                poGDS->pfnAlg,
-                                poGDS->pAlgData,
-                                poGDS->bComputeAtEdges);
-
-        if (eDataType == GDT_Byte)
-            ((GByte*)pImage)[j] = (GByte) (fVal + 0.5);
-        else
-            ((float*)pImage)[j] = fVal;
-
-    }
-
-    return CE_None;
+    return eErr;
 }
 
 double GDALGeneric3x3RasterBand::GetNoDataValue( int* pbHasNoData )
@@ -2571,6 +2594,7 @@ GDALDatasetH GDALDEMProcessing(const char *pszDest,
     int bDstHasNoData = FALSE;
     void* pData = NULL;
     GDALGeneric3x3ProcessingAlg pfnAlg = NULL;
+    GDALGeneric3x3ProcessingRowAlg pfnRowAlg = NULL;
 
     if (eUtilityMode == HILL_SHADE)
     {
@@ -2585,16 +2609,28 @@ GDALDatasetH GDALDEMProcessing(const char *pszDest,
         if (psOptions->bZevenbergenThorne)
         {
             if(!psOptions->bCombined)
+            {
                 pfnAlg = GDALHillshadeZevenbergenThorneAlg;
+                pfnRowAlg = GDALHillshadeZevenbergenThorneRowAlg;
+            }
             else
+            {
                 pfnAlg = GDALHillshadeZevenbergenThorneCombinedAlg;
+                pfnRowAlg = GDALHillshadeZevenbergenThorneCombinedRowAlg;
+            }
         }
         else
         {
             if(!psOptions->bCombined)
+            {
                 pfnAlg = GDALHillshadeAlg;
+                pfnRowAlg = GDALHillshadeRowAlg;
+            }
             else
+            {
                 pfnAlg = GDALHillshadeCombinedAlg;
+                pfnRowAlg = GDALHillshadeCombinedRowAlg;
+            }
         }
     }
     else if (eUtilityMode == SLOPE)
@@ -2604,9 +2640,15 @@ GDALDatasetH GDALDEMProcessing(const char *pszDest,
 
         pData = GDALCreateSlopeData(adfGeoTransform, psOptions->scale, psOptions->slopeFormat);
         if (psOptions->bZevenbergenThorne)
+        {
             pfnAlg = GDALSlopeZevenbergenThorneAlg;
+            pfnRowAlg = GDALSlopeZevenbergenThorneRowAlg;
+        }
         else
+        {
             pfnAlg = GDALSlopeHornAlg;
+            pfnRowAlg = GDALSlopeHornRowAlg;
+        }
     }
 
     else if (eUtilityMode == ASPECT)
@@ -2619,27 +2661,36 @@ GDALDatasetH GDALDEMProcessing(const char *pszDest,
 
         pData = GDALCreateAspectData(psOptions->bAngleAsAzimuth);
         if (psOptions->bZevenbergenThorne)
+        {
             pfnAlg = GDALAspectZevenbergenThorneAlg;
+            pfnRowAlg = GDALAspectZevenbergenThorneRowAlg;
+        }
         else
+        {
             pfnAlg = GDALAspectAlg;
+            pfnRowAlg = GDALAspectRowAlg;
+        }
     }
     else if (eUtilityMode == TRI)
     {
         dfDstNoDataValue = -9999;
         bDstHasNoData = TRUE;
         pfnAlg = GDALTRIAlg;
+        pfnRowAlg = GDALTRIRowAlg;
     }
     else if (eUtilityMode == TPI)
     {
         dfDstNoDataValue = -9999;
         bDstHasNoData = TRUE;
         pfnAlg = GDALTPIAlg;
+        pfnRowAlg = GDALTPIRowAlg;
     }
     else if (eUtilityMode == ROUGHNESS)
     {
         dfDstNoDataValue = -9999;
         bDstHasNoData = TRUE;
         pfnAlg = GDALRoughnessAlg;
+        pfnRowAlg = GDALRoughnessRowAlg;
     }
 
     GDALDataType eDstDataType = (eUtilityMode == HILL_SHADE ||
@@ -2735,6 +2786,7 @@ GDALDatasetH GDALDEMProcessing(const char *pszDest,
                                           bDstHasNoData,
                                           dfDstNoDataValue,
                                           pfnAlg,
+                                          pfnRowAlg,
                                           pData,
                                           psOptions->bComputeAtEdges);
             if( !(poDS->InitOK()) )
@@ -2805,7 +2857,7 @@ GDALDatasetH GDALDEMProcessing(const char *pszDest,
             GDALSetRasterNoDataValue(hDstBand, dfDstNoDataValue);
 
         GDALGeneric3x3Processing(hSrcBand, hDstBand,
-                                 pfnAlg, pData,
+                                 pfnAlg, pfnRowAlg, pData,
                                  psOptions->bComputeAtEdges,
                                  pfnProgress, pProgressData);
 
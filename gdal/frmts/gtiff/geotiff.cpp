@@ -42,6 +42,7 @@
 
 #include "cpl_csv.h"
 #include "cplkeywordparser.h"
+#include "cpl_metrics.h"
 #include "cpl_minixml.h"
 #include "cpl_multiproc.h"
 #include "cpl_string.h"
@@ -191,6 +192,7 @@ typedef struct
     GByte        *pabyBuffer;
     int           nBufferSize;
     int           nStripOrTile;
+    CPLMetric    *psEncodeTimeMetric;
 
     GByte        *pabyCompressedBuffer; /* owned by pszTmpFilename */
     int           nCompressedBufferSize;
@@ -250,6 +252,10 @@ class GTiffDataset CPL_FINAL : public GDALPamDataset
     CPLErr      FlushBlockBuf();
     int         bWriteErrorInFlushBlockBuf;
 
+    CPLMetric  *psDecodeTimeMetric;
+    CPLMetric  *psEncodeTimeMetric;
+    CPLMetric  *GetCodecMetric( bool bEncode );
+
     char        *pszProjection;
     int         bLookedForProjection;
     int         bLookedForMDAreaOrPoint;
@@ -3651,6 +3657,7 @@ CPLErr GTiffRasterBand::IReadBlock( int nBlockXOff, int nBlockYOff,
         if( nBlockReqSize < nBlockBufSize )
             memset( pImage, 0, nBlockBufSize );
 
+        const GIntBig nStartTime = CPLMetricsGetTimeMicroseconds();
         if( TIFFIsTiled( poGDS->hTIFF ) )
         {
             if( TIFFReadEncodedTile( poGDS->hTIFF, nBlockId, pImage,
@@ -3677,6 +3684,8 @@ CPLErr GTiffRasterBand::IReadBlock( int nBlockXOff, int nBlockYOff,
                 eErr = CE_Failure;
             }
         }
+        CPLMetricRecord( poGDS->GetCodecMetric(false), static_cast<double>(
+                            CPLMetricsGetTimeMicroseconds() - nStartTime) );
 
         return eErr;
     }
@@ -6010,6 +6019,8 @@ GTiffDataset::GTiffDataset() :
     bLoadedBlockDirty = FALSE;
     pabyBlockBuf = NULL;
     bWriteErrorInFlushBlockBuf = FALSE;
+    psDecodeTimeMetric = NULL;
+    psEncodeTimeMetric = NULL;
     hTIFF = NULL;
     fpL = NULL;
     bStreamingIn = FALSE;
@@ -6609,7 +6620,10 @@ bool GTiffDataset::WriteEncodedTile(uint32 tile, GByte *pabyData,
 #if !defined(INTERNAL_LIBTIFF) && (!defined(TIFFLIB_VERSION) || (TIFFLIB_VERSION <= 20150912))
     CPLErr eBefore = CPLGetLastErrorType();
 #endif
+    const GIntBig nStartTime = CPLMetricsGetTimeMicroseconds();
     bool bRet = static_cast<int>(TIFFWriteEncodedTile(hTIFF, tile, pabyData, cc)) == cc;
+    CPLMetricRecord( GetCodecMetric(true), static_cast<double>(
+                        CPLMetricsGetTimeMicroseconds() - nStartTime) );
 #if !defined(INTERNAL_LIBTIFF) && (!defined(TIFFLIB_VERSION) || (TIFFLIB_VERSION <= 20150912))
     if( eBefore == CE_None && CPLGetLastErrorType() == CE_Failure )
         bRet = FALSE;
@@ -6617,6 +6631,33 @@ bool GTiffDataset::WriteEncodedTile(uint32 tile, GByte *pabyData,
     return bRet;
 }
 
+/************************************************************************/
+/*                           GetCodecMetric()                           */
+/************************************************************************/
+
+/* Return the histogram of the time spent in libtiff to decode or encode */
+/* a strip or tile, named after the codec, for example */
+/* gtiff.lzw.decode_time_us. The decoding time includes the reading of */
+/* the compressed data. Must be called from the thread using the dataset: */
+/* compression jobs get the handle when they are submitted. */
+CPLMetric* GTiffDataset::GetCodecMetric( bool bEncode )
+{
+    CPLMetric*& psMetric = bEncode ? psEncodeTimeMetric : psDecodeTimeMetric;
+    if( psMetric == NULL )
+    {
+        const TIFFCodec* psCodec = TIFFFindCODEC(nCompression);
+        CPLString osCodec;
+        if( psCodec != NULL && psCodec->name != NULL )
+            osCodec = CPLString(psCodec->name).tolower();
+        else
+            osCodec.Printf("compression%d", nCompression);
+        psMetric = CPLMetricGetHistogram(
+            CPLSPrintf("gtiff.%s.%s_time_us", osCodec.c_str(),
+                       bEncode ? "encode" : "decode"));
+    }
+    return psMetric;
+}
+
 /************************************************************************/
 /*                        WriteEncodedStrip()                           */
 /************************************************************************/
@@ -6693,7 +6734,10 @@ bool GTiffDataset::WriteEncodedStrip(uint32 strip, GByte* pabyData,
 #if !defined(INTERNAL_LIBTIFF) && (!defined(TIFFLIB_VERSION) || (TIFFLIB_VERSION <= 20150912))
     CPLErr eBefore = CPLGetLastErrorType();
 #endif
+    const GIntBig nStartTime = CPLMetricsGetTimeMicroseconds();
     bool bRet = static_cast<int>(TIFFWriteEncodedStrip(hTIFF, strip, pabyData, cc)) == cc;
+    CPLMetricRecord( GetCodecMetric(true), static_cast<double>(
+                        CPLMetricsGetTimeMicroseconds() - nStartTime) );
 #if !defined(INTERNAL_LIBTIFF) && (!defined(TIFFLIB_VERSION) || (TIFFLIB_VERSION <= 20150912))
     if( eBefore == CE_None && CPLGetLastErrorType() == CE_Failure )
         bRet = FALSE;
@@ -6826,9 +6870,12 @@ void GTiffDataset::ThreadCompressionFunc(void* pData)
     TIFFSetField(hTIFFTmp, TIFFTAG_ROWSPERSTRIP, poDS->nBlockYSize);
     TIFFSetField(hTIFFTmp, TIFFTAG_PLANARCONFIG, poDS->nPlanarConfig);
 
+    const GIntBig nStartTime = CPLMetricsGetTimeMicroseconds();
     bool bOK
         = (TIFFWriteEncodedStrip(hTIFFTmp, 0, psJob->pabyBuffer,
                                  psJob->nBufferSize) == psJob->nBufferSize);
+    CPLMetricRecord( psJob->psEncodeTimeMetric, static_cast<double>(
+                        CPLMetricsGetTimeMicroseconds() - nStartTime) );
 
     int nOffset = 0;
     if( bOK )
@@ -7004,6 +7051,9 @@ int GTiffDataset::SubmitCompressionJob(int nStripOrTile, GByte* pabyData,
         TIFFGetField( hTIFF, TIFFTAG_PREDICTOR, &psJob->nPredictor );
     }
 
+    /* Resolved in this thread, as GetCodecMetric() is not thread-safe */
+    psJob->psEncodeTimeMetric = GetCodecMetric(true);
+
     poCompressThreadPool->SubmitJob(ThreadCompressionFunc, psJob);
     return TRUE;
 }
@@ -7248,6 +7298,7 @@ CPLErr GTiffDataset::LoadBlockBuf( int nBlockId, int bReadFromDisk )
 /* -------------------------------------------------------------------- */
 /*      Load the block, if it isn't our current block.                  */
 /* -------------------------------------------------------------------- */
+    const GIntBig nStartTime = CPLMetricsGetTimeMicroseconds();
     if( TIFFIsTiled( hTIFF ) )
     {
         if( TIFFReadEncodedTile(hTIFF, nBlockId, pabyBlockBuf,
@@ -7278,6 +7329,8 @@ CPLErr GTiffDataset::LoadBlockBuf( int nBlockId, int bReadFromDisk )
             eErr = CE_Failure;
         }
     }
+    CPLMetricRecord( GetCodecMetric(false), static_cast<double>(
+                        CPLMetricsGetTimeMicroseconds() - nStartTime) );
 
     if( eErr == CE_None )
     {
@@ -7919,6 +7972,7 @@ CPLErr GTiffDataset::RegisterNewOverviewDataset(toff_t nOverviewOffset)
                         nOverviewCount * (sizeof(void*)));
         papoOverviewDS[nOverviewCount-1] = poODS;
         poODS->poBaseDS = this;
+        poODS->SetCacheAccountingOwner(this);
         return CE_None;
     }
 }
@@ -8125,6 +8179,7 @@ CPLErr GTiffDataset::CreateInternalMaskOverviews(int nOvrBlockXSize,
                 {
                     poODS->bPromoteTo8Bits = CPLTestBool(CPLGetConfigOption("GDAL_TIFF_INTERNAL_MASK_TO_8BIT", "YES"));
                     poODS->poBaseDS = this;
+                    poODS->SetCacheAccountingOwner(this);
                     papoOverviewDS[i]->poMaskDS = poODS;
                     poMaskDS->nOverviewCount++;
                     poMaskDS->papoOverviewDS = (GTiffDataset **)
@@ -11927,6 +11982,7 @@ void GTiffDataset::ScanDirectories()
                                nOverviewCount * (sizeof(void*)));
                 papoOverviewDS[nOverviewCount-1] = poODS;
                 poODS->poBaseDS = this;
+                poODS->SetCacheAccountingOwner(this);
             }
         }
 
@@ -11962,6 +12018,7 @@ void GTiffDataset::ScanDirectories()
             {
                 CPLDebug( "GTiff", "Opened band mask.\n");
                 poMaskDS->poBaseDS = this;
+                poMaskDS->SetCacheAccountingOwner(this);
 
                 poMaskDS->bPromoteTo8Bits = CPLTestBool(CPLGetConfigOption("GDAL_TIFF_INTERNAL_MASK_TO_8BIT", "YES"));
             }
@@ -11996,6 +12053,7 @@ void GTiffDataset::ScanDirectories()
                         ((GTiffDataset*)papoOverviewDS[i])->poMaskDS = poDS;
                         poDS->bPromoteTo8Bits = CPLTestBool(CPLGetConfigOption("GDAL_TIFF_INTERNAL_MASK_TO_8BIT", "YES"));
                         poDS->poBaseDS = this;
+                        poDS->SetCacheAccountingOwner(this);
                         break;
                     }
                 }
@@ -244,6 +244,10 @@ typedef void *GDALRasterAttributeTableH;
 /** Opaque type used for the C bindings of the C++ GDALAsyncReader class */
 typedef void *GDALAsyncReaderH;
 
+/** Opaque type used for the C bindings of asynchronous RasterIO requests
+ * (see GDALDatasetAsyncRasterIO()) */
+typedef void *GDALAsyncRasterIORequestH;
+
 /** Type to express pixel, line or band spacing. Signed 64 bit integer. */
 typedef GIntBig GSpacing;
 
@@ -572,6 +576,33 @@ GDALBeginAsyncReader(GDALDatasetH hDS, int nXOff, int nYOff,
 void  CPL_DLL CPL_STDCALL
 GDALEndAsyncReader(GDALDatasetH hDS, GDALAsyncReaderH hAsynchReaderH);
 
+/** Completion callback of an asynchronous RasterIO request.
+ * @see GDALDatasetAsyncRasterIO() */
+typedef void (CPL_STDCALL *GDALAsyncRasterIOCompletionFunc)(
+    GDALAsyncRasterIORequestH hRequest, CPLErr eErr, void* pUserData );
+
+GDALAsyncRasterIORequestH CPL_DLL CPL_STDCALL
+GDALDatasetAsyncRasterIO(GDALDatasetH hDS,
+                         int nXOff, int nYOff, int nXSize, int nYSize,
+                         void *pBuf, int nBufXSize, int nBufYSize,
+                         GDALDataType eBufType,
+                         int nBandCount, int* panBandMap,
+                         GSpacing nPixelSpace, GSpacing nLineSpace,
+                         GSpacing nBandSpace,
+                         GDALAsyncRasterIOCompletionFunc pfnCompletion,
+                         void* pUserData,
+                         char **papszOptions) CPL_WARN_UNUSED_RESULT;
+GDALAsyncStatusType CPL_DLL CPL_STDCALL
+GDALAsyncRasterIOWait(GDALAsyncRasterIORequestH hRequest, double dfTimeout);
+GDALAsyncRasterIORequestH CPL_DLL CPL_STDCALL
+GDALDatasetAsyncRasterIOWaitAny(GDALDatasetH hDS, double dfTimeout);
+int CPL_DLL CPL_STDCALL
+GDALAsyncRasterIOCancel(GDALAsyncRasterIORequestH hRequest);
+void CPL_DLL * CPL_STDCALL
+GDALAsyncRasterIOGetUserData(GDALAsyncRasterIORequestH hRequest);
+void CPL_DLL CPL_STDCALL
+GDALAsyncRasterIORelease(GDALAsyncRasterIORequestH hRequest);
+
 CPLErr CPL_DLL CPL_STDCALL GDALDatasetRasterIO(
     GDALDatasetH hDS, GDALRWFlag eRWFlag,
     int nDSXOff, int nDSYOff, int nDSXSize, int nDSYSize,
@@ -1062,6 +1093,35 @@ GIntBig CPL_DLL CPL_STDCALL GDALGetCacheUsed64(void);
 
 int CPL_DLL CPL_STDCALL GDALFlushCacheBlock(void);
 
+/** Priority class of the blocks of a dataset in the raster block cache.
+ * @see GDALDatasetSetCachePriority()
+ * @since GDAL 2.2 */
+typedef enum
+{
+    /*! Blocks are evicted in least recently used order */
+                                    GBCP_NORMAL = 0,
+    /*! Blocks are evicted only when no block of another class can be */
+                                    GBCP_HIGH = 1,
+    /*! Blocks are admitted as the least recently used ones and are not
+        promoted on access, so that they are the first to be evicted
+        (suited to sequential scans) */
+                                    GBCP_SCAN_RESISTANT = 2
+} GDALBlockCachePriority;
+
+void CPL_DLL CPL_STDCALL GDALDatasetSetCacheQuota( GDALDatasetH hDS,
+                                                   GIntBig nBytes );
+GIntBig CPL_DLL CPL_STDCALL GDALDatasetGetCacheQuota( GDALDatasetH hDS );
+void CPL_DLL CPL_STDCALL GDALDatasetSetCachePriority(
+                                GDALDatasetH hDS,
+                                GDALBlockCachePriority ePriority );
+GDALBlockCachePriority CPL_DLL CPL_STDCALL
+                         GDALDatasetGetCachePriority( GDALDatasetH hDS );
+void CPL_DLL CPL_STDCALL GDALDatasetGetCacheStatistics( GDALDatasetH hDS,
+                                                        GIntBig* pnUsed,
+                                                        GIntBig* pnHits,
+                                                        GIntBig* pnMisses,
+                                                        GIntBig* pnEvictions );
+
 /* ==================================================================== */
 /*      GDAL virtual memory                                             */
 /* ==================================================================== */
@@ -50,6 +50,8 @@ class GDALRasterAttributeTable;
 class GDALProxyDataset;
 class GDALProxyRasterBand;
 class GDALAsyncReader;
+class GDALAsyncRasterIOScheduler;
+struct GDALBlockCacheAccounting;
 
 /* -------------------------------------------------------------------- */
 /*      Pull in the public declarations.  This gets the C apis, and     */
@@ -413,6 +415,15 @@ class CPL_DLL GDALDataset : public GDALMajorObject
     int          AcquireMutex();
     void         ReleaseMutex();
 
+    friend class GDALRasterBlock;
+    GDALBlockCacheAccounting* GetBlockCacheAccounting();
+    void                ReleaseBlockCacheAccounting();
+
+    friend class GDALAsyncRasterIOScheduler;
+    GDALAsyncRasterIOScheduler* GetAsyncRasterIOScheduler( bool bCreate,
+                                                           char** papszOptions );
+    void                DestroyAsyncRasterIOScheduler();
+
   public:
     virtual     ~GDALDataset();
 
@@ -479,6 +490,14 @@ class CPL_DLL GDALDataset : public GDALMajorObject
 
     void          MarkSuppressOnClose() { bSuppressOnClose = TRUE; }
 
+    void          SetCacheQuota( GIntBig nBytes );
+    GIntBig       GetCacheQuota();
+    void          SetCachePriority( GDALBlockCachePriority ePriority );
+    GDALBlockCachePriority GetCachePriority();
+    void          GetCacheStatistics( GIntBig* pnUsed, GIntBig* pnHits,
+                                      GIntBig* pnMisses, GIntBig* pnEvictions );
+    void          SetCacheAccountingOwner( GDALDataset* poOwnerDS );
+
     char        **GetOpenOptions() { return papszOpenOptions; }
 
     static GDALDataset **GetOpenDatasets( int *pnDatasetCount );
@@ -563,6 +582,27 @@ private:
     CPL_DISALLOW_COPY_ASSIGN(GDALDataset);
 };
 
+/* ******************************************************************** */
+/*                       GDALBlockCacheAccounting                       */
+/* ******************************************************************** */
+
+//! Per-dataset policy and statistics of the raster block cache.
+// Members are protected by the block cache lock (see gdalrasterblock.cpp).
+// Overview and mask datasets are chained to the accounting of their base
+// dataset through psOwner, which holds a reference on it.
+
+struct GDALBlockCacheAccounting
+{
+    GIntBig                 nQuota;         /* 0 = no quota */
+    GDALBlockCachePriority  ePriority;
+    GIntBig                 nUsed;
+    GIntBig                 nHits;
+    GIntBig                 nMisses;
+    GIntBig                 nEvictions;
+    GDALBlockCacheAccounting* psOwner;
+    int                     nRefCount;
+};
+
 /* ******************************************************************** */
 /*                           GDALRasterBlock                            */
 /* ******************************************************************** */
@@ -574,6 +614,7 @@ private:
 class CPL_DLL GDALRasterBlock
 {
     friend class GDALAbstractBandBlockCache;
+    friend class GDALDataset;
 
     GDALDataType        eType;
 
@@ -597,6 +638,20 @@ class CPL_DLL GDALRasterBlock
 
     void        Detach_unlocked( void );
     void        Touch_unlocked( void );
+    void        AddToOldest_unlocked( void );
+
+    GDALBlockCacheAccounting *GetCacheAccounting();
+
+    static GDALRasterBlock *TakeOldestEvictable_unlocked(
+                            GDALRasterBlock* poStart,
+                            const GDALBlockCacheAccounting* psFilter,
+                            bool bSkipHighPriority,
+                            bool bDirtyBlocksOnly );
+    static int  FlushOldestBlock( int bDirtyBlocksOnly,
+                                  const GDALBlockCacheAccounting* psFilter );
+    static void LinkCacheAccounting( GDALBlockCacheAccounting* psAccounting,
+                                     GDALBlockCacheAccounting* psOwner );
+    static void ReleaseCacheAccounting( GDALBlockCacheAccounting* psAccounting );
 
     void        RecycleFor( int nXOffIn, int nYOffIn );
 
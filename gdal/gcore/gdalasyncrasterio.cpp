@@ -0,0 +1,790 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  GDAL Core
+ * Purpose:  Implementation of the asynchronous RasterIO API and of the
+ *           per-dataset scheduler that services it.
+ *
+ ******************************************************************************
+ * Copyright (c) 2016, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "gdalasyncrasterio_priv.h"
+#include "cpl_multiproc.h"
+
+#include <new>
+
+CPL_CVSID("$Id$");
+
+/************************************************************************/
+/*                      GDALAsyncRasterIORequest()                      */
+/************************************************************************/
+
+GDALAsyncRasterIORequest::GDALAsyncRasterIORequest() :
+    poScheduler(NULL),
+    nXOff(0),
+    nYOff(0),
+    nXSize(0),
+    nYSize(0),
+    pBuf(NULL),
+    nBufXSize(0),
+    nBufYSize(0),
+    eBufType(GDT_Unknown),
+    nPixelSpace(0),
+    nLineSpace(0),
+    nBandSpace(0),
+    eResampleAlg(GRIORA_NearestNeighbour),
+    pfnCompletion(NULL),
+    pUserData(NULL),
+    nPriority(0),
+    nSeqNumber(0),
+    eStatus(GARIO_PENDING),
+    bRunning(false),
+    bReportedByWaitAny(false)
+{
+}
+
+/************************************************************************/
+/* ==================================================================== */
+/*                      GDALAsyncRasterIOScheduler                      */
+/* ==================================================================== */
+/************************************************************************/
+
+/************************************************************************/
+/*                     GDALAsyncRasterIOScheduler()                     */
+/************************************************************************/
+
+GDALAsyncRasterIOScheduler::GDALAsyncRasterIOScheduler( GDALDataset* poDSIn,
+                                                        char** papszOptions ) :
+    poDS(poDSIn),
+    hMutex(NULL),
+    hCond(NULL),
+    poThreadPool(NULL),
+    nMaxHandles(1),
+    bReopenFailed(false),
+    bOpeningHandle(false),
+    nActiveRequests(0),
+    nSeqCounter(0)
+{
+    hMutex = CPLCreateMutex();
+    CPLReleaseMutex(hMutex);
+    hCond = CPLCreateCond();
+
+    const char* pszThreads = CSLFetchNameValue(papszOptions, "NUM_THREADS");
+    if( pszThreads == NULL )
+        pszThreads = CPLGetConfigOption("GDAL_NUM_THREADS", "1");
+    int nThreads;
+    if( EQUAL(pszThreads, "ALL_CPUS") )
+        nThreads = CPLGetNumCPUs();
+    else
+        nThreads = atoi(pszThreads);
+    if( nThreads < 1 )
+        nThreads = 1;
+    if( nThreads > 128 )
+        nThreads = 128;
+
+    /* A dataset opened in update mode may have pending writes that a */
+    /* second handle would not see, so stick to the dataset itself. */
+    if( poDS->GetAccess() == GA_Update ||
+        !CPLFetchBool(const_cast<const char**>(papszOptions), "REOPEN",
+                      true) )
+    {
+        bReopenFailed = true;
+    }
+
+    nMaxHandles = nThreads;
+    apoHandles.reserve(nMaxHandles);
+    abHandleBusy.reserve(nMaxHandles);
+
+    poThreadPool = new (std::nothrow) CPLWorkerThreadPool();
+    if( poThreadPool == NULL || !poThreadPool->Setup(nThreads, NULL, NULL) )
+    {
+        delete poThreadPool;
+        poThreadPool = NULL;
+    }
+    else
+    {
+        CPLDebug("GDAL", "Using %d threads for asynchronous RasterIO on %s",
+                 nThreads, poDS->GetDescription());
+    }
+}
+
+/************************************************************************/
+/*                    ~GDALAsyncRasterIOScheduler()                     */
+/************************************************************************/
+
+GDALAsyncRasterIOScheduler::~GDALAsyncRasterIOScheduler()
+{
+    /* Cancel requests that have not started yet, and wait for the */
+    /* running ones. */
+    CPLAcquireMutex(hMutex, 1000.0);
+    std::list<GDALAsyncRasterIORequest*> oCancelledList;
+    oCancelledList.swap(oPendingList);
+    CPLReleaseMutex(hMutex);
+
+    for( std::list<GDALAsyncRasterIORequest*>::iterator oIter =
+                oCancelledList.begin(); oIter != oCancelledList.end(); ++oIter )
+    {
+        Complete(*oIter, CE_Failure);
+    }
+
+    if( poThreadPool )
+        poThreadPool->WaitCompletion();
+    delete poThreadPool;
+
+    for( size_t i = 0; i < apoHandles.size(); i++ )
+    {
+        if( apoHandles[i] != poDS )
+            GDALClose( (GDALDatasetH) apoHandles[i] );
+    }
+
+    /* Requests not released by the application are invalidated. */
+    for( std::list<GDALAsyncRasterIORequest*>::iterator oIter =
+                oCompletedList.begin(); oIter != oCompletedList.end(); ++oIter )
+    {
+        delete *oIter;
+    }
+
+    CPLDestroyCond(hCond);
+    CPLDestroyMutex(hMutex);
+}
+
+/************************************************************************/
+/*                                Get()                                 */
+/************************************************************************/
+
+GDALAsyncRasterIOScheduler*
+GDALAsyncRasterIOScheduler::Get( GDALDataset* poDS, bool bCreate,
+                                 char** papszOptions )
+{
+    return poDS->GetAsyncRasterIOScheduler(bCreate, papszOptions);
+}
+
+/************************************************************************/
+/*                           ReopenDataset()                            */
+/************************************************************************/
+
+GDALDataset* GDALAsyncRasterIOScheduler::ReopenDataset()
+{
+    const char* pszFilename = poDS->GetDescription();
+    if( pszFilename[0] == '\0' || poDS->GetDriver() == NULL )
+        return NULL;
+
+    const char* apszAllowedDrivers[2] =
+        { poDS->GetDriver()->GetDescription(), NULL };
+
+    CPLPushErrorHandler(CPLQuietErrorHandler);
+    GDALDataset* poHandle = (GDALDataset*)
+        GDALOpenEx( pszFilename, GDAL_OF_RASTER | GDAL_OF_INTERNAL,
+                    apszAllowedDrivers, poDS->GetOpenOptions(), NULL );
+    CPLPopErrorHandler();
+    if( poHandle == NULL )
+        return NULL;
+
+    if( poHandle->GetRasterXSize() != poDS->GetRasterXSize() ||
+        poHandle->GetRasterYSize() != poDS->GetRasterYSize() ||
+        poHandle->GetRasterCount() != poDS->GetRasterCount() )
+    {
+        CPLDebug("GDAL", "Reopened %s does not match original dataset",
+                 pszFilename);
+        GDALClose( (GDALDatasetH) poHandle );
+        return NULL;
+    }
+
+    return poHandle;
+}
+
+/************************************************************************/
+/*                           AcquireHandle()                            */
+/*                                                                      */
+/*      Must be called with hMutex held. Returns the index of a         */
+/*      dataset handle that is reserved for the calling thread.         */
+/************************************************************************/
+
+int GDALAsyncRasterIOScheduler::AcquireHandle()
+{
+    while( true )
+    {
+        for( size_t i = 0; i < apoHandles.size(); i++ )
+        {
+            if( !abHandleBusy[i] )
+            {
+                abHandleBusy[i] = true;
+                return static_cast<int>(i);
+            }
+        }
+
+        if( !bOpeningHandle &&
+            static_cast<int>(apoHandles.size()) < nMaxHandles &&
+            !(bReopenFailed && !apoHandles.empty()) )
+        {
+            GDALDataset* poHandle = NULL;
+            if( !bReopenFailed )
+            {
+                bOpeningHandle = true;
+                CPLReleaseMutex(hMutex);
+                poHandle = ReopenDataset();
+                CPLAcquireMutex(hMutex, 1000.0);
+                bOpeningHandle = false;
+                if( poHandle == NULL )
+                {
+                    CPLDebug("GDAL", "Cannot reopen %s. Asynchronous RasterIO "
+                             "requests will be serialized on it",
+                             poDS->GetDescription());
+                    bReopenFailed = true;
+                }
+            }
+            if( poHandle == NULL && apoHandles.empty() )
+                poHandle = poDS;
+
+            if( poHandle != NULL )
+            {
+                apoHandles.push_back(poHandle);
+                abHandleBusy.push_back(true);
+                CPLCondBroadcast(hCond);
+                return static_cast<int>(apoHandles.size()) - 1;
+            }
+            CPLCondBroadcast(hCond);
+            continue;
+        }
+
+        CPLCondWait(hCond, hMutex);
+    }
+}
+
+/************************************************************************/
+/*                             WorkerFunc()                             */
+/************************************************************************/
+
+void GDALAsyncRasterIOScheduler::WorkerFunc( void* pData )
+{
+    static_cast<GDALAsyncRasterIOScheduler*>(pData)->ProcessNextRequest();
+}
+
+/************************************************************************/
+/*                         ProcessNextRequest()                         */
+/*                                                                      */
+/*      Each submitted job services the most urgent pending request,    */
+/*      which is not necessarily the one it was submitted for.          */
+/************************************************************************/
+
+void GDALAsyncRasterIOScheduler::ProcessNextRequest()
+{
+    CPLAcquireMutex(hMutex, 1000.0);
+    if( oPendingList.empty() )
+    {
+        // The request was cancelled in the meantime.
+        CPLReleaseMutex(hMutex);
+        return;
+    }
+    GDALAsyncRasterIORequest* psReq = oPendingList.front();
+    oPendingList.pop_front();
+    psReq->bRunning = true;
+
+    const int iHandle = AcquireHandle();
+    GDALDataset* poHandle = apoHandles[iHandle];
+    CPLReleaseMutex(hMutex);
+
+    GDALRasterIOExtraArg sExtraArg;
+    INIT_RASTERIO_EXTRA_ARG(sExtraArg);
+    sExtraArg.eResampleAlg = psReq->eResampleAlg;
+
+    CPLErr eErr = poHandle->RasterIO( GF_Read,
+                                      psReq->nXOff, psReq->nYOff,
+                                      psReq->nXSize, psReq->nYSize,
+                                      psReq->pBuf,
+                                      psReq->nBufXSize, psReq->nBufYSize,
+                                      psReq->eBufType,
+                                      static_cast<int>(psReq->anBandMap.size()),
+                                      &psReq->anBandMap[0],
+                                      psReq->nPixelSpace, psReq->nLineSpace,
+                                      psReq->nBandSpace, &sExtraArg );
+
+    CPLAcquireMutex(hMutex, 1000.0);
+    abHandleBusy[iHandle] = false;
+    CPLCondBroadcast(hCond);
+    CPLReleaseMutex(hMutex);
+
+    Complete(psReq, eErr);
+}
+
+/************************************************************************/
+/*                              Complete()                              */
+/************************************************************************/
+
+void GDALAsyncRasterIOScheduler::Complete( GDALAsyncRasterIORequest* psReq,
+                                           CPLErr eErr )
+{
+    /* The callback is run before the request is flagged as completed, */
+    /* so that a thread waiting on it cannot release it under our feet. */
+    if( psReq->pfnCompletion != NULL )
+        psReq->pfnCompletion( (GDALAsyncRasterIORequestH) psReq, eErr,
+                              psReq->pUserData );
+
+    CPLAcquireMutex(hMutex, 1000.0);
+    psReq->bRunning = false;
+    psReq->eStatus = (eErr == CE_None) ? GARIO_COMPLETE : GARIO_ERROR;
+    oCompletedList.push_back(psReq);
+    nActiveRequests --;
+    CPLCondBroadcast(hCond);
+    CPLReleaseMutex(hMutex);
+}
+
+/************************************************************************/
+/*                               Submit()                               */
+/************************************************************************/
+
+GDALAsyncRasterIORequest*
+GDALAsyncRasterIOScheduler::Submit( GDALAsyncRasterIORequest* psReq )
+{
+    psReq->poScheduler = this;
+
+    CPLAcquireMutex(hMutex, 1000.0);
+    psReq->nSeqNumber = nSeqCounter ++;
+
+    /* Keep the pending list sorted by decreasing priority, and by */
+    /* submission order for requests of the same priority. */
+    std::list<GDALAsyncRasterIORequest*>::iterator oIter = oPendingList.end();
+    while( oIter != oPendingList.begin() )
+    {
+        std::list<GDALAsyncRasterIORequest*>::iterator oPrev = oIter;
+        --oPrev;
+        if( (*oPrev)->nPriority >= psReq->nPriority )
+            break;
+        oIter = oPrev;
+    }
+    oPendingList.insert(oIter, psReq);
+    nActiveRequests ++;
+    CPLReleaseMutex(hMutex);
+
+    if( poThreadPool == NULL || !poThreadPool->SubmitJob(WorkerFunc, this) )
+        ProcessNextRequest();
+
+    return psReq;
+}
+
+/************************************************************************/
+/*                                Wait()                                */
+/************************************************************************/
+
+GDALAsyncStatusType
+GDALAsyncRasterIOScheduler::Wait( GDALAsyncRasterIORequest* psReq,
+                                  double dfTimeout )
+{
+    CPLAcquireMutex(hMutex, 1000.0);
+    if( dfTimeout < 0 )
+    {
+        while( psReq->eStatus == GARIO_PENDING )
+            CPLCondWait(hCond, hMutex);
+    }
+    else
+    {
+        while( psReq->eStatus == GARIO_PENDING && dfTimeout > 0 )
+        {
+            const double dfSleep = MIN(dfTimeout, 0.001);
+            CPLReleaseMutex(hMutex);
+            CPLSleep(dfSleep);
+            dfTimeout -= dfSleep;
+            CPLAcquireMutex(hMutex, 1000.0);
+        }
+    }
+    GDALAsyncStatusType eStatus = psReq->eStatus;
+    CPLReleaseMutex(hMutex);
+    return eStatus;
+}
+
+/************************************************************************/
+/*                              WaitAny()                               */
+/************************************************************************/
+
+GDALAsyncRasterIORequest*
+GDALAsyncRasterIOScheduler::WaitAny( double dfTimeout )
+{
+    CPLAcquireMutex(hMutex, 1000.0);
+    GDALAsyncRasterIORequest* psRet = NULL;
+    while( true )
+    {
+        for( std::list<GDALAsyncRasterIORequest*>::iterator oIter =
+                oCompletedList.begin(); oIter != oCompletedList.end(); ++oIter )
+        {
+            if( !(*oIter)->bReportedByWaitAny )
+            {
+                psRet = *oIter;
+                psRet->bReportedByWaitAny = true;
+                break;
+            }
+        }
+        if( psRet != NULL || nActiveRequests == 0 || dfTimeout == 0 )
+            break;
+
+        if( dfTimeout < 0 )
+            CPLCondWait(hCond, hMutex);
+        else
+        {
+            const double dfSleep = MIN(dfTimeout, 0.001);
+            CPLReleaseMutex(hMutex);
+            CPLSleep(dfSleep);
+            dfTimeout -= dfSleep;
+            if( dfTimeout < 1e-9 )
+                dfTimeout = 0;
+            CPLAcquireMutex(hMutex, 1000.0);
+        }
+    }
+    CPLReleaseMutex(hMutex);
+    return psRet;
+}
+
+/************************************************************************/
+/*                               Cancel()                               */
+/************************************************************************/
+
+bool GDALAsyncRasterIOScheduler::Cancel( GDALAsyncRasterIORequest* psReq )
+{
+    CPLAcquireMutex(hMutex, 1000.0);
+    bool bFound = false;
+    if( psReq->eStatus == GARIO_PENDING && !psReq->bRunning )
+    {
+        for( std::list<GDALAsyncRasterIORequest*>::iterator oIter =
+                oPendingList.begin(); oIter != oPendingList.end(); ++oIter )
+        {
+            if( *oIter == psReq )
+            {
+                oPendingList.erase(oIter);
+                bFound = true;
+                break;
+            }
+        }
+    }
+    CPLReleaseMutex(hMutex);
+
+    if( bFound )
+        Complete(psReq, CE_Failure);
+    return bFound;
+}
+
+/************************************************************************/
+/*                              Release()                               */
+/************************************************************************/
+
+void GDALAsyncRasterIOScheduler::Release( GDALAsyncRasterIORequest* psReq )
+{
+    Cancel(psReq);
+    Wait(psReq, -1.0);
+
+    CPLAcquireMutex(hMutex, 1000.0);
+    oCompletedList.remove(psReq);
+    CPLReleaseMutex(hMutex);
+
+    delete psReq;
+}
+
+/************************************************************************/
+/* ==================================================================== */
+/*                              C API                                   */
+/* ==================================================================== */
+/************************************************************************/
+
+/************************************************************************/
+/*                      GDALDatasetAsyncRasterIO()                      */
+/************************************************************************/
+
+/**
+ * \brief Submit an asynchronous read request.
+ *
+ * This function queues a read of a region of image data for multiple bands,
+ * with the same semantics as GDALDatasetRasterIOEx() in GF_Read mode, and
+ * returns immediately. The request is serviced by a per-dataset scheduler
+ * running on a pool of worker threads, so that I/O, decompression and the
+ * processing done by the caller can overlap.
+ *
+ * When possible (dataset opened in read-only mode, and reopenable from its
+ * description, as it is the case for GTiff, VRT or /vsicurl/ based datasets),
+ * each worker thread uses its own handle on the dataset, so that requests
+ * are serviced concurrently and may complete in a different order than
+ * the one in which they have been submitted. Otherwise, requests are
+ * serialized on the dataset itself, and the application must not use the
+ * dataset while requests are pending.
+ *
+ * Pending requests are serviced by decreasing PRIORITY, and then in
+ * submission order.
+ *
+ * The pfnCompletion callback, if provided, is called from a worker thread
+ * (or from the thread that cancels the request) once the request has been
+ * serviced. It must not call GDALAsyncRasterIOWait() or
+ * GDALAsyncRasterIORelease() on the request.
+ *
+ * The request must be released with GDALAsyncRasterIORelease(), and all
+ * requests must be released before the dataset is closed.
+ *
+ * The following options are supported:
+ * <ul>
+ * <li>PRIORITY=integer: priority of the request. Default is 0.</li>
+ * <li>RESAMPLING=NEAREST/BILINEAR/CUBIC/CUBICSPLINE/LANCZOS/AVERAGE/MODE/GAUSS:
+ *     resampling method used when the buffer size differs from the window
+ *     size.</li>
+ * <li>NUM_THREADS=number or ALL_CPUS: number of worker threads of the
+ *     dataset scheduler. Only taken into account by the first request
+ *     submitted on a dataset. Defaults to the value of the GDAL_NUM_THREADS
+ *     configuration option, or 1.</li>
+ * <li>REOPEN=YES/NO: whether worker threads may open their own handle on the
+ *     dataset. Only taken into account by the first request submitted on a
+ *     dataset. Defaults to YES.</li>
+ * </ul>
+ *
+ * @param hDS the dataset.
+ * @param nXOff the pixel offset to the top left corner of the region.
+ * @param nYOff the line offset to the top left corner of the region.
+ * @param nXSize the width of the region in pixels.
+ * @param nYSize the height of the region in lines.
+ * @param pBuf the buffer into which the data should be read. It must remain
+ * valid until the request is completed.
+ * @param nBufXSize the width of the buffer image.
+ * @param nBufYSize the height of the buffer image.
+ * @param eBufType the type of the pixel values in the buffer.
+ * @param nBandCount the number of bands being read.
+ * @param panBandMap the list of nBandCount band numbers being read, or NULL
+ * to select the first nBandCount bands.
+ * @param nPixelSpace the byte offset between two pixels of a scanline, or 0.
+ * @param nLineSpace the byte offset between two scanlines, or 0.
+ * @param nBandSpace the byte offset between two bands, or 0.
+ * @param pfnCompletion completion callback, or NULL.
+ * @param pUserData user data passed to pfnCompletion.
+ * @param papszOptions NULL terminated list of options, or NULL.
+ *
+ * @return a request handle, or NULL if the request is invalid.
+ *
+ * @since GDAL 2.2
+ */
+
+GDALAsyncRasterIORequestH CPL_STDCALL
+GDALDatasetAsyncRasterIO( GDALDatasetH hDS,
+                          int nXOff, int nYOff, int nXSize, int nYSize,
+                          void *pBuf, int nBufXSize, int nBufYSize,
+                          GDALDataType eBufType,
+                          int nBandCount, int* panBandMap,
+                          GSpacing nPixelSpace, GSpacing nLineSpace,
+                          GSpacing nBandSpace,
+                          GDALAsyncRasterIOCompletionFunc pfnCompletion,
+                          void* pUserData,
+                          char **papszOptions )
+{
+    VALIDATE_POINTER1( hDS, "GDALDatasetAsyncRasterIO", NULL );
+    VALIDATE_POINTER1( pBuf, "GDALDatasetAsyncRasterIO", NULL );
+
+    GDALDataset* poDS = (GDALDataset*) hDS;
+
+    if( nXOff < 0 || nYOff < 0 || nXSize < 1 || nYSize < 1 ||
+        nXOff > poDS->GetRasterXSize() - nXSize ||
+        nYOff > poDS->GetRasterYSize() - nYSize ||
+        nBufXSize < 1 || nBufYSize < 1 )
+    {
+        CPLError( CE_Failure, CPLE_IllegalArg,
+                  "Access window out of range in GDALDatasetAsyncRasterIO().  "
+                  "Requested (%d,%d) of size %dx%d on raster of %dx%d.",
+                  nXOff, nYOff, nXSize, nYSize,
+                  poDS->GetRasterXSize(), poDS->GetRasterYSize() );
+        return NULL;
+    }
+
+    if( nBandCount < 1 || nBandCount > poDS->GetRasterCount() )
+    {
+        CPLError( CE_Failure, CPLE_IllegalArg,
+                  "%d bands requested in GDALDatasetAsyncRasterIO() "
+                  "on a dataset of %d bands.",
+                  nBandCount, poDS->GetRasterCount() );
+        return NULL;
+    }
+
+    GDALAsyncRasterIORequest* psReq = new GDALAsyncRasterIORequest();
+    psReq->anBandMap.resize(nBandCount);
+    for( int i = 0; i < nBandCount; i++ )
+    {
+        const int nBand = panBandMap ? panBandMap[i] : i + 1;
+        if( nBand < 1 || nBand > poDS->GetRasterCount() )
+        {
+            CPLError( CE_Failure, CPLE_IllegalArg,
+                      "panBandMap[%d] = %d, this band does not exist on "
+                      "dataset.", i, nBand );
+            delete psReq;
+            return NULL;
+        }
+        psReq->anBandMap[i] = nBand;
+    }
+
+    const char* pszResampling = CSLFetchNameValue(papszOptions, "RESAMPLING");
+    if( pszResampling != NULL )
+        psReq->eResampleAlg = GDALRasterIOGetResampleAlg(pszResampling);
+
+    psReq->nXOff = nXOff;
+    psReq->nYOff = nYOff;
+    psReq->nXSize = nXSize;
+    psReq->nYSize = nYSize;
+    psReq->pBuf = pBuf;
+    psReq->nBufXSize = nBufXSize;
+    psReq->nBufYSize = nBufYSize;
+    psReq->eBufType = eBufType;
+    psReq->nPixelSpace = nPixelSpace;
+    psReq->nLineSpace = nLineSpace;
+    psReq->nBandSpace = nBandSpace;
+    psReq->pfnCompletion = pfnCompletion;
+    psReq->pUserData = pUserData;
+    psReq->nPriority = atoi(CSLFetchNameValueDef(papszOptions, "PRIORITY", "0"));
+
+    GDALAsyncRasterIOScheduler* poScheduler =
+        GDALAsyncRasterIOScheduler::Get(poDS, true, papszOptions);
+    if( poScheduler == NULL )
+    {
+        delete psReq;
+        return NULL;
+    }
+
+    return (GDALAsyncRasterIORequestH) poScheduler->Submit(psReq);
+}
+
+/************************************************************************/
+/*                       GDALAsyncRasterIOWait()                        */
+/************************************************************************/
+
+/**
+ * \brief Wait for the completion of an asynchronous read request.
+ *
+ * @param hRequest request returned by GDALDatasetAsyncRasterIO().
+ * @param dfTimeout the number of seconds to wait. Use -1 to wait
+ * indefinitely, or zero to just query the status of the request.
+ *
+ * @return GARIO_COMPLETE if the request was successfully serviced,
+ * GARIO_ERROR if it failed or was cancelled, or GARIO_PENDING if it is
+ * still in progress when the timeout expires.
+ *
+ * @since GDAL 2.2
+ */
+
+GDALAsyncStatusType CPL_STDCALL
+GDALAsyncRasterIOWait( GDALAsyncRasterIORequestH hRequest, double dfTimeout )
+{
+    VALIDATE_POINTER1( hRequest, "GDALAsyncRasterIOWait", GARIO_ERROR );
+
+    GDALAsyncRasterIORequest* psReq = (GDALAsyncRasterIORequest*) hRequest;
+    return psReq->poScheduler->Wait(psReq, dfTimeout);
+}
+
+/************************************************************************/
+/*                  GDALDatasetAsyncRasterIOWaitAny()                   */
+/************************************************************************/
+
+/**
+ * \brief Wait for the completion of any asynchronous read request.
+ *
+ * Returns requests of the dataset in the order in which they completed.
+ * Each request is returned only once by this function.
+ *
+ * @param hDS the dataset.
+ * @param dfTimeout the number of seconds to wait. Use -1 to wait
+ * indefinitely, or zero to not wait at all.
+ *
+ * @return a completed request (that must still be released with
+ * GDALAsyncRasterIORelease()), or NULL if no request completed within the
+ * timeout or if there is no pending request.
+ *
+ * @since GDAL 2.2
+ */
+
+GDALAsyncRasterIORequestH CPL_STDCALL
+GDALDatasetAsyncRasterIOWaitAny( GDALDatasetH hDS, double dfTimeout )
+{
+    VALIDATE_POINTER1( hDS, "GDALDatasetAsyncRasterIOWaitAny", NULL );
+
+    GDALAsyncRasterIOScheduler* poScheduler =
+        GDALAsyncRasterIOScheduler::Get((GDALDataset*)hDS, false, NULL);
+    if( poScheduler == NULL )
+        return NULL;
+    return (GDALAsyncRasterIORequestH) poScheduler->WaitAny(dfTimeout);
+}
+
+/************************************************************************/
+/*                      GDALAsyncRasterIOCancel()                       */
+/************************************************************************/
+
+/**
+ * \brief Cancel an asynchronous read request.
+ *
+ * Only requests that have not started yet can be cancelled. A cancelled
+ * request completes with GARIO_ERROR status, and its callback is invoked
+ * with CE_Failure.
+ *
+ * @param hRequest request returned by GDALDatasetAsyncRasterIO().
+ * @return TRUE if the request was cancelled.
+ *
+ * @since GDAL 2.2
+ */
+
+int CPL_STDCALL GDALAsyncRasterIOCancel( GDALAsyncRasterIORequestH hRequest )
+{
+    VALIDATE_POINTER1( hRequest, "GDALAsyncRasterIOCancel", FALSE );
+
+    GDALAsyncRasterIORequest* psReq = (GDALAsyncRasterIORequest*) hRequest;
+    return psReq->poScheduler->Cancel(psReq);
+}
+
+/************************************************************************/
+/*                    GDALAsyncRasterIOGetUserData()                    */
+/************************************************************************/
+
+/**
+ * \brief Return the user data associated with an asynchronous read request.
+ *
+ * @param hRequest request returned by GDALDatasetAsyncRasterIO().
+ * @return the pUserData value passed to GDALDatasetAsyncRasterIO().
+ *
+ * @since GDAL 2.2
+ */
+
+void* CPL_STDCALL
+GDALAsyncRasterIOGetUserData( GDALAsyncRasterIORequestH hRequest )
+{
+    VALIDATE_POINTER1( hRequest, "GDALAsyncRasterIOGetUserData", NULL );
+
+    return ((GDALAsyncRasterIORequest*) hRequest)->pUserData;
+}
+
+/************************************************************************/
+/*                      GDALAsyncRasterIORelease()                      */
+/************************************************************************/
+
+/**
+ * \brief Release an asynchronous read request.
+ *
+ * A request that has not started yet is cancelled, and a running request is
+ * waited for, before being released.
+ *
+ * @param hRequest request returned by GDALDatasetAsyncRasterIO().
+ *
+ * @since GDAL 2.2
+ */
+
+void CPL_STDCALL GDALAsyncRasterIORelease( GDALAsyncRasterIORequestH hRequest )
+{
+    if( hRequest == NULL )
+        return;
+
+    GDALAsyncRasterIORequest* psReq = (GDALAsyncRasterIORequest*) hRequest;
+    psReq->poScheduler->Release(psReq);
+}
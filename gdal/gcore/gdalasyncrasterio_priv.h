@@ -0,0 +1,128 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  GDAL Core
+ * Purpose:  Per-dataset scheduler backing the asynchronous RasterIO API.
+ *
+ ******************************************************************************
+ * Copyright (c) 2016, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef GDALASYNCRASTERIO_PRIV_H_INCLUDED
+#define GDALASYNCRASTERIO_PRIV_H_INCLUDED
+
+#ifndef DOXYGEN_SKIP
+
+#include "gdal_priv.h"
+#include "cpl_worker_thread_pool.h"
+
+#include <list>
+#include <vector>
+
+class GDALAsyncRasterIOScheduler;
+
+/************************************************************************/
+/*                       GDALAsyncRasterIORequest                       */
+/************************************************************************/
+
+class GDALAsyncRasterIORequest
+{
+  public:
+    GDALAsyncRasterIOScheduler      *poScheduler;
+
+    int                              nXOff;
+    int                              nYOff;
+    int                              nXSize;
+    int                              nYSize;
+    void                            *pBuf;
+    int                              nBufXSize;
+    int                              nBufYSize;
+    GDALDataType                     eBufType;
+    std::vector<int>                 anBandMap;
+    GSpacing                         nPixelSpace;
+    GSpacing                         nLineSpace;
+    GSpacing                         nBandSpace;
+    GDALRIOResampleAlg               eResampleAlg;
+
+    GDALAsyncRasterIOCompletionFunc  pfnCompletion;
+    void                            *pUserData;
+
+    int                              nPriority;
+    GUIntBig                         nSeqNumber;
+
+    GDALAsyncStatusType              eStatus;
+    bool                             bRunning;
+    bool                             bReportedByWaitAny;
+
+                GDALAsyncRasterIORequest();
+};
+
+/************************************************************************/
+/*                      GDALAsyncRasterIOScheduler                      */
+/************************************************************************/
+
+class GDALAsyncRasterIOScheduler
+{
+    GDALDataset                             *poDS;
+
+    CPLMutex                                *hMutex;
+    CPLCond                                 *hCond;
+    CPLWorkerThreadPool                     *poThreadPool;
+
+    /* Worker dataset handles. When the dataset cannot be reopened, this */
+    /* contains only poDS itself, and requests are serialized on it. */
+    std::vector<GDALDataset*>                apoHandles;
+    std::vector<bool>                        abHandleBusy;
+    int                                      nMaxHandles;
+    bool                                     bReopenFailed;
+    bool                                     bOpeningHandle;
+
+    std::list<GDALAsyncRasterIORequest*>     oPendingList;
+    std::list<GDALAsyncRasterIORequest*>     oCompletedList;
+    int                                      nActiveRequests;
+    GUIntBig                                 nSeqCounter;
+
+    static void         WorkerFunc( void* pData );
+    void                ProcessNextRequest();
+    int                 AcquireHandle();
+    GDALDataset        *ReopenDataset();
+    void                Complete( GDALAsyncRasterIORequest* psReq,
+                                  CPLErr eErr );
+
+  public:
+                GDALAsyncRasterIOScheduler( GDALDataset* poDSIn,
+                                            char** papszOptions );
+               ~GDALAsyncRasterIOScheduler();
+
+    static GDALAsyncRasterIOScheduler* Get( GDALDataset* poDS, bool bCreate,
+                                            char** papszOptions );
+
+    GDALAsyncRasterIORequest* Submit( GDALAsyncRasterIORequest* psReq );
+    GDALAsyncStatusType Wait( GDALAsyncRasterIORequest* psReq,
+                              double dfTimeout );
+    GDALAsyncRasterIORequest* WaitAny( double dfTimeout );
+    bool                Cancel( GDALAsyncRasterIORequest* psReq );
+    void                Release( GDALAsyncRasterIORequest* psReq );
+};
+
+#endif /* #ifndef DOXYGEN_SKIP */
+
+#endif /* GDALASYNCRASTERIO_PRIV_H_INCLUDED */
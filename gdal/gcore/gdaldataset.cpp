@@ -37,6 +37,7 @@
 #include "ogr_featurestyle.h"
 #include "ogr_gensql.h"
 #include "ogr_p.h"
+#include "gdalasyncrasterio_priv.h"
 #include "ograpispy.h"
 #include "ogrunionlayer.h"
 #include "swq.h"
@@ -74,6 +75,8 @@ typedef struct
     CPLMutex* hMutex;
     int       nMutexTakenCount;
     GDALAllowReadWriteMutexState eStateReadWriteMutex;
+    GDALAsyncRasterIOScheduler* poAsyncRasterIOScheduler;
+    GDALBlockCacheAccounting* psBlockCacheAccounting;
 } GDALDatasetPrivate;
 
 typedef struct
@@ -217,7 +220,14 @@ void GDALDataset::Init(int bForceCachedIOIn)
     m_poStyleTable = NULL;
     m_hPrivateData = VSI_CALLOC_VERBOSE(1, sizeof(GDALDatasetPrivate));
     GDALDatasetPrivate* psPrivate = (GDALDatasetPrivate* )m_hPrivateData;
-    psPrivate->eStateReadWriteMutex = RW_MUTEX_STATE_UNKNOWN;
+    if( psPrivate != NULL )
+    {
+        psPrivate->eStateReadWriteMutex = RW_MUTEX_STATE_UNKNOWN;
+        psPrivate->psBlockCacheAccounting = (GDALBlockCacheAccounting*)
+            VSI_CALLOC_VERBOSE(1, sizeof(GDALBlockCacheAccounting));
+        if( psPrivate->psBlockCacheAccounting != NULL )
+            psPrivate->psBlockCacheAccounting->nRefCount = 1;
+    }
 }
 
 /************************************************************************/
@@ -256,6 +266,8 @@ GDALDataset::~GDALDataset()
                       "GDALClose(%s, this=%p)", GetDescription(), this );
     }
 
+    DestroyAsyncRasterIOScheduler();
+
     if( bSuppressOnClose )
         VSIUnlink(GetDescription());
 
@@ -322,6 +334,8 @@ GDALDataset::~GDALDataset()
         m_poStyleTable = NULL;
     }
 
+    ReleaseBlockCacheAccounting();
+
     GDALDatasetPrivate* psPrivate = (GDALDatasetPrivate* )m_hPrivateData;
     if( psPrivate != NULL && psPrivate->hMutex != NULL )
         CPLDestroyMutex( psPrivate->hMutex );
@@ -2988,6 +3002,7 @@ void CPL_STDCALL GDALClose( GDALDatasetH hDS )
         if( poDS->Dereference() > 0 )
             return;
 
+        poDS->DestroyAsyncRasterIOScheduler();
         delete poDS;
         return;
     }
@@ -2995,6 +3010,7 @@ void CPL_STDCALL GDALClose( GDALDatasetH hDS )
 /* -------------------------------------------------------------------- */
 /*      This is not shared dataset, so directly delete it.              */
 /* -------------------------------------------------------------------- */
+    poDS->DestroyAsyncRasterIOScheduler();
     delete poDS;
 }
 
@@ -3193,6 +3209,104 @@ GDALDataset::BeginAsyncReader(int nXOff, int nYOff,
                                      papszOptions );
 }
 
+/************************************************************************/
+/*                      GetBlockCacheAccounting()                       */
+/************************************************************************/
+
+/* Blocks of overview and mask datasets are accounted with the ones of */
+/* the base dataset, so follow the chain of owners. */
+
+GDALBlockCacheAccounting* GDALDataset::GetBlockCacheAccounting()
+{
+    GDALDatasetPrivate* psPrivate = (GDALDatasetPrivate* )m_hPrivateData;
+    if( psPrivate == NULL )
+        return NULL;
+    GDALBlockCacheAccounting* psAccounting = psPrivate->psBlockCacheAccounting;
+    while( psAccounting != NULL && psAccounting->psOwner != NULL )
+        psAccounting = psAccounting->psOwner;
+    return psAccounting;
+}
+
+/************************************************************************/
+/*                    ReleaseBlockCacheAccounting()                     */
+/************************************************************************/
+
+void GDALDataset::ReleaseBlockCacheAccounting()
+{
+    GDALDatasetPrivate* psPrivate = (GDALDatasetPrivate* )m_hPrivateData;
+    if( psPrivate == NULL || psPrivate->psBlockCacheAccounting == NULL )
+        return;
+    GDALRasterBlock::ReleaseCacheAccounting(psPrivate->psBlockCacheAccounting);
+    psPrivate->psBlockCacheAccounting = NULL;
+}
+
+/************************************************************************/
+/*                      SetCacheAccountingOwner()                       */
+/************************************************************************/
+
+/**
+ * \brief Account the cached blocks of this dataset with another dataset.
+ *
+ * This is used by drivers so that the blocks of overview and mask datasets
+ * count against the quota, priority class and statistics of their base
+ * dataset. It should be called before any block of this dataset is cached.
+ *
+ * @param poOwnerDS the base dataset.
+ *
+ * @since GDAL 2.2
+ */
+
+void GDALDataset::SetCacheAccountingOwner( GDALDataset* poOwnerDS )
+{
+    GDALDatasetPrivate* psPrivate = (GDALDatasetPrivate* )m_hPrivateData;
+    GDALDatasetPrivate* psOwnerPrivate = poOwnerDS != NULL ?
+        (GDALDatasetPrivate* )poOwnerDS->m_hPrivateData : NULL;
+    if( psPrivate == NULL || psPrivate->psBlockCacheAccounting == NULL ||
+        psOwnerPrivate == NULL || psOwnerPrivate->psBlockCacheAccounting == NULL )
+        return;
+    GDALRasterBlock::LinkCacheAccounting(
+        psPrivate->psBlockCacheAccounting,
+        psOwnerPrivate->psBlockCacheAccounting );
+}
+
+/************************************************************************/
+/*                     GetAsyncRasterIOScheduler()                      */
+/************************************************************************/
+
+GDALAsyncRasterIOScheduler*
+GDALDataset::GetAsyncRasterIOScheduler( bool bCreate, char** papszOptions )
+{
+    GDALDatasetPrivate* psPrivate = (GDALDatasetPrivate* )m_hPrivateData;
+    if( psPrivate == NULL )
+        return NULL;
+
+    CPLMutexHolderD( &(psPrivate->hMutex) );
+    if( psPrivate->poAsyncRasterIOScheduler == NULL && bCreate )
+    {
+        psPrivate->poAsyncRasterIOScheduler =
+            new GDALAsyncRasterIOScheduler(this, papszOptions);
+    }
+    return psPrivate->poAsyncRasterIOScheduler;
+}
+
+/************************************************************************/
+/*                   DestroyAsyncRasterIOScheduler()                    */
+/*                                                                      */
+/*      Called by GDALClose() before the destructors of derived         */
+/*      classes run, since worker threads may still be using the        */
+/*      dataset, and by ~GDALDataset() for datasets deleted directly.   */
+/************************************************************************/
+
+void GDALDataset::DestroyAsyncRasterIOScheduler()
+{
+    GDALDatasetPrivate* psPrivate = (GDALDatasetPrivate* )m_hPrivateData;
+    if( psPrivate == NULL || psPrivate->poAsyncRasterIOScheduler == NULL )
+        return;
+
+    delete psPrivate->poAsyncRasterIOScheduler;
+    psPrivate->poAsyncRasterIOScheduler = NULL;
+}
+
 /************************************************************************/
 /*                        GDALBeginAsyncReader()                      */
 /************************************************************************/
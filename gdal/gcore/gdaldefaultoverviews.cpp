@@ -322,6 +322,9 @@ void GDALDefaultOverviews::OverviewScan()
 /* -------------------------------------------------------------------- */
     if( poODS )
     {
+        /* Account the cached blocks of the overviews with the base dataset */
+        poODS->SetCacheAccountingOwner( poDS );
+
         int nOverviewCount = GetOverviewCount(1);
 
         for( int iOver = 0; iOver < nOverviewCount; iOver++ )
@@ -851,6 +854,9 @@ GDALDefaultOverviews::BuildOverviews(
 /* -------------------------------------------------------------------- */
     if( poODS )
     {
+        /* Account the cached blocks of the overviews with the base dataset */
+        poODS->SetCacheAccountingOwner( poDS );
+
         int nOverviewCount = GetOverviewCount(1);
         int iOver;
 
@@ -936,6 +942,7 @@ CPLErr GDALDefaultOverviews::CreateMaskBand( int nFlags, int nBand )
         if( poMaskDS == NULL ) // presumably error already issued.
             return CE_Failure;
 
+        poMaskDS->SetCacheAccountingOwner( poDS );
         bOwnMaskDS = TRUE;
     }
 
@@ -1126,6 +1133,7 @@ int GDALDefaultOverviews::HaveMaskFile( char ** papszSiblingFiles,
     if( poMaskDS == NULL )
         return FALSE;
 
+    poMaskDS->SetCacheAccountingOwner( poDS );
     bOwnMaskDS = TRUE;
 
     return TRUE;
@@ -28,6 +28,7 @@
  * DEALINGS IN THE SOFTWARE.
  ****************************************************************************/
 
+#include "cpl_metrics.h"
 #include "cpl_multiproc.h"
 #include "cpl_string.h"
 #include "gdal_alg_priv.h"
@@ -205,6 +206,12 @@ GDALDriverManager::~GDALDriverManager()
 /* -------------------------------------------------------------------- */
     PamCleanProxyDB();
 
+/* -------------------------------------------------------------------- */
+/*      Report metrics if requested by CPL_METRICS_OUTPUT, now that     */
+/*      datasets have been flushed but config options still exist.      */
+/* -------------------------------------------------------------------- */
+    CPLMetricsDumpAtExit();
+
 /* -------------------------------------------------------------------- */
 /*      Blow away all the finder hints paths.  We really should not     */
 /*      be doing all of them, but it is currently hard to keep track    */
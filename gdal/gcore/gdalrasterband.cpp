@@ -825,10 +825,10 @@ CPLErr GDALRasterBand::AdoptBlock( GDALRasterBlock * poBlock )
     if( !InitBlockInfo() )
         return CE_Failure;
 
-    CPLErr eErr = poBandBlockCache->AdoptBlock(poBlock);
-    if( eErr == CE_None )
-        poBlock->Touch();
-    return eErr;
+    // The block has already been inserted in the LRU list by
+    // GDALRasterBlock::Internalize(), according to the cache priority of
+    // the dataset, so do not touch it here.
+    return poBandBlockCache->AdoptBlock(poBlock);
 }
 
 /************************************************************************/
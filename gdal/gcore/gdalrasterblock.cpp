@@ -30,6 +30,7 @@
  ****************************************************************************/
 
 #include "gdal_priv.h"
+#include "cpl_metrics.h"
 #include "cpl_multiproc.h"
 
 CPL_CVSID("$Id$");
@@ -340,6 +341,311 @@ int CPL_STDCALL GDALFlushCacheBlock()
     return GDALRasterBlock::FlushCacheBlock();
 }
 
+/************************************************************************/
+/*                       GDALDataset::SetCacheQuota()                   */
+/************************************************************************/
+
+/**
+ * \brief Set the maximum amount of block cache memory used by the dataset.
+ *
+ * When loading a new block of the dataset would exceed this quota, older
+ * blocks of the same dataset are evicted first, so that a single dataset
+ * cannot take over the whole block cache. The quota is enforced in addition
+ * to the global limit set with GDALSetCacheMax64(). If the dataset currently
+ * uses more than the new quota, its unlocked blocks are flushed immediately.
+ *
+ * This method is the same as the C function GDALDatasetSetCacheQuota().
+ *
+ * @param nBytes the quota in bytes, or 0 to remove the quota.
+ *
+ * @since GDAL 2.2
+ */
+
+void GDALDataset::SetCacheQuota( GIntBig nBytes )
+{
+    GDALBlockCacheAccounting* psAccounting = GetBlockCacheAccounting();
+    if( psAccounting == NULL )
+        return;
+
+    GDALGetCacheMax64(); // make sure the block cache lock is initialized
+    {
+        TAKE_LOCK;
+        psAccounting->nQuota = nBytes > 0 ? nBytes : 0;
+    }
+
+    while( true )
+    {
+        {
+            TAKE_LOCK;
+            if( psAccounting->nQuota == 0 ||
+                psAccounting->nUsed <= psAccounting->nQuota )
+                break;
+        }
+        if( !GDALRasterBlock::FlushOldestBlock(FALSE, psAccounting) )
+            break;
+    }
+}
+
+/************************************************************************/
+/*                      GDALDatasetSetCacheQuota()                      */
+/************************************************************************/
+
+/**
+ * \brief Set the maximum amount of block cache memory used by the dataset.
+ *
+ * @see GDALDataset::SetCacheQuota()
+ * @since GDAL 2.2
+ */
+
+void CPL_STDCALL GDALDatasetSetCacheQuota( GDALDatasetH hDS, GIntBig nBytes )
+{
+    VALIDATE_POINTER0( hDS, "GDALDatasetSetCacheQuota" );
+    ((GDALDataset*)hDS)->SetCacheQuota(nBytes);
+}
+
+/************************************************************************/
+/*                       GDALDataset::GetCacheQuota()                   */
+/************************************************************************/
+
+/**
+ * \brief Get the block cache quota of the dataset.
+ *
+ * This method is the same as the C function GDALDatasetGetCacheQuota().
+ *
+ * @return the quota in bytes, or 0 if there is no quota.
+ *
+ * @since GDAL 2.2
+ */
+
+GIntBig GDALDataset::GetCacheQuota()
+{
+    GDALBlockCacheAccounting* psAccounting = GetBlockCacheAccounting();
+    if( psAccounting == NULL )
+        return 0;
+    TAKE_LOCK;
+    return psAccounting->nQuota;
+}
+
+/************************************************************************/
+/*                      GDALDatasetGetCacheQuota()                      */
+/************************************************************************/
+
+/**
+ * \brief Get the block cache quota of the dataset.
+ *
+ * @see GDALDataset::GetCacheQuota()
+ * @since GDAL 2.2
+ */
+
+GIntBig CPL_STDCALL GDALDatasetGetCacheQuota( GDALDatasetH hDS )
+{
+    VALIDATE_POINTER1( hDS, "GDALDatasetGetCacheQuota", 0 );
+    return ((GDALDataset*)hDS)->GetCacheQuota();
+}
+
+/************************************************************************/
+/*                     GDALDataset::SetCachePriority()                  */
+/************************************************************************/
+
+/**
+ * \brief Set the priority class of the blocks of the dataset in the cache.
+ *
+ * <ul>
+ * <li>GBCP_NORMAL: blocks are evicted in least recently used order. This is
+ * the default.</li>
+ * <li>GBCP_HIGH: blocks are evicted only when no unlocked block of a dataset
+ * of another class remains, for example for the overviews that interactive
+ * requests rely on.</li>
+ * <li>GBCP_SCAN_RESISTANT: newly loaded blocks are inserted at the least
+ * recently used end of the list, and are not promoted when accessed again.
+ * A sequential read of a large dataset then only recycles its own blocks
+ * instead of evicting the working set of other datasets.</li>
+ * </ul>
+ *
+ * The new priority applies to blocks loaded after this call.
+ *
+ * This method is the same as the C function GDALDatasetSetCachePriority().
+ *
+ * @param ePriority the priority class.
+ *
+ * @since GDAL 2.2
+ */
+
+void GDALDataset::SetCachePriority( GDALBlockCachePriority ePriority )
+{
+    GDALBlockCacheAccounting* psAccounting = GetBlockCacheAccounting();
+    if( psAccounting == NULL )
+        return;
+    GDALGetCacheMax64(); // make sure the block cache lock is initialized
+    TAKE_LOCK;
+    psAccounting->ePriority = ePriority;
+}
+
+/************************************************************************/
+/*                    GDALDatasetSetCachePriority()                     */
+/************************************************************************/
+
+/**
+ * \brief Set the priority class of the blocks of the dataset in the cache.
+ *
+ * @see GDALDataset::SetCachePriority()
+ * @since GDAL 2.2
+ */
+
+void CPL_STDCALL GDALDatasetSetCachePriority( GDALDatasetH hDS,
+                                              GDALBlockCachePriority ePriority )
+{
+    VALIDATE_POINTER0( hDS, "GDALDatasetSetCachePriority" );
+    ((GDALDataset*)hDS)->SetCachePriority(ePriority);
+}
+
+/************************************************************************/
+/*                     GDALDataset::GetCachePriority()                  */
+/************************************************************************/
+
+/**
+ * \brief Get the priority class of the blocks of the dataset in the cache.
+ *
+ * This method is the same as the C function GDALDatasetGetCachePriority().
+ *
+ * @since GDAL 2.2
+ */
+
+GDALBlockCachePriority GDALDataset::GetCachePriority()
+{
+    GDALBlockCacheAccounting* psAccounting = GetBlockCacheAccounting();
+    if( psAccounting == NULL )
+        return GBCP_NORMAL;
+    TAKE_LOCK;
+    return psAccounting->ePriority;
+}
+
+/************************************************************************/
+/*                    GDALDatasetGetCachePriority()                     */
+/************************************************************************/
+
+/**
+ * \brief Get the priority class of the blocks of the dataset in the cache.
+ *
+ * @see GDALDataset::GetCachePriority()
+ * @since GDAL 2.2
+ */
+
+GDALBlockCachePriority CPL_STDCALL
+GDALDatasetGetCachePriority( GDALDatasetH hDS )
+{
+    VALIDATE_POINTER1( hDS, "GDALDatasetGetCachePriority", GBCP_NORMAL );
+    return ((GDALDataset*)hDS)->GetCachePriority();
+}
+
+/************************************************************************/
+/*                    GDALDataset::GetCacheStatistics()                 */
+/************************************************************************/
+
+/**
+ * \brief Get block cache statistics of the dataset.
+ *
+ * Hits are block requests served from the cache, misses are blocks that
+ * had to be loaded, and evictions are blocks of the dataset that have been
+ * removed from the cache to make room for other blocks.
+ *
+ * This method is the same as the C function GDALDatasetGetCacheStatistics().
+ *
+ * @param pnUsed pointer to the number of bytes of the cache currently used
+ * by the dataset, or NULL.
+ * @param pnHits pointer to the number of cache hits, or NULL.
+ * @param pnMisses pointer to the number of cache misses, or NULL.
+ * @param pnEvictions pointer to the number of evicted blocks, or NULL.
+ *
+ * @since GDAL 2.2
+ */
+
+void GDALDataset::GetCacheStatistics( GIntBig* pnUsed, GIntBig* pnHits,
+                                      GIntBig* pnMisses, GIntBig* pnEvictions )
+{
+    GDALBlockCacheAccounting sAccounting;
+    memset(&sAccounting, 0, sizeof(sAccounting));
+    GDALBlockCacheAccounting* psAccounting = GetBlockCacheAccounting();
+    if( psAccounting != NULL )
+    {
+        TAKE_LOCK;
+        sAccounting = *psAccounting;
+    }
+    if( pnUsed )
+        *pnUsed = sAccounting.nUsed;
+    if( pnHits )
+        *pnHits = sAccounting.nHits;
+    if( pnMisses )
+        *pnMisses = sAccounting.nMisses;
+    if( pnEvictions )
+        *pnEvictions = sAccounting.nEvictions;
+}
+
+/************************************************************************/
+/*                   GDALDatasetGetCacheStatistics()                    */
+/************************************************************************/
+
+/**
+ * \brief Get block cache statistics of the dataset.
+ *
+ * @see GDALDataset::GetCacheStatistics()
+ * @since GDAL 2.2
+ */
+
+void CPL_STDCALL GDALDatasetGetCacheStatistics( GDALDatasetH hDS,
+                                                GIntBig* pnUsed,
+                                                GIntBig* pnHits,
+                                                GIntBig* pnMisses,
+                                                GIntBig* pnEvictions )
+{
+    VALIDATE_POINTER0( hDS, "GDALDatasetGetCacheStatistics" );
+    ((GDALDataset*)hDS)->GetCacheStatistics(pnUsed, pnHits, pnMisses,
+                                            pnEvictions);
+}
+
+/************************************************************************/
+/*                        LinkCacheAccounting()                         */
+/************************************************************************/
+
+void GDALRasterBlock::LinkCacheAccounting( GDALBlockCacheAccounting* psAccounting,
+                                           GDALBlockCacheAccounting* psOwner )
+{
+    TAKE_LOCK;
+
+    if( psAccounting->psOwner != NULL )
+        return;
+
+    /* Do not create a cycle */
+    GDALBlockCacheAccounting* psRoot = psOwner;
+    while( psRoot->psOwner != NULL )
+        psRoot = psRoot->psOwner;
+    if( psRoot == psAccounting )
+        return;
+
+    /* Blocks already cached are released against the new root */
+    psRoot->nUsed += psAccounting->nUsed;
+    psAccounting->nUsed = 0;
+
+    psAccounting->psOwner = psOwner;
+    psOwner->nRefCount ++;
+}
+
+/************************************************************************/
+/*                       ReleaseCacheAccounting()                       */
+/************************************************************************/
+
+void GDALRasterBlock::ReleaseCacheAccounting( GDALBlockCacheAccounting* psAccounting )
+{
+    TAKE_LOCK;
+
+    while( psAccounting != NULL && --psAccounting->nRefCount == 0 )
+    {
+        GDALBlockCacheAccounting* psOwner = psAccounting->psOwner;
+        CPLFree(psAccounting);
+        psAccounting = psOwner;
+    }
+}
+
 /************************************************************************/
 /* ==================================================================== */
 /*                           GDALRasterBlock                            */
@@ -395,28 +701,78 @@ int CPL_STDCALL GDALFlushCacheBlock()
 
 int GDALRasterBlock::FlushCacheBlock(int bDirtyBlocksOnly)
 
+{
+    return FlushOldestBlock(bDirtyBlocksOnly, NULL);
+}
+
+/************************************************************************/
+/*                    TakeOldestEvictable_unlocked()                    */
+/*                                                                      */
+/*      Walk the LRU list from poStart towards the newest block, and    */
+/*      return the first block that can be evicted, after having        */
+/*      acquired it for eviction (nLockCount set to -1).  Must be       */
+/*      called with the block cache lock held.                          */
+/************************************************************************/
+
+GDALRasterBlock *GDALRasterBlock::TakeOldestEvictable_unlocked(
+                                    GDALRasterBlock* poStart,
+                                    const GDALBlockCacheAccounting* psFilter,
+                                    bool bSkipHighPriority,
+                                    bool bDirtyBlocksOnly )
+{
+    for( GDALRasterBlock *poTarget = poStart;
+         poTarget != NULL;
+         poTarget = poTarget->poPrevious )
+    {
+        if( bDirtyBlocksOnly && !poTarget->GetDirty() )
+            continue;
+        if( psFilter != NULL || bSkipHighPriority )
+        {
+            const GDALBlockCacheAccounting* psAccounting =
+                poTarget->GetCacheAccounting();
+            if( psFilter != NULL && psAccounting != psFilter )
+                continue;
+            if( bSkipHighPriority && psAccounting != NULL &&
+                psAccounting->ePriority == GBCP_HIGH )
+                continue;
+        }
+        if( CPLAtomicCompareAndExchange(&(poTarget->nLockCount), 0, -1) )
+            return poTarget;
+    }
+    return NULL;
+}
+
+/************************************************************************/
+/*                          FlushOldestBlock()                          */
+/************************************************************************/
+
+int GDALRasterBlock::FlushOldestBlock( int bDirtyBlocksOnly,
+                                       const GDALBlockCacheAccounting* psFilter )
+
 {
     GDALRasterBlock *poTarget;
 
     {
         INITIALIZE_LOCK;
-        poTarget = poOldest;
 
-        while( poTarget != NULL )
-        {
-            if( !bDirtyBlocksOnly || poTarget->GetDirty() )
-            {
-                if( CPLAtomicCompareAndExchange(&(poTarget->nLockCount), 0, -1) )
-                    break;
-            }
-            poTarget = poTarget->poPrevious;
-        }
+        // Blocks of high priority datasets are only considered if no other
+        // block can be flushed.
+        poTarget = TakeOldestEvictable_unlocked(poOldest, psFilter, true,
+                                                CPL_TO_BOOL(bDirtyBlocksOnly));
+        if( poTarget == NULL )
+            poTarget = TakeOldestEvictable_unlocked(poOldest, psFilter, false,
+                                                    CPL_TO_BOOL(bDirtyBlocksOnly));
 
         if( poTarget == NULL )
             return FALSE;
         if( bSleepsForBockCacheDebug )
             CPLSleep(CPLAtof(CPLGetConfigOption("GDAL_RB_FLUSHBLOCK_SLEEP_AFTER_DROP_LOCK", "0")));
 
+        GDALBlockCacheAccounting* psAccounting = poTarget->GetCacheAccounting();
+        if( psAccounting != NULL )
+            psAccounting->nEvictions ++;
+        CPL_METRIC_ADD("gdal.block_cache.evictions", 1);
+
         poTarget->Detach_unlocked();
         poTarget->GetBand()->UnreferenceBlock(poTarget);
     }
@@ -638,7 +994,12 @@ void GDALRasterBlock::Detach_unlocked()
     bMustDetach = FALSE;
 
     if( pData )
+    {
         nCacheUsed -= GetBlockSize();
+        GDALBlockCacheAccounting* psAccounting = GetCacheAccounting();
+        if( psAccounting != NULL )
+            psAccounting->nUsed -= GetBlockSize();
+    }
 
 #ifdef ENABLE_DEBUG
     Verify();
@@ -739,6 +1100,9 @@ CPLErr GDALRasterBlock::Write()
 
     if (poBand->eFlushBlockErr == CE_None)
     {
+        CPL_METRIC_ADD("gdal.block_cache.dirty_flushes", 1);
+        CPL_METRIC_ADD("gdal.block_cache.dirty_bytes_flushed",
+                       GetBlockSize());
         int bCallLeaveReadWrite = poBand->EnterReadWrite(GF_Write);
         CPLErr eErr = poBand->IWriteBlock( nXOff, nYOff, pData );
         if( bCallLeaveReadWrite ) poBand->LeaveReadWrite();
@@ -756,13 +1120,25 @@ CPLErr GDALRasterBlock::Write()
  * Push block to top of LRU (least-recently used) list.
  *
  * This method is normally called when a block is used to keep track
- * that it has been recently used.
+ * that it has been recently used.  It is accounted as a cache hit in the
+ * statistics of the dataset of the block.
  */
 
 void GDALRasterBlock::Touch()
 
 {
+    CPL_METRIC_ADD("gdal.block_cache.hits", 1);
+
     TAKE_LOCK;
+    GDALBlockCacheAccounting* psAccounting = GetCacheAccounting();
+    if( psAccounting != NULL )
+    {
+        psAccounting->nHits ++;
+        // Repeated accesses during a sequential scan (for example reading
+        // a strip line by line) must not promote the block.
+        if( psAccounting->ePriority == GBCP_SCAN_RESISTANT && bMustDetach )
+            return;
+    }
     Touch_unlocked();
 }
 
@@ -778,7 +1154,12 @@ void GDALRasterBlock::Touch_unlocked()
     if( !bMustDetach )
     {
         if( pData )
+        {
             nCacheUsed += GetBlockSize();
+            GDALBlockCacheAccounting* psAccounting = GetCacheAccounting();
+            if( psAccounting != NULL )
+                psAccounting->nUsed += GetBlockSize();
+        }
 
         bMustDetach = TRUE;
     }
@@ -812,6 +1193,49 @@ void GDALRasterBlock::Touch_unlocked()
 #endif
 }
 
+/************************************************************************/
+/*                        AddToOldest_unlocked()                        */
+/*                                                                      */
+/*      Insert a block that is not yet in the LRU list at its tail, so  */
+/*      that it is the first candidate for eviction once unlocked,      */
+/*      unless it is touched again before.                              */
+/************************************************************************/
+
+void GDALRasterBlock::AddToOldest_unlocked()
+
+{
+    CPLAssert( poPrevious == NULL && poNext == NULL && poNewest != this );
+
+    poNext = NULL;
+    poPrevious = poOldest;
+    if( poOldest != NULL )
+    {
+        CPLAssert( poOldest->poNext == NULL );
+        poOldest->poNext = this;
+    }
+    poOldest = this;
+
+    if( poNewest == NULL )
+        poNewest = this;
+    bMustDetach = TRUE;
+
+#ifdef ENABLE_DEBUG
+    Verify();
+#endif
+}
+
+/************************************************************************/
+/*                         GetCacheAccounting()                         */
+/************************************************************************/
+
+GDALBlockCacheAccounting *GDALRasterBlock::GetCacheAccounting()
+
+{
+    if( poBand == NULL || poBand->poDS == NULL )
+        return NULL;
+    return poBand->poDS->GetBlockCacheAccounting();
+}
+
 /************************************************************************/
 /*                            Internalize()                             */
 /************************************************************************/
@@ -844,7 +1268,12 @@ CPLErr GDALRasterBlock::Internalize()
 
 /* -------------------------------------------------------------------- */
 /*      Flush old blocks if we are nearing our memory limit.            */
+/*                                                                      */
+/*      The quota of the dataset of the block is first enforced by      */
+/*      evicting its own blocks.  Then the global limit is enforced,    */
+/*      first without evicting blocks of high priority datasets.        */
 /* -------------------------------------------------------------------- */
+    GDALBlockCacheAccounting* psAccounting = GetCacheAccounting();
     bool bFirstIter = true;
     bool bLoopAgain = false;
     do
@@ -856,53 +1285,76 @@ CPLErr GDALRasterBlock::Internalize()
             TAKE_LOCK;
 
             if( bFirstIter )
-                nCacheUsed += nSizeInBytes;
-            GDALRasterBlock *poTarget = poOldest;
-            while( nCacheUsed > nCurCacheMax )
             {
-                while( poTarget != NULL )
+                nCacheUsed += nSizeInBytes;
+                if( psAccounting != NULL )
                 {
-                    if( CPLAtomicCompareAndExchange(&(poTarget->nLockCount), 0, -1) )
-                        break;
-                    poTarget = poTarget->poPrevious;
+                    psAccounting->nUsed += nSizeInBytes;
+                    psAccounting->nMisses ++;
                 }
+                CPL_METRIC_ADD("gdal.block_cache.misses", 1);
+            }
 
-                if( poTarget != NULL )
+            for( int iPhase = 0; iPhase < 3 && !bLoopAgain; iPhase++ )
+            {
+                const bool bQuotaPhase = (iPhase == 0);
+                if( bQuotaPhase &&
+                    (psAccounting == NULL || psAccounting->nQuota <= 0) )
+                    continue;
+
+                GDALRasterBlock *poTarget = poOldest;
+                while( bQuotaPhase ? psAccounting->nUsed > psAccounting->nQuota
+                                   : nCacheUsed > nCurCacheMax )
                 {
+                    poTarget = TakeOldestEvictable_unlocked(
+                        poTarget, bQuotaPhase ? psAccounting : NULL,
+                        iPhase == 1, false );
+                    if( poTarget == NULL )
+                        break;
+
                     if( bSleepsForBockCacheDebug )
                         CPLSleep(CPLAtof(CPLGetConfigOption("GDAL_RB_INTERNALIZE_SLEEP_AFTER_DROP_LOCK", "0")));
 
                     GDALRasterBlock* _poPrevious = poTarget->poPrevious;
 
+                    GDALBlockCacheAccounting* psTargetAccounting =
+                        poTarget->GetCacheAccounting();
+                    if( psTargetAccounting != NULL )
+                        psTargetAccounting->nEvictions ++;
+                    CPL_METRIC_ADD("gdal.block_cache.evictions", 1);
+
                     poTarget->Detach_unlocked();
                     poTarget->GetBand()->UnreferenceBlock(poTarget);
 
                     apoBlocksToFree[nBlocksToFree++] = poTarget;
-                    if( poTarget->GetDirty() )
+                    if( poTarget->GetDirty() || nBlocksToFree == 64 )
                     {
                         // Only free one dirty block at a time so that
                         // other dirty blocks of other bands with the same coordinates
                         // can be found with TryGetLockedBlock()
-                        bLoopAgain = ( nCacheUsed > nCurCacheMax );
-                        break;
-                    }
-                    if( nBlocksToFree == 64 )
-                    {
-                        bLoopAgain = ( nCacheUsed > nCurCacheMax );
+                        bLoopAgain = ( nCacheUsed > nCurCacheMax ) ||
+                            ( psAccounting != NULL && psAccounting->nQuota > 0 &&
+                              psAccounting->nUsed > psAccounting->nQuota );
                         break;
                     }
 
                     poTarget = _poPrevious;
                 }
-                else
-                    break;
             }
 
         /* -------------------------------------------------------------------- */
-        /*      Add this block to the list.                                     */
+        /*      Add this block to the list.  Blocks of scan resistant           */
+        /*      datasets are admitted as the oldest ones, so that a             */
+        /*      sequential read does not evict the working set of others.       */
         /* -------------------------------------------------------------------- */
             if( !bLoopAgain )
-                Touch_unlocked();
+            {
+                if( psAccounting != NULL &&
+                    psAccounting->ePriority == GBCP_SCAN_RESISTANT )
+                    AddToOldest_unlocked();
+                else
+                    Touch_unlocked();
+            }
         }
 
         bFirstIter = false;
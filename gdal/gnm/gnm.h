@@ -393,6 +393,39 @@ public:
 
     virtual OGRLayer *GetPath (GNMGFID nStartFID, GNMGFID nEndFID,
                      GNMGraphAlgorithmType eAlgorithm, char** papszOptions);
+
+    /**
+     * @brief Preprocess the network graph for fast shortest path queries.
+     *
+     * Builds a contraction hierarchy of the graph and stores it in the
+     * network, so that it is available the next times the network is
+     * opened. Dijkstra shortest path queries and GetShortestPathCosts() use
+     * it while the graph is not modified: any change of the connections or
+     * of the blocking state makes it out of date, and it is then ignored
+     * until this method is called again.
+     *
+     * @param pfnProgress Progress function
+     * @param pProgressArg Progress function argument
+     * @return CE_None on success
+     * @since GDAL 2.2
+     */
+    virtual CPLErr BuildContractionHierarchy(GDALProgressFunc pfnProgress = NULL,
+                                             void *pProgressArg = NULL);
+
+    /**
+     * @brief Calculate the costs of the best paths from a vertex to several
+     * vertices, e.g. to fill a row of an origin-destination matrix.
+     *
+     * @param nStartFID Start identificator
+     * @param anEndFIDs End identificators
+     * @param adfCosts Costs, in the order of anEndFIDs. The cost is infinity if
+     *        there is no path to the vertex.
+     * @return CE_None on success
+     * @since GDAL 2.2
+     */
+    virtual CPLErr GetShortestPathCosts(GNMGFID nStartFID,
+                                        const std::vector<GNMGFID> &anEndFIDs,
+                                        std::vector<double> &adfCosts);
 protected:
     /**
      * @brief Check or create layer OGR driver
@@ -419,6 +452,20 @@ protected:
     virtual CPLErr LoadGraphLayer( GDALDataset* const pDS );
     virtual CPLErr LoadGraph();
     virtual CPLErr LoadFeaturesLayer( GDALDataset* const pDS );
+    virtual CPLErr CreateContractionLayer( GDALDataset* const pDS );
+    virtual CPLErr LoadContractionLayer( GDALDataset* const pDS );
+    virtual CPLErr LoadContractionHierarchy();
+    /**
+     * @brief Create the storage of the contraction hierarchy. The default
+     * implementation reports that it is not supported.
+     * @return CE_None on success
+     */
+    virtual CPLErr CreateContractionStorage();
+    /**
+     * @brief Delete the contraction hierarchy layer, if there is one.
+     * @return CE_None on success
+     */
+    virtual CPLErr DeleteContractionLayer();
     virtual CPLErr DeleteMetadataLayer() = 0;
     virtual CPLErr DeleteGraphLayer() = 0;
     virtual CPLErr DeleteFeaturesLayer() = 0;
@@ -451,6 +498,7 @@ protected:
     OGRLayer* m_poMetadataLayer;
     OGRLayer* m_poGraphLayer;
     OGRLayer* m_poFeaturesLayer;
+    OGRLayer* m_poContractionLayer;
 
     GDALDriver *m_poLayerDriver;
 
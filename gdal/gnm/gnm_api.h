@@ -95,6 +95,16 @@ CPLErr CPL_DLL CPL_STDCALL GNMChangeBlockState (GNMGenericNetworkH hNet,
 CPLErr CPL_DLL CPL_STDCALL GNMChangeAllBlockState (GNMGenericNetworkH hNet,
                                                    int bIsBlock);
 
+CPLErr CPL_DLL CPL_STDCALL GNMBuildContractionHierarchy (GNMGenericNetworkH hNet,
+                                                     GDALProgressFunc pfnProgress,
+                                                     void *pProgressArg);
+
+CPLErr CPL_DLL CPL_STDCALL GNMGetShortestPathCosts (GNMGenericNetworkH hNet,
+                                                    GNMGFID nStartFID,
+                                                    int nEndCount,
+                                                    const GNMGFID *panEndFIDs,
+                                                    double *padfCosts);
+
 CPL_C_END
 
 #endif // GNM_API
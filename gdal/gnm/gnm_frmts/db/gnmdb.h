@@ -49,6 +49,8 @@ protected:
     virtual CPLErr DeleteMetadataLayer();
     virtual CPLErr DeleteGraphLayer();
     virtual CPLErr DeleteFeaturesLayer();
+    virtual CPLErr CreateContractionStorage();
+    virtual CPLErr DeleteContractionLayer();
     virtual CPLErr DeleteNetworkLayers();
     virtual CPLErr LoadNetworkLayer(const char* pszLayername);
     virtual bool CheckStorageDriverSupport(const char* pszDriverName);
@@ -78,6 +78,8 @@ CPLErr GNMDatabaseNetwork::Open(GDALOpenInfo *poOpenInfo)
         return CE_Failure;
     }
 
+    LoadContractionLayer(m_poDS);
+
     return CE_None;
 }
 
@@ -226,7 +228,8 @@ int GNMDatabaseNetwork::CheckNetworkExist(const char *pszFilename, char **papszO
 
         if(EQUAL(poLayer->GetName(), GNM_SYSLAYER_META) ||
            EQUAL(poLayer->GetName(), GNM_SYSLAYER_GRAPH) ||
-           EQUAL(poLayer->GetName(), GNM_SYSLAYER_FEATURES) )
+           EQUAL(poLayer->GetName(), GNM_SYSLAYER_FEATURES) ||
+           EQUAL(poLayer->GetName(), GNM_SYSLAYER_CONTRACTION) )
         {
             anDeleteLayers.push_back(i);
         }
@@ -268,6 +271,21 @@ CPLErr GNMDatabaseNetwork::DeleteFeaturesLayer()
     return DeleteLayerByName(GNM_SYSLAYER_FEATURES);
 }
 
+CPLErr GNMDatabaseNetwork::CreateContractionStorage()
+{
+    if(NULL == m_poDS)
+        return CE_Failure;
+    return CreateContractionLayer(m_poDS);
+}
+
+CPLErr GNMDatabaseNetwork::DeleteContractionLayer()
+{
+    if(NULL == m_poContractionLayer)
+        return CE_None;
+    m_poContractionLayer = NULL;
+    return DeleteLayerByName(GNM_SYSLAYER_CONTRACTION);
+}
+
 CPLErr GNMDatabaseNetwork::DeleteLayerByName(const char* pszLayerName)
 {
     if(NULL == m_poDS)
@@ -61,6 +61,8 @@ protected:
     virtual CPLErr CreateFeaturesLayerFromFile( const char* pszFilename,
                                         char** papszOptions );
     virtual CPLErr DeleteFeaturesLayer();
+    virtual CPLErr CreateContractionStorage();
+    virtual CPLErr DeleteContractionLayer();
     virtual CPLErr DeleteNetworkLayers();
     virtual CPLErr LoadNetworkLayer(const char* pszLayername);
     virtual bool CheckStorageDriverSupport(const char* pszDriverName);
@@ -71,5 +73,6 @@ protected:
     GDALDataset* m_pMetadataDS;
     GDALDataset* m_pGraphDS;
     GDALDataset* m_pFeaturesDS;
+    GDALDataset* m_pContractionDS;
     std::map<OGRLayer*, GDALDataset*> m_mpLayerDatasetMap;
 };
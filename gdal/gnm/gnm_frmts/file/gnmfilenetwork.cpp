@@ -37,6 +37,7 @@ GNMFileNetwork::GNMFileNetwork() : GNMGenericNetwork()
     m_pMetadataDS = NULL;
     m_pGraphDS = NULL;
     m_pFeaturesDS = NULL;
+    m_pContractionDS = NULL;
 }
 
 GNMFileNetwork::~GNMFileNetwork()
@@ -45,6 +46,7 @@ GNMFileNetwork::~GNMFileNetwork()
 
     GDALClose(m_pGraphDS);
     GDALClose(m_pFeaturesDS);
+    GDALClose(m_pContractionDS);
     GDALClose(m_pMetadataDS);
 }
 
@@ -125,6 +127,20 @@ CPLErr GNMFileNetwork::Open(GDALOpenInfo *poOpenInfo)
         return CE_Failure;
     }
 
+    // optional contraction hierarchy
+    // (pszExt may have been overwritten by CPLFormFilename())
+    CPLString soExt = CPLGetExtension(soMetadatafile);
+    CPLString soContractionfile = CPLFormFilename(m_soNetworkFullName,
+                                            GNM_SYSLAYER_CONTRACTION, soExt);
+    VSIStatBufL sStat;
+    if( VSIStatL(soContractionfile, &sStat) == 0 )
+    {
+        m_pContractionDS = (GDALDataset*) GDALOpenEx( soContractionfile,
+                            GDAL_OF_VECTOR | GDAL_OF_UPDATE, NULL, NULL, NULL );
+        if( NULL != m_pContractionDS )
+            LoadContractionLayer(m_pContractionDS);
+    }
+
     return CE_None;
 }
 
@@ -168,6 +184,7 @@ int GNMFileNetwork::CheckNetworkExist(const char *pszFilename, char **papszOptio
             if( EQUAL(CPLGetBasename(papszFiles[i]), GNM_SYSLAYER_META) ||
                 EQUAL(CPLGetBasename(papszFiles[i]), GNM_SYSLAYER_GRAPH) ||
                 EQUAL(CPLGetBasename(papszFiles[i]), GNM_SYSLAYER_FEATURES) ||
+                EQUAL(CPLGetBasename(papszFiles[i]), GNM_SYSLAYER_CONTRACTION) ||
                 EQUAL(papszFiles[i], GNM_SRSFILENAME) )
             {
                 if(bOverwrite)
@@ -374,6 +391,38 @@ CPLErr GNMFileNetwork::DeleteFeaturesLayer()
     return CE_Failure;
 }
 
+CPLErr GNMFileNetwork::CreateContractionStorage()
+{
+    if(NULL == m_poLayerDriver)
+        return CE_Failure;
+
+    const char* pszExt = m_poLayerDriver->GetMetadataItem(GDAL_DMD_EXTENSION);
+    CPLString osDSFileName = CPLFormFilename(m_soNetworkFullName,
+                                             GNM_SYSLAYER_CONTRACTION, pszExt);
+
+    m_pContractionDS = m_poLayerDriver->Create(osDSFileName, 0, 0, 0,
+                                               GDT_Unknown, NULL );
+
+    if( m_pContractionDS == NULL )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined, "Creation of '%s' file failed",
+                  osDSFileName.c_str() );
+        return CE_Failure;
+    }
+
+    return GNMGenericNetwork::CreateContractionLayer(m_pContractionDS);
+}
+
+CPLErr GNMFileNetwork::DeleteContractionLayer()
+{
+    if(NULL != m_pContractionDS)
+    {
+        m_poContractionLayer = NULL;
+        return m_pContractionDS->DeleteLayer(0) == OGRERR_NONE ? CE_None : CE_Failure;
+    }
+    return CE_None;
+}
+
 CPLErr GNMFileNetwork::DeleteNetworkLayers()
 {
     while(GetLayerCount() > 0)
@@ -47,6 +47,9 @@
 #define GNM_SYSLAYER_GRAPH      "_gnm_graph"
 #define GNM_SYSLAYER_FEATURES   "_gnm_features"
 
+// Optional system layers.
+#define GNM_SYSLAYER_CONTRACTION "_gnm_contraction"
+
 // System field names.
 // FORMAT NOTE: Shapefile driver does not support field names more than 10
 //              characters.
@@ -64,6 +67,8 @@
 #define GNM_SYSFIELD_BLOCKED    "blocked"
 #define GNM_SYSFIELD_PATHNUM    "path_num"
 #define GNM_SYSFIELD_TYPE       "ftype"
+#define GNM_SYSFIELD_VIA        "via"
+#define GNM_SYSFIELD_RANK       "rank"
 
 // Rule strings key-words.
 #define GNM_RULEKW_CONNECTS "CONNECTS"
@@ -84,6 +89,11 @@
 #define GNM_BLOCK_CONN 0x0004  // the connection edge is blocked
 #define GNM_BLOCK_ALL GNM_BLOCK_SRC | GNM_BLOCK_TGT | GNM_BLOCK_CONN
 
+// Contraction hierarchy record types
+#define GNM_CH_RANK      0   // rank of a vertex
+#define GNM_CH_SHORTCUT  1   // shortcut between two vertices
+#define GNM_CH_SIGNATURE 2   // signature of the graph the hierarchy was built on
+
 
 // Other string constants.
 #define GNM_SRSFILENAME "_gnm_srs.prj"
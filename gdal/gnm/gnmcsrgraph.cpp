@@ -0,0 +1,955 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  GDAL/OGR Geography Network support (Geographic Network Model)
+ * Purpose:  GNM frozen graph and contraction hierarchy implementation.
+ * Author:   Even Rouault, <even dot rouault at mines-paris dot org>
+ *
+ ******************************************************************************
+ * Copyright (c) 2016, Even Rouault <even dot rouault at mines-paris dot org>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "gnmgraph.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+// Maximum number of vertices settled by a witness search during the
+// contraction. A lower value speeds up the preprocessing but may add
+// useless shortcuts.
+#define GNM_CH_WITNESS_SETTLED_LIMIT 500
+
+typedef std::pair<double, int> GNMHeapItem;
+
+// Arc between two vertices (indices), used while building the arrays.
+struct GNMCSRArc
+{
+    int nSrc;
+    int nTgt;
+    int nVia;
+    GNMGFID nEdgeFID;
+    double dfCost;
+
+    bool operator<(const GNMCSRArc &other) const
+    {
+        if(nSrc != other.nSrc)
+            return nSrc < other.nSrc;
+        if(nTgt != other.nTgt)
+            return nTgt < other.nTgt;
+        if(dfCost != other.dfCost)
+            return dfCost < other.dfCost;
+        // Prefer the arcs of the graph to the shortcuts of same cost.
+        return nVia < other.nVia;
+    }
+};
+
+/************************************************************************/
+/*                            GNMCSRGraph()                             */
+/************************************************************************/
+
+GNMCSRGraph::GNMCSRGraph(const std::map<GNMGFID, GNMStdVertex> &mstVertices,
+                         const std::map<GNMGFID, GNMStdEdge> &mstEdges)
+{
+    m_anVertexFIDs.reserve(mstVertices.size());
+    std::vector<bool> abBlocked;
+    abBlocked.reserve(mstVertices.size());
+    for(std::map<GNMGFID, GNMStdVertex>::const_iterator it = mstVertices.begin();
+        it != mstVertices.end(); ++it)
+    {
+        m_anVertexFIDs.push_back(it->first);
+        abBlocked.push_back(it->second.bIsBloked);
+    }
+
+    // Collect the arcs: an arc cannot lead to a blocked vertex.
+    std::vector<GNMCSRArc> asArcs;
+    asArcs.reserve(mstEdges.size());
+    for(std::map<GNMGFID, GNMStdEdge>::const_iterator it = mstEdges.begin();
+        it != mstEdges.end(); ++it)
+    {
+        const GNMStdEdge &stEdge = it->second;
+        if(stEdge.bIsBloked)
+            continue;
+        int nSrc = GetVertexIndex(stEdge.nSrcVertexFID);
+        int nTgt = GetVertexIndex(stEdge.nTgtVertexFID);
+        if(nSrc < 0 || nTgt < 0)
+            continue;
+
+        GNMCSRArc sArc;
+        sArc.nVia = -1;
+        sArc.nEdgeFID = it->first;
+        sArc.dfCost = stEdge.dfDirCost;
+        if(!abBlocked[nTgt])
+        {
+            sArc.nSrc = nSrc;
+            sArc.nTgt = nTgt;
+            asArcs.push_back(sArc);
+        }
+        if(stEdge.bIsBidir && !abBlocked[nSrc])
+        {
+            sArc.nSrc = nTgt;
+            sArc.nTgt = nSrc;
+            asArcs.push_back(sArc);
+        }
+    }
+
+    // Compressed sparse row storage.
+    const int nVertexCount = static_cast<int>(m_anVertexFIDs.size());
+    m_anOutOffsets.resize(nVertexCount + 1, 0);
+    for(size_t i = 0; i < asArcs.size(); ++i)
+        m_anOutOffsets[asArcs[i].nSrc + 1]++;
+    for(int i = 0; i < nVertexCount; ++i)
+        m_anOutOffsets[i + 1] += m_anOutOffsets[i];
+
+    m_anArcTargets.resize(asArcs.size());
+    m_adfArcCosts.resize(asArcs.size());
+    m_anArcEdgeFIDs.resize(asArcs.size());
+    std::vector<int> anPos(m_anOutOffsets.begin(), m_anOutOffsets.end() - 1);
+    for(size_t i = 0; i < asArcs.size(); ++i)
+    {
+        int iPos = anPos[asArcs[i].nSrc]++;
+        m_anArcTargets[iPos] = asArcs[i].nTgt;
+        m_adfArcCosts[iPos] = asArcs[i].dfCost;
+        m_anArcEdgeFIDs[iPos] = asArcs[i].nEdgeFID;
+    }
+
+    InitSearch(m_oForward);
+    InitSearch(m_oBackward);
+}
+
+/************************************************************************/
+/*                           GetVertexIndex()                           */
+/************************************************************************/
+
+int GNMCSRGraph::GetVertexIndex(GNMGFID nFID) const
+{
+    GNMVECTOR::const_iterator it = std::lower_bound(m_anVertexFIDs.begin(),
+                                                    m_anVertexFIDs.end(), nFID);
+    if(it == m_anVertexFIDs.end() || *it != nFID)
+        return -1;
+    return static_cast<int>(it - m_anVertexFIDs.begin());
+}
+
+/************************************************************************/
+/*                       Search state management                        */
+/************************************************************************/
+
+void GNMCSRGraph::InitSearch(SearchState &oState)
+{
+    const size_t nVertexCount = m_anVertexFIDs.size();
+    oState.anReachedStamp.assign(nVertexCount, 0);
+    oState.anSettledStamp.assign(nVertexCount, 0);
+    oState.adfCost.resize(nVertexCount);
+    oState.anPredVertex.resize(nVertexCount);
+    oState.anPredArc.resize(nVertexCount);
+    oState.nStamp = 0;
+}
+
+void GNMCSRGraph::ResetSearch(SearchState &oState)
+{
+    oState.aoHeap.clear();
+    oState.nStamp++;
+    if(oState.nStamp == 0)
+    {
+        // The stamp has wrapped around: the marks must really be cleared.
+        InitSearch(oState);
+        oState.nStamp = 1;
+    }
+}
+
+void GNMCSRGraph::Reach(SearchState &oState, int iVertex, double dfCost,
+                        int iPredVertex, int iPredArc)
+{
+    oState.anReachedStamp[iVertex] = oState.nStamp;
+    oState.adfCost[iVertex] = dfCost;
+    oState.anPredVertex[iVertex] = iPredVertex;
+    oState.anPredArc[iVertex] = iPredArc;
+    oState.aoHeap.push_back(GNMHeapItem(dfCost, iVertex));
+    std::push_heap(oState.aoHeap.begin(), oState.aoHeap.end(),
+                   std::greater<GNMHeapItem>());
+}
+
+// Settle the reached vertex with the minimum cost, and return it (or -1 if
+// there is no more vertex to settle). Outdated heap items are skipped.
+int GNMCSRGraph::PopMin(SearchState &oState)
+{
+    while(!oState.aoHeap.empty())
+    {
+        std::pop_heap(oState.aoHeap.begin(), oState.aoHeap.end(),
+                      std::greater<GNMHeapItem>());
+        GNMHeapItem oItem = oState.aoHeap.back();
+        oState.aoHeap.pop_back();
+        const int iVertex = oItem.second;
+        if(IsSettled(oState, iVertex) || oItem.first > oState.adfCost[iVertex])
+            continue;
+        oState.anSettledStamp[iVertex] = oState.nStamp;
+        return iVertex;
+    }
+    return -1;
+}
+
+/************************************************************************/
+/*                           DijkstraSearch()                           */
+/*                                                                      */
+/*      Search the best paths from iStart in the graph, until all the   */
+/*      target vertices are settled.                                    */
+/************************************************************************/
+
+void GNMCSRGraph::DijkstraSearch(int iStart, const std::vector<int> &aiTargets)
+{
+    // The backward search state is used to mark the targets.
+    ResetSearch(m_oBackward);
+    int nRemaining = 0;
+    for(size_t i = 0; i < aiTargets.size(); ++i)
+    {
+        if(aiTargets[i] >= 0 && !IsReached(m_oBackward, aiTargets[i]))
+        {
+            m_oBackward.anReachedStamp[aiTargets[i]] = m_oBackward.nStamp;
+            nRemaining++;
+        }
+    }
+
+    ResetSearch(m_oForward);
+    Reach(m_oForward, iStart, 0.0, -1, -1);
+    while(nRemaining > 0)
+    {
+        const int iVertex = PopMin(m_oForward);
+        if(iVertex < 0)
+            break;
+        if(IsReached(m_oBackward, iVertex))
+            nRemaining--;
+
+        const double dfCost = m_oForward.adfCost[iVertex];
+        for(int iArc = m_anOutOffsets[iVertex];
+            iArc < m_anOutOffsets[iVertex + 1]; ++iArc)
+        {
+            const int iTarget = m_anArcTargets[iArc];
+            const double dfNewCost = dfCost + m_adfArcCosts[iArc];
+            if(!IsReached(m_oForward, iTarget) ||
+               (!IsSettled(m_oForward, iTarget) &&
+                dfNewCost < m_oForward.adfCost[iTarget]))
+            {
+                Reach(m_oForward, iTarget, dfNewCost, iVertex, iArc);
+            }
+        }
+    }
+}
+
+/************************************************************************/
+/*                            ShortestPath()                            */
+/************************************************************************/
+
+GNMPATH GNMCSRGraph::ShortestPath(GNMGFID nStartFID, GNMGFID nEndFID)
+{
+    GNMPATH aoPath;
+    if(nStartFID == nEndFID)
+    {
+        aoPath.push_back(std::make_pair(nStartFID, -1));
+        return aoPath;
+    }
+
+    const int iStart = GetVertexIndex(nStartFID);
+    const int iEnd = GetVertexIndex(nEndFID);
+    if(iStart < 0 || iEnd < 0)
+        return aoPath;
+
+    if(HasContractionHierarchy())
+    {
+        int iMeeting = -1;
+        CHSearch(iStart, iEnd, false, &iMeeting);
+        if(iMeeting < 0)
+            return aoPath;
+
+        // Up part of the path, from the meeting vertex back to the start.
+        GNMPATH aoUpPath;
+        for(int iVertex = iMeeting; iVertex != iStart;
+            iVertex = m_oForward.anPredVertex[iVertex])
+        {
+            const int iPred = m_oForward.anPredVertex[iVertex];
+            GNMPATH aoArcPath;
+            UnpackCHArc(iPred, iVertex, m_asUpArcs[m_oForward.anPredArc[iVertex]],
+                        aoArcPath);
+            aoUpPath.insert(aoUpPath.end(), aoArcPath.rbegin(), aoArcPath.rend());
+        }
+        aoPath.push_back(std::make_pair(nStartFID, -1));
+        aoPath.insert(aoPath.end(), aoUpPath.rbegin(), aoUpPath.rend());
+
+        // Down part of the path, from the meeting vertex to the end.
+        for(int iVertex = iMeeting; iVertex != iEnd;
+            iVertex = m_oBackward.anPredVertex[iVertex])
+        {
+            UnpackCHArc(iVertex, m_oBackward.anPredVertex[iVertex],
+                        m_asDownArcs[m_oBackward.anPredArc[iVertex]], aoPath);
+        }
+        return aoPath;
+    }
+
+    std::vector<int> aiTargets(1, iEnd);
+    DijkstraSearch(iStart, aiTargets);
+    if(!IsSettled(m_oForward, iEnd))
+        return aoPath;
+
+    for(int iVertex = iEnd; iVertex != iStart;
+        iVertex = m_oForward.anPredVertex[iVertex])
+    {
+        aoPath.push_back(std::make_pair(m_anVertexFIDs[iVertex],
+                            m_anArcEdgeFIDs[m_oForward.anPredArc[iVertex]]));
+    }
+    aoPath.push_back(std::make_pair(nStartFID, -1));
+    std::reverse(aoPath.begin(), aoPath.end());
+    return aoPath;
+}
+
+/************************************************************************/
+/*                         ShortestPathCosts()                          */
+/************************************************************************/
+
+std::vector<double> GNMCSRGraph::ShortestPathCosts(GNMGFID nStartFID,
+                                                   const GNMVECTOR &anEndFIDs)
+{
+    const double dfInfinity = std::numeric_limits<double>::infinity();
+    std::vector<double> adfCosts(anEndFIDs.size(), dfInfinity);
+    std::vector<int> aiTargets(anEndFIDs.size());
+    for(size_t i = 0; i < anEndFIDs.size(); ++i)
+    {
+        aiTargets[i] = GetVertexIndex(anEndFIDs[i]);
+        if(anEndFIDs[i] == nStartFID)
+            adfCosts[i] = 0.0;
+    }
+
+    const int iStart = GetVertexIndex(nStartFID);
+    if(iStart < 0)
+        return adfCosts;
+
+    if(HasContractionHierarchy())
+    {
+        // The search space of the start vertex is explored once, and each
+        // target only needs its own (small) backward search.
+        CHForwardSearch(iStart);
+        for(size_t i = 0; i < aiTargets.size(); ++i)
+        {
+            if(aiTargets[i] >= 0 && aiTargets[i] != iStart)
+                adfCosts[i] = CHSearch(iStart, aiTargets[i], true, NULL);
+        }
+        return adfCosts;
+    }
+
+    DijkstraSearch(iStart, aiTargets);
+    for(size_t i = 0; i < aiTargets.size(); ++i)
+    {
+        if(aiTargets[i] >= 0 && aiTargets[i] != iStart &&
+           IsSettled(m_oForward, aiTargets[i]))
+            adfCosts[i] = m_oForward.adfCost[aiTargets[i]];
+    }
+    return adfCosts;
+}
+
+/************************************************************************/
+/*                          CHForwardSearch()                           */
+/*                                                                      */
+/*      Complete upward search from iStart.                             */
+/************************************************************************/
+
+void GNMCSRGraph::CHForwardSearch(int iStart)
+{
+    ResetSearch(m_oForward);
+    Reach(m_oForward, iStart, 0.0, -1, -1);
+    int iVertex;
+    while((iVertex = PopMin(m_oForward)) >= 0)
+    {
+        const double dfCost = m_oForward.adfCost[iVertex];
+        for(int iArc = m_anUpOffsets[iVertex];
+            iArc < m_anUpOffsets[iVertex + 1]; ++iArc)
+        {
+            const int iTarget = m_asUpArcs[iArc].nVertex;
+            const double dfNewCost = dfCost + m_asUpArcs[iArc].dfCost;
+            if(!IsReached(m_oForward, iTarget) ||
+               dfNewCost < m_oForward.adfCost[iTarget])
+            {
+                Reach(m_oForward, iTarget, dfNewCost, iVertex, iArc);
+            }
+        }
+    }
+}
+
+/************************************************************************/
+/*                              CHSearch()                              */
+/*                                                                      */
+/*      Bidirectional upward search between iStart and iEnd. If         */
+/*      bForwardDone is true, the forward search has already been done  */
+/*      by CHForwardSearch() and only the backward search is run.       */
+/*      Returns the cost of the best path (infinity if there is none)   */
+/*      and sets *piMeeting to its highest ranked vertex.               */
+/************************************************************************/
+
+double GNMCSRGraph::CHSearch(int iStart, int iEnd, bool bForwardDone,
+                             int *piMeeting)
+{
+    double dfBest = std::numeric_limits<double>::infinity();
+    int iMeeting = -1;
+
+    if(!bForwardDone)
+    {
+        ResetSearch(m_oForward);
+        Reach(m_oForward, iStart, 0.0, -1, -1);
+    }
+    ResetSearch(m_oBackward);
+    Reach(m_oBackward, iEnd, 0.0, -1, -1);
+
+    bool bForward = bForwardDone;
+    while(true)
+    {
+        // Alternate the directions, and stop a direction when it cannot
+        // improve the best path anymore.
+        bool bForwardActive = !bForwardDone && !m_oForward.aoHeap.empty() &&
+                              m_oForward.aoHeap.front().first < dfBest;
+        bool bBackwardActive = !m_oBackward.aoHeap.empty() &&
+                               m_oBackward.aoHeap.front().first < dfBest;
+        if(!bForwardActive && !bBackwardActive)
+            break;
+        bForward = bForwardActive && (!bForward || !bBackwardActive);
+
+        SearchState &oState = bForward ? m_oForward : m_oBackward;
+        SearchState &oOther = bForward ? m_oBackward : m_oForward;
+        const std::vector<int> &anOffsets = bForward ? m_anUpOffsets :
+                                                       m_anDownOffsets;
+        const std::vector<CHArc> &asArcs = bForward ? m_asUpArcs :
+                                                      m_asDownArcs;
+
+        const int iVertex = PopMin(oState);
+        if(iVertex < 0)
+            continue;
+        const double dfCost = oState.adfCost[iVertex];
+        if(IsReached(oOther, iVertex) &&
+           (!bForwardDone || IsSettled(oOther, iVertex)) &&
+           dfCost + oOther.adfCost[iVertex] < dfBest)
+        {
+            dfBest = dfCost + oOther.adfCost[iVertex];
+            iMeeting = iVertex;
+        }
+
+        for(int iArc = anOffsets[iVertex]; iArc < anOffsets[iVertex + 1];
+            ++iArc)
+        {
+            const int iTarget = asArcs[iArc].nVertex;
+            const double dfNewCost = dfCost + asArcs[iArc].dfCost;
+            if(!IsReached(oState, iTarget) ||
+               dfNewCost < oState.adfCost[iTarget])
+            {
+                Reach(oState, iTarget, dfNewCost, iVertex, iArc);
+            }
+        }
+    }
+
+    if(piMeeting != NULL)
+        *piMeeting = iMeeting;
+    return dfBest;
+}
+
+/************************************************************************/
+/*                             FindCHArc()                              */
+/*                                                                      */
+/*      Find the arc of the hierarchy from iFrom to iTo.                */
+/************************************************************************/
+
+const GNMCSRGraph::CHArc *GNMCSRGraph::FindCHArc(int iFrom, int iTo) const
+{
+    if(m_anRank[iFrom] < m_anRank[iTo])
+    {
+        for(int iArc = m_anUpOffsets[iFrom]; iArc < m_anUpOffsets[iFrom + 1];
+            ++iArc)
+        {
+            if(m_asUpArcs[iArc].nVertex == iTo)
+                return &m_asUpArcs[iArc];
+        }
+    }
+    else
+    {
+        for(int iArc = m_anDownOffsets[iTo]; iArc < m_anDownOffsets[iTo + 1];
+            ++iArc)
+        {
+            if(m_asDownArcs[iArc].nVertex == iFrom)
+                return &m_asDownArcs[iArc];
+        }
+    }
+    return NULL;
+}
+
+/************************************************************************/
+/*                            UnpackCHArc()                             */
+/*                                                                      */
+/*      Append the edges of the graph an arc from iFrom to iTo stands   */
+/*      for to the path.                                                */
+/************************************************************************/
+
+void GNMCSRGraph::UnpackCHArc(int iFrom, int iTo, const CHArc &oArc,
+                              GNMPATH &aoPath) const
+{
+    if(oArc.nVia < 0)
+    {
+        aoPath.push_back(std::make_pair(m_anVertexFIDs[iTo], oArc.nEdgeFID));
+        return;
+    }
+
+    const CHArc *poFirst = FindCHArc(iFrom, oArc.nVia);
+    const CHArc *poSecond = FindCHArc(oArc.nVia, iTo);
+    if(poFirst == NULL || poSecond == NULL)
+    {
+        // Cannot happen with a consistent hierarchy.
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "Inconsistent contraction hierarchy.");
+        return;
+    }
+    UnpackCHArc(iFrom, oArc.nVia, *poFirst, aoPath);
+    UnpackCHArc(oArc.nVia, iTo, *poSecond, aoPath);
+}
+
+/************************************************************************/
+/*                    FinalizeContractionHierarchy()                    */
+/*                                                                      */
+/*      Build the upward and downward arc lists from the graph arcs,    */
+/*      the shortcuts and the vertex ranks.                             */
+/************************************************************************/
+
+void GNMCSRGraph::FinalizeContractionHierarchy(const std::vector<int> &anRank,
+                                 const std::vector<GNMCHShortcut> &asShortcuts)
+{
+    std::vector<GNMCSRArc> asArcs;
+    asArcs.reserve(m_anArcTargets.size() + asShortcuts.size());
+    const int nVertexCount = static_cast<int>(m_anVertexFIDs.size());
+    for(int iVertex = 0; iVertex < nVertexCount; ++iVertex)
+    {
+        for(int iArc = m_anOutOffsets[iVertex];
+            iArc < m_anOutOffsets[iVertex + 1]; ++iArc)
+        {
+            if(m_anArcTargets[iArc] == iVertex)
+                continue;
+            GNMCSRArc sArc;
+            sArc.nSrc = iVertex;
+            sArc.nTgt = m_anArcTargets[iArc];
+            sArc.nVia = -1;
+            sArc.nEdgeFID = m_anArcEdgeFIDs[iArc];
+            sArc.dfCost = m_adfArcCosts[iArc];
+            asArcs.push_back(sArc);
+        }
+    }
+    for(size_t i = 0; i < asShortcuts.size(); ++i)
+    {
+        GNMCSRArc sArc;
+        sArc.nSrc = GetVertexIndex(asShortcuts[i].nSrcVertexFID);
+        sArc.nTgt = GetVertexIndex(asShortcuts[i].nTgtVertexFID);
+        sArc.nVia = GetVertexIndex(asShortcuts[i].nViaVertexFID);
+        sArc.nEdgeFID = -1;
+        sArc.dfCost = asShortcuts[i].dfCost;
+        asArcs.push_back(sArc);
+    }
+
+    // Only keep the best arc between two vertices.
+    std::sort(asArcs.begin(), asArcs.end());
+    size_t nKept = 0;
+    for(size_t i = 0; i < asArcs.size(); ++i)
+    {
+        if(nKept > 0 && asArcs[nKept - 1].nSrc == asArcs[i].nSrc &&
+           asArcs[nKept - 1].nTgt == asArcs[i].nTgt)
+            continue;
+        asArcs[nKept++] = asArcs[i];
+    }
+    asArcs.resize(nKept);
+
+    m_anRank = anRank;
+    m_anUpOffsets.assign(nVertexCount + 1, 0);
+    m_anDownOffsets.assign(nVertexCount + 1, 0);
+    for(size_t i = 0; i < asArcs.size(); ++i)
+    {
+        if(anRank[asArcs[i].nSrc] < anRank[asArcs[i].nTgt])
+            m_anUpOffsets[asArcs[i].nSrc + 1]++;
+        else
+            m_anDownOffsets[asArcs[i].nTgt + 1]++;
+    }
+    for(int i = 0; i < nVertexCount; ++i)
+    {
+        m_anUpOffsets[i + 1] += m_anUpOffsets[i];
+        m_anDownOffsets[i + 1] += m_anDownOffsets[i];
+    }
+
+    m_asUpArcs.resize(m_anUpOffsets[nVertexCount]);
+    m_asDownArcs.resize(m_anDownOffsets[nVertexCount]);
+    std::vector<int> anUpPos(m_anUpOffsets.begin(), m_anUpOffsets.end() - 1);
+    std::vector<int> anDownPos(m_anDownOffsets.begin(),
+                               m_anDownOffsets.end() - 1);
+    for(size_t i = 0; i < asArcs.size(); ++i)
+    {
+        CHArc oArc;
+        oArc.nVia = asArcs[i].nVia;
+        oArc.nEdgeFID = asArcs[i].nEdgeFID;
+        oArc.dfCost = asArcs[i].dfCost;
+        if(anRank[asArcs[i].nSrc] < anRank[asArcs[i].nTgt])
+        {
+            oArc.nVertex = asArcs[i].nTgt;
+            m_asUpArcs[anUpPos[asArcs[i].nSrc]++] = oArc;
+        }
+        else
+        {
+            oArc.nVertex = asArcs[i].nSrc;
+            m_asDownArcs[anDownPos[asArcs[i].nTgt]++] = oArc;
+        }
+    }
+}
+
+/************************************************************************/
+/*                        GNMCHBuilder                                  */
+/*                                                                      */
+/*      Contraction of the vertices of a graph, by increasing           */
+/*      importance. The importance of a vertex is estimated with the    */
+/*      number of shortcuts its contraction adds minus the number of    */
+/*      arcs it removes, plus the number of already contracted          */
+/*      neighbours (to contract the graph uniformly). It is updated     */
+/*      lazily, when the vertex is about to be contracted.              */
+/************************************************************************/
+
+class GNMCHBuilder
+{
+public:
+    struct Neighbour
+    {
+        int nVertex;
+        double dfCost;
+    };
+
+    explicit GNMCHBuilder(int nVertexCount);
+
+    void AddArc(int nSrc, int nTgt, double dfCost);
+    bool Contract(GDALProgressFunc pfnProgress, void *pProgressArg);
+
+    std::vector<int>          anRank;
+    std::vector<GNMCHShortcut> asShortcuts; // vertex indices, not identificators
+
+private:
+    int  ContractVertex(int iVertex, bool bSimulate);
+    void WitnessSearch(int iSource, int iExcluded, double dfMaxCost);
+    static void SetNeighbour(std::vector<Neighbour> &aoList, int iVertex,
+                             double dfCost);
+    static void RemoveNeighbour(std::vector<Neighbour> &aoList, int iVertex);
+
+    int                                  nVertexCount;
+    std::vector< std::vector<Neighbour> > aaoOut;
+    std::vector< std::vector<Neighbour> > aaoIn;
+    std::vector<int>                     anContractedNeighbours;
+
+    // Witness search work arrays.
+    std::vector<unsigned>                anStamp;
+    std::vector<double>                  adfCost;
+    unsigned                             nStamp;
+    std::vector<GNMHeapItem>             aoHeap;
+};
+
+GNMCHBuilder::GNMCHBuilder(int nVertexCountIn) :
+    anRank(nVertexCountIn, -1),
+    nVertexCount(nVertexCountIn),
+    aaoOut(nVertexCountIn),
+    aaoIn(nVertexCountIn),
+    anContractedNeighbours(nVertexCountIn, 0),
+    anStamp(nVertexCountIn, 0),
+    adfCost(nVertexCountIn, 0.0),
+    nStamp(0)
+{
+}
+
+void GNMCHBuilder::SetNeighbour(std::vector<Neighbour> &aoList, int iVertex,
+                                double dfCost)
+{
+    for(size_t i = 0; i < aoList.size(); ++i)
+    {
+        if(aoList[i].nVertex == iVertex)
+        {
+            if(dfCost < aoList[i].dfCost)
+                aoList[i].dfCost = dfCost;
+            return;
+        }
+    }
+    Neighbour sNeighbour;
+    sNeighbour.nVertex = iVertex;
+    sNeighbour.dfCost = dfCost;
+    aoList.push_back(sNeighbour);
+}
+
+void GNMCHBuilder::RemoveNeighbour(std::vector<Neighbour> &aoList, int iVertex)
+{
+    for(size_t i = 0; i < aoList.size(); ++i)
+    {
+        if(aoList[i].nVertex == iVertex)
+        {
+            aoList[i] = aoList.back();
+            aoList.pop_back();
+            return;
+        }
+    }
+}
+
+void GNMCHBuilder::AddArc(int nSrc, int nTgt, double dfCost)
+{
+    if(nSrc == nTgt)
+        return;
+    SetNeighbour(aaoOut[nSrc], nTgt, dfCost);
+    SetNeighbour(aaoIn[nTgt], nSrc, dfCost);
+}
+
+// Limited Dijkstra search in the remaining graph, avoiding iExcluded.
+void GNMCHBuilder::WitnessSearch(int iSource, int iExcluded, double dfMaxCost)
+{
+    nStamp++;
+    if(nStamp == 0)
+    {
+        std::fill(anStamp.begin(), anStamp.end(), 0);
+        nStamp = 1;
+    }
+    aoHeap.clear();
+
+    anStamp[iSource] = nStamp;
+    adfCost[iSource] = 0.0;
+    aoHeap.push_back(GNMHeapItem(0.0, iSource));
+    int nSettled = 0;
+    while(!aoHeap.empty() && nSettled < GNM_CH_WITNESS_SETTLED_LIMIT)
+    {
+        std::pop_heap(aoHeap.begin(), aoHeap.end(), std::greater<GNMHeapItem>());
+        GNMHeapItem oItem = aoHeap.back();
+        aoHeap.pop_back();
+        const int iVertex = oItem.second;
+        if(oItem.first > adfCost[iVertex])
+            continue;
+        if(oItem.first > dfMaxCost)
+            break;
+        nSettled++;
+
+        const std::vector<Neighbour> &aoOut = aaoOut[iVertex];
+        for(size_t i = 0; i < aoOut.size(); ++i)
+        {
+            const int iTarget = aoOut[i].nVertex;
+            if(iTarget == iExcluded)
+                continue;
+            const double dfNewCost = oItem.first + aoOut[i].dfCost;
+            if(anStamp[iTarget] != nStamp || dfNewCost < adfCost[iTarget])
+            {
+                anStamp[iTarget] = nStamp;
+                adfCost[iTarget] = dfNewCost;
+                aoHeap.push_back(GNMHeapItem(dfNewCost, iTarget));
+                std::push_heap(aoHeap.begin(), aoHeap.end(),
+                               std::greater<GNMHeapItem>());
+            }
+        }
+    }
+}
+
+// Return the number of shortcuts needed to contract iVertex, and add them
+// and remove the vertex from the remaining graph if bSimulate is false.
+int GNMCHBuilder::ContractVertex(int iVertex, bool bSimulate)
+{
+    const std::vector<Neighbour> aoIn = aaoIn[iVertex];
+    const std::vector<Neighbour> aoOut = aaoOut[iVertex];
+    int nShortcuts = 0;
+
+    double dfMaxOut = 0.0;
+    for(size_t j = 0; j < aoOut.size(); ++j)
+        dfMaxOut = std::max(dfMaxOut, aoOut[j].dfCost);
+
+    for(size_t i = 0; i < aoIn.size(); ++i)
+    {
+        const int iSource = aoIn[i].nVertex;
+        WitnessSearch(iSource, iVertex, aoIn[i].dfCost + dfMaxOut);
+        for(size_t j = 0; j < aoOut.size(); ++j)
+        {
+            const int iTarget = aoOut[j].nVertex;
+            if(iTarget == iSource)
+                continue;
+            const double dfCost = aoIn[i].dfCost + aoOut[j].dfCost;
+            if(anStamp[iTarget] == nStamp && adfCost[iTarget] <= dfCost)
+                continue;
+
+            nShortcuts++;
+            if(!bSimulate)
+            {
+                GNMCHShortcut sShortcut;
+                sShortcut.nSrcVertexFID = iSource;
+                sShortcut.nTgtVertexFID = iTarget;
+                sShortcut.nViaVertexFID = iVertex;
+                sShortcut.dfCost = dfCost;
+                asShortcuts.push_back(sShortcut);
+                AddArc(iSource, iTarget, dfCost);
+            }
+        }
+    }
+
+    if(!bSimulate)
+    {
+        for(size_t i = 0; i < aoIn.size(); ++i)
+        {
+            RemoveNeighbour(aaoOut[aoIn[i].nVertex], iVertex);
+            anContractedNeighbours[aoIn[i].nVertex]++;
+        }
+        for(size_t j = 0; j < aoOut.size(); ++j)
+        {
+            RemoveNeighbour(aaoIn[aoOut[j].nVertex], iVertex);
+            anContractedNeighbours[aoOut[j].nVertex]++;
+        }
+        aaoIn[iVertex].clear();
+        aaoOut[iVertex].clear();
+    }
+
+    return nShortcuts;
+}
+
+bool GNMCHBuilder::Contract(GDALProgressFunc pfnProgress, void *pProgressArg)
+{
+    // The priorities are kept as integers, so that ties are resolved by
+    // the vertex index.
+    typedef std::pair<int, int> Priority;
+    std::vector<Priority> aoQueue;
+    aoQueue.reserve(nVertexCount);
+    for(int iVertex = 0; iVertex < nVertexCount; ++iVertex)
+    {
+        const int nPriority = ContractVertex(iVertex, true) -
+            static_cast<int>(aaoIn[iVertex].size() + aaoOut[iVertex].size());
+        aoQueue.push_back(Priority(nPriority, iVertex));
+    }
+    std::make_heap(aoQueue.begin(), aoQueue.end(), std::greater<Priority>());
+
+    int nRank = 0;
+    while(!aoQueue.empty())
+    {
+        std::pop_heap(aoQueue.begin(), aoQueue.end(), std::greater<Priority>());
+        const int iVertex = aoQueue.back().second;
+        aoQueue.pop_back();
+
+        const int nPriority = ContractVertex(iVertex, true) -
+            static_cast<int>(aaoIn[iVertex].size() + aaoOut[iVertex].size()) +
+            2 * anContractedNeighbours[iVertex];
+        if(!aoQueue.empty() && nPriority > aoQueue.front().first)
+        {
+            aoQueue.push_back(Priority(nPriority, iVertex));
+            std::push_heap(aoQueue.begin(), aoQueue.end(),
+                           std::greater<Priority>());
+            continue;
+        }
+
+        ContractVertex(iVertex, false);
+        anRank[iVertex] = nRank++;
+
+        if(pfnProgress != NULL && (nRank % 1000) == 0 &&
+           !pfnProgress(static_cast<double>(nRank) / nVertexCount, "",
+                        pProgressArg))
+        {
+            CPLError(CE_Failure, CPLE_UserInterrupt, "User terminated");
+            return false;
+        }
+    }
+
+    if(pfnProgress != NULL)
+        pfnProgress(1.0, "", pProgressArg);
+    return true;
+}
+
+/************************************************************************/
+/*                     BuildContractionHierarchy()                      */
+/************************************************************************/
+
+bool GNMCSRGraph::BuildContractionHierarchy(GDALProgressFunc pfnProgress,
+                                            void *pProgressArg)
+{
+    const int nVertexCount = static_cast<int>(m_anVertexFIDs.size());
+    GNMCHBuilder oBuilder(nVertexCount);
+    for(int iVertex = 0; iVertex < nVertexCount; ++iVertex)
+    {
+        for(int iArc = m_anOutOffsets[iVertex];
+            iArc < m_anOutOffsets[iVertex + 1]; ++iArc)
+        {
+            oBuilder.AddArc(iVertex, m_anArcTargets[iArc], m_adfArcCosts[iArc]);
+        }
+    }
+
+    if(!oBuilder.Contract(pfnProgress, pProgressArg))
+        return false;
+
+    std::vector<GNMCHShortcut> asShortcuts = oBuilder.asShortcuts;
+    for(size_t i = 0; i < asShortcuts.size(); ++i)
+    {
+        asShortcuts[i].nSrcVertexFID =
+            m_anVertexFIDs[static_cast<int>(asShortcuts[i].nSrcVertexFID)];
+        asShortcuts[i].nTgtVertexFID =
+            m_anVertexFIDs[static_cast<int>(asShortcuts[i].nTgtVertexFID)];
+        asShortcuts[i].nViaVertexFID =
+            m_anVertexFIDs[static_cast<int>(asShortcuts[i].nViaVertexFID)];
+    }
+
+    m_asShortcuts = asShortcuts;
+    FinalizeContractionHierarchy(oBuilder.anRank, m_asShortcuts);
+
+    CPLDebug("GNM", "Contraction hierarchy built: %d vertices, %d arcs, "
+             "%d shortcuts", nVertexCount,
+             static_cast<int>(m_anArcTargets.size()),
+             static_cast<int>(m_asShortcuts.size()));
+    return true;
+}
+
+/************************************************************************/
+/*                      GetContractionHierarchy()                       */
+/************************************************************************/
+
+void GNMCSRGraph::GetContractionHierarchy(GNMVECTOR &anVertexFIDs,
+                                std::vector<GNMCHShortcut> &asShortcuts) const
+{
+    anVertexFIDs.resize(m_anRank.size());
+    for(size_t i = 0; i < m_anRank.size(); ++i)
+        anVertexFIDs[m_anRank[i]] = m_anVertexFIDs[i];
+    asShortcuts = m_asShortcuts;
+}
+
+/************************************************************************/
+/*                      SetContractionHierarchy()                       */
+/************************************************************************/
+
+bool GNMCSRGraph::SetContractionHierarchy(const GNMVECTOR &anVertexFIDs,
+                                const std::vector<GNMCHShortcut> &asShortcuts)
+{
+    if(anVertexFIDs.size() != m_anVertexFIDs.size())
+        return false;
+
+    std::vector<int> anRank(m_anVertexFIDs.size(), -1);
+    for(size_t i = 0; i < anVertexFIDs.size(); ++i)
+    {
+        const int iVertex = GetVertexIndex(anVertexFIDs[i]);
+        if(iVertex < 0 || anRank[iVertex] >= 0)
+            return false;
+        anRank[iVertex] = static_cast<int>(i);
+    }
+
+    for(size_t i = 0; i < asShortcuts.size(); ++i)
+    {
+        const int iSrc = GetVertexIndex(asShortcuts[i].nSrcVertexFID);
+        const int iTgt = GetVertexIndex(asShortcuts[i].nTgtVertexFID);
+        const int iVia = GetVertexIndex(asShortcuts[i].nViaVertexFID);
+        if(iSrc < 0 || iTgt < 0 || iVia < 0 ||
+           anRank[iVia] >= anRank[iSrc] || anRank[iVia] >= anRank[iTgt])
+            return false;
+    }
+
+    m_asShortcuts = asShortcuts;
+    FinalizeContractionHierarchy(anRank, m_asShortcuts);
+    return true;
+}
@@ -32,6 +32,7 @@
 #include "gnm_api.h"
 #include "ogrsf_frmts.h"
 
+#include <algorithm>
 #include <set>
 
 GNMGenericNetwork::GNMGenericNetwork() :
@@ -42,6 +43,7 @@ GNMGenericNetwork::GNMGenericNetwork() :
     m_poMetadataLayer(NULL),
     m_poGraphLayer(NULL),
     m_poFeaturesLayer(NULL),
+    m_poContractionLayer(NULL),
     m_poLayerDriver(NULL),
     m_bIsRulesChanged(false),
     m_bIsGraphLoaded(false)
@@ -162,6 +164,9 @@ CPLErr GNMGenericNetwork::Delete()
     if(eResult != CE_None)
         return eResult;
     eResult = DeleteGraphLayer();
+    if(eResult != CE_None)
+        return eResult;
+    eResult = DeleteContractionLayer();
     if(eResult != CE_None)
         return eResult;
 
@@ -858,6 +863,111 @@ OGRLayer *GNMGenericNetwork::GetPath(GNMGFID nStartFID, GNMGFID nEndFID,
     return poResLayer;
 }
 
+CPLErr GNMGenericNetwork::GetShortestPathCosts(GNMGFID nStartFID,
+                                        const std::vector<GNMGFID> &anEndFIDs,
+                                        std::vector<double> &adfCosts)
+{
+    if(!m_bIsGraphLoaded && LoadGraph() != CE_None)
+    {
+        return CE_Failure;
+    }
+
+    adfCosts = m_oGraph.GetShortestPathCosts(nStartFID, anEndFIDs);
+    return CE_None;
+}
+
+CPLErr GNMGenericNetwork::BuildContractionHierarchy(GDALProgressFunc pfnProgress,
+                                                    void *pProgressArg)
+{
+    if(!m_bIsGraphLoaded && LoadGraph() != CE_None)
+    {
+        return CE_Failure;
+    }
+
+    if(m_oGraph.BuildContractionHierarchy(pfnProgress, pProgressArg) != CE_None)
+        return CE_Failure;
+
+    GNMVECTOR anVertexFIDs;
+    std::vector<GNMCHShortcut> asShortcuts;
+    m_oGraph.GetContractionHierarchy(anVertexFIDs, asShortcuts);
+
+    // Replace the previously stored hierarchy
+    if(NULL == m_poContractionLayer)
+    {
+        if(CreateContractionStorage() != CE_None)
+            return CE_Failure;
+    }
+    else
+    {
+        OGRFeature *poFeature;
+        std::vector<GIntBig> anFIDs;
+        m_poContractionLayer->ResetReading();
+        while ((poFeature = m_poContractionLayer->GetNextFeature()) != NULL)
+        {
+            anFIDs.push_back(poFeature->GetFID());
+            OGRFeature::DestroyFeature(poFeature);
+        }
+        for(size_t i = 0; i < anFIDs.size(); ++i)
+            CPL_IGNORE_RET_VAL(m_poContractionLayer->DeleteFeature(anFIDs[i]));
+    }
+
+    const bool bInTransaction =
+                    m_poContractionLayer->StartTransaction() == OGRERR_NONE;
+    OGRFeatureDefn *poDefn = m_poContractionLayer->GetLayerDefn();
+    bool bOK = true;
+    OGRFeature *poFeature;
+
+    for(size_t i = 0; bOK && i < anVertexFIDs.size(); ++i)
+    {
+        poFeature = OGRFeature::CreateFeature(poDefn);
+        poFeature->SetField(GNM_SYSFIELD_TYPE, GNM_CH_RANK);
+        poFeature->SetField(GNM_SYSFIELD_SOURCE, anVertexFIDs[i]);
+        poFeature->SetField(GNM_SYSFIELD_RANK, static_cast<int>(i));
+        bOK = m_poContractionLayer->CreateFeature(poFeature) == OGRERR_NONE;
+        OGRFeature::DestroyFeature(poFeature);
+    }
+
+    for(size_t i = 0; bOK && i < asShortcuts.size(); ++i)
+    {
+        poFeature = OGRFeature::CreateFeature(poDefn);
+        poFeature->SetField(GNM_SYSFIELD_TYPE, GNM_CH_SHORTCUT);
+        poFeature->SetField(GNM_SYSFIELD_SOURCE, asShortcuts[i].nSrcVertexFID);
+        poFeature->SetField(GNM_SYSFIELD_TARGET, asShortcuts[i].nTgtVertexFID);
+        poFeature->SetField(GNM_SYSFIELD_VIA, asShortcuts[i].nViaVertexFID);
+        poFeature->SetField(GNM_SYSFIELD_COST, asShortcuts[i].dfCost);
+        bOK = m_poContractionLayer->CreateFeature(poFeature) == OGRERR_NONE;
+        OGRFeature::DestroyFeature(poFeature);
+    }
+
+    // The signature is written last, so that a partially written hierarchy
+    // is never taken as up to date.
+    if(bOK)
+    {
+        poFeature = OGRFeature::CreateFeature(poDefn);
+        poFeature->SetField(GNM_SYSFIELD_TYPE, GNM_CH_SIGNATURE);
+        poFeature->SetField(GNM_SYSFIELD_SOURCE, m_oGraph.GetSignature());
+        bOK = m_poContractionLayer->CreateFeature(poFeature) == OGRERR_NONE;
+        OGRFeature::DestroyFeature(poFeature);
+    }
+
+    if(bInTransaction)
+    {
+        if(bOK)
+            bOK = m_poContractionLayer->CommitTransaction() == OGRERR_NONE;
+        else
+            CPL_IGNORE_RET_VAL(m_poContractionLayer->RollbackTransaction());
+    }
+
+    if(!bOK)
+    {
+        CPLError( CE_Failure, CPLE_AppDefined, "Write of '%s' layer failed",
+                  GNM_SYSLAYER_CONTRACTION );
+        return CE_Failure;
+    }
+
+    return CE_None;
+}
+
 void GNMGenericNetwork::ConnectPointsByMultiline(GIntBig nFID,
                                     const OGRMultiLineString* poMultiLineString,
                                     const std::vector<OGRLayer*>& paPointLayers,
@@ -1337,6 +1447,135 @@ CPLErr GNMGenericNetwork::LoadGraph()
     }
 
     m_bIsGraphLoaded = true;
+
+    // No error handling: the graph can still be used without the hierarchy
+    if(NULL != m_poContractionLayer)
+        LoadContractionHierarchy();
+
+    return CE_None;
+}
+
+CPLErr GNMGenericNetwork::CreateContractionLayer(GDALDataset * const pDS)
+{
+    m_poContractionLayer = pDS->CreateLayer(GNM_SYSLAYER_CONTRACTION, NULL,
+                                            wkbNone, NULL);
+    if (NULL == m_poContractionLayer)
+    {
+        CPLError( CE_Failure, CPLE_AppDefined, "Creation of '%s' layer failed",
+                  GNM_SYSLAYER_CONTRACTION );
+        return CE_Failure;
+    }
+
+    OGRFieldDefn oFieldType(GNM_SYSFIELD_TYPE, OFTInteger);
+    OGRFieldDefn oFieldSrc(GNM_SYSFIELD_SOURCE, GNMGFIDInt);
+    OGRFieldDefn oFieldDst(GNM_SYSFIELD_TARGET, GNMGFIDInt);
+    OGRFieldDefn oFieldVia(GNM_SYSFIELD_VIA, GNMGFIDInt);
+    OGRFieldDefn oFieldCost(GNM_SYSFIELD_COST, OFTReal);
+    OGRFieldDefn oFieldRank(GNM_SYSFIELD_RANK, OFTInteger);
+
+    if(m_poContractionLayer->CreateField(&oFieldType) != OGRERR_NONE ||
+       m_poContractionLayer->CreateField(&oFieldSrc) != OGRERR_NONE ||
+       m_poContractionLayer->CreateField(&oFieldDst) != OGRERR_NONE ||
+       m_poContractionLayer->CreateField(&oFieldVia) != OGRERR_NONE ||
+       m_poContractionLayer->CreateField(&oFieldCost) != OGRERR_NONE ||
+       m_poContractionLayer->CreateField(&oFieldRank) != OGRERR_NONE)
+    {
+        CPLError( CE_Failure, CPLE_AppDefined, "Creation of layer '%s' fields failed",
+                  GNM_SYSLAYER_CONTRACTION );
+        return CE_Failure;
+    }
+
+    return CE_None;
+}
+
+CPLErr GNMGenericNetwork::LoadContractionLayer(GDALDataset * const pDS)
+{
+    // The layer is optional: it only exists once a contraction hierarchy
+    // has been built.
+    m_poContractionLayer = pDS->GetLayerByName(GNM_SYSLAYER_CONTRACTION);
+    return CE_None;
+}
+
+CPLErr GNMGenericNetwork::LoadContractionHierarchy()
+{
+    GIntBig nSignature = 0;
+    bool bHasSignature = false;
+    std::map<int, GNMGFID> moRanks;
+    std::vector<GNMCHShortcut> asShortcuts;
+
+    OGRFeature *poFeature;
+    m_poContractionLayer->ResetReading();
+    while ((poFeature = m_poContractionLayer->GetNextFeature()) != NULL)
+    {
+        switch(poFeature->GetFieldAsInteger(GNM_SYSFIELD_TYPE))
+        {
+        case GNM_CH_SIGNATURE:
+            nSignature = poFeature->GetFieldAsInteger64(GNM_SYSFIELD_SOURCE);
+            bHasSignature = true;
+            break;
+        case GNM_CH_RANK:
+            moRanks[poFeature->GetFieldAsInteger(GNM_SYSFIELD_RANK)] =
+                    poFeature->GetFieldAsGNMGFID(GNM_SYSFIELD_SOURCE);
+            break;
+        case GNM_CH_SHORTCUT:
+            {
+                GNMCHShortcut sShortcut;
+                sShortcut.nSrcVertexFID =
+                        poFeature->GetFieldAsGNMGFID(GNM_SYSFIELD_SOURCE);
+                sShortcut.nTgtVertexFID =
+                        poFeature->GetFieldAsGNMGFID(GNM_SYSFIELD_TARGET);
+                sShortcut.nViaVertexFID =
+                        poFeature->GetFieldAsGNMGFID(GNM_SYSFIELD_VIA);
+                sShortcut.dfCost = poFeature->GetFieldAsDouble(GNM_SYSFIELD_COST);
+                asShortcuts.push_back(sShortcut);
+            }
+            break;
+        default:
+            break;
+        }
+        OGRFeature::DestroyFeature(poFeature);
+    }
+
+    if(!bHasSignature)
+        return CE_None;
+
+    if(nSignature != m_oGraph.GetSignature())
+    {
+        CPLDebug("GNM", "The graph has changed since the contraction hierarchy "
+                 "was built. Ignore it");
+        return CE_None;
+    }
+
+    GNMVECTOR anVertexFIDs;
+    int nExpectedRank = 0;
+    for(std::map<int, GNMGFID>::iterator it = moRanks.begin();
+        it != moRanks.end(); ++it, ++nExpectedRank)
+    {
+        if(it->first != nExpectedRank)
+            break;
+        anVertexFIDs.push_back(it->second);
+    }
+
+    if(!m_oGraph.SetContractionHierarchy(anVertexFIDs, asShortcuts))
+    {
+        CPLError( CE_Warning, CPLE_AppDefined, "Invalid content of '%s' layer. "
+                  "Contraction hierarchy ignored", GNM_SYSLAYER_CONTRACTION );
+        return CE_Failure;
+    }
+
+    CPLDebug("GNM", "Contraction hierarchy loaded");
+    return CE_None;
+}
+
+CPLErr GNMGenericNetwork::CreateContractionStorage()
+{
+    CPLError( CE_Failure, CPLE_NotSupported, "Storage of contraction "
+              "hierarchy not supported by this network format" );
+    return CE_Failure;
+}
+
+CPLErr GNMGenericNetwork::DeleteContractionLayer()
+{
     return CE_None;
 }
 
@@ -1524,3 +1763,33 @@ CPLErr CPL_STDCALL GNMChangeAllBlockState (GNMGenericNetworkH hNet,
 
     return ((GNMGenericNetwork*)hNet)->ChangeAllBlockState(bIsBlock == TRUE);
 }
+
+CPLErr CPL_STDCALL GNMBuildContractionHierarchy (GNMGenericNetworkH hNet,
+                                                 GDALProgressFunc pfnProgress,
+                                                 void *pProgressArg)
+{
+    VALIDATE_POINTER1( hNet, "GNMBuildContractionHierarchy", CE_Failure );
+
+    return ((GNMGenericNetwork*)hNet)->BuildContractionHierarchy(pfnProgress,
+                                                                 pProgressArg);
+}
+
+CPLErr CPL_STDCALL GNMGetShortestPathCosts (GNMGenericNetworkH hNet,
+                                            GNMGFID nStartFID, int nEndCount,
+                                            const GNMGFID *panEndFIDs,
+                                            double *padfCosts)
+{
+    VALIDATE_POINTER1( hNet, "GNMGetShortestPathCosts", CE_Failure );
+    if( nEndCount <= 0 )
+        return CE_None;
+    VALIDATE_POINTER1( panEndFIDs, "GNMGetShortestPathCosts", CE_Failure );
+    VALIDATE_POINTER1( padfCosts, "GNMGetShortestPathCosts", CE_Failure );
+
+    std::vector<GNMGFID> anEndFIDs(panEndFIDs, panEndFIDs + nEndCount);
+    std::vector<double> adfCosts;
+    CPLErr eErr = ((GNMGenericNetwork*)hNet)->GetShortestPathCosts(nStartFID,
+                                                        anEndFIDs, adfCosts);
+    if( eErr == CE_None )
+        std::copy(adfCosts.begin(), adfCosts.end(), padfCosts);
+    return eErr;
+}
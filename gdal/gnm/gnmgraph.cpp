@@ -34,13 +34,14 @@
 #include <limits>
 #include <set>
 
-GNMGraph::GNMGraph()
+GNMGraph::GNMGraph() :
+    m_poCSRGraph(NULL)
 {
 }
 
 GNMGraph::~GNMGraph()
 {
-
+    delete m_poCSRGraph;
 }
 
 void GNMGraph::AddVertex(GNMGFID nFID)
@@ -48,6 +49,7 @@ void GNMGraph::AddVertex(GNMGFID nFID)
     if(m_mstVertices.find(nFID) != m_mstVertices.end())
         return;
 
+    InvalidateCSRGraph();
     GNMStdVertex stVertex;
     stVertex.bIsBloked = false;
     m_mstVertices[nFID] = stVertex;
@@ -55,6 +57,7 @@ void GNMGraph::AddVertex(GNMGFID nFID)
 
 void GNMGraph::DeleteVertex(GNMGFID nFID)
 {
+    InvalidateCSRGraph();
     m_mstVertices.erase(nFID);
 
     // remove all edges with this vertex
@@ -81,6 +84,7 @@ void GNMGraph::AddEdge(GNMGFID nConFID, GNMGFID nSrcFID, GNMGFID nTgtFID,
         return;
     }
 
+    InvalidateCSRGraph();
     AddVertex(nSrcFID);
     AddVertex(nTgtFID);
 
@@ -111,6 +115,7 @@ void GNMGraph::AddEdge(GNMGFID nConFID, GNMGFID nSrcFID, GNMGFID nTgtFID,
 
 void GNMGraph::DeleteEdge(GNMGFID nConFID)
 {
+    InvalidateCSRGraph();
     m_mstEdges.erase(nConFID);
 
     // remove edge from all vertices anOutEdgeFIDs
@@ -129,6 +134,7 @@ void GNMGraph::ChangeEdge(GNMGFID nFID, double dfCost, double dfInvCost)
     std::map<GNMGFID, GNMStdEdge>::iterator it = m_mstEdges.find(nFID);
     if (it != m_mstEdges.end())
     {
+        InvalidateCSRGraph();
         it->second.dfDirCost = dfCost;
         it->second.dfInvCost = dfInvCost;
     }
@@ -140,6 +146,7 @@ void GNMGraph::ChangeBlockState(GNMGFID nFID, bool bBlock)
     std::map<GNMGFID, GNMStdVertex>::iterator itv = m_mstVertices.find(nFID);
     if(itv != m_mstVertices.end())
     {
+        InvalidateCSRGraph();
         itv->second.bIsBloked = bBlock;
         return;
     }
@@ -148,6 +155,7 @@ void GNMGraph::ChangeBlockState(GNMGFID nFID, bool bBlock)
     std::map<GNMGFID, GNMStdEdge>::iterator ite = m_mstEdges.find(nFID);
     if (ite != m_mstEdges.end())
     {
+        InvalidateCSRGraph();
         ite->second.bIsBloked = bBlock;
     }
 }
@@ -162,6 +170,7 @@ bool GNMGraph::CheckVertexBlocked(GNMGFID nFID) const
 
 void GNMGraph::ChangeAllBlockState(bool bBlock)
 {
+    InvalidateCSRGraph();
     for(std::map<GNMGFID, GNMStdVertex>::iterator itv = m_mstVertices.begin();
         itv != m_mstVertices.end(); ++itv)
     {
@@ -234,7 +243,80 @@ GNMPATH GNMGraph::DijkstraShortestPath( GNMGFID nStartFID, GNMGFID nEndFID,
 
 GNMPATH GNMGraph::DijkstraShortestPath( GNMGFID nStartFID, GNMGFID nEndFID)
 {
-    return DijkstraShortestPath(nStartFID, nEndFID, m_mstEdges);
+    return GetCSRGraph()->ShortestPath(nStartFID, nEndFID);
+}
+
+std::vector<double> GNMGraph::GetShortestPathCosts(GNMGFID nStartFID,
+                                                   const GNMVECTOR &anEndFIDs)
+{
+    return GetCSRGraph()->ShortestPathCosts(nStartFID, anEndFIDs);
+}
+
+CPLErr GNMGraph::BuildContractionHierarchy(GDALProgressFunc pfnProgress,
+                                           void *pProgressArg)
+{
+    if(!GetCSRGraph()->BuildContractionHierarchy(pfnProgress, pProgressArg))
+        return CE_Failure;
+    return CE_None;
+}
+
+bool GNMGraph::HasContractionHierarchy() const
+{
+    return m_poCSRGraph != NULL && m_poCSRGraph->HasContractionHierarchy();
+}
+
+bool GNMGraph::GetContractionHierarchy(GNMVECTOR &anVertexFIDs,
+                                std::vector<GNMCHShortcut> &asShortcuts) const
+{
+    if(!HasContractionHierarchy())
+        return false;
+    m_poCSRGraph->GetContractionHierarchy(anVertexFIDs, asShortcuts);
+    return true;
+}
+
+bool GNMGraph::SetContractionHierarchy(const GNMVECTOR &anVertexFIDs,
+                                const std::vector<GNMCHShortcut> &asShortcuts)
+{
+    return GetCSRGraph()->SetContractionHierarchy(anVertexFIDs, asShortcuts);
+}
+
+static void GNMHashAdd(GUIntBig &nHash, const void *pData, size_t nSize)
+{
+    const GByte *pabyData = static_cast<const GByte *>(pData);
+    for(size_t i = 0; i < nSize; ++i)
+    {
+        nHash ^= pabyData[i];
+        nHash *= static_cast<GUIntBig>(1099511628211ULL);
+    }
+}
+
+GIntBig GNMGraph::GetSignature() const
+{
+    // FNV-1a hash of the graph content, in identificators order.
+    GUIntBig nHash = static_cast<GUIntBig>(14695981039346656037ULL);
+    for(std::map<GNMGFID, GNMStdVertex>::const_iterator itv =
+        m_mstVertices.begin(); itv != m_mstVertices.end(); ++itv)
+    {
+        const GByte byBlocked = itv->second.bIsBloked ? 1 : 0;
+        GNMHashAdd(nHash, &itv->first, sizeof(GNMGFID));
+        GNMHashAdd(nHash, &byBlocked, 1);
+    }
+    for(std::map<GNMGFID, GNMStdEdge>::const_iterator ite = m_mstEdges.begin();
+        ite != m_mstEdges.end(); ++ite)
+    {
+        const GByte abyFlags[2] = { static_cast<GByte>(ite->second.bIsBidir),
+                                    static_cast<GByte>(ite->second.bIsBloked) };
+        GNMHashAdd(nHash, &ite->first, sizeof(GNMGFID));
+        GNMHashAdd(nHash, &ite->second.nSrcVertexFID, sizeof(GNMGFID));
+        GNMHashAdd(nHash, &ite->second.nTgtVertexFID, sizeof(GNMGFID));
+        GNMHashAdd(nHash, &ite->second.dfDirCost, sizeof(double));
+        GNMHashAdd(nHash, abyFlags, 2);
+    }
+
+    // Keep 48 bits, so that the value is exactly stored by any storage
+    // (floating point or decimal fields of limited width).
+    return static_cast<GIntBig>((nHash ^ (nHash >> 48)) &
+                                ((static_cast<GUIntBig>(1) << 48) - 1));
 }
 
 std::vector<GNMPATH> GNMGraph::KShortestPaths(GNMGFID nStartFID, GNMGFID nEndFID,
@@ -442,6 +524,7 @@ GNMPATH GNMGraph::ConnectedComponents(const GNMVECTOR &anEmittersIDs)
 
 void GNMGraph::Clear()
 {
+    InvalidateCSRGraph();
     m_mstVertices.clear();
     m_mstEdges.clear();
 }
@@ -620,3 +703,16 @@ void GNMGraph::TraceTargets(std::queue<GNMGFID> &vertexQueue,
     if (!neighbours_queue.empty())
         TraceTargets(neighbours_queue, markedVertIds, connectedIds);
 }
+
+GNMCSRGraph *GNMGraph::GetCSRGraph()
+{
+    if(m_poCSRGraph == NULL)
+        m_poCSRGraph = new GNMCSRGraph(m_mstVertices, m_mstEdges);
+    return m_poCSRGraph;
+}
+
+void GNMGraph::InvalidateCSRGraph()
+{
+    delete m_poCSRGraph;
+    m_poCSRGraph = NULL;
+}
@@ -58,6 +58,20 @@ struct GNMStdVertex
     bool bIsBloked;
 };
 
+/**
+ * A shortcut of a contraction hierarchy: the best path from the source to
+ * the target vertex goes through the via vertex.
+ */
+struct GNMCHShortcut
+{
+    GNMGFID nSrcVertexFID;
+    GNMGFID nTgtVertexFID;
+    GNMGFID nViaVertexFID;
+    double dfCost;
+};
+
+class GNMCSRGraph;
+
 /**
  * The simple graph class, which holds the appropriate for
  * calculations graph in memory (based on STL containers) and provides
@@ -195,6 +209,70 @@ public:
      */
     virtual GNMPATH ConnectedComponents(const GNMVECTOR &anEmittersIDs);
 
+    /**
+     * @brief Calculate the costs of the best paths from one vertex to several
+     * vertices.
+     *
+     * This is the building block of origin-destination matrices: the search
+     * from nStartFID is done once for all the end vertices. Method takes in
+     * account the blocking state of features.
+     *
+     * @param nStartFID Vertex identificator from which to start.
+     * @param anEndFIDs Vertex identificators to which the costs are
+     * calculated.
+     * @return an array of costs, in the order of anEndFIDs. The cost is
+     * infinity if there is no path to the vertex.
+     * @since GDAL 2.2
+     */
+    virtual std::vector<double> GetShortestPathCosts(GNMGFID nStartFID,
+                                                const GNMVECTOR &anEndFIDs);
+
+    /**
+     * @brief Preprocess the graph for fast shortest path queries.
+     *
+     * Builds a contraction hierarchy of the graph in its current state
+     * (costs and blocking included). While the graph is not modified, the
+     * shortest path and path costs queries use it. Any modification of the
+     * graph discards it.
+     *
+     * @return CE_None on success.
+     * @since GDAL 2.2
+     */
+    virtual CPLErr BuildContractionHierarchy(GDALProgressFunc pfnProgress = NULL,
+                                             void *pProgressArg = NULL);
+
+    /**
+     * @brief Check if a contraction hierarchy is available.
+     * @since GDAL 2.2
+     */
+    virtual bool HasContractionHierarchy() const;
+
+    /**
+     * @brief Get the contraction hierarchy in a form suitable for storage.
+     * @param anVertexFIDs Vertex identificators, ordered by rank.
+     * @param asShortcuts Shortcuts.
+     * @return false if there is no contraction hierarchy.
+     * @since GDAL 2.2
+     */
+    virtual bool GetContractionHierarchy(GNMVECTOR &anVertexFIDs,
+                                 std::vector<GNMCHShortcut> &asShortcuts) const;
+
+    /**
+     * @brief Set a contraction hierarchy previously got with
+     * GetContractionHierarchy() on the same graph.
+     * @return false if it does not match the graph.
+     * @since GDAL 2.2
+     */
+    virtual bool SetContractionHierarchy(const GNMVECTOR &anVertexFIDs,
+                           const std::vector<GNMCHShortcut> &asShortcuts);
+
+    /**
+     * @brief Compute a checksum of the graph (connections, costs and blocking
+     * states), used to check that a stored contraction hierarchy is up to date.
+     * @since GDAL 2.2
+     */
+    virtual GIntBig GetSignature() const;
+
     virtual void Clear();
 protected:
     /**
@@ -223,7 +301,119 @@ protected:
     virtual void TraceTargets(std::queue<GNMGFID> &vertexQueue,
                                 std::set<GNMGFID> &markedVertIds,
                                 GNMPATH &connectedIds);
+    /**
+     * @brief Get the frozen representation of the graph, built on first
+     * use after a modification.
+     */
+    GNMCSRGraph *GetCSRGraph();
+    void InvalidateCSRGraph();
 protected:
     std::map<GNMGFID, GNMStdVertex> m_mstVertices;
     std::map<GNMGFID, GNMStdEdge>   m_mstEdges;
+    GNMCSRGraph *m_poCSRGraph;
+private:
+    GNMGraph(const GNMGraph&);
+    GNMGraph& operator=(const GNMGraph&);
+};
+
+/**
+ * Frozen representation of a GNMGraph for routing: vertices are numbered
+ * from 0 and the outgoing arcs of each vertex are stored contiguously
+ * (compressed sparse row). Blocked edges, and arcs leading to blocked
+ * vertices, are left out. A bidirectional edge gives two arcs, both with the
+ * direct cost, as in GNMGraph::DijkstraShortestPath().
+ *
+ * The structure can be completed with a contraction hierarchy: vertices are
+ * ranked, and shortcuts are added so that a best path always goes up then
+ * down the ranks. Queries are then bidirectional searches which only visit
+ * a small part of the graph.
+ *
+ * The query methods reuse work arrays, so an object must not be used by
+ * several threads at once.
+ *
+ * @since GDAL 2.2
+ */
+
+class GNMCSRGraph
+{
+public:
+    GNMCSRGraph(const std::map<GNMGFID, GNMStdVertex> &mstVertices,
+                const std::map<GNMGFID, GNMStdEdge> &mstEdges);
+
+    int GetVertexIndex(GNMGFID nFID) const;
+    GNMPATH ShortestPath(GNMGFID nStartFID, GNMGFID nEndFID);
+    std::vector<double> ShortestPathCosts(GNMGFID nStartFID,
+                                          const GNMVECTOR &anEndFIDs);
+
+    bool BuildContractionHierarchy(GDALProgressFunc pfnProgress,
+                                   void *pProgressArg);
+    bool HasContractionHierarchy() const { return !m_anRank.empty(); }
+    void GetContractionHierarchy(GNMVECTOR &anVertexFIDs,
+                                 std::vector<GNMCHShortcut> &asShortcuts) const;
+    bool SetContractionHierarchy(const GNMVECTOR &anVertexFIDs,
+                                 const std::vector<GNMCHShortcut> &asShortcuts);
+
+protected:
+    // Arc of the contraction hierarchy: an arc of the graph (nVia == -1)
+    // or a shortcut through the vertex nVia.
+    struct CHArc
+    {
+        int nVertex;
+        int nVia;
+        GNMGFID nEdgeFID;
+        double dfCost;
+    };
+
+    // Work arrays of a search. A vertex is reached (resp. settled) in the
+    // current search if its stamp is the current stamp, so that they do not
+    // need to be reinitialized for each query.
+    struct SearchState
+    {
+        std::vector<unsigned> anReachedStamp;
+        std::vector<unsigned> anSettledStamp;
+        std::vector<double>   adfCost;
+        std::vector<int>      anPredVertex;
+        std::vector<int>      anPredArc;
+        std::vector< std::pair<double, int> > aoHeap;
+        unsigned              nStamp;
+    };
+
+    void InitSearch(SearchState &oState);
+    void ResetSearch(SearchState &oState);
+    bool IsReached(const SearchState &oState, int iVertex) const
+        { return oState.anReachedStamp[iVertex] == oState.nStamp; }
+    bool IsSettled(const SearchState &oState, int iVertex) const
+        { return oState.anSettledStamp[iVertex] == oState.nStamp; }
+    void Reach(SearchState &oState, int iVertex, double dfCost,
+               int iPredVertex, int iPredArc);
+    int PopMin(SearchState &oState);
+
+    void DijkstraSearch(int iStart, const std::vector<int> &aiTargets);
+    double CHSearch(int iStart, int iEnd, bool bForwardDone, int *piMeeting);
+    void CHForwardSearch(int iStart);
+    void FinalizeContractionHierarchy(const std::vector<int> &anRank,
+                                 const std::vector<GNMCHShortcut> &asShortcuts);
+    const CHArc *FindCHArc(int iFrom, int iTo) const;
+    void UnpackCHArc(int iFrom, int iTo, const CHArc &oArc,
+                     GNMPATH &aoPath) const;
+
+    // Vertices (sorted identificators) and arcs of the graph
+    GNMVECTOR             m_anVertexFIDs;
+    std::vector<int>      m_anOutOffsets;
+    std::vector<int>      m_anArcTargets;
+    std::vector<double>   m_adfArcCosts;
+    GNMVECTOR             m_anArcEdgeFIDs;
+
+    // Contraction hierarchy: arcs leading to higher ranked vertices, stored
+    // at their source, and arcs leading to lower ranked vertices, stored at
+    // their target (nVertex being the source) for the backward search.
+    std::vector<int>      m_anRank;
+    std::vector<int>      m_anUpOffsets;
+    std::vector<CHArc>    m_asUpArcs;
+    std::vector<int>      m_anDownOffsets;
+    std::vector<CHArc>    m_asDownArcs;
+    std::vector<GNMCHShortcut> m_asShortcuts;
+
+    SearchState m_oForward;
+    SearchState m_oBackward;
 };
@@ -32,6 +32,11 @@
 #define OGR_CSV_H_INCLUDED
 
 #include "ogrsf_frmts.h"
+#include "cpl_multiproc.h"
+#include "cpl_worker_thread_pool.h"
+
+#include <list>
+#include <vector>
 
 typedef enum
 {
@@ -59,6 +64,54 @@ typedef enum
 
 void OGRCSVDriverRemoveFromMap(const char* pszName, GDALDataset* poDS);
 
+/************************************************************************/
+/*                             OGRCSVReader                             */
+/*                                                                      */
+/*      Buffered record reader. Records are tokenized in place in a     */
+/*      large read buffer, so no allocation is done per record or per   */
+/*      token in the steady state.                                      */
+/************************************************************************/
+
+class OGRCSVReader
+{
+    VSILFILE           *fp;
+    char                chDelimiter;
+    bool                bHonourStrings;
+    bool                bMergeDelimiter;
+
+    std::vector<char>   abyBuffer;
+    size_t              nBufferStart;
+    size_t              nBufferEnd;
+    bool                bEOF;
+
+    std::vector<char*>  apszTokens;
+    char                szEmpty[1];
+
+    void                FillBuffer();
+    void                SplitRecord( char* pszRecord );
+
+  public:
+    static const size_t NPOS = ~static_cast<size_t>(0);
+
+                        OGRCSVReader();
+
+    void                SetOptions( char chDelimiter, bool bHonourStrings,
+                                    bool bMergeDelimiter );
+    void                Reset( VSILFILE* fp );
+    void                SetBuffer( std::vector<char>& abyData );
+    void                TakeBufferedData( std::vector<char>& abyData,
+                                          bool* pbEOF );
+    vsi_l_offset        Tell();
+
+    char              **ReadRecord( int* pnTokenCount = NULL );
+
+    static size_t       FindRecordEnd( const char* pachData,
+                                       size_t nStart, size_t nEnd, bool bEOF,
+                                       bool bHonourStrings, bool* pbEmpty );
+};
+
+class OGRCSVFeatureBatch;
+
 /************************************************************************/
 /*                             OGRCSVLayer                              */
 /************************************************************************/
@@ -118,7 +171,32 @@ class OGRCSVLayer : public OGRLayer
 
     int                 bEmptyStringNull;
 
-    char              **GetNextLineTokens();
+    OGRCSVReader       *poReader;
+    char              **GetNextLineTokens( int* pnTokenCount = NULL );
+    void                SyncFileWithReader();
+
+    OGRFeature         *BuildFeature( char** papszTokens, int nTokenCount,
+                                      int nFID, int* pbWarningEmitted,
+                                      CPLString* posDeferredWarning );
+
+    /* Parallel parsing of the records, when NUM_THREADS > 1 */
+    int                 nNumThreads;
+    CPLWorkerThreadPool *poThreadPool;
+    CPLMutex           *hBatchMutex;
+    CPLCond            *hBatchCond;
+    std::list<OGRCSVFeatureBatch*> oBatchList;
+    std::vector<char>   abyPendingData;
+    size_t              nPendingScanned;
+    int                 nPendingRecords;
+    bool                bPendingEOF;
+    int                 nNextBatchFID;
+    bool                bParallelReading;
+
+    void                StartParallelReading();
+    void                StopParallelReading();
+    bool                SubmitNextBatch();
+    OGRFeature         *GetNextParallelFeature();
+    static void         ParseBatchJob( void* pData );
 
     static int          Matches(const char* pszFieldName, char** papszPossibleNames);
 
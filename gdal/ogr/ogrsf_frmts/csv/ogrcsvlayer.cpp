@@ -36,6 +36,39 @@
 
 CPL_CVSID("$Id$");
 
+/* Size of the blocks of records parsed by a worker thread */
+static const size_t CSV_BATCH_SIZE = 1024 * 1024;
+
+/************************************************************************/
+/*                          OGRCSVFeatureBatch                          */
+/*                                                                      */
+/*      Block of complete records, turned into features by a worker     */
+/*      thread when NUM_THREADS > 1.                                    */
+/************************************************************************/
+
+class OGRCSVFeatureBatch
+{
+  public:
+    OGRCSVLayer                *poLayer;
+    std::vector<char>           abyData;
+    int                         nFirstFID;
+    std::vector<OGRFeature*>    apoFeatures;
+    size_t                      iNextFeature;
+    int                         bWarningEmitted;
+    CPLString                   osWarning;
+    bool                        bDone;
+
+    OGRCSVFeatureBatch( OGRCSVLayer* poLayerIn, int nFirstFIDIn ) :
+        poLayer(poLayerIn), nFirstFID(nFirstFIDIn), iNextFeature(0),
+        bWarningEmitted(FALSE), bDone(false) {}
+
+    ~OGRCSVFeatureBatch()
+    {
+        for( size_t i = iNextFeature; i < apoFeatures.size(); i++ )
+            delete apoFeatures[i];
+    }
+};
+
 
 /************************************************************************/
 /*                            CSVSplitLine()                            */
@@ -250,7 +283,17 @@ OGRCSVLayer::OGRCSVLayer( const char *pszLayerNameIn,
     bKeepSourceColumns(FALSE),
     bKeepGeomColumns(TRUE),
     bMergeDelimiter(FALSE),
-    bEmptyStringNull(FALSE)
+    bEmptyStringNull(FALSE),
+    poReader(new OGRCSVReader()),
+    nNumThreads(1),
+    poThreadPool(NULL),
+    hBatchMutex(NULL),
+    hBatchCond(NULL),
+    nPendingScanned(0),
+    nPendingRecords(0),
+    bPendingEOF(false),
+    nNextBatchFID(1),
+    bParallelReading(false)
 {
     poFeatureDefn = new OGRFeatureDefn( pszLayerNameIn );
     SetDescription( poFeatureDefn->GetName() );
@@ -325,6 +368,20 @@ void OGRCSVLayer::BuildFeatureDefn( const char* pszNfdcGeomField,
     bEmptyStringNull
         = CSLFetchBoolean(papszOpenOptions, "EMPTY_STRING_AS_NULL", FALSE);
 
+    const char* pszNumThreads
+        = CSLFetchNameValue(papszOpenOptions, "NUM_THREADS");
+    if( pszNumThreads != NULL )
+    {
+        if( EQUAL(pszNumThreads, "ALL_CPUS") )
+            nNumThreads = CPLGetNumCPUs();
+        else
+            nNumThreads = atoi(pszNumThreads);
+        if( nNumThreads < 1 )
+            nNumThreads = 1;
+        if( nNumThreads > 128 )
+            nNumThreads = 128;
+    }
+
 /* -------------------------------------------------------------------- */
 /*      If this is not a new file, read ahead to establish if it is     */
 /*      already in CRLF (DOS) mode, or just a normal unix CR mode.      */
@@ -950,6 +1007,8 @@ char** OGRCSVLayer::AutodetectFieldTypes(char** papszOpenOptions, int nFieldCoun
 {
     char** papszFieldTypes = NULL;
 
+    SyncFileWithReader();
+
     // Use 1000000 as default maximum distance to be compatible with /vsistdin/
     // caching.
     int nBytes = atoi(CSLFetchNameValueDef(papszOpenOptions,
@@ -1261,6 +1320,14 @@ OGRCSVLayer::~OGRCSVLayer()
                   poFeatureDefn->GetName() );
     }
 
+    StopParallelReading();
+    delete poThreadPool;
+    if( hBatchCond )
+        CPLDestroyCond( hBatchCond );
+    if( hBatchMutex )
+        CPLDestroyMutex( hBatchMutex );
+    delete poReader;
+
     // Make sure the header file is written even if no features are written.
     if ( bNew && bInWriteMode )
         WriteHeader();
@@ -1281,40 +1348,63 @@ OGRCSVLayer::~OGRCSVLayer()
 void OGRCSVLayer::ResetReading()
 
 {
+    StopParallelReading();
+
     if (fpCSV)
         VSIRewindL( fpCSV );
 
+    // Special fix to read NdfcFacilities.xls with un-balanced double quotes.
+    poReader->SetOptions( chDelimiter,
+                          !(chDelimiter == '\t' && bDontHonourStrings),
+                          CPL_TO_BOOL(bMergeDelimiter) );
+    poReader->Reset( fpCSV );
+
     if( bHasFieldNames )
-        CSLDestroy( OGRCSVReadParseLineL( fpCSV, chDelimiter, bDontHonourStrings ) );
+        poReader->ReadRecord();
 
     bNeedRewindBeforeRead = FALSE;
 
     nNextFID = 1;
 }
 
+/************************************************************************/
+/*                        SyncFileWithReader()                          */
+/*                                                                      */
+/*      Seek the file to the first record not consumed yet, so that     */
+/*      it can be read directly, bypassing the record reader.           */
+/************************************************************************/
+
+void OGRCSVLayer::SyncFileWithReader()
+{
+    if( fpCSV == NULL )
+        return;
+    CPL_IGNORE_RET_VAL(VSIFSeekL( fpCSV, poReader->Tell(), SEEK_SET ));
+    poReader->Reset( fpCSV );
+}
+
 /************************************************************************/
 /*                        GetNextLineTokens()                           */
+/*                                                                      */
+/*      Return the tokens of the next non empty record. They belong     */
+/*      to the record reader and are valid until the next call.         */
 /************************************************************************/
 
-char** OGRCSVLayer::GetNextLineTokens()
+char** OGRCSVLayer::GetNextLineTokens( int* pnTokenCount )
 {
-/* -------------------------------------------------------------------- */
-/*      Read the CSV record.                                            */
-/* -------------------------------------------------------------------- */
+    int nTokenCount = 0;
     char **papszTokens;
 
     while( true )
     {
-        papszTokens = OGRCSVReadParseLineL( fpCSV, chDelimiter, bDontHonourStrings,
-                                            FALSE, bMergeDelimiter );
+        papszTokens = poReader->ReadRecord( &nTokenCount );
         if( papszTokens == NULL )
             return NULL;
 
         if( papszTokens[0] != NULL )
             break;
-
-        CSLDestroy(papszTokens);
     }
+    if( pnTokenCount )
+        *pnTokenCount = nTokenCount;
     return papszTokens;
 }
 
@@ -1326,14 +1416,12 @@ OGRFeature* OGRCSVLayer::GetFeature(GIntBig nFID)
 {
     if( nFID < 1 || fpCSV == NULL )
         return NULL;
-    if( nFID < nNextFID || bNeedRewindBeforeRead )
+    if( nFID < nNextFID || bNeedRewindBeforeRead || bParallelReading )
         ResetReading();
     while( nNextFID < nFID )
     {
-        char **papszTokens = GetNextLineTokens();
-        if( papszTokens == NULL )
+        if( GetNextLineTokens() == NULL )
             return NULL;
-        CSLDestroy(papszTokens);
         nNextFID ++;
     }
     return GetNextUnfilteredFeature();
@@ -1352,10 +1440,123 @@ OGRFeature * OGRCSVLayer::GetNextUnfilteredFeature()
 /* -------------------------------------------------------------------- */
 /*      Read the CSV record.                                            */
 /* -------------------------------------------------------------------- */
-    char **papszTokens = GetNextLineTokens();
+    int nTokenCount = 0;
+    char **papszTokens = GetNextLineTokens( &nTokenCount );
     if( papszTokens == NULL )
         return NULL;
 
+    OGRFeature *poFeature = BuildFeature( papszTokens, nTokenCount, nNextFID,
+                                          &bWarningBadTypeOrWidth, NULL );
+    nNextFID ++;
+
+    m_nFeaturesRead++;
+
+    return poFeature;
+}
+
+/************************************************************************/
+/*                        OGRCSVParseNumber()                           */
+/*                                                                      */
+/*      Fast path for the plain decimal notations found in most         */
+/*      files.  Returns CPL_VALUE_INTEGER or CPL_VALUE_REAL when the    */
+/*      value could be computed exactly (at most 18 digits, and a       */
+/*      mantissa below 2^53 for reals, so that a single division by     */
+/*      an exact power of ten gives the correctly rounded result), or   */
+/*      CPL_VALUE_STRING if the generic parsers must be used.           */
+/************************************************************************/
+
+static CPLValueType OGRCSVParseNumber( const char* pszValue,
+                                       GIntBig* pnValue, double* pdfValue )
+{
+    static const double adfPowersOf10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+        1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18 };
+
+    const char* pszIter = pszValue;
+    bool bNegative = false;
+    if( *pszIter == '+' || *pszIter == '-' )
+    {
+        bNegative = (*pszIter == '-');
+        pszIter ++;
+    }
+
+    GUIntBig nMantissa = 0;
+    int nDigits = 0;
+    int nFractionDigits = 0;
+    bool bHasDot = false;
+    for( ; ; pszIter++ )
+    {
+        if( *pszIter >= '0' && *pszIter <= '9' )
+        {
+            if( nDigits == 18 )
+                return CPL_VALUE_STRING;
+            nMantissa = nMantissa * 10 + (*pszIter - '0');
+            nDigits ++;
+            if( bHasDot )
+                nFractionDigits ++;
+        }
+        else if( *pszIter == '.' && !bHasDot )
+            bHasDot = true;
+        else
+            break;
+    }
+    if( *pszIter != '\0' || nDigits == 0 )
+        return CPL_VALUE_STRING;
+
+    if( !bHasDot )
+    {
+        *pnValue = bNegative ? -static_cast<GIntBig>(nMantissa) :
+                                static_cast<GIntBig>(nMantissa);
+        return CPL_VALUE_INTEGER;
+    }
+
+    if( nMantissa > (static_cast<GUIntBig>(1) << 53) )
+        return CPL_VALUE_STRING;
+    const double dfValue =
+        static_cast<double>(nMantissa) / adfPowersOf10[nFractionDigits];
+    *pdfValue = bNegative ? -dfValue : dfValue;
+    return CPL_VALUE_REAL;
+}
+
+/************************************************************************/
+/*                      OGRCSVWarnBadTypeOrWidth()                      */
+/*                                                                      */
+/*      Emit the warning, or keep it in *posDeferredWarning when        */
+/*      called from a worker thread.                                    */
+/************************************************************************/
+
+static void OGRCSVWarnBadTypeOrWidth( int* pbWarningEmitted,
+                                      CPLString* posDeferredWarning,
+                                      const char* pszFormat, ... )
+    CPL_PRINT_FUNC_FORMAT (3, 4);
+
+static void OGRCSVWarnBadTypeOrWidth( int* pbWarningEmitted,
+                                      CPLString* posDeferredWarning,
+                                      const char* pszFormat, ... )
+{
+    *pbWarningEmitted = TRUE;
+
+    va_list args;
+    va_start(args, pszFormat);
+    if( posDeferredWarning != NULL )
+        posDeferredWarning->vPrintf(pszFormat, args);
+    else
+        CPLErrorV(CE_Warning, CPLE_AppDefined, pszFormat, args);
+    va_end(args);
+}
+
+/************************************************************************/
+/*                            BuildFeature()                            */
+/*                                                                      */
+/*      Turn the tokens of a record into a feature.  This may be        */
+/*      called from worker threads, so it must not modify the layer.    */
+/************************************************************************/
+
+OGRFeature *OGRCSVLayer::BuildFeature( char** papszTokens, int nTokenCount,
+                                       int nFID, int* pbWarningEmitted,
+                                       CPLString* posDeferredWarning )
+
+{
 /* -------------------------------------------------------------------- */
 /*      Create the OGR feature.                                         */
 /* -------------------------------------------------------------------- */
@@ -1368,7 +1569,7 @@ OGRFeature * OGRCSVLayer::GetNextUnfilteredFeature()
 /* -------------------------------------------------------------------- */
     int         iAttr;
     int         iOGRField = 0;
-    int         nAttrCount = MIN(CSLCount(papszTokens), nCSVFieldCount + (bHiddenWKTColumn ? 1 : 0) );
+    int         nAttrCount = MIN(nTokenCount, nCSVFieldCount + (bHiddenWKTColumn ? 1 : 0) );
     CPLValueType eType;
 
     for( iAttr = 0; !bIsEurostatTSV && iAttr < nAttrCount; iAttr++)
@@ -1442,13 +1643,12 @@ OGRFeature * OGRCSVLayer::GetNextUnfilteredFeature()
                 {
                     poFeature->SetField( iOGRField, 0 );
                 }
-                else if( !bWarningBadTypeOrWidth )
+                else if( !*pbWarningEmitted )
                 {
-                    bWarningBadTypeOrWidth = TRUE;
-                    CPLError(CE_Warning, CPLE_AppDefined,
+                    OGRCSVWarnBadTypeOrWidth(pbWarningEmitted, posDeferredWarning,
                                 "Invalid value type found in record %d for field %s. "
                                 "This warning will no longer be emitted",
-                                nNextFID, poFieldDefn->GetNameRef());
+                                nFID, poFieldDefn->GetNameRef());
                 }
             }
         }
@@ -1463,29 +1663,57 @@ OGRFeature * OGRCSVLayer::GetNextUnfilteredFeature()
                     if (chComma)
                         *chComma = '.';
                 }
-                eType = CPLGetValueType(papszTokens[iAttr]);
+                // Set directly the binary value in the common cases,
+                // which saves parsing the string a second time.
+                GIntBig nValue = 0;
+                double dfValue = 0.0;
+                eType = OGRCSVParseNumber(papszTokens[iAttr],
+                                          &nValue, &dfValue);
+                if( eType == CPL_VALUE_INTEGER && eFieldType == OFTInteger &&
+                    nValue >= INT_MIN && nValue <= INT_MAX )
+                {
+                    poFeature->SetField( iOGRField, static_cast<int>(nValue) );
+                }
+                else if( eType == CPL_VALUE_INTEGER &&
+                         eFieldType == OFTInteger64 )
+                {
+                    poFeature->SetField( iOGRField, nValue );
+                }
+                else if( eType == CPL_VALUE_INTEGER && eFieldType == OFTReal )
+                {
+                    poFeature->SetField( iOGRField,
+                                         static_cast<double>(nValue) );
+                }
+                else if( eType == CPL_VALUE_REAL && eFieldType == OFTReal )
+                {
+                    poFeature->SetField( iOGRField, dfValue );
+                }
+                else
+                {
+                    eType = CPLGetValueType(papszTokens[iAttr]);
+                    if ( eType == CPL_VALUE_INTEGER || eType == CPL_VALUE_REAL )
+                        poFeature->SetField( iOGRField, papszTokens[iAttr] );
+                }
+
                 if ( eType == CPL_VALUE_INTEGER || eType == CPL_VALUE_REAL )
                 {
-                    poFeature->SetField( iOGRField, papszTokens[iAttr] );
-                    if( !bWarningBadTypeOrWidth &&
+                    if( !*pbWarningEmitted &&
                         (eFieldType == OFTInteger || eFieldType == OFTInteger64) && eType == CPL_VALUE_REAL )
                     {
-                        bWarningBadTypeOrWidth = TRUE;
-                        CPLError(CE_Warning, CPLE_AppDefined,
+                        OGRCSVWarnBadTypeOrWidth(pbWarningEmitted, posDeferredWarning,
                                  "Invalid value type found in record %d for field %s. "
                                  "This warning will no longer be emitted",
-                                 nNextFID, poFieldDefn->GetNameRef());
+                                 nFID, poFieldDefn->GetNameRef());
                     }
-                    else if( !bWarningBadTypeOrWidth && poFieldDefn->GetWidth() > 0 &&
+                    else if( !*pbWarningEmitted && poFieldDefn->GetWidth() > 0 &&
                              (int)strlen(papszTokens[iAttr]) > poFieldDefn->GetWidth() )
                     {
-                        bWarningBadTypeOrWidth = TRUE;
-                        CPLError(CE_Warning, CPLE_AppDefined,
+                        OGRCSVWarnBadTypeOrWidth(pbWarningEmitted, posDeferredWarning,
                                  "Value with a width greater than field width found in record %d for field %s. "
                                  "This warning will no longer be emitted",
-                                 nNextFID, poFieldDefn->GetNameRef());
+                                 nFID, poFieldDefn->GetNameRef());
                     }
-                    else if( !bWarningBadTypeOrWidth && eType == CPL_VALUE_REAL &&
+                    else if( !*pbWarningEmitted && eType == CPL_VALUE_REAL &&
                              poFieldDefn->GetWidth() > 0)
                     {
                         const char* pszDot = strchr(papszTokens[iAttr], '.');
@@ -1494,23 +1722,21 @@ OGRFeature * OGRCSVLayer::GetNextUnfilteredFeature()
                             nPrecision = static_cast<int>(strlen(pszDot + 1));
                         if( nPrecision > poFieldDefn->GetPrecision() )
                         {
-                             bWarningBadTypeOrWidth = TRUE;
-                            CPLError(CE_Warning, CPLE_AppDefined,
+                            OGRCSVWarnBadTypeOrWidth(pbWarningEmitted, posDeferredWarning,
                                      "Value with a precision greater than field precision found in record %d for field %s. "
                                      "This warning will no longer be emitted",
-                                     nNextFID, poFieldDefn->GetNameRef());
+                                     nFID, poFieldDefn->GetNameRef());
                         }
                     }
                 }
                 else
                 {
-                    if( !bWarningBadTypeOrWidth )
+                    if( !*pbWarningEmitted )
                     {
-                        bWarningBadTypeOrWidth = TRUE;
-                        CPLError(CE_Warning, CPLE_AppDefined,
+                        OGRCSVWarnBadTypeOrWidth(pbWarningEmitted, posDeferredWarning,
                                     "Invalid value type found in record %d for field %s. "
                                     "This warning will no longer be emitted",
-                                    nNextFID, poFieldDefn->GetNameRef());
+                                    nFID, poFieldDefn->GetNameRef());
                     }
                 }
             }
@@ -1520,13 +1746,12 @@ OGRFeature * OGRCSVLayer::GetNextUnfilteredFeature()
             if (papszTokens[iAttr][0] != '\0' && !poFieldDefn->IsIgnored())
             {
                 poFeature->SetField( iOGRField, papszTokens[iAttr] );
-                if( !bWarningBadTypeOrWidth && !poFeature->IsFieldSet(iOGRField) )
+                if( !*pbWarningEmitted && !poFeature->IsFieldSet(iOGRField) )
                 {
-                    bWarningBadTypeOrWidth = TRUE;
-                    CPLError(CE_Warning, CPLE_AppDefined,
+                    OGRCSVWarnBadTypeOrWidth(pbWarningEmitted, posDeferredWarning,
                              "Invalid value type found in record %d for field %s. "
                              "This warning will no longer be emitted",
-                             nNextFID, poFieldDefn->GetNameRef());
+                             nFID, poFieldDefn->GetNameRef());
                 }
             }
         }
@@ -1536,14 +1761,13 @@ OGRFeature * OGRCSVLayer::GetNextUnfilteredFeature()
                 (!bEmptyStringNull || papszTokens[iAttr][0] != '\0') )
             {
                 poFeature->SetField( iOGRField, papszTokens[iAttr] );
-                if( !bWarningBadTypeOrWidth && poFieldDefn->GetWidth() > 0 &&
+                if( !*pbWarningEmitted && poFieldDefn->GetWidth() > 0 &&
                     (int)strlen(papszTokens[iAttr]) > poFieldDefn->GetWidth() )
                 {
-                    bWarningBadTypeOrWidth = TRUE;
-                    CPLError(CE_Warning, CPLE_AppDefined,
+                    OGRCSVWarnBadTypeOrWidth(pbWarningEmitted, posDeferredWarning,
                                 "Value with a width greater than field width found in record %d for field %s. "
                                 "This warning will no longer be emitted",
-                                nNextFID, poFieldDefn->GetNameRef());
+                                nFID, poFieldDefn->GetNameRef());
                 }
             }
         }
@@ -1651,14 +1875,10 @@ OGRFeature * OGRCSVLayer::GetNextUnfilteredFeature()
         }
     }
 
-    CSLDestroy( papszTokens );
-
 /* -------------------------------------------------------------------- */
 /*      Translate the record id.                                        */
 /* -------------------------------------------------------------------- */
-    poFeature->SetFID( nNextFID++ );
-
-    m_nFeaturesRead++;
+    poFeature->SetFID( nFID );
 
     return poFeature;
 }
@@ -1676,13 +1896,20 @@ OGRFeature *OGRCSVLayer::GetNextFeature()
     if( bNeedRewindBeforeRead )
         ResetReading();
 
+    if( nNumThreads > 1 && !bParallelReading && !bInWriteMode &&
+        fpCSV != NULL )
+        StartParallelReading();
+
 /* -------------------------------------------------------------------- */
 /*      Read features till we find one that satisfies our current       */
 /*      spatial criteria.                                               */
 /* -------------------------------------------------------------------- */
     while( true )
     {
-        poFeature = GetNextUnfilteredFeature();
+        if( bParallelReading )
+            poFeature = GetNextParallelFeature();
+        else
+            poFeature = GetNextUnfilteredFeature();
         if( poFeature == NULL )
             break;
 
@@ -1698,6 +1925,199 @@ OGRFeature *OGRCSVLayer::GetNextFeature()
     return poFeature;
 }
 
+/************************************************************************/
+/*                        StartParallelReading()                        */
+/************************************************************************/
+
+void OGRCSVLayer::StartParallelReading()
+{
+    if( poThreadPool == NULL )
+    {
+        poThreadPool = new CPLWorkerThreadPool();
+        if( !poThreadPool->Setup(nNumThreads, NULL, NULL) )
+        {
+            delete poThreadPool;
+            poThreadPool = NULL;
+            nNumThreads = 1;
+            return;
+        }
+        hBatchMutex = CPLCreateMutex();
+        CPLReleaseMutex(hBatchMutex);
+        hBatchCond = CPLCreateCond();
+    }
+
+    // Continue from where the sequential reader stopped.
+    poReader->TakeBufferedData( abyPendingData, &bPendingEOF );
+    nPendingScanned = 0;
+    nPendingRecords = 0;
+    nNextBatchFID = nNextFID;
+    bParallelReading = true;
+}
+
+/************************************************************************/
+/*                        StopParallelReading()                         */
+/*                                                                      */
+/*      The file position is undefined afterwards, so this must be      */
+/*      followed by a rewind.                                           */
+/************************************************************************/
+
+void OGRCSVLayer::StopParallelReading()
+{
+    if( !bParallelReading )
+        return;
+
+    poThreadPool->WaitCompletion();
+    for( std::list<OGRCSVFeatureBatch*>::iterator oIter = oBatchList.begin();
+         oIter != oBatchList.end(); ++oIter )
+    {
+        delete *oIter;
+    }
+    oBatchList.clear();
+    abyPendingData.clear();
+    bParallelReading = false;
+}
+
+/************************************************************************/
+/*                          SubmitNextBatch()                           */
+/*                                                                      */
+/*      Cut the next block of complete records from the file, and       */
+/*      queue it for parsing.  Returns false at end of file.            */
+/************************************************************************/
+
+bool OGRCSVLayer::SubmitNextBatch()
+{
+    const bool bHonourStrings = !(chDelimiter == '\t' && bDontHonourStrings);
+
+    while( true )
+    {
+        while( nPendingScanned < CSV_BATCH_SIZE )
+        {
+            bool bEmpty = false;
+            const size_t nRecordEnd = OGRCSVReader::FindRecordEnd(
+                abyPendingData.empty() ? NULL : &abyPendingData[0],
+                nPendingScanned, abyPendingData.size(), bPendingEOF,
+                bHonourStrings, &bEmpty );
+            if( nRecordEnd == OGRCSVReader::NPOS ||
+                nRecordEnd == nPendingScanned )
+                break;
+            nPendingScanned = nRecordEnd;
+            if( !bEmpty )
+                nPendingRecords ++;
+        }
+
+        if( nPendingScanned >= CSV_BATCH_SIZE || bPendingEOF )
+            break;
+
+        const size_t nOldSize = abyPendingData.size();
+        abyPendingData.resize( nOldSize + CSV_BATCH_SIZE );
+        const size_t nRead = VSIFReadL( &abyPendingData[nOldSize], 1,
+                                        CSV_BATCH_SIZE, fpCSV );
+        abyPendingData.resize( nOldSize + nRead );
+        if( nRead < CSV_BATCH_SIZE )
+            bPendingEOF = true;
+    }
+
+    if( nPendingScanned == 0 )
+        return false;
+
+    OGRCSVFeatureBatch* poBatch = new OGRCSVFeatureBatch(this, nNextBatchFID);
+    poBatch->abyData.assign( abyPendingData.begin(),
+                             abyPendingData.begin() + nPendingScanned );
+    abyPendingData.erase( abyPendingData.begin(),
+                          abyPendingData.begin() + nPendingScanned );
+    nNextBatchFID += nPendingRecords;
+    nPendingScanned = 0;
+    nPendingRecords = 0;
+
+    oBatchList.push_back( poBatch );
+    poThreadPool->SubmitJob( ParseBatchJob, poBatch );
+    return true;
+}
+
+/************************************************************************/
+/*                           ParseBatchJob()                            */
+/************************************************************************/
+
+void OGRCSVLayer::ParseBatchJob( void* pData )
+{
+    OGRCSVFeatureBatch* poBatch = static_cast<OGRCSVFeatureBatch*>(pData);
+    OGRCSVLayer* poLayer = poBatch->poLayer;
+
+    OGRCSVReader oReader;
+    oReader.SetOptions( poLayer->chDelimiter,
+                        !(poLayer->chDelimiter == '\t' &&
+                          poLayer->bDontHonourStrings),
+                        CPL_TO_BOOL(poLayer->bMergeDelimiter) );
+    oReader.SetBuffer( poBatch->abyData );
+
+    int nFID = poBatch->nFirstFID;
+    int nTokenCount = 0;
+    char** papszTokens;
+    while( (papszTokens = oReader.ReadRecord(&nTokenCount)) != NULL )
+    {
+        if( papszTokens[0] == NULL )
+            continue;
+        poBatch->apoFeatures.push_back(
+            poLayer->BuildFeature( papszTokens, nTokenCount, nFID,
+                                   &poBatch->bWarningEmitted,
+                                   &poBatch->osWarning ) );
+        nFID ++;
+    }
+
+    CPLAcquireMutex( poLayer->hBatchMutex, 1000.0 );
+    poBatch->bDone = true;
+    CPLCondBroadcast( poLayer->hBatchCond );
+    CPLReleaseMutex( poLayer->hBatchMutex );
+}
+
+/************************************************************************/
+/*                       GetNextParallelFeature()                       */
+/*                                                                      */
+/*      Return the features of the parsed batches in file order,        */
+/*      keeping enough batches in flight to feed the workers.           */
+/************************************************************************/
+
+OGRFeature* OGRCSVLayer::GetNextParallelFeature()
+{
+    while( true )
+    {
+        while( static_cast<int>(oBatchList.size()) < 2 * nNumThreads &&
+               SubmitNextBatch() )
+        {
+        }
+
+        if( oBatchList.empty() )
+            return NULL;
+
+        OGRCSVFeatureBatch* poBatch = oBatchList.front();
+        CPLAcquireMutex( hBatchMutex, 1000.0 );
+        while( !poBatch->bDone )
+            CPLCondWait( hBatchCond, hBatchMutex );
+        CPLReleaseMutex( hBatchMutex );
+
+        if( poBatch->iNextFeature == 0 && !poBatch->osWarning.empty() &&
+            !bWarningBadTypeOrWidth )
+        {
+            bWarningBadTypeOrWidth = TRUE;
+            CPLError( CE_Warning, CPLE_AppDefined,
+                      "%s", poBatch->osWarning.c_str() );
+        }
+
+        if( poBatch->iNextFeature < poBatch->apoFeatures.size() )
+        {
+            OGRFeature* poFeature =
+                poBatch->apoFeatures[poBatch->iNextFeature];
+            poBatch->iNextFeature ++;
+            nNextFID = static_cast<int>(poFeature->GetFID()) + 1;
+            m_nFeaturesRead++;
+            return poFeature;
+        }
+
+        oBatchList.pop_front();
+        delete poBatch;
+    }
+}
+
 /************************************************************************/
 /*                           TestCapability()                           */
 /************************************************************************/
@@ -2342,6 +2762,8 @@ GIntBig OGRCSVLayer::GetFeatureCount( int bForce )
     {
         char szBuffer[4096+1];
 
+        SyncFileWithReader();
+
         nTotalFeatures = 0;
         int bLastWasNewLine = FALSE;
         while( true )
@@ -2372,13 +2794,10 @@ GIntBig OGRCSVLayer::GetFeatureCount( int bForce )
         nTotalFeatures = 0;
         while( true )
         {
-            char **papszTokens = GetNextLineTokens();
-            if( papszTokens == NULL )
+            if( GetNextLineTokens() == NULL )
                 break;
 
             nTotalFeatures ++;
-
-            CSLDestroy(papszTokens);
         }
     }
 
@@ -0,0 +1,426 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  CSV Translator
+ * Purpose:  Implements OGRCSVReader class, a buffered CSV record tokenizer.
+ * Author:   Even Rouault, <even dot rouault at mines-paris dot org>
+ *
+ ******************************************************************************
+ * Copyright (c) 2016, Even Rouault <even dot rouault at mines-paris dot org>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "ogr_csv.h"
+#include "cpl_conv.h"
+
+#include <new>
+
+CPL_CVSID("$Id$");
+
+/* Initial size of the read buffer. It is doubled when a single record */
+/* does not fit in it. */
+static const size_t CSV_READER_BUFFER_SIZE = 1024 * 1024;
+
+/************************************************************************/
+/*                            OGRCSVReader()                            */
+/************************************************************************/
+
+OGRCSVReader::OGRCSVReader() :
+    fp(NULL),
+    chDelimiter(','),
+    bHonourStrings(true),
+    bMergeDelimiter(false),
+    nBufferStart(0),
+    nBufferEnd(0),
+    bEOF(false)
+{
+    szEmpty[0] = '\0';
+}
+
+/************************************************************************/
+/*                             SetOptions()                             */
+/*                                                                      */
+/*      When bHonourStrings is false, quotes are regular characters     */
+/*      and bMergeDelimiter is ignored, as in OGRCSVReadParseLineL()    */
+/*      for un-balanced tab separated files.                            */
+/************************************************************************/
+
+void OGRCSVReader::SetOptions( char chDelimiterIn, bool bHonourStringsIn,
+                               bool bMergeDelimiterIn )
+{
+    chDelimiter = chDelimiterIn;
+    bHonourStrings = bHonourStringsIn;
+    bMergeDelimiter = bHonourStringsIn && bMergeDelimiterIn;
+}
+
+/************************************************************************/
+/*                               Reset()                                */
+/*                                                                      */
+/*      Discard buffered data. The next record is read from the         */
+/*      current position of fpIn.                                       */
+/************************************************************************/
+
+void OGRCSVReader::Reset( VSILFILE* fpIn )
+{
+    fp = fpIn;
+    nBufferStart = 0;
+    nBufferEnd = 0;
+    bEOF = (fp == NULL);
+}
+
+/************************************************************************/
+/*                             SetBuffer()                              */
+/*                                                                      */
+/*      Read records from an in-memory buffer instead of a file.        */
+/*      The content of abyData is taken over by the reader.             */
+/************************************************************************/
+
+void OGRCSVReader::SetBuffer( std::vector<char>& abyData )
+{
+    fp = NULL;
+    abyBuffer.swap(abyData);
+    nBufferStart = 0;
+    nBufferEnd = abyBuffer.size();
+    // Spare byte for the terminating nul of a record ending at end of data.
+    abyBuffer.push_back('\0');
+    bEOF = true;
+}
+
+/************************************************************************/
+/*                          TakeBufferedData()                          */
+/*                                                                      */
+/*      Hand over the data read ahead from the file, but not yet        */
+/*      returned as records, and forget about it.                       */
+/************************************************************************/
+
+void OGRCSVReader::TakeBufferedData( std::vector<char>& abyData,
+                                     bool* pbEOF )
+{
+    abyData.assign( abyBuffer.begin() + nBufferStart,
+                    abyBuffer.begin() + nBufferEnd );
+    *pbEOF = bEOF;
+    nBufferStart = 0;
+    nBufferEnd = 0;
+}
+
+/************************************************************************/
+/*                                Tell()                                */
+/*                                                                      */
+/*      Offset in the file of the first record not returned yet.        */
+/************************************************************************/
+
+vsi_l_offset OGRCSVReader::Tell()
+{
+    if( fp == NULL )
+        return 0;
+    return VSIFTellL(fp) - (nBufferEnd - nBufferStart);
+}
+
+/************************************************************************/
+/*                             FillBuffer()                             */
+/************************************************************************/
+
+void OGRCSVReader::FillBuffer()
+{
+    if( bEOF )
+        return;
+
+    if( nBufferStart > 0 )
+    {
+        if( nBufferEnd > nBufferStart )
+            memmove( &abyBuffer[0], &abyBuffer[nBufferStart],
+                     nBufferEnd - nBufferStart );
+        nBufferEnd -= nBufferStart;
+        nBufferStart = 0;
+    }
+
+    // Keep one spare byte for the terminating nul of the last record.
+    if( abyBuffer.size() < nBufferEnd + 1 + abyBuffer.size() / 4 )
+    {
+        const size_t nNewSize = abyBuffer.empty() ?
+            CSV_READER_BUFFER_SIZE + 1 : (abyBuffer.size() - 1) * 2 + 1;
+        try
+        {
+            abyBuffer.resize( nNewSize );
+        }
+        catch( const std::bad_alloc& )
+        {
+            CPLError( CE_Failure, CPLE_OutOfMemory,
+                      "Cannot allocate " CPL_FRMT_GUIB " bytes for CSV record",
+                      static_cast<GUIntBig>(nNewSize) );
+            bEOF = true;
+            return;
+        }
+    }
+
+    const size_t nToRead = abyBuffer.size() - 1 - nBufferEnd;
+    const size_t nRead = VSIFReadL( &abyBuffer[nBufferEnd], 1, nToRead, fp );
+    nBufferEnd += nRead;
+    if( nRead < nToRead )
+        bEOF = true;
+}
+
+/************************************************************************/
+/*                           FindRecordEnd()                            */
+/*                                                                      */
+/*      Find the end of the record starting at nStart, with the same    */
+/*      line joining rules as OGRCSVReadParseLineL(): physical lines    */
+/*      (terminated by \r\n, \n\r, \n or \r) are appended while the     */
+/*      number of double quotes seen so far is odd.                     */
+/*                                                                      */
+/*      Returns the offset just after the record, nStart if bEOF is     */
+/*      set and there is no more record, or NPOS if more data is        */
+/*      needed to decide.  *pbEmpty is set if the record has no         */
+/*      content, in which case it produces no token.                    */
+/************************************************************************/
+
+size_t OGRCSVReader::FindRecordEnd( const char* pachData,
+                                    size_t nStart, size_t nEnd, bool bEOFIn,
+                                    bool bHonourStringsIn, bool* pbEmpty )
+{
+    if( nStart == nEnd )
+    {
+        *pbEmpty = true;
+        return bEOFIn ? nStart : NPOS;
+    }
+
+    size_t i = nStart;
+    int nQuoteCount = 0;
+    bool bFirstLine = true;
+
+    while( true )
+    {
+        const size_t nLineStart = i;
+        size_t nContentEnd = NPOS;
+        for( ; i < nEnd && pachData[i] != '\n' && pachData[i] != '\r'; i++ )
+        {
+            // CPLReadLineL() lines are nul terminated strings.
+            if( pachData[i] == '\0' )
+            {
+                if( nContentEnd == NPOS )
+                    nContentEnd = i;
+            }
+            else if( pachData[i] == '"' && nContentEnd == NPOS )
+                nQuoteCount++;
+        }
+        if( nContentEnd == NPOS )
+            nContentEnd = i;
+
+        if( bFirstLine )
+        {
+            size_t nContentStart = nLineStart;
+            if( nContentEnd - nContentStart >= 3 &&
+                static_cast<GByte>(pachData[nContentStart]) == 0xEF &&
+                static_cast<GByte>(pachData[nContentStart+1]) == 0xBB &&
+                static_cast<GByte>(pachData[nContentStart+2]) == 0xBF )
+            {
+                nContentStart += 3;
+            }
+            *pbEmpty = (nContentEnd == nContentStart);
+            bFirstLine = false;
+        }
+
+        if( i == nEnd )
+            return bEOFIn ? nEnd : NPOS;
+
+        // A terminator may be made of two characters.
+        if( i + 1 == nEnd && !bEOFIn )
+            return NPOS;
+        if( i + 1 < nEnd &&
+            ((pachData[i] == '\r' && pachData[i+1] == '\n') ||
+             (pachData[i] == '\n' && pachData[i+1] == '\r')) )
+            i += 2;
+        else
+            i ++;
+
+        // Unbalanced quotes: the record goes on with the next line.
+        if( !bHonourStringsIn || (nQuoteCount % 2) == 0 )
+            return i;
+    }
+}
+
+/************************************************************************/
+/*                            SplitRecord()                             */
+/*                                                                      */
+/*      Tokenize in place the nul terminated record, with the same      */
+/*      semantics as CSVSplitLine().  Tokens are written over the       */
+/*      record, which is possible since unquoting only shrinks it.      */
+/************************************************************************/
+
+void OGRCSVReader::SplitRecord( char* pszRecord )
+{
+    apszTokens.resize(0);
+
+    const char* pszIn = pszRecord;
+    char* pszOut = pszRecord;
+
+    while( *pszIn != '\0' )
+    {
+        bool bInString = false;
+        char chLastRaw = '\0';
+        char* pszToken = pszOut;
+
+        for( ; *pszIn != '\0'; pszIn++ )
+        {
+            if( !bInString && *pszIn == chDelimiter )
+            {
+                chLastRaw = chDelimiter;
+                pszIn++;
+                if( bMergeDelimiter )
+                {
+                    while( *pszIn == chDelimiter )
+                        pszIn ++;
+                }
+                break;
+            }
+
+            if( bHonourStrings && *pszIn == '"' )
+            {
+                if( !bInString || pszIn[1] != '"' )
+                {
+                    bInString = !bInString;
+                    chLastRaw = '"';
+                    continue;
+                }
+                else  /* doubled quotes in string resolve to one quote */
+                {
+                    pszIn++;
+                }
+            }
+
+            chLastRaw = *pszIn;
+            *pszOut = *pszIn;
+            pszOut++;
+        }
+
+        // pszOut is either before the consumed delimiter, or at the
+        // terminating nul, so this does not overwrite unread data.
+        *pszOut = '\0';
+        pszOut++;
+        apszTokens.push_back( pszToken );
+
+        /* If the last token is an empty token, then we have to catch
+         * it now, otherwise we won't reenter the loop and it will be lost.
+         */
+        if( *pszIn == '\0' && chLastRaw == chDelimiter )
+        {
+            apszTokens.push_back( szEmpty );
+        }
+    }
+
+    apszTokens.push_back( NULL );
+}
+
+/************************************************************************/
+/*                             ReadRecord()                             */
+/*                                                                      */
+/*      Return the tokens of the next record, or NULL at end of         */
+/*      file.  An empty line gives an empty token list.  The tokens     */
+/*      point into the read buffer and remain valid until the next      */
+/*      call.  They may be modified in place by the caller.             */
+/************************************************************************/
+
+char** OGRCSVReader::ReadRecord( int* pnTokenCount )
+{
+    size_t nRecordEnd;
+    bool bEmpty = false;
+    while( true )
+    {
+        nRecordEnd = FindRecordEnd( abyBuffer.empty() ? NULL : &abyBuffer[0],
+                                    nBufferStart, nBufferEnd, bEOF,
+                                    bHonourStrings, &bEmpty );
+        if( nRecordEnd != NPOS )
+            break;
+        FillBuffer();
+    }
+
+    if( nRecordEnd == nBufferStart )
+    {
+        if( pnTokenCount )
+            *pnTokenCount = 0;
+        return NULL;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Assemble the physical lines of the record in place, with a      */
+/*      single \n between them, dropping a leading UTF-8 BOM and        */
+/*      anything after a nul character in each line.                    */
+/* -------------------------------------------------------------------- */
+    char* pachData = &abyBuffer[0];
+    char* pszRecord = pachData + nBufferStart;
+    char* pszOut = pszRecord;
+    size_t i = nBufferStart;
+    bool bFirstLine = true;
+
+    while( true )
+    {
+        if( bFirstLine && nRecordEnd - i >= 3 &&
+            static_cast<GByte>(pachData[i]) == 0xEF &&
+            static_cast<GByte>(pachData[i+1]) == 0xBB &&
+            static_cast<GByte>(pachData[i+2]) == 0xBF )
+        {
+            i += 3;
+        }
+
+        bool bInContent = true;
+        for( ; i < nRecordEnd && pachData[i] != '\n' && pachData[i] != '\r';
+             i++ )
+        {
+            if( pachData[i] == '\0' )
+                bInContent = false;
+            if( bInContent )
+            {
+                *pszOut = pachData[i];
+                pszOut++;
+            }
+        }
+        if( i == nRecordEnd )
+            break;
+
+        if( i + 1 < nRecordEnd &&
+            ((pachData[i] == '\r' && pachData[i+1] == '\n') ||
+             (pachData[i] == '\n' && pachData[i+1] == '\r')) )
+            i += 2;
+        else
+            i ++;
+        if( i == nRecordEnd )
+            break;
+
+        // The '\n' gets lost in CPLReadLine().
+        *pszOut = '\n';
+        pszOut++;
+        bFirstLine = false;
+    }
+    *pszOut = '\0';
+
+    nBufferStart = nRecordEnd;
+
+    if( bEmpty )
+    {
+        apszTokens.resize(0);
+        apszTokens.push_back( NULL );
+    }
+    else
+        SplitRecord( pszRecord );
+
+    if( pnTokenCount )
+        *pnTokenCount = static_cast<int>(apszTokens.size()) - 1;
+    return &apszTokens[0];
+}
@@ -31,6 +31,7 @@
 #include "gmlreader.h"
 #include "cpl_conv.h"
 #include "cpl_string.h"
+#include "ogr_geometry.h"
 
 /************************************************************************/
 /*                             GMLFeature()                             */
@@ -51,6 +52,9 @@ GMLFeature::GMLFeature( GMLFeatureClass *poClass )
     m_apsGeometry[1] = NULL;
 
     m_papszOBProperties = NULL;
+
+    m_nOGRGeometryCount = 0;
+    m_papoOGRGeometry = NULL;
 }
 
 /************************************************************************/
@@ -88,6 +92,10 @@ GMLFeature::~GMLFeature()
 
     CPLFree( m_pasProperties );
     CSLDestroy( m_papszOBProperties );
+
+    for( int i = 0; i < m_nOGRGeometryCount; i++ )
+        delete m_papoOGRGeometry[i];
+    CPLFree( m_papoOGRGeometry );
 }
 
 /************************************************************************/
@@ -247,6 +255,38 @@ const CPLXMLNode* GMLFeature::GetGeometryRef( int nIdx ) const
     return m_papsGeometry[nIdx];
 }
 
+/************************************************************************/
+/*                          SetOGRGeometries()                          */
+/*                                                                      */
+/*      Attach geometries already converted from the GML geometry       */
+/*      nodes. Takes ownership of the array and of the geometries.      */
+/************************************************************************/
+
+void GMLFeature::SetOGRGeometries( int nCount, OGRGeometry** papoGeom )
+
+{
+    for( int i = 0; i < m_nOGRGeometryCount; i++ )
+        delete m_papoOGRGeometry[i];
+    CPLFree( m_papoOGRGeometry );
+
+    m_nOGRGeometryCount = nCount;
+    m_papoOGRGeometry = papoGeom;
+}
+
+/************************************************************************/
+/*                          StealOGRGeometry()                          */
+/************************************************************************/
+
+OGRGeometry* GMLFeature::StealOGRGeometry( int nIdx )
+
+{
+    if( nIdx < 0 || nIdx >= m_nOGRGeometryCount )
+        return NULL;
+    OGRGeometry* poGeom = m_papoOGRGeometry[nIdx];
+    m_papoOGRGeometry[nIdx] = NULL;
+    return poGeom;
+}
+
 /************************************************************************/
 /*                             AddGeometry()                            */
 /************************************************************************/
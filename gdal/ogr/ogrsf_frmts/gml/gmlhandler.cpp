@@ -1106,7 +1106,8 @@ OGRErr GMLHandler::startElementFeatureAttribute(const char *pszName, int nLenNam
                 m_bAlreadyFoundGeometry = true;
                 bReadGeometry = true;
                 m_nGeometryPropertyIndex = poClass->GetGeometryPropertyIndexBySrcElement( poState->osPath.c_str() );
-                if( m_nGeometryPropertyIndex < 0 )
+                /* A locked schema may be shared by several parsing threads */
+                if( m_nGeometryPropertyIndex < 0 && !poClass->IsSchemaLocked() )
                 {
                     poClass->AddGeometryProperty( new GMLGeometryPropertyDefn(
                             "geometry", poState->osPath.c_str(), wkbUnknown, -1, true ) );
@@ -0,0 +1,788 @@
+/**********************************************************************
+ * $Id$
+ *
+ * Project:  GML Reader
+ * Purpose:  Implementation of GMLParallelReader class.
+ * Author:   Even Rouault, <even dot rouault at mines-paris dot org>
+ *
+ **********************************************************************
+ * Copyright (c) 2016, Even Rouault <even dot rouault at mines-paris dot org>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "gmlreaderp.h"
+#include "gmlutils.h"
+#include "cpl_conv.h"
+#include "cpl_error.h"
+#include "cpl_string.h"
+#include "cpl_worker_thread_pool.h"
+#include "ogr_geometry.h"
+
+CPL_CVSID("$Id$");
+
+#ifdef HAVE_EXPAT
+
+/* Default amount of GML text handed to a single job */
+#define GML_PARALLEL_DEFAULT_CHUNK_SIZE (1024 * 1024)
+
+/************************************************************************/
+/*                           GMLParallelJob                             */
+/************************************************************************/
+
+typedef enum
+{
+    GMLJOB_PARSING,
+    GMLJOB_PARSED,
+    GMLJOB_CONVERTING,
+    GMLJOB_READY
+} GMLParallelJobState;
+
+typedef struct
+{
+    CPLErr      eErrClass;
+    CPLErrorNum nErrNo;
+    CPLString   osMsg;
+} GMLParallelJobError;
+
+class GMLParallelJob
+{
+public:
+    GMLReader          *poJobReader;
+    CPLMutex           *hMutex;
+    CPLCond            *hCond;
+
+    /* Input */
+    std::string         osData;
+    CPLString           osEncoding;
+    bool                bSetEncoding;
+    size_t              nPrefixLen;
+    int                 nStartLine;
+    int                 nStartColumn;
+
+    /* Conversion parameters, set by the main thread before conversion */
+    bool                bInvertAxisOrderIfLatLong;
+    bool                bConsiderEPSGAsURN;
+    bool                bGetSecondaryGeometryOption;
+    bool                bFaceHoleNegative;
+    bool                bHasSRSName;
+    CPLString           osSRSName;
+
+    /* Output */
+    GMLParallelJobState eState;
+    bool                bPromoted;
+    bool                bParseOK;
+    CPLString           osError;
+    int                 nErrorLine;
+    int                 nErrorColumn;
+    bool                bHasGlobalSRSName;
+    CPLString           osGlobalSRSName;
+    std::vector<GMLParallelJobError> aoErrors;
+    bool                bErrorsEmitted;
+    std::vector<GMLFeature*> apoFeatures;
+    size_t              iNextFeature;
+    int                 nConvertErrors;
+
+    GMLParallelJob() : poJobReader(NULL), hMutex(NULL),
+                       hCond(NULL), bSetEncoding(false), nPrefixLen(0),
+                       nStartLine(1), nStartColumn(0),
+                       bInvertAxisOrderIfLatLong(false),
+                       bConsiderEPSGAsURN(false),
+                       bGetSecondaryGeometryOption(false),
+                       bFaceHoleNegative(false), bHasSRSName(false),
+                       eState(GMLJOB_PARSING), bPromoted(false),
+                       bParseOK(true), nErrorLine(0), nErrorColumn(0),
+                       bHasGlobalSRSName(false), bErrorsEmitted(false),
+                       iNextFeature(0), nConvertErrors(0) {}
+
+    void SetState( GMLParallelJobState eNewState )
+    {
+        CPLAcquireMutex(hMutex, 1000.0);
+        eState = eNewState;
+        CPLCondBroadcast(hCond);
+        CPLReleaseMutex(hMutex);
+    }
+};
+
+/************************************************************************/
+/*                   GMLParallelCaptureErrorHandler()                   */
+/*                                                                      */
+/*      Errors emitted while parsing a job are stored in the job, and   */
+/*      emitted by the main thread when the features of the job are     */
+/*      returned, so that they come in the same order as with the       */
+/*      sequential reader.                                              */
+/************************************************************************/
+
+static void CPL_STDCALL GMLParallelCaptureErrorHandler( CPLErr eErrClass,
+                                                        CPLErrorNum nErrNo,
+                                                        const char* pszMsg )
+{
+    GMLParallelJob* poJob = (GMLParallelJob*) CPLGetErrorHandlerUserData();
+    GMLParallelJobError oError;
+    oError.eErrClass = eErrClass;
+    oError.nErrNo = nErrNo;
+    oError.osMsg = pszMsg;
+    poJob->aoErrors.push_back(oError);
+}
+
+/************************************************************************/
+/*                   GMLParallelCountErrorHandler()                     */
+/************************************************************************/
+
+static void CPL_STDCALL GMLParallelCountErrorHandler( CPLErr eErrClass,
+                                                      CPL_UNUSED CPLErrorNum nErrNo,
+                                                      CPL_UNUSED const char* pszMsg )
+{
+    GMLParallelJob* poJob = (GMLParallelJob*) CPLGetErrorHandlerUserData();
+    if( eErrClass != CE_Debug )
+        poJob->nConvertErrors ++;
+}
+
+/************************************************************************/
+/*                         GMLParallelReader()                          */
+/************************************************************************/
+
+GMLParallelReader::GMLParallelReader( GMLReader* poReader, VSILFILE* fp,
+                                      int nThreads, bool bUseGlobalSRSName ) :
+    m_poReader(poReader),
+    m_fp(fp),
+    m_nThreads(nThreads),
+    m_bUseGlobalSRSName(bUseGlobalSRSName),
+    m_nChunkSize(GML_PARALLEL_DEFAULT_CHUNK_SIZE),
+    m_poPool(NULL),
+    m_hMutex(NULL),
+    m_hCond(NULL),
+    m_oScanParser(NULL),
+    m_pabyBuf(NULL),
+    m_bScanDone(false),
+    m_bScanError(false),
+    m_bCanSplit(true),
+    m_bHasDoctype(false),
+    m_nDepth(0),
+    m_nContainerDepth(-1),
+    m_nLastSplitOffset(0),
+    m_nPendingOffset(0),
+    m_nPendingLine(1),
+    m_nPendingColumn(0)
+{
+    /* Only for testing purposes */
+    const char* pszChunkSize =
+        CPLGetConfigOption("GML_PARALLEL_CHUNK_SIZE", NULL);
+    if( pszChunkSize != NULL && atoi(pszChunkSize) > 0 )
+        m_nChunkSize = (size_t)atoi(pszChunkSize);
+
+    CPLDebug("GML", "Reading with %d threads", m_nThreads);
+
+    m_hMutex = CPLCreateMutex();
+    CPLReleaseMutex(m_hMutex);
+    m_hCond = CPLCreateCond();
+
+    m_poPool = new CPLWorkerThreadPool();
+    if( !m_poPool->Setup(m_nThreads, NULL, NULL) )
+    {
+        /* Jobs will be run synchronously */
+        delete m_poPool;
+        m_poPool = NULL;
+    }
+
+    m_oScanParser = OGRCreateExpatXMLParser();
+    XML_SetElementHandler(m_oScanParser, startElementScanCbk,
+                          endElementScanCbk);
+    XML_SetXmlDeclHandler(m_oScanParser, xmlDeclScanCbk);
+    XML_SetStartDoctypeDeclHandler(m_oScanParser, startDoctypeScanCbk);
+    XML_SetUserData(m_oScanParser, this);
+
+    m_pabyBuf = (char*) VSI_MALLOC_VERBOSE(PARSER_BUF_SIZE);
+    if( m_pabyBuf == NULL )
+        m_bScanDone = true;
+    else
+        ScanNextJobs();
+}
+
+/************************************************************************/
+/*                         ~GMLParallelReader()                         */
+/************************************************************************/
+
+GMLParallelReader::~GMLParallelReader()
+
+{
+    if( m_poPool != NULL )
+    {
+        m_poPool->WaitCompletion();
+        delete m_poPool;
+    }
+
+    while( !m_apoJobs.empty() )
+    {
+        ReleaseJob( m_apoJobs.front() );
+        m_apoJobs.pop_front();
+    }
+    for( size_t i = 0; i < m_apoFreeJobReaders.size(); i++ )
+        delete m_apoFreeJobReaders[i];
+
+    if( m_oScanParser != NULL )
+        XML_ParserFree(m_oScanParser);
+    CPLFree(m_pabyBuf);
+
+    CPLDestroyCond(m_hCond);
+    CPLDestroyMutex(m_hMutex);
+}
+
+/************************************************************************/
+/*                           xmlDeclScanCbk()                           */
+/************************************************************************/
+
+void XMLCALL GMLParallelReader::xmlDeclScanCbk( void* pUserData,
+                                                CPL_UNUSED const char* pszVersion,
+                                                const char* pszEncoding,
+                                                CPL_UNUSED int bStandalone )
+{
+    GMLParallelReader* poThis = (GMLParallelReader*) pUserData;
+    if( pszEncoding != NULL )
+    {
+        poThis->m_osEncoding = pszEncoding;
+        /* The pieces are prefixed with UTF-8 text, which must be */
+        /* compatible with the declared encoding */
+        if( STARTS_WITH_CI(pszEncoding, "UTF-16") ||
+            STARTS_WITH_CI(pszEncoding, "UTF16") )
+            poThis->m_bCanSplit = false;
+    }
+}
+
+/************************************************************************/
+/*                        startDoctypeScanCbk()                         */
+/************************************************************************/
+
+void XMLCALL GMLParallelReader::startDoctypeScanCbk( void* pUserData,
+                                    CPL_UNUSED const char* pszDoctypeName,
+                                    CPL_UNUSED const char* pszSysId,
+                                    CPL_UNUSED const char* pszPubId,
+                                    CPL_UNUSED int bHasInternalSubset )
+{
+    /* Entities declared in the DTD would not be known by the parsers */
+    /* of the pieces. */
+    GMLParallelReader* poThis = (GMLParallelReader*) pUserData;
+    poThis->m_bHasDoctype = true;
+    poThis->m_bCanSplit = false;
+}
+
+/************************************************************************/
+/*                        startElementScanCbk()                         */
+/*                                                                      */
+/*      The pre-scan looks for the element holding the feature          */
+/*      members, and remembers the start tags of it and of its          */
+/*      ancestors, so that they can be replayed at the beginning of     */
+/*      each piece.                                                     */
+/************************************************************************/
+
+void XMLCALL GMLParallelReader::startElementScanCbk( void *pUserData,
+                                                     const char *pszName,
+                                                     const char **ppszAttr )
+{
+    GMLParallelReader* poThis = (GMLParallelReader*) pUserData;
+
+    poThis->m_nDepth ++;
+    if( poThis->m_nContainerDepth >= 0 || !poThis->m_bCanSplit )
+        return;
+
+    CPLString osTag("<");
+    osTag += pszName;
+    for( int i = 0; ppszAttr[i] != NULL && ppszAttr[i+1] != NULL; i += 2 )
+    {
+        osTag += " ";
+        osTag += ppszAttr[i];
+        osTag += "=\"";
+        for( const char* pszIter = ppszAttr[i+1]; *pszIter; pszIter++ )
+        {
+            switch( *pszIter )
+            {
+                case '&':  osTag += "&amp;"; break;
+                case '<':  osTag += "&lt;"; break;
+                case '"':  osTag += "&quot;"; break;
+                case '\t': osTag += "&#9;"; break;
+                case '\n': osTag += "&#10;"; break;
+                case '\r': osTag += "&#13;"; break;
+                default:   osTag += *pszIter; break;
+            }
+        }
+        osTag += "\"";
+    }
+    osTag += ">";
+    poThis->m_aosTagNames.push_back(pszName);
+    poThis->m_aosTags.push_back(osTag);
+
+/* -------------------------------------------------------------------- */
+/*      gml:featureMembers holds the features directly, whereas         */
+/*      gml:featureMember or wfs:member are repeated in their parent.   */
+/* -------------------------------------------------------------------- */
+    const char* pszLocalName = strrchr(pszName, ':');
+    pszLocalName = (pszLocalName != NULL) ? pszLocalName + 1 : pszName;
+    const size_t nLen = strlen(pszLocalName);
+    if( nLen >= 7 && EQUAL(pszLocalName + nLen - 7, "members") )
+        poThis->m_nContainerDepth = poThis->m_nDepth;
+    else if( nLen >= 6 && EQUAL(pszLocalName + nLen - 6, "member") &&
+             poThis->m_nDepth > 1 )
+        poThis->m_nContainerDepth = poThis->m_nDepth - 1;
+    else
+        return;
+
+    poThis->m_osContainerOpenTags.clear();
+    poThis->m_osContainerCloseTags.clear();
+    for( int i = 0; i < poThis->m_nContainerDepth; i++ )
+    {
+        poThis->m_osContainerOpenTags += poThis->m_aosTags[i];
+        poThis->m_osContainerCloseTags += "</";
+        poThis->m_osContainerCloseTags +=
+            poThis->m_aosTagNames[poThis->m_nContainerDepth - 1 - i];
+        poThis->m_osContainerCloseTags += ">";
+    }
+
+    /* Non UTF-8 files can only be split if the replayed tags are ASCII */
+    if( !poThis->m_osEncoding.empty() &&
+        !EQUAL(poThis->m_osEncoding, "UTF-8") &&
+        !EQUAL(poThis->m_osEncoding, "UTF8") )
+    {
+        for( size_t i = 0; i < poThis->m_osContainerOpenTags.size(); i++ )
+        {
+            if( (unsigned char)poThis->m_osContainerOpenTags[i] >= 0x80 )
+            {
+                poThis->m_bCanSplit = false;
+                break;
+            }
+        }
+    }
+}
+
+/************************************************************************/
+/*                         endElementScanCbk()                          */
+/************************************************************************/
+
+void XMLCALL GMLParallelReader::endElementScanCbk( void *pUserData,
+                                                   CPL_UNUSED const char *pszName )
+{
+    GMLParallelReader* poThis = (GMLParallelReader*) pUserData;
+
+    if( poThis->m_bCanSplit && poThis->m_nContainerDepth >= 0 &&
+        poThis->m_nDepth == poThis->m_nContainerDepth + 1 )
+    {
+        const GUIntBig nEnd =
+            (GUIntBig)XML_GetCurrentByteIndex(poThis->m_oScanParser) +
+            XML_GetCurrentByteCount(poThis->m_oScanParser);
+        if( nEnd - poThis->m_nLastSplitOffset >= poThis->m_nChunkSize )
+        {
+            GMLSplitPoint oSplit;
+            oSplit.nOffset = nEnd;
+            oSplit.nLine = (int)XML_GetCurrentLineNumber(poThis->m_oScanParser);
+            oSplit.nColumn =
+                (int)XML_GetCurrentColumnNumber(poThis->m_oScanParser) +
+                XML_GetCurrentByteCount(poThis->m_oScanParser);
+            oSplit.osOpenTags = poThis->m_osContainerOpenTags;
+            oSplit.osCloseTags = poThis->m_osContainerCloseTags;
+            poThis->m_aoSplitPoints.push_back(oSplit);
+            poThis->m_nLastSplitOffset = nEnd;
+        }
+    }
+
+    if( (int)poThis->m_aosTags.size() == poThis->m_nDepth )
+    {
+        poThis->m_aosTags.pop_back();
+        poThis->m_aosTagNames.pop_back();
+    }
+    if( poThis->m_nDepth == poThis->m_nContainerDepth )
+        poThis->m_nContainerDepth = -1;
+    poThis->m_nDepth --;
+}
+
+/************************************************************************/
+/*                            ScanNextJobs()                            */
+/*                                                                      */
+/*      Read and pre-scan the next buffer of the file, and submit a     */
+/*      job for each piece completed.                                   */
+/************************************************************************/
+
+void GMLParallelReader::ScanNextJobs()
+
+{
+    unsigned int nLen =
+        (unsigned int)VSIFReadL( m_pabyBuf, 1, PARSER_BUF_SIZE, m_fp );
+    const int nDone = VSIFEofL(m_fp);
+
+    /* Some files end with trailing nul characters. See NextFeatureExpat() */
+    while( nDone && nLen > 0 && m_pabyBuf[nLen-1] == '\0' )
+        nLen --;
+
+    m_osPending.append(m_pabyBuf, nLen);
+
+    if( XML_Parse(m_oScanParser, m_pabyBuf, nLen, nDone) == XML_STATUS_ERROR )
+    {
+        /* The job covering that part of the file will report the error */
+        m_bScanError = true;
+    }
+
+    for( size_t i = 0; i < m_aoSplitPoints.size(); i++ )
+    {
+        const GMLSplitPoint& oSplit = m_aoSplitPoints[i];
+        const size_t nSize = (size_t)(oSplit.nOffset - m_nPendingOffset);
+
+        std::string osData;
+        osData.reserve(m_osPendingOpenTags.size() + nSize +
+                       oSplit.osCloseTags.size());
+        osData += m_osPendingOpenTags;
+        osData.append(m_osPending, 0, nSize);
+        osData += oSplit.osCloseTags;
+        SubmitParseJob(osData);
+
+        m_osPending.erase(0, nSize);
+        m_nPendingOffset = oSplit.nOffset;
+        m_nPendingLine = oSplit.nLine;
+        m_nPendingColumn = oSplit.nColumn;
+        m_osPendingOpenTags = oSplit.osOpenTags;
+    }
+    m_aoSplitPoints.clear();
+
+    if( nDone || m_bScanError )
+    {
+        std::string osData;
+        osData.reserve(m_osPendingOpenTags.size() + m_osPending.size());
+        osData += m_osPendingOpenTags;
+        osData += m_osPending;
+        SubmitParseJob(osData);
+
+        std::string().swap(m_osPending);
+        m_bScanDone = true;
+    }
+}
+
+/************************************************************************/
+/*                           SubmitParseJob()                           */
+/************************************************************************/
+
+void GMLParallelReader::SubmitParseJob( std::string& osData )
+
+{
+    GMLParallelJob* poJob = new GMLParallelJob();
+    poJob->hMutex = m_hMutex;
+    poJob->hCond = m_hCond;
+    if( !m_apoFreeJobReaders.empty() )
+    {
+        poJob->poJobReader = m_apoFreeJobReaders.back();
+        m_apoFreeJobReaders.pop_back();
+    }
+    else
+    {
+        poJob->poJobReader = m_poReader->CreateJobReader();
+    }
+    poJob->osData.swap(osData);
+    poJob->osEncoding = m_osEncoding;
+    /* The first piece starts with the XML declaration, if any */
+    poJob->bSetEncoding = m_nPendingOffset != 0 && !m_osEncoding.empty();
+    poJob->nPrefixLen = m_osPendingOpenTags.size();
+    poJob->nStartLine = m_nPendingLine;
+    poJob->nStartColumn = m_nPendingColumn;
+    m_apoJobs.push_back(poJob);
+
+    if( m_poPool != NULL )
+        m_poPool->SubmitJob(ParseJobFunc, poJob);
+    else
+        ParseJobFunc(poJob);
+}
+
+/************************************************************************/
+/*                            ParseJobFunc()                            */
+/************************************************************************/
+
+void GMLParallelReader::ParseJobFunc( void* pData )
+
+{
+    GMLParallelJob* poJob = (GMLParallelJob*) pData;
+    GMLReader* poJobReader = poJob->poJobReader;
+
+    CPLFree(poJobReader->m_pszGlobalSRSName);
+    poJobReader->m_pszGlobalSRSName = NULL;
+
+    CPLPushErrorHandlerEx(GMLParallelCaptureErrorHandler, poJob);
+    poJob->bParseOK = poJobReader->ParseJobBuffer(
+        poJob->osData.c_str(), poJob->osData.size(),
+        poJob->bSetEncoding ? poJob->osEncoding.c_str() : NULL,
+        poJob->apoFeatures, poJob->osError,
+        poJob->nErrorLine, poJob->nErrorColumn );
+    CPLPopErrorHandler();
+
+    if( poJobReader->m_pszGlobalSRSName != NULL )
+    {
+        poJob->bHasGlobalSRSName = true;
+        poJob->osGlobalSRSName = poJobReader->m_pszGlobalSRSName;
+    }
+
+    std::string().swap(poJob->osData);
+
+    poJob->SetState(GMLJOB_PARSED);
+}
+
+/************************************************************************/
+/*                           ConvertJobFunc()                           */
+/*                                                                      */
+/*      Build the OGR geometries of the features of a job. If the       */
+/*      conversion of a feature emits any error or warning, its         */
+/*      geometries are discarded so that the layer converts them again  */
+/*      and reports the messages itself.                                */
+/************************************************************************/
+
+void GMLParallelReader::ConvertJobFunc( void* pData )
+
+{
+    GMLParallelJob* poJob = (GMLParallelJob*) pData;
+    void* hCacheSRS = GML_BuildOGRGeometryFromList_CreateCache();
+    const char* pszSRSName =
+        poJob->bHasSRSName ? poJob->osSRSName.c_str() : NULL;
+
+    CPLPushErrorHandlerEx(GMLParallelCountErrorHandler, poJob);
+    for( size_t iFeature = 0; iFeature < poJob->apoFeatures.size(); iFeature++ )
+    {
+        GMLFeature* poFeature = poJob->apoFeatures[iFeature];
+        const CPLXMLNode* const * papsGeometry = poFeature->GetGeometryList();
+        const int nGeomPropCount =
+            poFeature->GetClass()->GetGeometryPropertyCount();
+
+        int nCount = 0;
+        OGRGeometry** papoGeom = NULL;
+        const int nErrorsBefore = poJob->nConvertErrors;
+
+        if( nGeomPropCount > 1 )
+        {
+            nCount = nGeomPropCount;
+            papoGeom = (OGRGeometry**) CPLCalloc(nCount, sizeof(OGRGeometry*));
+            for( int i = 0; i < nCount; i++ )
+            {
+                const CPLXMLNode* apsGeometry[2];
+                apsGeometry[0] = poFeature->GetGeometryRef(i);
+                apsGeometry[1] = NULL;
+                if( apsGeometry[0] == NULL )
+                    continue;
+                papoGeom[i] = GML_BuildOGRGeometryFromList(
+                    apsGeometry, true,
+                    poJob->bInvertAxisOrderIfLatLong,
+                    pszSRSName,
+                    poJob->bConsiderEPSGAsURN,
+                    poJob->bGetSecondaryGeometryOption,
+                    hCacheSRS,
+                    poJob->bFaceHoleNegative );
+            }
+        }
+        else if( papsGeometry[0] != NULL )
+        {
+            nCount = 1;
+            papoGeom = (OGRGeometry**) CPLCalloc(1, sizeof(OGRGeometry*));
+            papoGeom[0] = GML_BuildOGRGeometryFromList(
+                    papsGeometry, true,
+                    poJob->bInvertAxisOrderIfLatLong,
+                    pszSRSName,
+                    poJob->bConsiderEPSGAsURN,
+                    poJob->bGetSecondaryGeometryOption,
+                    hCacheSRS,
+                    poJob->bFaceHoleNegative );
+        }
+
+        if( papoGeom == NULL )
+            continue;
+
+        if( poJob->nConvertErrors != nErrorsBefore )
+        {
+            for( int i = 0; i < nCount; i++ )
+                delete papoGeom[i];
+            CPLFree(papoGeom);
+        }
+        else
+        {
+            poFeature->SetOGRGeometries(nCount, papoGeom);
+        }
+    }
+    CPLPopErrorHandler();
+
+    GML_BuildOGRGeometryFromList_DestroyCache(hCacheSRS);
+
+    poJob->SetState(GMLJOB_READY);
+}
+
+/************************************************************************/
+/*                         PromoteParsedJobs()                          */
+/*                                                                      */
+/*      Submit the geometry conversion of parsed jobs. This is done in  */
+/*      document order, as the global SRS used to convert geometries    */
+/*      is the first one found in the document.                         */
+/************************************************************************/
+
+void GMLParallelReader::PromoteParsedJobs()
+
+{
+    std::vector<GMLParallelJob*> apoParsedJobs;
+
+    CPLAcquireMutex(m_hMutex, 1000.0);
+    for( std::list<GMLParallelJob*>::iterator oIter = m_apoJobs.begin();
+         oIter != m_apoJobs.end(); ++oIter )
+    {
+        GMLParallelJob* poJob = *oIter;
+        if( poJob->bPromoted )
+            continue;
+        if( poJob->eState != GMLJOB_PARSED )
+            break;
+        poJob->bPromoted = true;
+        poJob->eState = GMLJOB_CONVERTING;
+        apoParsedJobs.push_back(poJob);
+    }
+    CPLReleaseMutex(m_hMutex);
+
+    for( size_t i = 0; i < apoParsedJobs.size(); i++ )
+    {
+        GMLParallelJob* poJob = apoParsedJobs[i];
+
+        if( m_poReader->m_pszGlobalSRSName == NULL && poJob->bHasGlobalSRSName )
+            m_poReader->m_pszGlobalSRSName = CPLStrdup(poJob->osGlobalSRSName);
+
+        /* Same logic as OGRGMLDataSource::GetGlobalSRSName() */
+        const char* pszSRSName =
+            ( m_poReader->CanUseGlobalSRSName() || m_bUseGlobalSRSName ) ?
+                                m_poReader->GetGlobalSRSName() : NULL;
+        poJob->bHasSRSName = pszSRSName != NULL;
+        if( pszSRSName != NULL )
+            poJob->osSRSName = pszSRSName;
+        poJob->bInvertAxisOrderIfLatLong = m_poReader->m_bInvertAxisOrderIfLatLong;
+        poJob->bConsiderEPSGAsURN = m_poReader->m_bConsiderEPSGAsURN;
+        poJob->bGetSecondaryGeometryOption =
+                                    m_poReader->m_bGetSecondaryGeometryOption;
+        poJob->bFaceHoleNegative = m_poReader->m_bFaceHoleNegative;
+
+        if( m_poPool != NULL )
+            m_poPool->SubmitJob(ConvertJobFunc, poJob);
+        else
+            ConvertJobFunc(poJob);
+    }
+}
+
+/************************************************************************/
+/*                             ReleaseJob()                             */
+/************************************************************************/
+
+void GMLParallelReader::ReleaseJob( GMLParallelJob* poJob )
+
+{
+    for( size_t i = poJob->iNextFeature; i < poJob->apoFeatures.size(); i++ )
+        delete poJob->apoFeatures[i];
+    m_apoFreeJobReaders.push_back(poJob->poJobReader);
+    delete poJob;
+}
+
+/************************************************************************/
+/*                            NextFeature()                             */
+/************************************************************************/
+
+GMLFeature *GMLParallelReader::NextFeature()
+
+{
+    while( true )
+    {
+        /* Keep enough pieces in flight to feed all threads */
+        while( !m_bScanDone && (int)m_apoJobs.size() < 2 * m_nThreads )
+            ScanNextJobs();
+
+        if( m_apoJobs.empty() )
+            return NULL;
+
+        GMLParallelJob* poJob = m_apoJobs.front();
+
+/* -------------------------------------------------------------------- */
+/*      Wait for the oldest job to be ready, and start the geometry     */
+/*      conversion of jobs as soon as their parsing is completed.       */
+/* -------------------------------------------------------------------- */
+        while( true )
+        {
+            PromoteParsedJobs();
+
+            CPLAcquireMutex(m_hMutex, 1000.0);
+            if( poJob->eState == GMLJOB_READY )
+            {
+                CPLReleaseMutex(m_hMutex);
+                break;
+            }
+            bool bCanPromote = false;
+            for( std::list<GMLParallelJob*>::iterator oIter = m_apoJobs.begin();
+                 oIter != m_apoJobs.end(); ++oIter )
+            {
+                if( (*oIter)->bPromoted )
+                    continue;
+                bCanPromote = (*oIter)->eState == GMLJOB_PARSED;
+                break;
+            }
+            if( !bCanPromote )
+                CPLCondWait(m_hCond, m_hMutex);
+            CPLReleaseMutex(m_hMutex);
+        }
+
+        if( !poJob->bErrorsEmitted )
+        {
+            poJob->bErrorsEmitted = true;
+            for( size_t i = 0; i < poJob->aoErrors.size(); i++ )
+            {
+                CPLError( poJob->aoErrors[i].eErrClass,
+                          poJob->aoErrors[i].nErrNo,
+                          "%s", poJob->aoErrors[i].osMsg.c_str() );
+            }
+        }
+
+        if( poJob->iNextFeature < poJob->apoFeatures.size() )
+            return poJob->apoFeatures[poJob->iNextFeature++];
+
+/* -------------------------------------------------------------------- */
+/*      All features of this job have been returned. Report its         */
+/*      parsing error, translating the position to the one in the      */
+/*      file, and stop there.                                           */
+/* -------------------------------------------------------------------- */
+        const bool bParseOK = poJob->bParseOK;
+        if( !bParseOK && !poJob->osError.empty() )
+        {
+            int nLine = poJob->nErrorLine;
+            int nColumn = poJob->nErrorColumn;
+            if( nLine == 1 )
+            {
+                nLine = poJob->nStartLine;
+                nColumn = poJob->nStartColumn +
+                    MAX(0, nColumn - (int)poJob->nPrefixLen);
+            }
+            else
+            {
+                nLine += poJob->nStartLine - 1;
+            }
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "XML parsing of GML file failed : %s "
+                     "at line %d, column %d",
+                     poJob->osError.c_str(), nLine, nColumn);
+        }
+
+        m_apoJobs.pop_front();
+        ReleaseJob(poJob);
+
+        if( !bParseOK )
+        {
+            m_poReader->m_bStopParsing = true;
+            return NULL;
+        }
+    }
+}
+
+#endif /* HAVE_EXPAT */
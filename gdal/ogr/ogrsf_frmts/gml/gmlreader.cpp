@@ -153,6 +153,7 @@ CPL_UNUSED
     nFeatureTabLength = 0;
     nFeatureTabAlloc = 0;
     pabyBuf = NULL;
+    m_poParallelReader = NULL;
 #endif
     fpGML = NULL;
     m_bReadStarted = false;
@@ -188,6 +189,10 @@ CPL_UNUSED
 
     m_bIsWFSJointLayer = false;
     m_bEmptyAsNull = true;
+
+    m_nNumThreads = 1;
+    m_bParallelUseGlobalSRSName = false;
+    m_bSharedClasses = false;
 }
 
 /************************************************************************/
@@ -197,6 +202,13 @@ CPL_UNUSED
 GMLReader::~GMLReader()
 
 {
+    /* Classes borrowed from the reader that created this job reader */
+    if( m_bSharedClasses )
+    {
+        CPLFree( m_papoClass );
+        m_papoClass = NULL;
+        m_nClassCount = 0;
+    }
     ClearClasses();
 
     CPLFree( m_pszFilename );
@@ -427,6 +439,11 @@ bool GMLReader::SetupParserExpat()
 void GMLReader::CleanupParser()
 
 {
+#ifdef HAVE_EXPAT
+    delete m_poParallelReader;
+    m_poParallelReader = NULL;
+#endif
+
 #ifdef HAVE_XERCES
     if( !bUseExpatReader && m_poSAXReader == NULL )
         return;
@@ -597,11 +614,27 @@ GMLFeature *GMLReader::NextFeatureExpat()
             SetupParser();
 
         m_bReadStarted = true;
+
+        if( fpGML != NULL && CanReadInParallel() )
+        {
+            m_poParallelReader = new GMLParallelReader(
+                this, fpGML, m_nNumThreads, m_bParallelUseGlobalSRSName );
+            /* The pieces could not be parsed without the DTD */
+            if( m_poParallelReader->HasDoctype() )
+            {
+                delete m_poParallelReader;
+                m_poParallelReader = NULL;
+                VSIFSeekL( fpGML, 0, SEEK_SET );
+            }
+        }
     }
 
     if (fpGML == NULL || m_bStopParsing)
         return NULL;
 
+    if( m_poParallelReader != NULL )
+        return m_poParallelReader->NextFeature();
+
     if (nFeatureTabIndex < nFeatureTabLength)
     {
         return ppoFeatureTab[nFeatureTabIndex++];
@@ -648,6 +681,134 @@ GMLFeature *GMLReader::NextFeatureExpat()
 }
 #endif
 
+/************************************************************************/
+/*                          SetNumThreads()                             */
+/************************************************************************/
+
+void GMLReader::SetNumThreads( int nThreads, bool bUseGlobalSRSName )
+{
+    m_nNumThreads = nThreads;
+    m_bParallelUseGlobalSRSName = bUseGlobalSRSName;
+}
+
+#ifdef HAVE_EXPAT
+
+/************************************************************************/
+/*                         CanReadInParallel()                          */
+/*                                                                      */
+/*      The parallel reader shares the feature classes between the      */
+/*      worker threads, which is only safe if parsing cannot alter      */
+/*      them, that is to say if the class list and all the class        */
+/*      schemas are locked.                                             */
+/************************************************************************/
+
+bool GMLReader::CanReadInParallel() const
+{
+    if( m_nNumThreads <= 1 || !bUseExpatReader || !m_bClassListLocked ||
+        m_nClassCount == 0 )
+        return false;
+    for( int i = 0; i < m_nClassCount; i++ )
+    {
+        if( !m_papoClass[i]->IsSchemaLocked() )
+            return false;
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                          CreateJobReader()                           */
+/*                                                                      */
+/*      Create a reader that parses in-memory pieces of the GML file    */
+/*      on behalf of the parallel reader, sharing our feature classes.  */
+/************************************************************************/
+
+GMLReader* GMLReader::CreateJobReader() const
+{
+    GMLReader* poJobReader = new GMLReader( true,
+                                            m_bInvertAxisOrderIfLatLong,
+                                            m_bConsiderEPSGAsURN,
+                                            m_bGetSecondaryGeometryOption );
+    poJobReader->m_bSharedClasses = true;
+    poJobReader->m_nClassCount = m_nClassCount;
+    poJobReader->m_papoClass = (GMLFeatureClass **)
+        CPLMalloc( sizeof(void*) * m_nClassCount );
+    memcpy( poJobReader->m_papoClass, m_papoClass,
+            sizeof(void*) * m_nClassCount );
+    poJobReader->m_bLookForClassAtAnyLevel = m_bLookForClassAtAnyLevel;
+    poJobReader->m_bClassListLocked = true;
+    poJobReader->SetFilteredClassName( m_pszFilteredClassName );
+    poJobReader->m_bFetchAllGeometries = m_bFetchAllGeometries;
+    poJobReader->m_bFaceHoleNegative = m_bFaceHoleNegative;
+    poJobReader->m_bSetWidthFlag = m_bSetWidthFlag;
+    poJobReader->m_bReportAllAttributes = m_bReportAllAttributes;
+    poJobReader->m_bIsWFSJointLayer = m_bIsWFSJointLayer;
+    poJobReader->m_bEmptyAsNull = m_bEmptyAsNull;
+    return poJobReader;
+}
+
+/************************************************************************/
+/*                          ParseJobBuffer()                            */
+/*                                                                      */
+/*      Parse a self-contained XML document held in memory, and append  */
+/*      the features found to apoFeatures. Returns false if the         */
+/*      parsing failed, in which case osError is filled with the XML    */
+/*      error, if that is the cause.                                    */
+/************************************************************************/
+
+bool GMLReader::ParseJobBuffer( const char* pabyData, size_t nDataLen,
+                                const char* pszEncoding,
+                                std::vector<GMLFeature*>& apoFeatures,
+                                CPLString& osError,
+                                int& nErrorLine, int& nErrorColumn )
+{
+    CleanupParser();
+    m_bStopParsing = false;
+
+    if( !SetupParserExpat() )
+    {
+        osError = "Out of memory";
+        return false;
+    }
+    if( pszEncoding != NULL )
+        XML_SetEncoding( oParser, pszEncoding );
+
+    PushState( m_poRecycledState ? m_poRecycledState : new GMLReadState() );
+    m_poRecycledState = NULL;
+
+    size_t nOffset = 0;
+    do
+    {
+        /* Reset counter that is used to detect billion laugh attacks */
+        ((GMLExpatHandler*)m_poGMLHandler)->ResetDataHandlerCounter();
+
+        const size_t nLen = MIN( (size_t)PARSER_BUF_SIZE, nDataLen - nOffset );
+        const bool bDone = ( nOffset + nLen == nDataLen );
+        if( XML_Parse( oParser, pabyData + nOffset, (int)nLen, bDone ) ==
+                                                        XML_STATUS_ERROR )
+        {
+            osError = XML_ErrorString(XML_GetErrorCode(oParser));
+            nErrorLine = (int)XML_GetCurrentLineNumber(oParser);
+            nErrorColumn = (int)XML_GetCurrentColumnNumber(oParser);
+            m_bStopParsing = true;
+        }
+        if( !m_bStopParsing )
+            m_bStopParsing = ((GMLExpatHandler*)m_poGMLHandler)->HasStoppedParsing();
+
+        for( int i = 0; i < nFeatureTabLength; i++ )
+            apoFeatures.push_back( ppoFeatureTab[i] );
+        nFeatureTabLength = 0;
+        nFeatureTabIndex = 0;
+
+        nOffset += nLen;
+    } while( nOffset < nDataLen && !m_bStopParsing );
+
+    const bool bRet = !m_bStopParsing;
+    CleanupParser();
+    return bRet;
+}
+
+#endif /* HAVE_EXPAT */
+
 GMLFeature *GMLReader::NextFeature()
 {
 #ifdef HAVE_EXPAT
@@ -37,6 +37,8 @@
 
 #include <vector>
 
+class OGRGeometry;
+
 typedef enum {
     GMLPT_Untyped = 0,
     GMLPT_String = 1,
@@ -238,6 +240,10 @@ class CPL_DLL GMLFeature
     // string list of named non-schema properties - used by NAS driver.
     char           **m_papszOBProperties;
 
+    // OGR geometries built ahead of time by the parallel reader.
+    int              m_nOGRGeometryCount;
+    OGRGeometry    **m_papoOGRGeometry;
+
 public:
                     GMLFeature( GMLFeatureClass * );
                    ~GMLFeature();
@@ -250,6 +256,10 @@ public:
     const CPLXMLNode* const * GetGeometryList() const { return m_papsGeometry; }
     const CPLXMLNode* GetGeometryRef( int nIdx ) const;
 
+    void            SetOGRGeometries( int nCount, OGRGeometry** papoGeom );
+    int             GetOGRGeometryCount() const { return m_nOGRGeometryCount; }
+    OGRGeometry    *StealOGRGeometry( int nIdx );
+
     void            SetPropertyDirectly( int i, char *pszValue );
 
     const GMLProperty*GetProperty( int i ) const { return (i < m_nPropertyCount) ? &m_pasProperties[i] : NULL; }
@@ -317,6 +327,9 @@ public:
     virtual const char* GetFilteredClassName() = 0;
 
     virtual bool IsSequentialLayers() const { return false; }
+
+    virtual void SetNumThreads( CPL_UNUSED int nThreads,
+                                CPL_UNUSED bool bUseGlobalSRSName ) {}
 };
 
 IGMLReader *CreateGMLReader(bool bUseExpatParserPreferably,
@@ -41,13 +41,16 @@
 #include "ogr_api.h"
 #include "cpl_vsi.h"
 #include "cpl_multiproc.h"
+#include "cpl_string.h"
 
+#include <list>
 #include <string>
 #include <vector>
 
 #define PARSER_BUF_SIZE (10*8192)
 
 class GMLReader;
+class GMLParallelReader;
 
 typedef struct _GeometryNamesStruct GeometryNamesStruct;
 
@@ -378,6 +381,8 @@ typedef enum
 
 class GMLReader : public IGMLReader
 {
+    friend class GMLParallelReader;
+
 private:
     static OGRGMLXercesState    m_eXercesInitState;
     static int    m_nInstanceCount;
@@ -412,6 +417,15 @@ private:
     bool          SetupParserExpat();
     GMLFeature   *NextFeatureExpat();
     char         *pabyBuf;
+
+    GMLParallelReader *m_poParallelReader;
+    bool          CanReadInParallel() const;
+    GMLReader    *CreateJobReader() const;
+    bool          ParseJobBuffer( const char* pabyData, size_t nDataLen,
+                                  const char* pszEncoding,
+                                  std::vector<GMLFeature*>& apoFeatures,
+                                  CPLString& osError,
+                                  int& nErrorLine, int& nErrorColumn );
 #endif
 
     VSILFILE*     fpGML;
@@ -455,6 +469,10 @@ private:
 
     bool          m_bEmptyAsNull;
 
+    int           m_nNumThreads;
+    bool          m_bParallelUseGlobalSRSName;
+    bool          m_bSharedClasses;
+
     bool          ParseXMLHugeFile( const char *pszOutputFilename,
                                     const bool bSqliteIsTempFile,
                                     const int iSqliteCacheMB );
@@ -547,7 +565,105 @@ public:
     void             SetEmptyAsNull( bool bFlag ) { m_bEmptyAsNull = bFlag; }
     bool             IsEmptyAsNull() const { return m_bEmptyAsNull; }
 
+    void             SetNumThreads( int nThreads, bool bUseGlobalSRSName );
+
     static CPLMutex* hMutex;
 };
 
+#if defined(HAVE_EXPAT)
+
+/************************************************************************/
+/*                          GMLParallelReader                           */
+/*                                                                      */
+/*      Splits the GML stream between feature members and parses and   */
+/*      converts each piece in a worker thread. Features are returned   */
+/*      in document order. Only used with the Expat parser, and when    */
+/*      the schema is locked, so that worker threads never modify the   */
+/*      shared feature classes.                                         */
+/************************************************************************/
+
+class CPLWorkerThreadPool;
+class GMLParallelJob;
+
+typedef struct
+{
+    GUIntBig    nOffset;
+    int         nLine;
+    int         nColumn;
+    CPLString   osOpenTags;
+    CPLString   osCloseTags;
+} GMLSplitPoint;
+
+class GMLParallelReader
+{
+    GMLReader          *m_poReader;
+    VSILFILE           *m_fp;
+    int                 m_nThreads;
+    bool                m_bUseGlobalSRSName;
+    size_t              m_nChunkSize;
+
+    CPLWorkerThreadPool *m_poPool;
+    CPLMutex           *m_hMutex;
+    CPLCond            *m_hCond;
+
+    std::list<GMLParallelJob*> m_apoJobs;
+    std::vector<GMLReader*> m_apoFreeJobReaders;
+
+    /* Pre-scan state */
+    XML_Parser          m_oScanParser;
+    char               *m_pabyBuf;
+    bool                m_bScanDone;
+    bool                m_bScanError;
+    bool                m_bCanSplit;
+    bool                m_bHasDoctype;
+    CPLString           m_osEncoding;
+    int                 m_nDepth;
+    int                 m_nContainerDepth;
+    std::vector<CPLString> m_aosTagNames;
+    std::vector<CPLString> m_aosTags;
+    CPLString           m_osContainerOpenTags;
+    CPLString           m_osContainerCloseTags;
+    GUIntBig            m_nLastSplitOffset;
+    std::vector<GMLSplitPoint> m_aoSplitPoints;
+    std::string         m_osPending;
+    GUIntBig            m_nPendingOffset;
+    int                 m_nPendingLine;
+    int                 m_nPendingColumn;
+    CPLString           m_osPendingOpenTags;
+
+    void                ScanNextJobs();
+    void                SubmitParseJob( std::string& osData );
+    void                PromoteParsedJobs();
+    void                ReleaseJob( GMLParallelJob* poJob );
+
+    static void XMLCALL startElementScanCbk( void *pUserData,
+                                             const char *pszName,
+                                             const char **ppszAttr );
+    static void XMLCALL endElementScanCbk( void *pUserData,
+                                           const char *pszName );
+    static void XMLCALL xmlDeclScanCbk( void* pUserData,
+                                        const char* pszVersion,
+                                        const char* pszEncoding,
+                                        int bStandalone );
+    static void XMLCALL startDoctypeScanCbk( void* pUserData,
+                                             const char* pszDoctypeName,
+                                             const char* pszSysId,
+                                             const char* pszPubId,
+                                             int bHasInternalSubset );
+
+    static void ParseJobFunc( void* pData );
+    static void ConvertJobFunc( void* pData );
+
+public:
+                GMLParallelReader( GMLReader* poReader, VSILFILE* fp,
+                                   int nThreads, bool bUseGlobalSRSName );
+               ~GMLParallelReader();
+
+    bool        HasDoctype() const { return m_bHasDoctype; }
+
+    GMLFeature *NextFeature();
+};
+
+#endif /* HAVE_EXPAT */
+
 #endif /* CPL_GMLREADERP_H_INCLUDED */
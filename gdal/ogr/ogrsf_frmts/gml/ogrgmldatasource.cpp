@@ -1192,6 +1192,33 @@ bool OGRGMLDataSource::Open( GDALOpenInfo* poOpenInfo )
         nLayers++;
     }
 
+/* -------------------------------------------------------------------- */
+/*      Setup multi-threaded reading if requested.                      */
+/* -------------------------------------------------------------------- */
+    const char* pszNumThreads = CSLFetchNameValueDef(
+            poOpenInfo->papszOpenOptions, "NUM_THREADS",
+                        CPLGetConfigOption("GML_NUM_THREADS", "1"));
+    int nNumThreads;
+    if( EQUAL(pszNumThreads, "ALL_CPUS") )
+        nNumThreads = CPLGetNumCPUs();
+    else
+        nNumThreads = atoi(pszNumThreads);
+    if( nNumThreads > 128 )
+        nNumThreads = 128;
+    if( nNumThreads > 1 )
+    {
+        /* The schema established by the initial scan is the one that */
+        /* would be read back from the .gfs file, so lock it as well. */
+        /* Worker threads then never modify the feature classes. */
+        if( !bHaveSchema )
+        {
+            poReader->SetClassListLocked( true );
+            for( int i = 0; i < poReader->GetClassCount(); i++ )
+                poReader->GetClass(i)->SetSchemaLocked( true );
+        }
+        poReader->SetNumThreads( nNumThreads, bUseGlobalSRSName );
+    }
+
 
 
     return true;
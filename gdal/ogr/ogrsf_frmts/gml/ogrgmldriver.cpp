@@ -189,6 +189,7 @@ void RegisterOGRGML()
 "  </Option>"
 "  <Option name='DOWNLOAD_SCHEMA' type='boolean' description='Whether to download the remote application schema if needed (only for WFS currently)' default='YES'/>"
 "  <Option name='REGISTRY' type='string' description='Filename of the registry with application schemas.'/>"
+"  <Option name='NUM_THREADS' type='string' description='Number of worker threads used to parse features, or ALL_CPUS' default='1'/>"
 "</OpenOptionList>" );
 
     poDriver->SetMetadataItem( GDAL_DMD_CREATIONOPTIONLIST,
@@ -279,6 +279,8 @@ OGRFeature *OGRGMLLayer::GetNextFeature()
             papoGeometries = (OGRGeometry**)
                 CPLCalloc( poFeatureDefn->GetGeomFieldCount(), sizeof(OGRGeometry*) );
             const char* pszSRSName = poDS->GetGlobalSRSName();
+            const bool bHasOGRGeometries =
+                poGMLFeature->GetOGRGeometryCount() == poFeatureDefn->GetGeomFieldCount();
             for( int i=0; i < poFeatureDefn->GetGeomFieldCount(); i++ )
             {
                 const CPLXMLNode* psGeom = poGMLFeature->GetGeometryRef(i);
@@ -287,7 +289,11 @@ OGRFeature *OGRGMLLayer::GetNextFeature()
                     const CPLXMLNode* myGeometryList[2];
                     myGeometryList[0] = psGeom;
                     myGeometryList[1] = NULL;
-                    poGeom = GML_BuildOGRGeometryFromList(myGeometryList, true,
+                    /* Use the geometry built by the parallel reader if any */
+                    if( bHasOGRGeometries )
+                        poGeom = poGMLFeature->StealOGRGeometry(i);
+                    if( poGeom == NULL )
+                        poGeom = GML_BuildOGRGeometryFromList(myGeometryList, true,
                                                   poDS->GetInvertAxisOrderIfLatLong(),
                                                   pszSRSName,
                                                   poDS->GetConsiderEPSGAsURN(),
@@ -335,7 +341,11 @@ OGRFeature *OGRGMLLayer::GetNextFeature()
         else if (papsGeometry[0] != NULL)
         {
             const char* pszSRSName = poDS->GetGlobalSRSName();
-            poGeom = GML_BuildOGRGeometryFromList(papsGeometry, true,
+            /* Use the geometry built by the parallel reader if any */
+            if( poGMLFeature->GetOGRGeometryCount() == 1 )
+                poGeom = poGMLFeature->StealOGRGeometry(0);
+            if( poGeom == NULL )
+                poGeom = GML_BuildOGRGeometryFromList(papsGeometry, true,
                                                   poDS->GetInvertAxisOrderIfLatLong(),
                                                   pszSRSName,
                                                   poDS->GetConsiderEPSGAsURN(),
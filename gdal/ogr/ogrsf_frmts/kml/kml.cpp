@@ -32,6 +32,7 @@
 #include "cpl_error.h"
 #include "cpl_conv.h"
 // std
+#include <algorithm>
 #include <cerrno>
 #include <cstdio>
 #include <iostream>
@@ -47,11 +48,24 @@ KML::KML() :
     poCurrent_(NULL),
     oCurrentParser(NULL),
     nDataHandlerCounter(0),
-    nWithoutEventCounter(0)
+    nWithoutEventCounter(0),
+    bStreaming_(false),
+    bStreamingError_(false),
+    poStreamLayer_(NULL),
+    oStreamParser_(NULL),
+    nStreamPos_(0),
+    nStreamNextFeature_(0),
+    bStreamEOF_(false),
+    poStreamTrunk_(NULL),
+    poStreamCurrent_(NULL),
+    nStreamDepth_(0),
+    nStreamLevel_(0),
+    nStreamSkipDepth_(0)
 { }
 
 KML::~KML()
 {
+    resetStream();
     if( NULL != pKMLFile_ )
         VSIFCloseL(pKMLFile_);
     CPLFree(papoLayers_);
@@ -95,8 +109,12 @@ void KML::parse()
     XML_SetUserData(oParser, this);
     XML_SetElementHandler(oParser, startElement, endElement);
     XML_SetCharacterDataHandler(oParser, dataHandler);
+    if( bStreaming_ )
+        XML_SetXmlDeclHandler(oParser, xmlDeclHandler);
     oCurrentParser = oParser;
     nWithoutEventCounter = 0;
+    bStreamingError_ = false;
+    resetStream();
 
     do
     {
@@ -226,6 +244,13 @@ void XMLCALL KML::startElement( void* pUserData, const char* pszName,
             poMynew->setName(pszName);
         poMynew->setLevel(poKML->nDepth_);
 
+        if( poKML->bStreaming_ && poKML->isContainer(poMynew->getName()) )
+        {
+            const vsi_l_offset nStart = static_cast<vsi_l_offset>(
+                XML_GetCurrentByteIndex(poKML->oCurrentParser));
+            poMynew->setStreamOffsets(nStart, nStart);
+        }
+
         for( int i = 0; ppszAttr[i]; i += 2 )
         {
             Attribute* poAtt = new Attribute();
@@ -440,11 +465,39 @@ void XMLCALL KML::endElement(void* pUserData, const char* pszName)
         else
             poKML->poCurrent_ = NULL;
 
+        if( poKML->bStreaming_ && poKML->isContainer(poTmp->getName()) )
+        {
+            // Remember where the container ends, just after its end tag.
+            const vsi_l_offset nEnd = static_cast<vsi_l_offset>(
+                XML_GetCurrentByteIndex(poKML->oCurrentParser) +
+                XML_GetCurrentByteCount(poKML->oCurrentParser));
+            poTmp->setStreamOffsets(poTmp->getStreamStartOffset(),
+                                    std::max(nEnd,
+                                             poTmp->getStreamStartOffset()));
+        }
+
         if(!poKML->isHandled(pszName))
         {
             CPLDebug("KML", "Not handled: %s", pszName);
             delete poTmp;
         }
+        else if( poKML->bStreaming_ && poKML->poCurrent_ != NULL &&
+                 poTmp->getName().compare("Placemark") == 0 &&
+                 poKML->isContainer(poKML->poCurrent_->getName()) )
+        {
+            // Only keep a summary of the Placemark in its container. It will
+            // be parsed again when the features of the layer are read.
+            if( poTmp->classify(poKML, static_cast<int>(poTmp->getLevel())) )
+            {
+                poKML->poCurrent_->addStreamedFeature(poTmp);
+            }
+            else
+            {
+                poKML->bStreamingError_ = true;
+                XML_StopParser(poKML->oCurrentParser, XML_FALSE);
+            }
+            delete poTmp;
+        }
         else
         {
             if(poKML->poCurrent_ != NULL)
@@ -514,6 +567,8 @@ std::string KML::getError() const
 
 int KML::classifyNodes()
 {
+    if( bStreamingError_ )
+        return FALSE;
     return poTrunk_->classify(this);
 }
 
@@ -620,5 +675,255 @@ Feature* KML::getFeature(std::size_t nNum, int& nLastAsked, int &nLastCount)
     if(poCurrent_ == NULL)
         return NULL;
 
+    if( bStreaming_ )
+    {
+        if( nNum >= poCurrent_->getNumFeatures() )
+            return NULL;
+        return getStreamedFeature(nNum);
+    }
+
     return poCurrent_->getFeature(nNum, nLastAsked, nLastCount);
 }
+
+/************************************************************************/
+/*                           xmlDeclHandler()                           */
+/************************************************************************/
+
+void XMLCALL KML::xmlDeclHandler( void* pUserData,
+                                  const char* /* pszVersion */,
+                                  const char* pszEncoding,
+                                  int /* nStandalone */ )
+{
+    KML* poKML = static_cast<KML *>(pUserData);
+
+    if( pszEncoding != NULL )
+        poKML->sEncoding_ = pszEncoding;
+}
+
+/************************************************************************/
+/*                            resetStream()                             */
+/************************************************************************/
+
+void KML::resetStream()
+{
+    if( oStreamParser_ != NULL )
+    {
+        XML_ParserFree(oStreamParser_);
+        oStreamParser_ = NULL;
+    }
+
+    while( !apoStreamFeatures_.empty() )
+    {
+        delete apoStreamFeatures_.front();
+        apoStreamFeatures_.pop_front();
+    }
+
+    delete poStreamTrunk_;
+    poStreamTrunk_ = NULL;
+    poStreamCurrent_ = NULL;
+    poStreamLayer_ = NULL;
+    nStreamNextFeature_ = 0;
+    bStreamEOF_ = true;
+}
+
+/************************************************************************/
+/*                            startStream()                             */
+/*                                                                      */
+/*      Prepare parsing the byte range of a layer container. Only the   */
+/*      Placemark elements that are direct children of the container   */
+/*      are built, one at a time.                                       */
+/************************************************************************/
+
+void KML::startStream(KMLNode* poLayer)
+{
+    resetStream();
+
+    poStreamLayer_ = poLayer;
+    nStreamPos_ = poLayer->getStreamStartOffset();
+    bStreamEOF_ = false;
+    nStreamDepth_ = static_cast<unsigned int>(poLayer->getLevel()) + 1;
+    nStreamLevel_ = 0;
+    nStreamSkipDepth_ = 0;
+
+    oStreamParser_ = OGRCreateExpatXMLParser();
+    if( !sEncoding_.empty() )
+        XML_SetEncoding(oStreamParser_, sEncoding_.c_str());
+    XML_SetUserData(oStreamParser_, this);
+    XML_SetElementHandler(oStreamParser_, startElementStream,
+                          endElementStream);
+    XML_SetCharacterDataHandler(oStreamParser_, dataHandlerStream);
+}
+
+/************************************************************************/
+/*                          readStreamChunk()                           */
+/************************************************************************/
+
+void KML::readStreamChunk()
+{
+    const vsi_l_offset nEnd = poStreamLayer_->getStreamEndOffset();
+    if( nStreamPos_ >= nEnd )
+    {
+        bStreamEOF_ = true;
+        return;
+    }
+
+    char aBuf[BUFSIZ] = { 0 };
+    const size_t nToRead = static_cast<size_t>(
+        std::min(static_cast<vsi_l_offset>(sizeof(aBuf)), nEnd - nStreamPos_));
+    size_t nLen = 0;
+    if( VSIFSeekL(pKMLFile_, nStreamPos_, SEEK_SET) == 0 )
+        nLen = VSIFReadL(aBuf, 1, nToRead, pKMLFile_);
+    nStreamPos_ += nLen;
+    const int nDone = nLen < nToRead || nStreamPos_ >= nEnd;
+
+    // The tree building callbacks work on poTrunk_, poCurrent_ and nDepth_,
+    // which hold the layer structure. Swap in the state of the Placemark
+    // being built for the duration of the parsing.
+    std::swap(poTrunk_, poStreamTrunk_);
+    std::swap(poCurrent_, poStreamCurrent_);
+    std::swap(nDepth_, nStreamDepth_);
+    oCurrentParser = oStreamParser_;
+    nDataHandlerCounter = 0;
+
+    if( XML_Parse(oStreamParser_, aBuf, static_cast<int>(nLen), nDone) ==
+                                                        XML_STATUS_ERROR )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "XML parsing of KML file failed : %s at offset "
+                  CPL_FRMT_GUIB,
+                  XML_ErrorString(XML_GetErrorCode(oStreamParser_)),
+                  static_cast<GUIntBig>(
+                      poStreamLayer_->getStreamStartOffset() +
+                      XML_GetCurrentByteIndex(oStreamParser_)) );
+        bStreamEOF_ = true;
+    }
+
+    std::swap(poTrunk_, poStreamTrunk_);
+    std::swap(poCurrent_, poStreamCurrent_);
+    std::swap(nDepth_, nStreamDepth_);
+    oCurrentParser = NULL;
+
+    if( nDone )
+        bStreamEOF_ = true;
+}
+
+/************************************************************************/
+/*                         getStreamedFeature()                         */
+/************************************************************************/
+
+Feature* KML::getStreamedFeature(std::size_t nNum)
+{
+    if( poStreamLayer_ != poCurrent_ || nNum < nStreamNextFeature_ )
+        startStream(poCurrent_);
+
+    while( true )
+    {
+        while( apoStreamFeatures_.empty() && !bStreamEOF_ )
+            readStreamChunk();
+        if( apoStreamFeatures_.empty() )
+            return NULL;
+
+        KMLNode* poFeat = apoStreamFeatures_.front();
+        apoStreamFeatures_.pop_front();
+
+        if( !poFeat->classify(this, static_cast<int>(poFeat->getLevel())) )
+        {
+            delete poFeat;
+            return NULL;
+        }
+
+        // Empty Placemarks have been removed from the tree by
+        // eliminateEmpty() in the non streaming case.
+        if( poStreamLayer_->isStreamedEmptyEliminated() &&
+            poFeat->getType() == Empty )
+        {
+            delete poFeat;
+            continue;
+        }
+
+        Feature* psFeature = NULL;
+        if( nStreamNextFeature_ == nNum )
+            psFeature = poFeat->getPlacemarkFeature();
+        nStreamNextFeature_ ++;
+        delete poFeat;
+
+        if( nStreamNextFeature_ > nNum )
+            return psFeature;
+    }
+}
+
+/************************************************************************/
+/*                         startElementStream()                         */
+/************************************************************************/
+
+void XMLCALL KML::startElementStream( void* pUserData, const char* pszName,
+                                      const char** ppszAttr )
+{
+    KML* poKML = static_cast<KML*>(pUserData);
+
+    poKML->nStreamLevel_ ++;
+    if( poKML->nStreamSkipDepth_ > 0 )
+    {
+        poKML->nStreamSkipDepth_ ++;
+        return;
+    }
+
+    if( poKML->poTrunk_ == NULL )
+    {
+        // Level 1 is the layer container itself. Only its Placemark
+        // children are features of the layer: nested containers are
+        // other layers.
+        if( poKML->nStreamLevel_ == 1 )
+            return;
+        if( poKML->nStreamLevel_ != 2 || strcmp(pszName, "Placemark") != 0 )
+        {
+            poKML->nStreamSkipDepth_ = 1;
+            return;
+        }
+    }
+
+    startElement(pUserData, pszName, ppszAttr);
+}
+
+/************************************************************************/
+/*                          endElementStream()                          */
+/************************************************************************/
+
+void XMLCALL KML::endElementStream( void* pUserData, const char* pszName )
+{
+    KML* poKML = static_cast<KML*>(pUserData);
+
+    poKML->nStreamLevel_ --;
+    if( poKML->nStreamSkipDepth_ > 0 )
+    {
+        poKML->nStreamSkipDepth_ --;
+        return;
+    }
+
+    if( poKML->poTrunk_ == NULL )
+        return;
+
+    endElement(pUserData, pszName);
+
+    // End of the Placemark ?
+    if( poKML->poCurrent_ == NULL )
+    {
+        poKML->apoStreamFeatures_.push_back(poKML->poTrunk_);
+        poKML->poTrunk_ = NULL;
+    }
+}
+
+/************************************************************************/
+/*                         dataHandlerStream()                          */
+/************************************************************************/
+
+void XMLCALL KML::dataHandlerStream( void* pUserData, const char* pszData,
+                                     int nLen )
+{
+    KML* poKML = static_cast<KML*>(pUserData);
+
+    if( poKML->nStreamSkipDepth_ > 0 || poKML->poTrunk_ == NULL )
+        return;
+
+    dataHandler(pUserData, pszData, nLen);
+}
@@ -34,6 +34,7 @@
 #include "cpl_vsi.h"
 
 // std
+#include <deque>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -65,6 +66,8 @@ public:
 	KML();
 	virtual ~KML();
 	bool open(const char* pszFilename);
+    void setStreaming(bool bStreaming) { bStreaming_ = bStreaming; }
+    bool isStreaming() const { return bStreaming_; }
 	bool isValid();
 	bool isHandled(std::string const& elem) const;
 	virtual bool isLeaf(std::string const& elem) const;
@@ -97,6 +100,12 @@ protected:
 	static void XMLCALL dataHandler(void *, const char *, int);
         static void XMLCALL dataHandlerValidate(void *, const char *, int);
 	static void XMLCALL endElement(void *, const char *);
+    static void XMLCALL xmlDeclHandler(void *, const char *, const char *,
+                                       int);
+    static void XMLCALL startElementStream(void *, const char *,
+                                           const char **);
+    static void XMLCALL endElementStream(void *, const char *);
+    static void XMLCALL dataHandlerStream(void *, const char *, int);
 
 	// trunk of KMLnodes
 	KMLNode* poTrunk_;
@@ -121,6 +130,35 @@ private:
         XML_Parser oCurrentParser;
         int nDataHandlerCounter;
         int nWithoutEventCounter;
+
+    // Streaming mode: Placemarks are not kept in the tree by parse(), but
+    // re-parsed from the byte range of their layer container when read.
+    void resetStream();
+    void startStream(KMLNode* poLayer);
+    void readStreamChunk();
+    Feature* getStreamedFeature(std::size_t nNum);
+
+    bool bStreaming_;
+    bool bStreamingError_;
+    // encoding from the XML declaration, to parse byte ranges with
+    std::string sEncoding_;
+    // layer container being streamed and its parser
+    KMLNode *poStreamLayer_;
+    XML_Parser oStreamParser_;
+    vsi_l_offset nStreamPos_;
+    std::size_t nStreamNextFeature_;
+    bool bStreamEOF_;
+    // Placemarks completely parsed but not yet returned
+    std::deque<KMLNode*> apoStreamFeatures_;
+    // state of the Placemark being built, swapped with poTrunk_,
+    // poCurrent_ and nDepth_ while the stream parser runs
+    KMLNode *poStreamTrunk_;
+    KMLNode *poStreamCurrent_;
+    unsigned int nStreamDepth_;
+    // element depth inside the layer container, and depth of the
+    // element being skipped (if not zero)
+    int nStreamLevel_;
+    int nStreamSkipDepth_;
 };
 
 #endif /* OGR_KML_KML_H_INCLUDED */
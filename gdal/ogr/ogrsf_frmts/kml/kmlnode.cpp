@@ -119,7 +119,15 @@ KMLNode::KMLNode() :
     eType_(Unknown),
     b25D_(false),
     nLayerNumber_(-1),
-    nNumFeatures_(-1)
+    nNumFeatures_(-1),
+    nStreamedFeatures_(0),
+    nStreamedNonEmptyFeatures_(0),
+    eStreamedType_(Empty),
+    bStreamedMixed_(false),
+    bStreamed25D_(false),
+    bStreamedEliminated_(false),
+    nStreamStartOffset_(0),
+    nStreamEndOffset_(0)
 {}
 
 KMLNode::~KMLNode()
@@ -303,6 +311,22 @@ int KMLNode::classify(KML* poKML, int nRecLevel)
         }
     }
 
+    // Merge the summary of the Placemark children dropped while streaming
+    if( nStreamedFeatures_ > 0 )
+    {
+        b25D_ |= bStreamed25D_;
+        if( bStreamedMixed_ ||
+            (eStreamedType_ != all && all != Empty &&
+             eStreamedType_ != Empty) )
+        {
+            eType_ = Mixed;
+        }
+        else if( eStreamedType_ != Empty )
+        {
+            all = eStreamedType_;
+        }
+    }
+
     if(eType_ == Unknown)
     {
         if (sName_.compare("MultiGeometry") == 0)
@@ -331,6 +355,9 @@ int KMLNode::classify(KML* poKML, int nRecLevel)
 
 void KMLNode::eliminateEmpty(KML* poKML)
 {
+    // Empty streamed Placemarks will be skipped when reading the features
+    bStreamedEliminated_ = true;
+
     for(kml_nodes_t::size_type z = 0; z < pvpoChildren_->size(); z++)
     {
         if((*pvpoChildren_)[z]->eType_ == Empty
@@ -350,6 +377,9 @@ void KMLNode::eliminateEmpty(KML* poKML)
 
 bool KMLNode::hasOnlyEmpty() const
 {
+    if( nStreamedNonEmptyFeatures_ > 0 )
+        return false;
+
     for(kml_nodes_t::size_type z = 0; z < pvpoChildren_->size(); z++)
     {
         if((*pvpoChildren_)[z]->eType_ != Empty)
@@ -516,6 +546,8 @@ std::size_t KMLNode::getNumFeatures()
             if( (*pvpoChildren_)[i]->sName_ == "Placemark" )
                 nNum++;
         }
+        nNum += bStreamedEliminated_ ? nStreamedNonEmptyFeatures_
+                                     : nStreamedFeatures_;
         nNumFeatures_ = (int)nNum;
     }
     return nNumFeatures_;
@@ -728,7 +760,6 @@ Feature* KMLNode::getFeature(std::size_t nNum, int& nLastAsked, int &nLastCount)
     unsigned int nCount;
     unsigned int nCountP = 0;
     KMLNode* poFeat = NULL;
-    KMLNode* poTemp = NULL;
 
     if (nLastAsked + 1 != static_cast<int>(nNum ))
     {
@@ -760,24 +791,29 @@ Feature* KMLNode::getFeature(std::size_t nNum, int& nLastAsked, int &nLastCount)
     if(poFeat == NULL)
         return NULL;
 
+    return poFeat->getPlacemarkFeature();
+}
+
+Feature* KMLNode::getPlacemarkFeature()
+{
     // Create a feature structure
     Feature *psReturn = new Feature;
     // Build up the name
-    psReturn->sName = poFeat->getNameElement();
+    psReturn->sName = getNameElement();
     // Build up the description
-    psReturn->sDescription = poFeat->getDescriptionElement();
+    psReturn->sDescription = getDescriptionElement();
     // the type
-    psReturn->eType = poFeat->eType_;
+    psReturn->eType = eType_;
 
     std::string sElementName;
-    if(poFeat->eType_ == Point ||
-       poFeat->eType_ == LineString ||
-       poFeat->eType_ == Polygon)
-        sElementName = Nodetype2String(poFeat->eType_);
-    else if (poFeat->eType_ == MultiGeometry ||
-             poFeat->eType_ == MultiPoint ||
-             poFeat->eType_ == MultiLineString ||
-             poFeat->eType_ == MultiPolygon)
+    if(eType_ == Point ||
+       eType_ == LineString ||
+       eType_ == Polygon)
+        sElementName = Nodetype2String(eType_);
+    else if (eType_ == MultiGeometry ||
+             eType_ == MultiPoint ||
+             eType_ == MultiLineString ||
+             eType_ == MultiPolygon)
         sElementName = "MultiGeometry";
     else
     {
@@ -785,12 +821,12 @@ Feature* KMLNode::getFeature(std::size_t nNum, int& nLastAsked, int &nLastCount)
         return NULL;
     }
 
-    for(nCount = 0; nCount < poFeat->pvpoChildren_->size(); nCount++)
+    for(std::size_t nCount = 0; nCount < pvpoChildren_->size(); nCount++)
     {
-        if((*poFeat->pvpoChildren_)[nCount]->sName_.compare(sElementName) == 0)
+        if((*pvpoChildren_)[nCount]->sName_.compare(sElementName) == 0)
         {
-            poTemp = (*poFeat->pvpoChildren_)[nCount];
-            psReturn->poGeom = poTemp->getGeometry(poFeat->eType_);
+            KMLNode* poTemp = (*pvpoChildren_)[nCount];
+            psReturn->poGeom = poTemp->getGeometry(eType_);
             if(psReturn->poGeom)
                 return psReturn;
             else
@@ -804,3 +840,39 @@ Feature* KMLNode::getFeature(std::size_t nNum, int& nLastAsked, int &nLastCount)
     delete psReturn;
     return NULL;
 }
+
+/************************************************************************/
+/*                        addStreamedFeature()                          */
+/*                                                                      */
+/*      Record the type of an already classified Placemark child that   */
+/*      is not kept in the tree. classify() merges this summary the     */
+/*      same way it does for regular children.                          */
+/************************************************************************/
+
+void KMLNode::addStreamedFeature(KMLNode* poPlacemark)
+{
+    nStreamedFeatures_++;
+    bStreamed25D_ |= poPlacemark->b25D_;
+
+    const Nodetype eType = poPlacemark->eType_;
+    if( eType == Empty )
+        return;
+
+    nStreamedNonEmptyFeatures_++;
+    if( eStreamedType_ != Empty && eType != eStreamedType_ )
+        bStreamedMixed_ = true;
+    else
+        eStreamedType_ = eType;
+}
+
+bool KMLNode::hasStreamedFeatures() const
+{
+    return (bStreamedEliminated_ ? nStreamedNonEmptyFeatures_
+                                 : nStreamedFeatures_) > 0;
+}
+
+void KMLNode::setStreamOffsets(vsi_l_offset nStart, vsi_l_offset nEnd)
+{
+    nStreamStartOffset_ = nStart;
+    nStreamEndOffset_ = nEnd;
+}
@@ -84,6 +84,15 @@ public:
 
     std::size_t getNumFeatures();
     Feature* getFeature(std::size_t nNum, int& nLastAsked, int &nLastCount);
+    Feature* getPlacemarkFeature();
+
+    // Streaming mode: Placemark children are summarized instead of kept
+    void addStreamedFeature(KMLNode* poPlacemark);
+    bool hasStreamedFeatures() const;
+    bool isStreamedEmptyEliminated() const { return bStreamedEliminated_; }
+    void setStreamOffsets(vsi_l_offset nStart, vsi_l_offset nEnd);
+    vsi_l_offset getStreamStartOffset() const { return nStreamStartOffset_; }
+    vsi_l_offset getStreamEndOffset() const { return nStreamEndOffset_; }
 
     OGRGeometry* getGeometry(Nodetype eType = Unknown);
 
@@ -109,6 +118,16 @@ private:
 
     int nLayerNumber_;
     int nNumFeatures_;
+
+    // Summary of the Placemark children dropped while streaming
+    int nStreamedFeatures_;
+    int nStreamedNonEmptyFeatures_;
+    Nodetype eStreamedType_;
+    bool bStreamedMixed_;
+    bool bStreamed25D_;
+    bool bStreamedEliminated_;
+    vsi_l_offset nStreamStartOffset_;
+    vsi_l_offset nStreamEndOffset_;
 };
 
 #endif /* KMLNODE_H_INCLUDED */
@@ -92,6 +92,9 @@ void KMLVector::findLayers(KMLNode* poNode, int bKeepEmptyContainers)
     }
     else if( isContainer(poNode->getName()) )
     {
+        if( poNode->hasStreamedFeatures() )
+            bEmpty = false;
+
         for( int z = 0; z < (int) poNode->countChildren(); z++ )
         {
             if( isContainer(poNode->getChild(z)->getName()) )
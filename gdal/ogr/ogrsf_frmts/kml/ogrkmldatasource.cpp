@@ -35,6 +35,10 @@
 #include "cpl_error.h"
 #include "cpl_minixml.h"
 
+/* Files larger than this are read in streaming mode unless KML_STREAMING */
+/* is set. */
+#define KML_STREAMING_THRESHOLD (100 * 1024 * 1024)
+
 /************************************************************************/
 /*                         OGRKMLDataSource()                           */
 /************************************************************************/
@@ -136,6 +140,28 @@ int OGRKMLDataSource::Open( const char * pszNewName, int bTestOpen )
 
     pszName_ = CPLStrdup( pszNewName );
 
+/* -------------------------------------------------------------------- */
+/*      Large files are read in streaming mode: the prescan only keeps  */
+/*      the container structure, and the Placemarks of a layer are      */
+/*      parsed again from its byte range when features are read.       */
+/* -------------------------------------------------------------------- */
+    const char* pszStreaming = CPLGetConfigOption("KML_STREAMING", NULL);
+    if( pszStreaming != NULL )
+    {
+        poKMLFile_->setStreaming( CPLTestBool(pszStreaming) );
+    }
+    else
+    {
+        VSIStatBufL sStatBuf;
+        if( VSIStatL( pszNewName, &sStatBuf ) == 0 &&
+            sStatBuf.st_size > KML_STREAMING_THRESHOLD )
+        {
+            poKMLFile_->setStreaming( true );
+        }
+    }
+    if( poKMLFile_->isStreaming() )
+        CPLDebug("KML", "Using streaming mode");
+
 /* -------------------------------------------------------------------- */
 /*      If we aren't sure it is KML, validate it by start parsing       */
 /* -------------------------------------------------------------------- */
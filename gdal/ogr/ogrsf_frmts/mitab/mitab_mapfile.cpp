@@ -215,6 +215,9 @@ TABMAPFile::TABMAPFile()
  */
     m_bQuickSpatialIndexMode = TRUE;
 //  m_bQuickSpatialIndexMode = FALSE;
+    m_pasBulkIndexEntries = NULL;
+    m_numBulkIndexEntries = 0;
+    m_numBulkIndexEntriesAlloc = 0;
 
     m_poCurObjBlock = NULL;
     m_nCurObjPtr = -1;
@@ -619,6 +622,11 @@ int TABMAPFile::Close()
         m_poSpIndexLeaf = NULL;
     }
 
+    CPLFree(m_pasBulkIndexEntries);
+    m_pasBulkIndexEntries = NULL;
+    m_numBulkIndexEntries = 0;
+    m_numBulkIndexEntriesAlloc = 0;
+
     if (m_poToolDefTable)
     {
         delete m_poToolDefTable;
@@ -745,6 +753,10 @@ int TABMAPFile::ReOpenReadWrite()
  * by MITAB before version 1.6.0). In this mode writing files can be
  * about 5 times faster, but spatial queries can be up to 30 times slower.
  *
+ * In quick mode, object blocks are written sequentially and the index
+ * tree is bulk-loaded from their Hilbert-sorted MBRs when the file is
+ * committed, see BuildSpatialIndexFromBulkEntries().
+ *
  * Returns 0 on success, -1 on error.
  **********************************************************************/
 int TABMAPFile::SetQuickSpatialIndexMode(GBool bQuickSpatialIndexMode/*=TRUE*/)
@@ -1394,8 +1406,9 @@ void  TABMAPFile::UpdateMapHeaderInfo(TABGeomType nObjType)
  * data block to be ready to write the object to it.
  * ... or ...
  * 2- prepare the current object data block to be ready to write the
- * object to it. If the object block is full then it is inserted in the
- * spatial index and committed to disk, and a new obj block is created.
+ * object to it. If the object block is full then its MBR is recorded for
+ * the spatial index and it is committed to disk, and a new obj block is
+ * created.
  *
  * m_poCurObjBlock will be set to be ready to receive the new object, and
  * a new block will be created if necessary (in which case the current
@@ -1996,29 +2009,30 @@ int TABMAPFile::CommitObjAndCoordBlocks(GBool bDeleteObjects /*=FALSE*/)
      * is already maintained up to date as part of inserting the objects in
      * PrepareNewObj().
      *
-     * Spatial index will be created here if it was not done yet.
+     * Until the spatial index is created, we only record the MBR of the
+     * object block: the tree will be bulk-loaded in CommitSpatialIndex().
+     * If the index already exists (e.g. the file was synced to disk in the
+     * middle of the writing), the block is inserted in it.
      *----------------------------------------------------------------*/
     if (nStatus == 0 && m_bQuickSpatialIndexMode)
     {
-        if (m_poSpIndex == NULL)
-        {
-            // Spatial Index not created yet...
-            m_poSpIndex = new TABMAPIndexBlock(m_eAccessMode);
-
-            m_poSpIndex->InitNewBlock(m_fp, m_poHeader->m_nRegularBlockSize,
-                                      m_oBlockManager.AllocNewBlock("INDEX"));
-            m_poSpIndex->SetMAPBlockManagerRef(&m_oBlockManager);
-
-            m_poHeader->m_nFirstIndexBlock = m_poSpIndex->GetNodeBlockPtr();
-        }
-
         GInt32 nXMin, nYMin, nXMax, nYMax;
         m_poCurObjBlock->GetMBR(nXMin, nYMin, nXMax, nYMax);
-        nStatus = m_poSpIndex->AddEntry(nXMin, nYMin, nXMax, nYMax,
+
+        if (m_poSpIndex == NULL)
+        {
+            nStatus = AddBulkIndexEntry(nXMin, nYMin, nXMax, nYMax,
                                         m_poCurObjBlock->GetStartAddress());
+        }
+        else
+        {
+            nStatus = m_poSpIndex->AddEntry(nXMin, nYMin, nXMax, nYMax,
+                                            m_poCurObjBlock->GetStartAddress());
 
-        m_poHeader->m_nMaxSpIndexDepth = MAX(m_poHeader->m_nMaxSpIndexDepth,
-                                      (GByte)m_poSpIndex->GetCurMaxDepth()+1);
+            m_poHeader->m_nMaxSpIndexDepth =
+                MAX(m_poHeader->m_nMaxSpIndexDepth,
+                    (GByte)m_poSpIndex->GetCurMaxDepth()+1);
+        }
     }
 
     /*-----------------------------------------------------------------
@@ -3146,6 +3160,16 @@ int TABMAPFile::CommitSpatialIndex()
         return -1;
     }
 
+    /*-------------------------------------------------------------
+     * In quick spatial index mode, build the tree from the MBRs of the
+     * object blocks written so far.
+     *------------------------------------------------------------*/
+    if (m_poSpIndex == NULL && m_numBulkIndexEntries > 0)
+    {
+        if (BuildSpatialIndexFromBulkEntries() != 0)
+            return -1;
+    }
+
     if (m_poSpIndex == NULL)
     {
         return 0;       // Nothing to do!
@@ -3166,6 +3190,290 @@ int TABMAPFile::CommitSpatialIndex()
 }
 
 
+/**********************************************************************
+ *                   TABMAPFile::AddBulkIndexEntry()
+ *
+ * Record the MBR of an object block written in quick spatial index mode.
+ * The entries are turned into an index tree only once all object blocks
+ * have been written, by BuildSpatialIndexFromBulkEntries().
+ *
+ * Also keeps the header MBR up to date so that GetExtent() works while
+ * writing.
+ *
+ * Returns 0 on success, -1 on error.
+ **********************************************************************/
+int TABMAPFile::AddBulkIndexEntry(GInt32 nXMin, GInt32 nYMin,
+                                  GInt32 nXMax, GInt32 nYMax,
+                                  GInt32 nBlockPtr)
+{
+    TABMAPIndexEntry *psEntry = NULL;
+
+    /*-----------------------------------------------------------------
+     * The current object block may be committed more than once, for
+     * instance by SyncToDisk(). Just update its MBR in that case.
+     *----------------------------------------------------------------*/
+    if (m_numBulkIndexEntries > 0 &&
+        m_pasBulkIndexEntries[m_numBulkIndexEntries-1].nBlockPtr == nBlockPtr)
+    {
+        psEntry = &m_pasBulkIndexEntries[m_numBulkIndexEntries-1];
+    }
+    else
+    {
+        if (m_numBulkIndexEntries == m_numBulkIndexEntriesAlloc)
+        {
+            int nNewAlloc = 100 + m_numBulkIndexEntriesAlloc +
+                                        m_numBulkIndexEntriesAlloc / 3;
+            TABMAPIndexEntry *pasNew = (TABMAPIndexEntry *)
+                VSIRealloc(m_pasBulkIndexEntries,
+                           nNewAlloc * sizeof(TABMAPIndexEntry));
+            if (pasNew == NULL)
+            {
+                CPLError(CE_Failure, CPLE_OutOfMemory,
+                         "Out of memory while recording spatial index "
+                         "entries.");
+                return -1;
+            }
+            m_pasBulkIndexEntries = pasNew;
+            m_numBulkIndexEntriesAlloc = nNewAlloc;
+        }
+        psEntry = &m_pasBulkIndexEntries[m_numBulkIndexEntries++];
+    }
+
+    psEntry->XMin = nXMin;
+    psEntry->YMin = nYMin;
+    psEntry->XMax = nXMax;
+    psEntry->YMax = nYMax;
+    psEntry->nBlockPtr = nBlockPtr;
+
+    if (m_numBulkIndexEntries == 1)
+    {
+        m_poHeader->m_nXMin = nXMin;
+        m_poHeader->m_nYMin = nYMin;
+        m_poHeader->m_nXMax = nXMax;
+        m_poHeader->m_nYMax = nYMax;
+    }
+    else
+    {
+        m_poHeader->m_nXMin = MIN(m_poHeader->m_nXMin, nXMin);
+        m_poHeader->m_nYMin = MIN(m_poHeader->m_nYMin, nYMin);
+        m_poHeader->m_nXMax = MAX(m_poHeader->m_nXMax, nXMax);
+        m_poHeader->m_nYMax = MAX(m_poHeader->m_nYMax, nYMax);
+    }
+
+    return 0;
+}
+
+/**********************************************************************
+ *                   TABHilbertCode()
+ *
+ * Return the position of (nX, nY) along a Hilbert curve covering a
+ * 65536x65536 grid.
+ **********************************************************************/
+static GUInt32 TABHilbertCode(GUInt32 nX, GUInt32 nY)
+{
+    const GUInt32 nGridSize = 65536;
+    GUInt32 nCode = 0;
+
+    for (GUInt32 nStep = nGridSize / 2; nStep > 0; nStep /= 2)
+    {
+        const GUInt32 nRX = (nX & nStep) ? 1 : 0;
+        const GUInt32 nRY = (nY & nStep) ? 1 : 0;
+        nCode += nStep * nStep * ((3 * nRX) ^ nRY);
+
+        // Rotate the quadrant so that the sub-curve has the right
+        // orientation.
+        if (nRY == 0)
+        {
+            if (nRX == 1)
+            {
+                nX = nGridSize - 1 - nX;
+                nY = nGridSize - 1 - nY;
+            }
+            const GUInt32 nTmp = nX;
+            nX = nY;
+            nY = nTmp;
+        }
+    }
+
+    return nCode;
+}
+
+typedef struct
+{
+    GUInt32          nHilbertCode;
+    TABMAPIndexEntry sEntry;
+} TABMAPSortedIndexEntry;
+
+static int TABCompareSortedIndexEntries(const void *pA, const void *pB)
+{
+    const TABMAPSortedIndexEntry *psA = (const TABMAPSortedIndexEntry *)pA;
+    const TABMAPSortedIndexEntry *psB = (const TABMAPSortedIndexEntry *)pB;
+
+    if (psA->nHilbertCode < psB->nHilbertCode)
+        return -1;
+    if (psA->nHilbertCode > psB->nHilbertCode)
+        return 1;
+    // Keep the write order for ties, so that output is deterministic.
+    if (psA->sEntry.nBlockPtr < psB->sEntry.nBlockPtr)
+        return -1;
+    if (psA->sEntry.nBlockPtr > psB->sEntry.nBlockPtr)
+        return 1;
+    return 0;
+}
+
+/**********************************************************************
+ *                   TABMAPFile::BuildSpatialIndexFromBulkEntries()
+ *
+ * Build the spatial index tree bottom-up from the object block MBRs
+ * recorded in quick spatial index mode.
+ *
+ * The entries are sorted along a Hilbert curve using the center of their
+ * MBR, and packed into index blocks, level by level, until a single root
+ * node remains. Compared to inserting the object blocks one by one in the
+ * tree, this avoids the node splits and the associated block rewrites, and
+ * gives fuller nodes with less overlap.
+ *
+ * On return, m_poSpIndex is the root node (still to be committed).
+ *
+ * Returns 0 on success, -1 on error.
+ **********************************************************************/
+int TABMAPFile::BuildSpatialIndexFromBulkEntries()
+{
+    CPLAssert(m_poSpIndex == NULL);
+
+    if (m_numBulkIndexEntries == 0)
+        return 0;
+
+    /*-----------------------------------------------------------------
+     * Sort the entries along the Hilbert curve
+     *----------------------------------------------------------------*/
+    TABMAPSortedIndexEntry *pasSorted = (TABMAPSortedIndexEntry *)
+        VSIMalloc2(m_numBulkIndexEntries, sizeof(TABMAPSortedIndexEntry));
+    if (pasSorted == NULL)
+    {
+        CPLError(CE_Failure, CPLE_OutOfMemory,
+                 "Out of memory while building spatial index.");
+        return -1;
+    }
+
+    const double dfXMin = m_poHeader->m_nXMin;
+    const double dfYMin = m_poHeader->m_nYMin;
+    const double dfXScale = (m_poHeader->m_nXMax > m_poHeader->m_nXMin) ?
+        65535.0 / ((double)m_poHeader->m_nXMax - dfXMin) : 0.0;
+    const double dfYScale = (m_poHeader->m_nYMax > m_poHeader->m_nYMin) ?
+        65535.0 / ((double)m_poHeader->m_nYMax - dfYMin) : 0.0;
+
+    for (int i = 0; i < m_numBulkIndexEntries; i++)
+    {
+        const TABMAPIndexEntry *psEntry = &m_pasBulkIndexEntries[i];
+        const double dfX =
+            ((double)psEntry->XMin + psEntry->XMax) / 2.0 - dfXMin;
+        const double dfY =
+            ((double)psEntry->YMin + psEntry->YMax) / 2.0 - dfYMin;
+        const GUInt32 nX = (GUInt32)MAX(0.0, MIN(65535.0, dfX * dfXScale));
+        const GUInt32 nY = (GUInt32)MAX(0.0, MIN(65535.0, dfY * dfYScale));
+
+        pasSorted[i].nHilbertCode = TABHilbertCode(nX, nY);
+        pasSorted[i].sEntry = *psEntry;
+    }
+
+    qsort(pasSorted, m_numBulkIndexEntries, sizeof(TABMAPSortedIndexEntry),
+          TABCompareSortedIndexEntries);
+
+    int numEntries = m_numBulkIndexEntries;
+    TABMAPIndexEntry *pasEntries = m_pasBulkIndexEntries;
+    for (int i = 0; i < numEntries; i++)
+        pasEntries[i] = pasSorted[i].sEntry;
+    CPLFree(pasSorted);
+
+    m_pasBulkIndexEntries = NULL;
+    m_numBulkIndexEntries = 0;
+    m_numBulkIndexEntriesAlloc = 0;
+
+    /*-----------------------------------------------------------------
+     * Pack each level into index blocks. The entries are spread evenly
+     * over the nodes of a level so that the last one is not left almost
+     * empty. We always create at least one index block, even if there
+     * is a single object block, as in the incremental mode.
+     *----------------------------------------------------------------*/
+    const int nMaxEntries = (m_poHeader->m_nRegularBlockSize - 4) / 20;
+    TABMAPIndexBlock *poRoot = NULL;
+    int nDepth = 0;
+
+    while (poRoot == NULL)
+    {
+        const int numNodes = (numEntries + nMaxEntries - 1) / nMaxEntries;
+        TABMAPIndexEntry *pasParentEntries = (TABMAPIndexEntry *)
+            VSIMalloc2(numNodes, sizeof(TABMAPIndexEntry));
+        if (pasParentEntries == NULL)
+        {
+            CPLError(CE_Failure, CPLE_OutOfMemory,
+                     "Out of memory while building spatial index.");
+            CPLFree(pasEntries);
+            return -1;
+        }
+
+        int iEntry = 0;
+        for (int iNode = 0; iNode < numNodes; iNode++)
+        {
+            const int nEndEntry =
+                (int)(((GIntBig)numEntries * (iNode + 1)) / numNodes);
+
+            TABMAPIndexBlock *poNode = new TABMAPIndexBlock(m_eAccessMode);
+            int nStatus =
+                poNode->InitNewBlock(m_fp, m_poHeader->m_nRegularBlockSize,
+                                     m_oBlockManager.AllocNewBlock("INDEX"));
+            poNode->SetMAPBlockManagerRef(&m_oBlockManager);
+
+            for (; nStatus == 0 && iEntry < nEndEntry; iEntry++)
+            {
+                const TABMAPIndexEntry *psEntry = &pasEntries[iEntry];
+                nStatus = poNode->InsertEntry(psEntry->XMin, psEntry->YMin,
+                                              psEntry->XMax, psEntry->YMax,
+                                              psEntry->nBlockPtr);
+            }
+            poNode->RecomputeMBR();
+
+            TABMAPIndexEntry *psParentEntry = &pasParentEntries[iNode];
+            poNode->GetMBR(psParentEntry->XMin, psParentEntry->YMin,
+                           psParentEntry->XMax, psParentEntry->YMax);
+            psParentEntry->nBlockPtr = poNode->GetNodeBlockPtr();
+
+            if (nStatus == 0 && numNodes == 1)
+            {
+                poRoot = poNode;
+                break;
+            }
+
+            if (nStatus == 0)
+                nStatus = poNode->CommitToFile();
+            delete poNode;
+
+            if (nStatus != 0)
+            {
+                CPLFree(pasParentEntries);
+                CPLFree(pasEntries);
+                return -1;
+            }
+        }
+
+        CPLFree(pasEntries);
+        pasEntries = pasParentEntries;
+        numEntries = numNodes;
+        nDepth++;
+    }
+    CPLFree(pasEntries);
+
+    m_poSpIndex = poRoot;
+    m_poHeader->m_nFirstIndexBlock = m_poSpIndex->GetNodeBlockPtr();
+
+    // Add 1 to Spatial Index Depth to account to the MapObjectBlocks
+    m_poHeader->m_nMaxSpIndexDepth = MAX(m_poHeader->m_nMaxSpIndexDepth,
+                                         (GByte)(nDepth + 1));
+
+    return 0;
+}
+
 /**********************************************************************
  *                   TABMAPFile::GetMinTABFileVersion()
  *
@@ -1507,6 +1507,12 @@ class TABMAPFile
     // Defaults to FALSE, i.e. optimized spatial index
     GBool       m_bQuickSpatialIndexMode;
 
+    // In quick spatial index mode, MBRs of the object blocks written so far.
+    // The index tree is bulk-loaded from them by CommitSpatialIndex().
+    TABMAPIndexEntry *m_pasBulkIndexEntries;
+    int         m_numBulkIndexEntries;
+    int         m_numBulkIndexEntriesAlloc;
+
     // Member used to access objects using the object ids (.ID file)
     TABIDFile   *m_poIdIndex;
 
@@ -1548,6 +1554,10 @@ class TABMAPFile
     int         CommitDrawingTools();
 
     int         CommitSpatialIndex();
+    int         AddBulkIndexEntry(GInt32 nXMin, GInt32 nYMin,
+                                  GInt32 nXMax, GInt32 nYMax,
+                                  GInt32 nBlockPtr);
+    int         BuildSpatialIndexFromBulkEntries();
 
     // Stuff related to traversing spatial index.
     TABMAPIndexBlock *m_poSpIndexLeaf;
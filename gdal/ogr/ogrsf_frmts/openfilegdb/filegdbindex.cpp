@@ -1820,4 +1820,390 @@ int FileGDBIndexIterator::GetMinMaxSumCount(double& dfMin, double& dfMax,
     return TRUE;
 }
 
+/************************************************************************/
+/*                             GetUInt64()                              */
+/************************************************************************/
+
+static GUIntBig GetUInt64(const GByte* pBaseAddr, int iOffset)
+{
+    GUIntBig nVal;
+    memcpy(&nVal, pBaseAddr + sizeof(nVal) * iOffset, sizeof(nVal));
+    CPL_LSBPTR64(&nVal);
+    return nVal;
+}
+
+/************************************************************************/
+/*                    FileGDBSpatialIndexIteratorImpl                   */
+/************************************************************************/
+
+/* Keys of the .spx B-tree are 64 bit integers made of the grid level */
+/* (2 bits), and the column and row of the cell in that grid (31 bits */
+/* each, offset by 2^29 so that negative cell indices are positive) */
+static const int SPX_MAX_GRID_COUNT = 4;
+static const GIntBig SPX_CELL_OFFSET = 1 << 29;
+static const GIntBig SPX_CELL_MAX = ((GIntBig)1 << 31) - 1 - SPX_CELL_OFFSET;
+/* Above this number of grid columns, a single range of keys, going from */
+/* the first to the last cell of the filter, is scanned */
+static const GIntBig SPX_MAX_COLUMN_RANGES = 1024;
+
+class FileGDBSpatialIndexIteratorImpl CPL_FINAL : public FileGDBSpatialIndexIterator
+{
+        FileGDBTable        *poParent;
+        VSILFILE            *fpSpx;
+        std::vector<double>  adfGridRes;
+        GUInt32              nMaxPerPages;
+        GUInt32              nOffsetFirstValInPage;
+        GUInt32              nIndexDepth;
+        bool                 bUnsignedOrder;
+
+        GUInt32              anCachedPage[MAX_DEPTH + 1];
+        GByte                abyPage[MAX_DEPTH + 1][FGDB_PAGE_SIZE];
+
+        std::vector<int>     anRows;
+        size_t               iCurRow;
+
+        bool                 IsLess(GUIntBig nKey1, GUIntBig nKey2) const;
+        GByte               *LoadPage(int iLevel, GUInt32 nPage);
+        int                  GetExtremeKey(bool bFirst, GUIntBig& nKey);
+        int                  CollectRows(int iLevel, GUInt32 nPage,
+                                         GUIntBig nMinKey, GUIntBig nMaxKey);
+
+                             FileGDBSpatialIndexIteratorImpl(FileGDBTable* poParent);
+        int                  Init();
+
+    public:
+        virtual             ~FileGDBSpatialIndexIteratorImpl();
+
+        static FileGDBSpatialIndexIterator* Build(FileGDBTable* poParent);
+
+        virtual FileGDBTable        *GetTable() { return poParent; }
+        virtual void                 Reset() { iCurRow = 0; }
+        virtual int                  GetNextRowSortedByFID();
+        virtual int                  GetRowCount()
+                { return static_cast<int>(anRows.size()); }
+
+        virtual int                  SetEnvelope(const OGREnvelope& sFilterEnvelope);
+};
+
+/************************************************************************/
+/*                                Build()                               */
+/************************************************************************/
+
+FileGDBSpatialIndexIterator* FileGDBSpatialIndexIterator::Build(
+                                                    FileGDBTable* poParent)
+{
+    return FileGDBSpatialIndexIteratorImpl::Build(poParent);
+}
+
+FileGDBSpatialIndexIterator* FileGDBSpatialIndexIteratorImpl::Build(
+                                                    FileGDBTable* poParent)
+{
+    FileGDBSpatialIndexIteratorImpl* poIterator =
+                new FileGDBSpatialIndexIteratorImpl(poParent);
+    if( poIterator->Init() )
+        return poIterator;
+    delete poIterator;
+    return NULL;
+}
+
+/************************************************************************/
+/*                    FileGDBSpatialIndexIteratorImpl()                 */
+/************************************************************************/
+
+FileGDBSpatialIndexIteratorImpl::FileGDBSpatialIndexIteratorImpl(
+                                                FileGDBTable* poParentIn) :
+    poParent(poParentIn),
+    fpSpx(NULL),
+    nMaxPerPages(0),
+    nOffsetFirstValInPage(0),
+    nIndexDepth(0),
+    bUnsignedOrder(false),
+    iCurRow(0)
+{
+    memset(anCachedPage, 0, sizeof(anCachedPage));
+}
+
+/************************************************************************/
+/*                   ~FileGDBSpatialIndexIteratorImpl()                 */
+/************************************************************************/
+
+FileGDBSpatialIndexIteratorImpl::~FileGDBSpatialIndexIteratorImpl()
+{
+    if( fpSpx )
+        VSIFCloseL(fpSpx);
+}
+
+/************************************************************************/
+/*                                Init()                                */
+/************************************************************************/
+
+int FileGDBSpatialIndexIteratorImpl::Init()
+{
+    const int errorRetValue = FALSE;
+
+    const int iGeomField = poParent->GetGeomFieldIdx();
+    if( iGeomField < 0 )
+        return FALSE;
+    const FileGDBGeomField* poGeomField =
+        reinterpret_cast<const FileGDBGeomField*>(poParent->GetField(iGeomField));
+    adfGridRes = poGeomField->GetSpatialIndexGridResolution();
+    /* A null grid size, as found in point layers, means that all */
+    /* features go into the same cell: the index is then useless. */
+    if( adfGridRes.empty() || (int)adfGridRes.size() > SPX_MAX_GRID_COUNT ||
+        !(adfGridRes[0] > 0.0) )
+    {
+        return FALSE;
+    }
+
+    const char* pszSpxName = CPLFormFilename(
+                    CPLGetPath(poParent->GetFilename().c_str()),
+                    CPLGetBasename(poParent->GetFilename().c_str()), "spx");
+    fpSpx = VSIFOpenL( pszSpxName, "rb" );
+    if( fpSpx == NULL )
+        return FALSE;
+
+    VSIFSeekL(fpSpx, 0, SEEK_END);
+    vsi_l_offset nFileSize = VSIFTellL(fpSpx);
+    returnErrorIf(nFileSize < FGDB_PAGE_SIZE + 22 );
+
+    VSIFSeekL(fpSpx, nFileSize - 22, SEEK_SET);
+    GByte abyTrailer[22];
+    returnErrorIf(VSIFReadL( abyTrailer, 22, 1, fpSpx ) != 1 );
+
+    returnErrorIf(abyTrailer[0] != sizeof(GUIntBig));
+    nMaxPerPages = (FGDB_PAGE_SIZE - 12) / (4 + abyTrailer[0]);
+    nOffsetFirstValInPage = 12 + nMaxPerPages * 4;
+
+    GUInt32 nMagic1 = GetUInt32(abyTrailer + 2, 0);
+    returnErrorIf(nMagic1 != 1 );
+
+    nIndexDepth = GetUInt32(abyTrailer + 6, 0);
+    returnErrorIf(!(nIndexDepth >= 1 && nIndexDepth <= MAX_DEPTH + 1) );
+
+    /* Keys of the last grid levels have their most significant bit set, */
+    /* so check on the extreme keys of the tree whether they sort as */
+    /* signed or unsigned integers. */
+    GUIntBig nFirstKey = 0;
+    GUIntBig nLastKey = 0;
+    if( GetExtremeKey(true, nFirstKey) && GetExtremeKey(false, nLastKey) )
+    {
+        bUnsignedOrder = (nFirstKey >> 63) == 0 && (nLastKey >> 63) != 0;
+    }
+
+    CPLDebug("OpenFileGDB", "Using spatial index %s (%d grid level(s), depth %u)",
+             pszSpxName, (int)adfGridRes.size(), nIndexDepth);
+
+    return TRUE;
+}
+
+/************************************************************************/
+/*                               IsLess()                               */
+/************************************************************************/
+
+bool FileGDBSpatialIndexIteratorImpl::IsLess(GUIntBig nKey1,
+                                             GUIntBig nKey2) const
+{
+    if( bUnsignedOrder )
+        return nKey1 < nKey2;
+    return static_cast<GIntBig>(nKey1) < static_cast<GIntBig>(nKey2);
+}
+
+/************************************************************************/
+/*                              LoadPage()                              */
+/************************************************************************/
+
+GByte* FileGDBSpatialIndexIteratorImpl::LoadPage(int iLevel, GUInt32 nPage)
+{
+    GByte* const errorRetValue = NULL;
+    if( anCachedPage[iLevel] != nPage )
+    {
+        anCachedPage[iLevel] = 0;
+        VSIFSeekL(fpSpx, (vsi_l_offset)(nPage - 1) * FGDB_PAGE_SIZE, SEEK_SET);
+        returnErrorIf(VSIFReadL( abyPage[iLevel], FGDB_PAGE_SIZE, 1, fpSpx ) != 1 );
+        anCachedPage[iLevel] = nPage;
+    }
+    return abyPage[iLevel];
+}
+
+/************************************************************************/
+/*                            GetExtremeKey()                           */
+/************************************************************************/
+
+int FileGDBSpatialIndexIteratorImpl::GetExtremeKey(bool bFirst, GUIntBig& nKey)
+{
+    const int errorRetValue = FALSE;
+    GUInt32 nPage = 1;
+    for( int iLevel = 0; iLevel < (int)nIndexDepth; iLevel++ )
+    {
+        GByte* pabyPage = LoadPage(iLevel, nPage);
+        if( pabyPage == NULL )
+            return FALSE;
+        const GUInt32 nCount = GetUInt32(pabyPage + 4, 0);
+        returnErrorIf(nCount > nMaxPerPages);
+        if( iLevel + 1 == (int)nIndexDepth )
+        {
+            if( nCount == 0 )
+                return FALSE;
+            nKey = GetUInt64(pabyPage + nOffsetFirstValInPage,
+                             bFirst ? 0 : nCount - 1);
+            return TRUE;
+        }
+        returnErrorIf(nCount == 0);
+        nPage = GetUInt32(pabyPage + 8, bFirst ? 0 : nCount);
+        returnErrorIf(nPage < 2);
+    }
+    return FALSE;
+}
+
+/************************************************************************/
+/*                             CollectRows()                            */
+/*                                                                      */
+/*      Append to anRows the rows of the subtree starting at nPage      */
+/*      whose key is in the [nMinKey, nMaxKey] range.                   */
+/************************************************************************/
+
+int FileGDBSpatialIndexIteratorImpl::CollectRows(int iLevel, GUInt32 nPage,
+                                                 GUIntBig nMinKey,
+                                                 GUIntBig nMaxKey)
+{
+    const int errorRetValue = FALSE;
+    GByte* pabyPage = LoadPage(iLevel, nPage);
+    if( pabyPage == NULL )
+        return FALSE;
+    const GUInt32 nCount = GetUInt32(pabyPage + 4, 0);
+    returnErrorIf(nCount > nMaxPerPages);
+
+    if( iLevel + 1 == (int)nIndexDepth )
+    {
+        const int nTotalRecordCount = poParent->GetTotalRecordCount();
+        for( GUInt32 i = 0; i < nCount; i++ )
+        {
+            const GUIntBig nKey = GetUInt64(pabyPage + nOffsetFirstValInPage, i);
+            if( IsLess(nKey, nMinKey) )
+                continue;
+            if( IsLess(nMaxKey, nKey) )
+                break;
+            const GUInt32 nFID = GetUInt32(pabyPage + 12, i);
+            returnErrorIf(nFID < 1 || nFID > (GUInt32)nTotalRecordCount);
+            anRows.push_back( (int)(nFID - 1) );
+        }
+        return TRUE;
+    }
+
+    /* The i-th key of an intermediate page is the greatest key of its */
+    /* i-th subpage. The last subpage has no key. */
+    returnErrorIf(nCount == 0);
+    for( GUInt32 i = 0; i <= nCount; i++ )
+    {
+        GUIntBig nKey = 0;
+        if( i < nCount )
+        {
+            nKey = GetUInt64(pabyPage + nOffsetFirstValInPage, i);
+            if( IsLess(nKey, nMinKey) )
+                continue;
+        }
+        const GUInt32 nSubPage = GetUInt32(pabyPage + 8, i);
+        returnErrorIf(nSubPage < 2);
+        if( !CollectRows(iLevel + 1, nSubPage, nMinKey, nMaxKey) )
+            return FALSE;
+        if( i < nCount && IsLess(nMaxKey, nKey) )
+            break;
+    }
+    return TRUE;
+}
+
+/************************************************************************/
+/*                          GetSpatialIndexCell()                       */
+/************************************************************************/
+
+static GIntBig GetSpatialIndexCell(double dfVal, double dfGridRes, bool bMin)
+{
+    /* Be a bit generous so that values on a cell boundary are not */
+    /* missed because of a different rounding when the index was written */
+    double dfCell = dfVal / dfGridRes;
+    dfCell = bMin ? dfCell - 1e-10 * (1 + fabs(dfCell)) :
+                    dfCell + 1e-10 * (1 + fabs(dfCell));
+    if( !(dfCell >= (double)-SPX_CELL_OFFSET) )
+        return -SPX_CELL_OFFSET;
+    if( !(dfCell <= (double)SPX_CELL_MAX) )
+        return SPX_CELL_MAX;
+    return static_cast<GIntBig>(floor(dfCell));
+}
+
+/************************************************************************/
+/*                          GetSpatialIndexKey()                        */
+/************************************************************************/
+
+static GUIntBig GetSpatialIndexKey(int iGrid, GIntBig nX, GIntBig nY)
+{
+    return (static_cast<GUIntBig>(iGrid) << 62) |
+           (static_cast<GUIntBig>(nX + SPX_CELL_OFFSET) << 31) |
+           static_cast<GUIntBig>(nY + SPX_CELL_OFFSET);
+}
+
+/************************************************************************/
+/*                             SetEnvelope()                            */
+/************************************************************************/
+
+int FileGDBSpatialIndexIteratorImpl::SetEnvelope(
+                                        const OGREnvelope& sFilterEnvelope)
+{
+    anRows.resize(0);
+    iCurRow = 0;
+
+    for( int iGrid = 0; iGrid < (int)adfGridRes.size(); iGrid++ )
+    {
+        const double dfGridRes = adfGridRes[iGrid];
+        /* Unused grid level */
+        if( !(dfGridRes > 0.0) )
+            continue;
+
+        const GIntBig nMinX =
+            GetSpatialIndexCell(sFilterEnvelope.MinX, dfGridRes, true);
+        const GIntBig nMinY =
+            GetSpatialIndexCell(sFilterEnvelope.MinY, dfGridRes, true);
+        const GIntBig nMaxX =
+            GetSpatialIndexCell(sFilterEnvelope.MaxX, dfGridRes, false);
+        const GIntBig nMaxY =
+            GetSpatialIndexCell(sFilterEnvelope.MaxY, dfGridRes, false);
+
+        /* Cells of a same column are contiguous in the index */
+        if( nMaxX - nMinX < SPX_MAX_COLUMN_RANGES )
+        {
+            for( GIntBig nX = nMinX; nX <= nMaxX; nX++ )
+            {
+                if( !CollectRows(0, 1,
+                                 GetSpatialIndexKey(iGrid, nX, nMinY),
+                                 GetSpatialIndexKey(iGrid, nX, nMaxY)) )
+                {
+                    return FALSE;
+                }
+            }
+        }
+        else if( !CollectRows(0, 1,
+                              GetSpatialIndexKey(iGrid, nMinX, nMinY),
+                              GetSpatialIndexKey(iGrid, nMaxX, nMaxY)) )
+        {
+            return FALSE;
+        }
+    }
+
+    /* A feature is generally indexed in several cells */
+    std::sort(anRows.begin(), anRows.end());
+    anRows.erase(std::unique(anRows.begin(), anRows.end()), anRows.end());
+
+    return TRUE;
+}
+
+/************************************************************************/
+/*                        GetNextRowSortedByFID()                       */
+/************************************************************************/
+
+int FileGDBSpatialIndexIteratorImpl::GetNextRowSortedByFID()
+{
+    if( iCurRow < anRows.size() )
+        return anRows[iCurRow ++];
+    return -1;
+}
+
 }; /* namespace OpenFileGDB */
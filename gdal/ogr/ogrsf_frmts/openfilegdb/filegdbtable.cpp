@@ -1003,13 +1003,20 @@ int FileGDBTable::Open(const char* pszFilename,
                     if( pabyIter[0] == 0x00 && pabyIter[1] >= 1 && pabyIter[1] <= 3 &&
                         pabyIter[2] == 0x00 && pabyIter[3] == 0x00 && pabyIter[4] == 0x00 )
                     {
-                        GByte nToSkip = pabyIter[1];
+                        /* The doubles that follow are the grid sizes of */
+                        /* the .spx spatial index */
+                        GByte nToRead = pabyIter[1];
                         pabyIter += 5;
                         nRemaining -= 5;
-                        returnErrorIf(nRemaining < (GUInt32)(nToSkip * 8) );
-                        nCountDoubles += nToSkip;
-                        pabyIter += nToSkip * 8;
-                        nRemaining -= nToSkip * 8;
+                        returnErrorIf(nRemaining < (GUInt32)(nToRead * 8) );
+                        nCountDoubles += nToRead;
+                        for( int j = 0; j < nToRead; j++ )
+                        {
+                            poField->adfSpatialIndexGridResolution.push_back(
+                                GetFloat64(pabyIter, j));
+                        }
+                        pabyIter += nToRead * 8;
+                        nRemaining -= nToRead * 8;
                         break;
                     }
                     else
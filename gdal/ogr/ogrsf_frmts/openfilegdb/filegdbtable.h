@@ -144,6 +144,7 @@ class FileGDBGeomField: public FileGDBField
         double            dfXMax;
         double            dfYMax;
         int               bHas3D;
+        std::vector<double> adfSpatialIndexGridResolution;
 
     public:
                           FileGDBGeomField(FileGDBTable* poParent);
@@ -173,6 +174,9 @@ class FileGDBGeomField: public FileGDBField
         double             GetMTolerance() const { return dfMTolerance; }
 
         int                Has3D() const { return bHas3D; }
+
+        const std::vector<double>& GetSpatialIndexGridResolution() const
+                                    { return adfSpatialIndexGridResolution; }
 };
 
 /************************************************************************/
@@ -374,6 +378,21 @@ class FileGDBIterator
                                              int bIteratorAreExclusive = FALSE);
 };
 
+/************************************************************************/
+/*                      FileGDBSpatialIndexIterator                     */
+/************************************************************************/
+
+/* Iterates, sorted by FID, over the rows whose cells in the .spx grid */
+/* index intersect the envelope passed to SetEnvelope(). This is a */
+/* superset of the rows whose geometry envelope intersects it. */
+class FileGDBSpatialIndexIterator: public FileGDBIterator
+{
+    public:
+        virtual int                  SetEnvelope(const OGREnvelope& sFilterEnvelope) = 0;
+
+        static FileGDBSpatialIndexIterator* Build(FileGDBTable* poParent);
+};
+
 /************************************************************************/
 /*                       FileGDBOGRGeometryConverter                    */
 /************************************************************************/
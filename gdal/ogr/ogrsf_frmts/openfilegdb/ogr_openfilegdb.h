@@ -86,6 +86,8 @@ class OGROpenFileGDBLayer : public OGRLayer
 
     FileGDBIterator*      m_poIterMinMax;
 
+    FileGDBSpatialIndexIterator *m_poSpatialIndexIterator;
+
     SPIState            m_eSpatialIndexState;
     CPLQuadTree        *m_pQuadTree;
     void              **m_pahFilteredFeatures;
@@ -117,7 +119,7 @@ public:
                                    int bAscending,
                                    int op,
                                    swq_expr_node* poValue);
-  SPIState              GetSpatialIndexState() const { return m_eSpatialIndexState; }
+  SPIState              GetSpatialIndexState();
   int                   IsValidLayerDefn() { return BuildLayerDefinition(); }
 
   virtual const char* GetName() { return m_osName.c_str(); }
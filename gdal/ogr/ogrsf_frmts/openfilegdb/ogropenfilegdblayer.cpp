@@ -153,6 +153,7 @@ OGROpenFileGDBLayer::OGROpenFileGDBLayer(const char* pszGDBFilename,
             m_poIterator(NULL),
             m_bIteratorSufficientToEvaluateFilter(FALSE),
             m_poIterMinMax(NULL),
+            m_poSpatialIndexIterator(NULL),
             m_eSpatialIndexState(SPI_IN_BUILDING),
             m_pQuadTree(NULL),
             m_pahFilteredFeatures(NULL),
@@ -187,6 +188,7 @@ OGROpenFileGDBLayer::~OGROpenFileGDBLayer()
     }
     delete m_poIterator;
     delete m_poIterMinMax;
+    delete m_poSpatialIndexIterator;
     delete m_poGeomConverter;
     if( m_pQuadTree != NULL )
         CPLQuadTreeDestroy(m_pQuadTree);
@@ -359,7 +361,20 @@ int OGROpenFileGDBLayer::BuildLayerDefinition()
         m_poGeomConverter =
             FileGDBOGRGeometryConverter::BuildConverter(poGDBGeomField);
 
+        /* Use the .spx spatial index if there's one. Otherwise build an */
+        /* in-memory one during the first full scan. */
         if( CPLTestBool(
+                CPLGetConfigOption("OPENFILEGDB_USE_SPATIAL_INDEX", "YES")) )
+        {
+            m_poSpatialIndexIterator =
+                FileGDBSpatialIndexIterator::Build(m_poLyrTable);
+        }
+
+        if( m_poSpatialIndexIterator != NULL )
+        {
+            m_eSpatialIndexState = SPI_INVALID;
+        }
+        else if( CPLTestBool(
                 CPLGetConfigOption("OPENFILEGDB_IN_MEMORY_SPI", "YES")) )
         {
             CPLRectObj sGlobalBounds;
@@ -683,6 +698,17 @@ const char* OGROpenFileGDBLayer::GetFIDColumn()
     return m_poLyrTable->GetObjectIdColName().c_str();
 }
 
+/***********************************************************************/
+/*                       GetSpatialIndexState()                        */
+/***********************************************************************/
+
+SPIState OGROpenFileGDBLayer::GetSpatialIndexState()
+{
+    /* The state is only settled once the .spx has been looked for */
+    (void) BuildLayerDefinition();
+    return m_eSpatialIndexState;
+}
+
 /***********************************************************************/
 /*                          ResetReading()                             */
 /***********************************************************************/
@@ -698,6 +724,8 @@ void OGROpenFileGDBLayer::ResetReading()
     m_iCurFeat = 0;
     if( m_poIterator )
         m_poIterator->Reset();
+    if( m_poSpatialIndexIterator )
+        m_poSpatialIndexIterator->Reset();
 }
 
 /***********************************************************************/
@@ -749,6 +777,13 @@ void OGROpenFileGDBLayer::SetSpatialFilter( OGRGeometry *poGeom )
                 std::sort(panStart, panStart + m_nFilteredFeatureCount);
             }
         }
+        else if( m_poSpatialIndexIterator != NULL &&
+                 !m_poSpatialIndexIterator->SetEnvelope(m_sFilterEnvelope) )
+        {
+            /* Corrupted index: fallback to a full scan */
+            delete m_poSpatialIndexIterator;
+            m_poSpatialIndexIterator = NULL;
+        }
         m_poLyrTable->InstallFilterEnvelope(&m_sFilterEnvelope);
     }
     else
@@ -1435,11 +1470,14 @@ OGRFeature* OGROpenFileGDBLayer::GetNextFeature()
                 }
             }
         }
-        else if( m_poIterator != NULL )
+        else if( m_poIterator != NULL ||
+                 (m_poSpatialIndexIterator != NULL && m_poFilterGeom != NULL) )
         {
+            FileGDBIterator* poIterator = (m_poIterator != NULL) ?
+                m_poIterator : m_poSpatialIndexIterator;
             while( true )
             {
-                int iRow = m_poIterator->GetNextRowSortedByFID();
+                int iRow = poIterator->GetNextRowSortedByFID();
                 if( iRow < 0 )
                     return NULL;
                 if( m_poLyrTable->SelectRow(iRow) )
@@ -1535,7 +1573,8 @@ OGRFeature* OGROpenFileGDBLayer::GetFeature( GIntBig nFeatureId )
 
 OGRErr OGROpenFileGDBLayer::SetNextByIndex( GIntBig nIndex )
 {
-    if( m_poIterator != NULL )
+    if( m_poIterator != NULL ||
+        (m_poSpatialIndexIterator != NULL && m_poFilterGeom != NULL) )
         return OGRLayer::SetNextByIndex(nIndex);
 
     if( !BuildLayerDefinition() )
@@ -1620,8 +1659,20 @@ GIntBig OGROpenFileGDBLayer::GetFeatureCount( int bForce )
             m_nFilteredFeatureCount = 0;
         }
 
-        for(int i=0;i<m_poLyrTable->GetTotalRecordCount();i++)
+        /* Restrict to the candidate rows of the .spx index if available */
+        if( m_poSpatialIndexIterator != NULL )
+            m_poSpatialIndexIterator->Reset();
+
+        int i = -1;
+        while( true )
         {
+            if( m_poSpatialIndexIterator != NULL )
+                i = m_poSpatialIndexIterator->GetNextRowSortedByFID();
+            else if( ++i == m_poLyrTable->GetTotalRecordCount() )
+                i = -1;
+            if( i < 0 )
+                break;
+
             if( !m_poLyrTable->SelectRow(i) )
             {
                 if( m_poLyrTable->HasGotError() )
@@ -1680,6 +1731,8 @@ GIntBig OGROpenFileGDBLayer::GetFeatureCount( int bForce )
             m_nFilteredFeatureCount = nCount;
             m_eSpatialIndexState = SPI_COMPLETED;
         }
+        if( m_poSpatialIndexIterator != NULL )
+            m_poSpatialIndexIterator->Reset();
 
         return nCount;
     }
@@ -1711,7 +1764,8 @@ int OGROpenFileGDBLayer::TestCapability( const char * pszCap )
     {
         return ( m_poLyrTable->GetValidRecordCount() ==
                  m_poLyrTable->GetTotalRecordCount() &&
-                 m_poIterator == NULL );
+                 m_poIterator == NULL &&
+                 !(m_poSpatialIndexIterator != NULL && m_poFilterGeom != NULL) );
     }
     else if( EQUAL(pszCap,OLCRandomRead) )
     {
@@ -35,6 +35,7 @@
 
 #include "ogrsf_frmts.h"
 #include "cpl_string.h"
+#include "cpl_virtualmem.h"
 
 #include <set>
 #include <map>
@@ -273,6 +274,58 @@ typedef struct
 } CollisionBucket;
 #endif
 
+/************************************************************************/
+/*                            OGROSMFlatStore                           */
+/************************************************************************/
+
+/* Sparse byte array, addressed as a flat file, and split in chunks. The */
+/* chunks are allocated in RAM up to nMaxRAMSize bytes, and in a temporary */
+/* file beyond, which is memory mapped for reading when possible. */
+class OGROSMFlatStore
+{
+    CPLString           osTmpFilePrefix;
+    CPLString           osFilename;
+    VSILFILE           *fp;
+    bool                bMustUnlink;
+    GUIntBig            nFileSize;
+    GUIntBig            nFlushedFileSize;
+    bool                bFileDirty;
+
+    GUIntBig            nMaxRAMSize;
+    GUIntBig            nRAMSize;
+    std::vector<GByte*> apabyChunks;    /* NULL if not in RAM */
+    std::vector<GUIntBig> anChunkOffsets; /* offset in file + 1, or 0 */
+
+    GByte              *pabyWriteChunk;
+    size_t              nWriteChunk;
+    bool                bHasWriteChunk;
+
+    CPLVirtualMem      *psVirtualMem;
+    GUIntBig            nMappedSize;
+    bool                bTryMapping;
+
+    bool                OpenTmpFile();
+    bool                FlushWriteChunk();
+    GByte*              GetChunkForWriting( size_t iChunk );
+
+  public:
+                        OGROSMFlatStore( const char* pszTmpFilePrefix,
+                                         GUIntBig nMaxRAMSize );
+                       ~OGROSMFlatStore();
+
+    bool                Write( GUIntBig nOffset, const void* pData,
+                               size_t nSize );
+    bool                Read( GUIntBig nOffset, void* pData, size_t nSize );
+    void                Clear();
+
+    GUIntBig            GetRAMSize() const { return nRAMSize; }
+    GUIntBig            GetFileSize() const { return nFileSize; }
+};
+
+/************************************************************************/
+/*                           OGROSMDataSource                           */
+/************************************************************************/
+
 class OGROSMDataSource : public OGRDataSource
 {
     friend class OGROSMLayer;
@@ -395,6 +448,12 @@ class OGROSMDataSource : public OGRDataSource
 
     bool                bNeedsToSaveWayInfo;
 
+    /* Only set when FLAT_NODES / FLAT_WAYS are enabled */
+    OGROSMFlatStore    *poFlatNodes;        /* LonLat at nID * 8 */
+    OGROSMFlatStore    *poFlatWayIndex;     /* offset << 16 | size at nID * 8 */
+    OGROSMFlatStore    *poFlatWayData;      /* compressed ways */
+    GUIntBig            nFlatWayDataSize;
+
     int                 CompressWay (unsigned int nTags, IndexedKVP* pasTags,
                                      int nPoints, LonLat* pasLonLatPairs,
                                      OSMInfo* psInfo,
@@ -417,11 +476,15 @@ class OGROSMDataSource : public OGRDataSource
     bool                FlushCurrentSectorCompressedCase();
     bool                FlushCurrentSectorNonCompressedCase();
     bool                IndexPointCustom(OSMNode* psNode);
+    bool                IndexPointFlat(OSMNode* psNode);
 
     void                IndexWay(GIntBig nWayID,
                                  unsigned int nTags, IndexedKVP* pasTags,
                                  LonLat* pasLonLatPairs, int nPairs,
                                  OSMInfo* psInfo);
+    void                IndexWayFlat(GIntBig nWayID, int nBufferSize);
+    bool                ReadWayFlat(GIntBig nWayID, GByte* pabyBuffer,
+                                    int* pnBufferSize);
 
     bool                StartTransactionCacheDB();
     bool                CommitTransactionCacheDB();
@@ -436,9 +499,12 @@ class OGROSMDataSource : public OGRDataSource
     void                LookupNodesCustom();
     void                LookupNodesCustomCompressedCase();
     void                LookupNodesCustomNonCompressedCase();
+    void                LookupNodesFlat();
 
     unsigned int        LookupWays( std::map< GIntBig, std::pair<int,void*> >& aoMapWays,
                                     OSMRelation* psRelation );
+    unsigned int        LookupWaysFlat( std::map< GIntBig, std::pair<int,void*> >& aoMapWays,
+                                        OSMRelation* psRelation );
 
     OGRGeometry*        BuildMultiPolygon(OSMRelation* psRelation,
                                           unsigned int* pnTags,
@@ -71,6 +71,9 @@ static const int LIMIT_IDS_PER_REQUEST = 200;
 
 #define VALID_ID_FOR_CUSTOM_INDEXING(_id) ((_id) >= 0 && (_id / NODE_PER_BUCKET) < INT_MAX)
 
+/* Flat stores are addressed by nID * 8 */
+#define VALID_ID_FOR_FLAT_INDEXING(_id) ((_id) >= 0 && (_id) < ((GIntBig)1 << 36))
+
 /* Minimum size of data written on disk, in *uncompressed* case */
 #define SECTOR_SIZE         512
 /* Which represents, 64 nodes */
@@ -256,7 +259,11 @@ OGROSMDataSource::OGROSMDataSource() :
     pabySector(NULL),
     papsBuckets(NULL),
     nBuckets(0),
-    bNeedsToSaveWayInfo(false)
+    bNeedsToSaveWayInfo(false),
+    poFlatNodes(NULL),
+    poFlatWayIndex(NULL),
+    poFlatWayData(NULL),
+    nFlatWayDataSize(0)
 {}
 
 /************************************************************************/
@@ -370,6 +377,10 @@ OGROSMDataSource::~OGROSMDataSource()
         }
         CPLFree(papsBuckets);
     }
+
+    delete poFlatNodes;
+    delete poFlatWayIndex;
+    delete poFlatWayData;
 }
 
 /************************************************************************/
@@ -455,6 +466,9 @@ int OGROSMDataSource::IndexPoint(OSMNode* psNode)
     if( !bIndexPoints )
         return TRUE;
 
+    if( poFlatNodes != NULL )
+        return IndexPointFlat(psNode);
+
     if( bCustomIndexing)
         return IndexPointCustom(psNode);
 
@@ -793,6 +807,42 @@ bool OGROSMDataSource::IndexPointCustom(OSMNode* psNode)
     return true;
 }
 
+/************************************************************************/
+/*                           IndexPointFlat()                           */
+/*                                                                      */
+/*      The coordinates of node nID are stored at nID * 8 in a flat     */
+/*      array. Unlike with the bucket based indexing, ids do not need   */
+/*      to be increasing, but this is much more efficient when they     */
+/*      are once the array does not fit in RAM anymore.                 */
+/************************************************************************/
+
+bool OGROSMDataSource::IndexPointFlat(OSMNode* psNode)
+{
+    if( !VALID_ID_FOR_FLAT_INDEXING(psNode->nID) )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "Unsupported node id value (" CPL_FRMT_GIB
+                  "). Use OSM_FLAT_NODES=NO",
+                  psNode->nID);
+        bStopParsing = true;
+        return false;
+    }
+
+    LonLat sLonLat;
+    sLonLat.nLon = DBL_TO_INT(psNode->dfLon);
+    sLonLat.nLat = DBL_TO_INT(psNode->dfLat);
+
+    if( !poFlatNodes->Write(static_cast<GUIntBig>(psNode->nID) *
+                                                        sizeof(LonLat),
+                            &sLonLat, sizeof(LonLat)) )
+    {
+        bStopParsing = true;
+        return false;
+    }
+
+    return true;
+}
+
 /************************************************************************/
 /*                             NotifyNodes()                            */
 /************************************************************************/
@@ -877,7 +927,9 @@ static void OGROSMNotifyNodes ( unsigned int nNodes,
 
 void OGROSMDataSource::LookupNodes( )
 {
-    if( bCustomIndexing )
+    if( poFlatNodes != NULL )
+        LookupNodesFlat();
+    else if( bCustomIndexing )
         LookupNodesCustom();
     else
         LookupNodesSQLite();
@@ -1014,6 +1066,52 @@ void OGROSMDataSource::LookupNodesSQLite( )
     nReqIds = j;
 }
 
+/************************************************************************/
+/*                           LookupNodesFlat()                          */
+/************************************************************************/
+
+void OGROSMDataSource::LookupNodesFlat( )
+{
+    CPLAssert(nUnsortedReqIds <= MAX_ACCUMULATED_NODES);
+
+    nReqIds = 0;
+    for( unsigned int i = 0; i < nUnsortedReqIds; i++)
+    {
+        GIntBig id = panUnsortedReqIds[i];
+        if( VALID_ID_FOR_FLAT_INDEXING(id) )
+            panReqIds[nReqIds++] = id;
+    }
+
+    /* Sorting the ids makes the accesses to the array sequential */
+    std::sort(panReqIds, panReqIds + nReqIds);
+
+    /* Remove duplicates */
+    unsigned int j = 0;
+    for( unsigned int i = 0; i < nReqIds; i++)
+    {
+        if (!(i > 0 && panReqIds[i] == panReqIds[i-1]))
+            panReqIds[j++] = panReqIds[i];
+    }
+    nReqIds = j;
+
+    j = 0;
+    for( unsigned int i = 0; i < nReqIds; i++)
+    {
+        GIntBig id = panReqIds[i];
+        if( !poFlatNodes->Read(static_cast<GUIntBig>(id) * sizeof(LonLat),
+                               pasLonLatArray + j, sizeof(LonLat)) )
+        {
+            bStopParsing = true;
+            break;
+        }
+
+        panReqIds[j] = id;
+        if( pasLonLatArray[j].nLon || pasLonLatArray[j].nLat )
+            j++;
+    }
+    nReqIds = j;
+}
+
 /************************************************************************/
 /*                            ReadVarSInt64()                           */
 /************************************************************************/
@@ -1571,10 +1669,16 @@ void OGROSMDataSource::IndexWay(GIntBig nWayID,
     if( !bIndexWays )
         return;
 
-    sqlite3_bind_int64( hInsertWayStmt, 1, nWayID );
-
     int nBufferSize = CompressWay (nTags, pasTags, nPairs, pasLonLatPairs, psInfo, pabyWayBuffer);
     CPLAssert(nBufferSize <= WAY_BUFFER_SIZE);
+
+    if( poFlatWayIndex != NULL )
+    {
+        IndexWayFlat(nWayID, nBufferSize);
+        return;
+    }
+
+    sqlite3_bind_int64( hInsertWayStmt, 1, nWayID );
     sqlite3_bind_blob( hInsertWayStmt, 2, pabyWayBuffer,
                        nBufferSize, SQLITE_STATIC );
 
@@ -1588,6 +1692,77 @@ void OGROSMDataSource::IndexWay(GIntBig nWayID,
     }
 }
 
+/************************************************************************/
+/*                            IndexWayFlat()                            */
+/*                                                                      */
+/*      Append the compressed way in pabyWayBuffer to the way data      */
+/*      store, and record its offset and size at nWayID * 8 in the      */
+/*      way index.                                                      */
+/************************************************************************/
+
+void OGROSMDataSource::IndexWayFlat(GIntBig nWayID, int nBufferSize)
+{
+    CPLAssert(nBufferSize > 0 && nBufferSize < 65536);
+
+    if( !VALID_ID_FOR_FLAT_INDEXING(nWayID) )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "Unsupported way id value (" CPL_FRMT_GIB
+                  "). Use OSM_FLAT_WAYS=NO",
+                  nWayID);
+        bStopParsing = true;
+        return;
+    }
+
+    const GUIntBig nEntry = (nFlatWayDataSize << 16) |
+                            static_cast<GUIntBig>(nBufferSize);
+    GByte abyEntry[8];
+    for( int i = 0; i < 8; i++ )
+        abyEntry[i] = static_cast<GByte>(nEntry >> (8 * i));
+
+    if( !poFlatWayData->Write(nFlatWayDataSize, pabyWayBuffer, nBufferSize) ||
+        !poFlatWayIndex->Write(static_cast<GUIntBig>(nWayID) * 8,
+                               abyEntry, 8) )
+    {
+        bStopParsing = true;
+        return;
+    }
+    nFlatWayDataSize += nBufferSize;
+}
+
+/************************************************************************/
+/*                             ReadWayFlat()                            */
+/*                                                                      */
+/*      Read the compressed way into pabyBuffer, which must be at       */
+/*      least WAY_BUFFER_SIZE large. Returns false if the way is        */
+/*      unknown.                                                        */
+/************************************************************************/
+
+bool OGROSMDataSource::ReadWayFlat(GIntBig nWayID, GByte* pabyBuffer,
+                                   int* pnBufferSize)
+{
+    if( !VALID_ID_FOR_FLAT_INDEXING(nWayID) )
+        return false;
+
+    GByte abyEntry[8];
+    if( !poFlatWayIndex->Read(static_cast<GUIntBig>(nWayID) * 8,
+                              abyEntry, 8) )
+        return false;
+    GUIntBig nEntry = 0;
+    for( int i = 0; i < 8; i++ )
+        nEntry |= static_cast<GUIntBig>(abyEntry[i]) << (8 * i);
+    if( nEntry == 0 )
+        return false;
+
+    const int nBufferSize = static_cast<int>(nEntry & 0xFFFF);
+    if( nBufferSize > WAY_BUFFER_SIZE ||
+        !poFlatWayData->Read(nEntry >> 16, pabyBuffer, nBufferSize) )
+        return false;
+
+    *pnBufferSize = nBufferSize;
+    return true;
+}
+
 /************************************************************************/
 /*                              FindNode()                              */
 /************************************************************************/
@@ -2083,6 +2258,9 @@ unsigned int OGROSMDataSource::LookupWays( std::map< GIntBig,
                                            std::pair<int,void*> >& aoMapWays,
                                            OSMRelation* psRelation )
 {
+    if( poFlatWayIndex != NULL )
+        return LookupWaysFlat(aoMapWays, psRelation);
+
     unsigned int nFound = 0;
     unsigned int iCur = 0;
     unsigned int i;
@@ -2143,6 +2321,42 @@ unsigned int OGROSMDataSource::LookupWays( std::map< GIntBig,
     return nFound;
 }
 
+/************************************************************************/
+/*                           LookupWaysFlat()                           */
+/************************************************************************/
+
+unsigned int OGROSMDataSource::LookupWaysFlat( std::map< GIntBig,
+                                               std::pair<int,void*> >& aoMapWays,
+                                               OSMRelation* psRelation )
+{
+    unsigned int nFound = 0;
+
+    for( unsigned int i = 0; i < psRelation->nMembers; i++ )
+    {
+        if( psRelation->pasMembers[i].eType != MEMBER_WAY ||
+            strcmp(psRelation->pasMembers[i].pszRole, "subarea") == 0 )
+            continue;
+
+        const GIntBig id = psRelation->pasMembers[i].nID;
+        if( aoMapWays.find(id) != aoMapWays.end() )
+        {
+            nFound++;
+            continue;
+        }
+
+        int nBlobSize = 0;
+        if( ReadWayFlat(id, pabyWayBuffer, &nBlobSize) )
+        {
+            void* blob_dup = CPLMalloc(nBlobSize);
+            memcpy(blob_dup, pabyWayBuffer, nBlobSize);
+            aoMapWays[id] = std::pair<int,void*>(nBlobSize, blob_dup);
+            nFound++;
+        }
+    }
+
+    return nFound;
+}
+
 /************************************************************************/
 /*                          BuildMultiPolygon()                         */
 /************************************************************************/
@@ -2567,12 +2781,27 @@ void OGROSMDataSource::ProcessPolygonsStandalone()
 
         GIntBig id = sqlite3_column_int64(hSelectPolygonsStandaloneStmt, 0);
 
-        sqlite3_bind_int64( pahSelectWayStmt[0], 1, id );
-        if( sqlite3_step(pahSelectWayStmt[0]) == SQLITE_ROW )
+        bool bFound;
+        int nBlobSize = 0;
+        const void* blob = NULL;
+        if( poFlatWayIndex != NULL )
         {
-            int nBlobSize = sqlite3_column_bytes(pahSelectWayStmt[0], 1);
-            const void* blob = sqlite3_column_blob(pahSelectWayStmt[0], 1);
+            bFound = ReadWayFlat(id, pabyWayBuffer, &nBlobSize);
+            blob = pabyWayBuffer;
+        }
+        else
+        {
+            sqlite3_bind_int64( pahSelectWayStmt[0], 1, id );
+            bFound = sqlite3_step(pahSelectWayStmt[0]) == SQLITE_ROW;
+            if( bFound )
+            {
+                nBlobSize = sqlite3_column_bytes(pahSelectWayStmt[0], 1);
+                blob = sqlite3_column_blob(pahSelectWayStmt[0], 1);
+            }
+        }
 
+        if( bFound )
+        {
             LonLat* pasCoords = reinterpret_cast<LonLat *>(pasLonLatCache);
 
             const int nPoints = UncompressWay(
@@ -2626,7 +2855,8 @@ void OGROSMDataSource::ProcessPolygonsStandalone()
             CPLAssert(false);
         }
 
-        sqlite3_reset(pahSelectWayStmt[0]);
+        if( poFlatWayIndex == NULL )
+            sqlite3_reset(pahSelectWayStmt[0]);
 
         bHasRowInPolygonsStandalone =
             sqlite3_step(hSelectPolygonsStandaloneStmt) == SQLITE_ROW;
@@ -2681,6 +2911,19 @@ int OGROSMDataSource::Open( const char * pszFilename,
     if( CSLFetchBoolean(papszOpenOptionsIn, "INTERLEAVED_READING", FALSE) )
         bInterleavedReading = TRUE;
 
+    const char* pszNumThreads = CSLFetchNameValueDef(
+            papszOpenOptionsIn, "NUM_THREADS",
+                        CPLGetConfigOption("OSM_NUM_THREADS", "1"));
+    int nNumThreads;
+    if( EQUAL(pszNumThreads, "ALL_CPUS") )
+        nNumThreads = CPLGetNumCPUs();
+    else
+        nNumThreads = atoi(pszNumThreads);
+    if( nNumThreads > 128 )
+        nNumThreads = 128;
+    if( nNumThreads > 1 )
+        OSM_SetNumThreads(psParser, nNumThreads);
+
     /* The following 4 config options are only useful for debugging */
     bIndexPoints = CPLTestBool(CPLGetConfigOption("OSM_INDEX_POINTS", "YES"));
     bUsePointsIndex = CPLTestBool(
@@ -2700,6 +2943,38 @@ int OGROSMDataSource::Open( const char * pszFilename,
     if( bCompressNodes )
         CPLDebug("OSM", "Using compression for nodes DB");
 
+    if( CPLTestBool(CSLFetchNameValueDef(
+            papszOpenOptionsIn, "FLAT_NODES",
+                        CPLGetConfigOption("OSM_FLAT_NODES", "NO"))) )
+    {
+        const int nMaxRAM = atoi(CSLFetchNameValueDef(
+            papszOpenOptionsIn, "FLAT_NODES_MAX_RAM",
+                        CPLGetConfigOption("OSM_FLAT_NODES_MAX_RAM", "1024")));
+        CPLDebug("OSM", "Using flat array for nodes, with %d MB in RAM",
+                 MAX(0, nMaxRAM));
+        poFlatNodes = new OGROSMFlatStore(
+            "osm_tmp_flat_nodes",
+            static_cast<GUIntBig>(MAX(0, nMaxRAM)) * 1024 * 1024);
+    }
+
+    if( CPLTestBool(CSLFetchNameValueDef(
+            papszOpenOptionsIn, "FLAT_WAYS",
+                        CPLGetConfigOption("OSM_FLAT_WAYS", "NO"))) )
+    {
+        const int nMaxRAM = atoi(CSLFetchNameValueDef(
+            papszOpenOptionsIn, "FLAT_WAYS_MAX_RAM",
+                        CPLGetConfigOption("OSM_FLAT_WAYS_MAX_RAM", "512")));
+        CPLDebug("OSM", "Using flat store for ways, with %d MB in RAM",
+                 MAX(0, nMaxRAM));
+        /* A quarter of the budget for the index, the rest for the data */
+        const GUIntBig nMaxRAMSize =
+            static_cast<GUIntBig>(MAX(0, nMaxRAM)) * 1024 * 1024;
+        poFlatWayIndex = new OGROSMFlatStore("osm_tmp_flat_way_index",
+                                             nMaxRAMSize / 4);
+        poFlatWayData = new OGROSMFlatStore("osm_tmp_flat_way_data",
+                                            nMaxRAMSize - nMaxRAMSize / 4);
+    }
+
     nLayers = 5;
     papoLayers = static_cast<OGROSMLayer **>(
         CPLMalloc(nLayers * sizeof(OGROSMLayer*)) );
@@ -2788,7 +3063,7 @@ int OGROSMDataSource::Open( const char * pszFilename,
         nSize = static_cast<GIntBig>(nMaxSizeForInMemoryDBInMB) * 1024 * 1024;
     }
 
-    if( bCustomIndexing )
+    if( bCustomIndexing && poFlatNodes == NULL )
     {
         pabySector = static_cast<GByte *>(VSI_CALLOC_VERBOSE(1, SECTOR_SIZE));
 
@@ -3629,7 +3904,7 @@ int OGROSMDataSource::ResetReading()
 {
     if( hDB == NULL )
         return FALSE;
-    if( bCustomIndexing && fpNodes == NULL )
+    if( bCustomIndexing && poFlatNodes == NULL && fpNodes == NULL )
         return FALSE;
 
     OSM_ResetReading(psParser);
@@ -3688,7 +3963,16 @@ int OGROSMDataSource::ResetReading()
         nNextKeyIndex = 0;
     }
 
-    if( bCustomIndexing )
+    if( poFlatNodes != NULL )
+        poFlatNodes->Clear();
+    if( poFlatWayIndex != NULL )
+    {
+        poFlatWayIndex->Clear();
+        poFlatWayData->Clear();
+        nFlatWayDataSize = 0;
+    }
+
+    if( bCustomIndexing && poFlatNodes == NULL )
     {
         nPrevNodeId = -1;
         nBucketOld = -1;
@@ -116,6 +116,11 @@ void RegisterOGROSM()
 "  <Option name='COMPRESS_NODES' type='boolean' description='Whether to compress nodes in temporary DB.' default='NO'/>"
 "  <Option name='MAX_TMPFILE_SIZE' type='int' description='Maximum size in MB of in-memory temporary file. If it exceeds that value, it will go to disk' default='100'/>"
 "  <Option name='INTERLEAVED_READING' type='boolean' description='Whether to enable interleaved reading.' default='NO'/>"
+"  <Option name='FLAT_NODES' type='boolean' description='Whether to store node coordinates in a flat array indexed by node id.' default='NO'/>"
+"  <Option name='FLAT_NODES_MAX_RAM' type='int' description='Maximum size in MB of the flat node array kept in RAM. Beyond, it goes to a temporary file' default='1024'/>"
+"  <Option name='FLAT_WAYS' type='boolean' description='Whether to store ways in a flat store indexed by way id, instead of the temporary SQLite database.' default='NO'/>"
+"  <Option name='FLAT_WAYS_MAX_RAM' type='int' description='Maximum size in MB of the flat way store kept in RAM. Beyond, it goes to a temporary file' default='512'/>"
+"  <Option name='NUM_THREADS' type='string' description='Number of worker threads used to decode PBF blocks, or ALL_CPUS' default='1'/>"
 "</OpenOptionList>" );
 
     poDriver->pfnOpen = OGROSMDriverOpen;
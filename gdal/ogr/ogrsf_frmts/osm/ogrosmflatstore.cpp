@@ -0,0 +1,357 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  OpenGIS Simple Features Reference Implementation
+ * Purpose:  Implements OGROSMFlatStore class, a sparse byte array split
+ *           between RAM and a temporary file.
+ * Author:   Even Rouault, <even dot rouault at mines dash paris dot org>
+ *
+ ******************************************************************************
+ * Copyright (c) 2016, Even Rouault <even dot rouault at mines-paris dot org>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "ogr_osm.h"
+#include "cpl_conv.h"
+#include "cpl_string.h"
+#include "cpl_virtualmem.h"
+
+CPL_CVSID("$Id$");
+
+/* 512 KB, i.e. 65536 nodes */
+#define FLAT_STORE_CHUNK_SHIFT  19
+#define FLAT_STORE_CHUNK_SIZE   (1 << FLAT_STORE_CHUNK_SHIFT)
+
+/************************************************************************/
+/*                          OGROSMFlatStore()                           */
+/************************************************************************/
+
+OGROSMFlatStore::OGROSMFlatStore( const char* pszTmpFilePrefixIn,
+                                  GUIntBig nMaxRAMSizeIn ) :
+    osTmpFilePrefix(pszTmpFilePrefixIn),
+    fp(NULL),
+    bMustUnlink(false),
+    nFileSize(0),
+    nFlushedFileSize(0),
+    bFileDirty(false),
+    nMaxRAMSize(nMaxRAMSizeIn),
+    nRAMSize(0),
+    pabyWriteChunk(NULL),
+    nWriteChunk(0),
+    bHasWriteChunk(false),
+    psVirtualMem(NULL),
+    nMappedSize(0),
+    bTryMapping(CPLIsVirtualMemFileMapAvailable() != FALSE &&
+                CPLTestBool(CPLGetConfigOption("OSM_FLAT_STORE_MMAP", "YES")))
+{}
+
+/************************************************************************/
+/*                          ~OGROSMFlatStore()                          */
+/************************************************************************/
+
+OGROSMFlatStore::~OGROSMFlatStore()
+{
+    Clear();
+
+    if( fp != NULL )
+        VSIFCloseL(fp);
+    if( bMustUnlink )
+    {
+        const char* pszVal = CPLGetConfigOption("OSM_UNLINK_TMPFILE", "YES");
+        if( !EQUAL(pszVal, "NOT_EVEN_AT_END") )
+            VSIUnlink(osFilename);
+    }
+}
+
+/************************************************************************/
+/*                               Clear()                                */
+/*                                                                      */
+/*      Forget about all the content. The temporary file is kept open   */
+/*      but truncated.                                                  */
+/************************************************************************/
+
+void OGROSMFlatStore::Clear()
+{
+    if( psVirtualMem != NULL )
+    {
+        CPLVirtualMemFree(psVirtualMem);
+        psVirtualMem = NULL;
+    }
+    nMappedSize = 0;
+
+    for( size_t i = 0; i < apabyChunks.size(); i++ )
+        CPLFree(apabyChunks[i]);
+    apabyChunks.resize(0);
+    anChunkOffsets.resize(0);
+    nRAMSize = 0;
+
+    CPLFree(pabyWriteChunk);
+    pabyWriteChunk = NULL;
+    bHasWriteChunk = false;
+
+    if( fp != NULL )
+    {
+        VSIFSeekL(fp, 0, SEEK_SET);
+        VSIFTruncateL(fp, 0);
+    }
+    nFileSize = 0;
+    nFlushedFileSize = 0;
+    bFileDirty = false;
+}
+
+/************************************************************************/
+/*                           OpenTmpFile()                              */
+/************************************************************************/
+
+bool OGROSMFlatStore::OpenTmpFile()
+{
+    osFilename = CPLGenerateTempFilename(osTmpFilePrefix);
+    CPLDebug("OSM", "Using %s as temporary file", osFilename.c_str());
+
+    fp = VSIFOpenL(osFilename, "wb+");
+    if( fp == NULL )
+    {
+        CPLError(CE_Failure, CPLE_FileIO,
+                 "Cannot create temporary file %s", osFilename.c_str());
+        return false;
+    }
+    bMustUnlink = true;
+
+    /* On Unix filesystems, you can remove a file even if it */
+    /* opened */
+    const char* pszVal = CPLGetConfigOption("OSM_UNLINK_TMPFILE", "YES");
+    if( EQUAL(pszVal, "YES") )
+    {
+        CPLPushErrorHandler(CPLQuietErrorHandler);
+        bMustUnlink = VSIUnlink( osFilename ) != 0;
+        CPLPopErrorHandler();
+    }
+
+    return true;
+}
+
+/************************************************************************/
+/*                          FlushWriteChunk()                           */
+/************************************************************************/
+
+bool OGROSMFlatStore::FlushWriteChunk()
+{
+    if( !bHasWriteChunk )
+        return true;
+    bHasWriteChunk = false;
+
+    const GUIntBig nOffset = anChunkOffsets[nWriteChunk] - 1;
+    if( VSIFSeekL(fp, nOffset, SEEK_SET) != 0 ||
+        VSIFWriteL(pabyWriteChunk, 1, FLAT_STORE_CHUNK_SIZE, fp) !=
+                                                    FLAT_STORE_CHUNK_SIZE )
+    {
+        CPLError(CE_Failure, CPLE_FileIO,
+                 "Cannot write in temporary file %s : %s",
+                 osFilename.c_str(), VSIStrerror(errno));
+        return false;
+    }
+    if( nOffset + FLAT_STORE_CHUNK_SIZE > nFlushedFileSize )
+        nFlushedFileSize = nOffset + FLAT_STORE_CHUNK_SIZE;
+    bFileDirty = true;
+    return true;
+}
+
+/************************************************************************/
+/*                        GetChunkForWriting()                          */
+/*                                                                      */
+/*      Return a pointer to the content of a chunk, allocating it in    */
+/*      RAM while the budget allows it, and in the temporary file       */
+/*      otherwise. Chunks of the file are modified through a single     */
+/*      chunk sized buffer, which is efficient when ids are written     */
+/*      in increasing order.                                            */
+/************************************************************************/
+
+GByte* OGROSMFlatStore::GetChunkForWriting( size_t iChunk )
+{
+    if( iChunk >= apabyChunks.size() )
+    {
+        apabyChunks.resize(iChunk + 1, NULL);
+        anChunkOffsets.resize(iChunk + 1, 0);
+    }
+
+    if( apabyChunks[iChunk] != NULL )
+        return apabyChunks[iChunk];
+
+    if( anChunkOffsets[iChunk] == 0 &&
+        nRAMSize + FLAT_STORE_CHUNK_SIZE <= nMaxRAMSize )
+    {
+        apabyChunks[iChunk] = static_cast<GByte*>(
+            VSI_CALLOC_VERBOSE(1, FLAT_STORE_CHUNK_SIZE));
+        if( apabyChunks[iChunk] != NULL )
+        {
+            nRAMSize += FLAT_STORE_CHUNK_SIZE;
+            return apabyChunks[iChunk];
+        }
+        /* Go on with the temporary file */
+    }
+
+    if( bHasWriteChunk && nWriteChunk == iChunk )
+        return pabyWriteChunk;
+
+    if( fp == NULL && !OpenTmpFile() )
+        return NULL;
+    if( pabyWriteChunk == NULL )
+    {
+        pabyWriteChunk = static_cast<GByte*>(
+            VSI_MALLOC_VERBOSE(FLAT_STORE_CHUNK_SIZE));
+        if( pabyWriteChunk == NULL )
+            return NULL;
+    }
+    if( !FlushWriteChunk() )
+        return NULL;
+
+    if( anChunkOffsets[iChunk] == 0 )
+    {
+        memset(pabyWriteChunk, 0, FLAT_STORE_CHUNK_SIZE);
+        anChunkOffsets[iChunk] = nFileSize + 1;
+        nFileSize += FLAT_STORE_CHUNK_SIZE;
+    }
+    else if( VSIFSeekL(fp, anChunkOffsets[iChunk] - 1, SEEK_SET) != 0 ||
+             VSIFReadL(pabyWriteChunk, 1, FLAT_STORE_CHUNK_SIZE, fp) !=
+                                                    FLAT_STORE_CHUNK_SIZE )
+    {
+        CPLError(CE_Failure, CPLE_FileIO,
+                 "Cannot read in temporary file %s", osFilename.c_str());
+        return NULL;
+    }
+
+    nWriteChunk = iChunk;
+    bHasWriteChunk = true;
+    return pabyWriteChunk;
+}
+
+/************************************************************************/
+/*                               Write()                                */
+/************************************************************************/
+
+bool OGROSMFlatStore::Write( GUIntBig nOffset, const void* pData,
+                             size_t nSize )
+{
+    const GByte* pabyData = static_cast<const GByte*>(pData);
+    while( nSize > 0 )
+    {
+        const size_t iChunk =
+            static_cast<size_t>(nOffset >> FLAT_STORE_CHUNK_SHIFT);
+        const size_t nOffInChunk =
+            static_cast<size_t>(nOffset & (FLAT_STORE_CHUNK_SIZE - 1));
+        const size_t nToCopy = MIN(nSize, FLAT_STORE_CHUNK_SIZE - nOffInChunk);
+
+        GByte* pabyChunk = GetChunkForWriting(iChunk);
+        if( pabyChunk == NULL )
+            return false;
+        memcpy(pabyChunk + nOffInChunk, pabyData, nToCopy);
+
+        pabyData += nToCopy;
+        nOffset += nToCopy;
+        nSize -= nToCopy;
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                               Read()                                 */
+/*                                                                      */
+/*      Ranges that have never been written read as zeroes.             */
+/************************************************************************/
+
+bool OGROSMFlatStore::Read( GUIntBig nOffset, void* pData, size_t nSize )
+{
+    GByte* pabyData = static_cast<GByte*>(pData);
+    while( nSize > 0 )
+    {
+        const size_t iChunk =
+            static_cast<size_t>(nOffset >> FLAT_STORE_CHUNK_SHIFT);
+        const size_t nOffInChunk =
+            static_cast<size_t>(nOffset & (FLAT_STORE_CHUNK_SIZE - 1));
+        const size_t nToCopy = MIN(nSize, FLAT_STORE_CHUNK_SIZE - nOffInChunk);
+
+        if( iChunk >= apabyChunks.size() ||
+            (apabyChunks[iChunk] == NULL && anChunkOffsets[iChunk] == 0) )
+        {
+            memset(pabyData, 0, nToCopy);
+        }
+        else if( apabyChunks[iChunk] != NULL )
+        {
+            memcpy(pabyData, apabyChunks[iChunk] + nOffInChunk, nToCopy);
+        }
+        else if( bHasWriteChunk && nWriteChunk == iChunk )
+        {
+            memcpy(pabyData, pabyWriteChunk + nOffInChunk, nToCopy);
+        }
+        else
+        {
+            const GUIntBig nFileOffset =
+                anChunkOffsets[iChunk] - 1 + nOffInChunk;
+
+            /* Chunks other than the write chunk have been flushed, so */
+            /* (re)map the file if it has grown since the last mapping. */
+            if( bTryMapping && nFileOffset + nToCopy > nMappedSize )
+            {
+                if( psVirtualMem != NULL )
+                    CPLVirtualMemFree(psVirtualMem);
+                nMappedSize = 0;
+                VSIFFlushL(fp);
+                bFileDirty = false;
+                psVirtualMem = CPLVirtualMemFileMapNew(
+                    fp, 0, nFlushedFileSize, VIRTUALMEM_READONLY, NULL, NULL);
+                if( psVirtualMem == NULL )
+                {
+                    CPLDebug("OSM", "Cannot map %s. Using regular I/O",
+                             osFilename.c_str());
+                    bTryMapping = false;
+                }
+                else
+                    nMappedSize = nFlushedFileSize;
+            }
+
+            if( psVirtualMem != NULL && nFileOffset + nToCopy <= nMappedSize )
+            {
+                /* The mapping shares the page cache, but not the buffer */
+                /* of the file handle */
+                if( bFileDirty )
+                {
+                    VSIFFlushL(fp);
+                    bFileDirty = false;
+                }
+                const GByte* pabyMapping = static_cast<const GByte*>(
+                    CPLVirtualMemGetAddr(psVirtualMem));
+                memcpy(pabyData, pabyMapping + nFileOffset, nToCopy);
+            }
+            else if( VSIFSeekL(fp, nFileOffset, SEEK_SET) != 0 ||
+                     VSIFReadL(pabyData, 1, nToCopy, fp) != nToCopy )
+            {
+                CPLError(CE_Failure, CPLE_FileIO,
+                         "Cannot read in temporary file %s",
+                         osFilename.c_str());
+                return false;
+            }
+        }
+
+        pabyData += nToCopy;
+        nOffset += nToCopy;
+        nSize -= nToCopy;
+    }
+    return true;
+}
@@ -31,8 +31,13 @@
 #include "gpb.h"
 
 #include "cpl_conv.h"
+#include "cpl_multiproc.h"
 #include "cpl_string.h"
 #include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
+
+#include <list>
+#include <vector>
 
 #ifdef HAVE_EXPAT
 #include "ogr_expat.h"
@@ -61,6 +66,11 @@ CPL_CVSID("$Id$");
 /*    \    sInfo.nVisible = 1; */
 
 
+class OSMBlockPipeline;
+
+static void PBF_DestroyPipeline( OSMBlockPipeline* poPipeline );
+static void PBF_DrainPipeline( OSMBlockPipeline* poPipeline );
+
 /************************************************************************/
 /*                            _OSMContext                               */
 /************************************************************************/
@@ -132,6 +142,9 @@ struct _OSMContext
     NotifyRelationFunc  pfnNotifyRelation;
     NotifyBoundsFunc    pfnNotifyBounds;
     void               *user_data;
+
+    /* Only set for PBF files decoded by worker threads */
+    OSMBlockPipeline   *poPipeline;
 };
 
 /************************************************************************/
@@ -2325,6 +2338,9 @@ void OSM_Close(OSMContext* psCtxt)
     if( psCtxt == NULL )
         return;
 
+    if( psCtxt->poPipeline != NULL )
+        PBF_DestroyPipeline(psCtxt->poPipeline);
+
 #ifdef HAVE_EXPAT
     if( !psCtxt->bPBF )
     {
@@ -2352,6 +2368,9 @@ void OSM_Close(OSMContext* psCtxt)
 
 void OSM_ResetReading( OSMContext* psCtxt )
 {
+    if( psCtxt->poPipeline != NULL )
+        PBF_DrainPipeline(psCtxt->poPipeline);
+
     VSIFSeekL(psCtxt->fp, 0, SEEK_SET);
 
     psCtxt->nBytesRead = 0;
@@ -2381,10 +2400,18 @@ void OSM_ResetReading( OSMContext* psCtxt )
 }
 
 /************************************************************************/
-/*                          OSM_ProcessBlock()                          */
+/*                            PBF_ReadBlob()                            */
+/*                                                                      */
+/*      Read the next BlobHeader and its Blob into *ppabyBlob, which    */
+/*      is grown as needed.                                             */
 /************************************************************************/
 
-static OSMRetCode PBF_ProcessBlock(OSMContext* psCtxt)
+static OSMRetCode PBF_ReadBlob(VSILFILE* fp,
+                               GByte** ppabyBlob,
+                               unsigned int* pnBlobSizeAllocated,
+                               unsigned int* pnBlobSize,
+                               BlobType* peType,
+                               GUIntBig* pnBytesRead)
 {
     int nRet = FALSE;
     GByte abyHeaderSize[4];
@@ -2392,51 +2419,49 @@ static OSMRetCode PBF_ProcessBlock(OSMContext* psCtxt)
     unsigned int nBlobSize = 0;
     BlobType eType;
 
-    if (VSIFReadL(abyHeaderSize, 4, 1, psCtxt->fp) != 1)
+    if (VSIFReadL(abyHeaderSize, 4, 1, fp) != 1)
     {
         return OSM_EOF;
     }
     nHeaderSize = (abyHeaderSize[0] << 24) | (abyHeaderSize[1] << 16) |
                     (abyHeaderSize[2] << 8) | abyHeaderSize[3];
 
-    psCtxt->nBytesRead += 4;
+    *pnBytesRead += 4;
 
     /* printf("nHeaderSize = %d\n", nHeaderSize); */
     if (nHeaderSize > 64 * 1024)
         GOTO_END_ERROR;
-    if (VSIFReadL(psCtxt->pabyBlob, 1, nHeaderSize, psCtxt->fp) != nHeaderSize)
+    if (VSIFReadL(*ppabyBlob, 1, nHeaderSize, fp) != nHeaderSize)
         GOTO_END_ERROR;
 
-    psCtxt->nBytesRead += nHeaderSize;
+    *pnBytesRead += nHeaderSize;
 
-    memset(psCtxt->pabyBlob + nHeaderSize, 0, EXTRA_BYTES);
-    nRet = ReadBlobHeader(psCtxt->pabyBlob, psCtxt->pabyBlob + nHeaderSize, &nBlobSize, &eType);
+    memset(*ppabyBlob + nHeaderSize, 0, EXTRA_BYTES);
+    nRet = ReadBlobHeader(*ppabyBlob, *ppabyBlob + nHeaderSize, &nBlobSize, &eType);
     if (!nRet || eType == BLOB_UNKNOWN)
         GOTO_END_ERROR;
 
     if (nBlobSize > 64*1024*1024)
         GOTO_END_ERROR;
-    if (nBlobSize > psCtxt->nBlobSizeAllocated)
+    if (nBlobSize > *pnBlobSizeAllocated)
     {
         GByte* pabyBlobNew;
-        psCtxt->nBlobSizeAllocated = MAX(psCtxt->nBlobSizeAllocated * 2, nBlobSize);
-        pabyBlobNew = (GByte*)VSI_REALLOC_VERBOSE(psCtxt->pabyBlob,
-                                        psCtxt->nBlobSizeAllocated + EXTRA_BYTES);
+        *pnBlobSizeAllocated = MAX(*pnBlobSizeAllocated * 2, nBlobSize);
+        pabyBlobNew = (GByte*)VSI_REALLOC_VERBOSE(*ppabyBlob,
+                                        *pnBlobSizeAllocated + EXTRA_BYTES);
         if( pabyBlobNew == NULL )
             GOTO_END_ERROR;
-        psCtxt->pabyBlob = pabyBlobNew;
+        *ppabyBlob = pabyBlobNew;
     }
-    if (VSIFReadL(psCtxt->pabyBlob, 1, nBlobSize, psCtxt->fp) != nBlobSize)
+    if (VSIFReadL(*ppabyBlob, 1, nBlobSize, fp) != nBlobSize)
         GOTO_END_ERROR;
 
-    psCtxt->nBytesRead += nBlobSize;
+    *pnBytesRead += nBlobSize;
 
-    memset(psCtxt->pabyBlob + nBlobSize, 0, EXTRA_BYTES);
-    nRet = ReadBlob(psCtxt->pabyBlob, nBlobSize, eType,
-                    psCtxt);
-    if (!nRet)
-        GOTO_END_ERROR;
+    memset(*ppabyBlob + nBlobSize, 0, EXTRA_BYTES);
 
+    *pnBlobSize = nBlobSize;
+    *peType = eType;
     return OSM_OK;
 
 end_error:
@@ -2444,12 +2469,542 @@ end_error:
     return OSM_ERROR;
 }
 
+/************************************************************************/
+/*                          PBF_ProcessBlock()                          */
+/************************************************************************/
+
+static OSMRetCode PBF_ProcessBlock(OSMContext* psCtxt)
+{
+    unsigned int nBlobSize = 0;
+    BlobType eType = BLOB_UNKNOWN;
+
+    OSMRetCode eRet = PBF_ReadBlob(psCtxt->fp,
+                                   &psCtxt->pabyBlob,
+                                   &psCtxt->nBlobSizeAllocated,
+                                   &nBlobSize, &eType,
+                                   &psCtxt->nBytesRead);
+    if( eRet != OSM_OK )
+        return eRet;
+
+    if (!ReadBlob(psCtxt->pabyBlob, nBlobSize, eType, psCtxt))
+        return OSM_ERROR;
+
+    return OSM_OK;
+}
+
+/************************************************************************/
+/*                           OSMDecodedBlock                            */
+/*                                                                      */
+/*      PBF blob decoded by a worker thread.  The notifications that    */
+/*      ReadBlob() issues are recorded, with copies of the node, way    */
+/*      and relation arrays, to be replayed in file order by the        */
+/*      thread calling OSM_ProcessBlock().  Strings still point into    */
+/*      the buffers of psDecodeCtxt and pabyBlob, so the block is only  */
+/*      recycled once replayed.                                         */
+/************************************************************************/
+
+typedef enum
+{
+    OSM_EVENT_NODES,
+    OSM_EVENT_WAY,
+    OSM_EVENT_RELATION,
+    OSM_EVENT_BOUNDS
+} OSMEventType;
+
+typedef struct
+{
+    OSMEventType  eType;
+    size_t        nIdx;
+    unsigned int  nCount;
+} OSMEvent;
+
+class OSMDecodedBlock
+{
+  public:
+    OSMBlockPipeline           *poPipeline;
+    OSMContext                 *psDecodeCtxt;
+
+    GByte                      *pabyBlob;
+    unsigned int                nBlobSizeAllocated;
+    unsigned int                nBlobSize;
+    BlobType                    eType;
+    GUIntBig                    nBytesRead;
+
+    bool                        bOK;
+    bool                        bDone;  /* protected by poPipeline->hMutex */
+
+    std::vector<OSMEvent>       asEvents;
+    std::vector<OSMNode>        asNodes;
+    std::vector<OSMWay>         asWays;
+    std::vector<OSMRelation>    asRelations;
+    std::vector<OSMTag>         asTags;
+    std::vector<GIntBig>        anNodeRefs;
+    std::vector<OSMMember>      asMembers;
+    std::vector<double>         adfBounds;
+
+    /* Offsets in asTags, anNodeRefs and asMembers, turned into */
+    /* pointers once the decoding is finished. */
+    std::vector<size_t>         anNodeTagIdx;
+    std::vector<size_t>         anWayTagIdx;
+    std::vector<size_t>         anWayRefIdx;
+    std::vector<size_t>         anRelationTagIdx;
+    std::vector<size_t>         anRelationMemberIdx;
+
+                                OSMDecodedBlock( OSMBlockPipeline* poPipelineIn );
+                               ~OSMDecodedBlock();
+
+    void                        Clear();
+    void                        ResolvePointers();
+};
+
+/************************************************************************/
+/*                           OSMBlockPipeline                           */
+/************************************************************************/
+
+class OSMBlockPipeline
+{
+  public:
+    int                             nThreads;
+    CPLWorkerThreadPool             oPool;
+    CPLMutex                       *hMutex;
+    CPLCond                        *hCond;
+    std::list<OSMDecodedBlock*>     oQueue;     /* in file order */
+    std::vector<OSMDecodedBlock*>   apoFreeBlocks;
+    bool                            bReadEOF;
+
+                                    OSMBlockPipeline();
+                                   ~OSMBlockPipeline();
+
+    void                            Drain();
+};
+
+/************************************************************************/
+/*                         Recording callbacks                          */
+/************************************************************************/
+
+static void OSM_RecordNodes( unsigned int nNodes, OSMNode* pasNodes,
+                             OSMContext* /* psCtxt */, void* user_data )
+{
+    OSMDecodedBlock* poBlock = static_cast<OSMDecodedBlock*>(user_data);
+
+    OSMEvent sEvent;
+    sEvent.eType = OSM_EVENT_NODES;
+    sEvent.nIdx = poBlock->asNodes.size();
+    sEvent.nCount = nNodes;
+    poBlock->asEvents.push_back(sEvent);
+
+    for( unsigned int i = 0; i < nNodes; i++ )
+    {
+        poBlock->asNodes.push_back(pasNodes[i]);
+        poBlock->anNodeTagIdx.push_back(poBlock->asTags.size());
+        if( pasNodes[i].pasTags != NULL )
+            poBlock->asTags.insert(poBlock->asTags.end(),
+                                   pasNodes[i].pasTags,
+                                   pasNodes[i].pasTags + pasNodes[i].nTags);
+    }
+}
+
+static void OSM_RecordWay( OSMWay* psWay,
+                           OSMContext* /* psCtxt */, void* user_data )
+{
+    OSMDecodedBlock* poBlock = static_cast<OSMDecodedBlock*>(user_data);
+
+    OSMEvent sEvent;
+    sEvent.eType = OSM_EVENT_WAY;
+    sEvent.nIdx = poBlock->asWays.size();
+    sEvent.nCount = 1;
+    poBlock->asEvents.push_back(sEvent);
+
+    poBlock->asWays.push_back(*psWay);
+    poBlock->anWayTagIdx.push_back(poBlock->asTags.size());
+    if( psWay->pasTags != NULL )
+        poBlock->asTags.insert(poBlock->asTags.end(),
+                               psWay->pasTags,
+                               psWay->pasTags + psWay->nTags);
+    poBlock->anWayRefIdx.push_back(poBlock->anNodeRefs.size());
+    if( psWay->panNodeRefs != NULL )
+        poBlock->anNodeRefs.insert(poBlock->anNodeRefs.end(),
+                                   psWay->panNodeRefs,
+                                   psWay->panNodeRefs + psWay->nRefs);
+}
+
+static void OSM_RecordRelation( OSMRelation* psRelation,
+                                OSMContext* /* psCtxt */, void* user_data )
+{
+    OSMDecodedBlock* poBlock = static_cast<OSMDecodedBlock*>(user_data);
+
+    OSMEvent sEvent;
+    sEvent.eType = OSM_EVENT_RELATION;
+    sEvent.nIdx = poBlock->asRelations.size();
+    sEvent.nCount = 1;
+    poBlock->asEvents.push_back(sEvent);
+
+    poBlock->asRelations.push_back(*psRelation);
+    poBlock->anRelationTagIdx.push_back(poBlock->asTags.size());
+    if( psRelation->pasTags != NULL )
+        poBlock->asTags.insert(poBlock->asTags.end(),
+                               psRelation->pasTags,
+                               psRelation->pasTags + psRelation->nTags);
+    poBlock->anRelationMemberIdx.push_back(poBlock->asMembers.size());
+    if( psRelation->pasMembers != NULL )
+        poBlock->asMembers.insert(poBlock->asMembers.end(),
+                                  psRelation->pasMembers,
+                                  psRelation->pasMembers +
+                                                    psRelation->nMembers);
+}
+
+static void OSM_RecordBounds( double dfXMin, double dfYMin,
+                              double dfXMax, double dfYMax,
+                              OSMContext* /* psCtxt */, void* user_data )
+{
+    OSMDecodedBlock* poBlock = static_cast<OSMDecodedBlock*>(user_data);
+
+    OSMEvent sEvent;
+    sEvent.eType = OSM_EVENT_BOUNDS;
+    sEvent.nIdx = poBlock->adfBounds.size();
+    sEvent.nCount = 1;
+    poBlock->asEvents.push_back(sEvent);
+
+    poBlock->adfBounds.push_back(dfXMin);
+    poBlock->adfBounds.push_back(dfYMin);
+    poBlock->adfBounds.push_back(dfXMax);
+    poBlock->adfBounds.push_back(dfYMax);
+}
+
+/************************************************************************/
+/*                          OSMDecodedBlock()                           */
+/************************************************************************/
+
+OSMDecodedBlock::OSMDecodedBlock( OSMBlockPipeline* poPipelineIn ) :
+    poPipeline(poPipelineIn),
+    psDecodeCtxt(NULL),
+    pabyBlob(NULL),
+    nBlobSizeAllocated(0),
+    nBlobSize(0),
+    eType(BLOB_UNKNOWN),
+    nBytesRead(0),
+    bOK(false),
+    bDone(false)
+{
+    psDecodeCtxt = static_cast<OSMContext *>(
+        CPLCalloc(1, sizeof(OSMContext)) );
+    psDecodeCtxt->bPBF = TRUE;
+    psDecodeCtxt->pfnNotifyNodes = OSM_RecordNodes;
+    psDecodeCtxt->pfnNotifyWay = OSM_RecordWay;
+    psDecodeCtxt->pfnNotifyRelation = OSM_RecordRelation;
+    psDecodeCtxt->pfnNotifyBounds = OSM_RecordBounds;
+    psDecodeCtxt->user_data = this;
+
+    nBlobSizeAllocated = 64 * 1024 + EXTRA_BYTES;
+    pabyBlob = static_cast<GByte *>(
+        CPLMalloc(nBlobSizeAllocated + EXTRA_BYTES) );
+}
+
+/************************************************************************/
+/*                          ~OSMDecodedBlock()                          */
+/************************************************************************/
+
+OSMDecodedBlock::~OSMDecodedBlock()
+{
+    VSIFree(pabyBlob);
+    VSIFree(psDecodeCtxt->pabyUncompressed);
+    VSIFree(psDecodeCtxt->panStrOff);
+    VSIFree(psDecodeCtxt->pasNodes);
+    VSIFree(psDecodeCtxt->pasTags);
+    VSIFree(psDecodeCtxt->pasMembers);
+    VSIFree(psDecodeCtxt->panNodeRefs);
+    VSIFree(psDecodeCtxt);
+}
+
+/************************************************************************/
+/*                               Clear()                                */
+/*                                                                      */
+/*      Forget about the recorded notifications, but keep the           */
+/*      allocated memory for the next blob.                             */
+/************************************************************************/
+
+void OSMDecodedBlock::Clear()
+{
+    nBlobSize = 0;
+    eType = BLOB_UNKNOWN;
+    nBytesRead = 0;
+    bOK = false;
+    bDone = false;
+    asEvents.resize(0);
+    asNodes.resize(0);
+    asWays.resize(0);
+    asRelations.resize(0);
+    asTags.resize(0);
+    anNodeRefs.resize(0);
+    asMembers.resize(0);
+    adfBounds.resize(0);
+    anNodeTagIdx.resize(0);
+    anWayTagIdx.resize(0);
+    anWayRefIdx.resize(0);
+    anRelationTagIdx.resize(0);
+    anRelationMemberIdx.resize(0);
+}
+
+/************************************************************************/
+/*                          ResolvePointers()                           */
+/************************************************************************/
+
+void OSMDecodedBlock::ResolvePointers()
+{
+    for( size_t i = 0; i < asNodes.size(); i++ )
+    {
+        if( asNodes[i].pasTags != NULL && asNodes[i].nTags > 0 )
+            asNodes[i].pasTags = &asTags[anNodeTagIdx[i]];
+        else
+            asNodes[i].pasTags = NULL;
+    }
+    for( size_t i = 0; i < asWays.size(); i++ )
+    {
+        if( asWays[i].pasTags != NULL && asWays[i].nTags > 0 )
+            asWays[i].pasTags = &asTags[anWayTagIdx[i]];
+        else
+            asWays[i].pasTags = NULL;
+        if( asWays[i].panNodeRefs != NULL && asWays[i].nRefs > 0 )
+            asWays[i].panNodeRefs = &anNodeRefs[anWayRefIdx[i]];
+    }
+    for( size_t i = 0; i < asRelations.size(); i++ )
+    {
+        if( asRelations[i].pasTags != NULL && asRelations[i].nTags > 0 )
+            asRelations[i].pasTags = &asTags[anRelationTagIdx[i]];
+        else
+            asRelations[i].pasTags = NULL;
+        if( asRelations[i].pasMembers != NULL &&
+            asRelations[i].nMembers > 0 )
+            asRelations[i].pasMembers =
+                &asMembers[anRelationMemberIdx[i]];
+    }
+}
+
+/************************************************************************/
+/*                          OSMBlockPipeline()                          */
+/************************************************************************/
+
+OSMBlockPipeline::OSMBlockPipeline() :
+    nThreads(0),
+    hMutex(NULL),
+    hCond(NULL),
+    bReadEOF(false)
+{
+    hMutex = CPLCreateMutex();
+    CPLReleaseMutex(hMutex);
+    hCond = CPLCreateCond();
+}
+
+/************************************************************************/
+/*                         ~OSMBlockPipeline()                          */
+/************************************************************************/
+
+OSMBlockPipeline::~OSMBlockPipeline()
+{
+    Drain();
+    for( size_t i = 0; i < apoFreeBlocks.size(); i++ )
+        delete apoFreeBlocks[i];
+    CPLDestroyCond(hCond);
+    CPLDestroyMutex(hMutex);
+}
+
+/************************************************************************/
+/*                               Drain()                                */
+/*                                                                      */
+/*      Wait for the pending decoding jobs, and discard their result.   */
+/************************************************************************/
+
+void OSMBlockPipeline::Drain()
+{
+    oPool.WaitCompletion();
+    for( std::list<OSMDecodedBlock*>::iterator oIter = oQueue.begin();
+         oIter != oQueue.end(); ++oIter )
+    {
+        apoFreeBlocks.push_back(*oIter);
+    }
+    oQueue.clear();
+    bReadEOF = false;
+}
+
+/************************************************************************/
+/*                         PBF_DrainPipeline()                          */
+/************************************************************************/
+
+static void PBF_DrainPipeline( OSMBlockPipeline* poPipeline )
+{
+    poPipeline->Drain();
+}
+
+/************************************************************************/
+/*                        PBF_DestroyPipeline()                         */
+/************************************************************************/
+
+static void PBF_DestroyPipeline( OSMBlockPipeline* poPipeline )
+{
+    delete poPipeline;
+}
+
+/************************************************************************/
+/*                         PBF_DecodeBlockJob()                         */
+/************************************************************************/
+
+static void PBF_DecodeBlockJob(void* pData)
+{
+    OSMDecodedBlock* poBlock = static_cast<OSMDecodedBlock*>(pData);
+
+    poBlock->bOK = ReadBlob(poBlock->pabyBlob, poBlock->nBlobSize,
+                            poBlock->eType, poBlock->psDecodeCtxt) != FALSE;
+    if( poBlock->bOK )
+        poBlock->ResolvePointers();
+
+    OSMBlockPipeline* poPipeline = poBlock->poPipeline;
+    CPLAcquireMutex(poPipeline->hMutex, 1000.0);
+    poBlock->bDone = true;
+    CPLCondBroadcast(poPipeline->hCond);
+    CPLReleaseMutex(poPipeline->hMutex);
+}
+
+/************************************************************************/
+/*                       PBF_ProcessBlockThreaded()                     */
+/*                                                                      */
+/*      Keep up to 2 blobs per thread read ahead and decoding, and      */
+/*      replay the notifications of the oldest one.                     */
+/************************************************************************/
+
+static OSMRetCode PBF_ProcessBlockThreaded(OSMContext* psCtxt)
+{
+    OSMBlockPipeline* poPipeline = psCtxt->poPipeline;
+
+    while( !poPipeline->bReadEOF &&
+           static_cast<int>(poPipeline->oQueue.size()) <
+                                                2 * poPipeline->nThreads )
+    {
+        OSMDecodedBlock* poBlock;
+        if( !poPipeline->apoFreeBlocks.empty() )
+        {
+            poBlock = poPipeline->apoFreeBlocks.back();
+            poPipeline->apoFreeBlocks.pop_back();
+        }
+        else
+            poBlock = new OSMDecodedBlock(poPipeline);
+        poBlock->Clear();
+
+        OSMRetCode eRet = PBF_ReadBlob(psCtxt->fp,
+                                       &poBlock->pabyBlob,
+                                       &poBlock->nBlobSizeAllocated,
+                                       &poBlock->nBlobSize,
+                                       &poBlock->eType,
+                                       &poBlock->nBytesRead);
+        if( eRet != OSM_OK )
+        {
+            poPipeline->bReadEOF = true;
+            if( eRet == OSM_EOF )
+            {
+                poPipeline->apoFreeBlocks.push_back(poBlock);
+                break;
+            }
+            /* Report the error once the previous blobs are consumed */
+            poBlock->bDone = true;
+            poPipeline->oQueue.push_back(poBlock);
+            break;
+        }
+
+        poPipeline->oQueue.push_back(poBlock);
+        poPipeline->oPool.SubmitJob(PBF_DecodeBlockJob, poBlock);
+    }
+
+    if( poPipeline->oQueue.empty() )
+        return OSM_EOF;
+
+    OSMDecodedBlock* poBlock = poPipeline->oQueue.front();
+    poPipeline->oQueue.pop_front();
+
+    CPLAcquireMutex(poPipeline->hMutex, 1000.0);
+    while( !poBlock->bDone )
+        CPLCondWait(poPipeline->hCond, poPipeline->hMutex);
+    CPLReleaseMutex(poPipeline->hMutex);
+
+    psCtxt->nBytesRead += poBlock->nBytesRead;
+
+    if( !poBlock->bOK )
+    {
+        poPipeline->apoFreeBlocks.push_back(poBlock);
+        return OSM_ERROR;
+    }
+
+    for( size_t i = 0; i < poBlock->asEvents.size(); i++ )
+    {
+        const OSMEvent& sEvent = poBlock->asEvents[i];
+        switch( sEvent.eType )
+        {
+            case OSM_EVENT_NODES:
+                psCtxt->pfnNotifyNodes(sEvent.nCount,
+                                       &poBlock->asNodes[sEvent.nIdx],
+                                       psCtxt, psCtxt->user_data);
+                break;
+            case OSM_EVENT_WAY:
+                psCtxt->pfnNotifyWay(&poBlock->asWays[sEvent.nIdx],
+                                     psCtxt, psCtxt->user_data);
+                break;
+            case OSM_EVENT_RELATION:
+                psCtxt->pfnNotifyRelation(&poBlock->asRelations[sEvent.nIdx],
+                                          psCtxt, psCtxt->user_data);
+                break;
+            case OSM_EVENT_BOUNDS:
+                psCtxt->pfnNotifyBounds(poBlock->adfBounds[sEvent.nIdx],
+                                        poBlock->adfBounds[sEvent.nIdx+1],
+                                        poBlock->adfBounds[sEvent.nIdx+2],
+                                        poBlock->adfBounds[sEvent.nIdx+3],
+                                        psCtxt, psCtxt->user_data);
+                break;
+        }
+    }
+
+    poPipeline->apoFreeBlocks.push_back(poBlock);
+    return OSM_OK;
+}
+
+/************************************************************************/
+/*                          OSM_SetNumThreads()                         */
+/*                                                                      */
+/*      Decode the blobs of a PBF file with nThreads worker threads.    */
+/*      The callbacks are still called from the thread that calls       */
+/*      OSM_ProcessBlock(), in file order.  No effect for OSM XML.      */
+/************************************************************************/
+
+void OSM_SetNumThreads( OSMContext* psCtxt, int nThreads )
+{
+    if( !psCtxt->bPBF )
+        return;
+
+    if( psCtxt->poPipeline != NULL )
+    {
+        /* Blobs read ahead would be lost */
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "OSM_SetNumThreads() can only be called once");
+        return;
+    }
+    if( nThreads <= 1 )
+        return;
+
+    OSMBlockPipeline* poPipeline = new OSMBlockPipeline();
+    if( !poPipeline->oPool.Setup(nThreads, NULL, NULL) )
+    {
+        delete poPipeline;
+        return;
+    }
+    poPipeline->nThreads = nThreads;
+    psCtxt->poPipeline = poPipeline;
+}
+
 /************************************************************************/
 /*                          OSM_ProcessBlock()                          */
 /************************************************************************/
 
 OSMRetCode OSM_ProcessBlock(OSMContext* psCtxt)
 {
+    if( psCtxt->poPipeline != NULL )
+        return PBF_ProcessBlockThreaded(psCtxt);
 #ifdef HAVE_EXPAT
     if( psCtxt->bPBF )
         return PBF_ProcessBlock(psCtxt);
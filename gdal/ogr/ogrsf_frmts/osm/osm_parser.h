@@ -126,6 +126,8 @@ void OSM_ResetReading( OSMContext* psOSMContext );
 
 OSMRetCode OSM_ProcessBlock( OSMContext* psOSMContext );
 
+void OSM_SetNumThreads( OSMContext* psOSMContext, int nThreads );
+
 void OSM_Close( OSMContext* psOSMContext );
 
 CPL_C_END
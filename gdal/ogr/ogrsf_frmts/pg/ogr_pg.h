@@ -38,6 +38,8 @@
 #include "ogrpgutility.h"
 #include "ogr_pgdump.h"
 
+#include <vector>
+
 /* These are the OIDs for some builtin types, as returned by PQftype(). */
 /* They were copied from pg_type.h in src/include/catalog/pg_type.h */
 
@@ -279,9 +281,14 @@ class OGRPGTableLayer : public OGRPGLayer
     int                 bFIDColumnInCopyFields;
     int                 bFirstInsertion;
 
+    int                 bBinaryCopy;
+    std::vector<int>    anBinaryCopyEncodings;
+
     OGRErr		CreateFeatureViaCopy( OGRFeature *poFeature );
+    OGRErr		CreateFeatureViaBinaryCopy( OGRFeature *poFeature );
     OGRErr		CreateFeatureViaInsert( OGRFeature *poFeature );
     CPLString           BuildCopyFields();
+    int                 SetupBinaryCopy();
 
     int                 bHasWarnedIncompatibleGeom;
     void                CheckGeomTypeCompatibility(int iGeomField, OGRGeometry* poGeom);
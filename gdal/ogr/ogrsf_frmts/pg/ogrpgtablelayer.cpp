@@ -35,6 +35,8 @@
 #include "cpl_error.h"
 #include "ogr_p.h"
 
+#include <map>
+
 #define PQexec this_is_an_error
 
 CPL_CVSID("$Id$");
@@ -145,6 +147,7 @@ OGRPGTableLayer::OGRPGTableLayer( OGRPGDataSource *poDSIn,
     bUseCopyByDefault = FALSE;
     bFIDColumnInCopyFields = FALSE;
     bFirstInsertion = TRUE;
+    bBinaryCopy = FALSE;
 
     pszTableName = CPLStrdup( pszTableNameIn );
     if (pszSchemaNameIn)
@@ -1932,6 +1935,806 @@ OGRErr OGRPGTableLayer::CreateFeatureViaInsert( OGRFeature *poFeature )
     return OGRERR_NONE;
 }
 
+/************************************************************************/
+/*                     Binary COPY encoding helpers                     */
+/************************************************************************/
+
+typedef enum
+{
+    PG_COPY_UNSUPPORTED,
+    PG_COPY_BOOL,
+    PG_COPY_INT2,
+    PG_COPY_INT4,
+    PG_COPY_INT8,
+    PG_COPY_FLOAT4,
+    PG_COPY_FLOAT8,
+    PG_COPY_NUMERIC,
+    PG_COPY_TEXT,
+    PG_COPY_BYTEA,
+    PG_COPY_DATE,
+    PG_COPY_TIME,
+    PG_COPY_TIMESTAMP,
+    PG_COPY_INT4_ARRAY,
+    PG_COPY_INT8_ARRAY,
+    PG_COPY_FLOAT8_ARRAY,
+    PG_COPY_TEXT_ARRAY,
+    PG_COPY_VARCHAR_ARRAY,
+    PG_COPY_EWKB,
+    PG_COPY_WKB
+} OGRPGCopyEncoding;
+
+/* Signature, flags field and header extension length */
+static const char achPGCopyBinaryHeader[] =
+    { 'P', 'G', 'C', 'O', 'P', 'Y', '\n', '\377', '\r', '\n', '\0',
+      0, 0, 0, 0, 0, 0, 0, 0 };
+
+#define PG_COPY_NUMERIC_POS     0x0000
+#define PG_COPY_NUMERIC_NEG     0x4000
+#define PG_COPY_NUMERIC_NAN     0xC000
+
+/* Days between 1970-01-01 and 2000-01-01, the epoch of PostgreSQL dates */
+#define PG_EPOCH_DAYS_FROM_UNIX_EPOCH   10957
+
+#define PG_WKB_SRID_FLAG        0x20000000
+
+static void OGRPGCopyAppendInt16( CPLString& osBuf, GUInt16 nVal )
+{
+    CPL_MSBPTR16(&nVal);
+    osBuf.append( (const char*)&nVal, 2 );
+}
+
+static void OGRPGCopyAppendInt32( CPLString& osBuf, GInt32 nVal )
+{
+    CPL_MSBPTR32(&nVal);
+    osBuf.append( (const char*)&nVal, 4 );
+}
+
+static void OGRPGCopyAppendInt64( CPLString& osBuf, GIntBig nVal )
+{
+    CPL_MSBPTR64(&nVal);
+    osBuf.append( (const char*)&nVal, 8 );
+}
+
+static void OGRPGCopyAppendFloat64( CPLString& osBuf, double dfVal )
+{
+    CPL_MSBPTR64(&dfVal);
+    osBuf.append( (const char*)&dfVal, 8 );
+}
+
+/* Write a field value of fixed size: its length followed by its content */
+static void OGRPGCopyAppendInt32Field( CPLString& osBuf, GInt32 nVal )
+{
+    OGRPGCopyAppendInt32( osBuf, 4 );
+    OGRPGCopyAppendInt32( osBuf, nVal );
+}
+
+static void OGRPGCopyAppendInt64Field( CPLString& osBuf, GIntBig nVal )
+{
+    OGRPGCopyAppendInt32( osBuf, 8 );
+    OGRPGCopyAppendInt64( osBuf, nVal );
+}
+
+/* Variable size values are written after a placeholder for their length, */
+/* which is patched afterwards */
+static size_t OGRPGCopyBeginField( CPLString& osBuf )
+{
+    size_t nPos = osBuf.size();
+    OGRPGCopyAppendInt32( osBuf, 0 );
+    return nPos;
+}
+
+static void OGRPGCopyEndField( CPLString& osBuf, size_t nPos )
+{
+    GInt32 nLen = (GInt32)(osBuf.size() - nPos - 4);
+    CPL_MSBPTR32(&nLen);
+    memcpy( &osBuf[nPos], &nLen, 4 );
+}
+
+/************************************************************************/
+/*                    OGRPGCopyAppendArrayHeader()                      */
+/*                                                                      */
+/*      One-dimension array with no NULL element, starting at index 1. */
+/************************************************************************/
+
+static void OGRPGCopyAppendArrayHeader( CPLString& osBuf, int nCount,
+                                        Oid nElemOID )
+{
+    OGRPGCopyAppendInt32( osBuf, nCount > 0 ? 1 : 0 );
+    OGRPGCopyAppendInt32( osBuf, 0 );
+    OGRPGCopyAppendInt32( osBuf, (GInt32)nElemOID );
+    if( nCount > 0 )
+    {
+        OGRPGCopyAppendInt32( osBuf, nCount );
+        OGRPGCopyAppendInt32( osBuf, 1 );
+    }
+}
+
+/************************************************************************/
+/*                      OGRPGCopyAppendNumeric()                        */
+/*                                                                      */
+/*      Convert a decimal string, possibly with an exponent, to the     */
+/*      base 10000 representation expected by numeric_recv().          */
+/************************************************************************/
+
+static int OGRPGCopyAppendNumeric( CPLString& osBuf, const char* pszVal )
+{
+    const char* pszIter = pszVal;
+    int bNegative = FALSE;
+    if( *pszIter == '-' || *pszIter == '+' )
+    {
+        bNegative = (*pszIter == '-');
+        pszIter ++;
+    }
+
+    std::string osDigits;
+    int nPointPos = -1;
+    for( ; *pszIter != '\0'; pszIter++ )
+    {
+        if( *pszIter >= '0' && *pszIter <= '9' )
+            osDigits += *pszIter;
+        else if( *pszIter == '.' && nPointPos < 0 )
+            nPointPos = (int)osDigits.size();
+        else
+            break;
+    }
+    if( osDigits.empty() )
+        return FALSE;
+    if( nPointPos < 0 )
+        nPointPos = (int)osDigits.size();
+    if( *pszIter == 'e' || *pszIter == 'E' )
+    {
+        char* pszEnd = NULL;
+        long nExp = strtol(pszIter + 1, &pszEnd, 10);
+        if( pszEnd == pszIter + 1 || nExp > 1000 || nExp < -1000 )
+            return FALSE;
+        nPointPos += (int)nExp;
+        pszIter = pszEnd;
+    }
+    if( *pszIter != '\0' )
+        return FALSE;
+
+    /* Make the decimal point fall within the digits */
+    if( nPointPos < 0 )
+    {
+        osDigits.insert( 0, -nPointPos, '0' );
+        nPointPos = 0;
+    }
+    else if( nPointPos > (int)osDigits.size() )
+        osDigits.append( nPointPos - osDigits.size(), '0' );
+    int nDScale = (int)osDigits.size() - nPointPos;
+
+    /* Align the integer and fractional parts on groups of 4 digits */
+    int nIntPad = (4 - nPointPos % 4) % 4;
+    osDigits.insert( 0, nIntPad, '0' );
+    int nFracPad = (4 - nDScale % 4) % 4;
+    osDigits.append( nFracPad, '0' );
+
+    std::vector<GUInt16> anGroups;
+    for( size_t i = 0; i < osDigits.size(); i += 4 )
+    {
+        anGroups.push_back( (GUInt16)((osDigits[i] - '0') * 1000 +
+                                      (osDigits[i+1] - '0') * 100 +
+                                      (osDigits[i+2] - '0') * 10 +
+                                      (osDigits[i+3] - '0')) );
+    }
+    int nWeight = (nPointPos + nIntPad) / 4 - 1;
+
+    /* Strip leading and trailing zero groups */
+    size_t iFirst = 0;
+    size_t iLast = anGroups.size();
+    while( iFirst < iLast && anGroups[iFirst] == 0 )
+    {
+        iFirst ++;
+        nWeight --;
+    }
+    while( iLast > iFirst && anGroups[iLast-1] == 0 )
+        iLast --;
+    if( iFirst == iLast )
+    {
+        nWeight = 0;
+        bNegative = FALSE;
+    }
+
+    size_t nPos = OGRPGCopyBeginField( osBuf );
+    OGRPGCopyAppendInt16( osBuf, (GUInt16)(iLast - iFirst) );
+    OGRPGCopyAppendInt16( osBuf, (GUInt16)(GInt16)nWeight );
+    OGRPGCopyAppendInt16( osBuf, bNegative ? PG_COPY_NUMERIC_NEG : PG_COPY_NUMERIC_POS );
+    OGRPGCopyAppendInt16( osBuf, (GUInt16)nDScale );
+    for( size_t i = iFirst; i < iLast; i++ )
+        OGRPGCopyAppendInt16( osBuf, anGroups[i] );
+    OGRPGCopyEndField( osBuf, nPos );
+
+    return TRUE;
+}
+
+/************************************************************************/
+/*                      OGRPGCopyDaysSince2000()                        */
+/************************************************************************/
+
+static int OGRPGCopyDaysSince2000( int nYear, int nMonth, int nDay )
+{
+    /* Days from civil date in the proleptic Gregorian calendar */
+    const int nY = nYear - (nMonth <= 2 ? 1 : 0);
+    const int nEra = (nY >= 0 ? nY : nY - 399) / 400;
+    const int nYearOfEra = nY - nEra * 400;
+    const int nDayOfYear = (153 * (nMonth + (nMonth > 2 ? -3 : 9)) + 2) / 5 +
+                           nDay - 1;
+    const int nDayOfEra = nYearOfEra * 365 + nYearOfEra / 4 -
+                          nYearOfEra / 100 + nDayOfYear;
+    return nEra * 146097 + nDayOfEra - 719468 - PG_EPOCH_DAYS_FROM_UNIX_EPOCH;
+}
+
+/************************************************************************/
+/*                        OGRPGCopyAppendText()                         */
+/*                                                                      */
+/*      Append a string, truncated to nMaxWidth UTF-8 characters as     */
+/*      done in text mode.                                              */
+/************************************************************************/
+
+static void OGRPGCopyAppendText( CPLString& osBuf, const char* pszStrValue,
+                                 int nMaxWidth, const char* pszFieldName )
+{
+    size_t nLen = strlen(pszStrValue);
+    if( nMaxWidth > 0 )
+    {
+        int iUTFChar = 0;
+        for( size_t iChar = 0; iChar < nLen; iChar++ )
+        {
+            if( (pszStrValue[iChar] & 0xc0) != 0x80 )
+            {
+                if( iUTFChar == nMaxWidth )
+                {
+                    CPLDebug( "PG",
+                              "Truncated %s field value, it was too long.",
+                              pszFieldName );
+                    nLen = iChar;
+                    break;
+                }
+                iUTFChar++;
+            }
+        }
+    }
+    OGRPGCopyAppendInt32( osBuf, (GInt32)nLen );
+    osBuf.append( pszStrValue, nLen );
+}
+
+/************************************************************************/
+/*                      OGRPGCopyAppendGeometry()                       */
+/************************************************************************/
+
+static int OGRPGCopyAppendGeometry( CPLString& osBuf, OGRGeometry* poGeom,
+                                    int nSRSId, int bEWKB,
+                                    int nPostGISMajor, int nPostGISMinor )
+{
+    int nWkbSize = poGeom->WkbSize();
+    GByte* pabyWKB = (GByte*) VSI_MALLOC_VERBOSE(nWkbSize);
+    if( pabyWKB == NULL )
+        return FALSE;
+
+    OGRErr eErr;
+    if( (nPostGISMajor > 2 || (nPostGISMajor == 2 && nPostGISMinor >= 2)) &&
+        wkbFlatten(poGeom->getGeometryType()) == wkbPoint &&
+        poGeom->IsEmpty() )
+    {
+        eErr = poGeom->exportToWkb( wkbNDR, pabyWKB, wkbVariantIso );
+    }
+    else
+    {
+        eErr = poGeom->exportToWkb( wkbNDR, pabyWKB,
+                    (nPostGISMajor < 2) ? wkbVariantPostGIS1 : wkbVariantOldOgc );
+    }
+    if( eErr != OGRERR_NONE )
+    {
+        CPLFree( pabyWKB );
+        return FALSE;
+    }
+
+    if( bEWKB && nSRSId > 0 )
+    {
+        /* Insert the SRID after the byte order and geometry type */
+        GUInt32 nGeomType;
+        memcpy( &nGeomType, pabyWKB + 1, 4 );
+        CPL_LSBPTR32(&nGeomType);
+        nGeomType |= PG_WKB_SRID_FLAG;
+        CPL_LSBPTR32(&nGeomType);
+        GInt32 nSRID = nSRSId;
+        CPL_LSBPTR32(&nSRID);
+
+        OGRPGCopyAppendInt32( osBuf, nWkbSize + 4 );
+        osBuf.append( (const char*)pabyWKB, 1 );
+        osBuf.append( (const char*)&nGeomType, 4 );
+        osBuf.append( (const char*)&nSRID, 4 );
+        osBuf.append( (const char*)pabyWKB + 5, nWkbSize - 5 );
+    }
+    else
+    {
+        OGRPGCopyAppendInt32( osBuf, nWkbSize );
+        osBuf.append( (const char*)pabyWKB, nWkbSize );
+    }
+
+    CPLFree( pabyWKB );
+    return TRUE;
+}
+
+/************************************************************************/
+/*                      OGRPGCopyGetEncoding()                          */
+/*                                                                      */
+/*      Binary encoding of an OGR field type to a column type.          */
+/************************************************************************/
+
+static int OGRPGCopyGetEncoding( OGRFieldType eType, const char* pszTypeName,
+                                 int bIntegerDateTimes )
+{
+    switch( eType )
+    {
+        case OFTInteger:
+        case OFTInteger64:
+            if( EQUAL(pszTypeName, "bool") )
+                return PG_COPY_BOOL;
+            if( EQUAL(pszTypeName, "int2") )
+                return PG_COPY_INT2;
+            if( EQUAL(pszTypeName, "int4") )
+                return PG_COPY_INT4;
+            if( EQUAL(pszTypeName, "int8") )
+                return PG_COPY_INT8;
+            if( EQUAL(pszTypeName, "numeric") )
+                return PG_COPY_NUMERIC;
+            break;
+
+        case OFTReal:
+            if( EQUAL(pszTypeName, "float4") )
+                return PG_COPY_FLOAT4;
+            if( EQUAL(pszTypeName, "float8") )
+                return PG_COPY_FLOAT8;
+            if( EQUAL(pszTypeName, "numeric") )
+                return PG_COPY_NUMERIC;
+            break;
+
+        case OFTString:
+            if( EQUAL(pszTypeName, "text") || EQUAL(pszTypeName, "varchar") ||
+                EQUAL(pszTypeName, "bpchar") )
+                return PG_COPY_TEXT;
+            break;
+
+        case OFTBinary:
+            if( EQUAL(pszTypeName, "bytea") )
+                return PG_COPY_BYTEA;
+            break;
+
+        case OFTDate:
+            if( EQUAL(pszTypeName, "date") )
+                return PG_COPY_DATE;
+            break;
+
+        case OFTTime:
+            if( bIntegerDateTimes && EQUAL(pszTypeName, "time") )
+                return PG_COPY_TIME;
+            break;
+
+        /* timestamptz would require converting local times with the */
+        /* session time zone, so it is left to the text format */
+        case OFTDateTime:
+            if( bIntegerDateTimes && EQUAL(pszTypeName, "timestamp") )
+                return PG_COPY_TIMESTAMP;
+            break;
+
+        case OFTIntegerList:
+            if( EQUAL(pszTypeName, "_int4") )
+                return PG_COPY_INT4_ARRAY;
+            break;
+
+        case OFTInteger64List:
+            if( EQUAL(pszTypeName, "_int8") )
+                return PG_COPY_INT8_ARRAY;
+            break;
+
+        case OFTRealList:
+            if( EQUAL(pszTypeName, "_float8") )
+                return PG_COPY_FLOAT8_ARRAY;
+            break;
+
+        case OFTStringList:
+            if( EQUAL(pszTypeName, "_text") )
+                return PG_COPY_TEXT_ARRAY;
+            if( EQUAL(pszTypeName, "_varchar") )
+                return PG_COPY_VARCHAR_ARRAY;
+            break;
+
+        default:
+            break;
+    }
+    return PG_COPY_UNSUPPORTED;
+}
+
+/************************************************************************/
+/*                          SetupBinaryCopy()                           */
+/*                                                                      */
+/*      Determine the binary encoding of each column of the COPY        */
+/*      statement. Returns FALSE if one of them has no binary encoding, */
+/*      in which case the text format must be used.                     */
+/************************************************************************/
+
+int OGRPGTableLayer::SetupBinaryCopy()
+
+{
+    anBinaryCopyEncodings.resize(0);
+
+#if defined(PG_PRE74)
+    return FALSE;
+#else
+    PGconn *hPGConn = poDS->GetPGConn();
+
+    const char* pszIntegerDateTimes =
+        PQparameterStatus(hPGConn, "integer_datetimes");
+    int bIntegerDateTimes = pszIntegerDateTimes != NULL &&
+                            EQUAL(pszIntegerDateTimes, "on");
+
+    CPLString osCommand;
+    osCommand.Printf( "SELECT a.attname, t.typname FROM pg_attribute a "
+                      "JOIN pg_type t ON a.atttypid = t.oid "
+                      "WHERE a.attrelid = %s::regclass AND a.attnum > 0 "
+                      "AND NOT a.attisdropped",
+                      OGRPGEscapeString(hPGConn, pszSqlTableName).c_str() );
+    PGresult *hResult = OGRPG_PQexec(hPGConn, osCommand);
+    if( !hResult || PQresultStatus(hResult) != PGRES_TUPLES_OK )
+    {
+        OGRPGClearResult( hResult );
+        return FALSE;
+    }
+
+    std::map<CPLString, CPLString> oMapColumnTypes;
+    for( int i = 0; i < PQntuples(hResult); i++ )
+        oMapColumnTypes[PQgetvalue(hResult, i, 0)] = PQgetvalue(hResult, i, 1);
+    OGRPGClearResult( hResult );
+
+    /* Same order as BuildCopyFields() */
+    int i;
+    for( i = 0; i < poFeatureDefn->GetGeomFieldCount(); i++ )
+    {
+        OGRPGGeomFieldDefn* poGeomFieldDefn =
+            poFeatureDefn->myGetGeomFieldDefn(i);
+        const CPLString& osType = oMapColumnTypes[poGeomFieldDefn->GetNameRef()];
+        int nEncoding = PG_COPY_UNSUPPORTED;
+        if( poGeomFieldDefn->ePostgisType == GEOM_TYPE_WKB )
+        {
+            if( osType == "bytea" )
+                nEncoding = PG_COPY_WKB;
+        }
+        else if( poDS->sPostGISVersion.nMajor >= 2 &&
+                 (osType == "geometry" || osType == "geography") )
+            nEncoding = PG_COPY_EWKB;
+        if( nEncoding == PG_COPY_UNSUPPORTED )
+        {
+            CPLDebug( "PG", "No binary COPY for column %s of type %s",
+                      poGeomFieldDefn->GetNameRef(), osType.c_str() );
+            return FALSE;
+        }
+        anBinaryCopyEncodings.push_back(nEncoding);
+    }
+
+    int nFIDIndex = -1;
+    if( bFIDColumnInCopyFields )
+    {
+        nFIDIndex = poFeatureDefn->GetFieldIndex( pszFIDColumn );
+        const CPLString& osType = oMapColumnTypes[pszFIDColumn];
+        if( osType == "int4" )
+            anBinaryCopyEncodings.push_back(PG_COPY_INT4);
+        else if( osType == "int8" )
+            anBinaryCopyEncodings.push_back(PG_COPY_INT8);
+        else
+        {
+            CPLDebug( "PG", "No binary COPY for column %s of type %s",
+                      pszFIDColumn, osType.c_str() );
+            return FALSE;
+        }
+    }
+
+    for( i = 0; i < poFeatureDefn->GetFieldCount(); i++ )
+    {
+        if( i == nFIDIndex )
+            continue;
+
+        OGRFieldDefn* poFieldDefn = poFeatureDefn->GetFieldDefn(i);
+        const CPLString& osType = oMapColumnTypes[poFieldDefn->GetNameRef()];
+        int nEncoding = OGRPGCopyGetEncoding( poFieldDefn->GetType(), osType,
+                                              bIntegerDateTimes );
+        if( nEncoding == PG_COPY_UNSUPPORTED )
+        {
+            CPLDebug( "PG", "No binary COPY for column %s of type %s",
+                      poFieldDefn->GetNameRef(), osType.c_str() );
+            return FALSE;
+        }
+        anBinaryCopyEncodings.push_back(nEncoding);
+    }
+
+    return TRUE;
+#endif
+}
+
+/************************************************************************/
+/*                     CreateFeatureViaBinaryCopy()                     */
+/************************************************************************/
+
+OGRErr OGRPGTableLayer::CreateFeatureViaBinaryCopy( OGRFeature *poFeature )
+{
+#if defined(PG_PRE74)
+    return OGRERR_FAILURE;
+#else
+    PGconn              *hPGConn = poDS->GetPGConn();
+    CPLString            osBuf;
+    size_t               iCol = 0;
+    int                  i;
+
+    OGRPGCopyAppendInt16( osBuf, (GUInt16)anBinaryCopyEncodings.size() );
+
+    /* First process geometry */
+    for( i = 0; i < poFeatureDefn->GetGeomFieldCount(); i++, iCol++ )
+    {
+        OGRPGGeomFieldDefn* poGeomFieldDefn =
+            poFeatureDefn->myGetGeomFieldDefn(i);
+        OGRGeometry* poGeom = poFeature->GetGeomFieldRef(i);
+
+        if( poGeom == NULL )
+        {
+            OGRPGCopyAppendInt32( osBuf, -1 );
+            continue;
+        }
+
+        CheckGeomTypeCompatibility(i, poGeom);
+
+        poGeom->closeRings();
+        poGeom->set3D(poGeomFieldDefn->GeometryTypeFlags & OGRGeometry::OGR_G_3D);
+        poGeom->setMeasured(poGeomFieldDefn->GeometryTypeFlags & OGRGeometry::OGR_G_MEASURED);
+
+        if( !OGRPGCopyAppendGeometry( osBuf, poGeom, poGeomFieldDefn->nSRSId,
+                                      anBinaryCopyEncodings[iCol] == PG_COPY_EWKB,
+                                      poDS->sPostGISVersion.nMajor,
+                                      poDS->sPostGISVersion.nMinor ) )
+        {
+            CPLError( CE_Failure, CPLE_AppDefined,
+                      "Cannot export geometry of feature " CPL_FRMT_GIB,
+                      poFeature->GetFID() );
+            return OGRERR_FAILURE;
+        }
+    }
+
+    /* Next process the field id column */
+    int nFIDIndex = -1;
+    if( bFIDColumnInCopyFields )
+    {
+        nFIDIndex = poFeatureDefn->GetFieldIndex( pszFIDColumn );
+        GIntBig nFID = poFeature->GetFID();
+        if( nFID == OGRNullFID )
+            OGRPGCopyAppendInt32( osBuf, -1 );
+        else if( anBinaryCopyEncodings[iCol] == PG_COPY_INT8 )
+            OGRPGCopyAppendInt64Field( osBuf, nFID );
+        else if( CPL_INT64_FITS_ON_INT32(nFID) )
+            OGRPGCopyAppendInt32Field( osBuf, (GInt32)nFID );
+        else
+        {
+            CPLError( CE_Failure, CPLE_AppDefined,
+                      "FID " CPL_FRMT_GIB " does not fit on a int4 column",
+                      nFID );
+            return OGRERR_FAILURE;
+        }
+        iCol ++;
+    }
+
+    /* Now process the remaining fields */
+    for( i = 0; i < poFeatureDefn->GetFieldCount(); i++ )
+    {
+        if( i == nFIDIndex )
+            continue;
+
+        const int nEncoding = anBinaryCopyEncodings[iCol++];
+        OGRFieldDefn* poFieldDefn = poFeatureDefn->GetFieldDefn(i);
+
+        if( !poFeature->IsFieldSet(i) )
+        {
+            OGRPGCopyAppendInt32( osBuf, -1 );
+            continue;
+        }
+
+        switch( nEncoding )
+        {
+            case PG_COPY_BOOL:
+                OGRPGCopyAppendInt32( osBuf, 1 );
+                osBuf += (char)(poFeature->GetFieldAsInteger64(i) != 0 ? 1 : 0);
+                break;
+
+            case PG_COPY_INT2:
+            case PG_COPY_INT4:
+            {
+                GIntBig nVal = poFeature->GetFieldAsInteger64(i);
+                if( (nEncoding == PG_COPY_INT2 && (nVal < -32768 || nVal > 32767)) ||
+                    !CPL_INT64_FITS_ON_INT32(nVal) )
+                {
+                    CPLError( CE_Failure, CPLE_AppDefined,
+                              "Value " CPL_FRMT_GIB " of field %s is out of range",
+                              nVal, poFieldDefn->GetNameRef() );
+                    return OGRERR_FAILURE;
+                }
+                if( nEncoding == PG_COPY_INT2 )
+                {
+                    OGRPGCopyAppendInt32( osBuf, 2 );
+                    OGRPGCopyAppendInt16( osBuf, (GUInt16)(GInt16)nVal );
+                }
+                else
+                    OGRPGCopyAppendInt32Field( osBuf, (GInt32)nVal );
+                break;
+            }
+
+            case PG_COPY_INT8:
+                OGRPGCopyAppendInt64Field( osBuf, poFeature->GetFieldAsInteger64(i) );
+                break;
+
+            case PG_COPY_FLOAT4:
+            {
+                float fVal = (float)poFeature->GetFieldAsDouble(i);
+                OGRPGCopyAppendInt32( osBuf, 4 );
+                CPL_MSBPTR32(&fVal);
+                osBuf.append( (const char*)&fVal, 4 );
+                break;
+            }
+
+            case PG_COPY_FLOAT8:
+                OGRPGCopyAppendInt32( osBuf, 8 );
+                OGRPGCopyAppendFloat64( osBuf, poFeature->GetFieldAsDouble(i) );
+                break;
+
+            case PG_COPY_NUMERIC:
+            {
+                if( poFieldDefn->GetType() == OFTReal &&
+                    CPLIsNan(poFeature->GetFieldAsDouble(i)) )
+                {
+                    OGRPGCopyAppendInt32( osBuf, 8 );
+                    OGRPGCopyAppendInt16( osBuf, 0 );
+                    OGRPGCopyAppendInt16( osBuf, 0 );
+                    OGRPGCopyAppendInt16( osBuf, PG_COPY_NUMERIC_NAN );
+                    OGRPGCopyAppendInt16( osBuf, 0 );
+                }
+                else if( !OGRPGCopyAppendNumeric( osBuf,
+                                                  poFeature->GetFieldAsString(i) ) )
+                {
+                    CPLError( CE_Failure, CPLE_AppDefined,
+                              "Value %s of field %s cannot be written as numeric",
+                              poFeature->GetFieldAsString(i),
+                              poFieldDefn->GetNameRef() );
+                    return OGRERR_FAILURE;
+                }
+                break;
+            }
+
+            case PG_COPY_TEXT:
+                OGRPGCopyAppendText( osBuf, poFeature->GetFieldAsString(i),
+                                     poFieldDefn->GetWidth(),
+                                     poFieldDefn->GetNameRef() );
+                break;
+
+            case PG_COPY_BYTEA:
+            {
+                int nLen = 0;
+                GByte* pabyData = poFeature->GetFieldAsBinary( i, &nLen );
+                OGRPGCopyAppendInt32( osBuf, nLen );
+                osBuf.append( (const char*)pabyData, nLen );
+                break;
+            }
+
+            case PG_COPY_DATE:
+            case PG_COPY_TIME:
+            case PG_COPY_TIMESTAMP:
+            {
+                int nYear = 0, nMonth = 0, nDay = 0, nHour = 0, nMinute = 0;
+                int nTZFlag = 0;
+                float fSecond = 0.0f;
+                poFeature->GetFieldAsDateTime( i, &nYear, &nMonth, &nDay,
+                                               &nHour, &nMinute, &fSecond,
+                                               &nTZFlag );
+                if( nEncoding != PG_COPY_TIME &&
+                    (nMonth < 1 || nMonth > 12 || nDay < 1 || nDay > 31) )
+                {
+                    CPLError( CE_Failure, CPLE_AppDefined,
+                              "Invalid date %s in field %s",
+                              poFeature->GetFieldAsString(i),
+                              poFieldDefn->GetNameRef() );
+                    return OGRERR_FAILURE;
+                }
+
+                /* Milliseconds are the resolution of the text format */
+                GIntBig nTimeMicroSec =
+                    ((GIntBig)(nHour * 60 + nMinute) * 60) * 1000000 +
+                    (GIntBig)floor(fSecond * 1000.0 + 0.5) * 1000;
+
+                if( nEncoding == PG_COPY_DATE )
+                    OGRPGCopyAppendInt32Field( osBuf,
+                        OGRPGCopyDaysSince2000(nYear, nMonth, nDay) );
+                else if( nEncoding == PG_COPY_TIME )
+                    OGRPGCopyAppendInt64Field( osBuf, nTimeMicroSec );
+                else
+                    OGRPGCopyAppendInt64Field( osBuf,
+                        (GIntBig)OGRPGCopyDaysSince2000(nYear, nMonth, nDay) *
+                            ((GIntBig)86400 * 1000000) + nTimeMicroSec );
+                break;
+            }
+
+            case PG_COPY_INT4_ARRAY:
+            {
+                int nCount = 0;
+                const int* panItems = poFeature->GetFieldAsIntegerList(i, &nCount);
+                size_t nPos = OGRPGCopyBeginField( osBuf );
+                OGRPGCopyAppendArrayHeader( osBuf, nCount, INT4OID );
+                for( int j = 0; j < nCount; j++ )
+                    OGRPGCopyAppendInt32Field( osBuf, panItems[j] );
+                OGRPGCopyEndField( osBuf, nPos );
+                break;
+            }
+
+            case PG_COPY_INT8_ARRAY:
+            {
+                int nCount = 0;
+                const GIntBig* panItems =
+                    poFeature->GetFieldAsInteger64List(i, &nCount);
+                size_t nPos = OGRPGCopyBeginField( osBuf );
+                OGRPGCopyAppendArrayHeader( osBuf, nCount, INT8OID );
+                for( int j = 0; j < nCount; j++ )
+                    OGRPGCopyAppendInt64Field( osBuf, panItems[j] );
+                OGRPGCopyEndField( osBuf, nPos );
+                break;
+            }
+
+            case PG_COPY_FLOAT8_ARRAY:
+            {
+                int nCount = 0;
+                const double* padfItems =
+                    poFeature->GetFieldAsDoubleList(i, &nCount);
+                size_t nPos = OGRPGCopyBeginField( osBuf );
+                OGRPGCopyAppendArrayHeader( osBuf, nCount, FLOAT8OID );
+                for( int j = 0; j < nCount; j++ )
+                {
+                    OGRPGCopyAppendInt32( osBuf, 8 );
+                    OGRPGCopyAppendFloat64( osBuf, padfItems[j] );
+                }
+                OGRPGCopyEndField( osBuf, nPos );
+                break;
+            }
+
+            case PG_COPY_TEXT_ARRAY:
+            case PG_COPY_VARCHAR_ARRAY:
+            {
+                /* The element type must match the one of the column */
+                char** papszItems = poFeature->GetFieldAsStringList(i);
+                int nCount = CSLCount(papszItems);
+                size_t nPos = OGRPGCopyBeginField( osBuf );
+                OGRPGCopyAppendArrayHeader( osBuf, nCount,
+                    nEncoding == PG_COPY_TEXT_ARRAY ? TEXTOID : VARCHAROID );
+                for( int j = 0; j < nCount; j++ )
+                    OGRPGCopyAppendText( osBuf, papszItems[j], 0, NULL );
+                OGRPGCopyEndField( osBuf, nPos );
+                break;
+            }
+
+            default:
+                CPLAssert(FALSE);
+                return OGRERR_FAILURE;
+        }
+    }
+
+    int copyResult = PQputCopyData(hPGConn, osBuf.data(),
+                                   static_cast<int>(osBuf.size()));
+    switch (copyResult)
+    {
+    case 0:
+        CPLError( CE_Failure, CPLE_AppDefined, "Writing COPY data blocked.");
+        return OGRERR_FAILURE;
+    case -1:
+        CPLError( CE_Failure, CPLE_AppDefined, "%s", PQerrorMessage(hPGConn) );
+        return OGRERR_FAILURE;
+    }
+
+    return OGRERR_NONE;
+#endif
+}
+
 /************************************************************************/
 /*                        CreateFeatureViaCopy()                        */
 /************************************************************************/
@@ -1945,6 +2748,9 @@ OGRErr OGRPGTableLayer::CreateFeatureViaCopy( OGRFeature *poFeature )
     /* Tell the datasource we are now planning to copy data */
     poDS->StartCopy( this );
 
+    if( bBinaryCopy )
+        return CreateFeatureViaBinaryCopy( poFeature );
+
     /* First process geometry */
     for( i = 0; i < poFeatureDefn->GetGeomFieldCount(); i++ )
     {
@@ -2906,12 +3712,17 @@ OGRErr OGRPGTableLayer::StartCopy()
 
     CPLString osFields = BuildCopyFields();
 
+    bBinaryCopy =
+        CPLTestBool(CPLGetConfigOption("PG_USE_BINARY_COPY", "NO")) &&
+        SetupBinaryCopy();
+
     size_t size = strlen(osFields) +  strlen(pszSqlTableName) + 100;
     char *pszCommand = (char *) CPLMalloc(size);
 
     snprintf( pszCommand, size,
-             "COPY %s (%s) FROM STDIN;",
-             pszSqlTableName, osFields.c_str() );
+             "COPY %s (%s) FROM STDIN%s;",
+             pszSqlTableName, osFields.c_str(),
+             bBinaryCopy ? " WITH BINARY" : "" );
 
     PGconn *hPGConn = poDS->GetPGConn();
     PGresult *hResult = OGRPG_PQexec(hPGConn, pszCommand);
@@ -2922,7 +3733,18 @@ OGRErr OGRPGTableLayer::StartCopy()
                   "%s", PQerrorMessage(hPGConn) );
     }
     else
+    {
         bCopyActive = TRUE;
+#if !defined(PG_PRE74)
+        if( bBinaryCopy &&
+            PQputCopyData(hPGConn, achPGCopyBinaryHeader,
+                          (int)sizeof(achPGCopyBinaryHeader)) != 1 )
+        {
+            CPLError( CE_Failure, CPLE_AppDefined,
+                      "%s", PQerrorMessage(hPGConn) );
+        }
+#endif
+    }
 
     OGRPGClearResult( hResult );
     CPLFree( pszCommand );
@@ -2952,6 +3774,21 @@ OGRErr OGRPGTableLayer::EndCopy()
 
     /* This is for postgresql 7.4 and higher */
 #if !defined(PG_PRE74)
+    if( bBinaryCopy )
+    {
+        /* File trailer */
+        CPLString osTrailer;
+        OGRPGCopyAppendInt16( osTrailer, 0xFFFF );
+        if( PQputCopyData(hPGConn, osTrailer.data(),
+                          (int)osTrailer.size()) != 1 )
+        {
+            CPLError( CE_Failure, CPLE_AppDefined,
+                      "%s", PQerrorMessage(hPGConn) );
+            result = OGRERR_FAILURE;
+        }
+        bBinaryCopy = FALSE;
+    }
+
     int copyResult = PQputCopyEnd(hPGConn, NULL);
 
     switch (copyResult)
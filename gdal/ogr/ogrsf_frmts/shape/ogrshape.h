@@ -47,10 +47,15 @@
 /* ==================================================================== */
 /*      Functions from Shape2ogr.cpp.                                   */
 /* ==================================================================== */
+class OGRShapeDBFBatchReader;
+
 OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
                                OGRFeatureDefn * poDefn, int iShape,
-                               SHPObject *psShape, const char *pszSHPEncoding );
+                               SHPObject *psShape, const char *pszSHPEncoding,
+                               OGRShapeDBFBatchReader *poDBFReader = NULL,
+                               int bDirectGeomRead = FALSE );
 OGRGeometry *SHPReadOGRObject( SHPHandle hSHP, int iShape, SHPObject *psShape );
+OGRGeometry *SHPReadOGRObjectDirect( SHPHandle hSHP, int iShape );
 OGRFeatureDefn *SHPReadOGRFeatureDefn( const char * pszName,
                                        SHPHandle hSHP, DBFHandle hDBF,
                                        const char *pszSHPEncoding,
@@ -61,6 +66,46 @@ OGRErr SHPWriteOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
                            int* pbTruncationWarningEmitted,
                            int bRewind );
 
+/************************************************************************/
+/*                        OGRShapeDBFBatchReader                        */
+/*                                                                      */
+/*      Reads consecutive .dbf records by batches, and decodes the      */
+/*      non-ignored fields of a whole batch at once, column by column.  */
+/************************************************************************/
+
+class OGRShapeDBFBatchReader
+{
+    DBFHandle           hDBF;
+    OGRFeatureDefn     *poDefn;
+    CPLString           osEncoding;
+
+    int                 nMaxBatchRecords;
+    int                 iFirstRecord;
+    int                 nBatchRecords;
+    std::vector<GByte>  abyRecords;
+
+    /* Decoded values, one array of nBatchRecords values per column */
+    std::vector<int>    anFieldColumn;
+    int                 nColumns;
+    std::vector<GByte>  abyState;
+    std::vector<OGRField> asValues;
+    std::vector<char>   achStrings;
+
+    int                 ProjectionChanged();
+    void                DecodeColumns();
+
+  public:
+                        OGRShapeDBFBatchReader( DBFHandle hDBFIn,
+                                                OGRFeatureDefn *poDefnIn,
+                                                const char *pszEncoding );
+
+    DBFHandle           GetDBFHandle() { return hDBF; }
+
+    int                 LoadRecord( int iRecord );
+    int                 IsRecordDeleted( int iRecord );
+    void                FillFeature( OGRFeature *poFeature, int iRecord );
+};
+
 /************************************************************************/
 /*                         OGRShapeGeomFieldDefn                        */
 /************************************************************************/
@@ -154,6 +199,13 @@ class OGRShapeLayer CPL_FINAL: public OGRAbstractProxiedLayer
     int                 bCreateSpatialIndexAtClose;
     int                 bRewindOnWrite;
 
+    int                 bUseDBFBatchReader;
+    int                 bDirectGeomRead;
+    OGRShapeDBFBatchReader *poDBFBatchReader;
+    OGRShapeDBFBatchReader *GetDBFBatchReader();
+
+    int                 ReadShapeBounds( int iShape, SHPObject* psShape );
+
   protected:
 
     virtual void        CloseUnderlyingLayer();
@@ -173,7 +225,8 @@ class OGRShapeLayer CPL_FINAL: public OGRAbstractProxiedLayer
 
     const char         *GetFullName() { return pszFullName; }
 
-    OGRFeature *        FetchShape(int iShapeId);
+    OGRFeature *        FetchShape(int iShapeId,
+                                   OGRShapeDBFBatchReader *poDBFReader = NULL);
     int                 GetFeatureCountWithSpatialFilterOnly();
 
   public:
@@ -0,0 +1,422 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  OpenGIS Simple Features Reference Implementation
+ * Purpose:  Implements OGRShapeDBFBatchReader class.
+ * Author:   Even Rouault, <even dot rouault at mines-paris dot org>
+ *
+ ******************************************************************************
+ * Copyright (c) 2016, Even Rouault <even dot rouault at mines-paris dot org>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "ogrshape.h"
+#include "cpl_conv.h"
+#include "cpl_string.h"
+
+CPL_CVSID("$Id$");
+
+/* Approximate size of the records read in a single I/O */
+#define DBF_BATCH_BYTES         (256 * 1024)
+
+/* State of a decoded value */
+#define DBF_VALUE_UNSET         0
+#define DBF_VALUE_SET           1
+#define DBF_VALUE_STRING        2   /* to be set from the string in the pool */
+
+/************************************************************************/
+/*                       OGRShapeDBFBatchReader()                       */
+/************************************************************************/
+
+OGRShapeDBFBatchReader::OGRShapeDBFBatchReader( DBFHandle hDBFIn,
+                                                OGRFeatureDefn *poDefnIn,
+                                                const char *pszEncoding ) :
+    hDBF(hDBFIn),
+    poDefn(poDefnIn),
+    osEncoding(pszEncoding),
+    iFirstRecord(0),
+    nBatchRecords(0),
+    nColumns(0)
+{
+    nMaxBatchRecords = DBF_BATCH_BYTES / MAX(1, hDBF->nRecordLength);
+    nMaxBatchRecords = MAX(1, MIN(nMaxBatchRecords, hDBF->nRecords));
+}
+
+/************************************************************************/
+/*                             LoadRecord()                             */
+/*                                                                      */
+/*      Make sure the batch containing iRecord is loaded and decoded.   */
+/*      Returns FALSE if the record cannot be read.                     */
+/************************************************************************/
+
+int OGRShapeDBFBatchReader::LoadRecord( int iRecord )
+
+{
+    if( iRecord < 0 || iRecord >= hDBF->nRecords )
+        return FALSE;
+
+    if( iRecord >= iFirstRecord && iRecord < iFirstRecord + nBatchRecords )
+    {
+        /* The ignored fields may have changed since the batch was decoded */
+        if( ProjectionChanged() )
+            DecodeColumns();
+        return TRUE;
+    }
+
+    nBatchRecords = 0;
+
+    const int nRecords = MIN(nMaxBatchRecords, hDBF->nRecords - iRecord);
+    abyRecords.resize( (size_t)nRecords * hDBF->nRecordLength );
+
+    const SAOffset nOffset =
+        hDBF->nRecordLength * (SAOffset) iRecord + hDBF->nHeaderLength;
+    if( hDBF->sHooks.FSeek( hDBF->fp, nOffset, SEEK_SET ) != 0 )
+    {
+        CPLError( CE_Failure, CPLE_FileIO,
+                  "fseek(" CPL_FRMT_GUIB ") failed on DBF file.",
+                  (GUIntBig) nOffset );
+        return FALSE;
+    }
+
+    const int nRead = (int) hDBF->sHooks.FRead( &abyRecords[0],
+                                                hDBF->nRecordLength,
+                                                nRecords, hDBF->fp );
+    if( nRead == 0 )
+    {
+        CPLError( CE_Failure, CPLE_FileIO,
+                  "fread(%d) failed on DBF file.", hDBF->nRecordLength );
+        return FALSE;
+    }
+
+    iFirstRecord = iRecord;
+    nBatchRecords = nRead;
+
+    DecodeColumns();
+
+    return TRUE;
+}
+
+/************************************************************************/
+/*                          IsRecordDeleted()                           */
+/************************************************************************/
+
+int OGRShapeDBFBatchReader::IsRecordDeleted( int iRecord )
+
+{
+    CPLAssert( iRecord >= iFirstRecord &&
+               iRecord < iFirstRecord + nBatchRecords );
+
+    return abyRecords[(size_t)(iRecord - iFirstRecord) *
+                                            hDBF->nRecordLength] == '*';
+}
+
+/************************************************************************/
+/*                         ProjectionChanged()                          */
+/************************************************************************/
+
+int OGRShapeDBFBatchReader::ProjectionChanged()
+
+{
+    for( int iField = 0; iField < poDefn->GetFieldCount(); iField++ )
+    {
+        const int bDecoded = anFieldColumn[iField] >= 0;
+        if( bDecoded == poDefn->GetFieldDefn(iField)->IsIgnored() )
+            return TRUE;
+    }
+    return FALSE;
+}
+
+/************************************************************************/
+/*                         DBFTrimmedValue()                            */
+/*                                                                      */
+/*      Locate the value of a field, with the same trimming rules as    */
+/*      DBFReadStringAttribute().                                       */
+/************************************************************************/
+
+static const char *DBFTrimmedValue( const char *pszRaw, int nWidth,
+                                    int *pnLen )
+
+{
+    const char *pszEnd = (const char *) memchr(pszRaw, '\0', nWidth);
+    int nLen = pszEnd ? (int)(pszEnd - pszRaw) : nWidth;
+
+    while( nLen > 0 && *pszRaw == ' ' )
+    {
+        pszRaw++;
+        nLen--;
+    }
+    while( nLen > 0 && pszRaw[nLen-1] == ' ' )
+        nLen--;
+
+    *pnLen = nLen;
+    return pszRaw;
+}
+
+/************************************************************************/
+/*                          DBFIsValueNULL()                            */
+/*                                                                      */
+/*      Same as the DBFIsValueNULL() of dbfopen.c, on a trimmed value.  */
+/************************************************************************/
+
+static int DBFIsValueNULL( char chType, const char *pszValue, int nLen )
+
+{
+    switch( chType )
+    {
+      case 'N':
+      case 'F':
+        return nLen == 0 || pszValue[0] == '*';
+
+      case 'D':
+        return nLen >= 8 && strncmp(pszValue, "00000000", 8) == 0;
+
+      case 'L':
+        return nLen > 0 && pszValue[0] == '?';
+
+      default:
+        return nLen == 0;
+    }
+}
+
+/************************************************************************/
+/*                          DBFParseInteger()                           */
+/*                                                                      */
+/*      Parse a plain decimal integer. Returns FALSE if the value has   */
+/*      anything else, in which case the generic (string) path is used. */
+/************************************************************************/
+
+static int DBFParseInteger( const char *pszValue, int nLen, GIntBig *pnValue )
+
+{
+    int i = 0;
+    int bNegative = FALSE;
+
+    if( nLen > 0 && (pszValue[0] == '-' || pszValue[0] == '+') )
+    {
+        bNegative = pszValue[0] == '-';
+        i = 1;
+    }
+    if( i == nLen || nLen - i > 18 )
+        return FALSE;
+
+    GIntBig nValue = 0;
+    for( ; i < nLen; i++ )
+    {
+        if( pszValue[i] < '0' || pszValue[i] > '9' )
+            return FALSE;
+        nValue = nValue * 10 + (pszValue[i] - '0');
+    }
+
+    *pnValue = bNegative ? -nValue : nValue;
+    return TRUE;
+}
+
+/************************************************************************/
+/*                           DecodeColumns()                            */
+/*                                                                      */
+/*      Decode the non-ignored fields of all the records of the batch.  */
+/*      This is the equivalent of the attribute part of                 */
+/*      SHPReadOGRFeature(), without going through the DBF work field.  */
+/************************************************************************/
+
+void OGRShapeDBFBatchReader::DecodeColumns()
+
+{
+    const int nFields = poDefn->GetFieldCount();
+
+    anFieldColumn.resize( nFields );
+    nColumns = 0;
+    for( int iField = 0; iField < nFields; iField++ )
+    {
+        if( poDefn->GetFieldDefn(iField)->IsIgnored() )
+            anFieldColumn[iField] = -1;
+        else
+            anFieldColumn[iField] = nColumns++;
+    }
+
+    abyState.resize( (size_t)nColumns * nBatchRecords );
+    asValues.resize( (size_t)nColumns * nBatchRecords );
+    achStrings.resize( 0 );
+
+    for( int iField = 0; iField < nFields; iField++ )
+    {
+        const int iCol = anFieldColumn[iField];
+        if( iCol < 0 )
+            continue;
+
+        const OGRFieldType eType = poDefn->GetFieldDefn(iField)->GetType();
+        const char chNativeType = hDBF->pachFieldType[iField];
+        const int nOffset = hDBF->panFieldOffset[iField];
+        const int nWidth = hDBF->panFieldSize[iField];
+        GByte *pabyState = &abyState[(size_t)iCol * nBatchRecords];
+        OGRField *pasValues = &asValues[(size_t)iCol * nBatchRecords];
+
+        for( int i = 0; i < nBatchRecords; i++ )
+        {
+            const char *pszRaw = (const char *)
+                &abyRecords[(size_t)i * hDBF->nRecordLength + nOffset];
+            int nLen;
+            const char *pszValue = DBFTrimmedValue( pszRaw, nWidth, &nLen );
+            OGRField *psValue = pasValues + i;
+
+            pabyState[i] = DBF_VALUE_UNSET;
+
+            if( eType == OFTString )
+            {
+                if( nLen == 0 )
+                    continue;
+            }
+            else
+            {
+                if( DBFIsValueNULL( chNativeType, pszValue, nLen ) )
+                    continue;
+
+                if( eType == OFTInteger || eType == OFTInteger64 )
+                {
+                    GIntBig nValue;
+                    if( DBFParseInteger( pszValue, nLen, &nValue ) &&
+                        (eType == OFTInteger64 ||
+                         (nValue >= INT_MIN && nValue <= INT_MAX)) )
+                    {
+                        if( eType == OFTInteger )
+                            psValue->Integer = (int) nValue;
+                        else
+                            psValue->Integer64 = nValue;
+                        pabyState[i] = DBF_VALUE_SET;
+                        continue;
+                    }
+                }
+                else if( eType == OFTReal )
+                {
+                    GIntBig nValue;
+                    char szValue[256];
+                    char *pszLast = NULL;
+                    if( DBFParseInteger( pszValue, nLen, &nValue ) )
+                    {
+                        psValue->Real = (double) nValue;
+                        pabyState[i] = DBF_VALUE_SET;
+                        continue;
+                    }
+                    if( nLen < (int)sizeof(szValue) )
+                    {
+                        memcpy( szValue, pszValue, nLen );
+                        szValue[nLen] = '\0';
+                        const double dfValue = CPLStrtod( szValue, &pszLast );
+                        if( *pszLast == '\0' )
+                        {
+                            psValue->Real = dfValue;
+                            pabyState[i] = DBF_VALUE_SET;
+                            continue;
+                        }
+                    }
+                }
+                else if( eType == OFTDate )
+                {
+                    /* Some DBF files have fields filled with spaces */
+                    /* to indicate null values for dates (#4265) */
+                    if( nLen == 0 )
+                        continue;
+
+                    char szValue[16];
+                    const int nCopy = MIN(nLen, (int)sizeof(szValue) - 1);
+                    memcpy( szValue, pszValue, nCopy );
+                    szValue[nCopy] = '\0';
+
+                    memset( psValue, 0, sizeof(OGRField) );
+                    if( nLen >= 10 && szValue[2] == '/' && szValue[5] == '/' )
+                    {
+                        psValue->Date.Month = (GByte)atoi(szValue+0);
+                        psValue->Date.Day   = (GByte)atoi(szValue+3);
+                        psValue->Date.Year  = (GInt16)atoi(szValue+6);
+                    }
+                    else
+                    {
+                        int nFullDate = atoi(szValue);
+                        psValue->Date.Year = (GInt16)(nFullDate / 10000);
+                        psValue->Date.Month = (GByte)((nFullDate / 100) % 100);
+                        psValue->Date.Day = (GByte)(nFullDate % 100);
+                    }
+                    pabyState[i] = DBF_VALUE_SET;
+                    continue;
+                }
+            }
+
+            /* Strings, and numeric values that need the generic parsing */
+            /* (and its warnings) of OGRFeature::SetField(). */
+            psValue->Integer = (int) achStrings.size();
+            achStrings.insert( achStrings.end(), pszValue, pszValue + nLen );
+            achStrings.push_back( '\0' );
+            pabyState[i] = DBF_VALUE_STRING;
+        }
+    }
+}
+
+/************************************************************************/
+/*                            FillFeature()                             */
+/*                                                                      */
+/*      Set the attributes of a record loaded with LoadRecord().        */
+/************************************************************************/
+
+void OGRShapeDBFBatchReader::FillFeature( OGRFeature *poFeature,
+                                          int iRecord )
+
+{
+    CPLAssert( iRecord >= iFirstRecord &&
+               iRecord < iFirstRecord + nBatchRecords );
+
+    const int iRow = iRecord - iFirstRecord;
+    const int nFields = poDefn->GetFieldCount();
+
+    for( int iField = 0; iField < nFields; iField++ )
+    {
+        const int iCol = anFieldColumn[iField];
+        if( iCol < 0 )
+            continue;
+
+        const size_t nIdx = (size_t)iCol * nBatchRecords + iRow;
+        if( abyState[nIdx] == DBF_VALUE_UNSET )
+            continue;
+
+        OGRField *psValue = &asValues[nIdx];
+        const OGRFieldType eType = poDefn->GetFieldDefn(iField)->GetType();
+
+        if( abyState[nIdx] == DBF_VALUE_STRING )
+        {
+            const char *pszValue = &achStrings[psValue->Integer];
+            if( eType == OFTString && !osEncoding.empty() )
+            {
+                char *pszUTF8Field = CPLRecode( pszValue, osEncoding,
+                                                CPL_ENC_UTF8 );
+                poFeature->SetField( iField, pszUTF8Field );
+                CPLFree( pszUTF8Field );
+            }
+            else
+                poFeature->SetField( iField, pszValue );
+        }
+        else if( eType == OFTInteger )
+            poFeature->SetField( iField, psValue->Integer );
+        else if( eType == OFTInteger64 )
+            poFeature->SetField( iField, psValue->Integer64 );
+        else if( eType == OFTReal )
+            poFeature->SetField( iField, psValue->Real );
+        else
+            poFeature->SetField( iField, psValue );
+    }
+}
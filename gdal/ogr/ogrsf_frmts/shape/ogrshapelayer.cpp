@@ -75,7 +75,8 @@ OGRShapeLayer::OGRShapeLayer( OGRShapeDataSource* poDSIn,
     bTruncationWarningEmitted(FALSE),
     eFileDescriptorsState(FD_OPENED),
     bResizeAtClose(FALSE),
-    bCreateSpatialIndexAtClose(FALSE)
+    bCreateSpatialIndexAtClose(FALSE),
+    poDBFBatchReader(NULL)
 {
     pszFullName = CPLStrdup(pszFullNameIn);
 
@@ -209,6 +210,8 @@ OGRShapeLayer::OGRShapeLayer( OGRShapeDataSource* poDSIn,
         poSRSIn->Release();
     SetDescription( poFeatureDefn->GetName() );
     bRewindOnWrite = CPLTestBool(CPLGetConfigOption( "SHAPE_REWIND_ON_WRITE", "YES" ));
+    bUseDBFBatchReader = CPLTestBool(CPLGetConfigOption( "SHAPE_DBF_BATCH_READ", "YES" ));
+    bDirectGeomRead = CPLTestBool(CPLGetConfigOption( "SHAPE_DIRECT_GEOM_READ", "YES" ));
 }
 
 /************************************************************************/
@@ -237,6 +240,8 @@ OGRShapeLayer::~OGRShapeLayer()
     ClearMatchingFIDs();
     ClearSpatialFIDs();
 
+    delete poDBFBatchReader;
+
     CPLFree( pszFullName );
 
     if( poFeatureDefn != NULL )
@@ -701,6 +706,63 @@ OGRErr OGRShapeLayer::SetNextByIndex( GIntBig nIndex )
     return OGRERR_NONE;
 }
 
+/************************************************************************/
+/*                          ReadShapeBounds()                           */
+/*                                                                      */
+/*      Read the shape type and the bounding box of a shape from its    */
+/*      record header, using the offset found in the .shx, without      */
+/*      reading the vertices. For points, the bounding box is the       */
+/*      point itself. Returns FALSE if the header cannot be read, in    */
+/*      which case the caller should read the full shape.               */
+/************************************************************************/
+
+int OGRShapeLayer::ReadShapeBounds( int iShape, SHPObject* psShape )
+
+{
+    if( iShape < 0 || iShape >= hSHP->nRecords ||
+        hSHP->panRecOffset[iShape] == 0 /* lazy shx loading case */ ||
+        hSHP->panRecSize[iShape] < 4 )
+        return FALSE;
+
+    GByte abyBuf[4 + 8 * 4];
+    const int nToRead = MIN( (int)sizeof(abyBuf), (int)hSHP->panRecSize[iShape] );
+    if( hSHP->sHooks.FSeek( hSHP->fpSHP, hSHP->panRecOffset[iShape] + 8, 0 ) != 0 ||
+        (int)hSHP->sHooks.FRead( abyBuf, 1, nToRead, hSHP->fpSHP ) != nToRead )
+        return FALSE;
+
+    memcpy(&(psShape->nSHPType), abyBuf, 4);
+    CPL_LSBPTR32(&(psShape->nSHPType));
+    if( psShape->nSHPType == SHPT_NULL )
+        return TRUE;
+
+    if( psShape->nSHPType == SHPT_POINT ||
+        psShape->nSHPType == SHPT_POINTM ||
+        psShape->nSHPType == SHPT_POINTZ )
+    {
+        if( nToRead < 4 + 8 * 2 )
+            return FALSE;
+        memcpy(&(psShape->dfXMin), abyBuf + 4, 8);
+        memcpy(&(psShape->dfYMin), abyBuf + 12, 8);
+        CPL_LSBPTR64(&(psShape->dfXMin));
+        CPL_LSBPTR64(&(psShape->dfYMin));
+        psShape->dfXMax = psShape->dfXMin;
+        psShape->dfYMax = psShape->dfYMin;
+        return TRUE;
+    }
+
+    if( nToRead < 4 + 8 * 4 )
+        return FALSE;
+    memcpy(&(psShape->dfXMin), abyBuf + 4, 8);
+    memcpy(&(psShape->dfYMin), abyBuf + 12, 8);
+    memcpy(&(psShape->dfXMax), abyBuf + 20, 8);
+    memcpy(&(psShape->dfYMax), abyBuf + 28, 8);
+    CPL_LSBPTR64(&(psShape->dfXMin));
+    CPL_LSBPTR64(&(psShape->dfYMin));
+    CPL_LSBPTR64(&(psShape->dfXMax));
+    CPL_LSBPTR64(&(psShape->dfYMax));
+    return TRUE;
+}
+
 /************************************************************************/
 /*                             FetchShape()                             */
 /*                                                                      */
@@ -708,57 +770,88 @@ OGRErr OGRShapeLayer::SetNextByIndex( GIntBig nIndex )
 /*      if the shapeid bbox intersects the geometry.                    */
 /************************************************************************/
 
-OGRFeature *OGRShapeLayer::FetchShape(int iShapeId /*, OGREnvelope* psShapeExtent */)
+OGRFeature *OGRShapeLayer::FetchShape(int iShapeId,
+                                      OGRShapeDBFBatchReader *poDBFReader
+                                      /*, OGREnvelope* psShapeExtent */)
 
 {
     OGRFeature *poFeature;
 
     if (m_poFilterGeom != NULL && hSHP != NULL )
     {
-        SHPObject   *psShape;
-
-        psShape = SHPReadObject( hSHP, iShapeId );
+        SHPObject   sShape;
 
-        // do not trust degenerate bounds on non-point geometries
+        // Only read the shape type and bounding box from the record
+        // header. The geometry is decoded if the bounding box test
+        // is inconclusive or successful.
+        // Do not trust degenerate bounds on non-point geometries
         // or bounds on null shapes.
-        if( psShape == NULL
-            || (psShape->nSHPType != SHPT_POINT
-                && psShape->nSHPType != SHPT_POINTZ
-                && psShape->nSHPType != SHPT_POINTM
-                && (psShape->dfXMin == psShape->dfXMax
-                 || psShape->dfYMin == psShape->dfYMax))
-            || psShape->nSHPType == SHPT_NULL )
+        if( !ReadShapeBounds( iShapeId, &sShape )
+            || (sShape.nSHPType != SHPT_POINT
+                && sShape.nSHPType != SHPT_POINTZ
+                && sShape.nSHPType != SHPT_POINTM
+                && (sShape.dfXMin == sShape.dfXMax
+                 || sShape.dfYMin == sShape.dfYMax))
+            || sShape.nSHPType == SHPT_NULL )
         {
             poFeature = SHPReadOGRFeature( hSHP, hDBF, poFeatureDefn,
-                                           iShapeId, psShape, osEncoding );
+                                           iShapeId, NULL, osEncoding,
+                                           poDBFReader, bDirectGeomRead );
         }
-        else if( m_sFilterEnvelope.MaxX < psShape->dfXMin
-                 || m_sFilterEnvelope.MaxY < psShape->dfYMin
-                 || psShape->dfXMax  < m_sFilterEnvelope.MinX
-                 || psShape->dfYMax < m_sFilterEnvelope.MinY )
+        else if( m_sFilterEnvelope.MaxX < sShape.dfXMin
+                 || m_sFilterEnvelope.MaxY < sShape.dfYMin
+                 || sShape.dfXMax  < m_sFilterEnvelope.MinX
+                 || sShape.dfYMax < m_sFilterEnvelope.MinY )
         {
-            SHPDestroyObject(psShape);
             poFeature = NULL;
         }
         else
         {
-            /*psShapeExtent->MinX = psShape->dfXMin;
-            psShapeExtent->MinY = psShape->dfYMin;
-            psShapeExtent->MaxX = psShape->dfXMax;
-            psShapeExtent->MaxY = psShape->dfYMax;*/
             poFeature = SHPReadOGRFeature( hSHP, hDBF, poFeatureDefn,
-                                           iShapeId, psShape, osEncoding );
+                                           iShapeId, NULL, osEncoding,
+                                           poDBFReader, bDirectGeomRead );
         }
     }
     else
     {
         poFeature = SHPReadOGRFeature( hSHP, hDBF, poFeatureDefn,
-                                       iShapeId, NULL, osEncoding );
+                                       iShapeId, NULL, osEncoding,
+                                       poDBFReader, bDirectGeomRead );
     }
 
     return poFeature;
 }
 
+/************************************************************************/
+/*                         GetDBFBatchReader()                          */
+/*                                                                      */
+/*      Return the reader used to fetch attributes by batches during    */
+/*      sequential reading, or NULL if it cannot be used. It is only    */
+/*      used in read-only mode, so that the records read through it     */
+/*      cannot be stale.                                                */
+/************************************************************************/
+
+OGRShapeDBFBatchReader *OGRShapeLayer::GetDBFBatchReader()
+
+{
+    if( hDBF == NULL || bUpdateAccess || !bUseDBFBatchReader ||
+        hDBF->nFields != poFeatureDefn->GetFieldCount() )
+        return NULL;
+
+    if( poDBFBatchReader != NULL &&
+        poDBFBatchReader->GetDBFHandle() != hDBF )
+    {
+        delete poDBFBatchReader;
+        poDBFBatchReader = NULL;
+    }
+
+    if( poDBFBatchReader == NULL )
+        poDBFBatchReader = new OGRShapeDBFBatchReader( hDBF, poFeatureDefn,
+                                                       osEncoding );
+
+    return poDBFBatchReader;
+}
+
 /************************************************************************/
 /*                           GetNextFeature()                           */
 /************************************************************************/
@@ -810,7 +903,17 @@ OGRFeature *OGRShapeLayer::GetNextFeature()
                 return NULL;
             }
 
-            if( hDBF )
+            OGRShapeDBFBatchReader *poDBFReader = GetDBFBatchReader();
+            if( poDBFReader != NULL )
+            {
+                if( !poDBFReader->LoadRecord( iNextShapeId ) )
+                    return NULL; /* There's an I/O error */
+                else if( poDBFReader->IsRecordDeleted( iNextShapeId ) )
+                    poFeature = NULL;
+                else
+                    poFeature = FetchShape(iNextShapeId, poDBFReader);
+            }
+            else if( hDBF )
             {
                 if (DBFIsRecordDeleted( hDBF, iNextShapeId ))
                     poFeature = NULL;
@@ -858,7 +961,7 @@ OGRFeature *OGRShapeLayer::GetFeature( GIntBig nFeatureId )
 
     OGRFeature *poFeature = NULL;
     poFeature = SHPReadOGRFeature( hSHP, hDBF, poFeatureDefn, (int)nFeatureId, NULL,
-                                   osEncoding );
+                                   osEncoding, NULL, bDirectGeomRead );
 
     if( poFeature != NULL )
     {
@@ -2926,6 +3029,9 @@ void OGRShapeLayer::CloseUnderlyingLayer()
 {
     CPLDebug("SHAPE", "CloseUnderlyingLayer(%s)", pszFullName);
 
+    delete poDBFBatchReader;
+    poDBFBatchReader = NULL;
+
     if( hDBF != NULL )
         DBFClose( hDBF );
     hDBF = NULL;
@@ -488,6 +488,161 @@ OGRGeometry *SHPReadOGRObject( SHPHandle hSHP, int iShape, SHPObject *psShape )
     return poOGR;
 }
 
+/************************************************************************/
+/*                       SHPReadOGRObjectDirect()                       */
+/*                                                                      */
+/*      Same as SHPReadOGRObject(), but for 2D point, arc and polygon   */
+/*      layers the OGR geometry is built straight from the .shp         */
+/*      record, without going through the SHPObject arrays. On little   */
+/*      endian hosts the X/Y pairs of the record have the layout of     */
+/*      OGRRawPoint, so the vertices are only copied once. Other shape  */
+/*      types, and records that fail the consistency checks, are        */
+/*      handed over to SHPReadOGRObject().                              */
+/************************************************************************/
+
+OGRGeometry *SHPReadOGRObjectDirect( SHPHandle hSHP, int iShape )
+{
+#ifdef CPL_LSB
+    if( hSHP->nShapeType != SHPT_POINT &&
+        hSHP->nShapeType != SHPT_ARC &&
+        hSHP->nShapeType != SHPT_POLYGON )
+        return SHPReadOGRObject( hSHP, iShape, NULL );
+
+    int nSize = 0;
+    const GByte* pabyRec = SHPReadRawObject( hSHP, iShape, &nSize );
+    if( pabyRec == NULL )
+        return NULL;
+
+    GInt32 nSHPType;
+    memcpy( &nSHPType, pabyRec, 4 );
+
+    if( nSHPType == SHPT_NULL )
+        return NULL;
+
+/* -------------------------------------------------------------------- */
+/*      Point.                                                          */
+/* -------------------------------------------------------------------- */
+    if( nSHPType == SHPT_POINT )
+    {
+        if( nSize < 4 + 16 )
+            return SHPReadOGRObject( hSHP, iShape, NULL );
+
+        double dfX, dfY;
+        memcpy( &dfX, pabyRec + 4, 8 );
+        memcpy( &dfY, pabyRec + 12, 8 );
+        return new OGRPoint( dfX, dfY );
+    }
+
+    if( (nSHPType != SHPT_ARC && nSHPType != SHPT_POLYGON) || nSize < 44 )
+        return SHPReadOGRObject( hSHP, iShape, NULL );
+
+/* -------------------------------------------------------------------- */
+/*      Check the part and point counts, and the part starts, as        */
+/*      SHPReadObject() does.                                           */
+/* -------------------------------------------------------------------- */
+    GInt32 nParts, nPoints;
+    memcpy( &nParts, pabyRec + 36, 4 );
+    memcpy( &nPoints, pabyRec + 40, 4 );
+    if( nParts < 0 || nPoints < 0 ||
+        nPoints > 50 * 1000 * 1000 || nParts > 10 * 1000 * 1000 ||
+        44 + 4 * nParts + 16 * nPoints > nSize )
+        return SHPReadOGRObject( hSHP, iShape, NULL );
+
+    const GByte* pabyPartStart = pabyRec + 44;
+    GInt32 nPrevStart = 0;
+    for( int iPart = 0; iPart < nParts; iPart++ )
+    {
+        GInt32 nStart;
+        memcpy( &nStart, pabyPartStart + 4 * iPart, 4 );
+        if( nStart < 0
+            || (nStart >= nPoints && nPoints > 0)
+            || (nStart > 0 && nPoints == 0)
+            || (iPart > 0 && nStart <= nPrevStart) )
+            return SHPReadOGRObject( hSHP, iShape, NULL );
+        nPrevStart = nStart;
+    }
+
+    if( nParts == 0 )
+        return NULL;
+
+    OGRRawPoint* pasPoints = (OGRRawPoint*) (pabyPartStart + 4 * nParts);
+
+/* -------------------------------------------------------------------- */
+/*      Arc (LineString)                                                */
+/* -------------------------------------------------------------------- */
+    if( nSHPType == SHPT_ARC )
+    {
+        if( nParts == 1 )
+        {
+            OGRLineString *poOGRLine = new OGRLineString();
+            poOGRLine->setPoints( nPoints, pasPoints );
+            return poOGRLine;
+        }
+
+        OGRMultiLineString *poOGRMulti = new OGRMultiLineString();
+        for( int iPart = 0; iPart < nParts; iPart++ )
+        {
+            GInt32 nStart, nEnd = nPoints;
+            memcpy( &nStart, pabyPartStart + 4 * iPart, 4 );
+            if( iPart < nParts - 1 )
+                memcpy( &nEnd, pabyPartStart + 4 * (iPart + 1), 4 );
+
+            OGRLineString *poLine = new OGRLineString();
+            poLine->setPoints( nEnd - nStart, pasPoints + nStart );
+            poOGRMulti->addGeometryDirectly( poLine );
+        }
+        return poOGRMulti;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Polygon                                                         */
+/* -------------------------------------------------------------------- */
+    OGRPolygon** tabPolygons = new OGRPolygon*[nParts];
+    for( int iPart = 0; iPart < nParts; iPart++ )
+    {
+        GInt32 nStart, nEnd = nPoints;
+        memcpy( &nStart, pabyPartStart + 4 * iPart, 4 );
+        if( iPart < nParts - 1 )
+            memcpy( &nEnd, pabyPartStart + 4 * (iPart + 1), 4 );
+
+        OGRLinearRing *poRing = new OGRLinearRing();
+        if( nEnd > nStart )
+            poRing->setPoints( nEnd - nStart, pasPoints + nStart );
+
+        tabPolygons[iPart] = new OGRPolygon();
+        tabPolygons[iPart]->addRingDirectly( poRing );
+    }
+
+    OGRGeometry* poOGR;
+    if( nParts == 1 )
+    {
+        /* Surely outer ring */
+        poOGR = tabPolygons[0];
+    }
+    else
+    {
+        int isValidGeometry;
+        const char* papszOptions[] = { "METHOD=ONLY_CCW", NULL };
+        poOGR = OGRGeometryFactory::organizePolygons(
+            (OGRGeometry**)tabPolygons, nParts, &isValidGeometry, papszOptions );
+
+        if (!isValidGeometry)
+        {
+            CPLError(CE_Warning, CPLE_AppDefined,
+                    "Geometry of polygon of fid %d cannot be translated to Simple Geometry. "
+                    "All polygons will be contained in a multipolygon.\n",
+                    iShape);
+        }
+    }
+
+    delete[] tabPolygons;
+
+    return poOGR;
+#else
+    return SHPReadOGRObject( hSHP, iShape, NULL );
+#endif
+}
+
 /************************************************************************/
 /*                         SHPWriteOGRObject()                          */
 /************************************************************************/
@@ -1158,7 +1313,9 @@ OGRFeatureDefn *SHPReadOGRFeatureDefn( const char * pszName,
 
 OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
                                OGRFeatureDefn * poDefn, int iShape,
-                               SHPObject *psShape, const char *pszSHPEncoding )
+                               SHPObject *psShape, const char *pszSHPEncoding,
+                               OGRShapeDBFBatchReader *poDBFReader,
+                               int bDirectGeomRead )
 
 {
     if( iShape < 0
@@ -1171,7 +1328,16 @@ OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
         return NULL;
     }
 
-    if( hDBF && DBFIsRecordDeleted( hDBF, iShape ) )
+/* -------------------------------------------------------------------- */
+/*      Use the batch reader if provided and if the record can be       */
+/*      read through it.                                                */
+/* -------------------------------------------------------------------- */
+    const int bUseDBFReader = hDBF != NULL && poDBFReader != NULL &&
+                              poDBFReader->GetDBFHandle() == hDBF &&
+                              poDBFReader->LoadRecord( iShape );
+
+    if( hDBF && (bUseDBFReader ? poDBFReader->IsRecordDeleted( iShape ) :
+                                 DBFIsRecordDeleted( hDBF, iShape )) )
     {
         CPLError( CE_Failure, CPLE_AppDefined,
                   "Attempt to read shape with feature id (%d), but it is marked deleted.",
@@ -1191,7 +1357,10 @@ OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
         if( !poDefn->IsGeometryIgnored() )
         {
             OGRGeometry* poGeometry = NULL;
-            poGeometry = SHPReadOGRObject( hSHP, iShape, psShape );
+            if( psShape == NULL && bDirectGeomRead )
+                poGeometry = SHPReadOGRObjectDirect( hSHP, iShape );
+            else
+                poGeometry = SHPReadOGRObject( hSHP, iShape, psShape );
 
             /*
             * NOTE - mloskot:
@@ -1240,8 +1409,12 @@ OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
 /* -------------------------------------------------------------------- */
 /*      Fetch feature attributes to OGRFeature fields.                  */
 /* -------------------------------------------------------------------- */
+    if( bUseDBFReader )
+        poDBFReader->FillFeature( poFeature, iShape );
 
-    for( int iField = 0; hDBF != NULL && iField < poDefn->GetFieldCount(); iField++ )
+    for( int iField = 0;
+         hDBF != NULL && !bUseDBFReader && iField < poDefn->GetFieldCount();
+         iField++ )
     {
         OGRFieldDefn* poFieldDefn = poDefn->GetFieldDefn(iField);
         if (poFieldDefn->IsIgnored() )
@@ -402,6 +402,10 @@ void SHPAPI_CALL
 
 SHPObject SHPAPI_CALL1(*)
       SHPReadObject( SHPHandle hSHP, int iShape );
+/* Returns the undecoded record content of a shape. The buffer is owned by */
+/* the SHPHandle and is only valid until the next read. */
+const unsigned char SHPAPI_CALL1(*)
+      SHPReadRawObject( SHPHandle hSHP, int iShape, int *pnSize );
 int SHPAPI_CALL
       SHPWriteObject( SHPHandle hSHP, int iShape, SHPObject * psObject );
 
@@ -1740,27 +1740,24 @@ static unsigned char* SHPReallocObjectBufIfNecessary ( SHPHandle psSHP,
 }
 
 /************************************************************************/
-/*                          SHPReadObject()                             */
+/*                           SHPReadRecord()                            */
 /*                                                                      */
-/*      Read the vertices, parts, and other non-attribute information	*/
-/*	for one shape.							*/
+/*      Read the raw record of a shape, including its 8 byte record     */
+/*      header, into psSHP->pabyRec.                                    */
 /************************************************************************/
 
-SHPObject SHPAPI_CALL1(*)
-SHPReadObject( SHPHandle psSHP, int hEntity )
+static int SHPReadRecord( SHPHandle psSHP, int hEntity, int *pnEntitySize )
 
 {
-    int                  nEntitySize, nRequiredSize;
-    SHPObject           *psShape;
+    int                  nEntitySize;
     char                 szErrorMsg[128];
-    int                  nSHPType;
     int                  nBytesRead;
 
 /* -------------------------------------------------------------------- */
 /*      Validate the record/entity number.                              */
 /* -------------------------------------------------------------------- */
     if( hEntity < 0 || hEntity >= psSHP->nRecords )
-        return( NULL );
+        return FALSE;
 
 /* -------------------------------------------------------------------- */
 /*      Read offset/length from SHX loading if necessary.               */
@@ -1779,7 +1776,7 @@ SHPReadObject( SHPHandle psSHP, int hEntity )
                     100 + 8 * hEntity);
 
             psSHP->sHooks.Error( str );
-            return NULL;
+            return FALSE;
         }
         if( !bBigEndian ) SwapWord( 4, &nOffset );
         if( !bBigEndian ) SwapWord( 4, &nLength );
@@ -1791,7 +1788,7 @@ SHPReadObject( SHPHandle psSHP, int hEntity )
                     "Invalid offset for entity %d", hEntity);
 
             psSHP->sHooks.Error( str );
-            return NULL;
+            return FALSE;
         }
         if( nLength > (unsigned int)(INT_MAX / 2 - 4) )
         {
@@ -1800,7 +1797,7 @@ SHPReadObject( SHPHandle psSHP, int hEntity )
                     "Invalid length for entity %d", hEntity);
 
             psSHP->sHooks.Error( str );
-            return NULL;
+            return FALSE;
         }
 
         psSHP->panRecOffset[hEntity] = nOffset*2;
@@ -1843,7 +1840,7 @@ SHPReadObject( SHPHandle psSHP, int hEntity )
                          nEntitySize, psSHP->panRecOffset[hEntity] );
 
                 psSHP->sHooks.Error( str );
-                return NULL;
+                return FALSE;
             }
         }
 
@@ -1856,7 +1853,7 @@ SHPReadObject( SHPHandle psSHP, int hEntity )
                      "Not enough memory to allocate requested memory (nNewBufSize=%d). "
                      "Probably broken SHP file", nNewBufSize);
             psSHP->sHooks.Error( szError );
-            return NULL;
+            return FALSE;
         }
 
         /* Only set new buffer size after successful alloc */
@@ -1867,7 +1864,7 @@ SHPReadObject( SHPHandle psSHP, int hEntity )
     /* In case we were not able to reallocate the buffer on a previous step */
     if (psSHP->pabyRec == NULL)
     {
-        return NULL;
+        return FALSE;
     }
 
 /* -------------------------------------------------------------------- */
@@ -1885,7 +1882,7 @@ SHPReadObject( SHPHandle psSHP, int hEntity )
                  psSHP->panRecOffset[hEntity]);
 
         psSHP->sHooks.Error( str );
-        return NULL;
+        return FALSE;
     }
 
     nBytesRead = (int)psSHP->sHooks.FRead( psSHP->pabyRec, 1, nEntitySize, psSHP->fpSHP );
@@ -1912,7 +1909,7 @@ SHPReadObject( SHPHandle psSHP, int hEntity )
                     hEntity );
 
             psSHP->sHooks.Error( str );
-            return NULL;
+            return FALSE;
         }
     }
     else if( nBytesRead != nEntitySize )
@@ -1927,7 +1924,7 @@ SHPReadObject( SHPHandle psSHP, int hEntity )
                  nEntitySize, psSHP->panRecOffset[hEntity] );
 
         psSHP->sHooks.Error( str );
-        return NULL;
+        return FALSE;
     }
 
     if ( 8 + 4 > nEntitySize )
@@ -1936,8 +1933,55 @@ SHPReadObject( SHPHandle psSHP, int hEntity )
                  "Corrupted .shp file : shape %d : nEntitySize = %d",
                  hEntity, nEntitySize);
         psSHP->sHooks.Error( szErrorMsg );
-        return NULL;
+        return FALSE;
     }
+
+    *pnEntitySize = nEntitySize;
+    return TRUE;
+}
+
+/************************************************************************/
+/*                          SHPReadRawObject()                          */
+/*                                                                      */
+/*      Read the record of a shape without decoding it, so that the     */
+/*      caller can build its own geometry from it. The returned         */
+/*      pointer is the record content (starting with the shape type,    */
+/*      in little endian order) and is owned by the SHPHandle. It is    */
+/*      only valid until the next read of the handle.                   */
+/************************************************************************/
+
+const unsigned char SHPAPI_CALL1(*)
+SHPReadRawObject( SHPHandle psSHP, int hEntity, int *pnSize )
+
+{
+    int nEntitySize;
+
+    if( !SHPReadRecord( psSHP, hEntity, &nEntitySize ) )
+        return NULL;
+
+    *pnSize = nEntitySize - 8;
+    return psSHP->pabyRec + 8;
+}
+
+/************************************************************************/
+/*                          SHPReadObject()                             */
+/*                                                                      */
+/*      Read the vertices, parts, and other non-attribute information	*/
+/*	for one shape.							*/
+/************************************************************************/
+
+SHPObject SHPAPI_CALL1(*)
+SHPReadObject( SHPHandle psSHP, int hEntity )
+
+{
+    int                  nEntitySize, nRequiredSize;
+    SHPObject           *psShape;
+    char                 szErrorMsg[128];
+    int                  nSHPType;
+
+    if( !SHPReadRecord( psSHP, hEntity, &nEntitySize ) )
+        return NULL;
+
     memcpy( &nSHPType, psSHP->pabyRec + 8, 4 );
 
     if( bBigEndian ) SwapWord( 4, &(nSHPType) );
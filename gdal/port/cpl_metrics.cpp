@@ -0,0 +1,546 @@
+/**********************************************************************
+ * $Id$
+ *
+ * Name:     cpl_metrics.cpp
+ * Project:  CPL - Common Portability Library
+ * Purpose:  Process wide registry of performance counters and histograms.
+ *
+ **********************************************************************
+ * Copyright (c) 2016, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "cpl_metrics.h"
+#include "cpl_conv.h"
+#include "cpl_multiproc.h"
+#include "cpl_string.h"
+#include "cpl_vsi.h"
+
+#include <map>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+
+CPL_CVSID("$Id$");
+
+/* Number of power of two buckets of histograms. Bucket 0 holds values */
+/* lower than 1, bucket i values in [2^(i-1), 2^i[. */
+#define CPL_METRIC_BUCKET_COUNT 64
+
+typedef enum
+{
+    CPL_METRIC_COUNTER,
+    CPL_METRIC_HISTOGRAM
+} CPLMetricType;
+
+struct _CPLMetric
+{
+    char            *pszName;
+    CPLMetricType    eType;
+    CPLMetric       *psNext;
+
+    /* Counter */
+    volatile GIntBig nValue;
+
+    /* Histogram, protected by hLock */
+    CPLLock         *hLock;
+    GIntBig          nCount;
+    double           dfSum;
+    double           dfMin;
+    double           dfMax;
+    GIntBig          anBuckets[CPL_METRIC_BUCKET_COUNT];
+};
+
+/* Metrics are never freed, so that instrumented code can keep the */
+/* handles in static variables for the life of the process. */
+static CPLMutex  *hMetricsMutex = NULL;
+static CPLMetric *psFirstMetric = NULL;
+
+/************************************************************************/
+/*                         CPLMetricAtomicAdd()                         */
+/************************************************************************/
+
+static void CPLMetricAtomicAdd( volatile GIntBig* pnValue, GIntBig nIncrement )
+{
+#if defined(__GNUC__) && SIZEOF_VOIDP == 8
+    __sync_fetch_and_add(pnValue, nIncrement);
+#elif defined(_MSC_VER) && defined(_WIN64)
+    InterlockedExchangeAdd64(pnValue, nIncrement);
+#else
+    /* No native 64 bit atomic addition on this platform */
+    static CPLLock* hCounterLock = NULL;
+    CPLLockHolderD( &hCounterLock, LOCK_SPIN );
+    *pnValue += nIncrement;
+#endif
+}
+
+/************************************************************************/
+/*                          CPLMetricGetOrCreate()                      */
+/************************************************************************/
+
+static CPLMetric* CPLMetricGetOrCreate( const char* pszName,
+                                        CPLMetricType eType )
+{
+    if( pszName == NULL || pszName[0] == '\0' )
+        return NULL;
+
+    CPLMutexHolderD( &hMetricsMutex );
+
+    for( CPLMetric* psIter = psFirstMetric; psIter; psIter = psIter->psNext )
+    {
+        if( strcmp(psIter->pszName, pszName) == 0 )
+        {
+            if( psIter->eType != eType )
+            {
+                CPLError(CE_Failure, CPLE_AppDefined,
+                         "Metric %s is already registered with another type",
+                         pszName);
+                return NULL;
+            }
+            return psIter;
+        }
+    }
+
+    CPLMetric* psMetric =
+        static_cast<CPLMetric*>(CPLCalloc(1, sizeof(CPLMetric)));
+    psMetric->pszName = CPLStrdup(pszName);
+    psMetric->eType = eType;
+    if( eType == CPL_METRIC_HISTOGRAM )
+        psMetric->hLock = CPLCreateLock(LOCK_SPIN);
+    psMetric->psNext = psFirstMetric;
+    psFirstMetric = psMetric;
+    return psMetric;
+}
+
+/************************************************************************/
+/*                         CPLMetricGetCounter()                        */
+/************************************************************************/
+
+/**
+ * Return the counter of the given name, registering it if needed.
+ *
+ * The returned handle remains valid until the process exits.
+ *
+ * @param pszName metric name, conventionally a dot separated path such as
+ *                "gdal.block_cache.hits".
+ * @return the counter, or NULL if the name is already used by a histogram.
+ * @since GDAL 2.2
+ */
+
+CPLMetric* CPLMetricGetCounter( const char* pszName )
+{
+    return CPLMetricGetOrCreate( pszName, CPL_METRIC_COUNTER );
+}
+
+/************************************************************************/
+/*                        CPLMetricGetHistogram()                       */
+/************************************************************************/
+
+/**
+ * Return the histogram of the given name, registering it if needed.
+ *
+ * Histograms keep the count, sum, minimum and maximum of the recorded
+ * values, as well as their distribution in power of two buckets.
+ * The returned handle remains valid until the process exits.
+ *
+ * @param pszName metric name.
+ * @return the histogram, or NULL if the name is already used by a counter.
+ * @since GDAL 2.2
+ */
+
+CPLMetric* CPLMetricGetHistogram( const char* pszName )
+{
+    return CPLMetricGetOrCreate( pszName, CPL_METRIC_HISTOGRAM );
+}
+
+/************************************************************************/
+/*                            CPLMetricAdd()                            */
+/************************************************************************/
+
+/**
+ * Atomically add a value to a counter.
+ *
+ * @param psMetric counter handle. NULL is accepted and ignored.
+ * @param nIncrement value to add.
+ * @since GDAL 2.2
+ */
+
+void CPLMetricAdd( CPLMetric* psMetric, GIntBig nIncrement )
+{
+    if( psMetric == NULL || psMetric->eType != CPL_METRIC_COUNTER )
+        return;
+    CPLMetricAtomicAdd( &(psMetric->nValue), nIncrement );
+}
+
+/************************************************************************/
+/*                          CPLMetricRecord()                           */
+/************************************************************************/
+
+/**
+ * Record a value in a histogram.
+ *
+ * @param psMetric histogram handle. NULL is accepted and ignored.
+ * @param dfValue value to record.
+ * @since GDAL 2.2
+ */
+
+void CPLMetricRecord( CPLMetric* psMetric, double dfValue )
+{
+    if( psMetric == NULL || psMetric->eType != CPL_METRIC_HISTOGRAM )
+        return;
+
+    int iBucket = 0;
+    if( dfValue >= 1.0 )
+    {
+        int nExp = 0;
+        frexp( dfValue, &nExp );
+        iBucket = MIN(nExp, CPL_METRIC_BUCKET_COUNT - 1);
+    }
+
+    CPLAcquireLock( psMetric->hLock );
+    if( psMetric->nCount == 0 || dfValue < psMetric->dfMin )
+        psMetric->dfMin = dfValue;
+    if( psMetric->nCount == 0 || dfValue > psMetric->dfMax )
+        psMetric->dfMax = dfValue;
+    psMetric->nCount ++;
+    psMetric->dfSum += dfValue;
+    psMetric->anBuckets[iBucket] ++;
+    CPLReleaseLock( psMetric->hLock );
+}
+
+/************************************************************************/
+/*                          CPLMetricFindByName()                       */
+/************************************************************************/
+
+static CPLMetric* CPLMetricFindByName( const char* pszName )
+{
+    CPLMutexHolderD( &hMetricsMutex );
+    for( CPLMetric* psIter = psFirstMetric; psIter; psIter = psIter->psNext )
+    {
+        if( strcmp(psIter->pszName, pszName) == 0 )
+            return psIter;
+    }
+    return NULL;
+}
+
+/************************************************************************/
+/*                          CPLMetricGetValue()                         */
+/************************************************************************/
+
+/**
+ * Return the current value of a counter.
+ *
+ * @param pszName counter name.
+ * @param pnValue pointer to the value to fill.
+ * @return TRUE if the counter exists.
+ * @since GDAL 2.2
+ */
+
+int CPLMetricGetValue( const char* pszName, GIntBig* pnValue )
+{
+    CPLMetric* psMetric = CPLMetricFindByName( pszName );
+    if( psMetric == NULL || psMetric->eType != CPL_METRIC_COUNTER )
+        return FALSE;
+    if( pnValue )
+        *pnValue = psMetric->nValue;
+    return TRUE;
+}
+
+/************************************************************************/
+/*                     CPLMetricGetHistogramStats()                     */
+/************************************************************************/
+
+/**
+ * Return the summary statistics of a histogram.
+ *
+ * @param pszName histogram name.
+ * @param pnCount pointer to the number of recorded values, or NULL.
+ * @param pdfSum pointer to the sum of recorded values, or NULL.
+ * @param pdfMin pointer to the minimum recorded value, or NULL.
+ * @param pdfMax pointer to the maximum recorded value, or NULL.
+ * @return TRUE if the histogram exists.
+ * @since GDAL 2.2
+ */
+
+int CPLMetricGetHistogramStats( const char* pszName, GIntBig* pnCount,
+                                double* pdfSum, double* pdfMin,
+                                double* pdfMax )
+{
+    CPLMetric* psMetric = CPLMetricFindByName( pszName );
+    if( psMetric == NULL || psMetric->eType != CPL_METRIC_HISTOGRAM )
+        return FALSE;
+
+    CPLAcquireLock( psMetric->hLock );
+    if( pnCount )
+        *pnCount = psMetric->nCount;
+    if( pdfSum )
+        *pdfSum = psMetric->dfSum;
+    if( pdfMin )
+        *pdfMin = psMetric->dfMin;
+    if( pdfMax )
+        *pdfMax = psMetric->dfMax;
+    CPLReleaseLock( psMetric->hLock );
+    return TRUE;
+}
+
+/************************************************************************/
+/*                         CPLMetricsGetNames()                         */
+/************************************************************************/
+
+/**
+ * Return the sorted list of registered metric names.
+ *
+ * @return a NULL terminated list to free with CSLDestroy().
+ * @since GDAL 2.2
+ */
+
+char** CPLMetricsGetNames()
+{
+    CPLStringList aosNames;
+    {
+        CPLMutexHolderD( &hMetricsMutex );
+        for( CPLMetric* psIter = psFirstMetric; psIter; psIter = psIter->psNext )
+            aosNames.AddString( psIter->pszName );
+    }
+    aosNames.Sort();
+    return aosNames.StealList();
+}
+
+/************************************************************************/
+/*                          CPLMetricsJSONName()                        */
+/************************************************************************/
+
+static CPLString CPLMetricsJSONName( const char* pszName )
+{
+    CPLString osRet("\"");
+    for( ; *pszName; pszName++ )
+    {
+        if( *pszName == '"' || *pszName == '\\' )
+            osRet += '\\';
+        if( static_cast<unsigned char>(*pszName) >= 32 )
+            osRet += *pszName;
+    }
+    osRet += "\"";
+    return osRet;
+}
+
+/************************************************************************/
+/*                         CPLMetricsGetAsJSON()                        */
+/************************************************************************/
+
+/**
+ * Serialize all registered metrics as a JSON document.
+ *
+ * The document is an object with a "counters" member mapping counter names
+ * to their values, and a "histograms" member mapping histogram names to
+ * objects with "count", "sum", "min", "max" and "buckets" members. Buckets
+ * are listed as [upper_bound, count] pairs, only for non empty buckets.
+ *
+ * @return a string to free with CPLFree().
+ * @since GDAL 2.2
+ */
+
+char* CPLMetricsGetAsJSON()
+{
+    std::map<std::string, CPLMetric*> oMapSorted;
+    {
+        CPLMutexHolderD( &hMetricsMutex );
+        for( CPLMetric* psIter = psFirstMetric; psIter; psIter = psIter->psNext )
+            oMapSorted[psIter->pszName] = psIter;
+    }
+
+    CPLString osCounters;
+    CPLString osHistograms;
+    std::map<std::string, CPLMetric*>::iterator oIter = oMapSorted.begin();
+    for( ; oIter != oMapSorted.end(); ++oIter )
+    {
+        CPLMetric* psMetric = oIter->second;
+        if( psMetric->eType == CPL_METRIC_COUNTER )
+        {
+            if( !osCounters.empty() )
+                osCounters += ",\n";
+            osCounters += "    " + CPLMetricsJSONName(psMetric->pszName);
+            osCounters += CPLSPrintf(": " CPL_FRMT_GIB,
+                                     static_cast<GIntBig>(psMetric->nValue));
+            continue;
+        }
+
+        GIntBig nCount;
+        double dfSum, dfMin, dfMax;
+        GIntBig anBuckets[CPL_METRIC_BUCKET_COUNT];
+        CPLAcquireLock( psMetric->hLock );
+        nCount = psMetric->nCount;
+        dfSum = psMetric->dfSum;
+        dfMin = psMetric->dfMin;
+        dfMax = psMetric->dfMax;
+        memcpy(anBuckets, psMetric->anBuckets, sizeof(anBuckets));
+        CPLReleaseLock( psMetric->hLock );
+
+        if( !osHistograms.empty() )
+            osHistograms += ",\n";
+        osHistograms += "    " + CPLMetricsJSONName(psMetric->pszName);
+        osHistograms += CPLSPrintf(": { \"count\": " CPL_FRMT_GIB
+                                   ", \"sum\": %.18g, \"min\": %.18g"
+                                   ", \"max\": %.18g, \"buckets\": [",
+                                   nCount, dfSum, dfMin, dfMax);
+        bool bFirst = true;
+        for( int i = 0; i < CPL_METRIC_BUCKET_COUNT; i++ )
+        {
+            if( anBuckets[i] == 0 )
+                continue;
+            if( !bFirst )
+                osHistograms += ", ";
+            bFirst = false;
+            osHistograms += CPLSPrintf("[%.18g, " CPL_FRMT_GIB "]",
+                                       ldexp(1.0, i), anBuckets[i]);
+        }
+        osHistograms += "] }";
+    }
+
+    CPLString osJSON("{\n  \"counters\": {");
+    if( !osCounters.empty() )
+        osJSON += "\n" + osCounters + "\n  ";
+    osJSON += "},\n  \"histograms\": {";
+    if( !osHistograms.empty() )
+        osJSON += "\n" + osHistograms + "\n  ";
+    osJSON += "}\n}\n";
+    return CPLStrdup(osJSON);
+}
+
+/************************************************************************/
+/*                           CPLMetricsReset()                          */
+/************************************************************************/
+
+/**
+ * Reset all registered counters and histograms to zero.
+ *
+ * Updates made concurrently by other threads may be lost.
+ *
+ * @since GDAL 2.2
+ */
+
+void CPLMetricsReset()
+{
+    CPLMutexHolderD( &hMetricsMutex );
+    for( CPLMetric* psIter = psFirstMetric; psIter; psIter = psIter->psNext )
+    {
+        if( psIter->eType == CPL_METRIC_COUNTER )
+        {
+            psIter->nValue = 0;
+            continue;
+        }
+        CPLAcquireLock( psIter->hLock );
+        psIter->nCount = 0;
+        psIter->dfSum = 0.0;
+        psIter->dfMin = 0.0;
+        psIter->dfMax = 0.0;
+        memset(psIter->anBuckets, 0, sizeof(psIter->anBuckets));
+        CPLReleaseLock( psIter->hLock );
+    }
+}
+
+/************************************************************************/
+/*                    CPLMetricsGetTimeMicroseconds()                   */
+/************************************************************************/
+
+/**
+ * Return a timestamp in microseconds, suitable to measure durations.
+ *
+ * The origin of the timestamp is unspecified.
+ *
+ * @since GDAL 2.2
+ */
+
+GIntBig CPLMetricsGetTimeMicroseconds()
+{
+#ifdef _WIN32
+    static LARGE_INTEGER sFrequency = { { 0, 0 } };
+    if( sFrequency.QuadPart == 0 )
+        QueryPerformanceFrequency( &sFrequency );
+    LARGE_INTEGER sCounter;
+    QueryPerformanceCounter( &sCounter );
+    if( sFrequency.QuadPart == 0 )
+        return 0;
+    return static_cast<GIntBig>(
+        static_cast<double>(sCounter.QuadPart) * 1e6 / sFrequency.QuadPart);
+#else
+    struct timeval tv;
+    gettimeofday( &tv, NULL );
+    return static_cast<GIntBig>(tv.tv_sec) * 1000000 + tv.tv_usec;
+#endif
+}
+
+/************************************************************************/
+/*                         CPLMetricsDumpAtExit()                       */
+/************************************************************************/
+
+/**
+ * Write the metrics as JSON if requested by the CPL_METRICS_OUTPUT
+ * configuration option.
+ *
+ * CPL_METRICS_OUTPUT can be set to "stdout", "stderr" or a filename.
+ * This is called by GDALDestroyDriverManager(), so applications do not
+ * normally need to call it.
+ *
+ * @since GDAL 2.2
+ */
+
+void CPLMetricsDumpAtExit()
+{
+    const char* pszOutput = CPLGetConfigOption("CPL_METRICS_OUTPUT", NULL);
+    if( pszOutput == NULL || pszOutput[0] == '\0' )
+        return;
+
+    char* pszJSON = CPLMetricsGetAsJSON();
+    if( EQUAL(pszOutput, "stdout") )
+    {
+        fputs( pszJSON, stdout );
+        fflush( stdout );
+    }
+    else if( EQUAL(pszOutput, "stderr") )
+    {
+        fputs( pszJSON, stderr );
+        fflush( stderr );
+    }
+    else
+    {
+        VSILFILE* fp = VSIFOpenL( pszOutput, "wb" );
+        if( fp == NULL )
+        {
+            CPLError(CE_Failure, CPLE_OpenFailed,
+                     "Cannot create %s", pszOutput);
+        }
+        else
+        {
+            const size_t nLen = strlen(pszJSON);
+            if( VSIFWriteL( pszJSON, 1, nLen, fp ) != nLen )
+            {
+                CPLError(CE_Failure, CPLE_FileIO,
+                         "Cannot write metrics to %s", pszOutput);
+            }
+            VSIFCloseL( fp );
+        }
+    }
+    CPLFree( pszJSON );
+}
@@ -0,0 +1,108 @@
+/**********************************************************************
+ * $Id$
+ *
+ * Name:     cpl_metrics.h
+ * Project:  CPL - Common Portability Library
+ * Purpose:  Process wide registry of performance counters and histograms.
+ *
+ **********************************************************************
+ * Copyright (c) 2016, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef CPL_METRICS_H_INCLUDED
+#define CPL_METRICS_H_INCLUDED
+
+#include "cpl_port.h"
+
+/**
+ * \file cpl_metrics.h
+ *
+ * Registry of named performance counters and histograms.
+ *
+ * Metrics are registered on first use and are never freed, so the handle
+ * returned by CPLMetricGetCounter() or CPLMetricGetHistogram() remains valid
+ * until the process exits and can be cached by the caller. Updating a counter is a single atomic
+ * addition, and updating a histogram takes a spin lock, so instrumentation
+ * can be left enabled in production builds.
+ *
+ * When the CPL_METRICS_OUTPUT configuration option is set to "stdout",
+ * "stderr" or a filename, the content of the registry is written as JSON
+ * by GDALDestroyDriverManager().
+ *
+ * @since GDAL 2.2
+ */
+
+CPL_C_START
+
+/* Types */
+
+typedef struct _CPLMetric CPLMetric;
+
+/* Functions */
+
+CPLMetric CPL_DLL *CPLMetricGetCounter( const char* pszName );
+CPLMetric CPL_DLL *CPLMetricGetHistogram( const char* pszName );
+
+void      CPL_DLL  CPLMetricAdd( CPLMetric* psMetric, GIntBig nIncrement );
+void      CPL_DLL  CPLMetricRecord( CPLMetric* psMetric, double dfValue );
+
+int       CPL_DLL  CPLMetricGetValue( const char* pszName, GIntBig* pnValue );
+int       CPL_DLL  CPLMetricGetHistogramStats( const char* pszName,
+                                               GIntBig* pnCount,
+                                               double* pdfSum,
+                                               double* pdfMin,
+                                               double* pdfMax );
+char      CPL_DLL **CPLMetricsGetNames( void );
+char      CPL_DLL *CPLMetricsGetAsJSON( void );
+void      CPL_DLL  CPLMetricsReset( void );
+
+GIntBig   CPL_DLL  CPLMetricsGetTimeMicroseconds( void );
+
+void      CPL_DLL  CPLMetricsDumpAtExit( void );
+
+CPL_C_END
+
+/*! @cond Doxygen_Suppress */
+
+/* Convenience macros for instrumentation points with a fixed metric name. */
+/* The handle is looked up once and cached in a function local static. */
+/* Concurrent first calls may both look the metric up, which is harmless */
+/* since they get the same handle. */
+
+#define CPL_METRIC_ADD(pszName, nIncrement) \
+    do { \
+        static CPLMetric* psCachedMetric_ = NULL; \
+        if( psCachedMetric_ == NULL ) \
+            psCachedMetric_ = CPLMetricGetCounter(pszName); \
+        CPLMetricAdd(psCachedMetric_, (nIncrement)); \
+    } while(0)
+
+#define CPL_METRIC_RECORD(pszName, dfValue) \
+    do { \
+        static CPLMetric* psCachedMetric_ = NULL; \
+        if( psCachedMetric_ == NULL ) \
+            psCachedMetric_ = CPLMetricGetHistogram(pszName); \
+        CPLMetricRecord(psCachedMetric_, (dfValue)); \
+    } while(0)
+
+/*! @endcond */
+
+#endif /* CPL_METRICS_H_INCLUDED */
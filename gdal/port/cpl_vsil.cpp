@@ -29,15 +29,156 @@
  * DEALINGS IN THE SOFTWARE.
  ****************************************************************************/
 
+#include "cpl_metrics.h"
 #include "cpl_multiproc.h"
 #include "cpl_string.h"
 #include "cpl_vsi_virtual.h"
 
 #include <cassert>
+#include <map>
 #include <string>
 
 CPL_CVSID("$Id$");
 
+/************************************************************************/
+/*                          VSIHandlerMetrics                           */
+/************************************************************************/
+
+/* I/O counters of a filesystem handler, named after its prefix, for */
+/* example vsi.vsimem.bytes_read. The default handler uses "file". */
+/* They are registered when the first file of the handler is opened with */
+/* VSIFOpenExL(), and updated by VSIFReadL(), VSIFReadMultiRangeL() and */
+/* VSIFWriteL(). */
+typedef struct
+{
+    CPLString    osName;
+    CPLMetric   *psOpenCount;
+    CPLMetric   *psReadCount;
+    CPLMetric   *psBytesRead;
+    CPLMetric   *psWriteCount;
+    CPLMetric   *psBytesWritten;
+} VSIHandlerMetrics;
+
+/* Counters of each handler, and of the handler of each file handle */
+/* opened with VSIFOpenExL(). Kept here so that the layout of the */
+/* exported VSIVirtualHandle and VSIFileManager classes is unchanged. */
+static CPLMutex* hVSIMetricsMutex = NULL;
+static std::map<VSIFilesystemHandler*, VSIHandlerMetrics>*
+                                            poMapHandlerMetrics = NULL;
+static std::map<VSIVirtualHandle*, const VSIHandlerMetrics*>*
+                                            poMapHandleMetrics = NULL;
+
+/************************************************************************/
+/*                       VSIGetHandlerMetrics()                         */
+/************************************************************************/
+
+/* Must be called with hVSIMetricsMutex held */
+static VSIHandlerMetrics& VSIGetHandlerMetrics(
+                                        VSIFilesystemHandler* poHandler )
+{
+    if( poMapHandlerMetrics == NULL )
+        poMapHandlerMetrics =
+            new std::map<VSIFilesystemHandler*, VSIHandlerMetrics>();
+
+    std::map<VSIFilesystemHandler*, VSIHandlerMetrics>::iterator oIter =
+        poMapHandlerMetrics->find(poHandler);
+    if( oIter != poMapHandlerMetrics->end() )
+        return oIter->second;
+
+    VSIHandlerMetrics& sMetrics = (*poMapHandlerMetrics)[poHandler];
+    sMetrics.osName = "vsi.file.";
+    sMetrics.psOpenCount = NULL;
+    sMetrics.psReadCount = NULL;
+    sMetrics.psBytesRead = NULL;
+    sMetrics.psWriteCount = NULL;
+    sMetrics.psBytesWritten = NULL;
+    return sMetrics;
+}
+
+/************************************************************************/
+/*                     VSISetHandlerMetricsName()                       */
+/************************************************************************/
+
+static void VSISetHandlerMetricsName( VSIFilesystemHandler* poHandler,
+                                      const std::string& osPrefix )
+{
+    if( osPrefix.empty() )
+        return;
+
+    CPLMutexHolderD( &hVSIMetricsMutex );
+    VSIHandlerMetrics& sMetrics = VSIGetHandlerMetrics( poHandler );
+    if( sMetrics.psOpenCount != NULL )
+        return;
+    sMetrics.osName = "vsi.";
+    for( size_t i = 0; i < osPrefix.size(); i++ )
+    {
+        if( osPrefix[i] != '/' )
+            sMetrics.osName += osPrefix[i];
+    }
+    sMetrics.osName += ".";
+}
+
+/************************************************************************/
+/*                     VSIRegisterHandleMetrics()                       */
+/************************************************************************/
+
+static void VSIRegisterHandleMetrics( VSIFilesystemHandler* poHandler,
+                                      VSIVirtualHandle* poHandle )
+{
+    CPLMutexHolderD( &hVSIMetricsMutex );
+    VSIHandlerMetrics& sMetrics = VSIGetHandlerMetrics( poHandler );
+    if( sMetrics.psOpenCount == NULL )
+    {
+        const CPLString& osName = sMetrics.osName;
+        sMetrics.psOpenCount =
+            CPLMetricGetCounter( (osName + "open_count").c_str() );
+        sMetrics.psReadCount =
+            CPLMetricGetCounter( (osName + "read_count").c_str() );
+        sMetrics.psBytesRead =
+            CPLMetricGetCounter( (osName + "bytes_read").c_str() );
+        sMetrics.psWriteCount =
+            CPLMetricGetCounter( (osName + "write_count").c_str() );
+        sMetrics.psBytesWritten =
+            CPLMetricGetCounter( (osName + "bytes_written").c_str() );
+    }
+    CPLMetricAdd( sMetrics.psOpenCount, 1 );
+
+    if( poMapHandleMetrics == NULL )
+        poMapHandleMetrics =
+            new std::map<VSIVirtualHandle*, const VSIHandlerMetrics*>();
+    (*poMapHandleMetrics)[poHandle] = &sMetrics;
+}
+
+/************************************************************************/
+/*                    VSIUnregisterHandleMetrics()                      */
+/************************************************************************/
+
+static void VSIUnregisterHandleMetrics( VSIVirtualHandle* poHandle )
+{
+    CPLMutexHolderD( &hVSIMetricsMutex );
+    if( poMapHandleMetrics != NULL )
+        poMapHandleMetrics->erase(poHandle);
+}
+
+/************************************************************************/
+/*                        VSIGetHandleMetrics()                         */
+/************************************************************************/
+
+/* Return the counters of a file handle, or NULL if it was not opened */
+/* with VSIFOpenExL() */
+static const VSIHandlerMetrics* VSIGetHandleMetrics(
+                                            VSIVirtualHandle* poHandle )
+{
+    CPLMutexHolderD( &hVSIMetricsMutex );
+    if( poMapHandleMetrics == NULL )
+        return NULL;
+    std::map<VSIVirtualHandle*, const VSIHandlerMetrics*>::const_iterator
+        oIter = poMapHandleMetrics->find(poHandle);
+    if( oIter == poMapHandleMetrics->end() )
+        return NULL;
+    return oIter->second;
+}
+
 /************************************************************************/
 /*                             VSIReadDir()                             */
 /************************************************************************/
@@ -597,8 +738,12 @@ VSILFILE *VSIFOpenExL( const char * pszFilename, const char * pszAccess, int bSe
     VSIFilesystemHandler *poFSHandler =
         VSIFileManager::GetHandler( pszFilename );
 
-    VSILFILE* fp = reinterpret_cast<VSILFILE *>(
-        poFSHandler->Open( pszFilename, pszAccess, CPL_TO_BOOL(bSetError) ) );
+    VSIVirtualHandle* poHandle =
+        poFSHandler->Open( pszFilename, pszAccess, CPL_TO_BOOL(bSetError) );
+    if( poHandle != NULL )
+        VSIRegisterHandleMetrics( poFSHandler, poHandle );
+
+    VSILFILE* fp = reinterpret_cast<VSILFILE *>( poHandle );
 
     VSIDebug4( "VSIFOpenExL(%s,%s,%d) = %p", pszFilename, pszAccess, bSetError, fp );
 
@@ -634,6 +779,7 @@ int VSIFCloseL( VSILFILE * fp )
 
     const int nResult = poFileHandle->Close();
 
+    VSIUnregisterHandleMetrics( poFileHandle );
     delete poFileHandle;
 
     return nResult;
@@ -773,7 +919,17 @@ size_t VSIFReadL( void * pBuffer, size_t nSize, size_t nCount, VSILFILE * fp )
 {
     VSIVirtualHandle *poFileHandle = reinterpret_cast<VSIVirtualHandle *>( fp );
 
-    return poFileHandle->Read( pBuffer, nSize, nCount );
+    const size_t nRet = poFileHandle->Read( pBuffer, nSize, nCount );
+
+    const VSIHandlerMetrics* psMetrics = VSIGetHandleMetrics( poFileHandle );
+    if( psMetrics != NULL )
+    {
+        CPLMetricAdd( psMetrics->psReadCount, 1 );
+        CPLMetricAdd( psMetrics->psBytesRead,
+                      static_cast<GIntBig>(nRet * nSize) );
+    }
+
+    return nRet;
 }
 
 
@@ -810,7 +966,20 @@ int VSIFReadMultiRangeL( int nRanges, void ** ppData,
 {
     VSIVirtualHandle *poFileHandle = (VSIVirtualHandle *) fp;
 
-    return poFileHandle->ReadMultiRange( nRanges, ppData, panOffsets, panSizes );
+    const int nRet =
+        poFileHandle->ReadMultiRange( nRanges, ppData, panOffsets, panSizes );
+
+    const VSIHandlerMetrics* psMetrics = VSIGetHandleMetrics( poFileHandle );
+    if( psMetrics != NULL && nRet == 0 )
+    {
+        GIntBig nBytes = 0;
+        for( int i = 0; i < nRanges; i++ )
+            nBytes += static_cast<GIntBig>(panSizes[i]);
+        CPLMetricAdd( psMetrics->psReadCount, 1 );
+        CPLMetricAdd( psMetrics->psBytesRead, nBytes );
+    }
+
+    return nRet;
 }
 
 /************************************************************************/
@@ -842,7 +1011,17 @@ size_t VSIFWriteL( const void *pBuffer, size_t nSize, size_t nCount, VSILFILE *f
 {
     VSIVirtualHandle *poFileHandle = reinterpret_cast<VSIVirtualHandle *>( fp );
 
-    return poFileHandle->Write( pBuffer, nSize, nCount );
+    const size_t nRet = poFileHandle->Write( pBuffer, nSize, nCount );
+
+    const VSIHandlerMetrics* psMetrics = VSIGetHandleMetrics( poFileHandle );
+    if( psMetrics != NULL )
+    {
+        CPLMetricAdd( psMetrics->psWriteCount, 1 );
+        CPLMetricAdd( psMetrics->psBytesWritten,
+                      static_cast<GIntBig>(nRet * nSize) );
+    }
+
+    return nRet;
 }
 
 /************************************************************************/
@@ -1352,6 +1531,8 @@ void VSIFileManager::InstallHandler( const std::string& osPrefix,
         Get()->poDefaultHandler = poHandler;
     else
         Get()->oHandlers[osPrefix] = poHandler;
+
+    VSISetHandlerMetricsName( poHandler, osPrefix );
 }
 
 /************************************************************************/
@@ -1372,6 +1553,16 @@ void VSICleanupFileManager()
         CPLDestroyMutex(hVSIFileManagerMutex);
         hVSIFileManagerMutex = NULL;
     }
+
+    delete poMapHandleMetrics;
+    poMapHandleMetrics = NULL;
+    delete poMapHandlerMetrics;
+    poMapHandlerMetrics = NULL;
+    if( hVSIMetricsMutex != NULL )
+    {
+        CPLDestroyMutex(hVSIMetricsMutex);
+        hVSIMetricsMutex = NULL;
+    }
 }
 
 /************************************************************************/
@@ -28,6 +28,7 @@
  ****************************************************************************/
 
 #include "cpl_vsi_virtual.h"
+#include "cpl_metrics.h"
 #include "cpl_string.h"
 #include "cpl_multiproc.h"
 #include "cpl_hash_set.h"
@@ -79,6 +80,44 @@ int VSICurlUninstallReadCbk(CPL_UNUSED VSILFILE* fp)
 void CPLHTTPSetOptions(CURL *http_handle, char** papszOptions);
 void VSICurlSetOptions(CURL* hCurlHandle, const char* pszURL);
 
+/************************************************************************/
+/*                         VSICurlEasyPerform()                         */
+/************************************************************************/
+
+/* curl_easy_perform() wrapper maintaining the vsicurl.* metrics */
+static CURLcode VSICurlEasyPerform( CURL* hCurlHandle )
+{
+    const GIntBig nStartTime = CPLMetricsGetTimeMicroseconds();
+    const CURLcode eRet = curl_easy_perform(hCurlHandle);
+    CPL_METRIC_RECORD("vsicurl.request_time_us",
+        static_cast<double>(CPLMetricsGetTimeMicroseconds() - nStartTime));
+    CPL_METRIC_ADD("vsicurl.requests", 1);
+    if( eRet != CURLE_OK )
+        CPL_METRIC_ADD("vsicurl.errors", 1);
+
+#if LIBCURL_VERSION_NUM >= 0x073700
+    /* CURLINFO_SIZE_DOWNLOAD/UPLOAD are deprecated since 7.55.0 */
+    curl_off_t nSize = 0;
+    if( curl_easy_getinfo(hCurlHandle, CURLINFO_SIZE_DOWNLOAD_T,
+                          &nSize) == CURLE_OK )
+        CPL_METRIC_ADD("vsicurl.bytes_downloaded", static_cast<GIntBig>(nSize));
+    nSize = 0;
+    if( curl_easy_getinfo(hCurlHandle, CURLINFO_SIZE_UPLOAD_T,
+                          &nSize) == CURLE_OK && nSize > 0 )
+        CPL_METRIC_ADD("vsicurl.bytes_uploaded", static_cast<GIntBig>(nSize));
+#else
+    double dfSize = 0.0;
+    if( curl_easy_getinfo(hCurlHandle, CURLINFO_SIZE_DOWNLOAD,
+                          &dfSize) == CURLE_OK )
+        CPL_METRIC_ADD("vsicurl.bytes_downloaded", static_cast<GIntBig>(dfSize));
+    dfSize = 0.0;
+    if( curl_easy_getinfo(hCurlHandle, CURLINFO_SIZE_UPLOAD,
+                          &dfSize) == CURLE_OK && dfSize > 0 )
+        CPL_METRIC_ADD("vsicurl.bytes_uploaded", static_cast<GIntBig>(dfSize));
+#endif
+    return eRet;
+}
+
 #include <map>
 
 #define ENABLE_DEBUG 1
@@ -741,7 +780,7 @@ vsi_l_offset VSICurlHandle::GetFileSize(bool bSetError)
     if( headers != NULL )
         curl_easy_setopt(hCurlHandle, CURLOPT_HTTPHEADER, headers);
 
-    curl_easy_perform(hCurlHandle);
+    VSICurlEasyPerform(hCurlHandle);
 
     if( headers != NULL )
         curl_slist_free_all(headers);
@@ -937,7 +976,7 @@ bool VSICurlHandle::DownloadRegion(vsi_l_offset startOffset, int nBlocks)
     if( headers != NULL )
         curl_easy_setopt(hCurlHandle, CURLOPT_HTTPHEADER, headers);
 
-    curl_easy_perform(hCurlHandle);
+    VSICurlEasyPerform(hCurlHandle);
 
     if( headers != NULL )
         curl_slist_free_all(headers);
@@ -1269,7 +1308,7 @@ int VSICurlHandle::ReadMultiRange( int const nRanges, void ** const ppData,
     if( headers != NULL )
         curl_easy_setopt(hCurlHandle, CURLOPT_HTTPHEADER, headers);
 
-    curl_easy_perform(hCurlHandle);
+    VSICurlEasyPerform(hCurlHandle);
 
     if( headers != NULL )
         curl_slist_free_all(headers);
@@ -2615,7 +2654,7 @@ char** VSICurlFilesystemHandler::GetFileList(const char *pszDirname,
             szCurlErrBuf[0] = '\0';
             curl_easy_setopt(hCurlHandle, CURLOPT_ERRORBUFFER, szCurlErrBuf );
 
-            curl_easy_perform(hCurlHandle);
+            VSICurlEasyPerform(hCurlHandle);
 
             if (sWriteFuncData.pBuffer == NULL)
                 return NULL;
@@ -2756,7 +2795,7 @@ char** VSICurlFilesystemHandler::GetFileList(const char *pszDirname,
         szCurlErrBuf[0] = '\0';
         curl_easy_setopt(hCurlHandle, CURLOPT_ERRORBUFFER, szCurlErrBuf );
 
-        curl_easy_perform(hCurlHandle);
+        VSICurlEasyPerform(hCurlHandle);
 
         if (sWriteFuncData.pBuffer == NULL)
             return NULL;
@@ -3256,7 +3295,7 @@ bool VSIS3WriteHandle::InitiateMultipartUpload()
         curl_easy_setopt(hCurlHandle, CURLOPT_WRITEDATA, &sWriteFuncData);
         curl_easy_setopt(hCurlHandle, CURLOPT_WRITEFUNCTION, VSICurlHandleWriteFunc);
 
-        curl_easy_perform(hCurlHandle);
+        VSICurlEasyPerform(hCurlHandle);
 
         curl_slist_free_all(headers);
 
@@ -3369,7 +3408,7 @@ bool VSIS3WriteHandle::UploadPart()
     curl_easy_setopt(hCurlHandle, CURLOPT_HEADERDATA, &sWriteFuncHeaderData);
     curl_easy_setopt(hCurlHandle, CURLOPT_HEADERFUNCTION, VSICurlHandleWriteFunc);
 
-    curl_easy_perform(hCurlHandle);
+    VSICurlEasyPerform(hCurlHandle);
 
     curl_slist_free_all(headers);
 
@@ -3488,7 +3527,7 @@ bool VSIS3WriteHandle::DoSinglePartPUT()
         curl_easy_setopt(hCurlHandle, CURLOPT_WRITEDATA, &sWriteFuncData);
         curl_easy_setopt(hCurlHandle, CURLOPT_WRITEFUNCTION, VSICurlHandleWriteFunc);
 
-        curl_easy_perform(hCurlHandle);
+        VSICurlEasyPerform(hCurlHandle);
 
         curl_slist_free_all(headers);
 
@@ -3580,7 +3619,7 @@ bool VSIS3WriteHandle::CompleteMultipart()
     curl_easy_setopt(hCurlHandle, CURLOPT_WRITEDATA, &sWriteFuncData);
     curl_easy_setopt(hCurlHandle, CURLOPT_WRITEFUNCTION, VSICurlHandleWriteFunc);
 
-    curl_easy_perform(hCurlHandle);
+    VSICurlEasyPerform(hCurlHandle);
 
     curl_slist_free_all(headers);
 
@@ -3625,7 +3664,7 @@ bool VSIS3WriteHandle::AbortMultipart()
     curl_easy_setopt(hCurlHandle, CURLOPT_WRITEDATA, &sWriteFuncData);
     curl_easy_setopt(hCurlHandle, CURLOPT_WRITEFUNCTION, VSICurlHandleWriteFunc);
 
-    curl_easy_perform(hCurlHandle);
+    VSICurlEasyPerform(hCurlHandle);
 
     curl_slist_free_all(headers);
 
@@ -3799,7 +3838,7 @@ int VSIS3FSHandler::Unlink( const char *pszFilename )
         curl_easy_setopt(hCurlHandle, CURLOPT_WRITEDATA, &sWriteFuncData);
         curl_easy_setopt(hCurlHandle, CURLOPT_WRITEFUNCTION, VSICurlHandleWriteFunc);
 
-        curl_easy_perform(hCurlHandle);
+        VSICurlEasyPerform(hCurlHandle);
 
         curl_slist_free_all(headers);
 
@@ -3907,7 +3946,7 @@ char** VSIS3FSHandler::GetFileList( const char *pszDirname,
         if( headers != NULL )
             curl_easy_setopt(hCurlHandle, CURLOPT_HTTPHEADER, headers);
 
-        curl_easy_perform(hCurlHandle);
+        VSICurlEasyPerform(hCurlHandle);
 
         if( headers != NULL )
             curl_slist_free_all(headers);
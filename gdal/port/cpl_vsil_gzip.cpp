@@ -70,6 +70,13 @@
    a .gz.properties file, so that we don't need to seek at the end of the file
    each time a Stat() is done.
 
+   For .gz files, a persistent index of access points can also be stored in a
+   .gz.idx file. Each access point records the state needed to resume inflating
+   in the middle of the stream (the last 32 KB of uncompressed data and the bit
+   position), as done in zlib's examples/zran.c. With such an index, seeking
+   only inflates from the nearest access point, and large reads can inflate
+   the ranges between access points concurrently.
+
    For .zip and .gz, both reading and writing are supported, but just one mode at a time
    (read-only or write-only)
 */
@@ -78,7 +85,11 @@
 #include "cpl_vsi_virtual.h"
 #include "cpl_string.h"
 #include "cpl_multiproc.h"
+#include "cpl_atomic_ops.h"
+#include "cpl_worker_thread_pool.h"
 #include <map>
+#include <new>
+#include <vector>
 
 #include <zlib.h>
 #include "cpl_minizip_unzip.h"
@@ -105,6 +116,364 @@ static int const gz_magic[2] = {0x1f, 0x8b}; /* gzip magic header */
 
 #define ENABLE_DEBUG 0
 
+#define GZIP_WINDOW_SIZE 32768      /* size of the deflate dictionary */
+#define GZIP_INDEX_SPAN  1048576    /* uncompressed bytes between access points */
+
+static const char szGZipIndexSignature[8] = { 'G','Z','I','D','X','1',0,0 };
+
+/************************************************************************/
+/*                          GetGZipNumThreads()                         */
+/************************************************************************/
+
+static int GetGZipNumThreads()
+{
+    const char* pszThreads = CPLGetConfigOption("GDAL_NUM_THREADS", "1");
+    int nThreads = EQUAL(pszThreads, "ALL_CPUS") ?
+        CPLGetNumCPUs() : atoi(pszThreads);
+    return MAX(1, MIN(128, nThreads));
+}
+
+/************************************************************************/
+/* ==================================================================== */
+/*                            VSIGZipIndex                              */
+/* ==================================================================== */
+/************************************************************************/
+
+typedef struct
+{
+    vsi_l_offset  nCompressedPos;   /* offset in the file of the next byte to inflate */
+    vsi_l_offset  nUncompressedPos;
+    uLong         nCRC;             /* crc32 of the current member up to that point */
+    int           nBits;            /* bits of the previous byte not yet consumed */
+    GByte        *pabyWindow;       /* last 32 KB of output, NULL at member starts */
+} VSIGZipCheckpoint;
+
+class VSIGZipIndex
+{
+    volatile int  nRefCount;
+
+                  ~VSIGZipIndex();
+
+  public:
+    vsi_l_offset  nCompressedSize;
+    vsi_l_offset  nUncompressedSize;
+    std::vector<VSIGZipCheckpoint> asCheckpoints;
+
+                  VSIGZipIndex();
+
+    void          Reference() { CPLAtomicInc(&nRefCount); }
+    void          Release() { if( CPLAtomicDec(&nRefCount) == 0 ) delete this; }
+
+    int           FindCheckpoint( vsi_l_offset nUncompressedPos ) const;
+    void          AddCheckpoint( vsi_l_offset nCompressedPos,
+                                 vsi_l_offset nUncompressedPos,
+                                 uLong nCRC, int nBits,
+                                 const GByte* pabyWindow, size_t nWindowPos );
+
+    bool          Save( const char* pszFilename ) const;
+    static VSIGZipIndex* Load( const char* pszFilename,
+                               vsi_l_offset nCompressedSize );
+};
+
+/************************************************************************/
+/*                            VSIGZipIndex()                            */
+/************************************************************************/
+
+VSIGZipIndex::VSIGZipIndex() :
+    nRefCount(1),
+    nCompressedSize(0),
+    nUncompressedSize(0)
+{
+}
+
+/************************************************************************/
+/*                           ~VSIGZipIndex()                            */
+/************************************************************************/
+
+VSIGZipIndex::~VSIGZipIndex()
+{
+    for( size_t i = 0; i < asCheckpoints.size(); i++ )
+        CPLFree(asCheckpoints[i].pabyWindow);
+}
+
+/************************************************************************/
+/*                           FindCheckpoint()                           */
+/*                                                                      */
+/*      Return the last access point at or before nUncompressedPos,     */
+/*      or -1.                                                          */
+/************************************************************************/
+
+int VSIGZipIndex::FindCheckpoint( vsi_l_offset nUncompressedPos ) const
+{
+    int nLow = 0;
+    int nHigh = static_cast<int>(asCheckpoints.size()) - 1;
+    int nFound = -1;
+    while( nLow <= nHigh )
+    {
+        const int nMid = (nLow + nHigh) / 2;
+        if( asCheckpoints[nMid].nUncompressedPos <= nUncompressedPos )
+        {
+            nFound = nMid;
+            nLow = nMid + 1;
+        }
+        else
+            nHigh = nMid - 1;
+    }
+    return nFound;
+}
+
+/************************************************************************/
+/*                           AddCheckpoint()                            */
+/*                                                                      */
+/*      pabyWindow is a circular buffer of GZIP_WINDOW_SIZE bytes       */
+/*      whose oldest byte is at nWindowPos.                             */
+/************************************************************************/
+
+void VSIGZipIndex::AddCheckpoint( vsi_l_offset nCompressedPos,
+                                  vsi_l_offset nUncompressedPos,
+                                  uLong nCRC, int nBits,
+                                  const GByte* pabyWindow, size_t nWindowPos )
+{
+    VSIGZipCheckpoint sCheckpoint;
+    sCheckpoint.nCompressedPos = nCompressedPos;
+    sCheckpoint.nUncompressedPos = nUncompressedPos;
+    sCheckpoint.nCRC = nCRC;
+    sCheckpoint.nBits = nBits;
+    sCheckpoint.pabyWindow = NULL;
+    if( pabyWindow != NULL )
+    {
+        sCheckpoint.pabyWindow = (GByte*) CPLMalloc(GZIP_WINDOW_SIZE);
+        memcpy( sCheckpoint.pabyWindow, pabyWindow + nWindowPos,
+                GZIP_WINDOW_SIZE - nWindowPos );
+        memcpy( sCheckpoint.pabyWindow + GZIP_WINDOW_SIZE - nWindowPos,
+                pabyWindow, nWindowPos );
+    }
+    asCheckpoints.push_back(sCheckpoint);
+}
+
+/************************************************************************/
+/*                                Save()                                */
+/*                                                                      */
+/*      The .gz.idx file is made of the 8 byte signature, the           */
+/*      compressed and uncompressed sizes, the number of access         */
+/*      points, and for each of them its compressed and uncompressed    */
+/*      positions, crc, number of bits, a flag set if the window        */
+/*      follows, and the window.  All values are little endian.         */
+/************************************************************************/
+
+bool VSIGZipIndex::Save( const char* pszFilename ) const
+{
+    VSILFILE* fp = VSIFOpenL(pszFilename, "wb");
+    if( fp == NULL )
+        return false;
+
+    bool bOK = VSIFWriteL(szGZipIndexSignature, 8, 1, fp) == 1;
+
+    GUIntBig anSizes[2] = { nCompressedSize, nUncompressedSize };
+    CPL_LSBPTR64(&anSizes[0]);
+    CPL_LSBPTR64(&anSizes[1]);
+    GUInt32 nCount = static_cast<GUInt32>(asCheckpoints.size());
+    CPL_LSBPTR32(&nCount);
+    bOK &= VSIFWriteL(anSizes, 8, 2, fp) == 2;
+    bOK &= VSIFWriteL(&nCount, 4, 1, fp) == 1;
+
+    for( size_t i = 0; bOK && i < asCheckpoints.size(); i++ )
+    {
+        const VSIGZipCheckpoint& sCheckpoint = asCheckpoints[i];
+        GByte abyRecord[22];
+        GUIntBig nVal = sCheckpoint.nCompressedPos;
+        CPL_LSBPTR64(&nVal);
+        memcpy(abyRecord, &nVal, 8);
+        nVal = sCheckpoint.nUncompressedPos;
+        CPL_LSBPTR64(&nVal);
+        memcpy(abyRecord + 8, &nVal, 8);
+        GUInt32 nCRC = static_cast<GUInt32>(sCheckpoint.nCRC);
+        CPL_LSBPTR32(&nCRC);
+        memcpy(abyRecord + 16, &nCRC, 4);
+        abyRecord[20] = static_cast<GByte>(sCheckpoint.nBits);
+        abyRecord[21] = sCheckpoint.pabyWindow != NULL ? 1 : 0;
+        bOK = VSIFWriteL(abyRecord, sizeof(abyRecord), 1, fp) == 1;
+        if( bOK && sCheckpoint.pabyWindow != NULL )
+            bOK = VSIFWriteL(sCheckpoint.pabyWindow, GZIP_WINDOW_SIZE, 1, fp) == 1;
+    }
+
+    if( VSIFCloseL(fp) != 0 )
+        bOK = false;
+    if( !bOK )
+        VSIUnlink(pszFilename);
+    return bOK;
+}
+
+/************************************************************************/
+/*                                Load()                                */
+/************************************************************************/
+
+VSIGZipIndex* VSIGZipIndex::Load( const char* pszFilename,
+                                  vsi_l_offset nCompressedSize )
+{
+    VSILFILE* fp = VSIFOpenL(pszFilename, "rb");
+    if( fp == NULL )
+        return NULL;
+
+    char szSignature[8];
+    GUIntBig anSizes[2];
+    GUInt32 nCount = 0;
+    if( VSIFReadL(szSignature, 8, 1, fp) != 1 ||
+        memcmp(szSignature, szGZipIndexSignature, 8) != 0 ||
+        VSIFReadL(anSizes, 8, 2, fp) != 2 ||
+        VSIFReadL(&nCount, 4, 1, fp) != 1 )
+    {
+        CPL_IGNORE_RET_VAL(VSIFCloseL(fp));
+        return NULL;
+    }
+    CPL_LSBPTR64(&anSizes[0]);
+    CPL_LSBPTR64(&anSizes[1]);
+    CPL_LSBPTR32(&nCount);
+
+    /* The index is stale if the .gz file has changed */
+    if( anSizes[0] != nCompressedSize )
+    {
+        CPLDebug("GZIP", "Ignoring %s: compressed size does not match",
+                 pszFilename);
+        CPL_IGNORE_RET_VAL(VSIFCloseL(fp));
+        return NULL;
+    }
+
+    VSIGZipIndex* poIndex = new VSIGZipIndex();
+    poIndex->nCompressedSize = anSizes[0];
+    poIndex->nUncompressedSize = anSizes[1];
+
+    bool bOK = true;
+    for( GUInt32 i = 0; bOK && i < nCount; i++ )
+    {
+        GByte abyRecord[22];
+        if( VSIFReadL(abyRecord, sizeof(abyRecord), 1, fp) != 1 )
+        {
+            bOK = false;
+            break;
+        }
+        VSIGZipCheckpoint sCheckpoint;
+        GUIntBig nVal;
+        memcpy(&nVal, abyRecord, 8);
+        CPL_LSBPTR64(&nVal);
+        sCheckpoint.nCompressedPos = nVal;
+        memcpy(&nVal, abyRecord + 8, 8);
+        CPL_LSBPTR64(&nVal);
+        sCheckpoint.nUncompressedPos = nVal;
+        GUInt32 nCRC;
+        memcpy(&nCRC, abyRecord + 16, 4);
+        CPL_LSBPTR32(&nCRC);
+        sCheckpoint.nCRC = nCRC;
+        sCheckpoint.nBits = abyRecord[20];
+        sCheckpoint.pabyWindow = NULL;
+
+        if( sCheckpoint.nBits > 7 ||
+            sCheckpoint.nCompressedPos > nCompressedSize ||
+            sCheckpoint.nUncompressedPos > poIndex->nUncompressedSize ||
+            (i > 0 && sCheckpoint.nUncompressedPos <
+                poIndex->asCheckpoints.back().nUncompressedPos) )
+        {
+            bOK = false;
+            break;
+        }
+
+        if( abyRecord[21] )
+        {
+            sCheckpoint.pabyWindow =
+                (GByte*) VSI_MALLOC_VERBOSE(GZIP_WINDOW_SIZE);
+            if( sCheckpoint.pabyWindow == NULL ||
+                VSIFReadL(sCheckpoint.pabyWindow, GZIP_WINDOW_SIZE, 1, fp) != 1 )
+            {
+                CPLFree(sCheckpoint.pabyWindow);
+                bOK = false;
+                break;
+            }
+        }
+        poIndex->asCheckpoints.push_back(sCheckpoint);
+    }
+    CPL_IGNORE_RET_VAL(VSIFCloseL(fp));
+
+    if( !bOK )
+    {
+        CPLDebug("GZIP", "Ignoring corrupted %s", pszFilename);
+        poIndex->Release();
+        return NULL;
+    }
+    return poIndex;
+}
+
+/************************************************************************/
+/*                        VSIGZipInflateRange()                         */
+/*                                                                      */
+/*      Job inflating the data between two access points from the       */
+/*      compressed bytes already read in memory.                        */
+/************************************************************************/
+
+typedef struct
+{
+    const GByte  *pabyIn;
+    size_t        nInSize;
+    const VSIGZipCheckpoint *psStart;
+    const VSIGZipCheckpoint *psEnd;
+    GByte        *pabyOut;
+    size_t        nOutSize;
+    bool          bOK;
+} VSIGZipInflateRangeJob;
+
+static void VSIGZipInflateRange( void* pData )
+{
+    VSIGZipInflateRangeJob* psJob = (VSIGZipInflateRangeJob*) pData;
+    psJob->bOK = false;
+
+    z_stream sStream;
+    memset(&sStream, 0, sizeof(sStream));
+    if( inflateInit2(&sStream, -MAX_WBITS) != Z_OK )
+        return;
+
+    sStream.next_in = (Bytef*) psJob->pabyIn;
+    sStream.avail_in = (uInt) psJob->nInSize;
+    const int nBits = psJob->psStart->nBits;
+    if( nBits && sStream.avail_in > 0 )
+    {
+        inflatePrime(&sStream, nBits, sStream.next_in[0] >> (8 - nBits));
+        sStream.next_in ++;
+        sStream.avail_in --;
+    }
+    if( psJob->psStart->pabyWindow != NULL )
+        inflateSetDictionary(&sStream, psJob->psStart->pabyWindow,
+                             GZIP_WINDOW_SIZE);
+
+    sStream.next_out = psJob->pabyOut;
+    sStream.avail_out = (uInt) psJob->nOutSize;
+    int nRet = Z_OK;
+    while( sStream.avail_out > 0 && nRet == Z_OK )
+        nRet = inflate(&sStream, Z_NO_FLUSH);
+
+    if( sStream.avail_out == 0 )
+    {
+        const uLong nCRC = crc32(psJob->psStart->nCRC, psJob->pabyOut,
+                                 (uInt) psJob->nOutSize);
+        if( psJob->psEnd->pabyWindow == NULL )
+        {
+            /* The next access point starts a new member: check the */
+            /* trailer of this one */
+            if( nRet != Z_STREAM_END )
+                nRet = inflate(&sStream, Z_NO_FLUSH);
+            if( nRet == Z_STREAM_END && sStream.avail_in >= 4 )
+            {
+                const GByte* p = sStream.next_in;
+                const uLong nExpected = p[0] | (p[1] << 8) | (p[2] << 16) |
+                                        ((uLong)p[3] << 24);
+                psJob->bOK = nCRC == nExpected;
+            }
+        }
+        else
+            psJob->bOK = nCRC == psJob->psEnd->nCRC;
+    }
+
+    inflateEnd(&sStream);
+}
+
 /************************************************************************/
 /* ==================================================================== */
 /*                       VSIGZipHandle                                  */
@@ -148,12 +517,26 @@ class VSIGZipHandle CPL_FINAL : public VSIVirtualHandle
     GZipSnapshot* snapshots;
     vsi_l_offset snapshot_byte_interval; /* number of compressed bytes at which we create a "snapshot" */
 
+    VSIGZipIndex* m_poIndex;         /* persistent access points, optional */
+    VSIGZipIndex* m_poIndexBuilding; /* access points collected while inflating the whole stream */
+    GByte*        m_pabyWindow;      /* last 32 KB of output while building the index */
+    size_t        m_nWindowPos;
+    CPLWorkerThreadPool* m_poThreadPool;
+
     void check_header();
     int get_byte();
     int gzseek( vsi_l_offset nOffset, int nWhence );
     int gzrewind ();
+    size_t gzread( void *pBuffer, size_t nLen );
     uLong getLong ();
 
+    bool   RestoreCheckpoint( const VSIGZipCheckpoint& sCheckpoint );
+    size_t ReadFromCheckpoints( void *pBuffer, size_t nLen );
+    bool   WantIndex();
+    void   StartIndex();
+    void   UpdateIndex( const Bytef* pabyOut, size_t nOut );
+    void   FinishIndex( bool bComplete );
+
   public:
 
     VSIGZipHandle(VSIVirtualHandle* poBaseHandle,
@@ -184,6 +567,9 @@ class VSIGZipHandle CPL_FINAL : public VSIVirtualHandle
     void              SetUncompressedSize(vsi_l_offset nUncompressedSize) { m_uncompressed_size = nUncompressedSize; }
     vsi_l_offset      GetUncompressedSize() { return m_uncompressed_size; }
 
+    void              SetIndex( VSIGZipIndex* poIndex );
+    void              LoadIndex();
+
     void              SaveInfo_unlocked();
 };
 
@@ -247,6 +633,8 @@ VSIGZipHandle* VSIGZipHandle::Duplicate()
     }
 
     poHandle->m_nLastReadOffset = m_nLastReadOffset;
+    if( m_poIndex != NULL )
+        poHandle->SetIndex(m_poIndex);
 
     /* Most important : duplicate the snapshots ! */
 
@@ -290,7 +678,12 @@ VSIGZipHandle::VSIGZipHandle(VSIVirtualHandle* poBaseHandle,
                              vsi_l_offset uncompressed_size,
                              uLong expected_crc,
                              int transparent) :
-    snapshot_byte_interval(0)
+    snapshot_byte_interval(0),
+    m_poIndex(NULL),
+    m_poIndexBuilding(NULL),
+    m_pabyWindow(NULL),
+    m_nWindowPos(0),
+    m_poThreadPool(NULL)
 {
     m_poBaseHandle = poBaseHandle;
     m_expected_crc = expected_crc;
@@ -405,10 +798,300 @@ VSIGZipHandle::~VSIGZipHandle()
     }
     CPLFree(m_pszBaseFileName);
 
+    if( m_poIndex != NULL )
+        m_poIndex->Release();
+    if( m_poIndexBuilding != NULL )
+        m_poIndexBuilding->Release();
+    CPLFree(m_pabyWindow);
+    delete m_poThreadPool;
+
     if (m_poBaseHandle)
         CPL_IGNORE_RET_VAL(VSIFCloseL((VSILFILE*)m_poBaseHandle));
 }
 
+/************************************************************************/
+/*                              SetIndex()                              */
+/************************************************************************/
+
+void VSIGZipHandle::SetIndex( VSIGZipIndex* poIndex )
+{
+    poIndex->Reference();
+    if( m_poIndex != NULL )
+        m_poIndex->Release();
+    m_poIndex = poIndex;
+    if( m_uncompressed_size == 0 )
+        m_uncompressed_size = poIndex->nUncompressedSize;
+}
+
+/************************************************************************/
+/*                             LoadIndex()                              */
+/************************************************************************/
+
+void VSIGZipHandle::LoadIndex()
+{
+    if( m_pszBaseFileName == NULL || m_transparent )
+        return;
+
+    CPLString osIndexFilename(m_pszBaseFileName);
+    osIndexFilename += ".idx";
+    VSIGZipIndex* poIndex =
+        VSIGZipIndex::Load(osIndexFilename, m_offset + m_compressed_size);
+    if( poIndex != NULL )
+    {
+        SetIndex(poIndex);
+        poIndex->Release();
+    }
+}
+
+/************************************************************************/
+/*                             WantIndex()                              */
+/************************************************************************/
+
+bool VSIGZipHandle::WantIndex()
+{
+    return m_poIndex == NULL && m_poIndexBuilding == NULL &&
+           m_pszBaseFileName != NULL && m_expected_crc == 0 &&
+           CPLTestBool(CPLGetConfigOption("CPL_VSIL_GZIP_WRITE_INDEX", "NO"));
+}
+
+/************************************************************************/
+/*                             StartIndex()                             */
+/*                                                                      */
+/*      Start collecting access points.  The stream must be at its      */
+/*      beginning.                                                      */
+/************************************************************************/
+
+void VSIGZipHandle::StartIndex()
+{
+    CPLAssert( out == 0 );
+    m_poIndexBuilding = new VSIGZipIndex();
+    m_poIndexBuilding->nCompressedSize = m_offset + m_compressed_size;
+    m_pabyWindow = (GByte*) CPLCalloc(1, GZIP_WINDOW_SIZE);
+    m_nWindowPos = 0;
+    m_poIndexBuilding->AddCheckpoint( startOff, 0, crc32(0L, NULL, 0), 0,
+                                      NULL, 0 );
+}
+
+/************************************************************************/
+/*                            UpdateIndex()                             */
+/*                                                                      */
+/*      Called after each inflate() call while building the index,      */
+/*      with the bytes just output.                                     */
+/************************************************************************/
+
+void VSIGZipHandle::UpdateIndex( const Bytef* pabyOut, size_t nOut )
+{
+    /* Keep the last 32 KB of output */
+    if( nOut >= GZIP_WINDOW_SIZE )
+    {
+        memcpy( m_pabyWindow, pabyOut + nOut - GZIP_WINDOW_SIZE,
+                GZIP_WINDOW_SIZE );
+        m_nWindowPos = 0;
+    }
+    else
+    {
+        const size_t nFirst = MIN(nOut, GZIP_WINDOW_SIZE - m_nWindowPos);
+        memcpy( m_pabyWindow + m_nWindowPos, pabyOut, nFirst );
+        memcpy( m_pabyWindow, pabyOut + nFirst, nOut - nFirst );
+        m_nWindowPos = (m_nWindowPos + nOut) % GZIP_WINDOW_SIZE;
+    }
+
+    /* Add an access point at the end of a deflate block, except the */
+    /* last one of a member, at most every GZIP_INDEX_SPAN bytes */
+    if( (stream.data_type & 128) && !(stream.data_type & 64) &&
+        out - m_poIndexBuilding->asCheckpoints.back().nUncompressedPos
+            >= GZIP_INDEX_SPAN )
+    {
+        m_poIndexBuilding->AddCheckpoint(
+            VSIFTellL((VSILFILE*)m_poBaseHandle) - stream.avail_in,
+            out, crc, stream.data_type & 7, m_pabyWindow, m_nWindowPos );
+    }
+}
+
+/************************************************************************/
+/*                            FinishIndex()                             */
+/************************************************************************/
+
+void VSIGZipHandle::FinishIndex( bool bComplete )
+{
+    CPLFree(m_pabyWindow);
+    m_pabyWindow = NULL;
+
+    VSIGZipIndex* poIndex = m_poIndexBuilding;
+    m_poIndexBuilding = NULL;
+    if( !bComplete )
+    {
+        poIndex->Release();
+        return;
+    }
+
+    poIndex->nUncompressedSize = out;
+    SetIndex(poIndex);
+    poIndex->Release();
+
+    CPLString osIndexFilename(m_pszBaseFileName);
+    osIndexFilename += ".idx";
+    if( !m_poIndex->Save(osIndexFilename) )
+        CPLDebug("GZIP", "Cannot write %s", osIndexFilename.c_str());
+}
+
+/************************************************************************/
+/*                         RestoreCheckpoint()                          */
+/************************************************************************/
+
+bool VSIGZipHandle::RestoreCheckpoint( const VSIGZipCheckpoint& sCheckpoint )
+{
+    const int nBits = sCheckpoint.nBits;
+    if( VSIFSeekL((VSILFILE*)m_poBaseHandle,
+                  sCheckpoint.nCompressedPos - (nBits ? 1 : 0), SEEK_SET) != 0 )
+        return false;
+
+    inflateReset(&stream);
+    stream.avail_in = 0;
+    stream.next_in = inbuf;
+    if( nBits )
+    {
+        GByte byVal = 0;
+        if( VSIFReadL(&byVal, 1, 1, (VSILFILE*)m_poBaseHandle) != 1 )
+            return false;
+        inflatePrime(&stream, nBits, byVal >> (8 - nBits));
+    }
+    if( sCheckpoint.pabyWindow != NULL )
+        inflateSetDictionary(&stream, sCheckpoint.pabyWindow, GZIP_WINDOW_SIZE);
+
+    crc = sCheckpoint.nCRC;
+    m_transparent = 0;
+    z_err = Z_OK;
+    z_eof = 0;
+    in = sCheckpoint.nCompressedPos - startOff;
+    out = sCheckpoint.nUncompressedPos;
+    return true;
+}
+
+/************************************************************************/
+/*                        ReadFromCheckpoints()                         */
+/*                                                                      */
+/*      Read nLen bytes, inflating the ranges between the access        */
+/*      points of the index concurrently.                               */
+/************************************************************************/
+
+size_t VSIGZipHandle::ReadFromCheckpoints( void* pBuffer, size_t nLen )
+{
+    const std::vector<VSIGZipCheckpoint>& asCheckpoints =
+        m_poIndex->asCheckpoints;
+    const vsi_l_offset nStart = out;
+
+    /* First access point at or after the start, last one before the end */
+    int iFirst = m_poIndex->FindCheckpoint(nStart);
+    if( iFirst < 0 || asCheckpoints[iFirst].nUncompressedPos < nStart )
+        iFirst ++;
+    const int iLast = m_poIndex->FindCheckpoint(nStart + nLen);
+    if( iLast - iFirst < 2 )
+        return gzread(pBuffer, nLen);
+
+    GByte* pabyOut = (GByte*) pBuffer;
+    const size_t nHead =
+        static_cast<size_t>(asCheckpoints[iFirst].nUncompressedPos - nStart);
+    size_t nDone = gzread(pabyOut, nHead);
+    if( nDone != nHead )
+        return nDone;
+
+/* -------------------------------------------------------------------- */
+/*      Read the compressed data of all the ranges.                     */
+/* -------------------------------------------------------------------- */
+    const vsi_l_offset nInStart = asCheckpoints[iFirst].nCompressedPos -
+        (asCheckpoints[iFirst].nBits ? 1 : 0);
+    const vsi_l_offset nInEnd = asCheckpoints[iLast].nCompressedPos;
+    const size_t nInSize = static_cast<size_t>(nInEnd - nInStart);
+    GByte* pabyIn = NULL;
+    if( nInEnd > nInStart && nInEnd - nInStart == nInSize )
+        pabyIn = (GByte*) VSI_MALLOC_VERBOSE(nInSize);
+    if( pabyIn == NULL )
+        return nDone + gzread(pabyOut + nDone, nLen - nDone);
+
+    if( VSIFSeekL((VSILFILE*)m_poBaseHandle, nInStart, SEEK_SET) != 0 ||
+        VSIFReadL(pabyIn, 1, nInSize, (VSILFILE*)m_poBaseHandle) != nInSize )
+    {
+        CPLError(CE_Failure, CPLE_FileIO, "Cannot read compressed data");
+        CPLFree(pabyIn);
+        z_err = Z_ERRNO;
+        return nDone;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Inflate them.                                                   */
+/* -------------------------------------------------------------------- */
+    std::vector<VSIGZipInflateRangeJob> asJobs(iLast - iFirst);
+    std::vector<void*> apJobs;
+    for( int i = iFirst; i < iLast; i++ )
+    {
+        VSIGZipInflateRangeJob* psJob = &asJobs[i - iFirst];
+        const vsi_l_offset nRangeStart = asCheckpoints[i].nCompressedPos -
+            (asCheckpoints[i].nBits ? 1 : 0);
+        psJob->pabyIn = pabyIn + static_cast<size_t>(nRangeStart - nInStart);
+        psJob->nInSize =
+            static_cast<size_t>(asCheckpoints[i+1].nCompressedPos - nRangeStart);
+        psJob->psStart = &asCheckpoints[i];
+        psJob->psEnd = &asCheckpoints[i+1];
+        psJob->pabyOut = pabyOut + static_cast<size_t>(
+            asCheckpoints[i].nUncompressedPos - nStart);
+        psJob->nOutSize = static_cast<size_t>(
+            asCheckpoints[i+1].nUncompressedPos -
+            asCheckpoints[i].nUncompressedPos);
+        psJob->bOK = false;
+        apJobs.push_back(psJob);
+    }
+
+    if( m_poThreadPool == NULL )
+    {
+        m_poThreadPool = new (std::nothrow) CPLWorkerThreadPool();
+        if( m_poThreadPool != NULL &&
+            !m_poThreadPool->Setup(GetGZipNumThreads(), NULL, NULL) )
+        {
+            delete m_poThreadPool;
+            m_poThreadPool = NULL;
+        }
+    }
+    if( m_poThreadPool != NULL )
+    {
+        m_poThreadPool->SubmitJobs(VSIGZipInflateRange, apJobs);
+        m_poThreadPool->WaitCompletion();
+    }
+    else
+    {
+        for( size_t i = 0; i < apJobs.size(); i++ )
+            VSIGZipInflateRange(apJobs[i]);
+    }
+    CPLFree(pabyIn);
+
+    for( size_t i = 0; i < asJobs.size(); i++ )
+    {
+        if( !asJobs[i].bOK )
+        {
+            CPLError(CE_Failure, CPLE_FileIO,
+                     "Inflate or CRC error at uncompressed offset " CPL_FRMT_GUIB,
+                     asJobs[i].psStart->nUncompressedPos);
+            z_err = Z_DATA_ERROR;
+            return nDone;
+        }
+        nDone += asJobs[i].nOutSize;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Continue sequentially from the last access point.               */
+/* -------------------------------------------------------------------- */
+    if( !RestoreCheckpoint(asCheckpoints[iLast]) )
+    {
+        z_err = Z_ERRNO;
+        return nDone;
+    }
+    if( nDone < nLen )
+        nDone += gzread(pabyOut + nDone, nLen - nDone);
+    if( out > m_nLastReadOffset )
+        m_nLastReadOffset = out;
+    return nDone;
+}
+
 /************************************************************************/
 /*                      check_header()                                  */
 /************************************************************************/
@@ -614,7 +1297,7 @@ int VSIGZipHandle::gzseek( vsi_l_offset offset, int whence )
     {
         /* If we known the uncompressed size, we can fake a jump to */
         /* the end of the stream */
-        if (offset == 0 && m_uncompressed_size != 0)
+        if (offset == 0 && m_uncompressed_size != 0 && !WantIndex())
         {
             out = m_uncompressed_size;
             return 1;
@@ -632,6 +1315,19 @@ int VSIGZipHandle::gzseek( vsi_l_offset offset, int whence )
         whence = SEEK_CUR;
         offset = 1024 * 1024 * 1024;
         offset *= 1024 * 1024;
+
+        /* As the whole stream is going to be inflated, collect access */
+        /* points on the way and save them in a .gz.idx file */
+        if( WantIndex() )
+        {
+            if( gzrewind() < 0 )
+            {
+                CPL_VSIL_GZ_RETURN(-1);
+                return -1L;
+            }
+            if( !m_transparent )
+                StartIndex();
+        }
     }
 
     if (/*whence == SEEK_END ||*/
@@ -685,6 +1381,28 @@ int VSIGZipHandle::gzseek( vsi_l_offset offset, int whence )
         }
     }
 
+    /* Restart from the access point of the index just before the */
+    /* target, if it is further than the current position */
+    if( m_poIndex != NULL && m_poIndexBuilding == NULL && !m_transparent )
+    {
+        const int iCheckpoint = m_poIndex->FindCheckpoint(out + offset);
+        if( iCheckpoint >= 0 &&
+            m_poIndex->asCheckpoints[iCheckpoint].nUncompressedPos > out )
+        {
+            const VSIGZipCheckpoint& sCheckpoint =
+                m_poIndex->asCheckpoints[iCheckpoint];
+            if (ENABLE_DEBUG)
+                CPLDebug("GZIP", "using access point %d : out=" CPL_FRMT_GUIB,
+                         iCheckpoint, sCheckpoint.nUncompressedPos);
+            offset = out + offset - sCheckpoint.nUncompressedPos;
+            if( !RestoreCheckpoint(sCheckpoint) )
+            {
+                CPL_VSIL_GZ_RETURN(-1);
+                return -1L;
+            }
+        }
+    }
+
     /* offset is now the number of bytes to skip. */
 
     if (offset != 0 && outbuf == NULL) {
@@ -705,15 +1423,19 @@ int VSIGZipHandle::gzseek( vsi_l_offset offset, int whence )
         int size = Z_BUFSIZE;
         if (offset < Z_BUFSIZE) size = (int)offset;
 
-        int read_size = static_cast<int>(Read(outbuf, 1, (uInt)size));
+        int read_size = static_cast<int>(gzread(outbuf, (uInt)size));
         if (read_size == 0) {
             //CPL_VSIL_GZ_RETURN(-1);
+            if( m_poIndexBuilding != NULL )
+                FinishIndex( z_err == Z_STREAM_END );
             return -1L;
         }
         if (original_nWhence == SEEK_END)
         {
             if (size != read_size)
             {
+                if( m_poIndexBuilding != NULL )
+                    FinishIndex( z_err == Z_STREAM_END );
                 z_err = Z_STREAM_END;
                 break;
             }
@@ -722,6 +1444,9 @@ int VSIGZipHandle::gzseek( vsi_l_offset offset, int whence )
     }
     if (ENABLE_DEBUG) CPLDebug("GZIP", "gzseek return " CPL_FRMT_GUIB, out);
 
+    if( m_poIndexBuilding != NULL )
+        FinishIndex( false );
+
     if (original_offset == 0 && original_nWhence == SEEK_END)
     {
         m_uncompressed_size = out;
@@ -775,6 +1500,28 @@ size_t VSIGZipHandle::Read( void * const buf, size_t const nSize, size_t const n
 {
     if (ENABLE_DEBUG) CPLDebug("GZIP", "Read(%p, %d, %d)", buf, (int)nSize, (int)nMemb);
 
+    const size_t nLen = nSize * nMemb;
+    if( nLen == 0 )
+        return 0;
+
+    /* Large reads can be inflated concurrently from the access points */
+    if( m_poIndex != NULL && !m_transparent && z_err == Z_OK &&
+        nLen >= 2 * GZIP_INDEX_SPAN && GetGZipNumThreads() > 1 )
+        return ReadFromCheckpoints(buf, nLen) / nSize;
+
+    return gzread(buf, nLen) / nSize;
+}
+
+/************************************************************************/
+/*                              gzread()                                */
+/*                                                                      */
+/*      Inflate nLen bytes from the current position, and return the    */
+/*      number of bytes read.                                           */
+/************************************************************************/
+
+size_t VSIGZipHandle::gzread( void * const buf, size_t const nLen )
+{
+
     if  (z_err == Z_DATA_ERROR || z_err == Z_ERRNO)
     {
         z_eof = 1; /* to avoid infinite loop in reader code */
@@ -790,7 +1537,7 @@ size_t VSIGZipHandle::Read( void * const buf, size_t const nSize, size_t const n
         return 0;  /* EOF */
     }
 
-    const unsigned len = static_cast<unsigned int>(nSize) * static_cast<unsigned int>(nMemb);
+    const unsigned len = static_cast<unsigned int>(nLen);
     Bytef *pStart = (Bytef*)buf; /* startOffing point for crc computation */
     Byte  *next_out; /* == stream.next_out but not forced far (for MSDOS) */
     next_out = (Byte*)buf;
@@ -823,8 +1570,8 @@ size_t VSIGZipHandle::Read( void * const buf, size_t const nSize, size_t const n
             in  += nRead;
             out += nRead;
             if (nRead < len) z_eof = 1;
-            if (ENABLE_DEBUG) CPLDebug("GZIP", "Read return %d", (int)(nRead / nSize));
-            return (int)nRead / nSize;
+            if (ENABLE_DEBUG) CPLDebug("GZIP", "Read return %d", (int)nRead);
+            return nRead;
         }
         if  (stream.avail_in == 0 && !z_eof)
         {
@@ -880,10 +1627,17 @@ size_t VSIGZipHandle::Read( void * const buf, size_t const nSize, size_t const n
         }
         in += stream.avail_in;
         out += stream.avail_out;
-        z_err = inflate(& (stream), Z_NO_FLUSH);
+        z_err = inflate(& (stream), m_poIndexBuilding ? Z_BLOCK : Z_NO_FLUSH);
         in -= stream.avail_in;
         out -= stream.avail_out;
 
+        if( m_poIndexBuilding != NULL )
+        {
+            crc = crc32 (crc, pStart, (uInt) (stream.next_out - pStart));
+            UpdateIndex( pStart, stream.next_out - pStart );
+            pStart = stream.next_out;
+        }
+
         if  (z_err == Z_STREAM_END && m_compressed_size != 2 ) {
             /* Check CRC and original size */
             crc = crc32 (crc, pStart, (uInt) (stream.next_out - pStart));
@@ -916,6 +1670,10 @@ size_t VSIGZipHandle::Read( void * const buf, size_t const nSize, size_t const n
                     if  (z_err == Z_OK) {
                         inflateReset(& (stream));
                         crc = crc32(0L, NULL, 0);
+                        if( m_poIndexBuilding != NULL )
+                            m_poIndexBuilding->AddCheckpoint(
+                                VSIFTellL((VSILFILE*)m_poBaseHandle) - stream.avail_in,
+                                out, crc, 0, NULL, 0 );
                     }
                 }
             }
@@ -934,8 +1692,8 @@ size_t VSIGZipHandle::Read( void * const buf, size_t const nSize, size_t const n
     }
     if (ENABLE_DEBUG)
         CPLDebug("GZIP", "Read return %d (z_err=%d, z_eof=%d)",
-                (int)((len - stream.avail_out) / nSize), z_err, z_eof);
-    return (int)(len - stream.avail_out) / nSize;
+                (int)(len - stream.avail_out), z_err, z_eof);
+    return len - stream.avail_out;
 }
 
 /************************************************************************/
@@ -1007,6 +1765,62 @@ int VSIGZipHandle::Close()
 /* ==================================================================== */
 /************************************************************************/
 
+typedef struct
+{
+    std::vector<GByte> abyIn;   /* uncompressed data */
+    std::vector<GByte> abyOut;  /* complete gzip member */
+} VSIGZipMemberJob;
+
+/************************************************************************/
+/*                       VSIGZipCompressMember()                        */
+/************************************************************************/
+
+static void VSIGZipCompressMember( void* pData )
+{
+    VSIGZipMemberJob* psJob = (VSIGZipMemberJob*) pData;
+    psJob->abyOut.clear();
+
+    z_stream sStream;
+    memset(&sStream, 0, sizeof(sStream));
+    if( deflateInit2( &sStream, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                      -MAX_WBITS, 8, Z_DEFAULT_STRATEGY ) != Z_OK )
+        return;
+
+    const uLong nInSize = static_cast<uLong>(psJob->abyIn.size());
+    psJob->abyOut.resize( 10 + deflateBound(&sStream, nInSize) + 8 );
+    GByte* pabyOut = &psJob->abyOut[0];
+
+    /* Same header as the one of the single member stream */
+    pabyOut[0] = (GByte) gz_magic[0];
+    pabyOut[1] = (GByte) gz_magic[1];
+    pabyOut[2] = Z_DEFLATED;
+    memset( pabyOut + 3, 0, 6 );
+    pabyOut[9] = 0x03;
+
+    sStream.next_in = nInSize ? &psJob->abyIn[0] : NULL;
+    sStream.avail_in = (uInt) nInSize;
+    sStream.next_out = pabyOut + 10;
+    sStream.avail_out = (uInt) (psJob->abyOut.size() - 18);
+    const int nRet = deflate( &sStream, Z_FINISH );
+    const size_t nOutSize = 10 + sStream.total_out;
+    deflateEnd( &sStream );
+    if( nRet != Z_STREAM_END )
+    {
+        psJob->abyOut.clear();
+        return;
+    }
+
+    uLong nCRC = crc32(0L, NULL, 0);
+    if( nInSize )
+        nCRC = crc32(nCRC, &psJob->abyIn[0], (uInt) nInSize);
+
+    GUInt32 anTrailer[2];
+    anTrailer[0] = CPL_LSBWORD32( static_cast<GUInt32>(nCRC) );
+    anTrailer[1] = CPL_LSBWORD32( static_cast<GUInt32>(nInSize) );
+    memcpy( pabyOut + nOutSize, anTrailer, 8 );
+    psJob->abyOut.resize( nOutSize + 8 );
+}
+
 class VSIGZipWriteHandle CPL_FINAL : public VSIVirtualHandle
 {
     VSIVirtualHandle*  m_poBaseHandle;
@@ -1019,9 +1833,22 @@ class VSIGZipWriteHandle CPL_FINAL : public VSIVirtualHandle
     int                bRegularZLib;
     int                bAutoCloseBaseHandle;
 
+    /* Multi member mode: the data is split in members of nMemberSize */
+    /* bytes compressed concurrently by batches */
+    size_t             nMemberSize;
+    std::vector<VSIGZipMemberJob> asMembers;
+    int                nPendingMembers;
+    vsi_l_offset       nCompressedOffset;
+    CPLWorkerThreadPool* poThreadPool;
+    VSIGZipIndex*      poIndex;        /* member starts, if a .gz.idx is to be written */
+    CPLString          osIndexFilename;
+
+    bool               FlushMembers();
+
   public:
 
-    VSIGZipWriteHandle(VSIVirtualHandle* poBaseHandle, int bRegularZLib, int bAutoCloseBaseHandleIn);
+    VSIGZipWriteHandle(VSIVirtualHandle* poBaseHandle, int bRegularZLib, int bAutoCloseBaseHandleIn,
+                       size_t nMemberSizeIn = 0, const char* pszIndexFilename = NULL);
 
     ~VSIGZipWriteHandle();
 
@@ -1040,8 +1867,14 @@ class VSIGZipWriteHandle CPL_FINAL : public VSIVirtualHandle
 
 VSIGZipWriteHandle::VSIGZipWriteHandle( VSIVirtualHandle *poBaseHandle,
                                         int bRegularZLibIn,
-                                        int bAutoCloseBaseHandleIn )
-
+                                        int bAutoCloseBaseHandleIn,
+                                        size_t nMemberSizeIn,
+                                        const char* pszIndexFilename ) :
+    nMemberSize(bRegularZLibIn ? 0 : nMemberSizeIn),
+    nPendingMembers(0),
+    nCompressedOffset(0),
+    poThreadPool(NULL),
+    poIndex(NULL)
 {
     nCurOffset = 0;
 
@@ -1049,6 +1882,27 @@ VSIGZipWriteHandle::VSIGZipWriteHandle( VSIVirtualHandle *poBaseHandle,
     bRegularZLib = bRegularZLibIn;
     bAutoCloseBaseHandle = bAutoCloseBaseHandleIn;
 
+    if( nMemberSize > 0 )
+    {
+        const int nThreads = GetGZipNumThreads();
+        asMembers.resize(nThreads);
+        if( nThreads > 1 )
+        {
+            poThreadPool = new (std::nothrow) CPLWorkerThreadPool();
+            if( poThreadPool != NULL &&
+                !poThreadPool->Setup(nThreads, NULL, NULL) )
+            {
+                delete poThreadPool;
+                poThreadPool = NULL;
+            }
+        }
+        if( pszIndexFilename != NULL )
+        {
+            poIndex = new VSIGZipIndex();
+            osIndexFilename = pszIndexFilename;
+        }
+    }
+
     nCRC = crc32(0L, NULL, 0);
     sStream.zalloc = (alloc_func)NULL;
     sStream.zfree = (free_func)NULL;
@@ -1062,7 +1916,13 @@ VSIGZipWriteHandle::VSIGZipWriteHandle( VSIVirtualHandle *poBaseHandle,
 
     pabyOutBuf = (Byte *) CPLMalloc( Z_BUFSIZE );
 
-    if( deflateInit2( &sStream, Z_DEFAULT_COMPRESSION,
+    if( nMemberSize > 0 )
+    {
+        /* The header is written with each member */
+        sStream.state = NULL;
+        bCompressActive = true;
+    }
+    else if( deflateInit2( &sStream, Z_DEFAULT_COMPRESSION,
                       Z_DEFLATED, (bRegularZLib) ? MAX_WBITS : -MAX_WBITS, 8,
                       Z_DEFAULT_STRATEGY ) != Z_OK )
         bCompressActive = false;
@@ -1108,6 +1968,61 @@ VSIGZipWriteHandle::~VSIGZipWriteHandle()
 
     CPLFree( pabyInBuf );
     CPLFree( pabyOutBuf );
+
+    delete poThreadPool;
+    if( poIndex != NULL )
+        poIndex->Release();
+}
+
+/************************************************************************/
+/*                            FlushMembers()                            */
+/*                                                                      */
+/*      Compress the pending members and write them in order.           */
+/************************************************************************/
+
+bool VSIGZipWriteHandle::FlushMembers()
+
+{
+    if( nPendingMembers == 0 )
+        return true;
+
+    if( poThreadPool != NULL && nPendingMembers > 1 )
+    {
+        std::vector<void*> apJobs;
+        for( int i = 0; i < nPendingMembers; i++ )
+            apJobs.push_back(&asMembers[i]);
+        poThreadPool->SubmitJobs(VSIGZipCompressMember, apJobs);
+        poThreadPool->WaitCompletion();
+    }
+    else
+    {
+        for( int i = 0; i < nPendingMembers; i++ )
+            VSIGZipCompressMember(&asMembers[i]);
+    }
+
+    vsi_l_offset nUncompressedOffset = nCurOffset;
+    for( int i = 0; i < nPendingMembers; i++ )
+        nUncompressedOffset -= asMembers[i].abyIn.size();
+
+    bool bOK = true;
+    for( int i = 0; i < nPendingMembers; i++ )
+    {
+        VSIGZipMemberJob* psMember = &asMembers[i];
+        const size_t nOutSize = psMember->abyOut.size();
+        if( bOK && (nOutSize == 0 ||
+            m_poBaseHandle->Write(&psMember->abyOut[0], 1, nOutSize) != nOutSize) )
+            bOK = false;
+        if( bOK && poIndex != NULL )
+            poIndex->AddCheckpoint( nCompressedOffset + 10,
+                                    nUncompressedOffset,
+                                    crc32(0L, NULL, 0), 0, NULL, 0 );
+        nCompressedOffset += nOutSize;
+        nUncompressedOffset += psMember->abyIn.size();
+        psMember->abyIn.resize(0);
+        psMember->abyOut.resize(0);
+    }
+    nPendingMembers = 0;
+    return bOK;
 }
 
 /************************************************************************/
@@ -1118,7 +2033,34 @@ int VSIGZipWriteHandle::Close()
 
 {
     int nRet = 0;
-    if( bCompressActive )
+    if( bCompressActive && nMemberSize > 0 )
+    {
+        /* An empty stream still needs one member */
+        if( !asMembers[nPendingMembers].abyIn.empty() ||
+            nCompressedOffset == 0 )
+            nPendingMembers ++;
+        if( !FlushMembers() )
+            nRet = EOF;
+
+        if( nRet == 0 && poIndex != NULL )
+        {
+            poIndex->nCompressedSize = nCompressedOffset;
+            poIndex->nUncompressedSize = nCurOffset;
+            if( !poIndex->Save(osIndexFilename) )
+                CPLDebug("GZIP", "Cannot write %s", osIndexFilename.c_str());
+        }
+
+        if( bAutoCloseBaseHandle )
+        {
+            if( m_poBaseHandle->Close() != 0 )
+                nRet = EOF;
+
+            delete m_poBaseHandle;
+        }
+
+        bCompressActive = false;
+    }
+    else if( bCompressActive )
     {
         sStream.next_out = pabyOutBuf;
         sStream.avail_out = Z_BUFSIZE;
@@ -1178,11 +2120,34 @@ size_t VSIGZipWriteHandle::Write( const void * const pBuffer,
     int nBytesToWrite = (int) (nSize * nMemb);
     int nNextByte = 0;
 
-    nCRC = crc32(nCRC, (const Bytef *)pBuffer, nBytesToWrite);
-
     if( !bCompressActive )
         return 0;
 
+    if( nMemberSize > 0 )
+    {
+        while( nNextByte < nBytesToWrite )
+        {
+            std::vector<GByte>& abyIn = asMembers[nPendingMembers].abyIn;
+            const size_t nToCopy = MIN( nMemberSize - abyIn.size(),
+                                        (size_t)(nBytesToWrite - nNextByte) );
+            abyIn.insert( abyIn.end(), ((GByte *) pBuffer) + nNextByte,
+                          ((GByte *) pBuffer) + nNextByte + nToCopy );
+            nNextByte += static_cast<int>(nToCopy);
+            nCurOffset += nToCopy;
+
+            if( abyIn.size() == nMemberSize )
+            {
+                nPendingMembers ++;
+                if( nPendingMembers == static_cast<int>(asMembers.size()) &&
+                    !FlushMembers() )
+                    return 0;
+            }
+        }
+        return nMemb;
+    }
+
+    nCRC = crc32(nCRC, (const Bytef *)pBuffer, nBytesToWrite);
+
     while( nNextByte < nBytesToWrite )
     {
         sStream.next_out = pabyOutBuf;
@@ -1376,8 +2341,21 @@ VSIVirtualHandle* VSIGZipFilesystemHandler::Open( const char *pszFilename,
         if (poVirtualHandle == NULL)
             return NULL;
 
-        else
-            return new VSIGZipWriteHandle( poVirtualHandle, strchr(pszAccess, 'z') != NULL, TRUE );
+        /* Independent members can be compressed concurrently, and */
+        /* their starts make an index for random access */
+        const GUIntBig nMemberSize = CPLScanUIntBig(
+            CPLGetConfigOption("CPL_VSIL_GZIP_MEMBER_SIZE", "0"), 32);
+        CPLString osIndexFilename;
+        if( nMemberSize > 0 &&
+            CPLTestBool(CPLGetConfigOption("CPL_VSIL_GZIP_WRITE_INDEX", "NO")) )
+        {
+            osIndexFilename = pszFilename + strlen("/vsigzip/");
+            osIndexFilename += ".idx";
+        }
+
+        return new VSIGZipWriteHandle( poVirtualHandle, strchr(pszAccess, 'z') != NULL, TRUE,
+                                       static_cast<size_t>(MIN(nMemberSize, 1024 * 1024 * 1024)),
+                                       osIndexFilename.empty() ? NULL : osIndexFilename.c_str() );
     }
 
 /* -------------------------------------------------------------------- */
@@ -1443,6 +2421,7 @@ VSIGZipHandle* VSIGZipFilesystemHandler::OpenGZipReadOnly( const char *pszFilena
         delete poHandle;
         return NULL;
     }
+    poHandle->LoadIndex();
     return poHandle;
 }
 
@@ -1458,7 +2437,20 @@ int VSIGZipFilesystemHandler::Stat( const char *pszFilename,
 
     memset(pStatBuf, 0, sizeof(VSIStatBufL));
 
-    if (poHandleLastGZipFile != NULL &&
+    /* The index of access points is built by seeking at the end, so */
+    /* don't take the shortcuts if it must be written */
+    bool bBuildIndex = false;
+    if ((nFlags & VSI_STAT_SIZE_FLAG) &&
+        CPLTestBool(CPLGetConfigOption("CPL_VSIL_GZIP_WRITE_INDEX", "NO")))
+    {
+        CPLString osIndexFilename(pszFilename+strlen("/vsigzip/"));
+        osIndexFilename += ".idx";
+        VSIStatBufL sIndexStat;
+        bBuildIndex = VSIStatExL(osIndexFilename, &sIndexStat,
+                                 VSI_STAT_EXISTS_FLAG) != 0;
+    }
+
+    if (poHandleLastGZipFile != NULL && !bBuildIndex &&
         strcmp(pszFilename+strlen("/vsigzip/"), poHandleLastGZipFile->GetBaseFileName()) == 0)
     {
         if (poHandleLastGZipFile->GetUncompressedSize() != 0)
@@ -1502,7 +2494,7 @@ int VSIGZipFilesystemHandler::Stat( const char *pszFilename,
 
             CPL_IGNORE_RET_VAL(VSIFCloseL(fpCacheLength));
 
-            if (nCompressedSize == (GUIntBig) pStatBuf->st_size)
+            if (nCompressedSize == (GUIntBig) pStatBuf->st_size && !bBuildIndex)
             {
                 /* Patch with the uncompressed size */
                 pStatBuf->st_size = nUncompressedSize;
@@ -1604,6 +2596,17 @@ char** VSIGZipFilesystemHandler::ReadDirEx( const char * /*pszDirname*/,
  * All portions of the file system underneath the base
  * path "/vsigzip/" will be handled by this driver.
  *
+ * Starting with GDAL 2.2, random access in large files can be sped up by an
+ * index of access points, saved in a .gz.idx file next to the .gz file.
+ * When the CPL_VSIL_GZIP_WRITE_INDEX configuration option is set to YES, the
+ * index is written the first time the whole file is inflated to compute its
+ * uncompressed size (VSIStatL(), or VSIFSeekL() at the end of the file).
+ * Reads larger than a few megabytes are then inflated on GDAL_NUM_THREADS
+ * threads. When writing, the CPL_VSIL_GZIP_MEMBER_SIZE configuration option
+ * can be set to a number of uncompressed bytes, so that the file is made of
+ * independent gzip members of that size, compressed on GDAL_NUM_THREADS
+ * threads, and indexed if CPL_VSIL_GZIP_WRITE_INDEX is set.
+ *
  * Additional documentation is to be found at http://trac.osgeo.org/gdal/wiki/UserDocs/ReadInZip
  *
  * @since GDAL 1.6.0
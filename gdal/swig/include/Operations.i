@@ -382,6 +382,32 @@ int  SieveFilter( GDALRasterBandShadow *srcBand,
 %}
 %clear GDALRasterBandShadow *srcBand, GDALRasterBandShadow *dstBand;
 
+/************************************************************************/
+/*                     LabelConnectedComponents()                       */
+/************************************************************************/
+
+%apply Pointer NONNULL {GDALRasterBandShadow *srcBand, GDALRasterBandShadow *dstBand};
+#ifndef SWIGJAVA
+%feature( "kwargs" ) LabelConnectedComponents;
+#endif
+%inline %{
+int  LabelConnectedComponents( GDALRasterBandShadow *srcBand,
+                               GDALRasterBandShadow *maskBand,
+                               GDALRasterBandShadow *dstBand,
+                               int connectedness=4,
+                               char **options = NULL,
+                               GDALProgressFunc callback=NULL,
+                               void* callback_data=NULL) {
+
+    CPLErrorReset();
+
+    return GDALLabelConnectedComponents( srcBand, maskBand, dstBand,
+                                         connectedness,
+                                         options, callback, callback_data );
+}
+%}
+%clear GDALRasterBandShadow *srcBand, GDALRasterBandShadow *dstBand;
+
 /************************************************************************/
 /*                        RegenerateOverviews()                         */
 /************************************************************************/
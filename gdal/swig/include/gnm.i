@@ -82,6 +82,7 @@ typedef void OSRSpatialReferenceShadow;
 %include python_exceptions.i
 %include python_strings.i
 %include typemaps_python.i
+%include "callback.i"
 #elif defined(SWIGRUBY)
 //%include typemaps_ruby.i
 #elif defined(SWIGPHP4)
@@ -379,6 +380,39 @@ class GNMGenericNetworkShadow : public GNMNetworkShadow
         CPLErr ChangeAllBlockState (bool bIsBlock = false) {
             return GNMChangeAllBlockState(self, bIsBlock);
         }
+
+#ifndef SWIGJAVA
+        %feature( "kwargs" ) BuildContractionHierarchy;
+#endif
+        CPLErr BuildContractionHierarchy (GDALProgressFunc callback = NULL,
+                                          void* callback_data = NULL) {
+            return GNMBuildContractionHierarchy(self, callback, callback_data);
+        }
+
+#if defined(SWIGPYTHON)
+        %apply (int nList, GIntBig* pList) {(int nEndCount, GNMGFID *panEndFIDs)};
+        void GetShortestPathCosts (GNMGFID nStartFID,
+                                   int nEndCount, GNMGFID *panEndFIDs,
+                                   int* pnCount, double** ppadfValues) {
+            *pnCount = 0;
+            *ppadfValues = NULL;
+            if( nEndCount <= 0 )
+                return;
+            double* padfCosts = (double*)
+                VSI_MALLOC2_VERBOSE(nEndCount, sizeof(double));
+            if( padfCosts == NULL )
+                return;
+            if( GNMGetShortestPathCosts(self, nStartFID, nEndCount,
+                                        panEndFIDs, padfCosts) != CE_None )
+            {
+                VSIFree(padfCosts);
+                return;
+            }
+            *pnCount = nEndCount;
+            *ppadfValues = padfCosts;
+        }
+        %clear (int nEndCount, GNMGFID *panEndFIDs);
+#endif
     }
 };
 
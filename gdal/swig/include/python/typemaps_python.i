@@ -1807,6 +1807,33 @@ DecomposeSequenceOfCoordinates( PyObject *seq, int nCount, double *x, double *y,
     VSIFree(*$3);
 }
 
+/*
+ * Typemap argout used in GenericNetwork::GetShortestPathCosts()
+ */
+%typemap(in,numinputs=0) (int* pnCount, double** ppadfValues) ( int nValues = 0, double* padfValues = NULL )
+{
+  /* %typemap(in,numinputs=0) (int* pnCount, double** ppadfValues) */
+  $1 = &nValues;
+  $2 = &padfValues;
+}
+
+%typemap(argout)  (int* pnCount, double** ppadfValues)
+{
+  /* %typemap(argout)  (int* pnCount, double** ppadfValues) */
+  Py_DECREF($result);
+  PyObject *out = PyList_New( *$1 );
+  for( int i=0; i<*$1; i++ ) {
+    PyList_SetItem( out, i, PyFloat_FromDouble( (*$2)[i] ) );
+  }
+  $result = out;
+}
+
+%typemap(freearg)  (int* pnCount, double** ppadfValues)
+{
+    /* %typemap(freearg)  (int* pnCount, double** ppadfValues) */
+    VSIFree(*$2);
+}
+
 
 %typemap(in) (const char *utf8_path) (int bToFree = 0)
 {
@@ -2948,10 +2948,11 @@ SWIG_Python_NonDynamicSetAttr(PyObject *obj, PyObject *name, PyObject *value) {
 #define SWIGTYPE_p_OGRwkbGeometryType swig_types[7]
 #define SWIGTYPE_p_OSRSpatialReferenceShadow swig_types[8]
 #define SWIGTYPE_p_char swig_types[9]
-#define SWIGTYPE_p_int swig_types[10]
-#define SWIGTYPE_p_p_char swig_types[11]
-static swig_type_info *swig_types[13];
-static swig_module_info swig_module = {swig_types, 12, 0, 0, 0, 0};
+#define SWIGTYPE_p_f_double_p_q_const__char_p_void__int swig_types[10]
+#define SWIGTYPE_p_int swig_types[11]
+#define SWIGTYPE_p_p_char swig_types[12]
+static swig_type_info *swig_types[14];
+static swig_module_info swig_module = {swig_types, 13, 0, 0, 0, 0};
 #define SWIG_TypeQuery(name) SWIG_TypeQueryModule(&swig_module, &swig_module, name)
 #define SWIG_MangledTypeQuery(name) SWIG_MangledTypeQueryModule(&swig_module, &swig_module, name)
 
@@ -3216,6 +3217,75 @@ static void GDALPythonFreeCStr(void* ptr, int bToFree)
 }
 
 
+
+typedef struct {
+    PyObject *psPyCallback;
+    PyObject *psPyCallbackData;
+    int nLastReported;
+} PyProgressData;
+
+/************************************************************************/
+/*                          PyProgressProxy()                           */
+/************************************************************************/
+
+static int CPL_STDCALL
+PyProgressProxy( double dfComplete, const char *pszMessage, void *pData )
+
+{
+    PyProgressData *psInfo = (PyProgressData *) pData;
+    PyObject *psArgs, *psResult;
+    int      bContinue = TRUE;
+
+    if( psInfo->nLastReported == (int) (100.0 * dfComplete) )
+        return TRUE;
+
+    if( psInfo->psPyCallback == NULL || psInfo->psPyCallback == Py_None )
+        return TRUE;
+
+    psInfo->nLastReported = (int) (100.0 * dfComplete);
+
+    if( pszMessage == NULL )
+        pszMessage = "";
+
+    if( psInfo->psPyCallbackData == NULL )
+        psArgs = Py_BuildValue("(dsO)", dfComplete, pszMessage, Py_None );
+    else
+        psArgs = Py_BuildValue("(dsO)", dfComplete, pszMessage,
+	                       psInfo->psPyCallbackData );
+
+    psResult = PyEval_CallObject( psInfo->psPyCallback, psArgs);
+    Py_XDECREF(psArgs);
+
+    if( PyErr_Occurred() != NULL )
+    {
+        PyErr_Clear();
+        return FALSE;
+    }
+
+    if( psResult == NULL )
+    {
+        return TRUE;
+    }
+
+    if( psResult == Py_None )
+    {
+        return TRUE;
+    }
+
+    if( !PyArg_Parse( psResult, "i", &bContinue ) )
+    {
+        PyErr_Clear();
+        CPLError(CE_Failure, CPLE_AppDefined, "bad progress return value");
+        Py_XDECREF(psResult);
+	return FALSE;
+    }
+
+    Py_XDECREF(psResult);
+
+    return bContinue;
+}
+
+
 SWIGINTERN char const *GDALMajorObjectShadow_GetDescription(GDALMajorObjectShadow *self){
     return GDALGetDescription( self );
   }
@@ -3689,6 +3759,27 @@ SWIGINTERN CPLErr GNMGenericNetworkShadow_ChangeBlockState(GNMGenericNetworkShad
 SWIGINTERN CPLErr GNMGenericNetworkShadow_ChangeAllBlockState(GNMGenericNetworkShadow *self,bool bIsBlock=false){
             return GNMChangeAllBlockState(self, bIsBlock);
         }
+SWIGINTERN CPLErr GNMGenericNetworkShadow_BuildContractionHierarchy(GNMGenericNetworkShadow *self,GDALProgressFunc callback=NULL,void *callback_data=NULL){
+            return GNMBuildContractionHierarchy(self, callback, callback_data);
+        }
+SWIGINTERN void GNMGenericNetworkShadow_GetShortestPathCosts(GNMGenericNetworkShadow *self,GIntBig nStartFID,int nEndCount,GIntBig *panEndFIDs,int *pnCount,double **ppadfValues){
+            *pnCount = 0;
+            *ppadfValues = NULL;
+            if( nEndCount <= 0 )
+                return;
+            double* padfCosts = (double*)
+                VSI_MALLOC2_VERBOSE(nEndCount, sizeof(double));
+            if( padfCosts == NULL )
+                return;
+            if( GNMGetShortestPathCosts(self, nStartFID, nEndCount,
+                                        panEndFIDs, padfCosts) != CE_None )
+            {
+                VSIFree(padfCosts);
+                return;
+            }
+            *pnCount = nEndCount;
+            *ppadfValues = padfCosts;
+        }
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -6397,6 +6488,213 @@ fail:
 }
 
 
+SWIGINTERN PyObject *_wrap_GenericNetwork_BuildContractionHierarchy(PyObject *SWIGUNUSEDPARM(self), PyObject *args, PyObject *kwargs) {
+  PyObject *resultobj = 0; int bLocalUseExceptionsCode = bUseExceptions;
+  GNMGenericNetworkShadow *arg1 = (GNMGenericNetworkShadow *) 0 ;
+  GDALProgressFunc arg2 = (GDALProgressFunc) NULL ;
+  void *arg3 = (void *) NULL ;
+  void *argp1 = 0 ;
+  int res1 = 0 ;
+  PyObject * obj0 = 0 ;
+  PyObject * obj1 = 0 ;
+  PyObject * obj2 = 0 ;
+  char *  kwnames[] = {
+    (char *) "self",(char *) "callback",(char *) "callback_data", NULL 
+  };
+  CPLErr result;
+  
+  /* %typemap(arginit) ( const char* callback_data=NULL)  */
+  PyProgressData *psProgressInfo;
+  psProgressInfo = (PyProgressData *) CPLCalloc(1,sizeof(PyProgressData));
+  psProgressInfo->nLastReported = -1;
+  psProgressInfo->psPyCallback = NULL;
+  psProgressInfo->psPyCallbackData = NULL;
+  arg3 = psProgressInfo;
+  if (!PyArg_ParseTupleAndKeywords(args,kwargs,(char *)"O|OO:GenericNetwork_BuildContractionHierarchy",kwnames,&obj0,&obj1,&obj2)) SWIG_fail;
+  res1 = SWIG_ConvertPtr(obj0, &argp1,SWIGTYPE_p_GNMGenericNetworkShadow, 0 |  0 );
+  if (!SWIG_IsOK(res1)) {
+    SWIG_exception_fail(SWIG_ArgError(res1), "in method '" "GenericNetwork_BuildContractionHierarchy" "', argument " "1"" of type '" "GNMGenericNetworkShadow *""'"); 
+  }
+  arg1 = reinterpret_cast< GNMGenericNetworkShadow * >(argp1);
+  if (obj1) {
+    {
+      /* %typemap(in) (GDALProgressFunc callback = NULL) */
+      /* callback_func typemap */
+      if (obj1 && obj1 != Py_None ) {
+        void* cbfunction = NULL;
+        CPL_IGNORE_RET_VAL(SWIG_ConvertPtr( obj1,
+            (void**)&cbfunction,
+            SWIGTYPE_p_f_double_p_q_const__char_p_void__int,
+            SWIG_POINTER_EXCEPTION | 0 ));
+        
+        if ( cbfunction == GDALTermProgress ) {
+          arg2 = GDALTermProgress;
+        } else {
+          if (!PyCallable_Check(obj1)) {
+            PyErr_SetString( PyExc_RuntimeError,
+              "Object given is not a Python function" );
+            SWIG_fail;
+          }
+          psProgressInfo->psPyCallback = obj1;
+          arg2 = PyProgressProxy;
+        }
+        
+      }
+      
+    }
+  }
+  if (obj2) {
+    {
+      /* %typemap(in) ( void* callback_data=NULL)  */
+      psProgressInfo->psPyCallbackData = obj2 ;
+    }
+  }
+  {
+    if ( bUseExceptions ) {
+      CPLErrorReset();
+    }
+    result = (CPLErr)GNMGenericNetworkShadow_BuildContractionHierarchy(arg1,arg2,arg3);
+#ifndef SED_HACKS
+    if ( bUseExceptions ) {
+      CPLErr eclass = CPLGetLastErrorType();
+      if ( eclass == CE_Failure || eclass == CE_Fatal ) {
+        SWIG_exception( SWIG_RuntimeError, CPLGetLastErrorMsg() );
+      }
+    }
+#endif
+  }
+  resultobj = SWIG_From_int(static_cast< int >(result));
+  {
+    /* %typemap(freearg) ( void* callback_data=NULL)  */
+    
+    CPLFree(psProgressInfo);
+    
+  }
+  if ( ReturnSame(bLocalUseExceptionsCode) ) { CPLErr eclass = CPLGetLastErrorType(); if ( eclass == CE_Failure || eclass == CE_Fatal ) { Py_XDECREF(resultobj); SWIG_Error( SWIG_RuntimeError, CPLGetLastErrorMsg() ); return NULL; } }
+  return resultobj;
+fail:
+  {
+    /* %typemap(freearg) ( void* callback_data=NULL)  */
+    
+    CPLFree(psProgressInfo);
+    
+  }
+  return NULL;
+}
+
+
+SWIGINTERN PyObject *_wrap_GenericNetwork_GetShortestPathCosts(PyObject *SWIGUNUSEDPARM(self), PyObject *args) {
+  PyObject *resultobj = 0; int bLocalUseExceptionsCode = bUseExceptions;
+  GNMGenericNetworkShadow *arg1 = (GNMGenericNetworkShadow *) 0 ;
+  GIntBig arg2 ;
+  int arg3 ;
+  GIntBig *arg4 = (GIntBig *) 0 ;
+  int *arg5 = (int *) 0 ;
+  double **arg6 = (double **) 0 ;
+  void *argp1 = 0 ;
+  int res1 = 0 ;
+  int nValues5 = 0 ;
+  double *padfValues5 = NULL ;
+  PyObject * obj0 = 0 ;
+  PyObject * obj1 = 0 ;
+  PyObject * obj2 = 0 ;
+  
+  {
+    /* %typemap(in,numinputs=0) (int* pnCount, double** ppadfValues) */
+    arg5 = &nValues5;
+    arg6 = &padfValues5;
+  }
+  if (!PyArg_ParseTuple(args,(char *)"OOO:GenericNetwork_GetShortestPathCosts",&obj0,&obj1,&obj2)) SWIG_fail;
+  res1 = SWIG_ConvertPtr(obj0, &argp1,SWIGTYPE_p_GNMGenericNetworkShadow, 0 |  0 );
+  if (!SWIG_IsOK(res1)) {
+    SWIG_exception_fail(SWIG_ArgError(res1), "in method '" "GenericNetwork_GetShortestPathCosts" "', argument " "1"" of type '" "GNMGenericNetworkShadow *""'"); 
+  }
+  arg1 = reinterpret_cast< GNMGenericNetworkShadow * >(argp1);
+  {
+    PY_LONG_LONG val;
+    if ( !PyArg_Parse(obj1,"L",&val) ) {
+      PyErr_SetString(PyExc_TypeError, "not an integer");
+      SWIG_fail;
+    }
+    arg2 = (GIntBig)val;
+  }
+  {
+    /* %typemap(in,numinputs=1) (int nList, GIntBig* pList)*/
+    /* check if is List */
+    if ( !PySequence_Check(obj2) ) {
+      PyErr_SetString(PyExc_TypeError, "not a sequence");
+      SWIG_fail;
+    }
+    Py_ssize_t size = PySequence_Size(obj2);
+    if( size != (int)size ) {
+      PyErr_SetString(PyExc_TypeError, "too big sequence");
+      SWIG_fail;
+    }
+    arg3 = (int)size;
+    arg4 = (GIntBig*) malloc(arg3*sizeof(GIntBig));
+    for( int i = 0; i<arg3; i++ ) {
+      PyObject *o = PySequence_GetItem(obj2,i);
+      PY_LONG_LONG val;
+      if ( !PyArg_Parse(o,"L",&val) ) {
+        PyErr_SetString(PyExc_TypeError, "not an integer");
+        Py_DECREF(o);
+        SWIG_fail;
+      }
+      arg4[i] = (GIntBig)val;
+      Py_DECREF(o);
+    }
+  }
+  {
+    if ( bUseExceptions ) {
+      CPLErrorReset();
+    }
+    GNMGenericNetworkShadow_GetShortestPathCosts(arg1,arg2,arg3,arg4,arg5,arg6);
+#ifndef SED_HACKS
+    if ( bUseExceptions ) {
+      CPLErr eclass = CPLGetLastErrorType();
+      if ( eclass == CE_Failure || eclass == CE_Fatal ) {
+        SWIG_exception( SWIG_RuntimeError, CPLGetLastErrorMsg() );
+      }
+    }
+#endif
+  }
+  resultobj = SWIG_Py_Void();
+  {
+    /* %typemap(argout)  (int* pnCount, double** ppadfValues) */
+    Py_DECREF(resultobj);
+    PyObject *out = PyList_New( *arg5 );
+    for( int i=0; i<*arg5; i++ ) {
+      PyList_SetItem( out, i, PyFloat_FromDouble( (*arg6)[i] ) );
+    }
+    resultobj = out;
+  }
+  {
+    /* %typemap(freearg) (int nList, GIntBig* pList) */
+    if (arg4) {
+      free((void*) arg4);
+    }
+  }
+  {
+    /* %typemap(freearg)  (int* pnCount, double** ppadfValues) */
+    VSIFree(*arg6);
+  }
+  if ( ReturnSame(bLocalUseExceptionsCode) ) { CPLErr eclass = CPLGetLastErrorType(); if ( eclass == CE_Failure || eclass == CE_Fatal ) { Py_XDECREF(resultobj); SWIG_Error( SWIG_RuntimeError, CPLGetLastErrorMsg() ); return NULL; } }
+  return resultobj;
+fail:
+  {
+    /* %typemap(freearg) (int nList, GIntBig* pList) */
+    if (arg4) {
+      free((void*) arg4);
+    }
+  }
+  {
+    /* %typemap(freearg)  (int* pnCount, double** ppadfValues) */
+    VSIFree(*arg6);
+  }
+  return NULL;
+}
+
+
 SWIGINTERN PyObject *GenericNetwork_swigregister(PyObject *SWIGUNUSEDPARM(self), PyObject *args) {
   PyObject *obj;
   if (!PyArg_ParseTuple(args,(char*)"O:swigregister", &obj)) return NULL;
@@ -6468,6 +6766,8 @@ static PyMethodDef SwigMethods[] = {
 		""},
 	 { (char *)"GenericNetwork_ChangeBlockState", _wrap_GenericNetwork_ChangeBlockState, METH_VARARGS, (char *)"GenericNetwork_ChangeBlockState(GenericNetwork self, GIntBig nFID, bool bIsBlock) -> CPLErr"},
 	 { (char *)"GenericNetwork_ChangeAllBlockState", _wrap_GenericNetwork_ChangeAllBlockState, METH_VARARGS, (char *)"GenericNetwork_ChangeAllBlockState(GenericNetwork self, bool bIsBlock=False) -> CPLErr"},
+	 { (char *)"GenericNetwork_BuildContractionHierarchy", (PyCFunction) _wrap_GenericNetwork_BuildContractionHierarchy, METH_VARARGS | METH_KEYWORDS, (char *)"GenericNetwork_BuildContractionHierarchy(GenericNetwork self, GDALProgressFunc callback=0, void * callback_data=None) -> CPLErr"},
+	 { (char *)"GenericNetwork_GetShortestPathCosts", _wrap_GenericNetwork_GetShortestPathCosts, METH_VARARGS, (char *)"GenericNetwork_GetShortestPathCosts(GenericNetwork self, GIntBig nStartFID, int nEndCount)"},
 	 { (char *)"GenericNetwork_swigregister", GenericNetwork_swigregister, METH_VARARGS, NULL},
 	 { NULL, NULL, 0, NULL }
 };
@@ -6494,6 +6794,7 @@ static swig_type_info _swigt__p_OGRLayerShadow = {"_p_OGRLayerShadow", "OGRLayer
 static swig_type_info _swigt__p_OGRwkbGeometryType = {"_p_OGRwkbGeometryType", "OGRwkbGeometryType *", 0, 0, (void*)0, 0};
 static swig_type_info _swigt__p_OSRSpatialReferenceShadow = {"_p_OSRSpatialReferenceShadow", "OSRSpatialReferenceShadow *", 0, 0, (void*)0, 0};
 static swig_type_info _swigt__p_char = {"_p_char", "char *|retStringAndCPLFree *", 0, 0, (void*)0, 0};
+static swig_type_info _swigt__p_f_double_p_q_const__char_p_void__int = {"_p_f_double_p_q_const__char_p_void__int", "int (*)(double,char const *,void *)", 0, 0, (void*)0, 0};
 static swig_type_info _swigt__p_int = {"_p_int", "CPLErr *|int *|GNMDirection *", 0, 0, (void*)0, 0};
 static swig_type_info _swigt__p_p_char = {"_p_p_char", "char **", 0, 0, (void*)0, 0};
 
@@ -6508,6 +6809,7 @@ static swig_type_info *swig_type_initial[] = {
   &_swigt__p_OGRwkbGeometryType,
   &_swigt__p_OSRSpatialReferenceShadow,
   &_swigt__p_char,
+  &_swigt__p_f_double_p_q_const__char_p_void__int,
   &_swigt__p_int,
   &_swigt__p_p_char,
 };
@@ -6522,6 +6824,7 @@ static swig_cast_info _swigc__p_OGRLayerShadow[] = {  {&_swigt__p_OGRLayerShadow
 static swig_cast_info _swigc__p_OGRwkbGeometryType[] = {  {&_swigt__p_OGRwkbGeometryType, 0, 0, 0},{0, 0, 0, 0}};
 static swig_cast_info _swigc__p_OSRSpatialReferenceShadow[] = {  {&_swigt__p_OSRSpatialReferenceShadow, 0, 0, 0},{0, 0, 0, 0}};
 static swig_cast_info _swigc__p_char[] = {  {&_swigt__p_char, 0, 0, 0},{0, 0, 0, 0}};
+static swig_cast_info _swigc__p_f_double_p_q_const__char_p_void__int[] = {  {&_swigt__p_f_double_p_q_const__char_p_void__int, 0, 0, 0},{0, 0, 0, 0}};
 static swig_cast_info _swigc__p_int[] = {  {&_swigt__p_int, 0, 0, 0},{0, 0, 0, 0}};
 static swig_cast_info _swigc__p_p_char[] = {  {&_swigt__p_p_char, 0, 0, 0},{0, 0, 0, 0}};
 
@@ -6536,6 +6839,7 @@ static swig_cast_info *swig_cast_initial[] = {
   _swigc__p_OGRwkbGeometryType,
   _swigc__p_OSRSpatialReferenceShadow,
   _swigc__p_char,
+  _swigc__p_f_double_p_q_const__char_p_void__int,
   _swigc__p_int,
   _swigc__p_p_char,
 };
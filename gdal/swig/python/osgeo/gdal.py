@@ -2634,6 +2634,14 @@ def SieveFilter(*args, **kwargs):
   return _gdal.SieveFilter(*args, **kwargs)
 SieveFilter = _gdal.SieveFilter
 
+def LabelConnectedComponents(*args, **kwargs):
+  """
+    LabelConnectedComponents(Band srcBand, Band maskBand, Band dstBand, int connectedness=4, char ** options=None,
+        GDALProgressFunc callback=0, void * callback_data=None) -> int
+    """
+  return _gdal.LabelConnectedComponents(*args, **kwargs)
+LabelConnectedComponents = _gdal.LabelConnectedComponents
+
 def RegenerateOverviews(*args, **kwargs):
   """
     RegenerateOverviews(Band srcBand, int overviewBandCount, char const * resampling="average", GDALProgressFunc callback=0,
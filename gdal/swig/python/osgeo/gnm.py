@@ -269,6 +269,14 @@ class GenericNetwork(Network):
         """ChangeAllBlockState(GenericNetwork self, bool bIsBlock=False) -> CPLErr"""
         return _gnm.GenericNetwork_ChangeAllBlockState(self, *args)
 
+    def BuildContractionHierarchy(self, *args, **kwargs):
+        """BuildContractionHierarchy(GenericNetwork self, GDALProgressFunc callback=0, void * callback_data=None) -> CPLErr"""
+        return _gnm.GenericNetwork_BuildContractionHierarchy(self, *args, **kwargs)
+
+    def GetShortestPathCosts(self, *args):
+        """GetShortestPathCosts(GenericNetwork self, GIntBig nStartFID, int nEndCount)"""
+        return _gnm.GenericNetwork_GetShortestPathCosts(self, *args)
+
 GenericNetwork_swigregister = _gnm.GenericNetwork_swigregister
 GenericNetwork_swigregister(GenericNetwork)
 
@@ -89,6 +89,10 @@ while i < len(argv):
         i = i + 1
         smoothing_iterations = int(argv[i])
 
+    elif arg == '-o':
+        i = i + 1
+        options.append(argv[i])
+
     elif arg == '-b':
         i = i + 1
         src_band = int(argv[i])
@@ -39,7 +39,8 @@ from osgeo import osr
 
 def Usage():
     print("""
-gdal_polygonize [-8] [-nomask] [-mask filename] raster_file [-b band]
+gdal_polygonize [-8] [-o name=value]* [-nomask] [-mask filename]
+                raster_file [-b band]
                 [-q] [-f ogr_format] out_file [layer] [fieldname]
 """)
     sys.exit(1)
@@ -81,6 +82,10 @@ while i < len(argv):
     elif arg == '-8':
         options.append('8CONNECTED=8')
 
+    elif arg == '-o':
+        i = i + 1
+        options.append(argv[i])
+
     elif arg == '-nomask':
         mask = 'none'
 